@@ -37,6 +37,7 @@ class BuildSamples(Builder.Action):
             'samples/mqtt5/mqtt5_shared_subscription',
             "samples/pub_sub/basic_pub_sub",
             "samples/pub_sub/cycle_pub_sub",
+            "samples/pub_sub/fleet_simulator",
             'samples/secure_tunneling/secure_tunnel',
             'samples/secure_tunneling/tunnel_notification',
             'samples/shadow/shadow_sync',
@@ -60,6 +61,11 @@ class BuildSamples(Builder.Action):
             'servicetests/tests/JobsExecution/',
             'servicetests/tests/FleetProvisioning/',
             'servicetests/tests/ShadowUpdate/',
+            'servicetests/tests/ShadowBenchmark/',
+            'servicetests/tests/JobsLoad/',
+            'servicetests/tests/PayloadDecodeBenchmark/',
+            'servicetests/tests/ShadowSyncStorm/',
+            'servicetests/tests/ShadowSchemaBenchmark/',
         ]
 
         for sample_path in samples:
@@ -0,0 +1,12 @@
+# The trace points of the service clients are declared in IotDeviceCommon-cpp's Tracing.h. They compile to nothing
+# unless AWS_IOT_SDK_TRACING is on, but the header is always included, so it is found in the source tree rather than
+# through IotDeviceCommon-cpp, which is not built with BYO_CRYPTO.
+set(AWS_IOT_SDK_TRACING_INCLUDE_DIR "${CMAKE_CURRENT_LIST_DIR}/../iotdevicecommon/include")
+
+function(aws_iot_sdk_use_tracing target)
+    target_include_directories(${target} PRIVATE $<BUILD_INTERFACE:${AWS_IOT_SDK_TRACING_INCLUDE_DIR}>)
+    if (AWS_IOT_SDK_TRACING)
+        target_compile_definitions(${target} PRIVATE "-DAWS_IOT_SDK_TRACING")
+        target_link_libraries(${target} IotDeviceCommon-cpp)
+    endif()
+endfunction()
@@ -1,6 +1,9 @@
 include(CMakeFindDependencyMacro)
 
 find_dependency(aws-crt-cpp)
+if (@AWS_IOT_SDK_TRACING@)
+    find_dependency(IotDeviceCommon-cpp)
+endif()
 
 macro(aws_load_targets type)
     include(${CMAKE_CURRENT_LIST_DIR}/${type}/@PROJECT_NAME@-targets.cmake)
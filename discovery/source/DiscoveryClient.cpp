@@ -10,6 +10,8 @@
 #include <aws/crt/io/TlsOptions.h>
 #include <aws/crt/io/Uri.h>
 
+#include <aws/iotdevicecommon/Tracing.h>
+
 namespace Aws
 {
     namespace Discovery
@@ -109,6 +111,7 @@ namespace Aws
             const Crt::String &thingName,
             const OnDiscoverResponse &onDiscoverResponse) noexcept
         {
+            AWS_IOT_TRACE_START(span, Discovery);
             auto callbackContext = Crt::MakeShared<ClientCallbackContext>(m_allocator);
             if (!callbackContext)
             {
@@ -118,7 +121,7 @@ namespace Aws
             callbackContext->responseCode = 0;
 
             bool res = m_connectionManager->AcquireConnection(
-                [this, callbackContext, thingName, onDiscoverResponse](
+                [this, callbackContext, thingName, onDiscoverResponse AWS_IOT_TRACE_CAPTURE(span)](
                     std::shared_ptr<Crt::Http::HttpClientConnection> connection, int errorCode) {
                     if (errorCode)
                     {
@@ -157,6 +160,7 @@ namespace Aws
                         onDiscoverResponse(nullptr, Crt::LastErrorOrUnknown(), 0);
                         return;
                     }
+                    AWS_IOT_TRACE_MARK(span, Serialize);
 
                     Crt::Http::HttpRequestOptions requestOptions;
                     requestOptions.request = request.get();
@@ -171,23 +175,26 @@ namespace Aws
                         [callbackContext](Crt::Http::HttpStream &, const Crt::ByteCursor &data) {
                             callbackContext->ss.write(reinterpret_cast<const char *>(data.ptr), data.len);
                         };
-                    requestOptions.onStreamComplete = [request, connection, callbackContext, onDiscoverResponse](
-                                                          Crt::Http::HttpStream &, int errorCode) {
-                        if (!errorCode && callbackContext->responseCode == 200)
-                        {
-                            Crt::JsonObject jsonObject(callbackContext->ss.str());
-                            DiscoverResponse response(jsonObject.View());
-                            onDiscoverResponse(&response, AWS_ERROR_SUCCESS, callbackContext->responseCode);
-                        }
-                        else
-                        {
-                            if (!errorCode)
+                    requestOptions.onStreamComplete =
+                        [request, connection, callbackContext, onDiscoverResponse AWS_IOT_TRACE_CAPTURE(span)](
+                            Crt::Http::HttpStream &, int errorCode) {
+                            AWS_IOT_TRACE_MARK(span, ResponseReceived);
+                            if (!errorCode && callbackContext->responseCode == 200)
+                            {
+                                Crt::JsonObject jsonObject(callbackContext->ss.str());
+                                DiscoverResponse response(jsonObject.View());
+                                onDiscoverResponse(&response, AWS_ERROR_SUCCESS, callbackContext->responseCode);
+                            }
+                            else
                             {
-                                errorCode = AWS_ERROR_UNKNOWN;
+                                if (!errorCode)
+                                {
+                                    errorCode = AWS_ERROR_UNKNOWN;
+                                }
+                                onDiscoverResponse(nullptr, errorCode, callbackContext->responseCode);
                             }
-                            onDiscoverResponse(nullptr, errorCode, callbackContext->responseCode);
-                        }
-                    };
+                            AWS_IOT_TRACE_MARK(span, HandlerDone);
+                        };
 
                     auto stream = connection->NewClientStream(requestOptions);
                     if (!stream)
@@ -199,6 +206,7 @@ namespace Aws
                     {
                         onDiscoverResponse(nullptr, Crt::LastErrorOrUnknown(), 0);
                     }
+                    AWS_IOT_TRACE_MARK(span, PublishQueued);
                 });
 
             if (!res)
@@ -21,9 +21,13 @@
 #include <aws/io/host_resolver.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 namespace Aws
 {
@@ -41,6 +45,8 @@ namespace Aws
         class ClientOperation;
         class ClientConnection;
         class ClientContinuation;
+        class ConnectionWatchdog;
+        class MessageArena;
 
         using HeaderValueType = aws_event_stream_header_value_type;
         using MessageType = aws_event_stream_rpc_message_type;
@@ -58,6 +64,58 @@ namespace Aws
          */
         using ConnectMessageAmender = std::function<const MessageAmendment &(void)>;
 
+        /**
+         * Computes the 32-bit FNV-1a hash of a model or operation name.
+         *
+         * This is constexpr so that generated service models can `switch` on the hashes of the names they know about
+         * rather than looking them up in a string-keyed map. Two names hashing alike within one switch is a compile
+         * error (duplicate case label), so each case only needs a single string comparison to confirm the match.
+         * @param name Null-terminated name to hash.
+         * @param hash Running hash value; callers should leave this as the default.
+         * @return The hash of the name.
+         */
+        constexpr uint32_t HashModelName(const char *name, uint32_t hash = 2166136261u) noexcept
+        {
+            return (*name == '\0') ? hash
+                                   : HashModelName(name + 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619u);
+        }
+
+        /**
+         * Computes the same hash as the constexpr overload over a sized byte range, such as a header value.
+         * @param name Bytes of the name to hash.
+         * @param length Number of bytes in the name.
+         * @return The hash of the name.
+         */
+        inline uint32_t HashModelName(const uint8_t *name, size_t length) noexcept
+        {
+            uint32_t hash = 2166136261u;
+            for (size_t i = 0; i < length; ++i)
+            {
+                hash = (hash ^ name[i]) * 16777619u;
+            }
+            return hash;
+        }
+
+        /**
+         * Computes the same hash as the constexpr overload over a string.
+         * @param name The name to hash.
+         * @return The hash of the name.
+         */
+        inline uint32_t HashModelName(const Crt::String &name) noexcept
+        {
+            return HashModelName(reinterpret_cast<const uint8_t *>(name.data()), name.length());
+        }
+
+        /**
+         * Computes the same hash as the constexpr overload over a string view.
+         * @param name The name to hash.
+         * @return The hash of the name.
+         */
+        inline uint32_t HashModelName(Crt::StringView name) noexcept
+        {
+            return HashModelName(reinterpret_cast<const uint8_t *>(name.data()), name.size());
+        }
+
         /**
          * A wrapper around an `aws_event_stream_header_value_pair` object.
          */
@@ -131,7 +189,11 @@ namespace Aws
         class AWS_EVENTSTREAMRPC_API ConnectionConfig
         {
           public:
-            ConnectionConfig() noexcept : m_clientBootstrap(nullptr), m_connectRequestCallback(nullptr) {}
+            ConnectionConfig() noexcept
+                : m_clientBootstrap(nullptr), m_connectRequestCallback(nullptr), m_keepAliveInterval(0),
+                  m_keepAliveTimeout(0), m_requestTimeout(0), m_maxPayloadSize(0)
+            {
+            }
             Crt::Optional<Crt::String> GetHostName() const noexcept { return m_hostName; }
             Crt::Optional<uint32_t> GetPort() const noexcept { return m_port; }
             Crt::Optional<Crt::Io::SocketOptions> GetSocketOptions() const noexcept { return m_socketOptions; }
@@ -142,6 +204,10 @@ namespace Aws
             }
             Crt::Io::ClientBootstrap *GetClientBootstrap() const noexcept { return m_clientBootstrap; }
             OnMessageFlushCallback GetConnectRequestCallback() const noexcept { return m_connectRequestCallback; }
+            std::chrono::milliseconds GetKeepAliveInterval() const noexcept { return m_keepAliveInterval; }
+            std::chrono::milliseconds GetKeepAliveTimeout() const noexcept { return m_keepAliveTimeout; }
+            std::chrono::milliseconds GetRequestTimeout() const noexcept { return m_requestTimeout; }
+            size_t GetMaxPayloadSize() const noexcept { return m_maxPayloadSize; }
             ConnectMessageAmender GetConnectMessageAmender() const noexcept
             {
                 return [&](void) -> const MessageAmendment & { return m_connectAmendment; };
@@ -169,6 +235,35 @@ namespace Aws
             {
                 m_connectRequestCallback = connectRequestCallback;
             }
+            /**
+             * Ping the server periodically once connected, closing the connection if a ping goes unanswered.
+             * @param keepAliveInterval Time between pings. Zero, the default, disables keepalive.
+             * @param keepAliveTimeout Time to wait for the response to a ping. Defaults to the interval if zero.
+             */
+            void SetKeepAlive(
+                std::chrono::milliseconds keepAliveInterval,
+                std::chrono::milliseconds keepAliveTimeout) noexcept
+            {
+                m_keepAliveInterval = keepAliveInterval;
+                m_keepAliveTimeout = keepAliveTimeout;
+            }
+            /**
+             * Fail operations whose response has not arrived within this time of their activation. Zero, the
+             * default, waits indefinitely. Individual operations can override it with `WithRequestTimeout`.
+             */
+            void SetRequestTimeout(std::chrono::milliseconds requestTimeout) noexcept
+            {
+                m_requestTimeout = requestTimeout;
+            }
+            /**
+             * Reject messages whose payload is larger than this. Requests whose serialized payload is larger fail
+             * with `EVENT_STREAM_RPC_PAYLOAD_TOO_LARGE` before being sent, and larger responses fail the operation
+             * with the same status before they are parsed. This is a cap, not a streaming mode: each request and
+             * response is still carried whole in one message, so a payload over the limit cannot be transferred at
+             * all. Zero, the default, sets no limit.
+             * @param maxPayloadSize The largest payload, in bytes.
+             */
+            void SetMaxPayloadSize(size_t maxPayloadSize) noexcept { m_maxPayloadSize = maxPayloadSize; }
 
           protected:
             Crt::Optional<Crt::String> m_hostName;
@@ -178,6 +273,10 @@ namespace Aws
             Crt::Io::ClientBootstrap *m_clientBootstrap;
             MessageAmendment m_connectAmendment;
             OnMessageFlushCallback m_connectRequestCallback;
+            std::chrono::milliseconds m_keepAliveInterval;
+            std::chrono::milliseconds m_keepAliveTimeout;
+            std::chrono::milliseconds m_requestTimeout;
+            size_t m_maxPayloadSize;
         };
 
         enum EventStreamRpcStatusCode
@@ -194,7 +293,9 @@ namespace Aws
             EVENT_STREAM_RPC_UNKNOWN_PROTOCOL_MESSAGE,
             EVENT_STREAM_RPC_UNMAPPED_DATA,
             EVENT_STREAM_RPC_UNSUPPORTED_CONTENT_TYPE,
-            EVENT_STREAM_RPC_CRT_ERROR
+            EVENT_STREAM_RPC_CRT_ERROR,
+            EVENT_STREAM_RPC_TIMED_OUT,
+            EVENT_STREAM_RPC_PAYLOAD_TOO_LARGE
         };
 
         struct AWS_EVENTSTREAMRPC_API RpcError
@@ -251,15 +352,40 @@ namespace Aws
             ContinuationCallbackData(
                 ClientContinuation *clientContinuation,
                 Crt::Allocator *allocator = Crt::g_allocator) noexcept
-                : clientContinuation(clientContinuation), allocator(allocator)
+                : streamClosed(false), clientContinuation(clientContinuation), allocator(allocator), m_state(0),
+                  m_drained(true)
             {
-                continuationDestroyed = false;
             }
             ContinuationCallbackData(const ContinuationCallbackData &lhs) noexcept = delete;
-            bool continuationDestroyed;
-            std::mutex callbackMutex;
+
+            /**
+             * Counts a callback as dispatching into the continuation.
+             * @return False if the continuation is being destroyed, in which case the callback must not dispatch.
+             * Either way, the callback must call LeaveCallback() once it returns.
+             */
+            bool EnterCallback() noexcept;
+            void LeaveCallback() noexcept;
+            /**
+             * Blocks until every callback counted by EnterCallback() has left.
+             * @param stopAdmitting If true, every callback entering from now on is refused.
+             */
+            void WaitForCallbacks(bool stopAdmitting) noexcept;
+
+            /* Set once the stream has delivered its closed callback, after which it will deliver no other. */
+            std::atomic<bool> streamClosed;
             ClientContinuation *clientContinuation;
             Crt::Allocator *allocator;
+
+          private:
+            static constexpr uint32_t STATE_DESTROYED = 1;
+            static constexpr uint32_t STATE_WAITING = 2;
+            static constexpr uint32_t STATE_CALLBACK = 4;
+
+            /* The number of callbacks in flight, in units of STATE_CALLBACK, and the flags above. */
+            std::atomic<uint32_t> m_state;
+            std::mutex m_drainMutex;
+            std::condition_variable m_drainSignal;
+            bool m_drained;
         };
 
         /**
@@ -356,10 +482,24 @@ namespace Aws
 
           private:
             friend class ClientOperation;
+
+            /**
+             * Replace a stream that has finished with a new, unactivated stream on the same connection so that the
+             * continuation can be activated again. The callback data is carried over to the new stream.
+             * @return True if the continuation holds an unactivated stream, false if the current stream is still
+             * open or a new stream could not be created.
+             */
+            bool Reopen() noexcept;
+
             Crt::Allocator *m_allocator;
+            ClientConnection *m_connection;
+            /* Shared with the connection, so that callbacks still delivered while the connection is destroyed and
+             * messages sent on a continuation that outlives it do not reach for a freed arena. */
+            std::shared_ptr<MessageArena> m_messageArena;
             ClientContinuationHandler &m_continuationHandler;
             struct aws_event_stream_rpc_client_continuation_token *m_continuationToken;
             ContinuationCallbackData *m_callbackData;
+            bool m_activated;
 
             static void s_onContinuationMessage(
                 struct aws_event_stream_rpc_client_continuation_token *continuationToken,
@@ -386,6 +526,143 @@ namespace Aws
             Crt::Allocator *m_allocator;
         };
 
+        /**
+         * An allocator that recycles the blocks it hands out instead of returning them to the underlying allocator.
+         *
+         * Streaming operations allocate a shape per event and free it once the stream handler returns, so after the
+         * first few events every allocation made through this pool is served from a free list. Blocks larger than
+         * `MAX_POOLED_BLOCK_SIZE` bypass the pool.
+         *
+         * The free lists belong to the first thread that allocates from the pool, which for a streaming operation is
+         * its connection's event loop thread, and are used without locking. Allocations made on any other thread
+         * bypass the pool, and blocks freed on any other thread, such as shapes a handler kept, go back to the
+         * underlying allocator.
+         * @note All shapes allocated through the pool must be freed before the pool is destroyed.
+         */
+        class AWS_EVENTSTREAMRPC_API ShapeAllocationPool final
+        {
+          public:
+            static constexpr size_t MAX_POOLED_BLOCK_SIZE = 1024;
+
+            /**
+             * @param allocator Allocator used to obtain blocks that are not yet cached.
+             * @param maxCachedBlocksPerSize The number of free blocks to retain for each block size.
+             */
+            explicit ShapeAllocationPool(
+                Crt::Allocator *allocator = Crt::g_allocator,
+                size_t maxCachedBlocksPerSize = 16) noexcept;
+            ~ShapeAllocationPool() noexcept;
+            ShapeAllocationPool(const ShapeAllocationPool &) = delete;
+            ShapeAllocationPool &operator=(const ShapeAllocationPool &) = delete;
+
+            /**
+             * @return The allocator to pass to model allocation functions.
+             */
+            Crt::Allocator *GetAllocator() noexcept { return &m_poolAllocator; }
+
+            /**
+             * @return The number of allocations that could not be served from a free list.
+             */
+            size_t GetMissCount() const noexcept { return m_missCount.load(); }
+
+          private:
+            static constexpr size_t SIZE_CLASS_GRANULARITY = 64;
+            static constexpr size_t SIZE_CLASS_COUNT = MAX_POOLED_BLOCK_SIZE / SIZE_CLASS_GRANULARITY;
+
+            static void *s_memAcquire(struct aws_allocator *allocator, size_t size);
+            static void s_memRelease(struct aws_allocator *allocator, void *ptr);
+
+            /* True if the calling thread owns the free lists, claiming them if no thread has yet. */
+            bool IsOwnerThread() noexcept;
+
+            struct aws_allocator m_poolAllocator;
+            Crt::Allocator *m_allocator;
+            size_t m_maxCachedBlocksPerSize;
+            std::atomic<std::thread::id> m_ownerThread;
+            /* Only used by the owner thread. */
+            void *m_freeLists[SIZE_CLASS_COUNT];
+            size_t m_freeListLengths[SIZE_CLASS_COUNT];
+            std::atomic<size_t> m_missCount;
+        };
+
+        /**
+         * Allocation counters for the header lists of the messages sent and received on a connection. The copies of
+         * header values, and the headers of a MessageAmendment, are not counted.
+         */
+        struct AWS_EVENTSTREAMRPC_API MessageAllocationStats
+        {
+            /* The number of messages sent and received. */
+            uint64_t messages;
+            /* The number of allocations made for the header lists of those messages, and the bytes they requested. */
+            uint64_t allocations;
+            uint64_t bytes;
+            /* Allocations for incoming messages that the arena could not serve, which went to the connection's
+             * allocator. */
+            uint64_t overflowAllocations;
+        };
+
+        /**
+         * A bump allocator for the list of headers handed to a continuation handler.
+         *
+         * Each incoming message begins on the connection's event loop thread, and memory is only carved from the
+         * arena for that thread; allocations made from any other thread, or that do not fit, go to the underlying
+         * allocator. The arena is rewound when a message begins and nothing allocated from it is still live, so in
+         * the steady state the list costs no allocation.
+         *
+         * The values of the headers in the list are still copied with the connection's allocator, so that a handler
+         * may keep a header after the connection is gone. Outgoing messages do not use the arena.
+         */
+        class AWS_EVENTSTREAMRPC_API MessageArena final
+        {
+          public:
+            /**
+             * @param allocator Allocator for the arena's block and for allocations that do not fit in it.
+             * @param capacity Size of the arena's block in bytes.
+             */
+            explicit MessageArena(Crt::Allocator *allocator = Crt::g_allocator, size_t capacity = 4096) noexcept;
+            ~MessageArena() noexcept;
+            MessageArena(const MessageArena &) = delete;
+            MessageArena &operator=(const MessageArena &) = delete;
+
+            /**
+             * Start a message on the calling thread, rewinding the arena if nothing allocated from it is live.
+             */
+            void BeginMessage() noexcept;
+
+            /**
+             * Count an outgoing message, whose native header array is built without the arena.
+             * @param heapBytes Bytes allocated for the header array, or zero if it fit in stack storage.
+             */
+            void CountOutgoingMessage(size_t heapBytes) noexcept;
+
+            /**
+             * @return The allocator that serves the current message.
+             */
+            Crt::Allocator *GetAllocator() noexcept { return &m_arenaAllocator; }
+
+            /**
+             * @return A snapshot of the allocation counters.
+             */
+            MessageAllocationStats GetStats() const noexcept;
+
+          private:
+            static void *s_memAcquire(struct aws_allocator *allocator, size_t size);
+            static void s_memRelease(struct aws_allocator *allocator, void *ptr);
+
+            struct aws_allocator m_arenaAllocator;
+            Crt::Allocator *m_allocator;
+            uint8_t *m_block;
+            size_t m_capacity;
+            /* Only used by the thread that began the current message. */
+            size_t m_offset;
+            std::atomic<std::thread::id> m_ownerThread;
+            std::atomic<size_t> m_liveAllocations;
+            std::atomic<uint64_t> m_messages;
+            std::atomic<uint64_t> m_allocations;
+            std::atomic<uint64_t> m_bytes;
+            std::atomic<uint64_t> m_overflowAllocations;
+        };
+
         /**
          * Base class for errors used by operations.
          */
@@ -525,6 +802,24 @@ namespace Aws
                 const Crt::String &errorModelName,
                 Crt::StringView stringView,
                 Crt::Allocator *allocator) const noexcept = 0;
+
+            /**
+             * Parse an error whose model name is viewed in place, such as in the header of a received message.
+             * Models that dispatch on the name without copying it override this; by default the name is copied and
+             * passed to `AllocateOperationErrorFromPayload`.
+             * @param errorModelName The model name.
+             * @param stringView String to parse the error from.
+             * @param allocator Allocator to use.
+             * @return The operation error.
+             */
+            virtual Crt::ScopedResource<OperationError> AllocateOperationErrorFromModelName(
+                Crt::StringView errorModelName,
+                Crt::StringView stringView,
+                Crt::Allocator *allocator) const noexcept
+            {
+                return AllocateOperationErrorFromPayload(
+                    Crt::String(errorModelName.data(), errorModelName.size()), stringView, allocator);
+            }
         };
 
         /**
@@ -598,6 +893,21 @@ namespace Aws
                 return m_serviceModel.AllocateOperationErrorFromPayload(errorModelName, stringView, allocator);
             }
 
+            /**
+             * Parse the given string into an operation error, without copying the model name.
+             * @param errorModelName The model name.
+             * @param stringView String to parse the error from.
+             * @param allocator Allocator to use.
+             * @return The operation error.
+             */
+            Crt::ScopedResource<OperationError> AllocateOperationErrorFromModelName(
+                Crt::StringView errorModelName,
+                Crt::StringView stringView,
+                Crt::Allocator *allocator) const noexcept
+            {
+                return m_serviceModel.AllocateOperationErrorFromModelName(errorModelName, stringView, allocator);
+            }
+
           private:
             const ServiceModel &m_serviceModel;
         };
@@ -641,6 +951,22 @@ namespace Aws
              */
             void WithLaunchMode(std::launch mode) noexcept;
 
+            /**
+             * Fail the operation with `EVENT_STREAM_RPC_TIMED_OUT` and close its stream if its response has not
+             * arrived within this time of activation. Overrides the connection's request timeout; zero uses it.
+             * @param requestTimeout The time to wait for the response.
+             */
+            void WithRequestTimeout(std::chrono::milliseconds requestTimeout) noexcept;
+
+            /**
+             * Prepare an operation whose stream has closed to be activated again, reusing the operation, its
+             * stream handler and its continuation instead of allocating new ones.
+             * @note The operation must not be in use by another thread while it is being reset.
+             * @return True if the operation can be activated again, false if its stream is still open or a new stream
+             * could not be opened on the connection.
+             */
+            bool Reset() noexcept;
+
           protected:
             /**
              * Initiate a new client stream. Send the shape for the new stream.
@@ -663,9 +989,29 @@ namespace Aws
             std::launch m_asyncLaunchMode;
 
           private:
+            friend class ClientReconnector;
+            friend class ConnectionWatchdog;
+
+            /**
+             * Called by the connection's watchdog when the response has not arrived in time.
+             */
+            void OnRequestTimedOut() noexcept;
+
+            /**
+             * Re-activate a stream that was lost along with its connection, sending the request it was last
+             * activated with. Streams that were closed by either peer are not replayed.
+             * @return Future which will be resolved once the request is sent. It resolves to
+             * `EVENT_STREAM_RPC_CONTINUATION_CLOSED` if the stream was closed on purpose, and to
+             * `EVENT_STREAM_RPC_CONNECTION_CLOSED` if a new stream could not be opened.
+             */
+            std::future<RpcError> Replay() noexcept;
+            std::future<RpcError> ActivatePayload(
+                const Crt::String &payloadString,
+                OnMessageFlushCallback onMessageFlushCallback) noexcept;
+
             EventStreamRpcStatusCode HandleData(const Crt::Optional<Crt::ByteBuf> &payload);
             EventStreamRpcStatusCode HandleError(
-                const Crt::String &modelName,
+                Crt::StringView modelName,
                 const Crt::Optional<Crt::ByteBuf> &payload,
                 uint32_t messageFlags);
             /**
@@ -685,9 +1031,14 @@ namespace Aws
              */
             void OnContinuationClosed() override;
 
-            const EventStreamHeader *GetHeaderByName(
+            /**
+             * Locate the service model type and content type headers in a single pass over the message headers.
+             * Header names are compared in place so that no strings are constructed per message.
+             */
+            static void s_indexHeaders(
                 const Crt::List<EventStreamHeader> &headers,
-                const Crt::String &name) noexcept;
+                const EventStreamHeader *&modelHeader,
+                const EventStreamHeader *&contentHeader) noexcept;
 
             enum CloseState
             {
@@ -698,17 +1049,165 @@ namespace Aws
 
             uint32_t m_messageCount;
             Crt::Allocator *m_allocator;
+            ClientConnection &m_connection;
+            /* Only valid while the connection is alive, which the watchdog tells since the operation may outlive it. */
+            std::weak_ptr<ConnectionWatchdog> m_watchdog;
+            std::chrono::milliseconds m_requestTimeout;
+            /* Built on first activation and reused by every activation that follows. */
+            Crt::String m_operationName;
+            Crt::List<EventStreamHeader> m_requestHeaders;
+            /* Resolved once from the model context so that incoming messages are not checked against fresh copies. */
+            Crt::String m_initialResponseModelName;
+            Crt::Optional<Crt::String> m_streamingResponseModelName;
             std::shared_ptr<StreamResponseHandler> m_streamHandler;
+            /* Declared ahead of the continuation so that it outlives any callback still allocating from it. */
+            ShapeAllocationPool m_streamingShapePool;
             ClientContinuation m_clientContinuation;
-            /* This mutex protects m_resultReceived & m_closeState. */
+            /* This mutex serializes stream closes with m_closeReady. Responses never take it. */
             std::mutex m_continuationMutex;
-            bool m_resultReceived;
+            /* Claimed by whichever of the response, a timeout or the stream closing delivers the result first. */
+            std::atomic_bool m_resultReceived;
             std::promise<TaggedResult> m_initialResponsePromise;
             std::atomic_int m_expectedCloses;
             std::atomic_bool m_streamClosedCalled;
             std::condition_variable m_closeReady;
+            /* Set when either peer terminates the stream, as opposed to it being lost with the connection. */
+            std::atomic_bool m_streamEnded;
+            /* The last request of a streaming operation, kept so that the stream can be replayed. */
+            Crt::String m_replayPayload;
         };
 
+        /**
+         * A pool of operations of one type, for callers that repeat the same request at a high rate.
+         *
+         * Operations handed back to the pool are reset and activated again by later callers, so that a steady
+         * stream of requests does not create a new operation, stream handler and continuation for every request.
+         */
+        template <typename OperationT> class ClientOperationPool final
+        {
+          public:
+            /**
+             * @param newOperation Function used to create an operation when none in the pool can be reused.
+             * @param maxPooledOperations The most operations that the pool will hold on to.
+             */
+            ClientOperationPool(
+                std::function<std::shared_ptr<OperationT>()> newOperation,
+                size_t maxPooledOperations = 8) noexcept
+                : m_newOperation(std::move(newOperation)), m_maxPooledOperations(maxPooledOperations)
+            {
+            }
+
+            /**
+             * Take an operation that is ready to be activated, reusing a pooled operation whose previous stream has
+             * closed if there is one.
+             * @return The operation.
+             */
+            std::shared_ptr<OperationT> Acquire() noexcept
+            {
+                /* Reset waits for the callbacks of the previous stream to return, so it is called without the pool
+                 * lock held. Operations whose stream has not closed yet go back to the pool afterwards. */
+                std::shared_ptr<OperationT> operation;
+                Crt::Vector<std::shared_ptr<OperationT>> notReady;
+                while (!operation)
+                {
+                    std::shared_ptr<OperationT> candidate;
+                    {
+                        const std::lock_guard<std::mutex> lock(m_poolMutex);
+                        if (m_operations.empty())
+                        {
+                            break;
+                        }
+                        candidate = std::move(m_operations.back());
+                        m_operations.pop_back();
+                    }
+                    if (candidate->Reset())
+                    {
+                        operation = std::move(candidate);
+                    }
+                    else
+                    {
+                        notReady.push_back(std::move(candidate));
+                    }
+                }
+
+                for (auto &pending : notReady)
+                {
+                    Release(std::move(pending));
+                }
+                return operation ? operation : m_newOperation();
+            }
+
+            /**
+             * Hand an operation back to the pool once its result has been retrieved.
+             * @param operation The operation, which the caller must no longer use.
+             */
+            void Release(std::shared_ptr<OperationT> operation) noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_poolMutex);
+                if (operation && m_operations.size() < m_maxPooledOperations)
+                {
+                    m_operations.push_back(std::move(operation));
+                }
+            }
+
+          private:
+            std::function<std::shared_ptr<OperationT>()> m_newOperation;
+            size_t m_maxPooledOperations;
+            std::mutex m_poolMutex;
+            Crt::Vector<std::shared_ptr<OperationT>> m_operations;
+        };
+
+        /**
+         * Activate one operation per request before waiting on any of them, so that the requests of a batch are
+         * pipelined on the connection instead of each waiting out a round trip.
+         * @param requests The requests, one per operation.
+         * @param newOperation Function used to create the operation for each request.
+         * @param launchMode Launch mode of the returned future.
+         * @return Future resolving to one result per request, in the order of the requests. A request that could not
+         * be sent is given a result holding the error it failed to activate with.
+         */
+        template <typename OperationT, typename ResultT, typename RequestT, typename NewOperationT>
+        std::future<Crt::Vector<ResultT>> ActivateBatch(
+            const Crt::Vector<RequestT> &requests,
+            NewOperationT newOperation,
+            std::launch launchMode) noexcept
+        {
+            /* Holds the operations alive until every one of their results has been collected. */
+            struct BatchState
+            {
+                Crt::Vector<std::shared_ptr<OperationT>> operations;
+                Crt::Vector<std::future<RpcError>> activations;
+            };
+
+            auto state = std::make_shared<BatchState>();
+            state->operations.reserve(requests.size());
+            state->activations.reserve(requests.size());
+            for (const RequestT &request : requests)
+            {
+                state->operations.push_back(newOperation());
+                state->activations.push_back(state->operations.back()->Activate(request));
+            }
+
+            return std::async(launchMode, [state]() {
+                Crt::Vector<ResultT> results;
+                results.reserve(state->operations.size());
+                for (size_t i = 0; i < state->operations.size(); ++i)
+                {
+                    RpcError activateError = state->activations[i].get();
+                    if (!activateError)
+                    {
+                        /* The request never made it onto the connection, so no response will arrive for it. */
+                        results.push_back(ResultT(TaggedResult(activateError)));
+                    }
+                    else
+                    {
+                        results.push_back(state->operations[i]->GetResult().get());
+                    }
+                }
+                return results;
+            });
+        }
+
         /**
          * Class representing a connection to an RPC server.
          */
@@ -757,6 +1256,12 @@ namespace Aws
              */
             void Close() noexcept;
 
+            /**
+             * @return Allocation counters for the messages sent and received on this connection. Dividing the
+             * allocations and bytes by the number of messages gives the cost of each message.
+             */
+            MessageAllocationStats GetMessageAllocationStats() const noexcept { return m_messageArena->GetStats(); }
+
             /**
              * Check if the connection is open.
              * @return True if the connection is open, false otherwise.
@@ -780,7 +1285,8 @@ namespace Aws
 
           private:
             friend class ClientContinuation;
-            friend std::future<RpcError> ClientOperation::Close(OnMessageFlushCallback onMessageFlushCallback) noexcept;
+            friend class ClientOperation;
+            friend class ConnectionWatchdog;
             enum ClientState
             {
                 DISCONNECTED = 1,
@@ -805,6 +1311,10 @@ namespace Aws
             OnMessageFlushCallback m_onConnectRequestCallback;
             Crt::Io::SocketOptions m_socketOptions;
             ConnectionConfig m_connectionConfig;
+            /* Runs keepalive pings and request deadlines. Shared with the operations created on this connection. */
+            std::shared_ptr<ConnectionWatchdog> m_watchdog;
+            /* Serves the transient buffers of incoming messages. Shared with the continuations of this connection. */
+            std::shared_ptr<MessageArena> m_messageArena;
             std::future<RpcError> SendProtocolMessage(
                 const Crt::List<EventStreamHeader> &headers,
                 const Crt::Optional<Crt::ByteBuf> &payload,
@@ -827,6 +1337,16 @@ namespace Aws
 
             static void s_protocolMessageCallback(int errorCode, void *userData) noexcept;
 
+            /**
+             * Close a connected connection, reporting `reason` to the lifecycle handler.
+             */
+            void CloseWithReason(RpcError reason) noexcept;
+
+            /**
+             * Send a keepalive ping if the connection is connected.
+             */
+            void SendKeepAlivePing() noexcept;
+
             /**
              * Sends a message on the connection. These must be connection level messages (not application messages).
              */
@@ -850,5 +1370,133 @@ namespace Aws
                 const Crt::Optional<Crt::ByteBuf> &payload,
                 OnMessageFlushCallback onMessageFlushCallback) noexcept;
         };
+
+        /**
+         * Options for automatically re-establishing a connection that was lost.
+         *
+         * Attempts are spaced with exponential backoff, starting at the minimum backoff and doubling up to the
+         * maximum backoff.
+         */
+        class AWS_EVENTSTREAMRPC_API ReconnectOptions
+        {
+          public:
+            ReconnectOptions() noexcept
+                : m_minBackoff(std::chrono::milliseconds(100)), m_maxBackoff(std::chrono::seconds(30))
+            {
+            }
+            std::chrono::milliseconds GetMinBackoff() const noexcept { return m_minBackoff; }
+            std::chrono::milliseconds GetMaxBackoff() const noexcept { return m_maxBackoff; }
+
+            void SetMinBackoff(std::chrono::milliseconds minBackoff) noexcept { m_minBackoff = minBackoff; }
+            void SetMaxBackoff(std::chrono::milliseconds maxBackoff) noexcept { m_maxBackoff = maxBackoff; }
+
+          protected:
+            std::chrono::milliseconds m_minBackoff;
+            std::chrono::milliseconds m_maxBackoff;
+        };
+
+        /**
+         * Counters describing how a connection has recovered from being lost.
+         */
+        struct AWS_EVENTSTREAMRPC_API ReconnectMetrics
+        {
+            /* The number of times the connection was re-established after being lost. */
+            uint32_t reconnectCount;
+            /* The number of connection attempts made during the most recent recovery. */
+            uint32_t lastReconnectAttempts;
+            /* Time from losing the connection until every stream was replayed, for the most recent recovery. */
+            std::chrono::milliseconds lastTimeToRecover;
+            /* The longest time to recover over all recoveries. */
+            std::chrono::milliseconds maxTimeToRecover;
+            /* Streams re-activated after a recovery, and those whose re-activation failed. */
+            uint32_t streamsReplayed;
+            uint32_t streamReplayFailures;
+        };
+
+        /**
+         * Re-establishes a connection after it is lost, then replays the streaming operations that were active on it.
+         *
+         * The reconnector sits between the connection and the user's lifecycle handler, forwarding every lifecycle
+         * event. Once the connection has been established, a loss of the connection that was not requested through
+         * `Close` starts reconnection attempts on a background thread.
+         */
+        class AWS_EVENTSTREAMRPC_API ClientReconnector final : public ConnectionLifecycleHandler
+        {
+          public:
+            ClientReconnector(ClientConnection &connection, Crt::Io::ClientBootstrap &clientBootstrap) noexcept;
+            ~ClientReconnector() noexcept;
+            ClientReconnector(const ClientReconnector &) = delete;
+            ClientReconnector &operator=(const ClientReconnector &) = delete;
+
+            /**
+             * Turn on automatic reconnection for connections made through this reconnector from now on.
+             * @param options The backoff used between connection attempts.
+             */
+            void Enable(const ReconnectOptions &options) noexcept;
+
+            /**
+             * @return True if automatic reconnection has been turned on.
+             */
+            bool IsEnabled() const noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_reconnectMutex);
+                return m_enabled;
+            }
+
+            /**
+             * Connect the connection, keeping the configuration so that it can be reused when reconnecting.
+             * @param connectionConfig The configuration parameters used for establishing the connection.
+             * @param lifecycleHandler The handler that lifecycle events are forwarded to.
+             * @return Future that will be resolved when the first connection attempt either succeeds or fails.
+             */
+            std::future<RpcError> Connect(
+                const ConnectionConfig &connectionConfig,
+                ConnectionLifecycleHandler *lifecycleHandler) noexcept;
+
+            /**
+             * Stop reconnecting, typically because the connection is being closed on purpose. A connection attempt
+             * that is in progress is cancelled by closing the connection.
+             */
+            void Close() noexcept;
+
+            /**
+             * Replay an operation's stream when the connection is re-established. Only weak references are kept,
+             * so tracking an operation does not extend its lifetime.
+             * @param operation The streaming operation to track.
+             */
+            void TrackOperation(const std::shared_ptr<ClientOperation> &operation) noexcept;
+
+            /**
+             * @return A snapshot of the recovery metrics.
+             */
+            ReconnectMetrics GetMetrics() const noexcept;
+
+            void OnConnectCallback() override;
+            void OnDisconnectCallback(RpcError status) override;
+            bool OnErrorCallback(RpcError status) override;
+            void OnPingCallback(
+                const Crt::List<EventStreamHeader> &headers,
+                const Crt::Optional<Crt::ByteBuf> &payload) override;
+
+          private:
+            void Run() noexcept;
+            void ReplayOperations() noexcept;
+
+            ClientConnection &m_connection;
+            Crt::Io::ClientBootstrap &m_clientBootstrap;
+            ReconnectOptions m_options;
+            ConnectionConfig m_connectionConfig;
+            ConnectionLifecycleHandler *m_lifecycleHandler;
+            /* This mutex protects everything below it. */
+            mutable std::mutex m_reconnectMutex;
+            std::condition_variable m_reconnectSignal;
+            bool m_enabled;
+            bool m_closing;
+            bool m_reconnectPending;
+            std::chrono::steady_clock::time_point m_disconnectTime;
+            Crt::Vector<std::weak_ptr<ClientOperation>> m_trackedOperations;
+            ReconnectMetrics m_metrics;
+            std::thread m_reconnectThread;
+        };
     } // namespace Eventstreamrpc
 } // namespace Aws
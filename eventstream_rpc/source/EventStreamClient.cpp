@@ -7,11 +7,16 @@
 #include <aws/crt/Api.h>
 #include <aws/crt/Config.h>
 #include <aws/crt/auth/Credentials.h>
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+#include <aws/iotdevicecommon/Tracing.h>
 
 #include <stdint.h>
 #include <string.h>
 
 #include <algorithm>
+#include <cstddef>
+#include <thread>
 
 constexpr auto EVENTSTREAM_VERSION_HEADER = ":version";
 constexpr auto EVENTSTREAM_VERSION_STRING = "0.1.0";
@@ -32,6 +37,256 @@ namespace Aws
             std::promise<RpcError> onFlushPromise;
         };
 
+        /* Sends keepalive pings on a connection and enforces the deadlines of its requests, using timers on one of
+         * the connection's event loops. It is shared by its connection, the operations created on the connection and
+         * every pending timer, since timers cannot be cancelled from outside the event loop. Operations may outlive
+         * their connection, so once the connection detaches from it the watchdog only answers that it is detached. */
+        class ConnectionWatchdog final : public std::enable_shared_from_this<ConnectionWatchdog>
+        {
+          public:
+            ConnectionWatchdog(ClientConnection *connection, Crt::Allocator *allocator) noexcept
+                : m_allocator(allocator), m_eventLoop(nullptr), m_connection(connection), m_keepAliveActive(false),
+                  m_pingOutstanding(false), m_pendingWakes(0),
+                  m_earliestWake(std::chrono::steady_clock::time_point::max()), m_ticking(false)
+            {
+            }
+
+            void SetConnection(ClientConnection *connection) noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_watchdogMutex);
+                m_connection = connection;
+            }
+
+            /* Called on every connection attempt; the first one picks the event loop that timers run on. */
+            void BindEventLoop(struct aws_event_loop *eventLoop) noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_watchdogMutex);
+                if (m_eventLoop == nullptr)
+                {
+                    m_eventLoop = eventLoop;
+                }
+            }
+
+            /* Operations check this before touching their connection, which may already have been destroyed. */
+            bool IsAttached() noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_watchdogMutex);
+                return m_connection != nullptr;
+            }
+
+            /* Called once the connection has been accepted. */
+            void StartKeepAlive(std::chrono::milliseconds interval, std::chrono::milliseconds timeout) noexcept
+            {
+                if (interval.count() <= 0)
+                {
+                    return;
+                }
+
+                const std::lock_guard<std::mutex> lock(m_watchdogMutex);
+                m_keepAliveInterval = interval;
+                m_keepAliveTimeout = timeout.count() > 0 ? timeout : interval;
+                m_keepAliveActive = true;
+                m_pingOutstanding = false;
+                m_nextPing = std::chrono::steady_clock::now() + m_keepAliveInterval;
+                ScheduleWakeLocked(m_nextPing);
+            }
+
+            void StopKeepAlive() noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_watchdogMutex);
+                m_keepAliveActive = false;
+                m_pingOutstanding = false;
+            }
+
+            void OnPingResponse() noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_watchdogMutex);
+                m_pingOutstanding = false;
+            }
+
+            void WatchRequest(ClientOperation *operation, std::chrono::steady_clock::time_point deadline) noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_watchdogMutex);
+                m_deadlines[operation] = deadline;
+                ScheduleWakeLocked(deadline);
+            }
+
+            /* If `waitForTimeout` is set, also waits for a timeout that is being delivered to the operation, so that
+             * the operation can be destroyed afterwards. */
+            void UnwatchRequest(ClientOperation *operation, bool waitForTimeout) noexcept
+            {
+                std::unique_lock<std::mutex> lock(m_watchdogMutex);
+                m_deadlines.erase(operation);
+                if (waitForTimeout)
+                {
+                    m_tickDone.wait(lock, [this]() { return !m_ticking; });
+                }
+            }
+
+            /* Called by the connection as it is destroyed. Timers that are still pending find nothing to do. */
+            void Detach() noexcept
+            {
+                std::unique_lock<std::mutex> lock(m_watchdogMutex);
+                m_tickDone.wait(lock, [this]() { return !m_ticking; });
+                m_connection = nullptr;
+                m_keepAliveActive = false;
+                m_deadlines.clear();
+            }
+
+          private:
+            struct WakeTask
+            {
+                struct aws_task task;
+                std::shared_ptr<ConnectionWatchdog> watchdog;
+                std::chrono::steady_clock::time_point wakeAt;
+            };
+
+            static void s_onWake(struct aws_task *task, void *arg, enum aws_task_status status) noexcept
+            {
+                (void)task;
+                auto *wakeTask = static_cast<WakeTask *>(arg);
+                std::shared_ptr<ConnectionWatchdog> watchdog = std::move(wakeTask->watchdog);
+                std::chrono::steady_clock::time_point wakeAt = wakeTask->wakeAt;
+                Crt::Delete(wakeTask, watchdog->m_allocator);
+
+                std::unique_lock<std::mutex> lock(watchdog->m_watchdogMutex);
+                watchdog->m_pendingWakes -= 1;
+                if (wakeAt == watchdog->m_earliestWake)
+                {
+                    watchdog->m_earliestWake = std::chrono::steady_clock::time_point::max();
+                }
+
+                if (watchdog->m_connection == nullptr)
+                {
+                    return;
+                }
+
+                /* The event loop is shutting down, so nothing further can be scheduled on it. */
+                if (status != AWS_TASK_STATUS_RUN_READY)
+                {
+                    return;
+                }
+
+                watchdog->Tick(lock);
+            }
+
+            void Tick(std::unique_lock<std::mutex> &lock) noexcept
+            {
+                auto now = std::chrono::steady_clock::now();
+                bool sendPing = false;
+                bool pingTimedOut = false;
+                if (m_keepAliveActive)
+                {
+                    if (m_pingOutstanding && now >= m_pingDeadline)
+                    {
+                        pingTimedOut = true;
+                        m_keepAliveActive = false;
+                        m_pingOutstanding = false;
+                    }
+                    else if (!m_pingOutstanding && now >= m_nextPing)
+                    {
+                        sendPing = true;
+                        m_pingOutstanding = true;
+                        m_pingDeadline = now + m_keepAliveTimeout;
+                        m_nextPing = now + m_keepAliveInterval;
+                    }
+                }
+
+                Crt::Vector<ClientOperation *> expired;
+                for (auto it = m_deadlines.begin(); it != m_deadlines.end();)
+                {
+                    if (it->second <= now)
+                    {
+                        expired.push_back(it->first);
+                        it = m_deadlines.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+
+                /* Nothing is called with the lock held, since the connection and operations take their own locks
+                 * and call back into the watchdog. Operations and the connection wait for `m_ticking` to clear
+                 * before they are destroyed. */
+                ClientConnection *connection = m_connection;
+                m_ticking = true;
+                lock.unlock();
+
+                if (pingTimedOut)
+                {
+                    AWS_LOGF_WARN(
+                        AWS_LS_EVENT_STREAM_RPC_CLIENT, "A keepalive ping went unanswered, closing the connection.");
+                    connection->CloseWithReason({EVENT_STREAM_RPC_TIMED_OUT, AWS_IO_SOCKET_TIMEOUT});
+                }
+                else if (sendPing)
+                {
+                    connection->SendKeepAlivePing();
+                }
+
+                for (ClientOperation *operation : expired)
+                {
+                    operation->OnRequestTimedOut();
+                }
+
+                lock.lock();
+                m_ticking = false;
+                m_tickDone.notify_all();
+
+                if (m_keepAliveActive)
+                {
+                    ScheduleWakeLocked(m_pingOutstanding ? m_pingDeadline : m_nextPing);
+                }
+                for (const auto &deadline : m_deadlines)
+                {
+                    ScheduleWakeLocked(deadline.second);
+                }
+            }
+
+            /* Timers only ever get added: a wake is scheduled if it is earlier than every pending one, and a wake that
+             * finds nothing due simply schedules the next one. */
+            void ScheduleWakeLocked(std::chrono::steady_clock::time_point wakeAt) noexcept
+            {
+                /* Requests activated before the first connection attempt have no event loop to be timed on, and
+                 * fail without a response anyway. */
+                if (m_eventLoop == nullptr || (m_pendingWakes > 0 && wakeAt >= m_earliestWake))
+                {
+                    return;
+                }
+
+                auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    wakeAt - std::chrono::steady_clock::now());
+                uint64_t runAt = 0;
+                aws_event_loop_current_clock_time(m_eventLoop, &runAt);
+                runAt += static_cast<uint64_t>((std::max)(delay.count(), static_cast<decltype(delay.count())>(0)));
+
+                auto *wakeTask = Crt::New<WakeTask>(m_allocator);
+                wakeTask->watchdog = shared_from_this();
+                wakeTask->wakeAt = wakeAt;
+                aws_task_init(&wakeTask->task, s_onWake, wakeTask, "EventStreamRpcConnectionWatchdog");
+                aws_event_loop_schedule_task_future(m_eventLoop, &wakeTask->task, runAt);
+                m_pendingWakes += 1;
+                m_earliestWake = wakeAt;
+            }
+
+            Crt::Allocator *m_allocator;
+            struct aws_event_loop *m_eventLoop;
+            /* This mutex protects everything below it. */
+            std::mutex m_watchdogMutex;
+            std::condition_variable m_tickDone;
+            ClientConnection *m_connection;
+            bool m_keepAliveActive;
+            bool m_pingOutstanding;
+            std::chrono::milliseconds m_keepAliveInterval;
+            std::chrono::milliseconds m_keepAliveTimeout;
+            std::chrono::steady_clock::time_point m_nextPing;
+            std::chrono::steady_clock::time_point m_pingDeadline;
+            Crt::Map<ClientOperation *, std::chrono::steady_clock::time_point> m_deadlines;
+            size_t m_pendingWakes;
+            std::chrono::steady_clock::time_point m_earliestWake;
+            bool m_ticking;
+        };
+
         MessageAmendment::MessageAmendment(Crt::Allocator *allocator) noexcept
             : m_headers(), m_payload(), m_allocator(allocator)
         {
@@ -117,6 +372,15 @@ namespace Aws
             }
         }
 
+        /* Stack storage for the native headers of an outgoing message, which nearly always has only a few. */
+        struct NativeHeadersStorage
+        {
+            static constexpr size_t INLINE_HEADER_COUNT = 8;
+            struct aws_event_stream_header_value_pair headers[INLINE_HEADER_COUNT];
+        };
+
+        constexpr size_t NativeHeadersStorage::INLINE_HEADER_COUNT;
+
         class EventStreamCppToNativeCrtBuilder
         {
           private:
@@ -125,11 +389,27 @@ namespace Aws
             static int s_fillNativeHeadersArray(
                 const Crt::List<EventStreamHeader> &headers,
                 struct aws_array_list *headersArray,
+                NativeHeadersStorage &inlineStorage,
+                MessageArena &messageArena,
                 Crt::Allocator *m_allocator = Crt::g_allocator)
             {
                 AWS_ZERO_STRUCT(*headersArray);
-                /* Check if the connection has expired before attempting to send. */
-                int errorCode = aws_event_stream_headers_list_init(headersArray, m_allocator);
+                int errorCode = AWS_OP_SUCCESS;
+                if (headers.size() <= NativeHeadersStorage::INLINE_HEADER_COUNT)
+                {
+                    aws_array_list_init_static(
+                        headersArray,
+                        inlineStorage.headers,
+                        NativeHeadersStorage::INLINE_HEADER_COUNT,
+                        sizeof(struct aws_event_stream_header_value_pair));
+                    messageArena.CountOutgoingMessage(0);
+                }
+                else
+                {
+                    errorCode = aws_event_stream_headers_list_init(headersArray, m_allocator);
+                    messageArena.CountOutgoingMessage(
+                        headers.size() * sizeof(struct aws_event_stream_header_value_pair));
+                }
 
                 if (!errorCode)
                 {
@@ -151,6 +431,16 @@ namespace Aws
 
         ClientConnection &ClientConnection::operator=(ClientConnection &&rhs) noexcept
         {
+            if (m_watchdog != nullptr)
+            {
+                m_watchdog->Detach();
+            }
+            m_watchdog = std::move(rhs.m_watchdog);
+            rhs.m_watchdog = nullptr;
+            if (m_watchdog != nullptr)
+            {
+                m_watchdog->SetConnection(this);
+            }
             m_allocator = std::move(rhs.m_allocator);
             m_underlyingConnection = rhs.m_underlyingConnection;
             rhs.m_stateMutex.lock();
@@ -174,7 +464,9 @@ namespace Aws
             return *this;
         }
 
-        ClientConnection::ClientConnection(ClientConnection &&rhs) noexcept : m_lifecycleHandler(rhs.m_lifecycleHandler)
+        ClientConnection::ClientConnection(ClientConnection &&rhs) noexcept
+            : m_lifecycleHandler(rhs.m_lifecycleHandler), m_watchdog(),
+              m_messageArena(Crt::MakeShared<MessageArena>(rhs.m_allocator, rhs.m_allocator))
         {
             *this = std::move(rhs);
         }
@@ -182,7 +474,9 @@ namespace Aws
         ClientConnection::ClientConnection(Crt::Allocator *allocator) noexcept
             : m_allocator(allocator), m_underlyingConnection(nullptr), m_clientState(DISCONNECTED),
               m_lifecycleHandler(nullptr), m_connectMessageAmender(nullptr), m_connectionWillSetup(false),
-              m_onConnectRequestCallback(nullptr)
+              m_onConnectRequestCallback(nullptr),
+              m_watchdog(Crt::MakeShared<ConnectionWatchdog>(allocator, this, allocator)),
+              m_messageArena(Crt::MakeShared<MessageArena>(allocator, allocator))
         {
         }
 
@@ -206,6 +500,11 @@ namespace Aws
             m_stateMutex.unlock();
 
             m_underlyingConnection = nullptr;
+            if (m_watchdog != nullptr)
+            {
+                m_watchdog->Detach();
+                m_watchdog.reset();
+            }
         }
 
         bool ConnectionLifecycleHandler::OnErrorCallback(RpcError error)
@@ -256,9 +555,15 @@ namespace Aws
                 case EVENT_STREAM_RPC_UNSUPPORTED_CONTENT_TYPE:
                     return "EVENT_STREAM_RPC_UNSUPPORTED_CONTENT_TYPE";
                 case EVENT_STREAM_RPC_CRT_ERROR:
+                {
                     Crt::String ret = "Failed with EVENT_STREAM_RPC_CRT_ERROR, the CRT error was ";
                     ret += Crt::ErrorDebugString(crtError);
                     return ret;
+                }
+                case EVENT_STREAM_RPC_TIMED_OUT:
+                    return "EVENT_STREAM_RPC_TIMED_OUT";
+                case EVENT_STREAM_RPC_PAYLOAD_TOO_LARGE:
+                    return "EVENT_STREAM_RPC_PAYLOAD_TOO_LARGE";
             }
             return "Unknown status code";
         }
@@ -315,6 +620,17 @@ namespace Aws
                 }
 
                 connOptions.bootstrap = clientBootstrap.GetUnderlyingHandle();
+
+                /* A connection that has been moved from gets a watchdog of its own. */
+                if (m_watchdog == nullptr)
+                {
+                    m_watchdog = Crt::MakeShared<ConnectionWatchdog>(m_allocator, this, m_allocator);
+                }
+                if (m_watchdog != nullptr)
+                {
+                    m_watchdog->BindEventLoop(
+                        aws_event_loop_group_get_next_loop(clientBootstrap.GetUnderlyingHandle()->event_loop_group));
+                }
             }
 
             if (baseError)
@@ -459,12 +775,13 @@ namespace Aws
             std::promise<RpcError> onFlushPromise;
             OnMessageFlushCallbackContainer *callbackContainer = nullptr;
             struct aws_array_list headersArray;
+            NativeHeadersStorage headersStorage;
 
             /* The caller should never pass a NULL connection. */
             AWS_PRECONDITION(connection != nullptr);
 
             int errorCode = EventStreamCppToNativeCrtBuilder::s_fillNativeHeadersArray(
-                headers, &headersArray, connection->m_allocator);
+                headers, &headersArray, headersStorage, *connection->m_messageArena, connection->m_allocator);
 
             if (!errorCode)
             {
@@ -537,6 +854,28 @@ namespace Aws
             }
         }
 
+        void ClientConnection::CloseWithReason(RpcError reason) noexcept
+        {
+            const std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
+            if (m_clientState != CONNECTED)
+            {
+                return;
+            }
+
+            m_closeReason = reason;
+            m_clientState = DISCONNECTING;
+            aws_event_stream_rpc_client_connection_close(m_underlyingConnection, reason.crtError);
+        }
+
+        void ClientConnection::SendKeepAlivePing() noexcept
+        {
+            const std::lock_guard<std::recursive_mutex> lock(m_stateMutex);
+            if (m_clientState == CONNECTED)
+            {
+                (void)s_sendPing(this, Crt::List<EventStreamHeader>(), Crt::Optional<Crt::ByteBuf>(), nullptr);
+            }
+        }
+
         EventStreamHeader::EventStreamHeader(
             const struct aws_event_stream_header_value_pair &header,
             Crt::Allocator *allocator)
@@ -714,6 +1053,10 @@ namespace Aws
             }
 
             thisConnection->m_underlyingConnection = nullptr;
+            if (thisConnection->m_watchdog != nullptr)
+            {
+                thisConnection->m_watchdog->StopKeepAlive();
+            }
 
             if (thisConnection->m_closeReason.baseStatus != EVENT_STREAM_RPC_UNINITIALIZED &&
                 !thisConnection->m_onConnectCalled)
@@ -725,7 +1068,11 @@ namespace Aws
 
             if (thisConnection->m_onConnectCalled)
             {
-                if (errorCode)
+                if (thisConnection->m_closeReason.baseStatus == EVENT_STREAM_RPC_TIMED_OUT)
+                {
+                    thisConnection->m_lifecycleHandler->OnDisconnectCallback(thisConnection->m_closeReason);
+                }
+                else if (errorCode)
                 {
                     thisConnection->m_lifecycleHandler->OnDisconnectCallback({EVENT_STREAM_RPC_CRT_ERROR, errorCode});
                 }
@@ -760,7 +1107,9 @@ namespace Aws
 
             /* The `userData` pointer is used to pass `this` of a `ClientConnection` object. */
             auto *thisConnection = static_cast<ClientConnection *>(userData);
-            Crt::List<EventStreamHeader> pingHeaders;
+            thisConnection->m_messageArena->BeginMessage();
+            Crt::List<EventStreamHeader> pingHeaders(
+                Crt::StlAllocator<EventStreamHeader>(thisConnection->m_messageArena->GetAllocator()));
 
             switch (messageArgs->message_type)
             {
@@ -773,6 +1122,9 @@ namespace Aws
                             thisConnection->m_clientState = CONNECTED;
                             thisConnection->m_onConnectCalled = true;
                             thisConnection->m_connectAckedPromise.set_value({EVENT_STREAM_RPC_SUCCESS, 0});
+                            thisConnection->m_watchdog->StartKeepAlive(
+                                thisConnection->m_connectionConfig.GetKeepAliveInterval(),
+                                thisConnection->m_connectionConfig.GetKeepAliveTimeout());
                             thisConnection->m_lifecycleHandler->OnConnectCallback();
                         }
                         else
@@ -809,7 +1161,7 @@ namespace Aws
                     break;
 
                 case AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_PING_RESPONSE:
-                    return;
+                    thisConnection->m_watchdog->OnPingResponse();
                     break;
 
                 case AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_PROTOCOL_ERROR:
@@ -841,11 +1193,212 @@ namespace Aws
                 Crt::Delete<AbstractShapeBase>(shape, shape->m_allocator);
         }
 
+        /* Every pooled block is preceded by a header recording its size class, so that a release can find the free
+         * list the block belongs to. The header is padded so that the block keeps the alignment of the allocation. */
+        union ShapeBlockHeader
+        {
+            size_t sizeClass;
+            std::max_align_t alignment;
+        };
+
+        constexpr size_t ShapeAllocationPool::MAX_POOLED_BLOCK_SIZE;
+        constexpr size_t ShapeAllocationPool::SIZE_CLASS_GRANULARITY;
+        constexpr size_t ShapeAllocationPool::SIZE_CLASS_COUNT;
+
+        ShapeAllocationPool::ShapeAllocationPool(Crt::Allocator *allocator, size_t maxCachedBlocksPerSize) noexcept
+            : m_allocator(allocator), m_maxCachedBlocksPerSize(maxCachedBlocksPerSize),
+              m_ownerThread(std::thread::id()), m_missCount(0)
+        {
+            AWS_ZERO_STRUCT(m_poolAllocator);
+            m_poolAllocator.mem_acquire = ShapeAllocationPool::s_memAcquire;
+            m_poolAllocator.mem_release = ShapeAllocationPool::s_memRelease;
+            m_poolAllocator.impl = this;
+
+            for (size_t i = 0; i < SIZE_CLASS_COUNT; ++i)
+            {
+                m_freeLists[i] = nullptr;
+                m_freeListLengths[i] = 0;
+            }
+        }
+
+        ShapeAllocationPool::~ShapeAllocationPool() noexcept
+        {
+            for (size_t i = 0; i < SIZE_CLASS_COUNT; ++i)
+            {
+                while (m_freeLists[i] != nullptr)
+                {
+                    void *block = m_freeLists[i];
+                    m_freeLists[i] = *static_cast<void **>(block);
+                    aws_mem_release(m_allocator, static_cast<ShapeBlockHeader *>(block) - 1);
+                }
+            }
+        }
+
+        bool ShapeAllocationPool::IsOwnerThread() noexcept
+        {
+            std::thread::id self = std::this_thread::get_id();
+            std::thread::id owner = m_ownerThread.load();
+            if (owner == std::thread::id() && m_ownerThread.compare_exchange_strong(owner, self))
+            {
+                return true;
+            }
+            return owner == self;
+        }
+
+        void *ShapeAllocationPool::s_memAcquire(struct aws_allocator *allocator, size_t size)
+        {
+            auto *pool = static_cast<ShapeAllocationPool *>(allocator->impl);
+
+            size_t sizeClass = (size == 0) ? 0 : (size - 1) / SIZE_CLASS_GRANULARITY;
+            size_t blockSize = size;
+            if (sizeClass < SIZE_CLASS_COUNT)
+            {
+                void *block = pool->IsOwnerThread() ? pool->m_freeLists[sizeClass] : nullptr;
+                if (block != nullptr)
+                {
+                    pool->m_freeLists[sizeClass] = *static_cast<void **>(block);
+                    pool->m_freeListLengths[sizeClass] -= 1;
+                    return block;
+                }
+                /* Round up so that the block can be reused by any allocation of the same size class. */
+                blockSize = (sizeClass + 1) * SIZE_CLASS_GRANULARITY;
+            }
+            else
+            {
+                sizeClass = SIZE_CLASS_COUNT;
+            }
+
+            pool->m_missCount.fetch_add(1);
+            auto *header = static_cast<ShapeBlockHeader *>(
+                aws_mem_acquire(pool->m_allocator, sizeof(ShapeBlockHeader) + blockSize));
+            if (header == nullptr)
+            {
+                return nullptr;
+            }
+            header->sizeClass = sizeClass;
+            return header + 1;
+        }
+
+        void ShapeAllocationPool::s_memRelease(struct aws_allocator *allocator, void *ptr)
+        {
+            auto *pool = static_cast<ShapeAllocationPool *>(allocator->impl);
+            auto *header = static_cast<ShapeBlockHeader *>(ptr) - 1;
+
+            size_t sizeClass = header->sizeClass;
+            if (sizeClass < SIZE_CLASS_COUNT && pool->IsOwnerThread() &&
+                pool->m_freeListLengths[sizeClass] < pool->m_maxCachedBlocksPerSize)
+            {
+                *static_cast<void **>(ptr) = pool->m_freeLists[sizeClass];
+                pool->m_freeLists[sizeClass] = ptr;
+                pool->m_freeListLengths[sizeClass] += 1;
+                return;
+            }
+
+            aws_mem_release(pool->m_allocator, header);
+        }
+
+        MessageArena::MessageArena(Crt::Allocator *allocator, size_t capacity) noexcept
+            : m_allocator(allocator), m_block(nullptr), m_capacity(capacity), m_offset(0),
+              m_ownerThread(std::thread::id()), m_liveAllocations(0), m_messages(0), m_allocations(0), m_bytes(0),
+              m_overflowAllocations(0)
+        {
+            AWS_ZERO_STRUCT(m_arenaAllocator);
+            m_arenaAllocator.mem_acquire = MessageArena::s_memAcquire;
+            m_arenaAllocator.mem_release = MessageArena::s_memRelease;
+            m_arenaAllocator.impl = this;
+
+            if (m_allocator != nullptr && m_capacity > 0)
+            {
+                m_block = static_cast<uint8_t *>(aws_mem_acquire(m_allocator, m_capacity));
+            }
+            if (m_block == nullptr)
+            {
+                m_capacity = 0;
+            }
+        }
+
+        MessageArena::~MessageArena() noexcept
+        {
+            if (m_block != nullptr)
+            {
+                aws_mem_release(m_allocator, m_block);
+            }
+        }
+
+        void MessageArena::BeginMessage() noexcept
+        {
+            m_ownerThread.store(std::this_thread::get_id());
+            m_messages.fetch_add(1);
+            /* Anything still allocated from the arena was kept by a handler, so it cannot be reused yet. */
+            if (m_liveAllocations.load() == 0)
+            {
+                m_offset = 0;
+            }
+        }
+
+        void MessageArena::CountOutgoingMessage(size_t heapBytes) noexcept
+        {
+            m_messages.fetch_add(1);
+            /* The arena never serves outgoing messages, so their allocations are not overflow. */
+            if (heapBytes > 0)
+            {
+                m_allocations.fetch_add(1);
+                m_bytes.fetch_add(heapBytes);
+            }
+        }
+
+        MessageAllocationStats MessageArena::GetStats() const noexcept
+        {
+            MessageAllocationStats stats;
+            stats.messages = m_messages.load();
+            stats.allocations = m_allocations.load();
+            stats.bytes = m_bytes.load();
+            stats.overflowAllocations = m_overflowAllocations.load();
+            return stats;
+        }
+
+        void *MessageArena::s_memAcquire(struct aws_allocator *allocator, size_t size)
+        {
+            auto *arena = static_cast<MessageArena *>(allocator->impl);
+            arena->m_allocations.fetch_add(1);
+            arena->m_bytes.fetch_add(size);
+
+            if (arena->m_block != nullptr && arena->m_ownerThread.load() == std::this_thread::get_id())
+            {
+                const size_t alignment = alignof(std::max_align_t);
+                size_t offset = (arena->m_offset + alignment - 1) & ~(alignment - 1);
+                if (offset <= arena->m_capacity && size <= arena->m_capacity - offset)
+                {
+                    arena->m_offset = offset + size;
+                    arena->m_liveAllocations.fetch_add(1);
+                    return arena->m_block + offset;
+                }
+            }
+
+            arena->m_overflowAllocations.fetch_add(1);
+            return aws_mem_acquire(arena->m_allocator, size);
+        }
+
+        void MessageArena::s_memRelease(struct aws_allocator *allocator, void *ptr)
+        {
+            auto *arena = static_cast<MessageArena *>(allocator->impl);
+            auto *bytes = static_cast<uint8_t *>(ptr);
+            if (arena->m_block != nullptr && bytes >= arena->m_block && bytes < arena->m_block + arena->m_capacity)
+            {
+                arena->m_liveAllocations.fetch_sub(1);
+                return;
+            }
+
+            aws_mem_release(arena->m_allocator, ptr);
+        }
+
         ClientContinuation::ClientContinuation(
             ClientConnection *connection,
             ClientContinuationHandler &continuationHandler,
             Crt::Allocator *allocator) noexcept
-            : m_allocator(allocator), m_continuationHandler(continuationHandler), m_continuationToken(nullptr)
+            : m_allocator(allocator), m_connection(connection), m_messageArena(connection->m_messageArena),
+              m_continuationHandler(continuationHandler), m_continuationToken(nullptr), m_callbackData(nullptr),
+              m_activated(false)
         {
             struct aws_event_stream_rpc_client_stream_continuation_options options;
             options.on_continuation = ClientContinuation::s_onContinuationMessage;
@@ -878,14 +1431,91 @@ namespace Aws
             }
             if (m_callbackData != nullptr)
             {
+                /* Stop admitting callbacks, then wait for any callback that was already admitted to return. */
+                m_callbackData->WaitForCallbacks(true);
+                Crt::Delete<ContinuationCallbackData>(m_callbackData, m_allocator);
+            }
+        }
+
+        constexpr uint32_t ContinuationCallbackData::STATE_DESTROYED;
+        constexpr uint32_t ContinuationCallbackData::STATE_WAITING;
+        constexpr uint32_t ContinuationCallbackData::STATE_CALLBACK;
+
+        bool ContinuationCallbackData::EnterCallback() noexcept
+        {
+            return (m_state.fetch_add(STATE_CALLBACK) & STATE_DESTROYED) == 0;
+        }
+
+        void ContinuationCallbackData::LeaveCallback() noexcept
+        {
+            /* The callback that drains the count clears the waiting flag, so that the waiter is signalled once. */
+            uint32_t state = m_state.load();
+            uint32_t next = 0;
+            do
+            {
+                next = state - STATE_CALLBACK;
+                if (next < STATE_CALLBACK)
                 {
-                    const std::lock_guard<std::mutex> lock(m_callbackData->callbackMutex);
-                    m_callbackData->continuationDestroyed = true;
+                    next &= ~STATE_WAITING;
                 }
-                Crt::Delete<ContinuationCallbackData>(m_callbackData, m_allocator);
+            } while (!m_state.compare_exchange_weak(state, next));
+
+            if ((state & STATE_WAITING) != 0 && (next & STATE_WAITING) == 0)
+            {
+                /* The waiter cannot return until this lock is released, so the callback data outlives it. */
+                const std::lock_guard<std::mutex> lock(m_drainMutex);
+                m_drained = true;
+                m_drainSignal.notify_one();
+            }
+        }
+
+        void ContinuationCallbackData::WaitForCallbacks(bool stopAdmitting) noexcept
+        {
+            std::unique_lock<std::mutex> lock(m_drainMutex);
+            m_drained = false;
+
+            /* Only wait if a callback is in flight; the last one to leave will then signal. */
+            uint32_t state = m_state.load();
+            uint32_t next = 0;
+            do
+            {
+                next = state | (stopAdmitting ? STATE_DESTROYED : 0);
+                if (state >= STATE_CALLBACK)
+                {
+                    next |= STATE_WAITING;
+                }
+            } while (!m_state.compare_exchange_weak(state, next));
+
+            if ((next & STATE_WAITING) != 0)
+            {
+                m_drainSignal.wait(lock, [this]() { return m_drained; });
             }
         }
 
+        /**
+         * Admits a callback into a continuation unless the continuation is being destroyed.
+         *
+         * Admission costs an atomic operation on entry and another on exit, and never blocks. The drain lock is
+         * only taken by the last callback to leave while the continuation waits for callbacks to drain.
+         */
+        class ContinuationDispatchGuard final
+        {
+          public:
+            explicit ContinuationDispatchGuard(ContinuationCallbackData *callbackData) noexcept
+                : m_callbackData(callbackData), m_admitted(callbackData->EnterCallback())
+            {
+            }
+            ~ContinuationDispatchGuard() noexcept { m_callbackData->LeaveCallback(); }
+            ContinuationDispatchGuard(const ContinuationDispatchGuard &) = delete;
+            ContinuationDispatchGuard &operator=(const ContinuationDispatchGuard &) = delete;
+
+            bool IsAdmitted() const noexcept { return m_admitted; }
+
+          private:
+            ContinuationCallbackData *m_callbackData;
+            bool m_admitted;
+        };
+
         void ClientContinuation::s_onContinuationMessage(
             struct aws_event_stream_rpc_client_continuation_token *continuationToken,
             const struct aws_event_stream_rpc_message_args *messageArgs,
@@ -896,7 +1526,16 @@ namespace Aws
             auto *callbackData = static_cast<ContinuationCallbackData *>(userData);
             auto *thisContinuation = callbackData->clientContinuation;
 
-            Crt::List<EventStreamHeader> continuationMessageHeaders;
+            const ContinuationDispatchGuard dispatchGuard(callbackData);
+            if (!dispatchGuard.IsAdmitted())
+                return;
+            AWS_IOT_TRACE_START(span, EventstreamRpc);
+
+            /* Continuation messages are delivered on the connection's event loop thread. */
+            MessageArena &messageArena = *thisContinuation->m_messageArena;
+            messageArena.BeginMessage();
+            Crt::List<EventStreamHeader> continuationMessageHeaders(
+                Crt::StlAllocator<EventStreamHeader>(messageArena.GetAllocator()));
             for (size_t i = 0; i < messageArgs->headers_count; ++i)
             {
                 continuationMessageHeaders.emplace_back(
@@ -913,12 +1552,11 @@ namespace Aws
             {
                 payload = Crt::Optional<Crt::ByteBuf>();
             }
+            AWS_IOT_TRACE_MARK(span, ResponseReceived);
 
-            const std::lock_guard<std::mutex> lock(callbackData->callbackMutex);
-            if (callbackData->continuationDestroyed)
-                return;
             thisContinuation->m_continuationHandler.OnContinuationMessage(
                 continuationMessageHeaders, payload, messageArgs->message_type, messageArgs->message_flags);
+            AWS_IOT_TRACE_MARK(span, HandlerDone);
         }
 
         void ClientContinuation::s_onContinuationClosed(
@@ -930,12 +1568,56 @@ namespace Aws
             /* The `userData` pointer is used to pass a `ContinuationCallbackData` object. */
             auto *callbackData = static_cast<ContinuationCallbackData *>(userData);
 
-            const std::lock_guard<std::mutex> lock(callbackData->callbackMutex);
-            if (callbackData->continuationDestroyed)
+            const ContinuationDispatchGuard dispatchGuard(callbackData);
+            if (!dispatchGuard.IsAdmitted())
                 return;
 
             auto *thisContinuation = callbackData->clientContinuation;
             thisContinuation->m_continuationHandler.OnContinuationClosed();
+            callbackData->streamClosed.store(true);
+        }
+
+        bool ClientContinuation::Reopen() noexcept
+        {
+            if (m_continuationToken != nullptr && !m_activated)
+            {
+                return true;
+            }
+
+            if (m_continuationToken != nullptr)
+            {
+                if (!m_callbackData->streamClosed.load())
+                {
+                    return false;
+                }
+                /* The closed callback is the last one a stream delivers, so once it has returned the callback data
+                 * can be handed to a new stream. */
+                m_callbackData->WaitForCallbacks(false);
+                aws_event_stream_rpc_client_continuation_release(m_continuationToken);
+                m_continuationToken = nullptr;
+                m_activated = false;
+            }
+
+            if (!m_connection->IsOpen())
+            {
+                return false;
+            }
+
+            if (m_callbackData == nullptr)
+            {
+                m_callbackData = Crt::New<ContinuationCallbackData>(m_allocator, this, m_allocator);
+                m_continuationHandler.m_callbackData = m_callbackData;
+            }
+            m_callbackData->streamClosed.store(false);
+
+            struct aws_event_stream_rpc_client_stream_continuation_options options;
+            options.on_continuation = ClientContinuation::s_onContinuationMessage;
+            options.on_continuation_closed = ClientContinuation::s_onContinuationClosed;
+            options.user_data = reinterpret_cast<void *>(m_callbackData);
+
+            m_continuationToken =
+                aws_event_stream_rpc_client_connection_new_stream(m_connection->m_underlyingConnection, &options);
+            return m_continuationToken != nullptr;
         }
 
         std::future<RpcError> ClientContinuation::Activate(
@@ -962,8 +1644,9 @@ namespace Aws
                 return onFlushPromise.get_future();
             }
 
-            int errorCode =
-                EventStreamCppToNativeCrtBuilder::s_fillNativeHeadersArray(headers, &headersArray, m_allocator);
+            NativeHeadersStorage headersStorage;
+            int errorCode = EventStreamCppToNativeCrtBuilder::s_fillNativeHeadersArray(
+                headers, &headersArray, headersStorage, *m_messageArena, m_allocator);
 
             /*
              * Regardless of how the promise gets moved around (or not), this future should stay valid as a return
@@ -995,6 +1678,10 @@ namespace Aws
                     &msg_args,
                     ClientConnection::s_protocolMessageCallback,
                     reinterpret_cast<void *>(callbackContainer));
+                if (!errorCode)
+                {
+                    m_activated = true;
+                }
             }
 
             /* Cleanup. */
@@ -1030,8 +1717,9 @@ namespace Aws
                 return onFlushPromise.get_future();
             }
 
-            int errorCode =
-                EventStreamCppToNativeCrtBuilder::s_fillNativeHeadersArray(headers, &headersArray, m_allocator);
+            NativeHeadersStorage headersStorage;
+            int errorCode = EventStreamCppToNativeCrtBuilder::s_fillNativeHeadersArray(
+                headers, &headersArray, headersStorage, *m_messageArena, m_allocator);
 
             if (!errorCode)
             {
@@ -1109,13 +1797,22 @@ namespace Aws
             const OperationModelContext &operationModelContext,
             Crt::Allocator *allocator) noexcept
             : m_operationModelContext(operationModelContext), m_asyncLaunchMode(std::launch::deferred),
-              m_messageCount(0), m_allocator(allocator), m_streamHandler(streamHandler),
-              m_clientContinuation(connection.NewStream(*this)), m_expectedCloses(0), m_streamClosedCalled(false)
+              m_messageCount(0), m_allocator(allocator), m_connection(connection), m_watchdog(connection.m_watchdog),
+              m_requestTimeout(0), m_initialResponseModelName(operationModelContext.GetInitialResponseModelName()),
+              m_streamingResponseModelName(operationModelContext.GetStreamingResponseModelName()),
+              m_streamHandler(streamHandler), m_streamingShapePool(allocator),
+              m_clientContinuation(connection.NewStream(*this)), m_resultReceived(false), m_expectedCloses(0),
+              m_streamClosedCalled(false), m_streamEnded(false)
         {
         }
 
         ClientOperation::~ClientOperation() noexcept
         {
+            std::shared_ptr<ConnectionWatchdog> watchdog = m_watchdog.lock();
+            if (watchdog != nullptr)
+            {
+                watchdog->UnwatchRequest(this, true);
+            }
             Close().wait();
             std::unique_lock<std::mutex> lock(m_continuationMutex);
             m_closeReady.wait(lock, [this] { return m_expectedCloses.load() == 0; });
@@ -1214,32 +1911,59 @@ namespace Aws
 
         std::future<TaggedResult> ClientOperation::GetOperationResult() noexcept
         {
+            if (m_clientContinuation.IsClosed() && !m_resultReceived.exchange(true))
             {
-                const std::lock_guard<std::mutex> lock(m_continuationMutex);
-
-                if (m_clientContinuation.IsClosed() && !m_resultReceived)
-                {
-                    AWS_LOGF_ERROR(AWS_LS_EVENT_STREAM_RPC_CLIENT, "The underlying stream is already closed.");
-                    m_initialResponsePromise.set_value(TaggedResult({EVENT_STREAM_RPC_CONNECTION_CLOSED, 0}));
-                    m_resultReceived = true;
-                }
+                AWS_LOGF_ERROR(AWS_LS_EVENT_STREAM_RPC_CLIENT, "The underlying stream is already closed.");
+                m_initialResponsePromise.set_value(TaggedResult({EVENT_STREAM_RPC_CONNECTION_CLOSED, 0}));
             }
 
             return m_initialResponsePromise.get_future();
         }
 
-        const EventStreamHeader *ClientOperation::GetHeaderByName(
+        /* Compares a header name in place, without constructing a string from it. */
+        static bool s_headerNameEquals(const EventStreamHeader &header, const char *name, size_t nameLength) noexcept
+        {
+            const struct aws_event_stream_header_value_pair *handle = header.GetUnderlyingHandle();
+            return handle->header_name_len == nameLength && memcmp(handle->header_name, name, nameLength) == 0;
+        }
+
+        /* Compares a string header value in place, without constructing a string from it. */
+        static bool s_headerValueEquals(const EventStreamHeader &header, const char *value, size_t valueLength) noexcept
+        {
+            const struct aws_event_stream_header_value_pair *handle = header.GetUnderlyingHandle();
+            return handle->header_value_type == AWS_EVENT_STREAM_HEADER_STRING &&
+                   handle->header_value_len == valueLength &&
+                   (valueLength == 0 || memcmp(handle->header_value.variable_len_val, value, valueLength) == 0);
+        }
+
+        void ClientOperation::s_indexHeaders(
             const Crt::List<EventStreamHeader> &headers,
-            const Crt::String &name) noexcept
+            const EventStreamHeader *&modelHeader,
+            const EventStreamHeader *&contentHeader) noexcept
         {
-            for (auto it = headers.begin(); it != headers.end(); ++it)
+            static const size_t s_modelHeaderLength = strlen(SERVICE_MODEL_TYPE_HEADER);
+            static const size_t s_contentHeaderLength = strlen(CONTENT_TYPE_HEADER);
+
+            modelHeader = nullptr;
+            contentHeader = nullptr;
+            for (const auto &header : headers)
             {
-                if (name == it->GetHeaderName())
+                if (modelHeader == nullptr &&
+                    s_headerNameEquals(header, SERVICE_MODEL_TYPE_HEADER, s_modelHeaderLength))
+                {
+                    modelHeader = &header;
+                }
+                else if (
+                    contentHeader == nullptr && s_headerNameEquals(header, CONTENT_TYPE_HEADER, s_contentHeaderLength))
                 {
-                    return &(*it);
+                    contentHeader = &header;
+                }
+
+                if (modelHeader != nullptr && contentHeader != nullptr)
+                {
+                    break;
                 }
             }
-            return nullptr;
         }
 
         EventStreamRpcStatusCode ClientOperation::HandleData(const Crt::Optional<Crt::ByteBuf> &payload)
@@ -1260,7 +1984,10 @@ namespace Aws
             }
             else
             {
-                response = m_operationModelContext.AllocateStreamingResponseFromPayload(payloadStringView, m_allocator);
+                /* Streaming responses are freed as soon as the stream handler returns, so they are served from the
+                 * operation's pool rather than from the general allocator. */
+                response = m_operationModelContext.AllocateStreamingResponseFromPayload(
+                    payloadStringView, m_streamingShapePool.GetAllocator());
             }
 
             if (response.get() == nullptr)
@@ -1271,9 +1998,11 @@ namespace Aws
 
             if (m_messageCount == 1)
             {
-                const std::lock_guard<std::mutex> lock(m_continuationMutex);
-                m_resultReceived = true;
-                m_initialResponsePromise.set_value(TaggedResult(std::move(response)));
+                /* The result has already been delivered if the request timed out. */
+                if (!m_resultReceived.exchange(true))
+                {
+                    m_initialResponsePromise.set_value(TaggedResult(std::move(response)));
+                }
             }
             else
             {
@@ -1285,7 +2014,7 @@ namespace Aws
         }
 
         EventStreamRpcStatusCode ClientOperation::HandleError(
-            const Crt::String &modelName,
+            Crt::StringView modelName,
             const Crt::Optional<Crt::ByteBuf> &payload,
             uint32_t messageFlags)
         {
@@ -1300,7 +2029,7 @@ namespace Aws
             /* The value of this hashmap contains the function that allocates the error from the
              * payload. */
             Crt::ScopedResource<OperationError> error =
-                m_operationModelContext.AllocateOperationErrorFromPayload(modelName, payloadStringView, m_allocator);
+                m_operationModelContext.AllocateOperationErrorFromModelName(modelName, payloadStringView, m_allocator);
             if (error.get() == nullptr)
                 return EVENT_STREAM_RPC_UNMAPPED_DATA;
             if (error->GetMessage().has_value())
@@ -1313,9 +2042,8 @@ namespace Aws
             TaggedResult taggedResult(std::move(error));
             if (m_messageCount == 1)
             {
+                if (!m_resultReceived.exchange(true))
                 {
-                    const std::lock_guard<std::mutex> lock(m_continuationMutex);
-                    m_resultReceived = true;
                     m_initialResponsePromise.set_value(std::move(taggedResult));
                 }
                 /* Close the stream unless the server already closed it for us. This condition is checked
@@ -1361,17 +2089,18 @@ namespace Aws
             EventStreamRpcStatusCode errorCode = EVENT_STREAM_RPC_SUCCESS;
             const EventStreamHeader *modelHeader = nullptr;
             const EventStreamHeader *contentHeader = nullptr;
-            Crt::String modelName;
+            Crt::StringView modelName;
 
             if (messageFlags & AWS_EVENT_STREAM_RPC_MESSAGE_FLAG_TERMINATE_STREAM)
             {
                 const std::lock_guard<std::mutex> lock(m_continuationMutex);
                 m_expectedCloses.fetch_add(1);
+                m_streamEnded.store(true);
             }
 
             m_messageCount += 1;
 
-            modelHeader = GetHeaderByName(headers, Crt::String(SERVICE_MODEL_TYPE_HEADER));
+            s_indexHeaders(headers, modelHeader, contentHeader);
             if (modelHeader == nullptr)
             {
                 /* Missing required service model type header. */
@@ -1385,32 +2114,49 @@ namespace Aws
             /* Verify that the model name matches. */
             if (!errorCode)
             {
-                modelHeader->GetValueAsString(modelName);
                 if (messageType == AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_MESSAGE)
                 {
-                    if (m_messageCount == 1 && m_operationModelContext.GetInitialResponseModelName() != modelName)
+                    if (m_messageCount == 1)
                     {
-                        AWS_LOGF_ERROR(
-                            AWS_LS_EVENT_STREAM_RPC_CLIENT,
-                            "The model name of the initial response did not match its expected model name.");
-                        errorCode = EVENT_STREAM_RPC_UNMAPPED_DATA;
+                        if (!s_headerValueEquals(
+                                *modelHeader, m_initialResponseModelName.c_str(), m_initialResponseModelName.length()))
+                        {
+                            AWS_LOGF_ERROR(
+                                AWS_LS_EVENT_STREAM_RPC_CLIENT,
+                                "The model name of the initial response did not match its expected model name.");
+                            errorCode = EVENT_STREAM_RPC_UNMAPPED_DATA;
+                        }
                     }
-                    else if (
-                        m_messageCount > 1 && m_operationModelContext.GetStreamingResponseModelName().has_value() &&
-                        m_operationModelContext.GetStreamingResponseModelName().value() != modelName)
+                    else
                     {
-                        AWS_LOGF_ERROR(
-                            AWS_LS_EVENT_STREAM_RPC_CLIENT,
-                            "The model name of a subsequent response did not match its expected model name.");
-                        errorCode = EVENT_STREAM_RPC_UNMAPPED_DATA;
+                        if (m_streamingResponseModelName.has_value() &&
+                            !s_headerValueEquals(
+                                *modelHeader,
+                                m_streamingResponseModelName.value().c_str(),
+                                m_streamingResponseModelName.value().length()))
+                        {
+                            AWS_LOGF_ERROR(
+                                AWS_LS_EVENT_STREAM_RPC_CLIENT,
+                                "The model name of a subsequent response did not match its expected model name.");
+                            errorCode = EVENT_STREAM_RPC_UNMAPPED_DATA;
+                        }
+                    }
+                }
+                else
+                {
+                    /* Errors look up their factory by the model name, which is viewed in place in the header. */
+                    const struct aws_event_stream_header_value_pair *modelHandle = modelHeader->GetUnderlyingHandle();
+                    if (modelHandle->header_value_type == AWS_EVENT_STREAM_HEADER_STRING)
+                    {
+                        modelName = Crt::StringView(
+                            reinterpret_cast<const char *>(modelHandle->header_value.variable_len_val),
+                            modelHandle->header_value_len);
                     }
                 }
             }
 
             if (!errorCode)
             {
-                Crt::String contentType;
-                contentHeader = GetHeaderByName(headers, Crt::String(CONTENT_TYPE_HEADER));
                 if (contentHeader == nullptr)
                 {
                     /* Missing required content type header. */
@@ -1420,9 +2166,13 @@ namespace Aws
                         CONTENT_TYPE_HEADER);
                     errorCode = EVENT_STREAM_RPC_UNSUPPORTED_CONTENT_TYPE;
                 }
-                else if (contentHeader->GetValueAsString(contentType) && contentType != CONTENT_TYPE_APPLICATION_JSON)
+                else if (
+                    contentHeader->GetUnderlyingHandle()->header_value_type == AWS_EVENT_STREAM_HEADER_STRING &&
+                    !s_headerValueEquals(
+                        *contentHeader, CONTENT_TYPE_APPLICATION_JSON, strlen(CONTENT_TYPE_APPLICATION_JSON)))
                 {
-                    /* Missing required content type header. */
+                    Crt::String contentType;
+                    contentHeader->GetValueAsString(contentType);
                     AWS_LOGF_ERROR(
                         AWS_LS_EVENT_STREAM_RPC_CLIENT,
                         "The content type (%s) header was specified with an unsupported value (%s).",
@@ -1432,6 +2182,21 @@ namespace Aws
                 }
             }
 
+            if (!errorCode && payload.has_value())
+            {
+                /* Reject oversized payloads before they are copied and parsed. */
+                size_t maxPayloadSize = m_connection.m_connectionConfig.GetMaxPayloadSize();
+                if (maxPayloadSize > 0 && payload.value().len > maxPayloadSize)
+                {
+                    AWS_LOGF_ERROR(
+                        AWS_LS_EVENT_STREAM_RPC_CLIENT,
+                        "The response payload (%zu bytes) exceeds the maximum payload size (%zu bytes).",
+                        payload.value().len,
+                        maxPayloadSize);
+                    errorCode = EVENT_STREAM_RPC_PAYLOAD_TOO_LARGE;
+                }
+            }
+
             if (!errorCode)
             {
                 if (messageType == AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_MESSAGE)
@@ -1444,14 +2209,24 @@ namespace Aws
                 }
             }
 
+            if (m_messageCount == 1)
+            {
+                std::shared_ptr<ConnectionWatchdog> watchdog = m_watchdog.lock();
+                if (watchdog != nullptr)
+                {
+                    watchdog->UnwatchRequest(this, false);
+                }
+            }
+
             if (errorCode)
             {
                 if (m_messageCount == 1)
                 {
-                    const std::lock_guard<std::mutex> lock(m_continuationMutex);
-                    m_resultReceived = true;
-                    RpcError promiseValue = {(EventStreamRpcStatusCode)errorCode, 0};
-                    m_initialResponsePromise.set_value(TaggedResult(promiseValue));
+                    if (!m_resultReceived.exchange(true))
+                    {
+                        RpcError promiseValue = {(EventStreamRpcStatusCode)errorCode, 0};
+                        m_initialResponsePromise.set_value(TaggedResult(promiseValue));
+                    }
                 }
                 else
                 {
@@ -1470,40 +2245,146 @@ namespace Aws
             const AbstractShapeBase *shape,
             OnMessageFlushCallback onMessageFlushCallback) noexcept
         {
+            AWS_IOT_TRACE_START(span, EventstreamRpc);
+            Crt::String payloadString;
+            {
+                /* Release the JSON tree before the payload is copied into the outgoing message, so that a large
+                 * payload is not resident three times at once. */
+                Crt::JsonObject payloadObject;
+                shape->SerializeToJsonObject(payloadObject);
+                payloadString = payloadObject.View().WriteCompact();
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+            if (m_streamHandler)
+            {
+                /* Streams are re-established with the same request if the connection is lost. */
+                m_replayPayload = payloadString;
+            }
+#ifdef AWS_IOT_SDK_TRACING
+            onMessageFlushCallback = [onMessageFlushCallback, span](int errorCode) {
+                AWS_IOT_TRACE_MARK(span, PubAck);
+                if (onMessageFlushCallback)
+                {
+                    onMessageFlushCallback(errorCode);
+                }
+            };
+#endif
+            std::future<RpcError> activated = ActivatePayload(payloadString, onMessageFlushCallback);
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            return activated;
+        }
+
+        std::future<RpcError> ClientOperation::Replay() noexcept
+        {
+            std::promise<RpcError> errorPromise;
+            if (m_replayPayload.empty() || m_streamEnded.load())
+            {
+                /* The stream was closed on purpose, so there is nothing to replay. */
+                errorPromise.set_value({EVENT_STREAM_RPC_CONTINUATION_CLOSED, 0});
+                return errorPromise.get_future();
+            }
+
+            if (!Reset())
+            {
+                /* A new stream could not be opened, typically because the connection was lost again. */
+                errorPromise.set_value({EVENT_STREAM_RPC_CONNECTION_CLOSED, 0});
+                return errorPromise.get_future();
+            }
+
+            return ActivatePayload(m_replayPayload, nullptr);
+        }
+
+        std::future<RpcError> ClientOperation::ActivatePayload(
+            const Crt::String &payloadString,
+            OnMessageFlushCallback onMessageFlushCallback) noexcept
+        {
+            /* The operation may have outlived the client that created it. */
+            std::shared_ptr<ConnectionWatchdog> watchdog = m_watchdog.lock();
+            if (watchdog == nullptr || !watchdog->IsAttached())
+            {
+                std::promise<RpcError> errorPromise;
+                errorPromise.set_value({EVENT_STREAM_RPC_CONNECTION_CLOSED, 0});
+                return errorPromise.get_future();
+            }
+
+            size_t maxPayloadSize = m_connection.m_connectionConfig.GetMaxPayloadSize();
+            if (maxPayloadSize > 0 && payloadString.length() > maxPayloadSize)
+            {
+                AWS_LOGF_ERROR(
+                    AWS_LS_EVENT_STREAM_RPC_CLIENT,
+                    "The request payload (%zu bytes) exceeds the maximum payload size (%zu bytes).",
+                    payloadString.length(),
+                    maxPayloadSize);
+                std::promise<RpcError> errorPromise;
+                errorPromise.set_value({EVENT_STREAM_RPC_PAYLOAD_TOO_LARGE, 0});
+                return errorPromise.get_future();
+            }
+
             /* Promises must be reset in case the client would like to send a subsequent request with the same
              * `ClientOperation`. */
             m_initialResponsePromise = {};
+            m_resultReceived.store(false);
+            m_streamEnded.store(false);
+
+            if (m_requestHeaders.empty())
             {
-                const std::lock_guard<std::mutex> lock(m_continuationMutex);
-                m_resultReceived = false;
+                m_operationName = GetModelName();
+                m_requestHeaders.emplace_back(EventStreamHeader(
+                    Crt::String(CONTENT_TYPE_HEADER), Crt::String(CONTENT_TYPE_APPLICATION_JSON), m_allocator));
+                m_requestHeaders.emplace_back(
+                    EventStreamHeader(Crt::String(SERVICE_MODEL_TYPE_HEADER), m_operationName, m_allocator));
+            }
+
+            std::chrono::milliseconds requestTimeout = m_requestTimeout;
+            if (requestTimeout.count() <= 0)
+            {
+                requestTimeout = m_connection.m_connectionConfig.GetRequestTimeout();
+            }
+            if (requestTimeout.count() > 0)
+            {
+                watchdog->WatchRequest(this, std::chrono::steady_clock::now() + requestTimeout);
             }
 
-            Crt::List<EventStreamHeader> headers;
-            headers.emplace_back(EventStreamHeader(
-                Crt::String(CONTENT_TYPE_HEADER), Crt::String(CONTENT_TYPE_APPLICATION_JSON), m_allocator));
-            headers.emplace_back(
-                EventStreamHeader(Crt::String(SERVICE_MODEL_TYPE_HEADER), GetModelName(), m_allocator));
-            Crt::JsonObject payloadObject;
-            shape->SerializeToJsonObject(payloadObject);
-            Crt::String payloadString = payloadObject.View().WriteCompact();
             return m_clientContinuation.Activate(
-                GetModelName(),
-                headers,
+                m_operationName,
+                m_requestHeaders,
                 Crt::ByteBufFromCString(payloadString.c_str()),
                 AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_MESSAGE,
                 0,
                 onMessageFlushCallback);
         }
 
+        void ClientOperation::OnRequestTimedOut() noexcept
+        {
+            if (m_resultReceived.exchange(true))
+            {
+                return;
+            }
+            m_initialResponsePromise.set_value(TaggedResult({EVENT_STREAM_RPC_TIMED_OUT, 0}));
+
+            AWS_LOGF_WARN(
+                AWS_LS_EVENT_STREAM_RPC_CLIENT,
+                "The response to %s did not arrive in time, closing its stream.",
+                m_operationName.c_str());
+            /* The result has been delivered, so a late response is dropped rather than waited for. */
+            (void)Close();
+        }
+
         void ClientOperation::OnContinuationClosed()
         {
-            const std::lock_guard<std::mutex> lock(m_continuationMutex);
-            if (!m_resultReceived)
+            std::shared_ptr<ConnectionWatchdog> watchdog = m_watchdog.lock();
+            if (watchdog != nullptr)
+            {
+                watchdog->UnwatchRequest(this, false);
+            }
+
+            if (!m_resultReceived.exchange(true))
             {
                 m_initialResponsePromise.set_value(TaggedResult({EVENT_STREAM_RPC_CONTINUATION_CLOSED, 0}));
-                m_resultReceived = true;
             }
 
+            const std::lock_guard<std::mutex> lock(m_continuationMutex);
+
             if (m_expectedCloses.load() > 0)
             {
                 m_expectedCloses.fetch_sub(1);
@@ -1518,6 +2399,24 @@ namespace Aws
 
         void ClientOperation::WithLaunchMode(std::launch mode) noexcept { m_asyncLaunchMode = mode; }
 
+        void ClientOperation::WithRequestTimeout(std::chrono::milliseconds requestTimeout) noexcept
+        {
+            m_requestTimeout = requestTimeout;
+        }
+
+        bool ClientOperation::Reset() noexcept
+        {
+            const std::lock_guard<std::mutex> lock(m_continuationMutex);
+            if (m_expectedCloses.load() > 0 || !m_clientContinuation.Reopen())
+            {
+                return false;
+            }
+
+            m_messageCount = 0;
+            m_streamClosedCalled.store(false);
+            return true;
+        }
+
         std::future<RpcError> ClientOperation::Close(OnMessageFlushCallback onMessageFlushCallback) noexcept
         {
             const std::lock_guard<std::mutex> lock(m_continuationMutex);
@@ -1569,6 +2468,7 @@ namespace Aws
                 else
                 {
                     m_expectedCloses.fetch_add(1);
+                    m_streamEnded.store(true);
                     return callbackContainer->onFlushPromise.get_future();
                 }
 
@@ -1581,5 +2481,239 @@ namespace Aws
             AbstractShapeBase::s_customDeleter(shape);
         }
 
+        ClientReconnector::ClientReconnector(
+            ClientConnection &connection,
+            Crt::Io::ClientBootstrap &clientBootstrap) noexcept
+            : m_connection(connection), m_clientBootstrap(clientBootstrap), m_lifecycleHandler(nullptr),
+              m_enabled(false), m_closing(false), m_reconnectPending(false), m_metrics()
+        {
+        }
+
+        ClientReconnector::~ClientReconnector() noexcept { Close(); }
+
+        void ClientReconnector::Enable(const ReconnectOptions &options) noexcept
+        {
+            const std::lock_guard<std::mutex> lock(m_reconnectMutex);
+            m_options = options;
+            m_enabled = true;
+        }
+
+        std::future<RpcError> ClientReconnector::Connect(
+            const ConnectionConfig &connectionConfig,
+            ConnectionLifecycleHandler *lifecycleHandler) noexcept
+        {
+            {
+                const std::lock_guard<std::mutex> lock(m_reconnectMutex);
+                m_connectionConfig = connectionConfig;
+                m_lifecycleHandler = lifecycleHandler;
+                m_closing = false;
+                if (m_enabled && !m_reconnectThread.joinable())
+                {
+                    m_reconnectThread = std::thread(&ClientReconnector::Run, this);
+                }
+            }
+
+            return m_connection.Connect(connectionConfig, this, m_clientBootstrap);
+        }
+
+        void ClientReconnector::Close() noexcept
+        {
+            {
+                const std::lock_guard<std::mutex> lock(m_reconnectMutex);
+                m_closing = true;
+                m_reconnectPending = false;
+            }
+            m_reconnectSignal.notify_all();
+
+            if (m_reconnectThread.joinable())
+            {
+                /* Closing the connection resolves any connection attempt that the thread is waiting on. */
+                m_connection.Close();
+                m_reconnectThread.join();
+            }
+        }
+
+        void ClientReconnector::TrackOperation(const std::shared_ptr<ClientOperation> &operation) noexcept
+        {
+            const std::lock_guard<std::mutex> lock(m_reconnectMutex);
+            if (!m_enabled)
+            {
+                return;
+            }
+
+            m_trackedOperations.erase(
+                std::remove_if(
+                    m_trackedOperations.begin(),
+                    m_trackedOperations.end(),
+                    [](const std::weak_ptr<ClientOperation> &tracked) { return tracked.expired(); }),
+                m_trackedOperations.end());
+            m_trackedOperations.push_back(operation);
+        }
+
+        ReconnectMetrics ClientReconnector::GetMetrics() const noexcept
+        {
+            const std::lock_guard<std::mutex> lock(m_reconnectMutex);
+            return m_metrics;
+        }
+
+        void ClientReconnector::OnConnectCallback()
+        {
+            if (m_lifecycleHandler)
+            {
+                m_lifecycleHandler->OnConnectCallback();
+            }
+        }
+
+        void ClientReconnector::OnDisconnectCallback(RpcError status)
+        {
+            {
+                const std::lock_guard<std::mutex> lock(m_reconnectMutex);
+                if (m_enabled && !m_closing)
+                {
+                    m_reconnectPending = true;
+                    m_disconnectTime = std::chrono::steady_clock::now();
+                }
+            }
+            m_reconnectSignal.notify_all();
+
+            if (m_lifecycleHandler)
+            {
+                m_lifecycleHandler->OnDisconnectCallback(status);
+            }
+        }
+
+        bool ClientReconnector::OnErrorCallback(RpcError status)
+        {
+            if (m_lifecycleHandler)
+            {
+                return m_lifecycleHandler->OnErrorCallback(status);
+            }
+            return ConnectionLifecycleHandler::OnErrorCallback(status);
+        }
+
+        void ClientReconnector::OnPingCallback(
+            const Crt::List<EventStreamHeader> &headers,
+            const Crt::Optional<Crt::ByteBuf> &payload)
+        {
+            if (m_lifecycleHandler)
+            {
+                m_lifecycleHandler->OnPingCallback(headers, payload);
+            }
+        }
+
+        void ClientReconnector::Run() noexcept
+        {
+            std::unique_lock<std::mutex> lock(m_reconnectMutex);
+            while (!m_closing)
+            {
+                m_reconnectSignal.wait(lock, [this]() { return m_closing || m_reconnectPending; });
+                if (m_closing)
+                {
+                    break;
+                }
+
+                /* A loss of the connection while recovering sets this again, starting another recovery. */
+                m_reconnectPending = false;
+                std::chrono::steady_clock::time_point disconnectTime = m_disconnectTime;
+                std::chrono::milliseconds backoff = m_options.GetMinBackoff();
+                uint32_t attempts = 0;
+                bool reconnected = false;
+
+                while (!reconnected)
+                {
+                    if (m_reconnectSignal.wait_for(lock, backoff, [this]() { return m_closing; }))
+                    {
+                        break;
+                    }
+
+                    attempts += 1;
+                    ConnectionConfig connectionConfig = m_connectionConfig;
+                    lock.unlock();
+                    RpcError connectStatus = m_connection.Connect(connectionConfig, this, m_clientBootstrap).get();
+                    lock.lock();
+
+                    /* The connection may also have been re-established by the user in the meantime. */
+                    if (connectStatus || connectStatus.baseStatus == EVENT_STREAM_RPC_CONNECTION_ALREADY_ESTABLISHED)
+                    {
+                        reconnected = true;
+                    }
+                    else
+                    {
+                        AWS_LOGF_WARN(
+                            AWS_LS_EVENT_STREAM_RPC_CLIENT,
+                            "Reconnection attempt %u failed: %s",
+                            attempts,
+                            connectStatus.StatusToString().c_str());
+                        backoff = (std::min)(backoff * 2, m_options.GetMaxBackoff());
+                    }
+                }
+
+                if (!reconnected)
+                {
+                    continue;
+                }
+
+                lock.unlock();
+                ReplayOperations();
+                lock.lock();
+
+                auto timeToRecover = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - disconnectTime);
+                m_metrics.reconnectCount += 1;
+                m_metrics.lastReconnectAttempts = attempts;
+                m_metrics.lastTimeToRecover = timeToRecover;
+                m_metrics.maxTimeToRecover = (std::max)(m_metrics.maxTimeToRecover, timeToRecover);
+                AWS_LOGF_INFO(
+                    AWS_LS_EVENT_STREAM_RPC_CLIENT,
+                    "Connection recovered after %u attempts in %lld ms",
+                    attempts,
+                    static_cast<long long>(timeToRecover.count()));
+            }
+        }
+
+        void ClientReconnector::ReplayOperations() noexcept
+        {
+            Crt::Vector<std::shared_ptr<ClientOperation>> operations;
+            {
+                const std::lock_guard<std::mutex> lock(m_reconnectMutex);
+                for (const auto &tracked : m_trackedOperations)
+                {
+                    std::shared_ptr<ClientOperation> operation = tracked.lock();
+                    if (operation)
+                    {
+                        operations.push_back(std::move(operation));
+                    }
+                }
+            }
+
+            /* Activate every stream before waiting on any of them so that they are re-established together. */
+            Crt::Vector<std::future<RpcError>> activations;
+            activations.reserve(operations.size());
+            for (auto &operation : operations)
+            {
+                activations.push_back(operation->Replay());
+            }
+
+            uint32_t replayed = 0;
+            uint32_t failures = 0;
+            for (auto &activation : activations)
+            {
+                RpcError activationStatus = activation.get();
+                if (activationStatus)
+                {
+                    replayed += 1;
+                }
+                else if (activationStatus.baseStatus != EVENT_STREAM_RPC_CONTINUATION_CLOSED)
+                {
+                    /* Streams that were closed on purpose are skipped rather than counted as failures. */
+                    failures += 1;
+                }
+            }
+
+            const std::lock_guard<std::mutex> lock(m_reconnectMutex);
+            m_metrics.streamsReplayed += replayed;
+            m_metrics.streamReplayFailures += failures;
+        }
+
     } /* namespace Eventstreamrpc */
 } // namespace Aws
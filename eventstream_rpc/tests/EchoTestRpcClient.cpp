@@ -14,24 +14,42 @@ namespace Awstest
     EchoTestRpcClient::EchoTestRpcClient(
         Aws::Crt::Io::ClientBootstrap &clientBootstrap,
         Aws::Crt::Allocator *allocator) noexcept
-        : m_connection(allocator), m_clientBootstrap(clientBootstrap), m_allocator(allocator),
-          m_asyncLaunchMode(std::launch::deferred)
+        : m_connection(allocator), m_clientBootstrap(clientBootstrap), m_reconnector(m_connection, clientBootstrap),
+          m_allocator(allocator), m_asyncLaunchMode(std::launch::deferred)
     {
-        m_echoTestRpcServiceModel.AssignModelNameToErrorResponse(
-            Aws::Crt::String("awstest#ServiceError"), ServiceError::s_allocateFromPayload);
     }
 
     std::future<RpcError> EchoTestRpcClient::Connect(
         ConnectionLifecycleHandler &lifecycleHandler,
         const ConnectionConfig &connectionConfig) noexcept
     {
+        if (m_reconnector.IsEnabled())
+        {
+            return m_reconnector.Connect(connectionConfig, &lifecycleHandler);
+        }
         return m_connection.Connect(connectionConfig, &lifecycleHandler, m_clientBootstrap);
     }
 
-    void EchoTestRpcClient::Close() noexcept { m_connection.Close(); }
+    void EchoTestRpcClient::Close() noexcept
+    {
+        m_reconnector.Close();
+        m_connection.Close();
+    }
 
     void EchoTestRpcClient::WithLaunchMode(std::launch mode) noexcept { m_asyncLaunchMode = mode; }
 
+    void EchoTestRpcClient::WithAutoReconnect(const ReconnectOptions &options) noexcept
+    {
+        m_reconnector.Enable(options);
+    }
+
+    ReconnectMetrics EchoTestRpcClient::GetReconnectMetrics() const noexcept { return m_reconnector.GetMetrics(); }
+
+    MessageAllocationStats EchoTestRpcClient::GetMessageAllocationStats() const noexcept
+    {
+        return m_connection.GetMessageAllocationStats();
+    }
+
     EchoTestRpcClient::~EchoTestRpcClient() noexcept { Close(); }
 
     std::shared_ptr<GetAllProductsOperation> EchoTestRpcClient::NewGetAllProducts() noexcept
@@ -53,23 +71,27 @@ namespace Awstest
     std::shared_ptr<CauseStreamServiceToErrorOperation> EchoTestRpcClient::NewCauseStreamServiceToError(
         std::shared_ptr<CauseStreamServiceToErrorStreamHandler> streamHandler) noexcept
     {
-        return Aws::Crt::MakeShared<CauseStreamServiceToErrorOperation>(
+        auto operation = Aws::Crt::MakeShared<CauseStreamServiceToErrorOperation>(
             m_allocator,
             m_connection,
             std::move(streamHandler),
             m_echoTestRpcServiceModel.m_causeStreamServiceToErrorOperationContext,
             m_allocator);
+        m_reconnector.TrackOperation(operation);
+        return operation;
     }
 
     std::shared_ptr<EchoStreamMessagesOperation> EchoTestRpcClient::NewEchoStreamMessages(
         std::shared_ptr<EchoStreamMessagesStreamHandler> streamHandler) noexcept
     {
-        return Aws::Crt::MakeShared<EchoStreamMessagesOperation>(
+        auto operation = Aws::Crt::MakeShared<EchoStreamMessagesOperation>(
             m_allocator,
             m_connection,
             std::move(streamHandler),
             m_echoTestRpcServiceModel.m_echoStreamMessagesOperationContext,
             m_allocator);
+        m_reconnector.TrackOperation(operation);
+        return operation;
     }
 
     std::shared_ptr<EchoMessageOperation> EchoTestRpcClient::NewEchoMessage() noexcept
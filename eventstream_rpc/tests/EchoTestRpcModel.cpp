@@ -42,8 +42,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<Product> shape(Aws::Crt::New<Product>(allocator), Product::s_customDeleter);
@@ -90,8 +90,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<Pair> shape(Aws::Crt::New<Pair>(allocator), Pair::s_customDeleter);
@@ -146,8 +146,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<Customer> shape(Aws::Crt::New<Customer>(allocator), Customer::s_customDeleter);
@@ -256,10 +256,11 @@ namespace Awstest
         }
         if (jsonView.ValueExists("blobMessage"))
         {
-            if (jsonView.GetString("blobMessage").size() > 0)
+            Aws::Crt::String encodedBlobMessage = jsonView.GetString("blobMessage");
+            if (encodedBlobMessage.size() > 0)
             {
-                messageData.m_blobMessage = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                    Aws::Crt::Base64Decode(jsonView.GetString("blobMessage")));
+                messageData.m_blobMessage =
+                    Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedBlobMessage));
             }
         }
         if (jsonView.ValueExists("stringListMessage"))
@@ -349,8 +350,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<MessageData> shape(
@@ -425,8 +426,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<EchoStreamingMessage> shape(
@@ -474,8 +475,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<ServiceError> shape(
@@ -534,8 +535,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<GetAllProductsResponse> shape(
@@ -572,8 +573,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<GetAllProductsRequest> shape(
@@ -634,8 +635,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<GetAllCustomersResponse> shape(
@@ -675,8 +676,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<GetAllCustomersRequest> shape(
@@ -713,8 +714,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<EchoStreamingResponse> shape(
@@ -751,8 +752,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<EchoStreamingRequest> shape(
@@ -797,8 +798,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<EchoMessageResponse> shape(
@@ -843,8 +844,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<EchoMessageRequest> shape(
@@ -884,8 +885,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<CauseServiceErrorResponse> shape(
@@ -925,8 +926,8 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) noexcept
     {
-        Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-        Aws::Crt::JsonObject jsonObject(payload);
+        Aws::Crt::JsonObject jsonObject(
+            Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
         Aws::Crt::JsonView jsonView(jsonObject);
 
         Aws::Crt::ScopedResource<CauseServiceErrorRequest> shape(
@@ -1399,7 +1400,29 @@ namespace Awstest
         Aws::Crt::StringView stringView,
         Aws::Crt::Allocator *allocator) const noexcept
     {
-        auto it = m_modelNameToErrorResponse.find(errorModelName);
+        return AllocateOperationErrorFromModelName(
+            Aws::Crt::StringView(errorModelName.data(), errorModelName.size()), stringView, allocator);
+    }
+
+    Aws::Crt::ScopedResource<OperationError> EchoTestRpcServiceModel::AllocateOperationErrorFromModelName(
+        Aws::Crt::StringView errorModelName,
+        Aws::Crt::StringView stringView,
+        Aws::Crt::Allocator *allocator) const noexcept
+    {
+        switch (HashModelName(errorModelName))
+        {
+            case HashModelName("awstest#ServiceError"):
+                if (errorModelName == Aws::Crt::StringView(ServiceError::MODEL_NAME))
+                {
+                    return ServiceError::s_allocateFromPayload(stringView, allocator);
+                }
+                break;
+            default:
+                break;
+        }
+
+        /* Only factories assigned at runtime need the name copied, to look them up. */
+        auto it = m_modelNameToErrorResponse.find(Aws::Crt::String(errorModelName.data(), errorModelName.size()));
         if (it == m_modelNameToErrorResponse.end())
         {
             return nullptr;
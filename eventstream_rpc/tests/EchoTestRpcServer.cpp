@@ -0,0 +1,435 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "EchoTestRpcServer.h"
+
+#include <aws/crt/UUID.h>
+
+#include <string.h>
+
+#include <algorithm>
+
+constexpr auto CONTENT_TYPE_HEADER = ":content-type";
+constexpr auto CONTENT_TYPE_APPLICATION_JSON = "application/json";
+constexpr auto SERVICE_MODEL_TYPE_HEADER = "service-model-type";
+constexpr auto CLIENT_NAME_HEADER = "client-name";
+constexpr auto ACCEPTED_CLIENT_NAME_PREFIX = "accepted.";
+
+namespace Awstest
+{
+    struct EchoTestRpcServer::StreamState
+    {
+        EchoTestRpcServer *server;
+        struct aws_event_stream_rpc_server_continuation_token *token;
+        Aws::Crt::String operationName;
+        bool requestReceived;
+    };
+
+    EchoTestRpcServer::EchoTestRpcServer(
+        Aws::Crt::Io::EventLoopGroup &eventLoopGroup,
+        Aws::Crt::Allocator *allocator) noexcept
+        : m_allocator(allocator), m_eventLoopGroup(eventLoopGroup), m_serverBootstrap(nullptr), m_listener(nullptr),
+          m_unresponsive(false)
+    {
+        m_socketOptions.SetSocketDomain(Aws::Crt::Io::SocketDomain::Local);
+        m_socketOptions.SetSocketType(Aws::Crt::Io::SocketType::Stream);
+    }
+
+    EchoTestRpcServer::~EchoTestRpcServer() noexcept { Stop(); }
+
+    bool EchoTestRpcServer::Start(const Aws::Crt::String &socketPath) noexcept
+    {
+        if (m_listener != nullptr)
+        {
+            return true;
+        }
+
+        m_socketPath = socketPath;
+        if (m_socketPath.empty())
+        {
+#if defined(_WIN32)
+            m_socketPath = Aws::Crt::String("\\\\.\\pipe\\echo-test-rpc-") + Aws::Crt::UUID().ToString();
+#else
+            m_socketPath = Aws::Crt::String("/tmp/echo-test-rpc-") + Aws::Crt::UUID().ToString() + ".sock";
+#endif
+        }
+
+        m_serverBootstrap = aws_server_bootstrap_new(m_allocator, m_eventLoopGroup.GetUnderlyingHandle());
+        if (m_serverBootstrap == nullptr)
+        {
+            return false;
+        }
+
+        struct aws_event_stream_rpc_server_listener_options listenerOptions;
+        AWS_ZERO_STRUCT(listenerOptions);
+        listenerOptions.host_name = m_socketPath.c_str();
+        listenerOptions.port = 0;
+        listenerOptions.socket_options = &m_socketOptions.GetImpl();
+        listenerOptions.bootstrap = m_serverBootstrap;
+        listenerOptions.on_new_connection = s_onNewConnection;
+        listenerOptions.on_connection_shutdown = s_onConnectionShutdown;
+        listenerOptions.on_destroy_callback = s_onListenerDestroy;
+        listenerOptions.user_data = this;
+
+        m_listenerDestroyedPromise = std::promise<void>();
+        m_listener = aws_event_stream_rpc_server_new_listener(m_allocator, &listenerOptions);
+        if (m_listener == nullptr)
+        {
+            aws_server_bootstrap_release(m_serverBootstrap);
+            m_serverBootstrap = nullptr;
+            return false;
+        }
+
+        return true;
+    }
+
+    void EchoTestRpcServer::Stop() noexcept
+    {
+        if (m_listener != nullptr)
+        {
+            std::future<void> listenerDestroyed = m_listenerDestroyedPromise.get_future();
+            aws_event_stream_rpc_server_listener_release(m_listener);
+            listenerDestroyed.wait();
+            m_listener = nullptr;
+        }
+
+        if (m_serverBootstrap != nullptr)
+        {
+            aws_server_bootstrap_release(m_serverBootstrap);
+            m_serverBootstrap = nullptr;
+        }
+    }
+
+    ConnectionConfig EchoTestRpcServer::GetConnectionConfig() const noexcept
+    {
+        ConnectionConfig connectionConfig;
+        connectionConfig.SetHostName(m_socketPath);
+        connectionConfig.SetPort(0);
+        connectionConfig.SetSocketOptions(m_socketOptions);
+        MessageAmendment connectAmendment;
+        connectAmendment.AddHeader(EventStreamHeader(
+            Aws::Crt::String(CLIENT_NAME_HEADER), Aws::Crt::String("accepted.testy_mc_testerson"), m_allocator));
+        connectionConfig.SetConnectAmendment(connectAmendment);
+        return connectionConfig;
+    }
+
+    void EchoTestRpcServer::AddStreamingOperation(
+        const Aws::Crt::String &operationName,
+        const Aws::Crt::String &responseModelName) noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_streamsMutex);
+        m_streamingOperations[operationName] = responseModelName;
+    }
+
+    size_t EchoTestRpcServer::PublishStreamMessage(const Aws::Crt::String &payload, const char *modelName) noexcept
+    {
+        size_t published = 0;
+        Aws::Crt::ByteCursor payloadCursor = Aws::Crt::ByteCursorFromCString(payload.c_str());
+
+        const std::lock_guard<std::mutex> lock(m_streamsMutex);
+        for (StreamState *stream : m_streamingStreams)
+        {
+            if (!SendOnStream(
+                    stream->token,
+                    modelName,
+                    payloadCursor,
+                    AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_MESSAGE,
+                    0))
+            {
+                published += 1;
+            }
+        }
+
+        return published;
+    }
+
+    size_t EchoTestRpcServer::CloseStreams(const char *modelName) noexcept
+    {
+        size_t closed = 0;
+
+        const std::lock_guard<std::mutex> lock(m_streamsMutex);
+        for (StreamState *stream : m_streamingStreams)
+        {
+            if (!SendOnStream(
+                    stream->token,
+                    modelName,
+                    Aws::Crt::ByteCursorFromCString("{}"),
+                    AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_MESSAGE,
+                    AWS_EVENT_STREAM_RPC_MESSAGE_FLAG_TERMINATE_STREAM))
+            {
+                closed += 1;
+            }
+        }
+
+        return closed;
+    }
+
+    size_t EchoTestRpcServer::CountOpenStreams() noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_streamsMutex);
+        return m_streamingStreams.size();
+    }
+
+    size_t EchoTestRpcServer::DropConnections() noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_streamsMutex);
+        for (struct aws_event_stream_rpc_server_connection *connection : m_connections)
+        {
+            aws_event_stream_rpc_server_connection_close(connection, AWS_IO_SOCKET_CLOSED);
+        }
+
+        return m_connections.size();
+    }
+
+    int EchoTestRpcServer::s_onNewConnection(
+        struct aws_event_stream_rpc_server_connection *connection,
+        int errorCode,
+        struct aws_event_stream_rpc_connection_options *connectionOptions,
+        void *userData) noexcept
+    {
+        if (errorCode)
+        {
+            return AWS_OP_ERR;
+        }
+
+        connectionOptions->on_connection_protocol_message = s_onProtocolMessage;
+        connectionOptions->on_incoming_stream = s_onIncomingStream;
+        connectionOptions->user_data = userData;
+
+        auto *thisServer = static_cast<EchoTestRpcServer *>(userData);
+        const std::lock_guard<std::mutex> lock(thisServer->m_streamsMutex);
+        aws_event_stream_rpc_server_connection_acquire(connection);
+        thisServer->m_connections.push_back(connection);
+        return AWS_OP_SUCCESS;
+    }
+
+    void EchoTestRpcServer::s_onConnectionShutdown(
+        struct aws_event_stream_rpc_server_connection *connection,
+        int errorCode,
+        void *userData) noexcept
+    {
+        (void)errorCode;
+        auto *thisServer = static_cast<EchoTestRpcServer *>(userData);
+        const std::lock_guard<std::mutex> lock(thisServer->m_streamsMutex);
+        auto tracked = std::find(thisServer->m_connections.begin(), thisServer->m_connections.end(), connection);
+        if (tracked != thisServer->m_connections.end())
+        {
+            thisServer->m_connections.erase(tracked);
+            aws_event_stream_rpc_server_connection_release(connection);
+        }
+    }
+
+    void EchoTestRpcServer::s_onListenerDestroy(
+        struct aws_event_stream_rpc_server_listener *listener,
+        void *userData) noexcept
+    {
+        (void)listener;
+        auto *thisServer = static_cast<EchoTestRpcServer *>(userData);
+        thisServer->m_listenerDestroyedPromise.set_value();
+    }
+
+    void EchoTestRpcServer::s_onProtocolMessage(
+        struct aws_event_stream_rpc_server_connection *connection,
+        const struct aws_event_stream_rpc_message_args *messageArgs,
+        void *userData) noexcept
+    {
+        auto *thisServer = static_cast<EchoTestRpcServer *>(userData);
+
+        struct aws_event_stream_rpc_message_args response;
+        AWS_ZERO_STRUCT(response);
+
+        if (messageArgs->message_type == AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_CONNECT)
+        {
+            /* Mirror the standalone echo server: only clients that name themselves as accepted get in. */
+            bool accepted = false;
+            for (size_t i = 0; i < messageArgs->headers_count; ++i)
+            {
+                EventStreamHeader header(messageArgs->headers[i], thisServer->m_allocator);
+                Aws::Crt::String clientName;
+                if (header.GetHeaderName() == CLIENT_NAME_HEADER && header.GetValueAsString(clientName))
+                {
+                    size_t prefixLength = strlen(ACCEPTED_CLIENT_NAME_PREFIX);
+                    accepted = clientName.compare(0, prefixLength, ACCEPTED_CLIENT_NAME_PREFIX) == 0;
+                }
+            }
+            response.message_type = AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_CONNECT_ACK;
+            response.message_flags = accepted ? AWS_EVENT_STREAM_RPC_MESSAGE_FLAG_CONNECTION_ACCEPTED : 0;
+        }
+        else if (messageArgs->message_type == AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_PING && !thisServer->m_unresponsive)
+        {
+            response.message_type = AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_PING_RESPONSE;
+        }
+        else
+        {
+            return;
+        }
+
+        aws_event_stream_rpc_server_connection_send_protocol_message(connection, &response, s_onMessageFlush, nullptr);
+    }
+
+    int EchoTestRpcServer::s_onIncomingStream(
+        struct aws_event_stream_rpc_server_connection *connection,
+        struct aws_event_stream_rpc_server_continuation_token *token,
+        struct aws_byte_cursor operationName,
+        struct aws_event_stream_rpc_server_stream_continuation_options *continuationOptions,
+        void *userData) noexcept
+    {
+        (void)connection;
+        auto *thisServer = static_cast<EchoTestRpcServer *>(userData);
+
+        auto *stream = Aws::Crt::New<StreamState>(thisServer->m_allocator);
+        if (stream == nullptr)
+        {
+            return AWS_OP_ERR;
+        }
+        stream->server = thisServer;
+        stream->token = token;
+        stream->operationName = Aws::Crt::String(reinterpret_cast<const char *>(operationName.ptr), operationName.len);
+        stream->requestReceived = false;
+        aws_event_stream_rpc_server_continuation_acquire(token);
+
+        continuationOptions->on_continuation = s_onStreamMessage;
+        continuationOptions->on_continuation_closed = s_onStreamClosed;
+        continuationOptions->user_data = stream;
+        return AWS_OP_SUCCESS;
+    }
+
+    void EchoTestRpcServer::s_onStreamMessage(
+        struct aws_event_stream_rpc_server_continuation_token *token,
+        const struct aws_event_stream_rpc_message_args *messageArgs,
+        void *userData) noexcept
+    {
+        auto *stream = static_cast<StreamState *>(userData);
+        auto *thisServer = stream->server;
+
+        /* Only the request that opens a stream is answered; later messages are the client closing it. */
+        if (stream->requestReceived || thisServer->m_unresponsive)
+        {
+            return;
+        }
+        stream->requestReceived = true;
+
+        Aws::Crt::ByteCursor requestPayload = Aws::Crt::ByteCursorFromCString("{}");
+        if (messageArgs->payload != nullptr && messageArgs->payload->len > 0)
+        {
+            requestPayload = Aws::Crt::ByteCursorFromByteBuf(*messageArgs->payload);
+        }
+
+        const Aws::Crt::String &operationName = stream->operationName;
+        Aws::Crt::String streamingResponseModelName;
+        if (operationName == "awstest#EchoStreamMessages" || operationName == "awstest#CauseStreamServiceToError")
+        {
+            streamingResponseModelName = EchoStreamingResponse::MODEL_NAME;
+        }
+        else
+        {
+            const std::lock_guard<std::mutex> lock(thisServer->m_streamsMutex);
+            auto streamingOperation = thisServer->m_streamingOperations.find(operationName);
+            if (streamingOperation != thisServer->m_streamingOperations.end())
+            {
+                streamingResponseModelName = streamingOperation->second;
+            }
+        }
+
+        if (operationName == "awstest#EchoMessage")
+        {
+            thisServer->SendOnStream(
+                token,
+                EchoMessageResponse::MODEL_NAME,
+                requestPayload,
+                AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_MESSAGE,
+                AWS_EVENT_STREAM_RPC_MESSAGE_FLAG_TERMINATE_STREAM);
+        }
+        else if (!streamingResponseModelName.empty())
+        {
+            /* The stream is registered before it is acknowledged, so that a client which publishes as soon as its
+             * initial response arrives always finds it. Holding the lock across the response also keeps an event from
+             * overtaking it. */
+            const std::lock_guard<std::mutex> lock(thisServer->m_streamsMutex);
+            thisServer->m_streamingStreams.push_back(stream);
+            thisServer->SendOnStream(
+                token,
+                streamingResponseModelName.c_str(),
+                Aws::Crt::ByteCursorFromCString("{}"),
+                AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_MESSAGE,
+                0);
+        }
+        else if (operationName == "awstest#GetAllProducts")
+        {
+            thisServer->SendOnStream(
+                token,
+                GetAllProductsResponse::MODEL_NAME,
+                Aws::Crt::ByteCursorFromCString("{}"),
+                AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_MESSAGE,
+                AWS_EVENT_STREAM_RPC_MESSAGE_FLAG_TERMINATE_STREAM);
+        }
+        else if (operationName == "awstest#GetAllCustomers")
+        {
+            thisServer->SendOnStream(
+                token,
+                GetAllCustomersResponse::MODEL_NAME,
+                Aws::Crt::ByteCursorFromCString("{}"),
+                AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_MESSAGE,
+                AWS_EVENT_STREAM_RPC_MESSAGE_FLAG_TERMINATE_STREAM);
+        }
+        else
+        {
+            /* CauseServiceError, and any operation that the echo service does not implement. */
+            thisServer->SendOnStream(
+                token,
+                ServiceError::MODEL_NAME,
+                Aws::Crt::ByteCursorFromCString("{\"message\":\"Intentionally thrown ServiceError\"}"),
+                AWS_EVENT_STREAM_RPC_MESSAGE_TYPE_APPLICATION_ERROR,
+                AWS_EVENT_STREAM_RPC_MESSAGE_FLAG_TERMINATE_STREAM);
+        }
+    }
+
+    void EchoTestRpcServer::s_onStreamClosed(
+        struct aws_event_stream_rpc_server_continuation_token *token,
+        void *userData) noexcept
+    {
+        auto *stream = static_cast<StreamState *>(userData);
+        auto *thisServer = stream->server;
+
+        {
+            const std::lock_guard<std::mutex> lock(thisServer->m_streamsMutex);
+            thisServer->m_streamingStreams.remove(stream);
+        }
+
+        aws_event_stream_rpc_server_continuation_release(token);
+        Aws::Crt::Delete(stream, thisServer->m_allocator);
+    }
+
+    void EchoTestRpcServer::s_onMessageFlush(int errorCode, void *userData) noexcept
+    {
+        (void)errorCode;
+        (void)userData;
+    }
+
+    int EchoTestRpcServer::SendOnStream(
+        struct aws_event_stream_rpc_server_continuation_token *token,
+        const char *modelName,
+        const Aws::Crt::ByteCursor &payload,
+        MessageType messageType,
+        uint32_t messageFlags) noexcept
+    {
+        EventStreamHeader contentTypeHeader(
+            Aws::Crt::String(CONTENT_TYPE_HEADER), Aws::Crt::String(CONTENT_TYPE_APPLICATION_JSON), m_allocator);
+        EventStreamHeader modelTypeHeader(
+            Aws::Crt::String(SERVICE_MODEL_TYPE_HEADER), Aws::Crt::String(modelName), m_allocator);
+        struct aws_event_stream_header_value_pair headers[2] = {
+            *contentTypeHeader.GetUnderlyingHandle(), *modelTypeHeader.GetUnderlyingHandle()};
+
+        struct aws_byte_buf payloadBuf = aws_byte_buf_from_array(payload.ptr, payload.len);
+
+        struct aws_event_stream_rpc_message_args messageArgs;
+        messageArgs.headers = headers;
+        messageArgs.headers_count = 2;
+        messageArgs.payload = &payloadBuf;
+        messageArgs.message_type = messageType;
+        messageArgs.message_flags = messageFlags;
+
+        return aws_event_stream_rpc_server_continuation_send_message(token, &messageArgs, s_onMessageFlush, nullptr);
+    }
+} // namespace Awstest
@@ -0,0 +1,153 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <awstest/EchoTestRpcClient.h>
+
+#include <aws/event-stream/event_stream_rpc_server.h>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+
+namespace Awstest
+{
+    /**
+     * An in-process implementation of the EchoTestRpc service, listening on a local (Unix domain) socket.
+     *
+     * It lets the client be exercised and measured without an external echo server:
+     * - EchoMessage responds with the payload of its request.
+     * - CauseServiceError responds with a `ServiceError`.
+     * - EchoStreamMessages and CauseStreamServiceToError acknowledge the request and keep the stream open so that
+     *   events can be pushed to it with `PublishStreamMessage`. Operations of other services can be served the same
+     *   way with `AddStreamingOperation`.
+     * - Connections are only accepted if their `client-name` header starts with `accepted.`.
+     */
+    class EchoTestRpcServer final
+    {
+      public:
+        EchoTestRpcServer(
+            Aws::Crt::Io::EventLoopGroup &eventLoopGroup,
+            Aws::Crt::Allocator *allocator = Aws::Crt::g_allocator) noexcept;
+        ~EchoTestRpcServer() noexcept;
+        EchoTestRpcServer(const EchoTestRpcServer &) = delete;
+        EchoTestRpcServer &operator=(const EchoTestRpcServer &) = delete;
+
+        /**
+         * Start listening.
+         * @param socketPath Path of the socket to listen on. A unique path is generated if this is empty.
+         * @return True if the server is listening.
+         */
+        bool Start(const Aws::Crt::String &socketPath = Aws::Crt::String()) noexcept;
+
+        /**
+         * Stop listening and wait for the listener to be torn down. Clients should be closed beforehand.
+         */
+        void Stop() noexcept;
+
+        /**
+         * @return A configuration that connects a client to this server.
+         */
+        ConnectionConfig GetConnectionConfig() const noexcept;
+
+        /**
+         * Serve a streaming operation of another service like EchoStreamMessages. Must be called before `Start`.
+         * @param operationName The operation name, such as `aws.greengrass#SubscribeToTopic`.
+         * @param responseModelName The model name of the response that acknowledges the request.
+         */
+        void AddStreamingOperation(
+            const Aws::Crt::String &operationName,
+            const Aws::Crt::String &responseModelName) noexcept;
+
+        /**
+         * Send an event with the given JSON payload to every open streaming operation.
+         * @param payload JSON encoded event.
+         * @param modelName The model name of the event.
+         * @return The number of streams that the event was queued on.
+         */
+        size_t PublishStreamMessage(
+            const Aws::Crt::String &payload,
+            const char *modelName = EchoStreamingMessage::MODEL_NAME) noexcept;
+
+        /**
+         * Terminate every open streaming operation from the server side, as a server that ends a subscription would,
+         * by sending each an empty event that terminates the stream.
+         * @param modelName The model name of the event.
+         * @return The number of streams that were terminated.
+         */
+        size_t CloseStreams(const char *modelName = EchoStreamingMessage::MODEL_NAME) noexcept;
+
+        /**
+         * @return The number of streaming operations that are open on the server.
+         */
+        size_t CountOpenStreams() noexcept;
+
+        /**
+         * Close every connection to the server while continuing to listen, as if the connections had been lost.
+         * @return The number of connections that were closed.
+         */
+        size_t DropConnections() noexcept;
+
+        /**
+         * Stop answering pings and requests while keeping connections open, as a hung server would.
+         * @param unresponsive True to stop answering, false to answer again.
+         */
+        void SetUnresponsive(bool unresponsive) noexcept { m_unresponsive.store(unresponsive); }
+
+      private:
+        struct StreamState;
+
+        static int s_onNewConnection(
+            struct aws_event_stream_rpc_server_connection *connection,
+            int errorCode,
+            struct aws_event_stream_rpc_connection_options *connectionOptions,
+            void *userData) noexcept;
+        static void s_onConnectionShutdown(
+            struct aws_event_stream_rpc_server_connection *connection,
+            int errorCode,
+            void *userData) noexcept;
+        static void s_onListenerDestroy(struct aws_event_stream_rpc_server_listener *listener, void *userData) noexcept;
+        static void s_onProtocolMessage(
+            struct aws_event_stream_rpc_server_connection *connection,
+            const struct aws_event_stream_rpc_message_args *messageArgs,
+            void *userData) noexcept;
+        static int s_onIncomingStream(
+            struct aws_event_stream_rpc_server_connection *connection,
+            struct aws_event_stream_rpc_server_continuation_token *token,
+            struct aws_byte_cursor operationName,
+            struct aws_event_stream_rpc_server_stream_continuation_options *continuationOptions,
+            void *userData) noexcept;
+        static void s_onStreamMessage(
+            struct aws_event_stream_rpc_server_continuation_token *token,
+            const struct aws_event_stream_rpc_message_args *messageArgs,
+            void *userData) noexcept;
+        static void s_onStreamClosed(
+            struct aws_event_stream_rpc_server_continuation_token *token,
+            void *userData) noexcept;
+        static void s_onMessageFlush(int errorCode, void *userData) noexcept;
+
+        int SendOnStream(
+            struct aws_event_stream_rpc_server_continuation_token *token,
+            const char *modelName,
+            const Aws::Crt::ByteCursor &payload,
+            MessageType messageType,
+            uint32_t messageFlags) noexcept;
+
+        Aws::Crt::Allocator *m_allocator;
+        Aws::Crt::Io::EventLoopGroup &m_eventLoopGroup;
+        Aws::Crt::String m_socketPath;
+        Aws::Crt::Io::SocketOptions m_socketOptions;
+        struct aws_server_bootstrap *m_serverBootstrap;
+        struct aws_event_stream_rpc_server_listener *m_listener;
+        std::promise<void> m_listenerDestroyedPromise;
+        std::atomic<bool> m_unresponsive;
+        /* Protects the connections and streams, which are modified from the event loop and read by the test. */
+        std::mutex m_streamsMutex;
+        Aws::Crt::List<struct aws_event_stream_rpc_server_connection *> m_connections;
+        Aws::Crt::List<StreamState *> m_streamingStreams;
+        /* Operation name to response model name, for the streaming operations added by `AddStreamingOperation`. */
+        Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> m_streamingOperations;
+    };
+} // namespace Awstest
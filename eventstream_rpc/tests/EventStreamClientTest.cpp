@@ -6,6 +6,8 @@
 
 #include <awstest/EchoTestRpcClient.h>
 
+#include "EchoTestRpcServer.h"
+
 #include <aws/testing/aws_test_harness.h>
 #if defined(_WIN32)
 // aws_test_harness.h includes Windows.h, which is an abomination.
@@ -14,9 +16,14 @@
 #    undef GetMessage
 #endif
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <queue>
 #include <sstream>
+#include <string>
+#include <thread>
 
 using namespace Aws::Crt;
 using namespace Aws::Eventstreamrpc;
@@ -61,6 +68,15 @@ static int s_testTeardown(struct aws_allocator *allocator, int setup_result, voi
 
 static int s_TestEventStreamConnect(struct aws_allocator *allocator, void *ctx);
 static int s_TestEchoOperation(struct aws_allocator *allocator, void *ctx);
+static int s_TestEchoOperationPipelined(struct aws_allocator *allocator, void *ctx);
+static int s_TestEchoServerInProcess(struct aws_allocator *allocator, void *ctx);
+static int s_TestReconnectReplaysStreams(struct aws_allocator *allocator, void *ctx);
+static int s_TestKeepAliveAndRequestTimeouts(struct aws_allocator *allocator, void *ctx);
+static int s_TestMaxPayloadSize(struct aws_allocator *allocator, void *ctx);
+static int s_TestMessageArenaStats(struct aws_allocator *allocator, void *ctx);
+static int s_TestOperationOutlivesClient(struct aws_allocator *allocator, void *ctx);
+static int s_TestOperationPoolReuse(struct aws_allocator *allocator, void *ctx);
+static int s_TestActivateBatch(struct aws_allocator *allocator, void *ctx);
 static int s_TestOperationWhileDisconnected(struct aws_allocator *allocator, void *ctx);
 
 class TestLifecycleHandler : public ConnectionLifecycleHandler
@@ -95,6 +111,7 @@ class TestLifecycleHandler : public ConnectionLifecycleHandler
 
   private:
     friend int s_TestEventStreamConnect(struct aws_allocator *allocator, void *ctx);
+    friend int s_TestKeepAliveAndRequestTimeouts(struct aws_allocator *allocator, void *ctx);
     std::condition_variable semaphore;
     std::mutex semaphoreLock;
     std::unique_lock<std::mutex> semaphoreULock;
@@ -197,6 +214,205 @@ static int s_TestOperationWhileDisconnected(struct aws_allocator *allocator, voi
         client.Close();
     }
 
+    /* Operations that cannot open a stream are not handed out again by a pool. */
+    {
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        ClientOperationPool<EchoMessageOperation> echoMessagePool([&client]() { return client.NewEchoMessage(); });
+        auto echoMessage = echoMessagePool.Acquire();
+        ASSERT_NOT_NULL(echoMessage.get());
+        ASSERT_FALSE(echoMessage->Reset());
+        EchoMessageOperation *released = echoMessage.get();
+        echoMessagePool.Release(std::move(echoMessage));
+        echoMessage = echoMessagePool.Acquire();
+        ASSERT_TRUE(echoMessage.get() != released);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShapeAllocationPoolRecycles, s_TestShapeAllocationPoolRecycles);
+static int s_TestShapeAllocationPoolRecycles(struct aws_allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    ApiHandle apiHandle(allocator);
+    Aws::Crt::String streamingPayload("{\"streamMessage\":{\"stringMessage\":\"Async I0 FTW\"}}");
+
+    {
+        ShapeAllocationPool pool(allocator);
+        /* Warm the pool up, then verify that steady-state allocations are served from its free lists. */
+        EchoStreamingMessage::s_allocateFromPayload(
+            Aws::Crt::ByteCursorToStringView(Aws::Crt::ByteCursorFromCString(streamingPayload.c_str())),
+            pool.GetAllocator());
+        size_t warmMisses = pool.GetMissCount();
+        ASSERT_TRUE(warmMisses > 0);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            auto shape = EchoStreamingMessage::s_allocateFromPayload(
+                Aws::Crt::ByteCursorToStringView(Aws::Crt::ByteCursorFromCString(streamingPayload.c_str())),
+                pool.GetAllocator());
+            ASSERT_NOT_NULL(shape.get());
+        }
+        ASSERT_UINT_EQUALS(warmMisses, pool.GetMissCount());
+
+        /* Blocks that are too large to pool are passed straight through to the underlying allocator. */
+        void *largeBlock = aws_mem_acquire(pool.GetAllocator(), ShapeAllocationPool::MAX_POOLED_BLOCK_SIZE * 2);
+        ASSERT_NOT_NULL(largeBlock);
+        aws_mem_release(pool.GetAllocator(), largeBlock);
+    }
+
+    {
+        /* The free lists belong to the thread that allocated first. */
+        ShapeAllocationPool pool(allocator);
+        void *block = aws_mem_acquire(pool.GetAllocator(), 64);
+        ASSERT_UINT_EQUALS(1, pool.GetMissCount());
+
+        /* A block freed on another thread goes back to the underlying allocator... */
+        std::thread([&pool, block]() { aws_mem_release(pool.GetAllocator(), block); }).join();
+        block = aws_mem_acquire(pool.GetAllocator(), 64);
+        ASSERT_UINT_EQUALS(2, pool.GetMissCount());
+
+        /* ...while one freed on the owner thread is reused. */
+        aws_mem_release(pool.GetAllocator(), block);
+        block = aws_mem_acquire(pool.GetAllocator(), 64);
+        ASSERT_UINT_EQUALS(2, pool.GetMissCount());
+
+        /* Another thread never takes from the free lists. */
+        aws_mem_release(pool.GetAllocator(), block);
+        std::thread([&pool]() { aws_mem_release(pool.GetAllocator(), aws_mem_acquire(pool.GetAllocator(), 64)); })
+            .join();
+        ASSERT_UINT_EQUALS(3, pool.GetMissCount());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ErrorModelNameDispatch, s_TestErrorModelNameDispatch);
+static int s_TestErrorModelNameDispatch(struct aws_allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    ApiHandle apiHandle(allocator);
+    EchoTestRpcServiceModel serviceModel;
+    Aws::Crt::String errorPayload("{\"message\":\"Failure\"}");
+    Aws::Crt::StringView errorPayloadView =
+        Aws::Crt::ByteCursorToStringView(Aws::Crt::ByteCursorFromCString(errorPayload.c_str()));
+
+    ASSERT_UINT_EQUALS(
+        HashModelName(ServiceError::MODEL_NAME), HashModelName(Aws::Crt::String("awstest#ServiceError")));
+
+    /* Known errors are resolved without having been registered with the service model. */
+    auto knownError =
+        serviceModel.AllocateOperationErrorFromPayload(ServiceError::MODEL_NAME, errorPayloadView, allocator);
+    ASSERT_NOT_NULL(knownError.get());
+    ASSERT_TRUE(knownError->GetModelName() == ServiceError::MODEL_NAME);
+
+    auto unknownError =
+        serviceModel.AllocateOperationErrorFromPayload("awstest#UnknownError", errorPayloadView, allocator);
+    ASSERT_NULL(unknownError.get());
+
+    /* Names viewed in place, as in a received header, take the same dispatch without being copied. */
+    const char headerValue[] = "awstest#ServiceErrorTrailing";
+    Aws::Crt::StringView headerNameView(headerValue, strlen(ServiceError::MODEL_NAME));
+    ASSERT_UINT_EQUALS(HashModelName(ServiceError::MODEL_NAME), HashModelName(headerNameView));
+    auto viewedError = serviceModel.AllocateOperationErrorFromModelName(headerNameView, errorPayloadView, allocator);
+    ASSERT_NOT_NULL(viewedError.get());
+    ASSERT_TRUE(viewedError->GetModelName() == ServiceError::MODEL_NAME);
+
+    Aws::Crt::StringView prefixView(headerValue, strlen(ServiceError::MODEL_NAME) - 1);
+    ASSERT_NULL(serviceModel.AllocateOperationErrorFromModelName(prefixView, errorPayloadView, allocator).get());
+
+    return AWS_OP_SUCCESS;
+}
+
+class CountingStreamHandler : public EchoStreamMessagesStreamHandler
+{
+  public:
+    explicit CountingStreamHandler(std::atomic<size_t> &eventCount) : eventCount(eventCount) {}
+    void OnStreamEvent(EchoStreamingMessage *response) override
+    {
+        if (response != nullptr && response->GetStreamMessage().has_value())
+        {
+            eventCount.fetch_add(1);
+        }
+    }
+    std::atomic<size_t> &eventCount;
+};
+
+AWS_TEST_CASE_FIXTURE(
+    ContinuationDispatchThroughput,
+    s_testSetup,
+    s_TestContinuationDispatchThroughput,
+    s_testTeardown,
+    &s_testContext);
+static int s_TestContinuationDispatchThroughput(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+    const size_t messagesPerRun = 20000;
+    const size_t streamCounts[] = {1, 16, 256};
+    const Aws::Crt::String streamMessage("{\"streamMessage\":{\"stringMessage\":\"Async I0 FTW\"}}");
+
+    /* Events are pushed by the in-process server, so every message takes the full inbound path: the continuation
+     * callback and its dispatch guard, header indexing, model name checks, shape allocation and the stream
+     * handler. */
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, server.GetConnectionConfig()).get());
+
+        for (size_t streamCount : streamCounts)
+        {
+            std::atomic<size_t> received(0);
+            Aws::Crt::Vector<std::shared_ptr<EchoStreamMessagesOperation>> operations;
+            for (size_t i = 0; i < streamCount; ++i)
+            {
+                auto operation =
+                    client.NewEchoStreamMessages(Aws::Crt::MakeShared<CountingStreamHandler>(allocator, received));
+                ASSERT_TRUE(operation->Activate(EchoStreamingRequest(), s_onMessageFlush).get());
+                ASSERT_TRUE(operation->GetResult().get());
+                operations.push_back(operation);
+            }
+
+            /* Streams of the previous run are torn down on the server asynchronously. */
+            for (int attempt = 0; attempt < 500 && server.CountOpenStreams() != streamCount; ++attempt)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            ASSERT_UINT_EQUALS(streamCount, server.CountOpenStreams());
+
+            /* Each publish reaches every open stream once. */
+            const size_t rounds = messagesPerRun / streamCount;
+            const size_t expected = rounds * streamCount;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < rounds; ++i)
+            {
+                ASSERT_UINT_EQUALS(streamCount, server.PublishStreamMessage(streamMessage));
+            }
+            for (int attempt = 0; attempt < 10000 && received.load() < expected; ++attempt)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            auto elapsed =
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            ASSERT_UINT_EQUALS(expected, received.load());
+
+            double seconds = static_cast<double>(elapsed.count()) / 1e6;
+            std::cout << "Dispatched " << expected << " inbound messages across " << streamCount
+                      << " active streams in " << seconds << "s ("
+                      << (seconds > 0 ? static_cast<double>(expected) / seconds : 0.0) << " msgs/s)" << std::endl;
+
+            for (auto &operation : operations)
+            {
+                operation->Close().wait();
+            }
+        }
+
+        client.Close();
+    }
+
+    server.Stop();
     return AWS_OP_SUCCESS;
 }
 
@@ -380,6 +596,596 @@ static int s_TestEchoOperation(struct aws_allocator *allocator, void *ctx)
     return AWS_OP_SUCCESS;
 }
 
+AWS_TEST_CASE_FIXTURE(
+    EchoOperationPipelined,
+    s_testSetup,
+    s_TestEchoOperationPipelined,
+    s_testTeardown,
+    &s_testContext);
+static int s_TestEchoOperationPipelined(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Aws::Crt::String expectedMessage("Async I0 FTW");
+        EchoMessageRequest echoMessageRequest;
+        MessageData messageData;
+        messageData.SetStringMessage(expectedMessage);
+        echoMessageRequest.SetMessage(messageData);
+        const size_t messageCount = 1000;
+
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        auto connectedStatus = client.Connect(lifecycleHandler, server.GetConnectionConfig());
+        ASSERT_TRUE(connectedStatus.get().baseStatus == EVENT_STREAM_RPC_SUCCESS);
+
+        /* Wait for each response before sending the next request. */
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messageCount; ++i)
+        {
+            auto echoMessage = client.NewEchoMessage();
+            echoMessage->Activate(echoMessageRequest, s_onMessageFlush).wait();
+            ASSERT_TRUE(echoMessage->GetResult().get());
+        }
+        std::chrono::duration<double> sequentialElapsed = std::chrono::steady_clock::now() - start;
+
+        /* Send every request before waiting on any response. */
+        start = std::chrono::steady_clock::now();
+        Aws::Crt::Vector<std::shared_ptr<EchoMessageOperation>> echoMessages;
+        Aws::Crt::Vector<std::future<RpcError>> activations;
+        for (size_t i = 0; i < messageCount; ++i)
+        {
+            echoMessages.push_back(client.NewEchoMessage());
+            activations.push_back(echoMessages.back()->Activate(echoMessageRequest, s_onMessageFlush));
+        }
+        for (size_t i = 0; i < messageCount; ++i)
+        {
+            ASSERT_TRUE(activations[i].get());
+            auto result = echoMessages[i]->GetResult().get();
+            ASSERT_TRUE(result);
+            ASSERT_TRUE(
+                result.GetOperationResponse()->GetMessage().value().GetStringMessage().value() == expectedMessage);
+        }
+        std::chrono::duration<double> pipelinedElapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "sequential: " << static_cast<uint64_t>(messageCount / sequentialElapsed.count()) << " msgs/s"
+                  << std::endl;
+        std::cout << "pipelined: " << static_cast<uint64_t>(messageCount / pipelinedElapsed.count()) << " msgs/s"
+                  << std::endl;
+
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+class WaitingStreamHandler : public EchoStreamMessagesStreamHandler
+{
+  public:
+    WaitingStreamHandler() : eventCount(0) {}
+    void OnStreamEvent(EchoStreamingMessage *response) override
+    {
+        (void)response;
+        std::lock_guard<std::mutex> lockGuard(eventLock);
+        eventCount += 1;
+        eventSignal.notify_all();
+    }
+    void WaitForEvents(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(eventLock);
+        eventSignal.wait(lock, [&]() { return eventCount >= count; });
+    }
+
+  private:
+    std::mutex eventLock;
+    std::condition_variable eventSignal;
+    size_t eventCount;
+};
+
+AWS_TEST_CASE_FIXTURE(EchoServerInProcess, s_testSetup, s_TestEchoServerInProcess, s_testTeardown, &s_testContext);
+static int s_TestEchoServerInProcess(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        auto connectedStatus = client.Connect(lifecycleHandler, server.GetConnectionConfig());
+        ASSERT_TRUE(connectedStatus.get().baseStatus == EVENT_STREAM_RPC_SUCCESS);
+
+        /* Request and response. */
+        Aws::Crt::String expectedMessage("Async I0 FTW");
+        EchoMessageRequest echoMessageRequest;
+        MessageData messageData;
+        messageData.SetStringMessage(expectedMessage);
+        echoMessageRequest.SetMessage(messageData);
+        auto echoMessage = client.NewEchoMessage();
+        ASSERT_TRUE(echoMessage->Activate(echoMessageRequest, s_onMessageFlush).get());
+        auto echoResult = echoMessage->GetResult().get();
+        ASSERT_TRUE(echoResult);
+        ASSERT_TRUE(
+            echoResult.GetOperationResponse()->GetMessage().value().GetStringMessage().value() == expectedMessage);
+
+        /* Modeled errors. */
+        auto causeServiceError = client.NewCauseServiceError();
+        ASSERT_TRUE(causeServiceError->Activate(CauseServiceErrorRequest(), s_onMessageFlush).get());
+        auto errorResult = causeServiceError->GetResult().get();
+        ASSERT_FALSE(errorResult);
+        ASSERT_NOT_NULL(errorResult.GetOperationError());
+        ASSERT_TRUE(errorResult.GetOperationError()->GetModelName() == ServiceError::MODEL_NAME);
+
+        /* Events pushed to a stream. */
+        auto streamHandler = Aws::Crt::MakeShared<WaitingStreamHandler>(allocator);
+        auto echoStreamMessages = client.NewEchoStreamMessages(streamHandler);
+        ASSERT_TRUE(echoStreamMessages->Activate(EchoStreamingRequest(), s_onMessageFlush).get());
+        ASSERT_TRUE(echoStreamMessages->GetResult().get());
+        const size_t eventCount = 10;
+        for (size_t i = 0; i < eventCount; ++i)
+        {
+            ASSERT_UINT_EQUALS(1, server.PublishStreamMessage("{\"streamMessage\":{\"stringMessage\":\"l33t\"}}"));
+        }
+        streamHandler->WaitForEvents(eventCount);
+        echoStreamMessages->Close().wait();
+
+        client.Close();
+    }
+
+    /* Clients that the server does not accept. */
+    {
+        TestLifecycleHandler lifecycleHandler;
+        ClientConnection connection(allocator);
+        ConnectionConfig rejectedConfig = server.GetConnectionConfig();
+        rejectedConfig.SetConnectAmendment(MessageAmendment());
+        auto future = connection.Connect(rejectedConfig, &lifecycleHandler, *testContext->clientBootstrap);
+        ASSERT_TRUE(future.get().baseStatus == EVENT_STREAM_RPC_CONNECTION_ACCESS_DENIED);
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    ReconnectReplaysStreams,
+    s_testSetup,
+    s_TestReconnectReplaysStreams,
+    s_testTeardown,
+    &s_testContext);
+static int s_TestReconnectReplaysStreams(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+    const Aws::Crt::String streamMessage("{\"streamMessage\":{\"stringMessage\":\"l33t\"}}");
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        ReconnectOptions reconnectOptions;
+        reconnectOptions.SetMinBackoff(std::chrono::milliseconds(10));
+        reconnectOptions.SetMaxBackoff(std::chrono::milliseconds(100));
+        client.WithAutoReconnect(reconnectOptions);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, server.GetConnectionConfig()).get());
+
+        auto streamHandler = Aws::Crt::MakeShared<WaitingStreamHandler>(allocator);
+        auto echoStreamMessages = client.NewEchoStreamMessages(streamHandler);
+        ASSERT_TRUE(echoStreamMessages->Activate(EchoStreamingRequest(), s_onMessageFlush).get());
+        ASSERT_TRUE(echoStreamMessages->GetResult().get());
+        ASSERT_UINT_EQUALS(1, server.PublishStreamMessage(streamMessage));
+        streamHandler->WaitForEvents(1);
+
+        /* A stream that was closed on purpose is not replayed. */
+        auto closedStream = client.NewEchoStreamMessages(Aws::Crt::MakeShared<WaitingStreamHandler>(allocator));
+        ASSERT_TRUE(closedStream->Activate(EchoStreamingRequest(), s_onMessageFlush).get());
+        ASSERT_TRUE(closedStream->GetResult().get());
+        closedStream->Close().wait();
+
+        ASSERT_UINT_EQUALS(1, server.DropConnections());
+
+        /* The stream is open on the server again once it has been replayed. */
+        size_t published = 0;
+        for (int attempt = 0; attempt < 500 && published == 0; ++attempt)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            published = server.PublishStreamMessage(streamMessage);
+        }
+        ASSERT_UINT_EQUALS(1, published);
+        streamHandler->WaitForEvents(2);
+
+        /* The metrics are updated once every replayed stream has been activated. */
+        ReconnectMetrics metrics = client.GetReconnectMetrics();
+        for (int attempt = 0; attempt < 500 && metrics.reconnectCount == 0; ++attempt)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            metrics = client.GetReconnectMetrics();
+        }
+        ASSERT_UINT_EQUALS(1, metrics.reconnectCount);
+        ASSERT_TRUE(metrics.lastReconnectAttempts >= 1);
+        ASSERT_UINT_EQUALS(1, metrics.streamsReplayed);
+        ASSERT_UINT_EQUALS(0, metrics.streamReplayFailures);
+
+        echoStreamMessages->Close().wait();
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    KeepAliveAndRequestTimeouts,
+    s_testSetup,
+    s_TestKeepAliveAndRequestTimeouts,
+    s_testTeardown,
+    &s_testContext);
+static int s_TestKeepAliveAndRequestTimeouts(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+
+    /* A request that is not answered fails once its deadline passes. */
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        ConnectionConfig connectionConfig = server.GetConnectionConfig();
+        connectionConfig.SetRequestTimeout(std::chrono::milliseconds(100));
+        ASSERT_TRUE(client.Connect(lifecycleHandler, connectionConfig).get());
+
+        server.SetUnresponsive(true);
+        EchoMessageRequest echoMessageRequest;
+        MessageData messageData;
+        messageData.SetStringMessage("l33t");
+        echoMessageRequest.SetMessage(messageData);
+        auto echoMessage = client.NewEchoMessage();
+        ASSERT_TRUE(echoMessage->Activate(echoMessageRequest, s_onMessageFlush).get());
+        auto echoResult = echoMessage->GetResult().get();
+        ASSERT_FALSE(echoResult);
+        ASSERT_INT_EQUALS(EVENT_STREAM_RPC_TIMED_OUT, echoResult.GetRpcError().baseStatus);
+
+        /* Operations can override the connection's timeout. */
+        server.SetUnresponsive(false);
+        auto patientEchoMessage = client.NewEchoMessage();
+        patientEchoMessage->WithRequestTimeout(std::chrono::milliseconds(5000));
+        ASSERT_TRUE(patientEchoMessage->Activate(echoMessageRequest, s_onMessageFlush).get());
+        ASSERT_TRUE(patientEchoMessage->GetResult().get());
+
+        client.Close();
+    }
+
+    /* Pings are answered while the server is responsive, and the connection is closed once one goes unanswered. */
+    {
+        TestLifecycleHandler lifecycleHandler;
+        ClientConnection connection(allocator);
+        ConnectionConfig connectionConfig = server.GetConnectionConfig();
+        connectionConfig.SetKeepAlive(std::chrono::milliseconds(50), std::chrono::milliseconds(100));
+        auto connectedStatus = connection.Connect(connectionConfig, &lifecycleHandler, *testContext->clientBootstrap);
+        ASSERT_TRUE(connectedStatus.get());
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        ASSERT_TRUE(connection.IsOpen());
+
+        server.SetUnresponsive(true);
+        lifecycleHandler.WaitOnCondition(
+            [&]() { return lifecycleHandler.lastErrorCode == EVENT_STREAM_RPC_TIMED_OUT; });
+        ASSERT_FALSE(connection.IsOpen());
+    }
+
+    server.SetUnresponsive(false);
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+class ErrorRecordingStreamHandler : public EchoStreamMessagesStreamHandler
+{
+  public:
+    ErrorRecordingStreamHandler() : lastError({EVENT_STREAM_RPC_SUCCESS, 0}), errorReceived(false) {}
+    bool OnStreamError(RpcError rpcError) override
+    {
+        std::lock_guard<std::mutex> lockGuard(errorLock);
+        lastError = rpcError;
+        errorReceived = true;
+        errorSignal.notify_all();
+        return false;
+    }
+    RpcError WaitForError()
+    {
+        std::unique_lock<std::mutex> lock(errorLock);
+        errorSignal.wait(lock, [&]() { return errorReceived; });
+        return lastError;
+    }
+
+  private:
+    std::mutex errorLock;
+    std::condition_variable errorSignal;
+    RpcError lastError;
+    bool errorReceived;
+};
+
+AWS_TEST_CASE_FIXTURE(MaxPayloadSize, s_testSetup, s_TestMaxPayloadSize, s_testTeardown, &s_testContext);
+static int s_TestMaxPayloadSize(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        ConnectionConfig connectionConfig = server.GetConnectionConfig();
+        connectionConfig.SetMaxPayloadSize(256);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, connectionConfig).get());
+
+        /* Requests within the limit are sent as usual. */
+        EchoMessageRequest echoMessageRequest;
+        MessageData messageData;
+        messageData.SetStringMessage(Aws::Crt::String(64, 'x'));
+        echoMessageRequest.SetMessage(messageData);
+        auto echoMessage = client.NewEchoMessage();
+        ASSERT_TRUE(echoMessage->Activate(echoMessageRequest, s_onMessageFlush).get());
+        ASSERT_TRUE(echoMessage->GetResult().get());
+
+        /* Larger requests fail without being sent. */
+        messageData.SetStringMessage(Aws::Crt::String(1024, 'x'));
+        echoMessageRequest.SetMessage(messageData);
+        auto largeEchoMessage = client.NewEchoMessage();
+        RpcError activateStatus = largeEchoMessage->Activate(echoMessageRequest, s_onMessageFlush).get();
+        ASSERT_INT_EQUALS(EVENT_STREAM_RPC_PAYLOAD_TOO_LARGE, activateStatus.baseStatus);
+
+        /* Larger events are reported as stream errors instead of being parsed. */
+        auto streamHandler = Aws::Crt::MakeShared<ErrorRecordingStreamHandler>(allocator);
+        auto echoStreamMessages = client.NewEchoStreamMessages(streamHandler);
+        ASSERT_TRUE(echoStreamMessages->Activate(EchoStreamingRequest(), s_onMessageFlush).get());
+        ASSERT_TRUE(echoStreamMessages->GetResult().get());
+        Aws::Crt::String largeEvent =
+            Aws::Crt::String("{\"streamMessage\":{\"stringMessage\":\"") + Aws::Crt::String(1024, 'x') + "\"}}";
+        ASSERT_UINT_EQUALS(1, server.PublishStreamMessage(largeEvent));
+        ASSERT_INT_EQUALS(EVENT_STREAM_RPC_PAYLOAD_TOO_LARGE, streamHandler->WaitForError().baseStatus);
+        echoStreamMessages->Close().wait();
+
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(MessageArenaStats, s_testSetup, s_TestMessageArenaStats, s_testTeardown, &s_testContext);
+static int s_TestMessageArenaStats(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+
+    {
+        /* An outgoing message's header array never comes from the arena, so a large one is not overflow... */
+        MessageArena arena(allocator, 4096);
+        arena.CountOutgoingMessage(0);
+        arena.CountOutgoingMessage(512);
+        MessageAllocationStats stats = arena.GetStats();
+        ASSERT_UINT_EQUALS(2, stats.messages);
+        ASSERT_UINT_EQUALS(1, stats.allocations);
+        ASSERT_UINT_EQUALS(512, stats.bytes);
+        ASSERT_UINT_EQUALS(0, stats.overflowAllocations);
+
+        /* ...but an incoming one that does not fit in the arena is. */
+        arena.BeginMessage();
+        void *small = aws_mem_acquire(arena.GetAllocator(), 64);
+        void *large = aws_mem_acquire(arena.GetAllocator(), 8192);
+        aws_mem_release(arena.GetAllocator(), large);
+        aws_mem_release(arena.GetAllocator(), small);
+        stats = arena.GetStats();
+        ASSERT_UINT_EQUALS(3, stats.messages);
+        ASSERT_UINT_EQUALS(3, stats.allocations);
+        ASSERT_UINT_EQUALS(1, stats.overflowAllocations);
+    }
+
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, server.GetConnectionConfig()).get());
+
+        EchoMessageRequest echoMessageRequest;
+        MessageData messageData;
+        messageData.SetStringMessage(Aws::Crt::String("Hello!"));
+        echoMessageRequest.SetMessage(messageData);
+        const size_t messageCount = 100;
+        MessageAllocationStats before = client.GetMessageAllocationStats();
+        for (size_t i = 0; i < messageCount; ++i)
+        {
+            auto echoMessage = client.NewEchoMessage();
+            ASSERT_TRUE(echoMessage->Activate(echoMessageRequest, s_onMessageFlush).get());
+            ASSERT_TRUE(echoMessage->GetResult().get());
+        }
+        MessageAllocationStats after = client.GetMessageAllocationStats();
+
+        /* Every request and response is counted, and their headers fit without going to the heap. */
+        ASSERT_TRUE(after.messages - before.messages >= 2 * messageCount);
+        ASSERT_TRUE(after.allocations > before.allocations);
+        ASSERT_UINT_EQUALS(before.overflowAllocations, after.overflowAllocations);
+
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    OperationOutlivesClient,
+    s_testSetup,
+    s_TestOperationOutlivesClient,
+    s_testTeardown,
+    &s_testContext);
+static int s_TestOperationOutlivesClient(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+
+    EchoMessageRequest echoMessageRequest;
+    MessageData messageData;
+    messageData.SetStringMessage("l33t");
+    echoMessageRequest.SetMessage(messageData);
+    std::shared_ptr<EchoMessageOperation> answeredEchoMessage;
+    std::shared_ptr<EchoMessageOperation> pendingEchoMessage;
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        ConnectionConfig connectionConfig = server.GetConnectionConfig();
+        connectionConfig.SetRequestTimeout(std::chrono::milliseconds(5000));
+        ASSERT_TRUE(client.Connect(lifecycleHandler, connectionConfig).get());
+
+        answeredEchoMessage = client.NewEchoMessage();
+        ASSERT_TRUE(answeredEchoMessage->Activate(echoMessageRequest, s_onMessageFlush).get());
+        ASSERT_TRUE(answeredEchoMessage->GetResult().get());
+
+        /* This request is still being watched for its deadline when the client is destroyed. */
+        server.SetUnresponsive(true);
+        pendingEchoMessage = client.NewEchoMessage();
+        ASSERT_TRUE(pendingEchoMessage->Activate(echoMessageRequest, s_onMessageFlush).get());
+    }
+
+    /* The pending request fails with its stream rather than waiting out its deadline. */
+    ASSERT_FALSE(pendingEchoMessage->GetResult().get());
+
+    /* Operations refuse to be activated again instead of reaching for the destroyed connection. */
+    RpcError activateStatus = answeredEchoMessage->Activate(echoMessageRequest, s_onMessageFlush).get();
+    ASSERT_INT_EQUALS(EVENT_STREAM_RPC_CONNECTION_CLOSED, activateStatus.baseStatus);
+
+    pendingEchoMessage.reset();
+    answeredEchoMessage.reset();
+
+    server.SetUnresponsive(false);
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(OperationPoolReuse, s_testSetup, s_TestOperationPoolReuse, s_testTeardown, &s_testContext);
+static int s_TestOperationPoolReuse(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, server.GetConnectionConfig()).get());
+
+        size_t created = 0;
+        ClientOperationPool<EchoMessageOperation> echoMessagePool([&client, &created]() {
+            created += 1;
+            return client.NewEchoMessage();
+        });
+
+        /* Each request carries its own message so that a reused operation cannot hand back an earlier response. */
+        const size_t messageCount = 100;
+        for (size_t i = 0; i < messageCount; ++i)
+        {
+            Aws::Crt::String expectedMessage = Aws::Crt::String("Async I0 FTW ") + std::to_string(i).c_str();
+            EchoMessageRequest echoMessageRequest;
+            MessageData messageData;
+            messageData.SetStringMessage(expectedMessage);
+            echoMessageRequest.SetMessage(messageData);
+
+            auto echoMessage = echoMessagePool.Acquire();
+            ASSERT_NOT_NULL(echoMessage.get());
+            ASSERT_TRUE(echoMessage->Activate(echoMessageRequest, s_onMessageFlush).get());
+            auto result = echoMessage->GetResult().get();
+            ASSERT_TRUE(result);
+            auto response = result.GetOperationResponse();
+            ASSERT_NOT_NULL(response);
+            ASSERT_TRUE(response->GetMessage().value().GetStringMessage().value() == expectedMessage);
+            echoMessagePool.Release(std::move(echoMessage));
+        }
+
+        /* Operations whose stream had closed were reset and activated again on a reopened stream. A stream may
+         * still be closing when the next request is made, so only some operations need to be reused. */
+        ASSERT_TRUE(created < messageCount);
+
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(ActivateBatch, s_testSetup, s_TestActivateBatch, s_testTeardown, &s_testContext);
+static int s_TestActivateBatch(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<EventStreamClientTestContext *>(ctx);
+    EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(server.Start());
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        Awstest::EchoTestRpcClient client(*testContext->clientBootstrap, allocator);
+        ConnectionConfig connectionConfig = server.GetConnectionConfig();
+        connectionConfig.SetMaxPayloadSize(256);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, connectionConfig).get());
+        auto newEchoMessage = [&client]() { return client.NewEchoMessage(); };
+
+        /* Every request is answered, and the results come back in the order of the requests. */
+        const size_t batchSize = 32;
+        Aws::Crt::Vector<EchoMessageRequest> requests;
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            MessageData messageData;
+            messageData.SetStringMessage(Aws::Crt::String("batched ") + std::to_string(i).c_str());
+            EchoMessageRequest echoMessageRequest;
+            echoMessageRequest.SetMessage(messageData);
+            requests.push_back(echoMessageRequest);
+        }
+        auto results = ActivateBatch<EchoMessageOperation, EchoMessageResult>(
+                           requests, newEchoMessage, std::launch::deferred)
+                           .get();
+        ASSERT_UINT_EQUALS(batchSize, results.size());
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            ASSERT_TRUE(results[i]);
+            ASSERT_TRUE(
+                results[i].GetOperationResponse()->GetMessage().value().GetStringMessage().value() ==
+                requests[i].GetMessage().value().GetStringMessage().value());
+        }
+
+        /* A request that fails to activate gets its activation error, without holding up the rest of the batch. */
+        const size_t failedIndex = batchSize / 2;
+        MessageData largeMessageData;
+        largeMessageData.SetStringMessage(Aws::Crt::String(1024, 'x'));
+        requests[failedIndex].SetMessage(largeMessageData);
+        results = ActivateBatch<EchoMessageOperation, EchoMessageResult>(requests, newEchoMessage, std::launch::async)
+                      .get();
+        ASSERT_UINT_EQUALS(batchSize, results.size());
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            if (i == failedIndex)
+            {
+                ASSERT_FALSE(results[i]);
+                ASSERT_INT_EQUALS(EVENT_STREAM_RPC_PAYLOAD_TOO_LARGE, results[i].GetRpcError().baseStatus);
+            }
+            else
+            {
+                ASSERT_TRUE(results[i]);
+                ASSERT_TRUE(
+                    results[i].GetOperationResponse()->GetMessage().value().GetStringMessage().value() ==
+                    requests[i].GetMessage().value().GetStringMessage().value());
+            }
+        }
+
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
 class ThreadPool
 {
   public:
@@ -0,0 +1,269 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+/*
+ * Measures the eventstream RPC client against the in-process echo server:
+ * - request/response latency percentiles for EchoMessage at varying payload sizes and numbers of requests in flight,
+ * - streaming throughput for events pushed to an EchoStreamMessages stream,
+ * - heap allocations per message for both.
+ *
+ * Usage: EventstreamRpc-cpp-benchmark [message count]
+ */
+
+#include <aws/crt/Api.h>
+#include <aws/iotservicecommon/CountingAllocator.h>
+
+#include "../EchoTestRpcServer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+using namespace Aws::Crt;
+using namespace Aws::Eventstreamrpc;
+using namespace Awstest;
+
+/* Counts every allocation the client and the in-process server make. */
+static Allocator *s_countingAllocator = nullptr;
+
+static uint64_t s_allocationCount()
+{
+    return Aws::Iotservicecommon::CountingAllocator::GetTotalAllocationCount(s_countingAllocator);
+}
+
+class BenchmarkStreamHandler : public EchoStreamMessagesStreamHandler
+{
+  public:
+    BenchmarkStreamHandler() : m_eventCount(0) {}
+    void OnStreamEvent(EchoStreamingMessage *response) override
+    {
+        (void)response;
+        std::lock_guard<std::mutex> lock(m_eventLock);
+        m_eventCount += 1;
+        m_eventSignal.notify_all();
+    }
+    void WaitForEvents(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(m_eventLock);
+        m_eventSignal.wait(lock, [&]() { return m_eventCount >= count; });
+    }
+
+  private:
+    std::mutex m_eventLock;
+    std::condition_variable m_eventSignal;
+    size_t m_eventCount;
+};
+
+static String s_makePayload(size_t size)
+{
+    return String(size, 'x');
+}
+
+static double s_percentile(const Vector<double> &sortedSamples, double percentile)
+{
+    if (sortedSamples.empty())
+    {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(percentile * (sortedSamples.size() - 1));
+    return sortedSamples[index];
+}
+
+/*
+ * Runs `messageCount` echo requests, keeping `concurrency` of them in flight until the last ones are sent: each of
+ * `concurrency` workers sends its next request as soon as its previous one completes. Latency is measured from
+ * activation until the worker observes the result.
+ */
+static void s_benchmarkRequestResponse(
+    EchoTestRpcClient &client,
+    size_t payloadSize,
+    size_t concurrency,
+    size_t messageCount)
+{
+    MessageData messageData;
+    messageData.SetStringMessage(s_makePayload(payloadSize));
+    EchoMessageRequest echoMessageRequest;
+    echoMessageRequest.SetMessage(messageData);
+
+    using Clock = std::chrono::steady_clock;
+    std::atomic<size_t> nextRequest(0);
+    std::atomic<size_t> failures(0);
+    /* Reserved up front so that recording a latency is not counted as an allocation of the request. */
+    Vector<Vector<double>> workerLatenciesUs(concurrency);
+    for (auto &workerLatencies : workerLatenciesUs)
+    {
+        workerLatencies.reserve(messageCount);
+    }
+    Vector<std::thread> workers;
+    workers.reserve(concurrency);
+
+    uint64_t allocationsBefore = s_allocationCount();
+    auto runStart = Clock::now();
+    for (size_t worker = 0; worker < concurrency; ++worker)
+    {
+        workers.emplace_back([&, worker]() {
+            Vector<double> &latenciesUs = workerLatenciesUs[worker];
+            while (nextRequest.fetch_add(1) < messageCount)
+            {
+                auto start = Clock::now();
+                auto echoMessage = client.NewEchoMessage();
+                echoMessage->Activate(echoMessageRequest, nullptr);
+                if (!echoMessage->GetResult().get())
+                {
+                    failures.fetch_add(1);
+                }
+                std::chrono::duration<double, std::micro> latency = Clock::now() - start;
+                latenciesUs.push_back(latency.count());
+            }
+        });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - runStart;
+    uint64_t allocations = s_allocationCount() - allocationsBefore;
+
+    Vector<double> latenciesUs;
+    latenciesUs.reserve(messageCount);
+    for (auto &workerLatencies : workerLatenciesUs)
+    {
+        latenciesUs.insert(latenciesUs.end(), workerLatencies.begin(), workerLatencies.end());
+    }
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    std::cout << std::fixed << std::setprecision(1) << "request/response payload=" << payloadSize
+              << "B concurrency=" << concurrency << ": " << messageCount / elapsed.count() << " req/s"
+              << ", p50=" << s_percentile(latenciesUs, 0.50) << "us"
+              << ", p90=" << s_percentile(latenciesUs, 0.90) << "us"
+              << ", p99=" << s_percentile(latenciesUs, 0.99) << "us"
+              << ", max=" << s_percentile(latenciesUs, 1.0) << "us"
+              << ", allocs/req=" << static_cast<double>(allocations) / messageCount
+              << ", failures=" << failures.load() << std::endl;
+}
+
+/* Pushes `messageCount` events to each of `streamCount` streams and measures how fast they are delivered. */
+static void s_benchmarkStreaming(
+    EchoTestRpcClient &client,
+    EchoTestRpcServer &server,
+    size_t payloadSize,
+    size_t streamCount,
+    size_t messageCount)
+{
+    StringStream payloadStream;
+    payloadStream << "{\"streamMessage\":{\"stringMessage\":\"" << s_makePayload(payloadSize) << "\"}}";
+    String payload = payloadStream.str();
+
+    Vector<std::shared_ptr<BenchmarkStreamHandler>> handlers;
+    Vector<std::shared_ptr<EchoStreamMessagesOperation>> streams;
+    for (size_t i = 0; i < streamCount; ++i)
+    {
+        handlers.push_back(MakeShared<BenchmarkStreamHandler>(DefaultAllocator()));
+        streams.push_back(client.NewEchoStreamMessages(handlers.back()));
+        streams.back()->Activate(EchoStreamingRequest(), nullptr).wait();
+        streams.back()->GetResult().wait();
+    }
+
+    uint64_t allocationsBefore = s_allocationCount();
+    auto runStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < messageCount; ++i)
+    {
+        server.PublishStreamMessage(payload);
+    }
+    for (auto &handler : handlers)
+    {
+        handler->WaitForEvents(messageCount);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - runStart;
+    uint64_t allocations = s_allocationCount() - allocationsBefore;
+
+    for (auto &stream : streams)
+    {
+        stream->Close().wait();
+    }
+
+    /* Allocations include the ones the in-process server makes to send each event. */
+    size_t delivered = messageCount * streamCount;
+    std::cout << std::fixed << std::setprecision(1) << "streaming payload=" << payloadSize
+              << "B streams=" << streamCount << ": " << delivered / elapsed.count() << " msgs/s"
+              << ", allocs/msg=" << static_cast<double>(allocations) / delivered << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t messageCount = 10000;
+    if (argc > 1)
+    {
+        messageCount = static_cast<size_t>(std::strtoull(argv[1], nullptr, 10));
+    }
+    if (messageCount == 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [message count]" << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<Allocator> countingAllocator =
+        Aws::Iotservicecommon::CountingAllocator::Create(aws_default_allocator());
+    if (!countingAllocator)
+    {
+        std::cerr << "Failed to create the counting allocator" << std::endl;
+        return 1;
+    }
+    s_countingAllocator = countingAllocator.get();
+    Allocator *allocator = countingAllocator.get();
+
+    {
+        ApiHandle apiHandle(allocator);
+        Io::EventLoopGroup eventLoopGroup(0, allocator);
+        Io::DefaultHostResolver hostResolver(eventLoopGroup, 8, 30, allocator);
+        Io::ClientBootstrap clientBootstrap(eventLoopGroup, hostResolver, allocator);
+
+        EchoTestRpcServer server(eventLoopGroup, allocator);
+        if (!server.Start())
+        {
+            std::cerr << "Failed to start the echo server: " << ErrorDebugString(LastError()) << std::endl;
+            return 1;
+        }
+
+        {
+            ConnectionLifecycleHandler lifecycleHandler;
+            EchoTestRpcClient client(clientBootstrap, allocator);
+            RpcError connectStatus = client.Connect(lifecycleHandler, server.GetConnectionConfig()).get();
+            if (!connectStatus)
+            {
+                std::cerr << "Failed to connect to the echo server: " << connectStatus.StatusToString() << std::endl;
+                return 1;
+            }
+
+            for (size_t payloadSize : {64, 1024, 16384})
+            {
+                for (size_t concurrency : {1, 16, 128})
+                {
+                    s_benchmarkRequestResponse(client, payloadSize, concurrency, messageCount);
+                }
+            }
+
+            for (size_t payloadSize : {64, 1024, 16384})
+            {
+                for (size_t streamCount : {1, 16})
+                {
+                    size_t messagesPerStream = (std::max)(size_t(1), messageCount / streamCount);
+                    s_benchmarkStreaming(client, server, payloadSize, streamCount, messagesPerStream);
+                }
+            }
+
+            client.Close();
+        }
+
+        server.Stop();
+    }
+
+    return 0;
+}
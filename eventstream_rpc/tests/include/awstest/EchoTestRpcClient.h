@@ -39,6 +39,21 @@ namespace Awstest
         bool IsConnected() const noexcept { return m_connection.IsOpen(); }
         void Close() noexcept;
         void WithLaunchMode(std::launch mode) noexcept;
+        /**
+         * Re-establish the connection whenever it is lost, then re-activate the streaming operations that were
+         * active on it with their original requests. Must be called before `Connect`. Messages that the server
+         * sent while the connection was down are not recovered.
+         * @param options The backoff used between connection attempts.
+         */
+        void WithAutoReconnect(const ReconnectOptions &options = ReconnectOptions()) noexcept;
+        /**
+         * @return Counters describing how the connection has recovered, if automatic reconnection is enabled.
+         */
+        ReconnectMetrics GetReconnectMetrics() const noexcept;
+        /**
+         * @return Counters for the buffers allocated to send and receive messages on the connection.
+         */
+        MessageAllocationStats GetMessageAllocationStats() const noexcept;
 
         /**
          * Fetches all products, indexed by SKU
@@ -78,6 +93,7 @@ namespace Awstest
         EchoTestRpcServiceModel m_echoTestRpcServiceModel;
         ClientConnection m_connection;
         Aws::Crt::Io::ClientBootstrap &m_clientBootstrap;
+        ClientReconnector m_reconnector;
         Aws::Crt::Allocator *m_allocator;
         MessageAmendment m_connectAmendment;
         std::launch m_asyncLaunchMode;
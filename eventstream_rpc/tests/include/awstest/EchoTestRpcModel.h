@@ -1153,6 +1153,10 @@ namespace Awstest
             const Aws::Crt::String &errorModelName,
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator = Aws::Crt::g_allocator) const noexcept override;
+        Aws::Crt::ScopedResource<OperationError> AllocateOperationErrorFromModelName(
+            Aws::Crt::StringView errorModelName,
+            Aws::Crt::StringView stringView,
+            Aws::Crt::Allocator *allocator = Aws::Crt::g_allocator) const noexcept override;
         void AssignModelNameToErrorResponse(Aws::Crt::String, ErrorResponseFactory) noexcept;
 
       private:
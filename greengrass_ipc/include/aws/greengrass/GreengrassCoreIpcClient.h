@@ -41,6 +41,21 @@ namespace Aws
             bool IsConnected() const noexcept { return m_connection.IsOpen(); }
             void Close() noexcept;
             void WithLaunchMode(std::launch mode) noexcept;
+            /**
+             * Re-establish the connection whenever it is lost, then re-activate the streaming operations that were
+             * active on it with their original requests. Must be called before `Connect`. Messages that the server
+             * sent while the connection was down are not recovered.
+             * @param options The backoff used between connection attempts.
+             */
+            void WithAutoReconnect(const ReconnectOptions &options = ReconnectOptions()) noexcept;
+            /**
+             * @return Counters describing how the connection has recovered, if automatic reconnection is enabled.
+             */
+            ReconnectMetrics GetReconnectMetrics() const noexcept;
+            /**
+             * @return Counters for the buffers allocated to send and receive messages on the connection.
+             */
+            MessageAllocationStats GetMessageAllocationStats() const noexcept;
 
             /**
              * Subscribe to a topic in AWS IoT message broker.
@@ -58,6 +73,17 @@ namespace Aws
              */
             std::shared_ptr<PublishToIoTCoreOperation> NewPublishToIoTCore() noexcept;
 
+            /**
+             * Publish a batch of MQTT messages to AWS IoT message broker.
+             * Each request is still carried by its own operation, but every operation is activated before any
+             * response is awaited so that the requests are pipelined on the connection instead of each waiting for
+             * the previous one to complete.
+             * @param requests The requests to publish.
+             * @return A future that resolves to one result per request, in the order of the requests.
+             */
+            std::future<Aws::Crt::Vector<PublishToIoTCoreResult>> PublishToIoTCoreBatch(
+                const Aws::Crt::Vector<PublishToIoTCoreRequest> &requests) noexcept;
+
             /**
              * Subscribes to be notified when GGC updates the configuration for a given componentName and keyName.
              */
@@ -116,6 +142,17 @@ namespace Aws
              */
             std::shared_ptr<PublishToTopicOperation> NewPublishToTopic() noexcept;
 
+            /**
+             * Publish a batch of messages to custom topics.
+             * Each request is still carried by its own operation, but every operation is activated before any
+             * response is awaited so that the requests are pipelined on the connection instead of each waiting for
+             * the previous one to complete.
+             * @param requests The requests to publish.
+             * @return A future that resolves to one result per request, in the order of the requests.
+             */
+            std::future<Aws::Crt::Vector<PublishToTopicResult>> PublishToTopicBatch(
+                const Aws::Crt::Vector<PublishToTopicRequest> &requests) noexcept;
+
             /**
              * Create a subscription for new certificates
              */
@@ -147,6 +184,18 @@ namespace Aws
              */
             std::shared_ptr<GetThingShadowOperation> NewGetThingShadow() noexcept;
 
+            /**
+             * Take a GetThingShadow operation from the client's pool, for callers that poll a shadow at a high rate.
+             * An operation handed back with ReleaseGetThingShadow is reused once its stream has closed.
+             */
+            std::shared_ptr<GetThingShadowOperation> AcquireGetThingShadow() noexcept;
+
+            /**
+             * Hand a GetThingShadow operation back to the client's pool once its result has been retrieved.
+             * @param operation The operation, which the caller must no longer use.
+             */
+            void ReleaseGetThingShadow(std::shared_ptr<GetThingShadowOperation> operation) noexcept;
+
             /**
              * This operation should be used in response to event received as part of
              * SubscribeToValidateConfigurationUpdates subscription. It is not necessary to send the report if the
@@ -237,9 +286,12 @@ namespace Aws
             GreengrassCoreIpcServiceModel m_greengrassCoreIpcServiceModel;
             ClientConnection m_connection;
             Aws::Crt::Io::ClientBootstrap &m_clientBootstrap;
+            ClientReconnector m_reconnector;
             Aws::Crt::Allocator *m_allocator;
             MessageAmendment m_connectAmendment;
             std::launch m_asyncLaunchMode;
+            /* Declared last, so that the pooled operations are gone before the connection they were made on. */
+            ClientOperationPool<GetThingShadowOperation> m_getThingShadowPool;
         };
     } // namespace Greengrass
 } // namespace Aws
@@ -0,0 +1,204 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/greengrass/GreengrassCoreIpcClient.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Greengrass
+    {
+        /**
+         * What a subscriber's buffer does with a new message when it is full.
+         */
+        enum class TopicOverflowPolicy
+        {
+            /* Discard the oldest buffered message to make room for the new one. */
+            DropOldest,
+            /* Discard the new message. */
+            DropNewest
+        };
+
+        /**
+         * Buffering used for one subscriber of a `TopicBus`.
+         */
+        class AWS_GREENGRASSCOREIPC_API TopicSubscriberOptions
+        {
+          public:
+            TopicSubscriberOptions() noexcept : m_capacity(64), m_overflowPolicy(TopicOverflowPolicy::DropOldest) {}
+            size_t GetCapacity() const noexcept { return m_capacity; }
+            TopicOverflowPolicy GetOverflowPolicy() const noexcept { return m_overflowPolicy; }
+
+            /**
+             * @param capacity The number of messages buffered for the subscriber, rounded up to a power of two and to
+             * at least two.
+             */
+            void SetCapacity(size_t capacity) noexcept { m_capacity = capacity; }
+            void SetOverflowPolicy(TopicOverflowPolicy overflowPolicy) noexcept { m_overflowPolicy = overflowPolicy; }
+
+          protected:
+            size_t m_capacity;
+            TopicOverflowPolicy m_overflowPolicy;
+        };
+
+        /**
+         * An in-process subscriber to a topic of a `TopicBus`.
+         *
+         * Messages are buffered in a bounded lock-free queue until they are taken with `TryPop` or `WaitPop`. The
+         * queue may be drained by several threads at once. Each message is shared with the other subscribers to the
+         * topic and must not be modified.
+         */
+        class AWS_GREENGRASSCOREIPC_API TopicSubscriber final
+        {
+          public:
+            TopicSubscriber(
+                const Aws::Crt::String &topic,
+                const TopicSubscriberOptions &options,
+                Aws::Crt::Allocator *allocator = Aws::Crt::g_allocator) noexcept;
+            ~TopicSubscriber() noexcept;
+            TopicSubscriber(const TopicSubscriber &) = delete;
+            TopicSubscriber &operator=(const TopicSubscriber &) = delete;
+
+            /**
+             * Take the oldest buffered message without waiting.
+             * @param message Set to the message if one was buffered.
+             * @return True if a message was taken.
+             */
+            bool TryPop(std::shared_ptr<SubscriptionResponseMessage> &message) noexcept;
+
+            /**
+             * Take the oldest buffered message, waiting for one to arrive if the buffer is empty.
+             * @param message Set to the message if one was taken.
+             * @param timeout The longest time to wait.
+             * @return True if a message was taken, false if the wait timed out or the subscription was closed.
+             */
+            bool WaitPop(
+                std::shared_ptr<SubscriptionResponseMessage> &message,
+                std::chrono::milliseconds timeout) noexcept;
+
+            /**
+             * @return The topic filter this subscriber was subscribed with.
+             */
+            const Aws::Crt::String &GetTopic() const noexcept { return m_topic; }
+
+            /**
+             * @return The number of messages discarded because the buffer was full.
+             */
+            uint64_t GetDroppedCount() const noexcept { return m_droppedCount.load(); }
+
+            /**
+             * @return True if no more messages will be delivered, because the subscriber was unsubscribed or the IPC
+             * subscription was closed.
+             */
+            bool IsClosed() const noexcept { return m_closed.load(); }
+
+          private:
+            friend class TopicBus;
+
+            struct Slot
+            {
+                std::atomic<size_t> sequence;
+                std::shared_ptr<SubscriptionResponseMessage> message;
+            };
+
+            bool TryEnqueue(const std::shared_ptr<SubscriptionResponseMessage> &message) noexcept;
+            bool TryDequeue(std::shared_ptr<SubscriptionResponseMessage> &message) noexcept;
+            /* Called by the bus, from one thread at a time, to buffer a message according to the overflow policy. */
+            void Deliver(const std::shared_ptr<SubscriptionResponseMessage> &message) noexcept;
+            void Close() noexcept;
+
+            Aws::Crt::String m_topic;
+            TopicOverflowPolicy m_overflowPolicy;
+            Aws::Crt::Allocator *m_allocator;
+            Slot *m_slots;
+            size_t m_mask;
+            std::atomic<size_t> m_enqueuePosition;
+            std::atomic<size_t> m_dequeuePosition;
+            std::atomic<uint64_t> m_droppedCount;
+            std::atomic<bool> m_closed;
+            /* Only used to put `WaitPop` to sleep; buffering and taking messages does not lock. */
+            std::atomic<size_t> m_waiters;
+            std::mutex m_waitMutex;
+            std::condition_variable m_waitSignal;
+        };
+
+        /**
+         * Shares IPC topic subscriptions between the components of a process.
+         *
+         * The bus holds a single `SubscribeToTopic` stream per topic filter, however many in-process subscribers it
+         * has. Each message is decoded once and handed to every subscriber to the topic, which buffers it
+         * independently so that a slow subscriber does not hold up the others.
+         *
+         * Unsubscribing does not wait for the IPC subscription to close, so it may be done from an IPC callback.
+         * Destroying the bus waits for its IPC subscriptions to close, so it must not be done from one.
+         */
+        class AWS_GREENGRASSCOREIPC_API TopicBus final
+        {
+          public:
+            /**
+             * @param client A client that stays connected for the lifetime of the bus.
+             */
+            explicit TopicBus(
+                GreengrassCoreIpcClient &client,
+                Aws::Crt::Allocator *allocator = Aws::Crt::g_allocator) noexcept;
+            ~TopicBus() noexcept;
+            TopicBus(const TopicBus &) = delete;
+            TopicBus &operator=(const TopicBus &) = delete;
+
+            /**
+             * Subscribe to a topic filter, opening the IPC subscription if this is its first subscriber. Waits for
+             * the subscription to be acknowledged when it is opened, or when another call is opening it. Only that
+             * wait, and not the bus, is held while the subscription is being opened.
+             * @param topic The topic filter to subscribe to.
+             * @param options Buffering for the subscriber.
+             * @param result If not null and the IPC subscription was opened by this call, set to its result.
+             * @return The subscriber, or nullptr if the IPC subscription could not be opened.
+             */
+            std::shared_ptr<TopicSubscriber> Subscribe(
+                const Aws::Crt::String &topic,
+                const TopicSubscriberOptions &options = TopicSubscriberOptions(),
+                SubscribeToTopicResult *result = nullptr) noexcept;
+
+            /**
+             * Remove a subscriber, closing the IPC subscription if it was the topic's last subscriber. The subscriber
+             * is closed and may still be drained.
+             */
+            void Unsubscribe(const std::shared_ptr<TopicSubscriber> &subscriber) noexcept;
+
+            /**
+             * @return The number of IPC subscriptions held by the bus.
+             */
+            size_t GetTopicCount() const noexcept;
+
+          private:
+            class TopicChannel;
+            class TopicStreamHandler;
+
+            /* Opens the stream of a channel that was just added to the topics, and removes it again on failure. */
+            bool OpenChannel(
+                const Aws::Crt::String &topic,
+                const std::shared_ptr<TopicChannel> &channel,
+                SubscribeToTopicResult *result) noexcept;
+            /* Starts closing the stream of a retired channel without waiting for it to close. */
+            void CloseChannel(const std::shared_ptr<TopicChannel> &channel) noexcept;
+            /* Destroys the operations of closing channels whose streams have closed. */
+            void ReleaseClosedChannels() noexcept;
+
+            GreengrassCoreIpcClient &m_client;
+            Aws::Crt::Allocator *m_allocator;
+            /* This mutex protects everything below it. */
+            mutable std::mutex m_topicsMutex;
+            Aws::Crt::Map<Aws::Crt::String, std::shared_ptr<TopicChannel>> m_topics;
+            /* Channels whose streams are closing. Their operations are destroyed once the streams have closed. */
+            Aws::Crt::Vector<std::shared_ptr<TopicChannel>> m_closingChannels;
+        };
+    } // namespace Greengrass
+} // namespace Aws
@@ -16,63 +16,59 @@ namespace Aws
         GreengrassCoreIpcClient::GreengrassCoreIpcClient(
             Aws::Crt::Io::ClientBootstrap &clientBootstrap,
             Aws::Crt::Allocator *allocator) noexcept
-            : m_connection(allocator), m_clientBootstrap(clientBootstrap), m_allocator(allocator),
-              m_asyncLaunchMode(std::launch::deferred)
-        {
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#InvalidArgumentsError"), InvalidArgumentsError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#ServiceError"), ServiceError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#UnauthorizedError"), UnauthorizedError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#InvalidTokenError"), InvalidTokenError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#ConflictError"), ConflictError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#ResourceNotFoundError"), ResourceNotFoundError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#FailedUpdateConditionCheckError"),
-                FailedUpdateConditionCheckError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#ComponentNotFoundError"),
-                ComponentNotFoundError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#InvalidCredentialError"),
-                InvalidCredentialError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#InvalidArtifactsDirectoryPathError"),
-                InvalidArtifactsDirectoryPathError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#InvalidRecipeDirectoryPathError"),
-                InvalidRecipeDirectoryPathError::s_allocateFromPayload);
-            m_greengrassCoreIpcServiceModel.AssignModelNameToErrorResponse(
-                Aws::Crt::String("aws.greengrass#InvalidClientDeviceAuthTokenError"),
-                InvalidClientDeviceAuthTokenError::s_allocateFromPayload);
+            : m_connection(allocator), m_clientBootstrap(clientBootstrap), m_reconnector(m_connection, clientBootstrap),
+              m_allocator(allocator), m_asyncLaunchMode(std::launch::deferred),
+              m_getThingShadowPool([this]() { return NewGetThingShadow(); })
+        {
         }
 
         std::future<RpcError> GreengrassCoreIpcClient::Connect(
             ConnectionLifecycleHandler &lifecycleHandler,
             const ConnectionConfig &connectionConfig) noexcept
         {
+            if (m_reconnector.IsEnabled())
+            {
+                return m_reconnector.Connect(connectionConfig, &lifecycleHandler);
+            }
             return m_connection.Connect(connectionConfig, &lifecycleHandler, m_clientBootstrap);
         }
 
-        void GreengrassCoreIpcClient::Close() noexcept { m_connection.Close(); }
+        void GreengrassCoreIpcClient::Close() noexcept
+        {
+            m_reconnector.Close();
+            m_connection.Close();
+        }
 
         void GreengrassCoreIpcClient::WithLaunchMode(std::launch mode) noexcept { m_asyncLaunchMode = mode; }
 
+        void GreengrassCoreIpcClient::WithAutoReconnect(const ReconnectOptions &options) noexcept
+        {
+            m_reconnector.Enable(options);
+        }
+
+        ReconnectMetrics GreengrassCoreIpcClient::GetReconnectMetrics() const noexcept
+        {
+            return m_reconnector.GetMetrics();
+        }
+
+        MessageAllocationStats GreengrassCoreIpcClient::GetMessageAllocationStats() const noexcept
+        {
+            return m_connection.GetMessageAllocationStats();
+        }
+
         GreengrassCoreIpcClient::~GreengrassCoreIpcClient() noexcept { Close(); }
 
         std::shared_ptr<SubscribeToIoTCoreOperation> GreengrassCoreIpcClient::NewSubscribeToIoTCore(
             std::shared_ptr<SubscribeToIoTCoreStreamHandler> streamHandler) noexcept
         {
-            return Aws::Crt::MakeShared<SubscribeToIoTCoreOperation>(
+            auto operation = Aws::Crt::MakeShared<SubscribeToIoTCoreOperation>(
                 m_allocator,
                 m_connection,
                 std::move(streamHandler),
                 m_greengrassCoreIpcServiceModel.m_subscribeToIoTCoreOperationContext,
                 m_allocator);
+            m_reconnector.TrackOperation(operation);
+            return operation;
         }
 
         std::shared_ptr<ResumeComponentOperation> GreengrassCoreIpcClient::NewResumeComponent() noexcept
@@ -97,16 +93,25 @@ namespace Aws
             return operation;
         }
 
+        std::future<Aws::Crt::Vector<PublishToIoTCoreResult>> GreengrassCoreIpcClient::PublishToIoTCoreBatch(
+            const Aws::Crt::Vector<PublishToIoTCoreRequest> &requests) noexcept
+        {
+            return ActivateBatch<PublishToIoTCoreOperation, PublishToIoTCoreResult>(
+                requests, [this]() { return NewPublishToIoTCore(); }, m_asyncLaunchMode);
+        }
+
         std::shared_ptr<SubscribeToConfigurationUpdateOperation> GreengrassCoreIpcClient::
             NewSubscribeToConfigurationUpdate(
                 std::shared_ptr<SubscribeToConfigurationUpdateStreamHandler> streamHandler) noexcept
         {
-            return Aws::Crt::MakeShared<SubscribeToConfigurationUpdateOperation>(
+            auto operation = Aws::Crt::MakeShared<SubscribeToConfigurationUpdateOperation>(
                 m_allocator,
                 m_connection,
                 std::move(streamHandler),
                 m_greengrassCoreIpcServiceModel.m_subscribeToConfigurationUpdateOperationContext,
                 m_allocator);
+            m_reconnector.TrackOperation(operation);
+            return operation;
         }
 
         std::shared_ptr<DeleteThingShadowOperation> GreengrassCoreIpcClient::NewDeleteThingShadow() noexcept
@@ -146,12 +151,14 @@ namespace Aws
             NewSubscribeToValidateConfigurationUpdates(
                 std::shared_ptr<SubscribeToValidateConfigurationUpdatesStreamHandler> streamHandler) noexcept
         {
-            return Aws::Crt::MakeShared<SubscribeToValidateConfigurationUpdatesOperation>(
+            auto operation = Aws::Crt::MakeShared<SubscribeToValidateConfigurationUpdatesOperation>(
                 m_allocator,
                 m_connection,
                 std::move(streamHandler),
                 m_greengrassCoreIpcServiceModel.m_subscribeToValidateConfigurationUpdatesOperationContext,
                 m_allocator);
+            m_reconnector.TrackOperation(operation);
+            return operation;
         }
 
         std::shared_ptr<GetConfigurationOperation> GreengrassCoreIpcClient::NewGetConfiguration() noexcept
@@ -168,12 +175,14 @@ namespace Aws
         std::shared_ptr<SubscribeToTopicOperation> GreengrassCoreIpcClient::NewSubscribeToTopic(
             std::shared_ptr<SubscribeToTopicStreamHandler> streamHandler) noexcept
         {
-            return Aws::Crt::MakeShared<SubscribeToTopicOperation>(
+            auto operation = Aws::Crt::MakeShared<SubscribeToTopicOperation>(
                 m_allocator,
                 m_connection,
                 std::move(streamHandler),
                 m_greengrassCoreIpcServiceModel.m_subscribeToTopicOperationContext,
                 m_allocator);
+            m_reconnector.TrackOperation(operation);
+            return operation;
         }
 
         std::shared_ptr<GetComponentDetailsOperation> GreengrassCoreIpcClient::NewGetComponentDetails() noexcept
@@ -210,16 +219,25 @@ namespace Aws
             return operation;
         }
 
+        std::future<Aws::Crt::Vector<PublishToTopicResult>> GreengrassCoreIpcClient::PublishToTopicBatch(
+            const Aws::Crt::Vector<PublishToTopicRequest> &requests) noexcept
+        {
+            return ActivateBatch<PublishToTopicOperation, PublishToTopicResult>(
+                requests, [this]() { return NewPublishToTopic(); }, m_asyncLaunchMode);
+        }
+
         std::shared_ptr<SubscribeToCertificateUpdatesOperation> GreengrassCoreIpcClient::
             NewSubscribeToCertificateUpdates(
                 std::shared_ptr<SubscribeToCertificateUpdatesStreamHandler> streamHandler) noexcept
         {
-            return Aws::Crt::MakeShared<SubscribeToCertificateUpdatesOperation>(
+            auto operation = Aws::Crt::MakeShared<SubscribeToCertificateUpdatesOperation>(
                 m_allocator,
                 m_connection,
                 std::move(streamHandler),
                 m_greengrassCoreIpcServiceModel.m_subscribeToCertificateUpdatesOperationContext,
                 m_allocator);
+            m_reconnector.TrackOperation(operation);
+            return operation;
         }
 
         std::shared_ptr<VerifyClientDeviceIdentityOperation> GreengrassCoreIpcClient::
@@ -279,6 +297,16 @@ namespace Aws
             return operation;
         }
 
+        std::shared_ptr<GetThingShadowOperation> GreengrassCoreIpcClient::AcquireGetThingShadow() noexcept
+        {
+            return m_getThingShadowPool.Acquire();
+        }
+
+        void GreengrassCoreIpcClient::ReleaseGetThingShadow(std::shared_ptr<GetThingShadowOperation> operation) noexcept
+        {
+            m_getThingShadowPool.Release(std::move(operation));
+        }
+
         std::shared_ptr<SendConfigurationValidityReportOperation> GreengrassCoreIpcClient::
             NewSendConfigurationValidityReport() noexcept
         {
@@ -393,12 +421,14 @@ namespace Aws
         std::shared_ptr<SubscribeToComponentUpdatesOperation> GreengrassCoreIpcClient::NewSubscribeToComponentUpdates(
             std::shared_ptr<SubscribeToComponentUpdatesStreamHandler> streamHandler) noexcept
         {
-            return Aws::Crt::MakeShared<SubscribeToComponentUpdatesOperation>(
+            auto operation = Aws::Crt::MakeShared<SubscribeToComponentUpdatesOperation>(
                 m_allocator,
                 m_connection,
                 std::move(streamHandler),
                 m_greengrassCoreIpcServiceModel.m_subscribeToComponentUpdatesOperationContext,
                 m_allocator);
+            m_reconnector.TrackOperation(operation);
+            return operation;
         }
 
         std::shared_ptr<ListLocalDeploymentsOperation> GreengrassCoreIpcClient::NewListLocalDeployments() noexcept
@@ -44,8 +44,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<UserProperty> shape(
@@ -87,8 +87,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<MessageContext> shape(
@@ -246,8 +246,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<DeploymentStatusDetails> shape(
@@ -300,8 +300,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SystemResourceLimits> shape(
@@ -356,8 +356,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ValidateConfigurationUpdateEvent> shape(
@@ -397,10 +397,11 @@ namespace Aws
         {
             if (jsonView.ValueExists("message"))
             {
-                if (jsonView.GetString("message").size() > 0)
+                Aws::Crt::String encodedMessage = jsonView.GetString("message");
+                if (encodedMessage.size() > 0)
                 {
-                    binaryMessage.m_message = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("message")));
+                    binaryMessage.m_message =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedMessage));
                 }
             }
             if (jsonView.ValueExists("context"))
@@ -418,8 +419,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<BinaryMessage> shape(
@@ -471,8 +472,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<JsonMessage> shape(
@@ -551,10 +552,11 @@ namespace Aws
             }
             if (jsonView.ValueExists("payload"))
             {
-                if (jsonView.GetString("payload").size() > 0)
+                Aws::Crt::String encodedPayload = jsonView.GetString("payload");
+                if (encodedPayload.size() > 0)
                 {
-                    mQTTMessage.m_payload = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("payload")));
+                    mQTTMessage.m_payload =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedPayload));
                 }
             }
             if (jsonView.ValueExists("retain"))
@@ -579,10 +581,11 @@ namespace Aws
             }
             if (jsonView.ValueExists("correlationData"))
             {
-                if (jsonView.GetString("correlationData").size() > 0)
+                Aws::Crt::String encodedCorrelationData = jsonView.GetString("correlationData");
+                if (encodedCorrelationData.size() > 0)
                 {
-                    mQTTMessage.m_correlationData = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("correlationData")));
+                    mQTTMessage.m_correlationData =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedCorrelationData));
                 }
             }
             if (jsonView.ValueExists("responseTopic"))
@@ -638,8 +641,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<MQTTMessage> shape(
@@ -708,8 +711,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ConfigurationUpdateEvent> shape(
@@ -755,8 +758,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PostComponentUpdateEvent> shape(
@@ -811,8 +814,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PreComponentUpdateEvent> shape(
@@ -894,8 +897,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CertificateUpdate> shape(
@@ -1010,8 +1013,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<Metric> shape(Aws::Crt::New<Metric>(allocator), Metric::s_customDeleter);
@@ -1134,8 +1137,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<LocalDeployment> shape(
@@ -1276,8 +1279,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ComponentDetails> shape(
@@ -1344,8 +1347,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<MQTTCredential> shape(
@@ -1405,8 +1408,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<RunWithInfo> shape(
@@ -1463,8 +1466,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ClientDeviceCredential> shape(
@@ -1530,8 +1533,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ValidateConfigurationUpdateEvents> shape(
@@ -1611,8 +1614,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscriptionResponseMessage> shape(
@@ -1668,8 +1671,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<IoTCoreMessage> shape(
@@ -1731,8 +1734,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ConfigurationUpdateEvents> shape(
@@ -1811,8 +1814,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ComponentUpdatePolicyEvents> shape(
@@ -1872,8 +1875,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CertificateUpdateEvent> shape(
@@ -1940,8 +1943,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CertificateOptions> shape(
@@ -2036,8 +2039,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ConfigurationValidityReport> shape(
@@ -2112,8 +2115,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PublishMessage> shape(
@@ -2153,10 +2156,11 @@ namespace Aws
             }
             else if (jsonView.ValueExists("secretBinary"))
             {
-                if (jsonView.GetString("secretBinary").size() > 0)
+                Aws::Crt::String encodedSecretBinary = jsonView.GetString("secretBinary");
+                if (encodedSecretBinary.size() > 0)
                 {
-                    secretValue.m_secretBinary = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("secretBinary")));
+                    secretValue.m_secretBinary =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedSecretBinary));
                 }
                 secretValue.m_chosenMember = TAG_SECRET_BINARY;
             }
@@ -2185,8 +2189,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SecretValue> shape(
@@ -2243,8 +2247,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CredentialDocument> shape(
@@ -2289,8 +2293,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<InvalidArgumentsError> shape(
@@ -2339,8 +2343,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ServiceError> shape(
@@ -2382,8 +2386,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<UnauthorizedError> shape(
@@ -2431,8 +2435,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<VerifyClientDeviceIdentityResponse> shape(
@@ -2483,8 +2487,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<VerifyClientDeviceIdentityRequest> shape(
@@ -2527,8 +2531,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<InvalidTokenError> shape(
@@ -2575,8 +2579,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ValidateAuthorizationTokenResponse> shape(
@@ -2624,8 +2628,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ValidateAuthorizationTokenRequest> shape(
@@ -2668,8 +2672,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ConflictError> shape(
@@ -2702,10 +2706,11 @@ namespace Aws
         {
             if (jsonView.ValueExists("payload"))
             {
-                if (jsonView.GetString("payload").size() > 0)
+                Aws::Crt::String encodedPayload = jsonView.GetString("payload");
+                if (encodedPayload.size() > 0)
                 {
-                    updateThingShadowResponse.m_payload = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("payload")));
+                    updateThingShadowResponse.m_payload =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedPayload));
                 }
             }
         }
@@ -2721,8 +2726,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<UpdateThingShadowResponse> shape(
@@ -2773,10 +2778,11 @@ namespace Aws
             }
             if (jsonView.ValueExists("payload"))
             {
-                if (jsonView.GetString("payload").size() > 0)
+                Aws::Crt::String encodedPayload = jsonView.GetString("payload");
+                if (encodedPayload.size() > 0)
                 {
-                    updateThingShadowRequest.m_payload = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("payload")));
+                    updateThingShadowRequest.m_payload =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedPayload));
                 }
             }
         }
@@ -2792,8 +2798,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<UpdateThingShadowRequest> shape(
@@ -2856,8 +2862,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ResourceNotFoundError> shape(
@@ -2894,8 +2900,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<UpdateStateResponse> shape(
@@ -2968,8 +2974,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<UpdateStateRequest> shape(
@@ -3015,8 +3021,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<FailedUpdateConditionCheckError> shape(
@@ -3057,8 +3063,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<UpdateConfigurationResponse> shape(
@@ -3136,8 +3142,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<UpdateConfigurationRequest> shape(
@@ -3178,8 +3184,8 @@ namespace Aws
         Aws::Crt::ScopedResource<AbstractShapeBase> SubscribeToValidateConfigurationUpdatesResponse::
             s_allocateFromPayload(Aws::Crt::StringView stringView, Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToValidateConfigurationUpdatesResponse> shape(
@@ -3222,8 +3228,8 @@ namespace Aws
         Aws::Crt::ScopedResource<AbstractShapeBase> SubscribeToValidateConfigurationUpdatesRequest::
             s_allocateFromPayload(Aws::Crt::StringView stringView, Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToValidateConfigurationUpdatesRequest> shape(
@@ -3271,8 +3277,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToTopicResponse> shape(
@@ -3357,8 +3363,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToTopicRequest> shape(
@@ -3398,8 +3404,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToIoTCoreResponse> shape(
@@ -3484,8 +3490,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToIoTCoreRequest> shape(
@@ -3527,8 +3533,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToConfigurationUpdateResponse> shape(
@@ -3601,8 +3607,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToConfigurationUpdateRequest> shape(
@@ -3646,8 +3652,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToComponentUpdatesResponse> shape(
@@ -3690,8 +3696,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToComponentUpdatesRequest> shape(
@@ -3734,8 +3740,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToCertificateUpdatesResponse> shape(
@@ -3789,8 +3795,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SubscribeToCertificateUpdatesRequest> shape(
@@ -3836,8 +3842,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ComponentNotFoundError> shape(
@@ -3922,8 +3928,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<StopComponentResponse> shape(
@@ -3969,8 +3975,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<StopComponentRequest> shape(
@@ -4012,8 +4018,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SendConfigurationValidityReportResponse> shape(
@@ -4067,8 +4073,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<SendConfigurationValidityReportRequest> shape(
@@ -4110,8 +4116,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ResumeComponentResponse> shape(
@@ -4157,8 +4163,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ResumeComponentRequest> shape(
@@ -4244,8 +4250,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<RestartComponentResponse> shape(
@@ -4291,8 +4297,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<RestartComponentRequest> shape(
@@ -4332,8 +4338,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PutComponentMetricResponse> shape(
@@ -4394,8 +4400,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PutComponentMetricRequest> shape(
@@ -4435,8 +4441,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PublishToTopicResponse> shape(
@@ -4493,8 +4499,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PublishToTopicRequest> shape(
@@ -4534,8 +4540,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PublishToIoTCoreResponse> shape(
@@ -4625,10 +4631,11 @@ namespace Aws
             }
             if (jsonView.ValueExists("payload"))
             {
-                if (jsonView.GetString("payload").size() > 0)
+                Aws::Crt::String encodedPayload = jsonView.GetString("payload");
+                if (encodedPayload.size() > 0)
                 {
-                    publishToIoTCoreRequest.m_payload = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("payload")));
+                    publishToIoTCoreRequest.m_payload =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedPayload));
                 }
             }
             if (jsonView.ValueExists("retain"))
@@ -4653,10 +4660,11 @@ namespace Aws
             }
             if (jsonView.ValueExists("correlationData"))
             {
-                if (jsonView.GetString("correlationData").size() > 0)
+                Aws::Crt::String encodedCorrelationData = jsonView.GetString("correlationData");
+                if (encodedCorrelationData.size() > 0)
                 {
-                    publishToIoTCoreRequest.m_correlationData = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("correlationData")));
+                    publishToIoTCoreRequest.m_correlationData =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedCorrelationData));
                 }
             }
             if (jsonView.ValueExists("responseTopic"))
@@ -4748,8 +4756,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PublishToIoTCoreRequest> shape(
@@ -4789,8 +4797,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PauseComponentResponse> shape(
@@ -4836,8 +4844,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<PauseComponentRequest> shape(
@@ -4915,8 +4923,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ListNamedShadowsForThingResponse> shape(
@@ -4980,8 +4988,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ListNamedShadowsForThingRequest> shape(
@@ -5045,8 +5053,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ListLocalDeploymentsResponse> shape(
@@ -5086,8 +5094,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ListLocalDeploymentsRequest> shape(
@@ -5148,8 +5156,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ListComponentsResponse> shape(
@@ -5189,8 +5197,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<ListComponentsRequest> shape(
@@ -5223,10 +5231,11 @@ namespace Aws
         {
             if (jsonView.ValueExists("payload"))
             {
-                if (jsonView.GetString("payload").size() > 0)
+                Aws::Crt::String encodedPayload = jsonView.GetString("payload");
+                if (encodedPayload.size() > 0)
                 {
-                    getThingShadowResponse.m_payload = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("payload")));
+                    getThingShadowResponse.m_payload =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedPayload));
                 }
             }
         }
@@ -5242,8 +5251,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetThingShadowResponse> shape(
@@ -5298,8 +5307,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetThingShadowRequest> shape(
@@ -5389,8 +5398,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetSecretValueResponse> shape(
@@ -5453,8 +5462,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetSecretValueRequest> shape(
@@ -5503,8 +5512,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetLocalDeploymentStatusResponse> shape(
@@ -5551,8 +5560,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetLocalDeploymentStatusRequest> shape(
@@ -5608,8 +5617,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetConfigurationResponse> shape(
@@ -5678,8 +5687,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetConfigurationRequest> shape(
@@ -5728,8 +5737,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetComponentDetailsResponse> shape(
@@ -5775,8 +5784,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetComponentDetailsRequest> shape(
@@ -5821,8 +5830,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<InvalidCredentialError> shape(
@@ -5868,8 +5877,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetClientDeviceAuthTokenResponse> shape(
@@ -5919,8 +5928,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<GetClientDeviceAuthTokenRequest> shape(
@@ -5954,10 +5963,11 @@ namespace Aws
         {
             if (jsonView.ValueExists("payload"))
             {
-                if (jsonView.GetString("payload").size() > 0)
+                Aws::Crt::String encodedPayload = jsonView.GetString("payload");
+                if (encodedPayload.size() > 0)
                 {
-                    deleteThingShadowResponse.m_payload = Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(
-                        Aws::Crt::Base64Decode(jsonView.GetString("payload")));
+                    deleteThingShadowResponse.m_payload =
+                        Aws::Crt::Optional<Aws::Crt::Vector<uint8_t>>(Aws::Crt::Base64Decode(encodedPayload));
                 }
             }
         }
@@ -5973,8 +5983,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<DeleteThingShadowResponse> shape(
@@ -6029,8 +6039,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<DeleteThingShadowRequest> shape(
@@ -6070,8 +6080,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<DeferComponentUpdateResponse> shape(
@@ -6135,8 +6145,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<DeferComponentUpdateRequest> shape(
@@ -6184,8 +6194,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<InvalidArtifactsDirectoryPathError> shape(
@@ -6232,8 +6242,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<InvalidRecipeDirectoryPathError> shape(
@@ -6280,8 +6290,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CreateLocalDeploymentResponse> shape(
@@ -6488,8 +6498,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CreateLocalDeploymentRequest> shape(
@@ -6571,8 +6581,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CreateDebugPasswordResponse> shape(
@@ -6612,8 +6622,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CreateDebugPasswordRequest> shape(
@@ -6659,8 +6669,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CancelLocalDeploymentResponse> shape(
@@ -6707,8 +6717,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<CancelLocalDeploymentRequest> shape(
@@ -6755,8 +6765,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<InvalidClientDeviceAuthTokenError> shape(
@@ -6805,8 +6815,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<AuthorizeClientDeviceActionResponse> shape(
@@ -6873,8 +6883,8 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) noexcept
         {
-            Aws::Crt::String payload = {stringView.begin(), stringView.end()};
-            Aws::Crt::JsonObject jsonObject(payload);
+            Aws::Crt::JsonObject jsonObject(
+                Aws::Crt::String(stringView.begin(), stringView.end(), Aws::Crt::StlAllocator<char>(allocator)));
             Aws::Crt::JsonView jsonView(jsonObject);
 
             Aws::Crt::ScopedResource<AuthorizeClientDeviceActionRequest> shape(
@@ -9454,7 +9464,95 @@ namespace Aws
             Aws::Crt::StringView stringView,
             Aws::Crt::Allocator *allocator) const noexcept
         {
-            auto it = m_modelNameToErrorResponse.find(errorModelName);
+            return AllocateOperationErrorFromModelName(
+                Aws::Crt::StringView(errorModelName.data(), errorModelName.size()), stringView, allocator);
+        }
+
+        Aws::Crt::ScopedResource<OperationError> GreengrassCoreIpcServiceModel::AllocateOperationErrorFromModelName(
+            Aws::Crt::StringView errorModelName,
+            Aws::Crt::StringView stringView,
+            Aws::Crt::Allocator *allocator) const noexcept
+        {
+            switch (HashModelName(errorModelName))
+            {
+                case HashModelName("aws.greengrass#InvalidArgumentsError"):
+                    if (errorModelName == Aws::Crt::StringView(InvalidArgumentsError::MODEL_NAME))
+                    {
+                        return InvalidArgumentsError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#ServiceError"):
+                    if (errorModelName == Aws::Crt::StringView(ServiceError::MODEL_NAME))
+                    {
+                        return ServiceError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#UnauthorizedError"):
+                    if (errorModelName == Aws::Crt::StringView(UnauthorizedError::MODEL_NAME))
+                    {
+                        return UnauthorizedError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#InvalidTokenError"):
+                    if (errorModelName == Aws::Crt::StringView(InvalidTokenError::MODEL_NAME))
+                    {
+                        return InvalidTokenError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#ConflictError"):
+                    if (errorModelName == Aws::Crt::StringView(ConflictError::MODEL_NAME))
+                    {
+                        return ConflictError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#ResourceNotFoundError"):
+                    if (errorModelName == Aws::Crt::StringView(ResourceNotFoundError::MODEL_NAME))
+                    {
+                        return ResourceNotFoundError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#FailedUpdateConditionCheckError"):
+                    if (errorModelName == Aws::Crt::StringView(FailedUpdateConditionCheckError::MODEL_NAME))
+                    {
+                        return FailedUpdateConditionCheckError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#ComponentNotFoundError"):
+                    if (errorModelName == Aws::Crt::StringView(ComponentNotFoundError::MODEL_NAME))
+                    {
+                        return ComponentNotFoundError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#InvalidCredentialError"):
+                    if (errorModelName == Aws::Crt::StringView(InvalidCredentialError::MODEL_NAME))
+                    {
+                        return InvalidCredentialError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#InvalidArtifactsDirectoryPathError"):
+                    if (errorModelName == Aws::Crt::StringView(InvalidArtifactsDirectoryPathError::MODEL_NAME))
+                    {
+                        return InvalidArtifactsDirectoryPathError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#InvalidRecipeDirectoryPathError"):
+                    if (errorModelName == Aws::Crt::StringView(InvalidRecipeDirectoryPathError::MODEL_NAME))
+                    {
+                        return InvalidRecipeDirectoryPathError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                case HashModelName("aws.greengrass#InvalidClientDeviceAuthTokenError"):
+                    if (errorModelName == Aws::Crt::StringView(InvalidClientDeviceAuthTokenError::MODEL_NAME))
+                    {
+                        return InvalidClientDeviceAuthTokenError::s_allocateFromPayload(stringView, allocator);
+                    }
+                    break;
+                default:
+                    break;
+            }
+
+            /* Only factories assigned at runtime need the name copied, to look them up. */
+            auto it = m_modelNameToErrorResponse.find(Aws::Crt::String(errorModelName.data(), errorModelName.size()));
             if (it == m_modelNameToErrorResponse.end())
             {
                 return nullptr;
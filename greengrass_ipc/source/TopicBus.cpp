@@ -0,0 +1,568 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/greengrass/TopicBus.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <new>
+
+namespace Aws
+{
+    namespace Greengrass
+    {
+        TopicSubscriber::TopicSubscriber(
+            const Aws::Crt::String &topic,
+            const TopicSubscriberOptions &options,
+            Aws::Crt::Allocator *allocator) noexcept
+            : m_topic(topic), m_overflowPolicy(options.GetOverflowPolicy()), m_allocator(allocator), m_slots(nullptr),
+              m_mask(0), m_enqueuePosition(0), m_dequeuePosition(0), m_droppedCount(0), m_closed(false),
+              m_waiters(0)
+        {
+            /* The slot index is taken from the low bits of the position, so the capacity is a power of two. It is
+             * at least two, because with a single slot the sequence of a slot that was just read would equal the
+             * sequence of a slot holding a message. */
+            size_t capacity = 2;
+            while (capacity < options.GetCapacity())
+            {
+                capacity <<= 1;
+            }
+
+            m_slots = static_cast<Slot *>(aws_mem_acquire(m_allocator, capacity * sizeof(Slot)));
+            if (m_slots == nullptr)
+            {
+                m_closed.store(true);
+                return;
+            }
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                Slot *slot = new (&m_slots[i]) Slot();
+                slot->sequence.store(i, std::memory_order_relaxed);
+            }
+            m_mask = capacity - 1;
+        }
+
+        TopicSubscriber::~TopicSubscriber() noexcept
+        {
+            if (m_slots != nullptr)
+            {
+                for (size_t i = 0; i <= m_mask; ++i)
+                {
+                    m_slots[i].~Slot();
+                }
+                aws_mem_release(m_allocator, m_slots);
+            }
+        }
+
+        /*
+         * A bounded queue in which every slot carries a sequence number: a slot at position `p` is free to be
+         * written when its sequence is `p`, and holds a message to be read when its sequence is `p + 1`. Readers and
+         * the writer claim positions with a compare-and-swap, so neither side ever blocks the other.
+         */
+        bool TopicSubscriber::TryEnqueue(const std::shared_ptr<SubscriptionResponseMessage> &message) noexcept
+        {
+            if (m_slots == nullptr)
+            {
+                return false;
+            }
+
+            size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+            Slot *slot = nullptr;
+            for (;;)
+            {
+                slot = &m_slots[position & m_mask];
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0)
+                {
+                    if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    /* The slot has not been read since the queue last wrapped around: the queue is full. */
+                    return false;
+                }
+                else
+                {
+                    position = m_enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->message = message;
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TopicSubscriber::TryDequeue(std::shared_ptr<SubscriptionResponseMessage> &message) noexcept
+        {
+            size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+            Slot *slot = nullptr;
+            for (;;)
+            {
+                slot = &m_slots[position & m_mask];
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+                if (difference == 0)
+                {
+                    if (m_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = m_dequeuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            message = std::move(slot->message);
+            slot->message.reset();
+            slot->sequence.store(position + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        void TopicSubscriber::Deliver(const std::shared_ptr<SubscriptionResponseMessage> &message) noexcept
+        {
+            if (m_closed.load())
+            {
+                return;
+            }
+
+            while (!TryEnqueue(message))
+            {
+                if (m_slots == nullptr || m_overflowPolicy == TopicOverflowPolicy::DropNewest)
+                {
+                    m_droppedCount.fetch_add(1);
+                    return;
+                }
+
+                /* Readers may be draining the queue at the same time, in which case there is room again. */
+                std::shared_ptr<SubscriptionResponseMessage> oldestMessage;
+                if (TryDequeue(oldestMessage))
+                {
+                    m_droppedCount.fetch_add(1);
+                }
+            }
+
+            if (m_waiters.load() > 0)
+            {
+                const std::lock_guard<std::mutex> lock(m_waitMutex);
+                m_waitSignal.notify_all();
+            }
+        }
+
+        void TopicSubscriber::Close() noexcept
+        {
+            m_closed.store(true);
+            const std::lock_guard<std::mutex> lock(m_waitMutex);
+            m_waitSignal.notify_all();
+        }
+
+        bool TopicSubscriber::TryPop(std::shared_ptr<SubscriptionResponseMessage> &message) noexcept
+        {
+            if (m_slots == nullptr)
+            {
+                return false;
+            }
+            return TryDequeue(message);
+        }
+
+        bool TopicSubscriber::WaitPop(
+            std::shared_ptr<SubscriptionResponseMessage> &message,
+            std::chrono::milliseconds timeout) noexcept
+        {
+            if (TryPop(message))
+            {
+                return true;
+            }
+
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_waiters.fetch_add(1);
+            bool popped = false;
+            /* Counted as waiting before checking the queue, so a message delivered after the check will notify. */
+            m_waitSignal.wait_until(lock, deadline, [&]() {
+                popped = TryPop(message);
+                return popped || m_closed.load();
+            });
+            m_waiters.fetch_sub(1);
+            return popped;
+        }
+
+        class TopicBus::TopicChannel final
+        {
+          public:
+            explicit TopicChannel(Aws::Crt::Allocator *allocator) noexcept
+                : m_allocator(allocator), m_subscribers(Aws::Crt::MakeShared<SubscriberList>(allocator)),
+                  m_opened(m_openedPromise.get_future().share()), m_open(false), m_streamClosed(false),
+                  m_retired(false)
+            {
+            }
+
+            void OnStreamEvent(SubscriptionResponseMessage *response) noexcept
+            {
+                /* Copied once, then shared by every subscriber. */
+                auto message = Aws::Crt::MakeShared<SubscriptionResponseMessage>(m_allocator, *response);
+                std::shared_ptr<const SubscriberList> subscribers = std::atomic_load(&m_subscribers);
+                for (const auto &subscriber : *subscribers)
+                {
+                    subscriber->Deliver(message);
+                }
+            }
+
+            void OnStreamClosed() noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_subscribersMutex);
+                m_streamClosed.store(true);
+                CloseSubscribersLocked();
+            }
+
+            /* Called once by the subscriber that opens the stream, after `operation` is set if it was opened. */
+            void SetOpened(bool opened) noexcept
+            {
+                m_open.store(opened);
+                m_openedPromise.set_value(opened);
+            }
+
+            /* Waits for the subscriber that opens the stream to learn whether it was opened. */
+            bool WaitOpened() const noexcept { return m_opened.get(); }
+
+            /* False once the channel was retired, or once its stream was opened and then closed by the server. */
+            bool IsUsable() const noexcept { return !m_retired.load() && (!m_open.load() || !m_streamClosed.load()); }
+
+            bool IsOpen() const noexcept { return m_open.load(); }
+
+            bool IsRetired() const noexcept { return m_retired.load(); }
+
+            bool IsStreamClosed() const noexcept { return m_streamClosed.load(); }
+
+            /*
+             * Subscribers are added and removed by replacing the list, so that delivery never waits for them.
+             * Returns false if the channel was retired by its last subscriber leaving, in which case the subscriber
+             * should be added to a new channel. A subscriber added after the server closed the stream is closed.
+             */
+            bool AddSubscriber(const std::shared_ptr<TopicSubscriber> &subscriber) noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_subscribersMutex);
+                if (m_retired.load())
+                {
+                    return false;
+                }
+                if (m_streamClosed.load())
+                {
+                    subscriber->Close();
+                    return true;
+                }
+                auto subscribers = Aws::Crt::MakeShared<SubscriberList>(m_allocator, *m_subscribers);
+                subscribers->push_back(subscriber);
+                std::atomic_store(&m_subscribers, std::shared_ptr<const SubscriberList>(subscribers));
+                return true;
+            }
+
+            /*
+             * Returns true if the subscriber was the last one, in which case the channel is retired and the caller
+             * must close its stream.
+             */
+            bool RemoveSubscriber(const std::shared_ptr<TopicSubscriber> &subscriber) noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_subscribersMutex);
+                auto subscribers = Aws::Crt::MakeShared<SubscriberList>(m_allocator, *m_subscribers);
+                auto removed = std::remove(subscribers->begin(), subscribers->end(), subscriber);
+                if (removed == subscribers->end())
+                {
+                    return false;
+                }
+                subscribers->erase(removed, subscribers->end());
+                std::atomic_store(&m_subscribers, std::shared_ptr<const SubscriberList>(subscribers));
+                if (!subscribers->empty() || m_streamClosed.load())
+                {
+                    return false;
+                }
+                m_retired.store(true);
+                return true;
+            }
+
+            void CloseSubscribers() noexcept
+            {
+                const std::lock_guard<std::mutex> lock(m_subscribersMutex);
+                CloseSubscribersLocked();
+            }
+
+            /* Released by the bus rather than with the channel, which a stream callback may be holding: destroying
+             * an operation from one of its own callbacks would deadlock. */
+            std::shared_ptr<SubscribeToTopicOperation> operation;
+
+          private:
+            using SubscriberList = Aws::Crt::Vector<std::shared_ptr<TopicSubscriber>>;
+
+            void CloseSubscribersLocked() noexcept
+            {
+                for (const auto &subscriber : *m_subscribers)
+                {
+                    subscriber->Close();
+                }
+                auto subscribers = Aws::Crt::MakeShared<SubscriberList>(m_allocator);
+                std::atomic_store(&m_subscribers, std::shared_ptr<const SubscriberList>(subscribers));
+            }
+
+            Aws::Crt::Allocator *m_allocator;
+            std::mutex m_subscribersMutex;
+            std::shared_ptr<const SubscriberList> m_subscribers;
+            std::promise<bool> m_openedPromise;
+            std::shared_future<bool> m_opened;
+            std::atomic<bool> m_open;
+            std::atomic<bool> m_streamClosed;
+            std::atomic<bool> m_retired;
+        };
+
+        /*
+         * The operation holds its stream handler and the channel holds the operation, so the handler only holds the
+         * channel weakly: otherwise neither would ever be freed.
+         */
+        class TopicBus::TopicStreamHandler final : public SubscribeToTopicStreamHandler
+        {
+          public:
+            explicit TopicStreamHandler(const std::shared_ptr<TopicChannel> &channel) noexcept : m_channel(channel) {}
+
+            void OnStreamEvent(SubscriptionResponseMessage *response) override
+            {
+                std::shared_ptr<TopicChannel> channel = m_channel.lock();
+                if (channel != nullptr)
+                {
+                    channel->OnStreamEvent(response);
+                }
+            }
+
+            void OnStreamClosed() override
+            {
+                std::shared_ptr<TopicChannel> channel = m_channel.lock();
+                if (channel != nullptr)
+                {
+                    channel->OnStreamClosed();
+                }
+            }
+
+          private:
+            std::weak_ptr<TopicChannel> m_channel;
+        };
+
+        TopicBus::TopicBus(GreengrassCoreIpcClient &client, Aws::Crt::Allocator *allocator) noexcept
+            : m_client(client), m_allocator(allocator)
+        {
+        }
+
+        TopicBus::~TopicBus() noexcept
+        {
+            Aws::Crt::Map<Aws::Crt::String, std::shared_ptr<TopicChannel>> topics;
+            {
+                const std::lock_guard<std::mutex> lock(m_topicsMutex);
+                topics.swap(m_topics);
+            }
+
+            for (auto &topic : topics)
+            {
+                topic.second->CloseSubscribers();
+                CloseChannel(topic.second);
+            }
+
+            Aws::Crt::Vector<std::shared_ptr<TopicChannel>> closingChannels;
+            {
+                const std::lock_guard<std::mutex> lock(m_topicsMutex);
+                closingChannels.swap(m_closingChannels);
+            }
+            /* Each operation waits for its stream to close when it is destroyed. It is taken out of its channel
+             * first, so that it is destroyed here even if a stream callback is still holding the channel. */
+            for (auto &channel : closingChannels)
+            {
+                std::shared_ptr<SubscribeToTopicOperation> operation = std::move(channel->operation);
+                operation.reset();
+            }
+        }
+
+        void TopicBus::CloseChannel(const std::shared_ptr<TopicChannel> &channel) noexcept
+        {
+            if (!channel->IsOpen() || channel->operation == nullptr)
+            {
+                return;
+            }
+
+            /* Waiting for the stream to close would deadlock if this were called from an IPC callback, so the channel
+             * is kept until its closed callback has been delivered. */
+            channel->operation->Close();
+            const std::lock_guard<std::mutex> lock(m_topicsMutex);
+            m_closingChannels.push_back(channel);
+        }
+
+        void TopicBus::ReleaseClosedChannels() noexcept
+        {
+            Aws::Crt::Vector<std::shared_ptr<SubscribeToTopicOperation>> closedOperations;
+            {
+                const std::lock_guard<std::mutex> lock(m_topicsMutex);
+                auto channelIter = m_closingChannels.begin();
+                while (channelIter != m_closingChannels.end())
+                {
+                    if ((*channelIter)->IsStreamClosed())
+                    {
+                        closedOperations.push_back(std::move((*channelIter)->operation));
+                        channelIter = m_closingChannels.erase(channelIter);
+                    }
+                    else
+                    {
+                        ++channelIter;
+                    }
+                }
+            }
+            /* The operations are destroyed outside the lock, since each waits for its closed callback to return. */
+        }
+
+        std::shared_ptr<TopicSubscriber> TopicBus::Subscribe(
+            const Aws::Crt::String &topic,
+            const TopicSubscriberOptions &options,
+            SubscribeToTopicResult *result) noexcept
+        {
+            ReleaseClosedChannels();
+            auto subscriber = Aws::Crt::MakeShared<TopicSubscriber>(m_allocator, topic, options, m_allocator);
+
+            /* The stream is opened and closed outside of the lock, so that subscribers to other topics, and to this
+             * topic once its stream is open, are not held up by a round trip to the server. */
+            for (;;)
+            {
+                std::shared_ptr<TopicChannel> channel;
+                std::shared_ptr<TopicChannel> closedChannel;
+                bool opening = false;
+                {
+                    const std::lock_guard<std::mutex> lock(m_topicsMutex);
+                    auto topicIter = m_topics.find(topic);
+                    if (topicIter != m_topics.end() && topicIter->second->IsUsable())
+                    {
+                        channel = topicIter->second;
+                    }
+                    else
+                    {
+                        if (topicIter != m_topics.end())
+                        {
+                            /* A channel whose stream was closed by the server is released here, while a retired
+                             * channel is closed by the subscriber that retired it. */
+                            if (!topicIter->second->IsRetired())
+                            {
+                                closedChannel = topicIter->second;
+                            }
+                            m_topics.erase(topicIter);
+                        }
+                        channel = Aws::Crt::MakeShared<TopicChannel>(m_allocator, m_allocator);
+                        m_topics.emplace(topic, channel);
+                        opening = true;
+                    }
+                }
+
+                if (closedChannel != nullptr)
+                {
+                    closedChannel->operation.reset();
+                }
+
+                if (opening && !OpenChannel(topic, channel, result))
+                {
+                    return nullptr;
+                }
+                if (!opening && !channel->WaitOpened())
+                {
+                    return nullptr;
+                }
+
+                if (channel->AddSubscriber(subscriber))
+                {
+                    return subscriber;
+                }
+            }
+        }
+
+        bool TopicBus::OpenChannel(
+            const Aws::Crt::String &topic,
+            const std::shared_ptr<TopicChannel> &channel,
+            SubscribeToTopicResult *result) noexcept
+        {
+            auto operation =
+                m_client.NewSubscribeToTopic(Aws::Crt::MakeShared<TopicStreamHandler>(m_allocator, channel));
+            SubscribeToTopicRequest request;
+            request.SetTopic(topic);
+            RpcError activateStatus = operation->Activate(request, nullptr).get();
+            SubscribeToTopicResult subscribeResult =
+                activateStatus ? operation->GetResult().get() : SubscribeToTopicResult(TaggedResult(activateStatus));
+            bool subscribed = subscribeResult;
+            if (result != nullptr)
+            {
+                *result = std::move(subscribeResult);
+            }
+
+            if (!subscribed)
+            {
+                {
+                    const std::lock_guard<std::mutex> lock(m_topicsMutex);
+                    auto topicIter = m_topics.find(topic);
+                    if (topicIter != m_topics.end() && topicIter->second == channel)
+                    {
+                        m_topics.erase(topicIter);
+                    }
+                }
+                channel->SetOpened(false);
+                return false;
+            }
+
+            channel->operation = operation;
+            channel->SetOpened(true);
+            return true;
+        }
+
+        void TopicBus::Unsubscribe(const std::shared_ptr<TopicSubscriber> &subscriber) noexcept
+        {
+            if (subscriber == nullptr)
+            {
+                return;
+            }
+
+            subscriber->Close();
+            std::shared_ptr<TopicChannel> channel;
+            {
+                const std::lock_guard<std::mutex> lock(m_topicsMutex);
+                auto topicIter = m_topics.find(subscriber->GetTopic());
+                if (topicIter == m_topics.end())
+                {
+                    return;
+                }
+                channel = topicIter->second;
+            }
+
+            if (!channel->RemoveSubscriber(subscriber))
+            {
+                return;
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock(m_topicsMutex);
+                auto topicIter = m_topics.find(subscriber->GetTopic());
+                if (topicIter != m_topics.end() && topicIter->second == channel)
+                {
+                    m_topics.erase(topicIter);
+                }
+            }
+            CloseChannel(channel);
+            ReleaseClosedChannels();
+        }
+
+        size_t TopicBus::GetTopicCount() const noexcept
+        {
+            const std::lock_guard<std::mutex> lock(m_topicsMutex);
+            return m_topics.size();
+        }
+    } // namespace Greengrass
+} // namespace Aws
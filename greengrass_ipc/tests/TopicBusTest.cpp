@@ -0,0 +1,407 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/greengrass/TopicBus.h>
+
+#include "EchoTestRpcServer.h"
+
+#include <aws/testing/aws_test_harness.h>
+#if defined(_WIN32)
+// aws_test_harness.h includes Windows.h, which is an abomination.
+// undef macros with clashing names...
+#    undef SetPort
+#    undef GetMessage
+#endif
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+
+using namespace Aws::Crt;
+using namespace Aws::Eventstreamrpc;
+using namespace Aws::Greengrass;
+
+struct TopicBusTestContext
+{
+    std::unique_ptr<ApiHandle> apiHandle;
+    std::unique_ptr<Io::EventLoopGroup> elGroup;
+    std::unique_ptr<Io::HostResolver> resolver;
+    std::unique_ptr<Io::ClientBootstrap> clientBootstrap;
+};
+
+static TopicBusTestContext s_testContext;
+
+static int s_testSetup(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<TopicBusTestContext *>(ctx);
+
+    testContext->apiHandle = std::unique_ptr<ApiHandle>(new ApiHandle(allocator));
+    testContext->elGroup = std::unique_ptr<Io::EventLoopGroup>(new Io::EventLoopGroup(0, allocator));
+    testContext->resolver =
+        std::unique_ptr<Io::HostResolver>(new Io::DefaultHostResolver(*testContext->elGroup, 8, 30, allocator));
+    testContext->clientBootstrap = std::unique_ptr<Io::ClientBootstrap>(
+        new Io::ClientBootstrap(*testContext->elGroup, *testContext->resolver, allocator));
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static int s_testTeardown(struct aws_allocator *allocator, int setup_result, void *ctx)
+{
+    auto *testContext = static_cast<TopicBusTestContext *>(ctx);
+
+    testContext->elGroup.reset();
+    testContext->resolver.reset();
+    testContext->clientBootstrap.reset();
+    /* The ApiHandle must be deallocated last or a deadlock occurs. */
+    testContext->apiHandle.reset();
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static int s_TestTopicBusFanOut(struct aws_allocator *allocator, void *ctx);
+static int s_TestTopicBusDropOldest(struct aws_allocator *allocator, void *ctx);
+static int s_TestTopicBusDropNewest(struct aws_allocator *allocator, void *ctx);
+static int s_TestTopicBusReopensClosedStream(struct aws_allocator *allocator, void *ctx);
+static int s_TestTopicBusUnsubscribeFromCallback(struct aws_allocator *allocator, void *ctx);
+
+static const std::chrono::milliseconds s_waitTimeout(5000);
+
+/* Serves SubscribeToTopic as a stream, so that messages can be published to the bus with `s_publish`. */
+static bool s_startServer(Awstest::EchoTestRpcServer &server)
+{
+    server.AddStreamingOperation(
+        String("aws.greengrass#SubscribeToTopic"), String(SubscribeToTopicResponse::MODEL_NAME));
+    return server.Start();
+}
+
+static size_t s_publish(Awstest::EchoTestRpcServer &server, int64_t sequence)
+{
+    String payload = String("{\"jsonMessage\":{\"message\":{\"sequence\":") + std::to_string(sequence).c_str() + "}}}";
+    return server.PublishStreamMessage(payload, SubscriptionResponseMessage::MODEL_NAME);
+}
+
+static int64_t s_sequenceOf(const std::shared_ptr<SubscriptionResponseMessage> &message)
+{
+    return message->GetJsonMessage().value().GetMessage().value().View().GetInt64("sequence");
+}
+
+static bool s_waitFor(const std::function<bool()> &condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + s_waitTimeout;
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+AWS_TEST_CASE_FIXTURE(TopicBusFanOut, s_testSetup, s_TestTopicBusFanOut, s_testTeardown, &s_testContext);
+static int s_TestTopicBusFanOut(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<TopicBusTestContext *>(ctx);
+    Awstest::EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(s_startServer(server));
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        GreengrassCoreIpcClient client(*testContext->clientBootstrap, allocator);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, server.GetConnectionConfig()).get());
+
+        {
+            TopicBus bus(client, allocator);
+            const size_t subscriberCount = 3;
+            Vector<std::shared_ptr<TopicSubscriber>> subscribers;
+            for (size_t i = 0; i < subscriberCount; ++i)
+            {
+                auto subscriber = bus.Subscribe(String("fan/out"));
+                ASSERT_NOT_NULL(subscriber.get());
+                subscribers.push_back(subscriber);
+            }
+
+            /* Every subscriber shares a single IPC subscription. */
+            ASSERT_UINT_EQUALS(1, bus.GetTopicCount());
+            ASSERT_UINT_EQUALS(1, server.CountOpenStreams());
+
+            const int64_t messageCount = 10;
+            for (int64_t i = 0; i < messageCount; ++i)
+            {
+                ASSERT_UINT_EQUALS(1, s_publish(server, i));
+            }
+
+            for (const auto &subscriber : subscribers)
+            {
+                for (int64_t i = 0; i < messageCount; ++i)
+                {
+                    std::shared_ptr<SubscriptionResponseMessage> message;
+                    ASSERT_TRUE(subscriber->WaitPop(message, s_waitTimeout));
+                    ASSERT_INT_EQUALS(i, s_sequenceOf(message));
+                }
+                ASSERT_UINT_EQUALS(0, subscriber->GetDroppedCount());
+            }
+
+            /* The IPC subscription is only closed when its last subscriber leaves. */
+            bus.Unsubscribe(subscribers[0]);
+            bus.Unsubscribe(subscribers[1]);
+            ASSERT_TRUE(subscribers[0]->IsClosed());
+            ASSERT_FALSE(subscribers[2]->IsClosed());
+            ASSERT_UINT_EQUALS(1, bus.GetTopicCount());
+
+            bus.Unsubscribe(subscribers[2]);
+            ASSERT_UINT_EQUALS(0, bus.GetTopicCount());
+            ASSERT_TRUE(s_waitFor([&server]() { return server.CountOpenStreams() == 0; }));
+        }
+
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Publishes `messageCount` messages to a subscriber with the given buffering, and returns the sequence numbers that it
+ * kept. A second, large subscriber is used to tell when every message has been delivered.
+ */
+static int s_deliverToSmallBuffer(
+    struct aws_allocator *allocator,
+    TopicBusTestContext *testContext,
+    const TopicSubscriberOptions &options,
+    int64_t messageCount,
+    Vector<int64_t> &kept,
+    uint64_t &dropped)
+{
+    Awstest::EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(s_startServer(server));
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        GreengrassCoreIpcClient client(*testContext->clientBootstrap, allocator);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, server.GetConnectionConfig()).get());
+
+        {
+            TopicBus bus(client, allocator);
+            auto smallSubscriber = bus.Subscribe(String("small/buffer"), options);
+            ASSERT_NOT_NULL(smallSubscriber.get());
+            /* Subscribers are delivered to in the order they subscribed, so this one receives each message last. */
+            auto witness = bus.Subscribe(String("small/buffer"));
+            ASSERT_NOT_NULL(witness.get());
+
+            for (int64_t i = 0; i < messageCount; ++i)
+            {
+                ASSERT_UINT_EQUALS(1, s_publish(server, i));
+            }
+            for (int64_t i = 0; i < messageCount; ++i)
+            {
+                std::shared_ptr<SubscriptionResponseMessage> message;
+                ASSERT_TRUE(witness->WaitPop(message, s_waitTimeout));
+            }
+
+            std::shared_ptr<SubscriptionResponseMessage> message;
+            while (smallSubscriber->TryPop(message))
+            {
+                kept.push_back(s_sequenceOf(message));
+            }
+            dropped = smallSubscriber->GetDroppedCount();
+        }
+
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(TopicBusDropOldest, s_testSetup, s_TestTopicBusDropOldest, s_testTeardown, &s_testContext);
+static int s_TestTopicBusDropOldest(struct aws_allocator *allocator, void *ctx)
+{
+    TopicSubscriberOptions options;
+    options.SetCapacity(4);
+    options.SetOverflowPolicy(TopicOverflowPolicy::DropOldest);
+
+    Vector<int64_t> kept;
+    uint64_t dropped = 0;
+    ASSERT_SUCCESS(
+        s_deliverToSmallBuffer(allocator, static_cast<TopicBusTestContext *>(ctx), options, 10, kept, dropped));
+
+    /* The newest messages are kept, in order. */
+    ASSERT_UINT_EQUALS(4, kept.size());
+    for (size_t i = 0; i < kept.size(); ++i)
+    {
+        ASSERT_INT_EQUALS(6 + i, kept[i]);
+    }
+    ASSERT_UINT_EQUALS(6, dropped);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(TopicBusDropNewest, s_testSetup, s_TestTopicBusDropNewest, s_testTeardown, &s_testContext);
+static int s_TestTopicBusDropNewest(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<TopicBusTestContext *>(ctx);
+
+    TopicSubscriberOptions options;
+    options.SetCapacity(4);
+    options.SetOverflowPolicy(TopicOverflowPolicy::DropNewest);
+
+    Vector<int64_t> kept;
+    uint64_t dropped = 0;
+    ASSERT_SUCCESS(s_deliverToSmallBuffer(allocator, testContext, options, 10, kept, dropped));
+
+    /* The oldest messages are kept, in order. */
+    ASSERT_UINT_EQUALS(4, kept.size());
+    for (size_t i = 0; i < kept.size(); ++i)
+    {
+        ASSERT_INT_EQUALS(i, kept[i]);
+    }
+    ASSERT_UINT_EQUALS(6, dropped);
+
+    /* A capacity below two is raised to two. */
+    options.SetCapacity(1);
+    kept.clear();
+    ASSERT_SUCCESS(s_deliverToSmallBuffer(allocator, testContext, options, 5, kept, dropped));
+    ASSERT_UINT_EQUALS(2, kept.size());
+    ASSERT_INT_EQUALS(0, kept[0]);
+    ASSERT_INT_EQUALS(1, kept[1]);
+    ASSERT_UINT_EQUALS(3, dropped);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    TopicBusReopensClosedStream,
+    s_testSetup,
+    s_TestTopicBusReopensClosedStream,
+    s_testTeardown,
+    &s_testContext);
+static int s_TestTopicBusReopensClosedStream(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<TopicBusTestContext *>(ctx);
+    Awstest::EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(s_startServer(server));
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        GreengrassCoreIpcClient client(*testContext->clientBootstrap, allocator);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, server.GetConnectionConfig()).get());
+
+        {
+            TopicBus bus(client, allocator);
+            auto firstSubscriber = bus.Subscribe(String("closed/by/server"));
+            ASSERT_NOT_NULL(firstSubscriber.get());
+
+            /* The server ends the subscription, which closes its subscribers. */
+            ASSERT_UINT_EQUALS(1, server.CloseStreams(SubscriptionResponseMessage::MODEL_NAME));
+            ASSERT_TRUE(s_waitFor([&firstSubscriber]() { return firstSubscriber->IsClosed(); }));
+            ASSERT_TRUE(s_waitFor([&server]() { return server.CountOpenStreams() == 0; }));
+
+            /* The next subscriber to the topic opens a new IPC subscription in place of the closed one. */
+            SubscribeToTopicResult result;
+            auto secondSubscriber = bus.Subscribe(String("closed/by/server"), TopicSubscriberOptions(), &result);
+            ASSERT_NOT_NULL(secondSubscriber.get());
+            ASSERT_TRUE(result);
+            ASSERT_FALSE(secondSubscriber->IsClosed());
+            ASSERT_UINT_EQUALS(1, bus.GetTopicCount());
+            ASSERT_UINT_EQUALS(1, server.CountOpenStreams());
+
+            ASSERT_UINT_EQUALS(1, s_publish(server, 42));
+            std::shared_ptr<SubscriptionResponseMessage> message;
+            ASSERT_TRUE(secondSubscriber->WaitPop(message, s_waitTimeout));
+            ASSERT_INT_EQUALS(42, s_sequenceOf(message));
+
+            bus.Unsubscribe(firstSubscriber);
+            ASSERT_UINT_EQUALS(1, bus.GetTopicCount());
+            bus.Unsubscribe(secondSubscriber);
+            ASSERT_UINT_EQUALS(0, bus.GetTopicCount());
+        }
+
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
+
+/* Unsubscribes a subscriber of a bus from the event loop thread, on the first message of its own stream. */
+class UnsubscribingStreamHandler : public SubscribeToTopicStreamHandler
+{
+  public:
+    UnsubscribingStreamHandler(TopicBus &bus, const std::shared_ptr<TopicSubscriber> &subscriber)
+        : m_bus(bus), m_subscriber(subscriber)
+    {
+    }
+
+    void OnStreamEvent(SubscriptionResponseMessage *response) override
+    {
+        (void)response;
+        if (m_subscriber != nullptr)
+        {
+            m_bus.Unsubscribe(m_subscriber);
+            m_subscriber.reset();
+            unsubscribed.set_value();
+        }
+    }
+
+    std::promise<void> unsubscribed;
+
+  private:
+    TopicBus &m_bus;
+    std::shared_ptr<TopicSubscriber> m_subscriber;
+};
+
+AWS_TEST_CASE_FIXTURE(
+    TopicBusUnsubscribeFromCallback,
+    s_testSetup,
+    s_TestTopicBusUnsubscribeFromCallback,
+    s_testTeardown,
+    &s_testContext);
+static int s_TestTopicBusUnsubscribeFromCallback(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<TopicBusTestContext *>(ctx);
+    Awstest::EchoTestRpcServer server(*testContext->elGroup, allocator);
+    ASSERT_TRUE(s_startServer(server));
+
+    {
+        ConnectionLifecycleHandler lifecycleHandler;
+        GreengrassCoreIpcClient client(*testContext->clientBootstrap, allocator);
+        ASSERT_TRUE(client.Connect(lifecycleHandler, server.GetConnectionConfig()).get());
+
+        {
+            TopicBus bus(client, allocator);
+            auto subscriber = bus.Subscribe(String("bus/topic"));
+            ASSERT_NOT_NULL(subscriber.get());
+
+            /* A stream of its own, whose handler leaves the bus while the event loop is delivering to it. */
+            auto handler = MakeShared<UnsubscribingStreamHandler>(allocator, bus, subscriber);
+            std::future<void> unsubscribed = handler->unsubscribed.get_future();
+            auto operation = client.NewSubscribeToTopic(handler);
+            SubscribeToTopicRequest request;
+            request.SetTopic(String("other/topic"));
+            ASSERT_TRUE(operation->Activate(request, nullptr).get());
+            ASSERT_TRUE(operation->GetResult().get());
+            ASSERT_UINT_EQUALS(2, server.CountOpenStreams());
+
+            /* Unsubscribing does not wait for the bus's stream to close, so it returns on the event loop. */
+            ASSERT_UINT_EQUALS(2, s_publish(server, 1));
+            ASSERT_TRUE(unsubscribed.wait_for(s_waitTimeout) == std::future_status::ready);
+            ASSERT_TRUE(subscriber->IsClosed());
+            ASSERT_UINT_EQUALS(0, bus.GetTopicCount());
+            ASSERT_TRUE(s_waitFor([&server]() { return server.CountOpenStreams() == 1; }));
+
+            operation->Close().wait();
+        }
+
+        client.Close();
+    }
+
+    server.Stop();
+    return AWS_OP_SUCCESS;
+}
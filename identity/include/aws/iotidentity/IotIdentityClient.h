@@ -7,6 +7,7 @@
  */
 
 #include <aws/iotidentity/Exports.h>
+#include <aws/iotidentity/SubscriptionHandle.h>
 
 #include <aws/crt/StlAllocator.h>
 #include <aws/crt/Types.h>
@@ -26,6 +27,7 @@ namespace Aws
         class CreateKeysAndCertificateResponse;
         class CreateKeysAndCertificateSubscriptionRequest;
         class ErrorResponse;
+        class PublishBufferPool;
         class RegisterThingRequest;
         class RegisterThingResponse;
         class RegisterThingSubscriptionRequest;
@@ -60,12 +62,37 @@ namespace Aws
         class AWS_IOTIDENTITY_API IotIdentityClient final
         {
           public:
-            IotIdentityClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection);
-            IotIdentityClient(const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client);
+            /**
+             * @param allocator Allocates the client's publish buffers and subscription bookkeeping. The client counts
+             * what it allocates; see GetAllocatedBytes.
+             */
+            IotIdentityClient(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                Aws::Crt::Allocator *allocator = Aws::Crt::ApiAllocator());
+            IotIdentityClient(
+                const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client,
+                Aws::Crt::Allocator *allocator = Aws::Crt::ApiAllocator());
 
             operator bool() const noexcept;
             int GetLastError() const noexcept;
 
+            /**
+             * @return The allocator the client allocates with, which counts allocations before passing them on to
+             * the allocator the client was created with.
+             */
+            Aws::Crt::Allocator *GetAllocator() const noexcept;
+
+            /**
+             * @return The number of bytes the client has allocated and not yet freed. Buffers of publishes that are
+             * still in flight, and buffers kept for reuse, are included.
+             */
+            size_t GetAllocatedBytes() const noexcept;
+
+            /**
+             * @return The number of allocations the client has made and not yet freed.
+             */
+            size_t GetAllocationCount() const noexcept;
+
             /**
              * Subscribes to the accepted topic of the CreateCertificateFromCsr operation.
              *
@@ -83,9 +110,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToCreateCertificateFromCsrAccepted(
+            SubscriptionHandle SubscribeToCreateCertificateFromCsrAccepted(
                 const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToCreateCertificateFromCsrAcceptedResponse &handler,
@@ -108,9 +136,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToCreateCertificateFromCsrRejected(
+            SubscriptionHandle SubscribeToCreateCertificateFromCsrRejected(
                 const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToCreateCertificateFromCsrRejectedResponse &handler,
@@ -133,9 +162,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToCreateKeysAndCertificateAccepted(
+            SubscriptionHandle SubscribeToCreateKeysAndCertificateAccepted(
                 const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToCreateKeysAndCertificateAcceptedResponse &handler,
@@ -158,9 +188,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToCreateKeysAndCertificateRejected(
+            SubscriptionHandle SubscribeToCreateKeysAndCertificateRejected(
                 const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToCreateKeysAndCertificateRejectedResponse &handler,
@@ -183,9 +214,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToRegisterThingAccepted(
+            SubscriptionHandle SubscribeToRegisterThingAccepted(
                 const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToRegisterThingAcceptedResponse &handler,
@@ -208,9 +240,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToRegisterThingRejected(
+            SubscriptionHandle SubscribeToRegisterThingRejected(
                 const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToRegisterThingRejectedResponse &handler,
@@ -292,7 +325,12 @@ namespace Aws
                 const OnPublishComplete &onPubAck);
 
           private:
+            /* Counts what the client allocates. Shared with the buffer pool and subscription registry, which may
+             * outlive the client. */
+            std::shared_ptr<Aws::Crt::Allocator> m_allocator;
             std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
+            std::shared_ptr<SubscriptionRegistry> m_subscriptions;
+            std::shared_ptr<PublishBufferPool> m_publishBuffers;
         };
 
     } // namespace Iotidentity
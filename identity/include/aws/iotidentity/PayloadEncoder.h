@@ -0,0 +1,37 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotservicecommon/PayloadWriter.h>
+
+#include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
+#include <aws/iotidentity/CreateKeysAndCertificateRequest.h>
+#include <aws/iotidentity/Exports.h>
+#include <aws/iotidentity/RegisterThingRequest.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        /* The writer and buffer pool are shared with the other service clients. */
+        using JsonPayloadWriter = Aws::Iotservicecommon::JsonPayloadWriter;
+        using PublishBufferPool = Aws::Iotservicecommon::PublishBufferPool;
+
+        /**
+         * Serialize a request into `payload` as SerializeToObject would, without building a JsonObject.
+         * @return false if `payload` could not be grown.
+         */
+        AWS_IOTIDENTITY_API bool EncodePayload(
+            const CreateCertificateFromCsrRequest &request,
+            Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTIDENTITY_API bool EncodePayload(
+            const CreateKeysAndCertificateRequest &request,
+            Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTIDENTITY_API bool EncodePayload(
+            const RegisterThingRequest &request,
+            Aws::Crt::ByteBuf &payload) noexcept;
+    } // namespace Iotidentity
+} // namespace Aws
@@ -0,0 +1,118 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
+#include <aws/iotidentity/CreateKeysAndCertificateResponse.h>
+#include <aws/iotidentity/ErrorResponse.h>
+#include <aws/iotidentity/IotIdentityClient.h>
+#include <aws/iotidentity/RegisterThingResponse.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        /**
+         * How long each stage of a provisioning flow took.
+         */
+        struct AWS_IOTIDENTITY_API ProvisioningTimings
+        {
+            /* From the start of the flow until every response topic was subscribed to. */
+            std::chrono::milliseconds subscribe;
+            /* From publishing the certificate request until it was accepted. */
+            std::chrono::milliseconds createCertificate;
+            /* From publishing the RegisterThing request until it was accepted. */
+            std::chrono::milliseconds registerThing;
+            /* From the start of the flow until it completed. */
+            std::chrono::milliseconds total;
+        };
+
+        /**
+         * The outcome of a provisioning flow.
+         */
+        struct AWS_IOTIDENTITY_API ProvisioningOutcome
+        {
+            /* An error from subscribing or publishing, or AWS_OP_SUCCESS. */
+            int errorCode;
+            /* Set if the service rejected a request. */
+            Aws::Crt::Optional<ErrorResponse> rejection;
+            /* Set when the flow created the certificate with CreateKeysAndCertificate. */
+            Aws::Crt::Optional<CreateKeysAndCertificateResponse> keysAndCertificate;
+            /* Set when the flow created the certificate with CreateCertificateFromCsr. */
+            Aws::Crt::Optional<CreateCertificateFromCsrResponse> certificateFromCsr;
+            /* Set once the thing has been registered. */
+            Aws::Crt::Optional<RegisterThingResponse> registeredThing;
+            ProvisioningTimings timings;
+
+            /**
+             * @return True if the thing was registered.
+             */
+            bool Succeeded() const noexcept { return registeredThing.has_value(); }
+        };
+
+        struct ProvisioningFlowState;
+
+        /**
+         * Runs fleet provisioning by claim over an IotIdentityClient: creates a certificate, then registers a thing
+         * with it.
+         *
+         * Each stage starts as soon as the previous one allows it, rather than after a fixed delay. The accepted and
+         * rejected topics of both requests are subscribed to in a single batch. The certificate request is published
+         * once every SUBACK has arrived, and RegisterThing is published from the callback that accepts the
+         * certificate. The subscriptions are released once the provisioning finishes, however it finishes.
+         *
+         * One provisioning runs at a time: starting another, or destroying the flow, resolves the one in progress
+         * with AWS_ERROR_INVALID_STATE.
+         */
+        class AWS_IOTIDENTITY_API ProvisioningFlow final
+        {
+          public:
+            /**
+             * @param client Client whose connection is established and stays open while flows run.
+             * @param qos The QoS used for every subscription and publish.
+             */
+            explicit ProvisioningFlow(
+                const IotIdentityClient &client,
+                Aws::Crt::Mqtt::QOS qos = AWS_MQTT_QOS_AT_LEAST_ONCE) noexcept;
+            ~ProvisioningFlow() noexcept;
+            ProvisioningFlow(const ProvisioningFlow &) = delete;
+            ProvisioningFlow &operator=(const ProvisioningFlow &) = delete;
+
+            /**
+             * Create a new key pair and certificate with CreateKeysAndCertificate, then register a thing with it.
+             * @param templateName The provisioning template to register the thing with.
+             * @param parameters Parameters passed to the provisioning template.
+             * @return Future that is resolved when the thing is registered or a stage fails.
+             */
+            std::future<ProvisioningOutcome> ProvisionWithNewKeys(
+                const Aws::Crt::String &templateName,
+                const Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> &parameters);
+
+            /**
+             * Create a certificate from a certificate signing request with CreateCertificateFromCsr, then register
+             * a thing with it.
+             * @param certificateSigningRequest The PEM encoded certificate signing request.
+             * @param templateName The provisioning template to register the thing with.
+             * @param parameters Parameters passed to the provisioning template.
+             * @return Future that is resolved when the thing is registered or a stage fails.
+             */
+            std::future<ProvisioningOutcome> ProvisionWithCsr(
+                const Aws::Crt::String &certificateSigningRequest,
+                const Aws::Crt::String &templateName,
+                const Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> &parameters);
+
+          private:
+            std::future<ProvisioningOutcome> Start(const std::shared_ptr<ProvisioningFlowState> &state);
+
+            IotIdentityClient m_client;
+            Aws::Crt::Mqtt::QOS m_qos;
+            std::shared_ptr<ProvisioningFlowState> m_activeFlow;
+        };
+    } // namespace Iotidentity
+} // namespace Aws
@@ -0,0 +1,20 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotservicecommon/SubscriptionRegistry.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        /**
+         * Identifies one subscription made through IotIdentityClient. See Aws::Iotservicecommon::SubscriptionHandle.
+         */
+        using SubscriptionHandle = Aws::Iotservicecommon::SubscriptionHandle;
+        using ScopedSubscription = Aws::Iotservicecommon::ScopedSubscription;
+        using SubscriptionRegistry = Aws::Iotservicecommon::SubscriptionRegistry;
+    } // namespace Iotidentity
+} // namespace Aws
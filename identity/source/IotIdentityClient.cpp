@@ -5,6 +5,9 @@
  */
 #include <aws/iotidentity/IotIdentityClient.h>
 
+#include <aws/iotdevicecommon/Tracing.h>
+#include <aws/iotservicecommon/CountingAllocator.h>
+
 #include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
 #include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
 #include <aws/iotidentity/CreateCertificateFromCsrSubscriptionRequest.h>
@@ -12,6 +15,7 @@
 #include <aws/iotidentity/CreateKeysAndCertificateResponse.h>
 #include <aws/iotidentity/CreateKeysAndCertificateSubscriptionRequest.h>
 #include <aws/iotidentity/ErrorResponse.h>
+#include <aws/iotidentity/PayloadEncoder.h>
 #include <aws/iotidentity/RegisterThingRequest.h>
 #include <aws/iotidentity/RegisterThingResponse.h>
 #include <aws/iotidentity/RegisterThingSubscriptionRequest.h>
@@ -21,34 +25,77 @@ namespace Aws
     namespace Iotidentity
     {
 
-        IotIdentityClient::IotIdentityClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection)
-            : m_connection(connection)
+#ifdef AWS_IOT_SDK_TRACING
+        static uint64_t s_startDispatchTrace()
+        {
+            return Aws::Iotdevicecommon::Tracing::IsEnabled() ? Aws::Iotdevicecommon::Tracing::NowNanoseconds() : 0;
+        }
+
+        static void s_markDispatchTrace(Aws::Iotservicecommon::DispatchPhase phase, uint64_t startNs)
+        {
+            Aws::Iotdevicecommon::Tracing::Record(
+                Aws::Iotdevicecommon::TraceSubsystem::Identity,
+                phase == Aws::Iotservicecommon::DispatchPhase::HandlersFound
+                    ? Aws::Iotdevicecommon::TracePhase::ResponseReceived
+                    : Aws::Iotdevicecommon::TracePhase::HandlerDone,
+                Aws::Iotdevicecommon::Tracing::NowNanoseconds() - startNs);
+        }
+#endif
+
+        /* The registry is shared with the other service clients, which trace into their own subsystems. */
+        static Aws::Iotservicecommon::DispatchTraceHooks s_dispatchTraceHooks() noexcept
+        {
+            Aws::Iotservicecommon::DispatchTraceHooks traceHooks;
+#ifdef AWS_IOT_SDK_TRACING
+            traceHooks.Start = s_startDispatchTrace;
+            traceHooks.Mark = s_markDispatchTrace;
+#endif
+            return traceHooks;
+        }
+
+        IotIdentityClient::IotIdentityClient(
+            const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+            Aws::Crt::Allocator *allocator)
+            : m_allocator(Aws::Iotservicecommon::CountingAllocator::Create(allocator)), m_connection(connection),
+              m_subscriptions(std::make_shared<SubscriptionRegistry>(connection, m_allocator, s_dispatchTraceHooks())),
+              m_publishBuffers(std::make_shared<PublishBufferPool>(m_allocator))
         {
         }
 
-        IotIdentityClient::IotIdentityClient(const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client)
+        IotIdentityClient::IotIdentityClient(
+            const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client,
+            Aws::Crt::Allocator *allocator)
+            : m_allocator(Aws::Iotservicecommon::CountingAllocator::Create(allocator))
         {
             m_connection = Aws::Crt::Mqtt::MqttConnection::NewConnectionFromMqtt5Client(mqtt5Client);
+            m_subscriptions = std::make_shared<SubscriptionRegistry>(m_connection, m_allocator, s_dispatchTraceHooks());
+            m_publishBuffers = std::make_shared<PublishBufferPool>(m_allocator);
         }
 
         IotIdentityClient::operator bool() const noexcept { return m_connection && *m_connection; }
 
         int IotIdentityClient::GetLastError() const noexcept { return aws_last_error(); }
 
-        bool IotIdentityClient::SubscribeToCreateCertificateFromCsrAccepted(
+        Aws::Crt::Allocator *IotIdentityClient::GetAllocator() const noexcept { return m_allocator.get(); }
+
+        size_t IotIdentityClient::GetAllocatedBytes() const noexcept
+        {
+            return Aws::Iotservicecommon::CountingAllocator::GetAllocatedBytes(m_allocator.get());
+        }
+
+        size_t IotIdentityClient::GetAllocationCount() const noexcept
+        {
+            return Aws::Iotservicecommon::CountingAllocator::GetAllocationCount(m_allocator.get());
+        }
+
+        SubscriptionHandle IotIdentityClient::SubscribeToCreateCertificateFromCsrAccepted(
             const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToCreateCertificateFromCsrAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -60,14 +107,12 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::CreateCertificateFromCsrResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
+                Aws::Crt::JsonObject jsonObject(objectStr);
+                Aws::Iotidentity::CreateCertificateFromCsrResponse response(jsonObject);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -80,27 +125,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotIdentityClient::SubscribeToCreateCertificateFromCsrRejected(
+        SubscriptionHandle IotIdentityClient::SubscribeToCreateCertificateFromCsrRejected(
             const Aws::Iotidentity::CreateCertificateFromCsrSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToCreateCertificateFromCsrRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -112,14 +148,12 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
+                Aws::Crt::JsonObject jsonObject(objectStr);
+                Aws::Iotidentity::ErrorResponse response(jsonObject);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -132,27 +166,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotIdentityClient::SubscribeToCreateKeysAndCertificateAccepted(
+        SubscriptionHandle IotIdentityClient::SubscribeToCreateKeysAndCertificateAccepted(
             const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToCreateKeysAndCertificateAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -164,14 +189,12 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::CreateKeysAndCertificateResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
+                Aws::Crt::JsonObject jsonObject(objectStr);
+                Aws::Iotidentity::CreateKeysAndCertificateResponse response(jsonObject);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -184,27 +207,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotIdentityClient::SubscribeToCreateKeysAndCertificateRejected(
+        SubscriptionHandle IotIdentityClient::SubscribeToCreateKeysAndCertificateRejected(
             const Aws::Iotidentity::CreateKeysAndCertificateSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToCreateKeysAndCertificateRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -216,14 +230,12 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
+                Aws::Crt::JsonObject jsonObject(objectStr);
+                Aws::Iotidentity::ErrorResponse response(jsonObject);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -236,27 +248,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotIdentityClient::SubscribeToRegisterThingAccepted(
+        SubscriptionHandle IotIdentityClient::SubscribeToRegisterThingAccepted(
             const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToRegisterThingAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -268,14 +271,12 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::RegisterThingResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
+                Aws::Crt::JsonObject jsonObject(objectStr);
+                Aws::Iotidentity::RegisterThingResponse response(jsonObject);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -288,27 +289,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotIdentityClient::SubscribeToRegisterThingRejected(
+        SubscriptionHandle IotIdentityClient::SubscribeToRegisterThingRejected(
             const Aws::Iotidentity::RegisterThingSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToRegisterThingRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -320,14 +312,12 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotidentity::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
+                Aws::Crt::JsonObject jsonObject(objectStr);
+                Aws::Iotidentity::ErrorResponse response(jsonObject);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -340,11 +330,8 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
         bool IotIdentityClient::PublishCreateCertificateFromCsr(
@@ -352,6 +339,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Identity);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -361,19 +349,30 @@ namespace Aws
                              << "/"
                              << "json";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotidentity::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotIdentityClient::PublishCreateKeysAndCertificate(
@@ -381,6 +380,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Identity);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -390,19 +390,30 @@ namespace Aws
                              << "/"
                              << "json";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotidentity::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotIdentityClient::PublishRegisterThing(
@@ -410,6 +421,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Identity);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -419,19 +431,30 @@ namespace Aws
                              << "/"
                              << "json";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotidentity::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
     } // namespace Iotidentity
@@ -0,0 +1,41 @@
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/PayloadEncoder.h>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        bool EncodePayload(const CreateCertificateFromCsrRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            JsonPayloadWriter writer(payload);
+            if (request.CertificateSigningRequest)
+            {
+                writer.WithString("certificateSigningRequest", *request.CertificateSigningRequest);
+            }
+            return writer.Finish();
+        }
+
+        bool EncodePayload(const CreateKeysAndCertificateRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            (void)request;
+            JsonPayloadWriter writer(payload);
+            return writer.Finish();
+        }
+
+        bool EncodePayload(const RegisterThingRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            JsonPayloadWriter writer(payload);
+            if (request.CertificateOwnershipToken)
+            {
+                writer.WithString("certificateOwnershipToken", *request.CertificateOwnershipToken);
+            }
+            if (request.Parameters)
+            {
+                writer.WithStringMap("parameters", *request.Parameters);
+            }
+            return writer.Finish();
+        }
+    } // namespace Iotidentity
+} // namespace Aws
@@ -0,0 +1,395 @@
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotidentity/ProvisioningFlow.h>
+
+#include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
+#include <aws/iotidentity/CreateCertificateFromCsrSubscriptionRequest.h>
+#include <aws/iotidentity/CreateKeysAndCertificateRequest.h>
+#include <aws/iotidentity/CreateKeysAndCertificateSubscriptionRequest.h>
+#include <aws/iotidentity/RegisterThingRequest.h>
+#include <aws/iotidentity/RegisterThingSubscriptionRequest.h>
+
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotidentity
+    {
+        using Clock = std::chrono::steady_clock;
+
+        enum class ProvisioningStage
+        {
+            Subscribing,
+            CreatingCertificate,
+            RegisteringThing,
+            Done
+        };
+
+        struct ProvisioningFlowState
+        {
+            ProvisioningFlowState(const IotIdentityClient &identityClient, Aws::Crt::Mqtt::QOS requestQos, bool withCsr)
+                : client(identityClient), qos(requestQos), useCsr(withCsr), stage(ProvisioningStage::Subscribing),
+                  pendingSubAcks(4), startTime(Clock::now()), stageStartTime(startTime)
+            {
+                outcome.errorCode = AWS_OP_SUCCESS;
+                outcome.timings.subscribe = std::chrono::milliseconds(0);
+                outcome.timings.createCertificate = std::chrono::milliseconds(0);
+                outcome.timings.registerThing = std::chrono::milliseconds(0);
+                outcome.timings.total = std::chrono::milliseconds(0);
+            }
+
+            IotIdentityClient client;
+            Aws::Crt::Mqtt::QOS qos;
+            bool useCsr;
+            CreateCertificateFromCsrRequest csrRequest;
+            RegisterThingRequest registerRequest;
+
+            std::mutex lock;
+            ProvisioningStage stage;
+            /* The accepted and rejected topics of both the certificate request and RegisterThing. */
+            size_t pendingSubAcks;
+            Clock::time_point startTime;
+            Clock::time_point stageStartTime;
+            ProvisioningOutcome outcome;
+            std::promise<ProvisioningOutcome> promise;
+            /* Released once the flow is done, so that each flow leaves no handlers behind in the client. */
+            Aws::Crt::Vector<SubscriptionHandle> subscriptions;
+        };
+
+        static std::chrono::milliseconds s_elapsedSince(Clock::time_point start)
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+        }
+
+        /* Must be called with the state locked. The registry invokes handlers unlocked, so this may run from one. */
+        static void s_unsubscribe(ProvisioningFlowState &state)
+        {
+            for (SubscriptionHandle &subscription : state.subscriptions)
+            {
+                subscription.Unsubscribe();
+            }
+            state.subscriptions.clear();
+        }
+
+        /* Must be called with the state locked. */
+        static void s_finish(ProvisioningFlowState &state, int errorCode, const ErrorResponse *rejection)
+        {
+            state.stage = ProvisioningStage::Done;
+            s_unsubscribe(state);
+            state.outcome.errorCode = errorCode;
+            if (rejection != nullptr)
+            {
+                state.outcome.rejection = *rejection;
+            }
+            state.outcome.timings.total = s_elapsedSince(state.startTime);
+            state.promise.set_value(state.outcome);
+        }
+
+        static void s_fail(
+            const std::weak_ptr<ProvisioningFlowState> &weakState,
+            int errorCode,
+            const ErrorResponse *rejection)
+        {
+            auto state = weakState.lock();
+            if (!state)
+            {
+                return;
+            }
+
+            const std::lock_guard<std::mutex> lock(state->lock);
+            if (state->stage != ProvisioningStage::Done)
+            {
+                s_finish(*state, errorCode, rejection);
+            }
+        }
+
+        static void s_onPublishComplete(const std::weak_ptr<ProvisioningFlowState> &weakState, int ioErr)
+        {
+            if (ioErr != AWS_OP_SUCCESS)
+            {
+                s_fail(weakState, ioErr, nullptr);
+            }
+        }
+
+        static void s_publishCertificateRequest(const std::shared_ptr<ProvisioningFlowState> &state)
+        {
+            std::weak_ptr<ProvisioningFlowState> weakState = state;
+            auto onPubAck = [weakState](int ioErr) { s_onPublishComplete(weakState, ioErr); };
+
+            bool published = false;
+            if (state->useCsr)
+            {
+                published = state->client.PublishCreateCertificateFromCsr(state->csrRequest, state->qos, onPubAck);
+            }
+            else
+            {
+                published = state->client.PublishCreateKeysAndCertificate(
+                    CreateKeysAndCertificateRequest(), state->qos, onPubAck);
+            }
+
+            if (!published)
+            {
+                s_fail(weakState, state->client.GetLastError(), nullptr);
+            }
+        }
+
+        static void s_onSubAck(const std::weak_ptr<ProvisioningFlowState> &weakState, int ioErr)
+        {
+            auto state = weakState.lock();
+            if (!state)
+            {
+                return;
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock(state->lock);
+                if (state->stage != ProvisioningStage::Subscribing)
+                {
+                    return;
+                }
+                if (ioErr != AWS_OP_SUCCESS)
+                {
+                    s_finish(*state, ioErr, nullptr);
+                    return;
+                }
+                if (--state->pendingSubAcks > 0)
+                {
+                    return;
+                }
+
+                state->outcome.timings.subscribe = s_elapsedSince(state->startTime);
+                state->stage = ProvisioningStage::CreatingCertificate;
+                state->stageStartTime = Clock::now();
+            }
+
+            s_publishCertificateRequest(state);
+        }
+
+        /* Registers the thing as soon as the certificate has been created, from the callback that accepted it. */
+        static void s_onCertificateAccepted(
+            const std::weak_ptr<ProvisioningFlowState> &weakState,
+            const CreateKeysAndCertificateResponse *keysResponse,
+            const CreateCertificateFromCsrResponse *csrResponse)
+        {
+            auto state = weakState.lock();
+            if (!state)
+            {
+                return;
+            }
+
+            RegisterThingRequest registerRequest;
+            {
+                const std::lock_guard<std::mutex> lock(state->lock);
+                if (state->stage != ProvisioningStage::CreatingCertificate)
+                {
+                    return;
+                }
+
+                if (keysResponse != nullptr)
+                {
+                    state->outcome.keysAndCertificate = *keysResponse;
+                    state->registerRequest.CertificateOwnershipToken = keysResponse->CertificateOwnershipToken;
+                }
+                else
+                {
+                    state->outcome.certificateFromCsr = *csrResponse;
+                    state->registerRequest.CertificateOwnershipToken = csrResponse->CertificateOwnershipToken;
+                }
+                state->outcome.timings.createCertificate = s_elapsedSince(state->stageStartTime);
+                state->stage = ProvisioningStage::RegisteringThing;
+                state->stageStartTime = Clock::now();
+                registerRequest = state->registerRequest;
+            }
+
+            auto onPubAck = [weakState](int ioErr) { s_onPublishComplete(weakState, ioErr); };
+            if (!state->client.PublishRegisterThing(registerRequest, state->qos, onPubAck))
+            {
+                s_fail(weakState, state->client.GetLastError(), nullptr);
+            }
+        }
+
+        static void s_onRegisterAccepted(
+            const std::weak_ptr<ProvisioningFlowState> &weakState,
+            const RegisterThingResponse &response)
+        {
+            auto state = weakState.lock();
+            if (!state)
+            {
+                return;
+            }
+
+            const std::lock_guard<std::mutex> lock(state->lock);
+            if (state->stage != ProvisioningStage::RegisteringThing)
+            {
+                return;
+            }
+            state->outcome.registeredThing = response;
+            state->outcome.timings.registerThing = s_elapsedSince(state->stageStartTime);
+            s_finish(*state, AWS_OP_SUCCESS, nullptr);
+        }
+
+        static void s_onRejected(
+            const std::weak_ptr<ProvisioningFlowState> &weakState,
+            ProvisioningStage rejectedStage,
+            const ErrorResponse &error)
+        {
+            auto state = weakState.lock();
+            if (!state)
+            {
+                return;
+            }
+
+            const std::lock_guard<std::mutex> lock(state->lock);
+            if (state->stage == rejectedStage)
+            {
+                s_finish(*state, AWS_OP_SUCCESS, &error);
+            }
+        }
+
+        /* Resolves a flow that is still running when it is replaced or its ProvisioningFlow is destroyed. */
+        static void s_abandon(const std::shared_ptr<ProvisioningFlowState> &state)
+        {
+            if (!state)
+            {
+                return;
+            }
+
+            const std::lock_guard<std::mutex> lock(state->lock);
+            if (state->stage != ProvisioningStage::Done)
+            {
+                s_finish(*state, AWS_ERROR_INVALID_STATE, nullptr);
+            }
+        }
+
+        ProvisioningFlow::ProvisioningFlow(const IotIdentityClient &client, Aws::Crt::Mqtt::QOS qos) noexcept
+            : m_client(client), m_qos(qos)
+        {
+        }
+
+        ProvisioningFlow::~ProvisioningFlow() noexcept { s_abandon(m_activeFlow); }
+
+        std::future<ProvisioningOutcome> ProvisioningFlow::ProvisionWithNewKeys(
+            const Aws::Crt::String &templateName,
+            const Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> &parameters)
+        {
+            auto state = std::make_shared<ProvisioningFlowState>(m_client, m_qos, false);
+            state->registerRequest.TemplateName = templateName;
+            state->registerRequest.Parameters = parameters;
+            return Start(state);
+        }
+
+        std::future<ProvisioningOutcome> ProvisioningFlow::ProvisionWithCsr(
+            const Aws::Crt::String &certificateSigningRequest,
+            const Aws::Crt::String &templateName,
+            const Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> &parameters)
+        {
+            auto state = std::make_shared<ProvisioningFlowState>(m_client, m_qos, true);
+            state->csrRequest.CertificateSigningRequest = certificateSigningRequest;
+            state->registerRequest.TemplateName = templateName;
+            state->registerRequest.Parameters = parameters;
+            return Start(state);
+        }
+
+        std::future<ProvisioningOutcome> ProvisioningFlow::Start(const std::shared_ptr<ProvisioningFlowState> &state)
+        {
+            std::future<ProvisioningOutcome> outcomeFuture = state->promise.get_future();
+            /* The flow owns its subscriptions, so their handlers only hold on to it weakly. */
+            s_abandon(m_activeFlow);
+            m_activeFlow = state;
+            std::weak_ptr<ProvisioningFlowState> weakState = state;
+
+            auto onSubAck = [weakState](int ioErr) { s_onSubAck(weakState, ioErr); };
+            auto onRegisterAccepted = [weakState](RegisterThingResponse *response, int ioErr) {
+                if (ioErr != AWS_OP_SUCCESS)
+                {
+                    s_fail(weakState, ioErr, nullptr);
+                    return;
+                }
+                s_onRegisterAccepted(weakState, *response);
+            };
+            auto onRegisterRejected = [weakState](ErrorResponse *error, int ioErr) {
+                if (ioErr != AWS_OP_SUCCESS)
+                {
+                    s_fail(weakState, ioErr, nullptr);
+                    return;
+                }
+                s_onRejected(weakState, ProvisioningStage::RegisteringThing, *error);
+            };
+            auto onCertificateRejected = [weakState](ErrorResponse *error, int ioErr) {
+                if (ioErr != AWS_OP_SUCCESS)
+                {
+                    s_fail(weakState, ioErr, nullptr);
+                    return;
+                }
+                s_onRejected(weakState, ProvisioningStage::CreatingCertificate, *error);
+            };
+
+            Aws::Crt::Vector<SubscriptionHandle> subscriptions;
+            auto keep = [&subscriptions](const SubscriptionHandle &subscription) {
+                subscriptions.push_back(subscription);
+                return static_cast<bool>(subscription);
+            };
+
+            /* Every subscription is requested before any SUBACK is waited for. */
+            bool subscribed = false;
+            if (state->useCsr)
+            {
+                auto onCsrAccepted = [weakState](CreateCertificateFromCsrResponse *response, int ioErr) {
+                    if (ioErr != AWS_OP_SUCCESS)
+                    {
+                        s_fail(weakState, ioErr, nullptr);
+                        return;
+                    }
+                    s_onCertificateAccepted(weakState, nullptr, response);
+                };
+                CreateCertificateFromCsrSubscriptionRequest csrSubscriptionRequest;
+                subscribed = keep(m_client.SubscribeToCreateCertificateFromCsrAccepted(
+                                 csrSubscriptionRequest, m_qos, onCsrAccepted, onSubAck)) &&
+                             keep(m_client.SubscribeToCreateCertificateFromCsrRejected(
+                                 csrSubscriptionRequest, m_qos, onCertificateRejected, onSubAck));
+            }
+            else
+            {
+                auto onKeysAccepted = [weakState](CreateKeysAndCertificateResponse *response, int ioErr) {
+                    if (ioErr != AWS_OP_SUCCESS)
+                    {
+                        s_fail(weakState, ioErr, nullptr);
+                        return;
+                    }
+                    s_onCertificateAccepted(weakState, response, nullptr);
+                };
+                CreateKeysAndCertificateSubscriptionRequest keysSubscriptionRequest;
+                subscribed = keep(m_client.SubscribeToCreateKeysAndCertificateAccepted(
+                                 keysSubscriptionRequest, m_qos, onKeysAccepted, onSubAck)) &&
+                             keep(m_client.SubscribeToCreateKeysAndCertificateRejected(
+                                 keysSubscriptionRequest, m_qos, onCertificateRejected, onSubAck));
+            }
+
+            RegisterThingSubscriptionRequest registerSubscriptionRequest;
+            registerSubscriptionRequest.TemplateName = state->registerRequest.TemplateName;
+            subscribed = subscribed &&
+                         keep(m_client.SubscribeToRegisterThingAccepted(
+                             registerSubscriptionRequest, m_qos, onRegisterAccepted, onSubAck)) &&
+                         keep(m_client.SubscribeToRegisterThingRejected(
+                             registerSubscriptionRequest, m_qos, onRegisterRejected, onSubAck));
+
+            {
+                const std::lock_guard<std::mutex> lock(state->lock);
+                state->subscriptions = std::move(subscriptions);
+                /* A failed SUBACK may have finished the flow before its subscriptions were kept. */
+                if (state->stage == ProvisioningStage::Done)
+                {
+                    s_unsubscribe(*state);
+                }
+            }
+
+            if (!subscribed)
+            {
+                s_fail(weakState, m_client.GetLastError(), nullptr);
+            }
+
+            return outcomeFuture;
+        }
+    } // namespace Iotidentity
+} // namespace Aws
@@ -0,0 +1,220 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/iotidentity/IotIdentityClient.h>
+#include <aws/iotidentity/ProvisioningFlow.h>
+
+#include "LocalMqttBroker.h"
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <functional>
+#include <thread>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotidentity;
+
+struct ProvisioningFlowTestContext
+{
+    std::unique_ptr<ApiHandle> apiHandle;
+    std::unique_ptr<Io::EventLoopGroup> elGroup;
+    std::unique_ptr<Io::HostResolver> resolver;
+    std::unique_ptr<Io::ClientBootstrap> clientBootstrap;
+};
+
+static ProvisioningFlowTestContext s_testContext;
+
+static int s_testSetup(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ProvisioningFlowTestContext *>(ctx);
+
+    testContext->apiHandle = std::unique_ptr<ApiHandle>(new ApiHandle(allocator));
+    testContext->elGroup = std::unique_ptr<Io::EventLoopGroup>(new Io::EventLoopGroup(0, allocator));
+    testContext->resolver =
+        std::unique_ptr<Io::HostResolver>(new Io::DefaultHostResolver(*testContext->elGroup, 8, 30, allocator));
+    testContext->clientBootstrap = std::unique_ptr<Io::ClientBootstrap>(
+        new Io::ClientBootstrap(*testContext->elGroup, *testContext->resolver, allocator));
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static int s_testTeardown(struct aws_allocator *allocator, int setup_result, void *ctx)
+{
+    auto *testContext = static_cast<ProvisioningFlowTestContext *>(ctx);
+
+    testContext->elGroup.reset();
+    testContext->resolver.reset();
+    testContext->clientBootstrap.reset();
+    /* The ApiHandle must be deallocated last or a deadlock occurs. */
+    testContext->apiHandle.reset();
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static const std::chrono::milliseconds s_waitTimeout(10000);
+
+static bool s_waitFor(const std::function<bool()> &condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + s_waitTimeout;
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+/* Answers a request as the service would, on a response topic the client has subscribed to. */
+static bool s_deliver(Utils::LocalMqttBroker &broker, const char *topic, const char *payload)
+{
+    return broker.Publish(topic, ByteCursorFromCString(payload)) == 1;
+}
+
+static bool s_isSubscribedTo(const Utils::LocalMqttBroker &broker, const char *topic)
+{
+    for (const String &subscribed : broker.GetSubscribedFilters())
+    {
+        if (subscribed == topic)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int s_TestProvisioningFlowWithNewKeys(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ProvisioningFlowTestContext *>(ctx);
+
+    Utils::LocalMqttBroker broker(*testContext->elGroup, allocator);
+    ASSERT_TRUE(broker.Start());
+    broker.RecordPublishes("$aws/#");
+    {
+        Mqtt::MqttClient mqttClient(*testContext->clientBootstrap, allocator);
+        auto connection = broker.Connect(mqttClient, "provisioning-flow-test");
+        ASSERT_NOT_NULL(connection.get());
+        {
+            IotIdentityClient client(connection, allocator);
+            ProvisioningFlow flow(client);
+
+            Map<String, String> parameters;
+            parameters["SerialNumber"] = "1234";
+            std::future<ProvisioningOutcome> outcomeFuture = flow.ProvisionWithNewKeys("template-1", parameters);
+
+            /* The certificate is requested once every response topic is subscribed to. */
+            ASSERT_TRUE(broker.WaitForRecordedPublishes(1, s_waitTimeout));
+            ASSERT_TRUE(broker.GetRecordedPublishes()[0].topic == "$aws/certificates/create/json");
+            ASSERT_UINT_EQUALS(4, broker.GetSubscribedFilters().size());
+            ASSERT_TRUE(s_isSubscribedTo(broker, "$aws/certificates/create/json/accepted"));
+            ASSERT_TRUE(s_isSubscribedTo(broker, "$aws/provisioning-templates/template-1/provision/json/rejected"));
+
+            /* The thing is registered with the token of the certificate as soon as it is accepted. */
+            ASSERT_TRUE(s_deliver(
+                broker,
+                "$aws/certificates/create/json/accepted",
+                "{\"certificateId\":\"cert-1\",\"certificatePem\":\"pem\",\"privateKey\":\"key\","
+                "\"certificateOwnershipToken\":\"token-1\"}"));
+            ASSERT_TRUE(broker.WaitForRecordedPublishes(2, s_waitTimeout));
+            Utils::LocalMqttBroker::RecordedPublish registerThing = broker.GetRecordedPublishes()[1];
+            ASSERT_TRUE(registerThing.topic == "$aws/provisioning-templates/template-1/provision/json");
+            JsonObject registerPayload(registerThing.payload);
+            ASSERT_TRUE(registerPayload.View().GetString("certificateOwnershipToken") == "token-1");
+            ASSERT_TRUE(registerPayload.View().GetJsonObject("parameters").GetString("SerialNumber") == "1234");
+
+            ASSERT_TRUE(s_deliver(
+                broker,
+                "$aws/provisioning-templates/template-1/provision/json/accepted",
+                "{\"thingName\":\"thing-1\"}"));
+            ASSERT_TRUE(outcomeFuture.wait_for(s_waitTimeout) == std::future_status::ready);
+            ProvisioningOutcome outcome = outcomeFuture.get();
+            ASSERT_TRUE(outcome.Succeeded());
+            ASSERT_INT_EQUALS(AWS_OP_SUCCESS, outcome.errorCode);
+            ASSERT_TRUE(*outcome.keysAndCertificate->CertificateId == "cert-1");
+            ASSERT_TRUE(*outcome.registeredThing->ThingName == "thing-1");
+            ASSERT_TRUE(outcome.timings.total >= outcome.timings.registerThing);
+
+            /* A finished flow leaves no subscriptions behind. */
+            ASSERT_TRUE(s_waitFor([&broker]() { return broker.GetSubscribedFilters().empty(); }));
+        }
+        Utils::LocalMqttBroker::Disconnect(*connection);
+    }
+    broker.Stop();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    ProvisioningFlowWithNewKeys,
+    s_testSetup,
+    s_TestProvisioningFlowWithNewKeys,
+    s_testTeardown,
+    &s_testContext);
+
+static int s_TestProvisioningFlowRejected(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ProvisioningFlowTestContext *>(ctx);
+
+    Utils::LocalMqttBroker broker(*testContext->elGroup, allocator);
+    ASSERT_TRUE(broker.Start());
+    broker.RecordPublishes("$aws/#");
+    {
+        Mqtt::MqttClient mqttClient(*testContext->clientBootstrap, allocator);
+        auto connection = broker.Connect(mqttClient, "provisioning-flow-test");
+        ASSERT_NOT_NULL(connection.get());
+        {
+            IotIdentityClient client(connection, allocator);
+            std::future<ProvisioningOutcome> abandonedFuture;
+            {
+                ProvisioningFlow flow(client);
+
+                /* A rejected certificate request ends the flow without registering a thing. */
+                std::future<ProvisioningOutcome> outcomeFuture =
+                    flow.ProvisionWithCsr("csr", "template-1", Map<String, String>());
+                ASSERT_TRUE(broker.WaitForRecordedPublishes(1, s_waitTimeout));
+                Utils::LocalMqttBroker::RecordedPublish createCertificate = broker.GetRecordedPublishes()[0];
+                ASSERT_TRUE(createCertificate.topic == "$aws/certificates/create-from-csr/json");
+                JsonObject createPayload(createCertificate.payload);
+                ASSERT_TRUE(createPayload.View().GetString("certificateSigningRequest") == "csr");
+
+                ASSERT_TRUE(s_deliver(
+                    broker,
+                    "$aws/certificates/create-from-csr/json/rejected",
+                    "{\"statusCode\":400,\"errorCode\":\"InvalidCsr\",\"errorMessage\":\"bad csr\"}"));
+                ASSERT_TRUE(outcomeFuture.wait_for(s_waitTimeout) == std::future_status::ready);
+                ProvisioningOutcome outcome = outcomeFuture.get();
+                ASSERT_FALSE(outcome.Succeeded());
+                ASSERT_INT_EQUALS(AWS_OP_SUCCESS, outcome.errorCode);
+                ASSERT_INT_EQUALS(400, *outcome.rejection->StatusCode);
+                ASSERT_TRUE(*outcome.rejection->ErrorCode == "InvalidCsr");
+                ASSERT_FALSE(outcome.certificateFromCsr.has_value());
+                ASSERT_TRUE(s_waitFor([&broker]() { return broker.GetSubscribedFilters().empty(); }));
+
+                /* A flow still running when its ProvisioningFlow is destroyed is resolved, and unsubscribes. */
+                abandonedFuture = flow.ProvisionWithNewKeys("template-1", Map<String, String>());
+                ASSERT_TRUE(broker.WaitForRecordedPublishes(2, s_waitTimeout));
+                ASSERT_UINT_EQUALS(4, broker.GetSubscribedFilters().size());
+            }
+            ASSERT_TRUE(abandonedFuture.wait_for(s_waitTimeout) == std::future_status::ready);
+            ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, abandonedFuture.get().errorCode);
+            ASSERT_TRUE(s_waitFor([&broker]() { return broker.GetSubscribedFilters().empty(); }));
+        }
+        Utils::LocalMqttBroker::Disconnect(*connection);
+    }
+    broker.Stop();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    ProvisioningFlowRejected,
+    s_testSetup,
+    s_TestProvisioningFlowRejected,
+    s_testTeardown,
+    &s_testContext);
@@ -2,6 +2,7 @@ include(CMakeFindDependencyMacro)
 
 find_dependency(aws-crt-cpp)
 find_dependency(aws-c-iot)
+find_dependency(IotServiceCommon-cpp)
 
 macro(aws_load_targets type)
     include(${CMAKE_CURRENT_LIST_DIR}/${type}/@PROJECT_NAME@-targets.cmake)
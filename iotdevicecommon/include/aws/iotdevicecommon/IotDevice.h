@@ -17,16 +17,103 @@ namespace Aws
 
     namespace Iotdevicecommon
     {
+        /**
+         * The parts of the SDK whose allocations DeviceApiHandle can count separately. Each has its own allocator,
+         * which is passed to that part when it is created.
+         */
+        enum class AllocationSubsystem : uint8_t
+        {
+            /** The device library itself, and anything that is not attributed to another subsystem. */
+            Library,
+            Shadow,
+            Jobs,
+            Identity,
+            SecureTunneling,
+            DeviceDefender,
+            Ipc,
+            Count,
+        };
+
+        struct AWS_IOTDEVICECOMMON_API AllocationTrackingOptions
+        {
+            /**
+             * How many stack frames identify the call site of an allocation, up to 16. If this is 0, call sites are
+             * not recorded and counting an allocation costs a few atomic adds; otherwise each allocation also takes
+             * a stack trace and a lock, which is only worth it while looking for a leak.
+             */
+            size_t CallSiteDepth = 0;
+
+            /**
+             * How many call sites are recorded for each subsystem. Allocations from call sites beyond these are
+             * counted against an unnamed one.
+             */
+            size_t MaxCallSites = 256;
+        };
+
+        struct AWS_IOTDEVICECOMMON_API AllocationStats
+        {
+            /** The bytes allocated and not yet freed. */
+            size_t LiveBytes = 0;
+            /** The most bytes that were allocated and not yet freed at any one time. */
+            size_t PeakBytes = 0;
+            uint64_t LiveAllocations = 0;
+            uint64_t TotalAllocations = 0;
+        };
+
+        struct AWS_IOTDEVICECOMMON_API AllocationCallSite
+        {
+            /** The symbolized stack of the call site, innermost frame first. Empty for the unnamed call site. */
+            Crt::Vector<Crt::String> Frames;
+            size_t LiveBytes = 0;
+            uint64_t LiveAllocations = 0;
+            uint64_t TotalAllocations = 0;
+        };
+
+        class AllocationTracker;
 
         class AWS_IOTDEVICECOMMON_API DeviceApiHandle final
         {
           public:
             DeviceApiHandle(Crt::Allocator *allocator) noexcept;
+
+            /**
+             * Count what each subsystem allocates. The subsystems only use the counting allocators if they are
+             * created with the ones GetAllocator returns, and those must not be used after this handle is destroyed.
+             */
+            DeviceApiHandle(Crt::Allocator *allocator, const AllocationTrackingOptions &trackingOptions) noexcept;
             ~DeviceApiHandle();
             DeviceApiHandle(const DeviceApiHandle &) = delete;
             DeviceApiHandle(DeviceApiHandle &&) = delete;
             DeviceApiHandle &operator=(const DeviceApiHandle &) = delete;
             DeviceApiHandle &operator=(DeviceApiHandle &&) = delete;
+
+            bool IsTrackingAllocations() const noexcept;
+
+            /**
+             * @return The allocator to create `subsystem` with: one that counts its allocations if they are
+             * tracked, and the allocator this handle was created with otherwise.
+             */
+            Crt::Allocator *GetAllocator(AllocationSubsystem subsystem) const noexcept;
+
+            /**
+             * @return What `subsystem` has allocated so far. All zero if allocations are not tracked.
+             */
+            AllocationStats GetAllocationStats(AllocationSubsystem subsystem) const noexcept;
+
+            /**
+             * @return Up to `count` of the call sites of `subsystem` with the most live bytes, most first. Empty
+             * unless allocations are tracked with a CallSiteDepth.
+             */
+            Crt::Vector<AllocationCallSite> GetTopCallSites(AllocationSubsystem subsystem, size_t count) const noexcept;
+
+            /**
+             * Log the allocation stats of every subsystem that has allocated, at info level.
+             */
+            void LogAllocationStats() const noexcept;
+
+          private:
+            Crt::Allocator *m_allocator;
+            AllocationTracker *m_trackers[static_cast<size_t>(AllocationSubsystem::Count)];
         };
 
     } // namespace Iotdevicecommon
@@ -0,0 +1,193 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevicecommon/Exports.h>
+
+#include <chrono>
+
+namespace Aws
+{
+    namespace Crt
+    {
+        namespace Io
+        {
+            class EventLoopGroup;
+        }
+    } // namespace Crt
+
+    namespace Iotdevicecommon
+    {
+        /**
+         * The clients whose requests are traced.
+         */
+        enum class TraceSubsystem : uint8_t
+        {
+            Shadow,
+            Jobs,
+            Identity,
+            Discovery,
+            EventstreamRpc,
+            SecureTunneling,
+            Count,
+        };
+
+        /**
+         * The points in the life of a request at which its latency is recorded. Each is measured from the start of
+         * the request: for an outgoing request, when it was made; for an incoming message, when it arrived.
+         */
+        enum class TracePhase : uint8_t
+        {
+            /** The request has been serialized. */
+            Serialize,
+            /** The request has been handed to the connection. */
+            PublishQueued,
+            /** The connection has finished sending the request: a PUBACK for MQTT at QoS 1, a flush otherwise. */
+            PubAck,
+            /** An incoming message has been matched to its handler, or a response has been read in full. */
+            ResponseReceived,
+            /** The handler of an incoming message or response has returned. */
+            HandlerDone,
+            Count,
+        };
+
+        /**
+         * A snapshot of the latencies recorded for one phase of one subsystem's requests.
+         *
+         * Latencies are counted in buckets that are a power of two wide, split into eight, so a value read back from
+         * the histogram is within an eighth of the latency that was recorded.
+         */
+        class AWS_IOTDEVICECOMMON_API TraceHistogram final
+        {
+          public:
+            TraceHistogram() noexcept;
+
+            uint64_t GetCount() const noexcept { return m_count; }
+            std::chrono::nanoseconds GetMax() const noexcept { return std::chrono::nanoseconds(m_maxNs); }
+            std::chrono::nanoseconds GetMean() const noexcept;
+
+            /**
+             * @param percentile From 0 to 100.
+             * @return The latency that `percentile` percent of the recorded ones do not exceed.
+             */
+            std::chrono::nanoseconds GetValueAtPercentile(double percentile) const noexcept;
+
+            /**
+             * Values below 8ns have a bucket each; above that, each power of two up to 2^36ns (about 69 seconds) is
+             * split into eight. Longer latencies are counted in the last bucket.
+             */
+            static const size_t BucketCount = 272;
+
+          private:
+            friend class Tracing;
+
+            static size_t s_bucketOf(uint64_t nanoseconds) noexcept;
+            static uint64_t s_highestValueIn(size_t bucket) noexcept;
+
+            uint64_t m_buckets[BucketCount];
+            uint64_t m_count;
+            uint64_t m_sumNs;
+            uint64_t m_maxNs;
+        };
+
+        /**
+         * Latency tracing for the requests of the service clients.
+         *
+         * The clients only record latencies when they are built with AWS_IOT_SDK_TRACING; otherwise the trace points
+         * compile to nothing. Even then, nothing is recorded until tracing is enabled, and a disabled trace point
+         * costs one load and branch.
+         *
+         * Each thread records into its own histograms, which it allocates the first time it records for a phase, so
+         * recording takes no lock. Reads sum the histograms of every thread.
+         */
+        class AWS_IOTDEVICECOMMON_API Tracing final
+        {
+          public:
+            static void SetEnabled(bool enabled) noexcept;
+            static bool IsEnabled() noexcept;
+
+            static void Record(TraceSubsystem subsystem, TracePhase phase, uint64_t nanoseconds) noexcept;
+
+            static TraceHistogram GetHistogram(TraceSubsystem subsystem, TracePhase phase) noexcept;
+
+            /**
+             * Forget every latency recorded so far. Latencies recorded while this runs may be kept or lost.
+             */
+            static void Reset() noexcept;
+
+            /**
+             * Log the count, percentiles and maximum of every phase with latencies, at info level, every
+             * `interval`. A previous periodic log is replaced.
+             *
+             * @param eventLoopGroup Runs the timer. The default event loop group is used if this is null.
+             * @return false if the timer could not be scheduled.
+             */
+            static bool StartPeriodicLog(
+                std::chrono::milliseconds interval,
+                Aws::Crt::Io::EventLoopGroup *eventLoopGroup = nullptr) noexcept;
+            static void StopPeriodicLog() noexcept;
+
+            /**
+             * Log every phase with latencies once, at info level.
+             */
+            static void LogHistograms() noexcept;
+
+            static const char *GetSubsystemName(TraceSubsystem subsystem) noexcept;
+            static const char *GetPhaseName(TracePhase phase) noexcept;
+
+            static uint64_t NowNanoseconds() noexcept
+            {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                 std::chrono::steady_clock::now().time_since_epoch())
+                                                 .count());
+            }
+        };
+
+        /**
+         * The start of a traced request, from which the latency of each of its phases is measured. A span that was
+         * started while tracing was disabled records nothing. It is small enough to be captured by value.
+         */
+        class TraceSpan final
+        {
+          public:
+            TraceSpan() noexcept : m_startNs(0), m_subsystem(TraceSubsystem::Count) {}
+            explicit TraceSpan(TraceSubsystem subsystem) noexcept
+                : m_startNs(Tracing::IsEnabled() ? Tracing::NowNanoseconds() : 0), m_subsystem(subsystem)
+            {
+            }
+
+            void Mark(TracePhase phase) const noexcept
+            {
+                if (m_startNs != 0)
+                {
+                    Tracing::Record(m_subsystem, phase, Tracing::NowNanoseconds() - m_startNs);
+                }
+            }
+
+          private:
+            uint64_t m_startNs;
+            TraceSubsystem m_subsystem;
+        };
+    } // namespace Iotdevicecommon
+} // namespace Aws
+
+/*
+ * Trace points for the service clients. They compile to nothing unless AWS_IOT_SDK_TRACING is defined, so that
+ * clients built without tracing do not depend on this library.
+ *
+ * AWS_IOT_TRACE_START declares a span named `span` and starts it. AWS_IOT_TRACE_CAPTURE goes at the end of the capture
+ * list of a lambda that marks the span.
+ */
+#ifdef AWS_IOT_SDK_TRACING
+#    define AWS_IOT_TRACE_START(span, subsystem)                                                                       \
+        const Aws::Iotdevicecommon::TraceSpan span(Aws::Iotdevicecommon::TraceSubsystem::subsystem)
+#    define AWS_IOT_TRACE_MARK(span, phase) (span).Mark(Aws::Iotdevicecommon::TracePhase::phase)
+#    define AWS_IOT_TRACE_CAPTURE(span) , span
+#else
+#    define AWS_IOT_TRACE_START(span, subsystem)
+#    define AWS_IOT_TRACE_MARK(span, phase)
+#    define AWS_IOT_TRACE_CAPTURE(span)
+#endif
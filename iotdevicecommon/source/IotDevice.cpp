@@ -5,6 +5,17 @@
 
 #include <aws/iotdevice/iotdevice.h>
 #include <aws/iotdevicecommon/IotDevice.h>
+#include <aws/iotservicecommon/CountingAllocator.h>
+
+#include <aws/common/logging.h>
+#include <aws/common/system_info.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
 
 namespace Aws
 {
@@ -16,10 +27,306 @@ namespace Aws
 
     namespace Iotdevicecommon
     {
+        static const char *s_subsystemNames[] = {
+            "library",
+            "shadow",
+            "jobs",
+            "identity",
+            "secure-tunneling",
+            "device-defender",
+            "ipc",
+        };
+        static_assert(
+            sizeof(s_subsystemNames) / sizeof(s_subsystemNames[0]) == static_cast<size_t>(AllocationSubsystem::Count),
+            "Every allocation subsystem needs a name");
+
+        static const size_t s_maxCallSiteDepth = 16;
+        /* aws_backtrace, AllocationTracker::s_acquire and aws_mem_acquire. */
+        static const size_t s_skippedFrames = 3;
+        /* Allocations whose call site was not recorded are counted against the first one. */
+        static const size_t s_unnamedCallSite = 0;
+
+        /**
+         * Counts what one subsystem allocates, through a counting allocator that wraps the one the subsystem would
+         * otherwise have used. With a CallSiteDepth, the call site of each allocation is recorded on top of it.
+         */
+        class AllocationTracker final
+        {
+          public:
+            AllocationTracker(Crt::Allocator *allocator, const AllocationTrackingOptions &options) noexcept
+                : m_counter(Iotservicecommon::CountingAllocator::Create(allocator)),
+                  m_callSiteDepth(std::min(options.CallSiteDepth, s_maxCallSiteDepth)),
+                  m_maxCallSites(std::max<size_t>(options.MaxCallSites, 1)), m_callSites(1)
+            {
+                AWS_ZERO_STRUCT(m_trackingAllocator);
+                m_trackingAllocator.mem_acquire = s_acquire;
+                m_trackingAllocator.mem_release = s_release;
+                m_trackingAllocator.impl = this;
+            }
+
+            explicit operator bool() const noexcept { return m_counter != nullptr; }
+
+            /* Without a CallSiteDepth, the subsystem allocates through the counting allocator directly. */
+            Crt::Allocator *GetAllocator() noexcept
+            {
+                return m_callSiteDepth > 0 ? &m_trackingAllocator : m_counter.get();
+            }
+
+            AllocationStats GetStats() const noexcept
+            {
+                AllocationStats stats;
+                stats.LiveBytes = Iotservicecommon::CountingAllocator::GetAllocatedBytes(m_counter.get());
+                stats.PeakBytes = Iotservicecommon::CountingAllocator::GetPeakBytes(m_counter.get());
+                stats.LiveAllocations = Iotservicecommon::CountingAllocator::GetAllocationCount(m_counter.get());
+                stats.TotalAllocations = Iotservicecommon::CountingAllocator::GetTotalAllocationCount(m_counter.get());
+                return stats;
+            }
+
+            Crt::Vector<AllocationCallSite> GetTopCallSites(size_t count) const noexcept;
+
+          private:
+            struct CallSite
+            {
+                CallSite() noexcept : depth(0), liveBytes(0), liveAllocations(0), totalAllocations(0) {}
+
+                void *frames[s_maxCallSiteDepth];
+                size_t depth;
+                size_t liveBytes;
+                uint64_t liveAllocations;
+                uint64_t totalAllocations;
+            };
+
+            struct LiveAllocation
+            {
+                size_t size;
+                size_t callSite;
+            };
+
+            static void *s_acquire(struct aws_allocator *allocator, size_t size);
+            static void s_release(struct aws_allocator *allocator, void *ptr);
+
+            size_t AddToCallSiteLocked(void *const *frames, size_t depth, size_t size) noexcept;
+
+            std::shared_ptr<Crt::Allocator> m_counter;
+            struct aws_allocator m_trackingAllocator;
+            size_t m_callSiteDepth;
+            size_t m_maxCallSites;
+
+            /* This mutex protects everything below it. Call sites are only recorded with a CallSiteDepth. */
+            mutable std::mutex m_callSitesMutex;
+            Crt::Vector<CallSite> m_callSites;
+            Crt::UnorderedMap<uint64_t, size_t> m_callSiteIndex;
+            /* The call site of every allocation not yet freed, kept aside so that the counting allocator's header
+             * is the only one an allocation carries. */
+            Crt::UnorderedMap<void *, LiveAllocation> m_liveAllocations;
+        };
+
+        void *AllocationTracker::s_acquire(struct aws_allocator *allocator, size_t size)
+        {
+            auto *tracker = static_cast<AllocationTracker *>(allocator->impl);
+            void *frames[s_skippedFrames + s_maxCallSiteDepth];
+            size_t depth = aws_backtrace(frames, s_skippedFrames + tracker->m_callSiteDepth);
+            depth = depth > s_skippedFrames ? depth - s_skippedFrames : 0;
+
+            void *ptr = aws_mem_acquire(tracker->m_counter.get(), size);
+            if (ptr == nullptr)
+            {
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(tracker->m_callSitesMutex);
+            LiveAllocation liveAllocation;
+            liveAllocation.size = size;
+            liveAllocation.callSite = tracker->AddToCallSiteLocked(frames + s_skippedFrames, depth, size);
+            tracker->m_liveAllocations.emplace(ptr, liveAllocation);
+            return ptr;
+        }
+
+        void AllocationTracker::s_release(struct aws_allocator *allocator, void *ptr)
+        {
+            auto *tracker = static_cast<AllocationTracker *>(allocator->impl);
+            {
+                std::lock_guard<std::mutex> lock(tracker->m_callSitesMutex);
+                auto liveAllocation = tracker->m_liveAllocations.find(ptr);
+                if (liveAllocation != tracker->m_liveAllocations.end())
+                {
+                    CallSite &callSite = tracker->m_callSites[liveAllocation->second.callSite];
+                    callSite.liveBytes -= liveAllocation->second.size;
+                    --callSite.liveAllocations;
+                    tracker->m_liveAllocations.erase(liveAllocation);
+                }
+            }
+            aws_mem_release(tracker->m_counter.get(), ptr);
+        }
+
+        size_t AllocationTracker::AddToCallSiteLocked(void *const *frames, size_t depth, size_t size) noexcept
+        {
+            /* FNV-1a over the return addresses. */
+            uint64_t hash = 14695981039346656037ULL;
+            for (size_t i = 0; i < depth; ++i)
+            {
+                hash = (hash ^ static_cast<uint64_t>(reinterpret_cast<uintptr_t>(frames[i]))) * 1099511628211ULL;
+            }
+
+            size_t index = s_unnamedCallSite;
+            auto indexIter = m_callSiteIndex.find(hash);
+            if (indexIter != m_callSiteIndex.end())
+            {
+                const CallSite &found = m_callSites[indexIter->second];
+                if (found.depth == depth && std::equal(frames, frames + depth, found.frames))
+                {
+                    index = indexIter->second;
+                }
+            }
+            else if (depth > 0 && m_callSites.size() <= m_maxCallSites)
+            {
+                index = m_callSites.size();
+                m_callSites.emplace_back();
+                std::copy(frames, frames + depth, m_callSites.back().frames);
+                m_callSites.back().depth = depth;
+                m_callSiteIndex.emplace(hash, index);
+            }
+
+            CallSite &callSite = m_callSites[index];
+            callSite.liveBytes += size;
+            ++callSite.liveAllocations;
+            ++callSite.totalAllocations;
+            return index;
+        }
+
+        Crt::Vector<AllocationCallSite> AllocationTracker::GetTopCallSites(size_t count) const noexcept
+        {
+            Crt::Vector<CallSite> callSites;
+            {
+                std::lock_guard<std::mutex> lock(m_callSitesMutex);
+                callSites = m_callSites;
+            }
+            /* The unnamed call site is only kept if something was counted against it. */
+            if (callSites[s_unnamedCallSite].totalAllocations == 0)
+            {
+                callSites.erase(callSites.begin() + s_unnamedCallSite);
+            }
+
+            std::sort(callSites.begin(), callSites.end(), [](const CallSite &left, const CallSite &right) {
+                return left.liveBytes > right.liveBytes;
+            });
+            callSites.resize(std::min(count, callSites.size()));
+
+            /* Symbolizing is slow, so it is done outside the lock, and only for the call sites that are returned. */
+            Crt::Vector<AllocationCallSite> topCallSites;
+            topCallSites.reserve(callSites.size());
+            for (const CallSite &callSite : callSites)
+            {
+                AllocationCallSite topCallSite;
+                topCallSite.LiveBytes = callSite.liveBytes;
+                topCallSite.LiveAllocations = callSite.liveAllocations;
+                topCallSite.TotalAllocations = callSite.totalAllocations;
+                char **symbols = callSite.depth > 0 ? aws_backtrace_symbols(callSite.frames, callSite.depth) : nullptr;
+                if (symbols != nullptr)
+                {
+                    for (size_t i = 0; i < callSite.depth; ++i)
+                    {
+                        topCallSite.Frames.emplace_back(symbols[i] != nullptr ? symbols[i] : "");
+                    }
+                    free(symbols);
+                }
+                topCallSites.push_back(std::move(topCallSite));
+            }
+            return topCallSites;
+        }
+
+        DeviceApiHandle::DeviceApiHandle(Crt::Allocator *allocator) noexcept : m_allocator(allocator), m_trackers()
+        {
+            aws_iotdevice_library_init(allocator);
+        }
+
+        DeviceApiHandle::DeviceApiHandle(
+            Crt::Allocator *allocator,
+            const AllocationTrackingOptions &trackingOptions) noexcept
+            : m_allocator(allocator), m_trackers()
+        {
+            for (auto &tracker : m_trackers)
+            {
+                tracker = Crt::New<AllocationTracker>(allocator, allocator, trackingOptions);
+                if (tracker != nullptr && !*tracker)
+                {
+                    Crt::Delete(tracker, allocator);
+                    tracker = nullptr;
+                }
+            }
+            aws_iotdevice_library_init(GetAllocator(AllocationSubsystem::Library));
+        }
+
+        DeviceApiHandle::~DeviceApiHandle()
+        {
+            aws_iotdevice_library_clean_up();
+
+            for (size_t subsystem = 0; subsystem < static_cast<size_t>(AllocationSubsystem::Count); ++subsystem)
+            {
+                AllocationTracker *tracker = m_trackers[subsystem];
+                if (tracker == nullptr)
+                {
+                    continue;
+                }
+                /* Memory that is still allocated is freed through its tracker, so a tracker with live allocations
+                 * is leaked rather than destroyed. */
+                AllocationStats stats = tracker->GetStats();
+                if (stats.LiveAllocations != 0)
+                {
+                    AWS_LOGF_WARN(
+                        AWS_LS_COMMON_GENERAL,
+                        "id=allocations: %s still has %llu allocations of %zu bytes in total when the device API "
+                        "handle is destroyed",
+                        s_subsystemNames[subsystem],
+                        static_cast<unsigned long long>(stats.LiveAllocations),
+                        stats.LiveBytes);
+                    continue;
+                }
+                Crt::Delete(tracker, m_allocator);
+            }
+        }
+
+        bool DeviceApiHandle::IsTrackingAllocations() const noexcept { return m_trackers[0] != nullptr; }
+
+        Crt::Allocator *DeviceApiHandle::GetAllocator(AllocationSubsystem subsystem) const noexcept
+        {
+            AllocationTracker *tracker = m_trackers[static_cast<size_t>(subsystem)];
+            return tracker != nullptr ? tracker->GetAllocator() : m_allocator;
+        }
+
+        AllocationStats DeviceApiHandle::GetAllocationStats(AllocationSubsystem subsystem) const noexcept
+        {
+            AllocationTracker *tracker = m_trackers[static_cast<size_t>(subsystem)];
+            return tracker != nullptr ? tracker->GetStats() : AllocationStats();
+        }
 
-        DeviceApiHandle::DeviceApiHandle(Crt::Allocator *allocator) noexcept { aws_iotdevice_library_init(allocator); }
+        Crt::Vector<AllocationCallSite> DeviceApiHandle::GetTopCallSites(
+            AllocationSubsystem subsystem,
+            size_t count) const noexcept
+        {
+            AllocationTracker *tracker = m_trackers[static_cast<size_t>(subsystem)];
+            return tracker != nullptr ? tracker->GetTopCallSites(count) : Crt::Vector<AllocationCallSite>();
+        }
 
-        DeviceApiHandle::~DeviceApiHandle() { aws_iotdevice_library_clean_up(); }
+        void DeviceApiHandle::LogAllocationStats() const noexcept
+        {
+            for (size_t subsystem = 0; subsystem < static_cast<size_t>(AllocationSubsystem::Count); ++subsystem)
+            {
+                AllocationStats stats = GetAllocationStats(static_cast<AllocationSubsystem>(subsystem));
+                if (stats.TotalAllocations == 0)
+                {
+                    continue;
+                }
+                AWS_LOGF_INFO(
+                    AWS_LS_COMMON_GENERAL,
+                    "id=allocations: %s: live=%zu bytes in %llu allocations peak=%zu bytes total=%llu allocations",
+                    s_subsystemNames[subsystem],
+                    stats.LiveBytes,
+                    static_cast<unsigned long long>(stats.LiveAllocations),
+                    stats.PeakBytes,
+                    static_cast<unsigned long long>(stats.TotalAllocations));
+            }
+        }
     } // namespace Iotdevicecommon
 
 } // namespace Aws
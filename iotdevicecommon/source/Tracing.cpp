@@ -0,0 +1,463 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotdevicecommon/Tracing.h>
+
+#include <aws/common/logging.h>
+#include <aws/crt/Api.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/io/event_loop.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotdevicecommon
+    {
+        static const size_t s_subBucketBits = 3;
+        static const size_t s_subBucketCount = size_t(1) << s_subBucketBits;
+        static const size_t s_histogramCount =
+            static_cast<size_t>(TraceSubsystem::Count) * static_cast<size_t>(TracePhase::Count);
+
+        /* One thread's counts for one phase. Only the owning thread adds to them, but they are atomic so that they
+         * can be read and reset from others. */
+        struct TraceCounts
+        {
+            TraceCounts() noexcept : count(0), sumNs(0), maxNs(0)
+            {
+                for (auto &bucket : buckets)
+                {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            std::atomic<uint64_t> buckets[TraceHistogram::BucketCount];
+            std::atomic<uint64_t> count;
+            std::atomic<uint64_t> sumNs;
+            std::atomic<uint64_t> maxNs;
+        };
+
+        struct TraceThreadCounts
+        {
+            TraceThreadCounts() noexcept
+            {
+                for (auto &counts : histograms)
+                {
+                    counts.store(nullptr, std::memory_order_relaxed);
+                }
+            }
+
+            ~TraceThreadCounts()
+            {
+                for (auto &counts : histograms)
+                {
+                    TraceCounts *owned = counts.load(std::memory_order_relaxed);
+                    if (owned != nullptr)
+                    {
+                        Aws::Crt::Delete(owned, aws_default_allocator());
+                    }
+                }
+            }
+
+            std::atomic<TraceCounts *> histograms[s_histogramCount];
+        };
+
+        /* Every thread's counts, and the counts of threads that have exited. It is never destroyed, since threads may
+         * exit after static destructors have run. */
+        struct TraceRegistry
+        {
+            std::mutex mutex;
+            Aws::Crt::Vector<TraceThreadCounts *> threads;
+            TraceThreadCounts exited;
+            uint64_t periodicLogGeneration = 0;
+        };
+
+        static std::atomic<bool> s_enabled(false);
+
+        static TraceRegistry &s_registry()
+        {
+            static TraceRegistry *registry = Aws::Crt::New<TraceRegistry>(aws_default_allocator());
+            return *registry;
+        }
+
+        static void s_addCounts(const TraceCounts &from, TraceCounts &to) noexcept
+        {
+            for (size_t i = 0; i < TraceHistogram::BucketCount; ++i)
+            {
+                to.buckets[i].fetch_add(from.buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            to.count.fetch_add(from.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            to.sumNs.fetch_add(from.sumNs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            uint64_t maxNs = from.maxNs.load(std::memory_order_relaxed);
+            if (maxNs > to.maxNs.load(std::memory_order_relaxed))
+            {
+                to.maxNs.store(maxNs, std::memory_order_relaxed);
+            }
+        }
+
+        /* Registers the thread's counts on first use, and folds them into the exited counts when the thread exits. */
+        class TraceThreadRegistration final
+        {
+          public:
+            TraceThreadRegistration() noexcept : m_counts(Aws::Crt::New<TraceThreadCounts>(aws_default_allocator()))
+            {
+                if (m_counts != nullptr)
+                {
+                    TraceRegistry &registry = s_registry();
+                    std::lock_guard<std::mutex> lock(registry.mutex);
+                    registry.threads.push_back(m_counts);
+                }
+            }
+
+            ~TraceThreadRegistration()
+            {
+                if (m_counts == nullptr)
+                {
+                    return;
+                }
+                TraceRegistry &registry = s_registry();
+                {
+                    std::lock_guard<std::mutex> lock(registry.mutex);
+                    registry.threads.erase(
+                        std::remove(registry.threads.begin(), registry.threads.end(), m_counts),
+                        registry.threads.end());
+                    for (size_t i = 0; i < s_histogramCount; ++i)
+                    {
+                        TraceCounts *counts = m_counts->histograms[i].load(std::memory_order_relaxed);
+                        if (counts == nullptr)
+                        {
+                            continue;
+                        }
+                        TraceCounts *exited = registry.exited.histograms[i].load(std::memory_order_relaxed);
+                        if (exited == nullptr)
+                        {
+                            exited = Aws::Crt::New<TraceCounts>(aws_default_allocator());
+                            if (exited == nullptr)
+                            {
+                                continue;
+                            }
+                            registry.exited.histograms[i].store(exited, std::memory_order_release);
+                        }
+                        s_addCounts(*counts, *exited);
+                    }
+                }
+                Aws::Crt::Delete(m_counts, aws_default_allocator());
+            }
+
+            TraceThreadCounts *GetCounts() const noexcept { return m_counts; }
+
+          private:
+            TraceThreadCounts *m_counts;
+        };
+
+        static TraceCounts *s_countsFor(size_t histogram) noexcept
+        {
+            static thread_local TraceThreadRegistration registration;
+            TraceThreadCounts *threadCounts = registration.GetCounts();
+            if (threadCounts == nullptr)
+            {
+                return nullptr;
+            }
+
+            TraceCounts *counts = threadCounts->histograms[histogram].load(std::memory_order_relaxed);
+            if (counts == nullptr)
+            {
+                counts = Aws::Crt::New<TraceCounts>(aws_default_allocator());
+                threadCounts->histograms[histogram].store(counts, std::memory_order_release);
+            }
+            return counts;
+        }
+
+        static size_t s_histogramIndex(TraceSubsystem subsystem, TracePhase phase) noexcept
+        {
+            return static_cast<size_t>(subsystem) * static_cast<size_t>(TracePhase::Count) +
+                   static_cast<size_t>(phase);
+        }
+
+        TraceHistogram::TraceHistogram() noexcept : m_count(0), m_sumNs(0), m_maxNs(0)
+        {
+            std::fill(m_buckets, m_buckets + BucketCount, 0);
+        }
+
+        std::chrono::nanoseconds TraceHistogram::GetMean() const noexcept
+        {
+            return std::chrono::nanoseconds(m_count == 0 ? 0 : m_sumNs / m_count);
+        }
+
+        std::chrono::nanoseconds TraceHistogram::GetValueAtPercentile(double percentile) const noexcept
+        {
+            if (m_count == 0)
+            {
+                return std::chrono::nanoseconds(0);
+            }
+
+            double clamped = (std::min)(100.0, (std::max)(0.0, percentile));
+            uint64_t rank = static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(m_count) + 0.5);
+            rank = (std::max)(uint64_t(1), (std::min)(rank, m_count));
+            uint64_t seen = 0;
+            for (size_t bucket = 0; bucket < BucketCount; ++bucket)
+            {
+                seen += m_buckets[bucket];
+                if (seen >= rank)
+                {
+                    /* The bucket's upper bound may exceed anything recorded. */
+                    return std::chrono::nanoseconds((std::min)(s_highestValueIn(bucket), m_maxNs));
+                }
+            }
+            return std::chrono::nanoseconds(m_maxNs);
+        }
+
+        size_t TraceHistogram::s_bucketOf(uint64_t nanoseconds) noexcept
+        {
+            if (nanoseconds < s_subBucketCount)
+            {
+                return static_cast<size_t>(nanoseconds);
+            }
+
+            size_t highestBit = 0;
+            for (uint64_t remaining = nanoseconds >> 1; remaining != 0; remaining >>= 1)
+            {
+                ++highestBit;
+            }
+            size_t shift = highestBit - s_subBucketBits;
+            size_t bucket = shift * s_subBucketCount + static_cast<size_t>(nanoseconds >> shift);
+            return (std::min)(bucket, BucketCount - 1);
+        }
+
+        uint64_t TraceHistogram::s_highestValueIn(size_t bucket) noexcept
+        {
+            if (bucket < s_subBucketCount)
+            {
+                return bucket;
+            }
+            size_t shift = bucket / s_subBucketCount - 1;
+            uint64_t subBucket = bucket % s_subBucketCount + s_subBucketCount;
+            return ((subBucket + 1) << shift) - 1;
+        }
+
+        void Tracing::SetEnabled(bool enabled) noexcept { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+        bool Tracing::IsEnabled() noexcept { return s_enabled.load(std::memory_order_relaxed); }
+
+        void Tracing::Record(TraceSubsystem subsystem, TracePhase phase, uint64_t nanoseconds) noexcept
+        {
+            TraceCounts *counts = s_countsFor(s_histogramIndex(subsystem, phase));
+            if (counts == nullptr)
+            {
+                return;
+            }
+
+            counts->buckets[TraceHistogram::s_bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+            counts->count.fetch_add(1, std::memory_order_relaxed);
+            counts->sumNs.fetch_add(nanoseconds, std::memory_order_relaxed);
+            if (nanoseconds > counts->maxNs.load(std::memory_order_relaxed))
+            {
+                counts->maxNs.store(nanoseconds, std::memory_order_relaxed);
+            }
+        }
+
+        TraceHistogram Tracing::GetHistogram(TraceSubsystem subsystem, TracePhase phase) noexcept
+        {
+            size_t index = s_histogramIndex(subsystem, phase);
+            TraceHistogram histogram;
+            auto addCounts = [&histogram](const TraceCounts *counts) {
+                if (counts == nullptr)
+                {
+                    return;
+                }
+                for (size_t i = 0; i < TraceHistogram::BucketCount; ++i)
+                {
+                    histogram.m_buckets[i] += counts->buckets[i].load(std::memory_order_relaxed);
+                }
+                histogram.m_count += counts->count.load(std::memory_order_relaxed);
+                histogram.m_sumNs += counts->sumNs.load(std::memory_order_relaxed);
+                histogram.m_maxNs = (std::max)(histogram.m_maxNs, counts->maxNs.load(std::memory_order_relaxed));
+            };
+
+            TraceRegistry &registry = s_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (const TraceThreadCounts *thread : registry.threads)
+            {
+                addCounts(thread->histograms[index].load(std::memory_order_acquire));
+            }
+            addCounts(registry.exited.histograms[index].load(std::memory_order_acquire));
+            return histogram;
+        }
+
+        void Tracing::Reset() noexcept
+        {
+            auto resetCounts = [](TraceCounts *counts) {
+                if (counts == nullptr)
+                {
+                    return;
+                }
+                for (auto &bucket : counts->buckets)
+                {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+                counts->count.store(0, std::memory_order_relaxed);
+                counts->sumNs.store(0, std::memory_order_relaxed);
+                counts->maxNs.store(0, std::memory_order_relaxed);
+            };
+
+            TraceRegistry &registry = s_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (size_t i = 0; i < s_histogramCount; ++i)
+            {
+                for (TraceThreadCounts *thread : registry.threads)
+                {
+                    resetCounts(thread->histograms[i].load(std::memory_order_acquire));
+                }
+                resetCounts(registry.exited.histograms[i].load(std::memory_order_acquire));
+            }
+        }
+
+        void Tracing::LogHistograms() noexcept
+        {
+            for (size_t subsystem = 0; subsystem < static_cast<size_t>(TraceSubsystem::Count); ++subsystem)
+            {
+                for (size_t phase = 0; phase < static_cast<size_t>(TracePhase::Count); ++phase)
+                {
+                    TraceHistogram histogram =
+                        GetHistogram(static_cast<TraceSubsystem>(subsystem), static_cast<TracePhase>(phase));
+                    if (histogram.GetCount() == 0)
+                    {
+                        continue;
+                    }
+                    AWS_LOGF_INFO(
+                        AWS_LS_COMMON_GENERAL,
+                        "id=tracing: %s %s: count=%llu p50=%lluns p90=%lluns p99=%lluns max=%lluns",
+                        GetSubsystemName(static_cast<TraceSubsystem>(subsystem)),
+                        GetPhaseName(static_cast<TracePhase>(phase)),
+                        static_cast<unsigned long long>(histogram.GetCount()),
+                        static_cast<unsigned long long>(histogram.GetValueAtPercentile(50).count()),
+                        static_cast<unsigned long long>(histogram.GetValueAtPercentile(90).count()),
+                        static_cast<unsigned long long>(histogram.GetValueAtPercentile(99).count()),
+                        static_cast<unsigned long long>(histogram.GetMax().count()));
+                }
+            }
+        }
+
+        struct PeriodicLogTask
+        {
+            struct aws_task task;
+            struct aws_event_loop *eventLoop;
+            uint64_t intervalNs;
+            uint64_t generation;
+        };
+
+        static void s_schedulePeriodicLog(PeriodicLogTask *periodicLog) noexcept
+        {
+            uint64_t runAt = 0;
+            aws_event_loop_current_clock_time(periodicLog->eventLoop, &runAt);
+            aws_event_loop_schedule_task_future(
+                periodicLog->eventLoop, &periodicLog->task, runAt + periodicLog->intervalNs);
+        }
+
+        static void s_onPeriodicLog(struct aws_task *task, void *arg, enum aws_task_status status)
+        {
+            (void)task;
+            auto *periodicLog = static_cast<PeriodicLogTask *>(arg);
+            bool current = false;
+            {
+                TraceRegistry &registry = s_registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                current = periodicLog->generation == registry.periodicLogGeneration;
+            }
+            if (status != AWS_TASK_STATUS_RUN_READY || !current)
+            {
+                Aws::Crt::Delete(periodicLog, aws_default_allocator());
+                return;
+            }
+
+            Tracing::LogHistograms();
+            s_schedulePeriodicLog(periodicLog);
+        }
+
+        bool Tracing::StartPeriodicLog(
+            std::chrono::milliseconds interval,
+            Aws::Crt::Io::EventLoopGroup *eventLoopGroup) noexcept
+        {
+            if (eventLoopGroup == nullptr)
+            {
+                eventLoopGroup = Aws::Crt::ApiHandle::GetOrCreateStaticDefaultEventLoopGroup();
+            }
+            struct aws_event_loop *eventLoop =
+                eventLoopGroup != nullptr ? aws_event_loop_group_get_next_loop(eventLoopGroup->GetUnderlyingHandle())
+                                          : nullptr;
+            if (eventLoop == nullptr || interval.count() <= 0)
+            {
+                return false;
+            }
+
+            auto *periodicLog = Aws::Crt::New<PeriodicLogTask>(aws_default_allocator());
+            if (periodicLog == nullptr)
+            {
+                return false;
+            }
+            periodicLog->eventLoop = eventLoop;
+            periodicLog->intervalNs =
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count());
+            {
+                /* A periodic log that is already running stops at its next run. */
+                TraceRegistry &registry = s_registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                periodicLog->generation = ++registry.periodicLogGeneration;
+            }
+            aws_task_init(&periodicLog->task, s_onPeriodicLog, periodicLog, "TracingPeriodicLog");
+            s_schedulePeriodicLog(periodicLog);
+            return true;
+        }
+
+        void Tracing::StopPeriodicLog() noexcept
+        {
+            TraceRegistry &registry = s_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            ++registry.periodicLogGeneration;
+        }
+
+        const char *Tracing::GetSubsystemName(TraceSubsystem subsystem) noexcept
+        {
+            switch (subsystem)
+            {
+                case TraceSubsystem::Shadow:
+                    return "shadow";
+                case TraceSubsystem::Jobs:
+                    return "jobs";
+                case TraceSubsystem::Identity:
+                    return "identity";
+                case TraceSubsystem::Discovery:
+                    return "discovery";
+                case TraceSubsystem::EventstreamRpc:
+                    return "eventstream-rpc";
+                case TraceSubsystem::SecureTunneling:
+                    return "secure-tunneling";
+                default:
+                    return "unknown";
+            }
+        }
+
+        const char *Tracing::GetPhaseName(TracePhase phase) noexcept
+        {
+            switch (phase)
+            {
+                case TracePhase::Serialize:
+                    return "serialize";
+                case TracePhase::PublishQueued:
+                    return "publish-queued";
+                case TracePhase::PubAck:
+                    return "puback";
+                case TracePhase::ResponseReceived:
+                    return "response-received";
+                case TracePhase::HandlerDone:
+                    return "handler-done";
+                default:
+                    return "unknown";
+            }
+        }
+    } // namespace Iotdevicecommon
+} // namespace Aws
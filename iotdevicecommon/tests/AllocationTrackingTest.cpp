@@ -0,0 +1,123 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotdevicecommon/IotDevice.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotdevicecommon;
+
+static int s_TestAllocationTrackingStats(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        /* Without tracking, every subsystem is created with the handle's allocator and nothing is counted. */
+        {
+            DeviceApiHandle deviceApiHandle(allocator);
+            ASSERT_FALSE(deviceApiHandle.IsTrackingAllocations());
+            ASSERT_PTR_EQUALS(allocator, deviceApiHandle.GetAllocator(AllocationSubsystem::Shadow));
+            ASSERT_UINT_EQUALS(0, deviceApiHandle.GetAllocationStats(AllocationSubsystem::Shadow).TotalAllocations);
+        }
+
+        DeviceApiHandle deviceApiHandle(allocator, AllocationTrackingOptions());
+        ASSERT_TRUE(deviceApiHandle.IsTrackingAllocations());
+        Allocator *shadowAllocator = deviceApiHandle.GetAllocator(AllocationSubsystem::Shadow);
+        ASSERT_TRUE(shadowAllocator != allocator);
+        ASSERT_TRUE(shadowAllocator != deviceApiHandle.GetAllocator(AllocationSubsystem::Jobs));
+
+        void *first = aws_mem_acquire(shadowAllocator, 100);
+        void *second = aws_mem_acquire(shadowAllocator, 28);
+        ASSERT_NOT_NULL(first);
+        ASSERT_NOT_NULL(second);
+        AllocationStats stats = deviceApiHandle.GetAllocationStats(AllocationSubsystem::Shadow);
+        ASSERT_UINT_EQUALS(128, stats.LiveBytes);
+        ASSERT_UINT_EQUALS(128, stats.PeakBytes);
+        ASSERT_UINT_EQUALS(2, stats.LiveAllocations);
+        ASSERT_UINT_EQUALS(2, stats.TotalAllocations);
+
+        /* The peak and the total are kept once the allocations are freed. */
+        aws_mem_release(shadowAllocator, first);
+        aws_mem_release(shadowAllocator, second);
+        stats = deviceApiHandle.GetAllocationStats(AllocationSubsystem::Shadow);
+        ASSERT_UINT_EQUALS(0, stats.LiveBytes);
+        ASSERT_UINT_EQUALS(128, stats.PeakBytes);
+        ASSERT_UINT_EQUALS(0, stats.LiveAllocations);
+        ASSERT_UINT_EQUALS(2, stats.TotalAllocations);
+
+        /* Each subsystem is counted on its own, and call sites are only recorded with a CallSiteDepth. */
+        ASSERT_UINT_EQUALS(0, deviceApiHandle.GetAllocationStats(AllocationSubsystem::Jobs).TotalAllocations);
+        ASSERT_TRUE(deviceApiHandle.GetTopCallSites(AllocationSubsystem::Shadow, 3).empty());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(AllocationTrackingStats, s_TestAllocationTrackingStats)
+
+static int s_TestAllocationTrackingCallSites(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        AllocationTrackingOptions trackingOptions;
+        trackingOptions.CallSiteDepth = 4;
+        trackingOptions.MaxCallSites = 2;
+        DeviceApiHandle deviceApiHandle(allocator, trackingOptions);
+        Allocator *jobsAllocator = deviceApiHandle.GetAllocator(AllocationSubsystem::Jobs);
+
+        /* Allocations made from the same place share a call site. */
+        void *small[3];
+        for (void *&block : small)
+        {
+            block = aws_mem_acquire(jobsAllocator, 16);
+        }
+        void *large = aws_mem_acquire(jobsAllocator, 1000);
+
+        Vector<AllocationCallSite> callSites = deviceApiHandle.GetTopCallSites(AllocationSubsystem::Jobs, 3);
+        ASSERT_UINT_EQUALS(2, callSites.size());
+        ASSERT_UINT_EQUALS(1000, callSites[0].LiveBytes);
+        ASSERT_UINT_EQUALS(1, callSites[0].LiveAllocations);
+        ASSERT_FALSE(callSites[0].Frames.empty());
+        ASSERT_UINT_EQUALS(48, callSites[1].LiveBytes);
+        ASSERT_UINT_EQUALS(3, callSites[1].LiveAllocations);
+        ASSERT_UINT_EQUALS(3, callSites[1].TotalAllocations);
+
+        /* The stats count exactly the bytes asked for, with or without call sites. */
+        AllocationStats stats = deviceApiHandle.GetAllocationStats(AllocationSubsystem::Jobs);
+        ASSERT_UINT_EQUALS(1048, stats.LiveBytes);
+        ASSERT_UINT_EQUALS(4, stats.LiveAllocations);
+
+        /* Call sites beyond MaxCallSites are counted against an unnamed one, which has no frames. */
+        void *unnamed = aws_mem_acquire(jobsAllocator, 2000);
+        callSites = deviceApiHandle.GetTopCallSites(AllocationSubsystem::Jobs, 1);
+        ASSERT_UINT_EQUALS(1, callSites.size());
+        ASSERT_UINT_EQUALS(2000, callSites[0].LiveBytes);
+        ASSERT_TRUE(callSites[0].Frames.empty());
+
+        /* Freeing an allocation takes it off its call site. */
+        aws_mem_release(jobsAllocator, unnamed);
+        aws_mem_release(jobsAllocator, large);
+        callSites = deviceApiHandle.GetTopCallSites(AllocationSubsystem::Jobs, 3);
+        ASSERT_UINT_EQUALS(3, callSites.size());
+        ASSERT_UINT_EQUALS(48, callSites[0].LiveBytes);
+        ASSERT_UINT_EQUALS(0, callSites[1].LiveBytes);
+        ASSERT_UINT_EQUALS(0, callSites[2].LiveBytes);
+
+        for (void *block : small)
+        {
+            aws_mem_release(jobsAllocator, block);
+        }
+        ASSERT_UINT_EQUALS(0, deviceApiHandle.GetAllocationStats(AllocationSubsystem::Jobs).LiveBytes);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(AllocationTrackingCallSites, s_TestAllocationTrackingCallSites)
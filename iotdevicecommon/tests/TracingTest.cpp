@@ -0,0 +1,240 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotdevicecommon/Tracing.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotdevicecommon;
+
+static uint64_t s_valueAt(TraceSubsystem subsystem, TracePhase phase, double percentile)
+{
+    return static_cast<uint64_t>(Tracing::GetHistogram(subsystem, phase).GetValueAtPercentile(percentile).count());
+}
+
+static int s_TestTracingBucketBoundaries(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        /* A value and the highest value of its bucket: below 8ns every value has a bucket of its own; above it,
+         * each power of two is split into eight; from 2^36ns on, everything shares the last bucket. */
+        const uint64_t lastBucketTop = (uint64_t(1) << 36) - 1;
+        const struct
+        {
+            uint64_t value;
+            uint64_t bucketTop;
+        } boundaries[] = {
+            {0, 0},
+            {1, 1},
+            {7, 7},
+            {8, 8},
+            {15, 15},
+            {16, 17},
+            {17, 17},
+            {18, 19},
+            {31, 31},
+            {32, 35},
+            {36, 39},
+            {255, 255},
+            {256, 287},
+            {1000, 1023},
+            {1024, 1151},
+            {(uint64_t(1) << 35) - 1, (uint64_t(1) << 35) - 1},
+            {uint64_t(1) << 35, (uint64_t(9) << 32) - 1},
+            {lastBucketTop, lastBucketTop},
+            {uint64_t(1) << 36, lastBucketTop},
+            {uint64_t(1) << 50, lastBucketTop},
+        };
+
+        for (const auto &boundary : boundaries)
+        {
+            /* With a larger latency recorded too, the median is the highest value of the first one's bucket. */
+            Tracing::Reset();
+            Tracing::Record(TraceSubsystem::Shadow, TracePhase::Serialize, boundary.value);
+            Tracing::Record(TraceSubsystem::Shadow, TracePhase::Serialize, UINT64_MAX);
+            ASSERT_UINT_EQUALS(boundary.bucketTop, s_valueAt(TraceSubsystem::Shadow, TracePhase::Serialize, 50));
+        }
+
+        /* A bucket's highest value is not reported above the largest latency recorded. */
+        Tracing::Reset();
+        Tracing::Record(TraceSubsystem::Shadow, TracePhase::Serialize, 1000);
+        ASSERT_UINT_EQUALS(1000, s_valueAt(TraceSubsystem::Shadow, TracePhase::Serialize, 50));
+        ASSERT_UINT_EQUALS(1000, s_valueAt(TraceSubsystem::Shadow, TracePhase::Serialize, 100));
+
+        /* Nothing recorded reads as zero. */
+        Tracing::Reset();
+        TraceHistogram empty = Tracing::GetHistogram(TraceSubsystem::Shadow, TracePhase::Serialize);
+        ASSERT_UINT_EQUALS(0, empty.GetCount());
+        ASSERT_UINT_EQUALS(0, empty.GetValueAtPercentile(50).count());
+        ASSERT_UINT_EQUALS(0, empty.GetMean().count());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(TracingBucketBoundaries, s_TestTracingBucketBoundaries)
+
+static int s_TestTracingPercentileAccuracy(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+        Tracing::Reset();
+
+        /* Latencies spread over eight orders of magnitude, from 100ns to about 10s. */
+        Vector<uint64_t> latencies;
+        uint64_t state = 12345;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < 20000; ++i)
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            uint64_t magnitude = (state >> 33) % 8;
+            uint64_t scale = 100;
+            for (uint64_t j = 0; j < magnitude; ++j)
+            {
+                scale *= 10;
+            }
+            uint64_t latency = scale + (state >> 11) % (scale * 9);
+            latencies.push_back(latency);
+            sum += latency;
+            Tracing::Record(TraceSubsystem::Jobs, TracePhase::ResponseReceived, latency);
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        TraceHistogram histogram = Tracing::GetHistogram(TraceSubsystem::Jobs, TracePhase::ResponseReceived);
+        ASSERT_UINT_EQUALS(latencies.size(), histogram.GetCount());
+        ASSERT_UINT_EQUALS(latencies.back(), histogram.GetMax().count());
+        ASSERT_UINT_EQUALS(sum / latencies.size(), histogram.GetMean().count());
+
+        /* A percentile is never below the latency at its rank, and above it by at most an eighth. */
+        const double percentiles[] = {0, 0.1, 1, 10, 25, 50, 75, 90, 99, 99.9, 100};
+        for (double percentile : percentiles)
+        {
+            size_t rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(latencies.size()) + 0.5);
+            rank = (std::max)(size_t(1), (std::min)(rank, latencies.size()));
+            uint64_t exact = latencies[rank - 1];
+            uint64_t reported = static_cast<uint64_t>(histogram.GetValueAtPercentile(percentile).count());
+            ASSERT_TRUE(reported >= exact);
+            ASSERT_TRUE(reported - exact <= exact / 8);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(TracingPercentileAccuracy, s_TestTracingPercentileAccuracy)
+
+static int s_TestTracingMultiThreadSums(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+        Tracing::Reset();
+
+        const size_t threadCount = 4;
+        const uint64_t recordsPerThread = 50000;
+        std::atomic<size_t> finished(0);
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+
+        /* Thread t records t+1 thousand nanoseconds, plus 0 to 6. */
+        Vector<std::thread> threads;
+        uint64_t expectedSum = 0;
+        for (size_t t = 0; t < threadCount; ++t)
+        {
+            for (uint64_t i = 0; i < recordsPerThread; ++i)
+            {
+                expectedSum += (t + 1) * 1000 + i % 7;
+            }
+            threads.emplace_back([t, recordsPerThread, &finished, released]() {
+                for (uint64_t i = 0; i < recordsPerThread; ++i)
+                {
+                    Tracing::Record(TraceSubsystem::EventstreamRpc, TracePhase::HandlerDone, (t + 1) * 1000 + i % 7);
+                }
+                finished++;
+                released.wait();
+            });
+        }
+
+        while (finished.load() < threadCount)
+        {
+            std::this_thread::yield();
+        }
+
+        /* The histograms of threads that are still running are summed... */
+        TraceHistogram running = Tracing::GetHistogram(TraceSubsystem::EventstreamRpc, TracePhase::HandlerDone);
+        ASSERT_UINT_EQUALS(threadCount * recordsPerThread, running.GetCount());
+        ASSERT_UINT_EQUALS(expectedSum / (threadCount * recordsPerThread), running.GetMean().count());
+        ASSERT_UINT_EQUALS(threadCount * 1000 + 6, running.GetMax().count());
+
+        /* ...and so are those of threads that have exited. */
+        release.set_value();
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        TraceHistogram exited = Tracing::GetHistogram(TraceSubsystem::EventstreamRpc, TracePhase::HandlerDone);
+        ASSERT_UINT_EQUALS(running.GetCount(), exited.GetCount());
+        ASSERT_UINT_EQUALS(running.GetMean().count(), exited.GetMean().count());
+        ASSERT_UINT_EQUALS(running.GetMax().count(), exited.GetMax().count());
+
+        /* The median is the second thread's latency, read back within an eighth. */
+        uint64_t median = static_cast<uint64_t>(exited.GetValueAtPercentile(50).count());
+        ASSERT_TRUE(median >= 2000 && median <= 2000 + 2000 / 8);
+
+        Tracing::Reset();
+        TraceHistogram reset = Tracing::GetHistogram(TraceSubsystem::EventstreamRpc, TracePhase::HandlerDone);
+        ASSERT_UINT_EQUALS(0, reset.GetCount());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(TracingMultiThreadSums, s_TestTracingMultiThreadSums)
+
+static int s_TestTracingDisabled(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+        Tracing::Reset();
+
+        /* A span started while tracing is disabled records nothing, even once tracing is enabled. */
+        Tracing::SetEnabled(false);
+        ASSERT_FALSE(Tracing::IsEnabled());
+        TraceSpan disabledSpan(TraceSubsystem::Discovery);
+        disabledSpan.Mark(TracePhase::Serialize);
+        ASSERT_UINT_EQUALS(0, Tracing::GetHistogram(TraceSubsystem::Discovery, TracePhase::Serialize).GetCount());
+
+        Tracing::SetEnabled(true);
+        disabledSpan.Mark(TracePhase::Serialize);
+        ASSERT_UINT_EQUALS(0, Tracing::GetHistogram(TraceSubsystem::Discovery, TracePhase::Serialize).GetCount());
+
+        TraceSpan enabledSpan(TraceSubsystem::Discovery);
+        enabledSpan.Mark(TracePhase::Serialize);
+        ASSERT_UINT_EQUALS(1, Tracing::GetHistogram(TraceSubsystem::Discovery, TracePhase::Serialize).GetCount());
+
+        /* A default span belongs to no request. */
+        TraceSpan none;
+        none.Mark(TracePhase::Serialize);
+        ASSERT_UINT_EQUALS(1, Tracing::GetHistogram(TraceSubsystem::Discovery, TracePhase::Serialize).GetCount());
+
+        Tracing::SetEnabled(false);
+        Tracing::Reset();
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(TracingDisabled, s_TestTracingDisabled)
@@ -0,0 +1,163 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/common/allocator.h>
+#include <aws/crt/Types.h>
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace Aws
+{
+    namespace Iotservicecommon
+    {
+        /**
+         * An aws_allocator that counts the bytes and allocations it has not yet freed before passing them on to
+         * another allocator. Each allocation is preceded by its size, so counting takes a few relaxed atomic updates
+         * and no lock.
+         *
+         * This is the one counting allocator of the SDK: the service clients count what they allocate with it, and
+         * so do the device API handle and the benchmarks.
+         */
+        class CountingAllocator final
+        {
+          public:
+            /**
+             * @param allocator The allocator that allocations are passed on to.
+             * @return The counting allocator, which is destroyed once the last copy of the pointer is, or nullptr if
+             * it could not be allocated.
+             */
+            static std::shared_ptr<Aws::Crt::Allocator> Create(Aws::Crt::Allocator *allocator) noexcept;
+
+            /**
+             * @param allocator An allocator returned by Create.
+             * @return The number of bytes allocated through it and not yet freed.
+             */
+            static size_t GetAllocatedBytes(const Aws::Crt::Allocator *allocator) noexcept;
+
+            /**
+             * @param allocator An allocator returned by Create.
+             * @return The number of allocations made through it and not yet freed.
+             */
+            static size_t GetAllocationCount(const Aws::Crt::Allocator *allocator) noexcept;
+
+            /**
+             * @param allocator An allocator returned by Create.
+             * @return The most bytes that were allocated through it and not yet freed at any one time.
+             */
+            static size_t GetPeakBytes(const Aws::Crt::Allocator *allocator) noexcept;
+
+            /**
+             * @param allocator An allocator returned by Create.
+             * @return The number of allocations made through it, freed or not.
+             */
+            static uint64_t GetTotalAllocationCount(const Aws::Crt::Allocator *allocator) noexcept;
+
+            ~CountingAllocator() = default;
+            CountingAllocator(const CountingAllocator &) = delete;
+            CountingAllocator &operator=(const CountingAllocator &) = delete;
+
+          private:
+            /* The header is 16 bytes on every platform, so that it keeps the alignment of the allocator underneath. */
+            static const size_t s_headerSize = 16;
+
+            explicit CountingAllocator(Aws::Crt::Allocator *allocator) noexcept;
+
+            static void *s_acquire(struct aws_allocator *allocator, size_t size);
+            static void s_release(struct aws_allocator *allocator, void *ptr);
+
+            struct aws_allocator m_countingAllocator;
+            Aws::Crt::Allocator *m_allocator;
+            std::atomic<size_t> m_allocatedBytes;
+            std::atomic<size_t> m_allocationCount;
+            std::atomic<size_t> m_peakBytes;
+            std::atomic<uint64_t> m_totalAllocationCount;
+        };
+
+        inline CountingAllocator::CountingAllocator(Aws::Crt::Allocator *allocator) noexcept
+            : m_allocator(allocator), m_allocatedBytes(0), m_allocationCount(0), m_peakBytes(0),
+              m_totalAllocationCount(0)
+        {
+            AWS_ZERO_STRUCT(m_countingAllocator);
+            m_countingAllocator.mem_acquire = s_acquire;
+            m_countingAllocator.mem_release = s_release;
+            m_countingAllocator.impl = this;
+        }
+
+        inline std::shared_ptr<Aws::Crt::Allocator> CountingAllocator::Create(Aws::Crt::Allocator *allocator) noexcept
+        {
+            void *mem = aws_mem_acquire(allocator, sizeof(CountingAllocator));
+            if (mem == nullptr)
+            {
+                return nullptr;
+            }
+            auto *counter = new (mem) CountingAllocator(allocator);
+            return std::shared_ptr<Aws::Crt::Allocator>(
+                &counter->m_countingAllocator,
+                [counter, allocator](Aws::Crt::Allocator *) { Aws::Crt::Delete(counter, allocator); });
+        }
+
+        inline size_t CountingAllocator::GetAllocatedBytes(const Aws::Crt::Allocator *allocator) noexcept
+        {
+            const auto *counter = static_cast<const CountingAllocator *>(allocator->impl);
+            return counter->m_allocatedBytes.load(std::memory_order_relaxed);
+        }
+
+        inline size_t CountingAllocator::GetAllocationCount(const Aws::Crt::Allocator *allocator) noexcept
+        {
+            const auto *counter = static_cast<const CountingAllocator *>(allocator->impl);
+            return counter->m_allocationCount.load(std::memory_order_relaxed);
+        }
+
+        inline size_t CountingAllocator::GetPeakBytes(const Aws::Crt::Allocator *allocator) noexcept
+        {
+            const auto *counter = static_cast<const CountingAllocator *>(allocator->impl);
+            return counter->m_peakBytes.load(std::memory_order_relaxed);
+        }
+
+        inline uint64_t CountingAllocator::GetTotalAllocationCount(const Aws::Crt::Allocator *allocator) noexcept
+        {
+            const auto *counter = static_cast<const CountingAllocator *>(allocator->impl);
+            return counter->m_totalAllocationCount.load(std::memory_order_relaxed);
+        }
+
+        inline void *CountingAllocator::s_acquire(struct aws_allocator *allocator, size_t size)
+        {
+            auto *counter = static_cast<CountingAllocator *>(allocator->impl);
+            if (size > SIZE_MAX - s_headerSize)
+            {
+                return nullptr;
+            }
+            auto *block = static_cast<uint8_t *>(aws_mem_acquire(counter->m_allocator, s_headerSize + size));
+            if (block == nullptr)
+            {
+                return nullptr;
+            }
+
+            *reinterpret_cast<size_t *>(block) = size;
+            size_t allocatedBytes = counter->m_allocatedBytes.fetch_add(size, std::memory_order_relaxed) + size;
+            size_t peakBytes = counter->m_peakBytes.load(std::memory_order_relaxed);
+            while (allocatedBytes > peakBytes &&
+                   !counter->m_peakBytes.compare_exchange_weak(peakBytes, allocatedBytes, std::memory_order_relaxed))
+            {
+            }
+            counter->m_allocationCount.fetch_add(1, std::memory_order_relaxed);
+            counter->m_totalAllocationCount.fetch_add(1, std::memory_order_relaxed);
+            return block + s_headerSize;
+        }
+
+        inline void CountingAllocator::s_release(struct aws_allocator *allocator, void *ptr)
+        {
+            auto *counter = static_cast<CountingAllocator *>(allocator->impl);
+            uint8_t *block = static_cast<uint8_t *>(ptr) - s_headerSize;
+
+            counter->m_allocatedBytes.fetch_sub(*reinterpret_cast<const size_t *>(block), std::memory_order_relaxed);
+            counter->m_allocationCount.fetch_sub(1, std::memory_order_relaxed);
+            aws_mem_release(counter->m_allocator, block);
+        }
+    } // namespace Iotservicecommon
+} // namespace Aws
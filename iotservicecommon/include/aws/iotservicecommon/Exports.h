@@ -0,0 +1,20 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#if defined(AWS_IOTSERVICECOMMON_USE_WINDOWS_DLL_SEMANTICS) || defined(WIN32)
+#    ifdef AWS_IOTSERVICECOMMON_USE_IMPORT_EXPORT
+#        ifdef AWS_IOTSERVICECOMMON_EXPORTS
+#            define AWS_IOTSERVICECOMMON_API __declspec(dllexport)
+#        else
+#            define AWS_IOTSERVICECOMMON_API __declspec(dllimport)
+#        endif /* AWS_IOTSERVICECOMMON_EXPORTS */
+#    else
+#        define AWS_IOTSERVICECOMMON_API
+#    endif /* AWS_IOTSERVICECOMMON_USE_IMPORT_EXPORT */
+
+#else /* defined (AWS_IOTSERVICECOMMON_USE_WINDOWS_DLL_SEMANTICS) || defined (WIN32) */
+#    define AWS_IOTSERVICECOMMON_API
+#endif /* defined (AWS_IOTSERVICECOMMON__USE_WINDOWS_DLL_SEMANTICS) || defined (WIN32) */
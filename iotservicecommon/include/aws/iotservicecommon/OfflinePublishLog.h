@@ -0,0 +1,117 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotservicecommon/Exports.h>
+
+#include <cstdint>
+#include <functional>
+
+namespace Aws
+{
+    namespace Iotservicecommon
+    {
+        /**
+         * A file of records that outlives the process, for publishes that are waiting for a connection.
+         *
+         * The file is memory-mapped and has a fixed size. Records are appended with a sequence number and a
+         * checksum, and are marked done in place once they are no longer needed. When the file is full, the records
+         * that are not done are copied to a new file, which then replaces it. On open, records are read up to the
+         * first one whose checksum does not match, which is where a write was cut short.
+         *
+         * An OfflinePublishLog is not thread safe.
+         */
+        class AWS_IOTSERVICECOMMON_API OfflinePublishLog final
+        {
+          public:
+            using OnRecord = std::function<void(uint64_t sequence, const Aws::Crt::ByteCursor &record)>;
+
+            OfflinePublishLog() noexcept;
+            ~OfflinePublishLog();
+            OfflinePublishLog(const OfflinePublishLog &) = delete;
+            OfflinePublishLog &operator=(const OfflinePublishLog &) = delete;
+
+            /**
+             * Open the log at `path`, creating it if it does not exist.
+             *
+             * @param maxBytes The size of the file. A file that is already bigger keeps its size.
+             * @param syncEachWrite Flush every append and every record marked done to disk before returning. If
+             * this is false, records survive the process exiting but not the device losing power.
+             * @return false if the file could not be opened or mapped, or is not a log.
+             */
+            bool Open(const Aws::Crt::String &path, size_t maxBytes, bool syncEachWrite) noexcept;
+            void Close() noexcept;
+            bool IsOpen() const noexcept { return m_data != nullptr; }
+
+            /**
+             * @return The sequence number of the new record, or 0 if the file has no room for it even after the
+             * records that are done are dropped.
+             */
+            uint64_t Append(const Aws::Crt::ByteCursor &record) noexcept;
+
+            void MarkDone(uint64_t sequence) noexcept;
+
+            /**
+             * Invoke `onRecord` with every record that is not done, oldest first.
+             */
+            void ForEach(const OnRecord &onRecord) const noexcept;
+
+            size_t GetRecordCount() const noexcept { return m_records.size(); }
+
+          private:
+            struct LogHeader
+            {
+                uint64_t magic;
+                uint32_t formatVersion;
+                uint32_t reserved;
+            };
+
+            /* The checksum covers the length, the sequence number and the record, but not the state, which is
+             * changed in place. */
+            struct RecordHeader
+            {
+                uint32_t checksum;
+                uint32_t length;
+                uint64_t sequence;
+                uint32_t state;
+                uint32_t reserved;
+            };
+
+            static const uint64_t s_logMagic = 0x314c50544f494f41ULL; /* "AOIOTPL1" */
+            static const uint32_t s_logFormatVersion = 1;
+            static const uint32_t s_recordLive = 1;
+            static const uint32_t s_recordDone = 2;
+            static const intptr_t s_noFile = -1;
+
+            static size_t s_recordSize(size_t length) noexcept;
+            static uint32_t s_checksum(const RecordHeader &header, const uint8_t *record) noexcept;
+
+            bool Map(const Aws::Crt::String &path, size_t size) noexcept;
+            void Unmap() noexcept;
+            void Sync(size_t offset, size_t length) noexcept;
+            bool Recover() noexcept;
+            bool Compact() noexcept;
+            /* Replace `to` with `from`, and wait for the rename to reach the disk. */
+            static bool s_replaceFile(const Aws::Crt::String &from, const Aws::Crt::String &to) noexcept;
+
+            Aws::Crt::String m_path;
+            size_t m_maxBytes;
+            bool m_syncEachWrite;
+
+            uint8_t *m_data;
+            size_t m_size;
+            /* A file descriptor, or a HANDLE to the file and one to its mapping on Windows. */
+            intptr_t m_file;
+            intptr_t m_mapping;
+
+            size_t m_tail;
+            size_t m_doneBytes;
+            uint64_t m_nextSequence;
+            /* The offset of every record that is not done, by sequence number. */
+            Aws::Crt::Map<uint64_t, size_t> m_records;
+        };
+    } // namespace Iotservicecommon
+} // namespace Aws
@@ -0,0 +1,714 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/DateTime.h>
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Optional.h>
+#include <aws/crt/Types.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace Aws
+{
+    namespace Iotservicecommon
+    {
+        /**
+         * One JSON value within a payload. Nothing is parsed or copied until the value is read, and a read fails if
+         * the value is not of the type asked for.
+         */
+        class JsonPayloadValue final
+        {
+          public:
+            JsonPayloadValue() noexcept : m_raw(aws_byte_cursor_from_array(nullptr, 0)) {}
+            explicit JsonPayloadValue(Aws::Crt::ByteCursor raw) noexcept : m_raw(raw) {}
+
+            bool IsNull() const noexcept { return aws_byte_cursor_eq_c_str(&m_raw, "null"); }
+            bool GetString(Aws::Crt::String &value) const noexcept;
+
+            /**
+             * Read an integer. A number with a fraction or an exponent is not read, since JsonObject converts it
+             * from a double, and neither is one that does not fit in 64 bits.
+             */
+            bool GetInt64(int64_t &value) const noexcept;
+
+            /**
+             * Read a number. Only the JSON number grammar is accepted, not the other forms that strtod reads, such
+             * as a leading plus, hexadecimal, infinity or NaN.
+             */
+            bool GetDouble(double &value) const noexcept;
+            bool GetBool(bool &value) const noexcept;
+
+            /**
+             * Parse this value, and only this value, into a document.
+             */
+            bool GetJsonObject(Aws::Crt::JsonObject &value) const noexcept;
+
+            /**
+             * Read the value into an optional model field, leaving the field unset if the value is not of its type.
+             * Timestamps are read as seconds since the epoch.
+             */
+            bool ReadField(Aws::Crt::Optional<Aws::Crt::String> &field) const noexcept;
+            bool ReadField(Aws::Crt::Optional<int32_t> &field) const noexcept;
+            bool ReadField(Aws::Crt::Optional<int64_t> &field) const noexcept;
+            bool ReadField(Aws::Crt::Optional<Aws::Crt::DateTime> &field) const noexcept;
+            bool ReadField(Aws::Crt::Optional<Aws::Crt::JsonObject> &field) const noexcept;
+
+            /**
+             * @return The text of the value.
+             */
+            Aws::Crt::ByteCursor GetRaw() const noexcept { return m_raw; }
+
+          private:
+            /* True if the value is a JSON number. `isInteger` is set if it has neither a fraction nor an exponent. */
+            bool IsNumber(bool &isInteger) const noexcept;
+
+            /* Copy the value into `number` so that it is null-terminated. */
+            bool CopyNumber(char *number, size_t capacity) const noexcept;
+
+            Aws::Crt::ByteCursor m_raw;
+        };
+
+        /**
+         * Reads the members of a JSON object in a single pass over the payload, without building a document.
+         * Each value is skipped over rather than parsed, so only the values that are read cost more than a scan.
+         */
+        class JsonPayloadReader final
+        {
+          public:
+            explicit JsonPayloadReader(const JsonPayloadValue &object) noexcept
+                : m_remaining(object.GetRaw()), m_started(false), m_finished(false), m_error(false)
+            {
+            }
+
+            /**
+             * Read the next member of the object.
+             * @return False at the end of the object, or if the payload is malformed, in which case HasError is set.
+             */
+            bool Next(Aws::Crt::ByteCursor &key, JsonPayloadValue &value) noexcept;
+
+            bool HasError() const noexcept { return m_error; }
+
+            static bool KeyIs(const Aws::Crt::ByteCursor &key, const char *name) noexcept
+            {
+                return aws_byte_cursor_eq_c_str(&key, name);
+            }
+
+          private:
+            static void s_skipWhitespace(Aws::Crt::ByteCursor &cursor) noexcept;
+            /* The length of the string at the start of `cursor`, including its quotes, or 0 if it is not terminated. */
+            static size_t s_scanString(const Aws::Crt::ByteCursor &cursor) noexcept;
+            /* The length of the value at the start of `cursor`, or 0 if it is not terminated. */
+            static size_t s_scanValue(const Aws::Crt::ByteCursor &cursor) noexcept;
+
+            Aws::Crt::ByteCursor m_remaining;
+            bool m_started;
+            bool m_finished;
+            bool m_error;
+        };
+
+        /**
+         * Names the fields of a model that is decoded on demand. Specialize it for each model, with a static Describe
+         * that names every field the model's LoadFromObject reads:
+         *
+         *     template <> struct PayloadModel<ErrorResponse>
+         *     {
+         *         template <typename Visitor> static void Describe(Visitor &visitor)
+         *         {
+         *             visitor.Field("clientToken", &ErrorResponse::ClientToken);
+         *             visitor.Field("code", &ErrorResponse::Code);
+         *         }
+         *     };
+         *
+         * A field is an optional of a type ReadField reads, or of a model with a PayloadModel of its own, which is
+         * decoded from a nested object. A field of any other type names the function that reads it as well:
+         *
+         *     visitor.Field("status", &JobExecutionState::Status, s_readJobStatus);
+         *
+         * A model may have at most 64 fields.
+         */
+        template <typename Model> struct PayloadModel;
+
+        /**
+         * Decode an object into a model with a PayloadModel. A null value leaves its field unset, as ValueExists
+         * does, a key that appears more than once is read from its first member, as cJSON reads it, and members the
+         * model does not name are skipped without being parsed.
+         *
+         * @return false if `object` is malformed or has escaped keys, or if a field's value is not of its type.
+         */
+        template <typename Model> bool DecodePayloadModel(const JsonPayloadValue &object, Model &model) noexcept;
+
+        namespace PayloadModelDetail
+        {
+            /*
+             * Reads one member of an object into the field named by its key, if there is one. `readFields` has a bit
+             * for each field already met, by its position in Describe.
+             */
+            template <typename Model> class FieldDecoder final
+            {
+              public:
+                FieldDecoder(
+                    const Aws::Crt::ByteCursor &key,
+                    const JsonPayloadValue &value,
+                    Model &model,
+                    uint64_t &readFields) noexcept
+                    : m_key(key), m_value(value), m_model(model), m_readFields(readFields), m_index(0),
+                      m_found(false), m_decoded(true)
+                {
+                }
+
+                template <typename T> void Field(const char *name, Aws::Crt::Optional<T> Model::*member) noexcept
+                {
+                    if (Find(name))
+                    {
+                        m_decoded = Read(m_model.*member);
+                    }
+                }
+
+                template <typename T>
+                void Field(const char *name, T Model::*member, bool (*read)(const JsonPayloadValue &, T &)) noexcept
+                {
+                    if (Find(name))
+                    {
+                        m_decoded = read(m_value, m_model.*member);
+                    }
+                }
+
+                bool IsDecoded() const noexcept { return m_decoded; }
+
+              private:
+                /*
+                 * True if the member is the field `name` and is to be read. As with cJSON, only the first member
+                 * with a key is read, and a null one leaves the field unset.
+                 */
+                bool Find(const char *name) noexcept
+                {
+                    AWS_FATAL_ASSERT(m_index < 64 && "A PayloadModel may have at most 64 fields");
+                    uint64_t bit = uint64_t(1) << m_index++;
+                    if (m_found || !JsonPayloadReader::KeyIs(m_key, name))
+                    {
+                        return false;
+                    }
+                    m_found = true;
+                    bool first = (m_readFields & bit) == 0;
+                    m_readFields |= bit;
+                    return first && !m_value.IsNull();
+                }
+
+                bool Read(Aws::Crt::Optional<Aws::Crt::String> &field) noexcept { return m_value.ReadField(field); }
+                bool Read(Aws::Crt::Optional<int32_t> &field) noexcept { return m_value.ReadField(field); }
+                bool Read(Aws::Crt::Optional<int64_t> &field) noexcept { return m_value.ReadField(field); }
+                bool Read(Aws::Crt::Optional<Aws::Crt::DateTime> &field) noexcept { return m_value.ReadField(field); }
+                bool Read(Aws::Crt::Optional<Aws::Crt::JsonObject> &field) noexcept { return m_value.ReadField(field); }
+
+                template <typename Nested> bool Read(Aws::Crt::Optional<Nested> &field) noexcept
+                {
+                    Nested nested;
+                    bool decoded = DecodePayloadModel(m_value, nested);
+                    field = std::move(nested);
+                    return decoded;
+                }
+
+                const Aws::Crt::ByteCursor &m_key;
+                const JsonPayloadValue &m_value;
+                Model &m_model;
+                uint64_t &m_readFields;
+                size_t m_index;
+                bool m_found;
+                bool m_decoded;
+            };
+        } // namespace PayloadModelDetail
+
+        inline bool JsonPayloadValue::GetString(Aws::Crt::String &value) const noexcept
+        {
+            if (m_raw.len < 2 || m_raw.ptr[0] != '"')
+            {
+                return false;
+            }
+
+            const char *characters = reinterpret_cast<const char *>(m_raw.ptr) + 1;
+            size_t length = m_raw.len - 2;
+            if (memchr(characters, '\\', length) == nullptr)
+            {
+                value.assign(characters, length);
+                return true;
+            }
+
+            value.clear();
+            value.reserve(length);
+            for (size_t i = 0; i < length; ++i)
+            {
+                if (characters[i] != '\\')
+                {
+                    value.push_back(characters[i]);
+                    continue;
+                }
+                if (++i == length)
+                {
+                    return false;
+                }
+                switch (characters[i])
+                {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        value.push_back(characters[i]);
+                        break;
+                    case 'b':
+                        value.push_back('\b');
+                        break;
+                    case 'f':
+                        value.push_back('\f');
+                        break;
+                    case 'n':
+                        value.push_back('\n');
+                        break;
+                    case 'r':
+                        value.push_back('\r');
+                        break;
+                    case 't':
+                        value.push_back('\t');
+                        break;
+                    case 'u':
+                    {
+                        if (length - i <= 4)
+                        {
+                            return false;
+                        }
+                        /* Read the digits here rather than with strtoul, which also takes whitespace, a sign or a 0x
+                         * prefix. */
+                        unsigned long codePoint = 0;
+                        for (size_t digit = 1; digit <= 4; ++digit)
+                        {
+                            char hex = characters[i + digit];
+                            unsigned long nibble = 0;
+                            if (hex >= '0' && hex <= '9')
+                            {
+                                nibble = static_cast<unsigned long>(hex - '0');
+                            }
+                            else if (hex >= 'a' && hex <= 'f')
+                            {
+                                nibble = static_cast<unsigned long>(hex - 'a' + 10);
+                            }
+                            else if (hex >= 'A' && hex <= 'F')
+                            {
+                                nibble = static_cast<unsigned long>(hex - 'A' + 10);
+                            }
+                            else
+                            {
+                                return false;
+                            }
+                            codePoint = (codePoint << 4) | nibble;
+                        }
+                        /* Surrogate pairs are left to JsonObject. */
+                        if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+                        {
+                            return false;
+                        }
+                        if (codePoint < 0x80)
+                        {
+                            value.push_back(static_cast<char>(codePoint));
+                        }
+                        else if (codePoint < 0x800)
+                        {
+                            value.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                            value.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                        }
+                        else
+                        {
+                            value.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                            value.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                            value.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+                        }
+                        i += 4;
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        inline bool JsonPayloadValue::IsNumber(bool &isInteger) const noexcept
+        {
+            /* -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+            const uint8_t *character = m_raw.ptr;
+            const uint8_t *end = m_raw.ptr + m_raw.len;
+            auto isDigit = [](uint8_t c) { return c >= '0' && c <= '9'; };
+
+            if (character != end && *character == '-')
+            {
+                ++character;
+            }
+            if (character == end || !isDigit(*character))
+            {
+                return false;
+            }
+            if (*character == '0')
+            {
+                ++character;
+            }
+            else
+            {
+                while (character != end && isDigit(*character))
+                {
+                    ++character;
+                }
+            }
+
+            isInteger = true;
+            if (character != end && *character == '.')
+            {
+                isInteger = false;
+                ++character;
+                if (character == end || !isDigit(*character))
+                {
+                    return false;
+                }
+                while (character != end && isDigit(*character))
+                {
+                    ++character;
+                }
+            }
+            if (character != end && (*character == 'e' || *character == 'E'))
+            {
+                isInteger = false;
+                ++character;
+                if (character != end && (*character == '+' || *character == '-'))
+                {
+                    ++character;
+                }
+                if (character == end || !isDigit(*character))
+                {
+                    return false;
+                }
+                while (character != end && isDigit(*character))
+                {
+                    ++character;
+                }
+            }
+            return character == end;
+        }
+
+        inline bool JsonPayloadValue::CopyNumber(char *number, size_t capacity) const noexcept
+        {
+            /* The payload is not null-terminated, so the number is copied before it is converted. */
+            if (m_raw.len >= capacity)
+            {
+                return false;
+            }
+            memcpy(number, m_raw.ptr, m_raw.len);
+            number[m_raw.len] = 0;
+            return true;
+        }
+
+        inline bool JsonPayloadValue::GetInt64(int64_t &value) const noexcept
+        {
+            bool isInteger = false;
+            char number[32];
+            if (!IsNumber(isInteger) || !isInteger || !CopyNumber(number, sizeof(number)))
+            {
+                return false;
+            }
+            errno = 0;
+            long long parsed = strtoll(number, nullptr, 10);
+            if (errno == ERANGE)
+            {
+                return false;
+            }
+            value = static_cast<int64_t>(parsed);
+            return true;
+        }
+
+        inline bool JsonPayloadValue::GetDouble(double &value) const noexcept
+        {
+            bool isInteger = false;
+            char number[64];
+            if (!IsNumber(isInteger) || !CopyNumber(number, sizeof(number)))
+            {
+                return false;
+            }
+            value = strtod(number, nullptr);
+            return true;
+        }
+
+        inline bool JsonPayloadValue::GetBool(bool &value) const noexcept
+        {
+            if (aws_byte_cursor_eq_c_str(&m_raw, "true") || aws_byte_cursor_eq_c_str(&m_raw, "false"))
+            {
+                value = m_raw.len == 4;
+                return true;
+            }
+            return false;
+        }
+
+        inline bool JsonPayloadValue::GetJsonObject(Aws::Crt::JsonObject &value) const noexcept
+        {
+            value = Aws::Crt::JsonObject(Aws::Crt::String(reinterpret_cast<const char *>(m_raw.ptr), m_raw.len));
+            return value.WasParseSuccessful();
+        }
+
+        inline bool JsonPayloadValue::ReadField(Aws::Crt::Optional<Aws::Crt::String> &field) const noexcept
+        {
+            Aws::Crt::String decoded;
+            if (!GetString(decoded))
+            {
+                return false;
+            }
+            field = std::move(decoded);
+            return true;
+        }
+
+        inline bool JsonPayloadValue::ReadField(Aws::Crt::Optional<int32_t> &field) const noexcept
+        {
+            int64_t decoded = 0;
+            if (!GetInt64(decoded))
+            {
+                return false;
+            }
+            field = static_cast<int32_t>(decoded);
+            return true;
+        }
+
+        inline bool JsonPayloadValue::ReadField(Aws::Crt::Optional<int64_t> &field) const noexcept
+        {
+            int64_t decoded = 0;
+            if (!GetInt64(decoded))
+            {
+                return false;
+            }
+            field = decoded;
+            return true;
+        }
+
+        inline bool JsonPayloadValue::ReadField(Aws::Crt::Optional<Aws::Crt::DateTime> &field) const noexcept
+        {
+            double decoded = 0;
+            if (!GetDouble(decoded))
+            {
+                return false;
+            }
+            field = decoded;
+            return true;
+        }
+
+        inline bool JsonPayloadValue::ReadField(Aws::Crt::Optional<Aws::Crt::JsonObject> &field) const noexcept
+        {
+            Aws::Crt::JsonObject decoded;
+            if (!GetJsonObject(decoded))
+            {
+                return false;
+            }
+            field = std::move(decoded);
+            return true;
+        }
+
+        inline void JsonPayloadReader::s_skipWhitespace(Aws::Crt::ByteCursor &cursor) noexcept
+        {
+            while (cursor.len > 0 &&
+                   (*cursor.ptr == ' ' || *cursor.ptr == '\t' || *cursor.ptr == '\n' || *cursor.ptr == '\r'))
+            {
+                aws_byte_cursor_advance(&cursor, 1);
+            }
+        }
+
+        inline size_t JsonPayloadReader::s_scanString(const Aws::Crt::ByteCursor &cursor) noexcept
+        {
+            size_t position = 1;
+            while (position < cursor.len)
+            {
+                const void *quote = memchr(cursor.ptr + position, '"', cursor.len - position);
+                if (quote == nullptr)
+                {
+                    return 0;
+                }
+                size_t quotePosition = static_cast<size_t>(static_cast<const uint8_t *>(quote) - cursor.ptr);
+
+                /* The quote ends the string unless it follows an odd number of backslashes. */
+                size_t backslashCount = 0;
+                while (quotePosition - backslashCount > 1 && cursor.ptr[quotePosition - backslashCount - 1] == '\\')
+                {
+                    ++backslashCount;
+                }
+                if (backslashCount % 2 == 0)
+                {
+                    return quotePosition + 1;
+                }
+                position = quotePosition + 1;
+            }
+            return 0;
+        }
+
+        inline size_t JsonPayloadReader::s_scanValue(const Aws::Crt::ByteCursor &cursor) noexcept
+        {
+            if (cursor.len == 0)
+            {
+                return 0;
+            }
+
+            uint8_t first = cursor.ptr[0];
+            if (first == '"')
+            {
+                return s_scanString(cursor);
+            }
+
+            if (first == '{' || first == '[')
+            {
+                /* The brackets still open, one bit each, set for an object. Nothing deeper than this would parse
+                 * with cJSON either. */
+                const size_t maxDepth = 1024;
+                uint64_t open[maxDepth / 64];
+                size_t depth = 0;
+                size_t position = 0;
+                while (position < cursor.len)
+                {
+                    uint8_t character = cursor.ptr[position];
+                    if (character == '"')
+                    {
+                        size_t stringLength =
+                            s_scanString(aws_byte_cursor_from_array(cursor.ptr + position, cursor.len - position));
+                        if (stringLength == 0)
+                        {
+                            return 0;
+                        }
+                        position += stringLength;
+                        continue;
+                    }
+                    if (character == '{' || character == '[')
+                    {
+                        if (depth == maxDepth)
+                        {
+                            return 0;
+                        }
+                        uint64_t bit = uint64_t(1) << (depth % 64);
+                        open[depth / 64] = character == '{' ? open[depth / 64] | bit : open[depth / 64] & ~bit;
+                        ++depth;
+                    }
+                    else if (character == '}' || character == ']')
+                    {
+                        --depth;
+                        bool closesObject = ((open[depth / 64] >> (depth % 64)) & 1) != 0;
+                        if (closesObject != (character == '}'))
+                        {
+                            return 0;
+                        }
+                        if (depth == 0)
+                        {
+                            return position + 1;
+                        }
+                    }
+                    ++position;
+                }
+                return 0;
+            }
+
+            /* Numbers, true, false and null run until the next delimiter. */
+            size_t position = 0;
+            while (position < cursor.len)
+            {
+                uint8_t character = cursor.ptr[position];
+                if (character == ',' || character == '}' || character == ']' || character == ' ' ||
+                    character == '\t' || character == '\n' || character == '\r')
+                {
+                    break;
+                }
+                ++position;
+            }
+            return position;
+        }
+
+        inline bool JsonPayloadReader::Next(Aws::Crt::ByteCursor &key, JsonPayloadValue &value) noexcept
+        {
+            if (m_finished || m_error)
+            {
+                return false;
+            }
+
+            s_skipWhitespace(m_remaining);
+            bool expectMember = !m_started;
+            if (!m_started)
+            {
+                if (m_remaining.len == 0 || *m_remaining.ptr != '{')
+                {
+                    m_error = true;
+                    return false;
+                }
+                aws_byte_cursor_advance(&m_remaining, 1);
+                s_skipWhitespace(m_remaining);
+                m_started = true;
+            }
+
+            if (m_remaining.len > 0 && *m_remaining.ptr == '}')
+            {
+                /* Only whitespace may follow the object. */
+                aws_byte_cursor_advance(&m_remaining, 1);
+                s_skipWhitespace(m_remaining);
+                m_finished = true;
+                m_error = m_remaining.len != 0;
+                return false;
+            }
+
+            if (!expectMember)
+            {
+                if (m_remaining.len == 0 || *m_remaining.ptr != ',')
+                {
+                    m_error = true;
+                    return false;
+                }
+                aws_byte_cursor_advance(&m_remaining, 1);
+                s_skipWhitespace(m_remaining);
+            }
+
+            size_t keyLength = (m_remaining.len > 0 && *m_remaining.ptr == '"') ? s_scanString(m_remaining) : 0;
+            /* Keys with escapes are left to JsonObject. */
+            if (keyLength == 0 || memchr(m_remaining.ptr + 1, '\\', keyLength - 2) != nullptr)
+            {
+                m_error = true;
+                return false;
+            }
+            key = aws_byte_cursor_from_array(m_remaining.ptr + 1, keyLength - 2);
+            aws_byte_cursor_advance(&m_remaining, keyLength);
+
+            s_skipWhitespace(m_remaining);
+            if (m_remaining.len == 0 || *m_remaining.ptr != ':')
+            {
+                m_error = true;
+                return false;
+            }
+            aws_byte_cursor_advance(&m_remaining, 1);
+            s_skipWhitespace(m_remaining);
+
+            size_t valueLength = s_scanValue(m_remaining);
+            if (valueLength == 0)
+            {
+                m_error = true;
+                return false;
+            }
+            value = JsonPayloadValue(aws_byte_cursor_advance(&m_remaining, valueLength));
+            return true;
+        }
+
+        template <typename Model> bool DecodePayloadModel(const JsonPayloadValue &object, Model &model) noexcept
+        {
+            JsonPayloadReader reader(object);
+            Aws::Crt::ByteCursor key;
+            JsonPayloadValue value;
+            uint64_t readFields = 0;
+            while (reader.Next(key, value))
+            {
+                PayloadModelDetail::FieldDecoder<Model> fieldDecoder(key, value, model, readFields);
+                PayloadModel<Model>::Describe(fieldDecoder);
+                if (!fieldDecoder.IsDecoded())
+                {
+                    return false;
+                }
+            }
+            return !reader.HasError();
+        }
+    } // namespace Iotservicecommon
+} // namespace Aws
@@ -0,0 +1,326 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Types.h>
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotservicecommon
+    {
+        /**
+         * Writes a JSON object directly into a ByteBuf, growing the buffer with its own allocator. Strings are
+         * escaped the way Crt::JsonObject escapes them.
+         */
+        class JsonPayloadWriter final
+        {
+          public:
+            /**
+             * Start an object at the end of `buffer`.
+             */
+            explicit JsonPayloadWriter(Aws::Crt::ByteBuf &buffer) noexcept;
+
+            JsonPayloadWriter &WithString(const char *key, const Aws::Crt::String &value) noexcept;
+            JsonPayloadWriter &WithInt64(const char *key, int64_t value) noexcept;
+            JsonPayloadWriter &WithBool(const char *key, bool value) noexcept;
+
+            /**
+             * Write a number with the fewest digits that read back as `value`. NaN and infinities are written as null,
+             * as JsonObject writes them.
+             */
+            JsonPayloadWriter &WithDouble(const char *key, double value) noexcept;
+
+            /**
+             * Write a document as the value of `key`. The document is printed by JsonObject.
+             */
+            JsonPayloadWriter &WithObject(const char *key, const Aws::Crt::JsonObject &value) noexcept;
+
+            JsonPayloadWriter &WithStringMap(
+                const char *key,
+                const Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> &value) noexcept;
+
+            /**
+             * Start an object as the value of `key`. Members written until the matching EndObject belong to it.
+             */
+            JsonPayloadWriter &BeginObject(const char *key) noexcept;
+            JsonPayloadWriter &EndObject() noexcept;
+
+            /**
+             * End the object started by the constructor.
+             * @return false if the buffer could not be grown, in which case its contents are incomplete.
+             */
+            bool Finish() noexcept;
+
+          private:
+            void WriteKey(const char *key) noexcept;
+            void WriteString(Aws::Crt::ByteCursor value) noexcept;
+            void Write(Aws::Crt::ByteCursor bytes) noexcept;
+
+            Aws::Crt::ByteBuf &m_buffer;
+            bool m_needsComma;
+            bool m_error;
+        };
+
+        /**
+         * Keeps the buffers of completed publishes for reuse, so that publishing does not allocate once the pool has
+         * warmed up. Buffers that grew large are freed rather than kept.
+         */
+        class PublishBufferPool final
+        {
+          public:
+            /**
+             * @param allocator Allocates the buffers. The pool shares ownership of it, since buffers may be released
+             * after whoever created the pool is gone.
+             */
+            explicit PublishBufferPool(std::shared_ptr<Aws::Crt::Allocator> allocator) noexcept;
+            ~PublishBufferPool();
+            PublishBufferPool(const PublishBufferPool &) = delete;
+            PublishBufferPool &operator=(const PublishBufferPool &) = delete;
+
+            /**
+             * @return An empty buffer. Its allocator is null if one could not be allocated.
+             */
+            Aws::Crt::ByteBuf Acquire() noexcept;
+
+            /**
+             * Return a buffer obtained from Acquire. It must not be used afterwards.
+             */
+            void Release(Aws::Crt::ByteBuf buffer) noexcept;
+
+          private:
+            /* Buffers are allocated with room for a typical request, and those that grew beyond a few of them are not
+             * kept. */
+            static const size_t s_initialBufferCapacity = 512;
+            static const size_t s_maxPooledBufferCapacity = 16 * 1024;
+            static const size_t s_maxPooledBufferCount = 32;
+
+            std::shared_ptr<Aws::Crt::Allocator> m_allocator;
+            std::mutex m_freeBuffersMutex;
+            Aws::Crt::Vector<Aws::Crt::ByteBuf> m_freeBuffers;
+        };
+
+        inline JsonPayloadWriter::JsonPayloadWriter(Aws::Crt::ByteBuf &buffer) noexcept
+            : m_buffer(buffer), m_needsComma(false), m_error(false)
+        {
+            Write(aws_byte_cursor_from_c_str("{"));
+        }
+
+        inline JsonPayloadWriter &JsonPayloadWriter::WithString(
+            const char *key,
+            const Aws::Crt::String &value) noexcept
+        {
+            WriteKey(key);
+            WriteString(aws_byte_cursor_from_array(value.data(), value.size()));
+            return *this;
+        }
+
+        inline JsonPayloadWriter &JsonPayloadWriter::WithInt64(const char *key, int64_t value) noexcept
+        {
+            char number[24];
+            int length = snprintf(number, sizeof(number), "%" PRId64, value);
+            WriteKey(key);
+            Write(aws_byte_cursor_from_array(number, static_cast<size_t>(length)));
+            return *this;
+        }
+
+        inline JsonPayloadWriter &JsonPayloadWriter::WithDouble(const char *key, double value) noexcept
+        {
+            WriteKey(key);
+            if (std::isnan(value) || std::isinf(value))
+            {
+                Write(aws_byte_cursor_from_c_str("null"));
+                return *this;
+            }
+
+            char number[32];
+            int length = snprintf(number, sizeof(number), "%1.15g", value);
+            if (strtod(number, nullptr) != value)
+            {
+                length = snprintf(number, sizeof(number), "%1.17g", value);
+            }
+            Write(aws_byte_cursor_from_array(number, static_cast<size_t>(length)));
+            return *this;
+        }
+
+        inline JsonPayloadWriter &JsonPayloadWriter::WithBool(const char *key, bool value) noexcept
+        {
+            WriteKey(key);
+            Write(aws_byte_cursor_from_c_str(value ? "true" : "false"));
+            return *this;
+        }
+
+        inline JsonPayloadWriter &JsonPayloadWriter::WithObject(
+            const char *key,
+            const Aws::Crt::JsonObject &value) noexcept
+        {
+            Aws::Crt::String document = value.View().WriteCompact(true);
+            WriteKey(key);
+            Write(aws_byte_cursor_from_array(document.data(), document.size()));
+            return *this;
+        }
+
+        inline JsonPayloadWriter &JsonPayloadWriter::WithStringMap(
+            const char *key,
+            const Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> &value) noexcept
+        {
+            BeginObject(key);
+            for (const auto &member : value)
+            {
+                WithString(member.first.c_str(), member.second);
+            }
+            return EndObject();
+        }
+
+        inline JsonPayloadWriter &JsonPayloadWriter::BeginObject(const char *key) noexcept
+        {
+            WriteKey(key);
+            Write(aws_byte_cursor_from_c_str("{"));
+            m_needsComma = false;
+            return *this;
+        }
+
+        inline JsonPayloadWriter &JsonPayloadWriter::EndObject() noexcept
+        {
+            Write(aws_byte_cursor_from_c_str("}"));
+            m_needsComma = true;
+            return *this;
+        }
+
+        inline bool JsonPayloadWriter::Finish() noexcept
+        {
+            Write(aws_byte_cursor_from_c_str("}"));
+            return !m_error;
+        }
+
+        inline void JsonPayloadWriter::WriteKey(const char *key) noexcept
+        {
+            if (m_needsComma)
+            {
+                Write(aws_byte_cursor_from_c_str(","));
+            }
+            WriteString(aws_byte_cursor_from_c_str(key));
+            Write(aws_byte_cursor_from_c_str(":"));
+            m_needsComma = true;
+        }
+
+        inline void JsonPayloadWriter::WriteString(Aws::Crt::ByteCursor value) noexcept
+        {
+            Write(aws_byte_cursor_from_c_str("\""));
+
+            /* Runs of characters that need no escaping are written at once. */
+            size_t runStart = 0;
+            for (size_t i = 0; i < value.len; ++i)
+            {
+                uint8_t character = value.ptr[i];
+                if (character >= 0x20 && character != '"' && character != '\\')
+                {
+                    continue;
+                }
+
+                Write(aws_byte_cursor_from_array(value.ptr + runStart, i - runStart));
+                runStart = i + 1;
+
+                char escape[8];
+                switch (character)
+                {
+                    case '"':
+                        Write(aws_byte_cursor_from_c_str("\\\""));
+                        break;
+                    case '\\':
+                        Write(aws_byte_cursor_from_c_str("\\\\"));
+                        break;
+                    case '\b':
+                        Write(aws_byte_cursor_from_c_str("\\b"));
+                        break;
+                    case '\f':
+                        Write(aws_byte_cursor_from_c_str("\\f"));
+                        break;
+                    case '\n':
+                        Write(aws_byte_cursor_from_c_str("\\n"));
+                        break;
+                    case '\r':
+                        Write(aws_byte_cursor_from_c_str("\\r"));
+                        break;
+                    case '\t':
+                        Write(aws_byte_cursor_from_c_str("\\t"));
+                        break;
+                    default:
+                        snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned int>(character));
+                        Write(aws_byte_cursor_from_c_str(escape));
+                        break;
+                }
+            }
+            Write(aws_byte_cursor_from_array(value.ptr + runStart, value.len - runStart));
+
+            Write(aws_byte_cursor_from_c_str("\""));
+        }
+
+        inline void JsonPayloadWriter::Write(Aws::Crt::ByteCursor bytes) noexcept
+        {
+            if (!m_error && bytes.len > 0 && aws_byte_buf_append_dynamic(&m_buffer, &bytes) != AWS_OP_SUCCESS)
+            {
+                m_error = true;
+            }
+        }
+
+        inline PublishBufferPool::PublishBufferPool(std::shared_ptr<Aws::Crt::Allocator> allocator) noexcept
+            : m_allocator(std::move(allocator))
+        {
+        }
+
+        inline PublishBufferPool::~PublishBufferPool()
+        {
+            for (auto &buffer : m_freeBuffers)
+            {
+                aws_byte_buf_clean_up(&buffer);
+            }
+        }
+
+        inline Aws::Crt::ByteBuf PublishBufferPool::Acquire() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_freeBuffersMutex);
+                if (!m_freeBuffers.empty())
+                {
+                    Aws::Crt::ByteBuf buffer = m_freeBuffers.back();
+                    m_freeBuffers.pop_back();
+                    return buffer;
+                }
+            }
+
+            Aws::Crt::ByteBuf buffer;
+            AWS_ZERO_STRUCT(buffer);
+            aws_byte_buf_init(&buffer, m_allocator.get(), s_initialBufferCapacity);
+            return buffer;
+        }
+
+        inline void PublishBufferPool::Release(Aws::Crt::ByteBuf buffer) noexcept
+        {
+            if (buffer.allocator == nullptr)
+            {
+                return;
+            }
+
+            if (buffer.capacity <= s_maxPooledBufferCapacity)
+            {
+                aws_byte_buf_reset(&buffer, false);
+                std::lock_guard<std::mutex> lock(m_freeBuffersMutex);
+                if (m_freeBuffers.size() < s_maxPooledBufferCount)
+                {
+                    m_freeBuffers.push_back(buffer);
+                    return;
+                }
+            }
+            aws_byte_buf_clean_up(&buffer);
+        }
+    } // namespace Iotservicecommon
+} // namespace Aws
@@ -0,0 +1,378 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/crt/mqtt/MqttClient.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotservicecommon
+    {
+        class SubscriptionRegistry;
+
+        /**
+         * Identifies one subscription made through a service client. Copies of a handle refer to the same
+         * subscription.
+         *
+         * Dropping a handle leaves the subscription in place; call Unsubscribe, or hold the handle in a
+         * ScopedSubscription, to end it.
+         */
+        class SubscriptionHandle final
+        {
+          public:
+            SubscriptionHandle() noexcept = default;
+
+            /**
+             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             */
+            operator bool() const noexcept { return m_registration != nullptr; }
+
+            /**
+             * Stop invoking this subscription's handler. The topic is unsubscribed from once no other subscription
+             * made through the same client uses it. Calling this more than once has no further effect.
+             */
+            void Unsubscribe() noexcept;
+
+          private:
+            friend class SubscriptionRegistry;
+
+            struct Registration
+            {
+                std::shared_ptr<SubscriptionRegistry> registry;
+                Aws::Crt::String topic;
+                uint64_t id = 0;
+                std::atomic<bool> released{false};
+            };
+
+            explicit SubscriptionHandle(std::shared_ptr<Registration> registration) noexcept
+                : m_registration(std::move(registration))
+            {
+            }
+
+            std::shared_ptr<Registration> m_registration;
+        };
+
+        /**
+         * Owns a subscription, and unsubscribes from it when destroyed.
+         */
+        class ScopedSubscription final
+        {
+          public:
+            ScopedSubscription() noexcept = default;
+            ScopedSubscription(SubscriptionHandle handle) noexcept : m_handle(std::move(handle)) {}
+            ~ScopedSubscription() { Reset(); }
+            ScopedSubscription(const ScopedSubscription &) = delete;
+            ScopedSubscription &operator=(const ScopedSubscription &) = delete;
+            ScopedSubscription(ScopedSubscription &&other) noexcept : m_handle(std::move(other.m_handle))
+            {
+                other.m_handle = SubscriptionHandle();
+            }
+            ScopedSubscription &operator=(ScopedSubscription &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    Reset();
+                    m_handle = std::move(other.m_handle);
+                    other.m_handle = SubscriptionHandle();
+                }
+                return *this;
+            }
+
+            operator bool() const noexcept { return m_handle; }
+
+            /**
+             * Unsubscribe now rather than when destroyed.
+             */
+            void Reset() noexcept
+            {
+                m_handle.Unsubscribe();
+                m_handle = SubscriptionHandle();
+            }
+
+          private:
+            SubscriptionHandle m_handle;
+        };
+
+        /**
+         * The points in the dispatch of an incoming message that are reported to DispatchTraceHooks.
+         */
+        enum class DispatchPhase
+        {
+            /** The message has been matched to the handlers of its topic. */
+            HandlersFound,
+            /** A handler of the message has returned. */
+            HandlerDone,
+        };
+
+        /**
+         * Lets the client that owns a registry trace the dispatch of incoming messages, without the registry depending
+         * on the tracing library. Nothing is traced if either hook is null, or if `Start` returns 0.
+         */
+        struct DispatchTraceHooks
+        {
+            /** Called when a message arrives. Returns when it arrived in nanoseconds, or 0 not to trace it. */
+            uint64_t (*Start)() = nullptr;
+            /** Called with the value returned by `Start` as the message reaches each phase. */
+            void (*Mark)(DispatchPhase phase, uint64_t startNs) = nullptr;
+        };
+
+        /**
+         * Shares one broker subscription between every subscription a service client makes to the same topic.
+         *
+         * The connection only keeps one handler per topic, so without this a second subscription to a topic would
+         * replace the first one's handler. Here each topic has a single connection handler that fans messages out to
+         * the handlers of all its subscriptions, and the topic is unsubscribed from when the last of them is
+         * released.
+         */
+        class SubscriptionRegistry final : public std::enable_shared_from_this<SubscriptionRegistry>
+        {
+          public:
+            using OnMessage = std::function<void(const Aws::Crt::ByteBuf &payload)>;
+            using OnSubAck = std::function<void(int errorCode)>;
+
+            /**
+             * @param allocator Allocates the registry's bookkeeping. The registry shares ownership of it, since
+             * subscriptions may outlive the client.
+             * @param traceHooks Called as incoming messages are dispatched.
+             */
+            SubscriptionRegistry(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                std::shared_ptr<Aws::Crt::Allocator> allocator,
+                const DispatchTraceHooks &traceHooks = DispatchTraceHooks()) noexcept
+                : m_connection(connection), m_allocator(std::move(allocator)), m_traceHooks(traceHooks),
+                  m_topics(Aws::Crt::StlAllocator<std::pair<const Aws::Crt::String, Topic>>(m_allocator.get())),
+                  m_nextId(1)
+            {
+            }
+
+            /**
+             * Subscribe to `topic`. If the topic is already subscribed to, `qos` is ignored and `onSubAck` is
+             * invoked with the result of the existing subscribe. A topic whose subscribe fails is forgotten, so that
+             * the next subscription to it subscribes again.
+             */
+            SubscriptionHandle Subscribe(
+                const Aws::Crt::String &topic,
+                Aws::Crt::Mqtt::QOS qos,
+                OnMessage &&onMessage,
+                OnSubAck &&onSubAck) noexcept;
+
+            /**
+             * @return The number of topics currently subscribed to.
+             */
+            size_t GetTopicCount() const noexcept
+            {
+                std::lock_guard<std::mutex> lock(m_topicsMutex);
+                return m_topics.size();
+            }
+
+          private:
+            friend class SubscriptionHandle;
+
+            struct Topic
+            {
+                Aws::Crt::Map<uint64_t, std::shared_ptr<OnMessage>> handlers;
+                Aws::Crt::Vector<OnSubAck> pendingSubAcks;
+                bool subAcked = false;
+                /* The id of the subscription that subscribed to the topic, so that a late SUBACK for an earlier
+                 * subscribe to the same topic is not mistaken for this one's. */
+                uint64_t subscribeId = 0;
+            };
+
+            void OnPublish(const Aws::Crt::String &topic, const Aws::Crt::ByteBuf &payload) noexcept;
+            void OnSubscribeComplete(const Aws::Crt::String &topic, uint64_t subscribeId, int errorCode) noexcept;
+            void Release(const Aws::Crt::String &topic, uint64_t id) noexcept;
+
+            std::weak_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
+            std::shared_ptr<Aws::Crt::Allocator> m_allocator;
+            DispatchTraceHooks m_traceHooks;
+            mutable std::mutex m_topicsMutex;
+            Aws::Crt::Map<Aws::Crt::String, Topic> m_topics;
+            uint64_t m_nextId;
+        };
+
+        inline void SubscriptionHandle::Unsubscribe() noexcept
+        {
+            if (m_registration && !m_registration->released.exchange(true))
+            {
+                m_registration->registry->Release(m_registration->topic, m_registration->id);
+            }
+        }
+
+        inline SubscriptionHandle SubscriptionRegistry::Subscribe(
+            const Aws::Crt::String &topic,
+            Aws::Crt::Mqtt::QOS qos,
+            OnMessage &&onMessage,
+            OnSubAck &&onSubAck) noexcept
+        {
+            std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> connection = m_connection.lock();
+            if (!connection)
+            {
+                return SubscriptionHandle();
+            }
+
+            std::unique_lock<std::mutex> lock(m_topicsMutex);
+            uint64_t id = m_nextId++;
+            auto topicIter = m_topics.find(topic);
+            if (topicIter != m_topics.end())
+            {
+                Topic &existing = topicIter->second;
+                existing.handlers.emplace(
+                    id,
+                    std::allocate_shared<OnMessage>(
+                        Aws::Crt::StlAllocator<OnMessage>(m_allocator.get()), std::move(onMessage)));
+                if (!existing.subAcked)
+                {
+                    existing.pendingSubAcks.push_back(std::move(onSubAck));
+                }
+                else
+                {
+                    lock.unlock();
+                    if (onSubAck)
+                    {
+                        onSubAck(AWS_ERROR_SUCCESS);
+                    }
+                }
+            }
+            else
+            {
+                Topic &added = m_topics[topic];
+                added.handlers.emplace(
+                    id,
+                    std::allocate_shared<OnMessage>(
+                        Aws::Crt::StlAllocator<OnMessage>(m_allocator.get()), std::move(onMessage)));
+                added.pendingSubAcks.push_back(std::move(onSubAck));
+                added.subscribeId = id;
+
+                /* The connection's handlers keep the registry alive, so that messages are still delivered to
+                 * subscriptions whose client has been destroyed. */
+                std::shared_ptr<SubscriptionRegistry> self = shared_from_this();
+                auto onSubscribePublish = [self, topic](
+                                              Aws::Crt::Mqtt::MqttConnection &,
+                                              const Aws::Crt::String &,
+                                              const Aws::Crt::ByteBuf &payload) { self->OnPublish(topic, payload); };
+                auto onSubscribeComplete = [self, topic, id](
+                                               Aws::Crt::Mqtt::MqttConnection &,
+                                               uint16_t,
+                                               const Aws::Crt::String &,
+                                               Aws::Crt::Mqtt::QOS,
+                                               int errorCode) { self->OnSubscribeComplete(topic, id, errorCode); };
+
+                if (connection->Subscribe(
+                        topic.c_str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete)) == 0)
+                {
+                    m_topics.erase(topic);
+                    return SubscriptionHandle();
+                }
+            }
+
+            /* Registrations own the registry, and with it the allocator, so they cannot be allocated with it. */
+            auto registration = std::make_shared<SubscriptionHandle::Registration>();
+            registration->registry = shared_from_this();
+            registration->topic = topic;
+            registration->id = id;
+            return SubscriptionHandle(std::move(registration));
+        }
+
+        inline void SubscriptionRegistry::OnPublish(
+            const Aws::Crt::String &topic,
+            const Aws::Crt::ByteBuf &payload) noexcept
+        {
+            uint64_t traceStartNs = 0;
+            if (m_traceHooks.Start != nullptr && m_traceHooks.Mark != nullptr)
+            {
+                traceStartNs = m_traceHooks.Start();
+            }
+
+            /* Handlers are invoked unlocked, so that they may subscribe and unsubscribe. */
+            Aws::Crt::Vector<std::shared_ptr<OnMessage>> handlers;
+            {
+                std::lock_guard<std::mutex> lock(m_topicsMutex);
+                auto topicIter = m_topics.find(topic);
+                if (topicIter == m_topics.end())
+                {
+                    return;
+                }
+                handlers.reserve(topicIter->second.handlers.size());
+                for (const auto &handler : topicIter->second.handlers)
+                {
+                    handlers.push_back(handler.second);
+                }
+            }
+            if (traceStartNs != 0)
+            {
+                m_traceHooks.Mark(DispatchPhase::HandlersFound, traceStartNs);
+            }
+
+            for (const auto &handler : handlers)
+            {
+                (*handler)(payload);
+                if (traceStartNs != 0)
+                {
+                    m_traceHooks.Mark(DispatchPhase::HandlerDone, traceStartNs);
+                }
+            }
+        }
+
+        inline void SubscriptionRegistry::OnSubscribeComplete(
+            const Aws::Crt::String &topic,
+            uint64_t subscribeId,
+            int errorCode) noexcept
+        {
+            Aws::Crt::Vector<OnSubAck> subAcks;
+            {
+                std::lock_guard<std::mutex> lock(m_topicsMutex);
+                auto topicIter = m_topics.find(topic);
+                if (topicIter == m_topics.end() || topicIter->second.subscribeId != subscribeId)
+                {
+                    return;
+                }
+                subAcks.swap(topicIter->second.pendingSubAcks);
+                if (errorCode == AWS_ERROR_SUCCESS)
+                {
+                    topicIter->second.subAcked = true;
+                }
+                else
+                {
+                    m_topics.erase(topicIter);
+                }
+            }
+
+            for (auto &subAck : subAcks)
+            {
+                if (subAck)
+                {
+                    subAck(errorCode);
+                }
+            }
+        }
+
+        inline void SubscriptionRegistry::Release(const Aws::Crt::String &topic, uint64_t id) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_topicsMutex);
+            auto topicIter = m_topics.find(topic);
+            if (topicIter == m_topics.end())
+            {
+                return;
+            }
+            topicIter->second.handlers.erase(id);
+            if (!topicIter->second.handlers.empty())
+            {
+                return;
+            }
+
+            /* Every subscription to the topic has been released, so a SUBACK still pending is no longer reported. */
+            m_topics.erase(topicIter);
+            std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> connection = m_connection.lock();
+            if (connection)
+            {
+                connection->Unsubscribe(topic.c_str(), [](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int) {});
+            }
+        }
+    } // namespace Iotservicecommon
+} // namespace Aws
@@ -0,0 +1,414 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotservicecommon/OfflinePublishLog.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace Aws
+{
+    namespace Iotservicecommon
+    {
+        /* Records start on 8 byte boundaries, so that their headers can be read in place. */
+        size_t OfflinePublishLog::s_recordSize(size_t length) noexcept
+        {
+            return (sizeof(RecordHeader) + length + 7) & ~size_t(7);
+        }
+
+        uint32_t OfflinePublishLog::s_checksum(const RecordHeader &header, const uint8_t *record) noexcept
+        {
+            /* FNV-1a */
+            uint32_t hash = 2166136261u;
+            auto add = [&hash](const uint8_t *bytes, size_t length) {
+                for (size_t i = 0; i < length; ++i)
+                {
+                    hash = (hash ^ bytes[i]) * 16777619u;
+                }
+            };
+            add(reinterpret_cast<const uint8_t *>(&header.length), sizeof(header.length));
+            add(reinterpret_cast<const uint8_t *>(&header.sequence), sizeof(header.sequence));
+            add(record, header.length);
+            return hash;
+        }
+
+        OfflinePublishLog::OfflinePublishLog() noexcept
+            : m_maxBytes(0), m_syncEachWrite(false), m_data(nullptr), m_size(0), m_file(s_noFile),
+              m_mapping(s_noFile), m_tail(0), m_doneBytes(0), m_nextSequence(1)
+        {
+        }
+
+        OfflinePublishLog::~OfflinePublishLog() { Close(); }
+
+        bool OfflinePublishLog::Open(const Aws::Crt::String &path, size_t maxBytes, bool syncEachWrite) noexcept
+        {
+            Close();
+            m_path = path;
+            m_maxBytes = (std::max)(maxBytes, sizeof(LogHeader) + s_recordSize(0));
+            m_syncEachWrite = syncEachWrite;
+            if (!Map(m_path, m_maxBytes))
+            {
+                return false;
+            }
+            if (!Recover())
+            {
+                Close();
+                return false;
+            }
+            return true;
+        }
+
+        void OfflinePublishLog::Close() noexcept
+        {
+            Unmap();
+            m_tail = 0;
+            m_doneBytes = 0;
+            m_nextSequence = 1;
+            m_records.clear();
+        }
+
+        bool OfflinePublishLog::Recover() noexcept
+        {
+            auto *logHeader = reinterpret_cast<LogHeader *>(m_data);
+            if (logHeader->magic == 0)
+            {
+                logHeader->magic = s_logMagic;
+                logHeader->formatVersion = s_logFormatVersion;
+                logHeader->reserved = 0;
+                Sync(0, sizeof(LogHeader));
+            }
+            else if (logHeader->magic != s_logMagic || logHeader->formatVersion != s_logFormatVersion)
+            {
+                return false;
+            }
+
+            size_t offset = sizeof(LogHeader);
+            while (offset + sizeof(RecordHeader) <= m_size)
+            {
+                const auto *header = reinterpret_cast<const RecordHeader *>(m_data + offset);
+                if (header->length > m_size - offset - sizeof(RecordHeader) ||
+                    (header->state != s_recordLive && header->state != s_recordDone) ||
+                    header->checksum != s_checksum(*header, m_data + offset + sizeof(RecordHeader)))
+                {
+                    break;
+                }
+
+                if (header->state == s_recordLive)
+                {
+                    m_records[header->sequence] = offset;
+                }
+                else
+                {
+                    m_doneBytes += s_recordSize(header->length);
+                }
+                m_nextSequence = (std::max)(m_nextSequence, header->sequence + 1);
+                offset += s_recordSize(header->length);
+            }
+            m_tail = offset;
+
+            /* Whatever follows the last good record was cut short, and must not be read as records if it is only
+             * partly overwritten. */
+            size_t cleared = (std::min)(m_size - m_tail, sizeof(RecordHeader));
+            memset(m_data + m_tail, 0, cleared);
+            Sync(m_tail, cleared);
+            return true;
+        }
+
+        uint64_t OfflinePublishLog::Append(const Aws::Crt::ByteCursor &record) noexcept
+        {
+            if (!IsOpen() || record.len > UINT32_MAX)
+            {
+                return 0;
+            }
+
+            size_t recordSize = s_recordSize(record.len);
+            if (m_tail + recordSize > m_size && (m_doneBytes == 0 || !Compact() || m_tail + recordSize > m_size))
+            {
+                return 0;
+            }
+
+            uint8_t *recordStart = m_data + m_tail;
+            RecordHeader header;
+            header.length = static_cast<uint32_t>(record.len);
+            header.sequence = m_nextSequence;
+            header.state = s_recordLive;
+            header.reserved = 0;
+            header.checksum = s_checksum(header, record.ptr);
+            if (record.len > 0)
+            {
+                memcpy(recordStart + sizeof(RecordHeader), record.ptr, record.len);
+            }
+            memcpy(recordStart, &header, sizeof(RecordHeader));
+
+            /* The next record's header stays zero until it is written, so that recovery stops here. */
+            size_t next = m_tail + recordSize;
+            size_t cleared = (std::min)(m_size - next, sizeof(RecordHeader));
+            memset(m_data + next, 0, cleared);
+            Sync(m_tail, recordSize + cleared);
+
+            m_records[header.sequence] = m_tail;
+            m_tail = next;
+            return m_nextSequence++;
+        }
+
+        void OfflinePublishLog::MarkDone(uint64_t sequence) noexcept
+        {
+            auto recordIter = m_records.find(sequence);
+            if (recordIter == m_records.end())
+            {
+                return;
+            }
+            auto *header = reinterpret_cast<RecordHeader *>(m_data + recordIter->second);
+            header->state = s_recordDone;
+            Sync(recordIter->second, sizeof(RecordHeader));
+            m_doneBytes += s_recordSize(header->length);
+            m_records.erase(recordIter);
+        }
+
+        void OfflinePublishLog::ForEach(const OnRecord &onRecord) const noexcept
+        {
+            for (const auto &record : m_records)
+            {
+                const auto *header = reinterpret_cast<const RecordHeader *>(m_data + record.second);
+                onRecord(
+                    record.first,
+                    Aws::Crt::ByteCursorFromArray(m_data + record.second + sizeof(RecordHeader), header->length));
+            }
+        }
+
+        bool OfflinePublishLog::Compact() noexcept
+        {
+            Aws::Crt::String compactPath = m_path + ".compact";
+            remove(compactPath.c_str());
+
+            OfflinePublishLog compacted;
+            compacted.m_syncEachWrite = false;
+            size_t liveBytes = m_tail - sizeof(LogHeader) - m_doneBytes;
+            if (!compacted.Map(compactPath, (std::max)(m_maxBytes, sizeof(LogHeader) + liveBytes)) ||
+                !compacted.Recover())
+            {
+                compacted.Close();
+                remove(compactPath.c_str());
+                return false;
+            }
+
+            size_t offset = sizeof(LogHeader);
+            for (const auto &record : m_records)
+            {
+                const auto *header = reinterpret_cast<const RecordHeader *>(m_data + record.second);
+                size_t recordSize = s_recordSize(header->length);
+                memcpy(compacted.m_data + offset, header, recordSize);
+                offset += recordSize;
+            }
+            compacted.m_syncEachWrite = true;
+            compacted.Sync(0, offset);
+            compacted.Close();
+
+            /* Windows cannot replace a file that is mapped. */
+            Unmap();
+            bool replaced = s_replaceFile(compactPath, m_path);
+            if (!replaced)
+            {
+                remove(compactPath.c_str());
+            }
+
+            uint64_t nextSequence = m_nextSequence;
+            m_records.clear();
+            m_doneBytes = 0;
+            if (!Map(m_path, m_maxBytes) || !Recover())
+            {
+                Close();
+                return false;
+            }
+            m_nextSequence = (std::max)(m_nextSequence, nextSequence);
+            return replaced;
+        }
+
+#if defined(_WIN32)
+        bool OfflinePublishLog::Map(const Aws::Crt::String &path, size_t size) noexcept
+        {
+            HANDLE file = CreateFileA(
+                path.c_str(),
+                GENERIC_READ | GENERIC_WRITE,
+                0,
+                nullptr,
+                OPEN_ALWAYS,
+                FILE_ATTRIBUTE_NORMAL,
+                nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize))
+            {
+                CloseHandle(file);
+                return false;
+            }
+            size = (std::max)(size, static_cast<size_t>(fileSize.QuadPart));
+
+            /* Mapping more than the file holds extends it with zeros. */
+            uint64_t mappingSize = size;
+            HANDLE mapping = CreateFileMappingA(
+                file,
+                nullptr,
+                PAGE_READWRITE,
+                static_cast<DWORD>(mappingSize >> 32),
+                static_cast<DWORD>(mappingSize & 0xffffffff),
+                nullptr);
+            if (mapping == nullptr)
+            {
+                CloseHandle(file);
+                return false;
+            }
+
+            void *data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+            if (data == nullptr)
+            {
+                CloseHandle(mapping);
+                CloseHandle(file);
+                return false;
+            }
+
+            m_data = static_cast<uint8_t *>(data);
+            m_size = size;
+            m_file = reinterpret_cast<intptr_t>(file);
+            m_mapping = reinterpret_cast<intptr_t>(mapping);
+            return true;
+        }
+
+        void OfflinePublishLog::Unmap() noexcept
+        {
+            if (m_data != nullptr)
+            {
+                UnmapViewOfFile(m_data);
+                CloseHandle(reinterpret_cast<HANDLE>(m_mapping));
+                CloseHandle(reinterpret_cast<HANDLE>(m_file));
+            }
+            m_data = nullptr;
+            m_size = 0;
+            m_file = s_noFile;
+            m_mapping = s_noFile;
+        }
+
+        void OfflinePublishLog::Sync(size_t offset, size_t length) noexcept
+        {
+            if (m_syncEachWrite && length > 0)
+            {
+                FlushViewOfFile(m_data + offset, length);
+                FlushFileBuffers(reinterpret_cast<HANDLE>(m_file));
+            }
+        }
+
+        bool OfflinePublishLog::s_replaceFile(const Aws::Crt::String &from, const Aws::Crt::String &to) noexcept
+        {
+            /* MOVEFILE_WRITE_THROUGH returns once the rename is on disk. */
+            return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+        }
+#else
+        bool OfflinePublishLog::Map(const Aws::Crt::String &path, size_t size) noexcept
+        {
+            int file = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+            if (file < 0)
+            {
+                return false;
+            }
+
+            struct stat fileStat;
+            if (fstat(file, &fileStat) != 0)
+            {
+                close(file);
+                return false;
+            }
+            size = (std::max)(size, static_cast<size_t>(fileStat.st_size));
+
+            /* Extending the file with ftruncate leaves it sparse, so space is only used as records are written. */
+            if (static_cast<size_t>(fileStat.st_size) < size && ftruncate(file, static_cast<off_t>(size)) != 0)
+            {
+                close(file);
+                return false;
+            }
+
+            void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+            if (data == MAP_FAILED)
+            {
+                close(file);
+                return false;
+            }
+
+            m_data = static_cast<uint8_t *>(data);
+            m_size = size;
+            m_file = file;
+            return true;
+        }
+
+        void OfflinePublishLog::Unmap() noexcept
+        {
+            if (m_data != nullptr)
+            {
+                munmap(m_data, m_size);
+                close(static_cast<int>(m_file));
+            }
+            m_data = nullptr;
+            m_size = 0;
+            m_file = s_noFile;
+            m_mapping = s_noFile;
+        }
+
+        void OfflinePublishLog::Sync(size_t offset, size_t length) noexcept
+        {
+            if (m_syncEachWrite && length > 0)
+            {
+                /* msync needs a page-aligned address. */
+                size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+                size_t start = offset - offset % pageSize;
+                msync(m_data + start, offset + length - start, MS_SYNC);
+            }
+        }
+
+        bool OfflinePublishLog::s_replaceFile(const Aws::Crt::String &from, const Aws::Crt::String &to) noexcept
+        {
+            if (rename(from.c_str(), to.c_str()) != 0)
+            {
+                return false;
+            }
+
+            /* The rename is only durable once the directory holding the file is synced. Until then, losing power
+             * can bring back the log from before compaction, whose records would be sent again. */
+            Aws::Crt::String directory = ".";
+            size_t separator = to.find_last_of('/');
+            if (separator != Aws::Crt::String::npos)
+            {
+                directory = separator == 0 ? "/" : to.substr(0, separator);
+            }
+            int directoryFile = open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+            if (directoryFile < 0)
+            {
+                return false;
+            }
+            bool synced = fsync(directoryFile) == 0;
+            close(directoryFile);
+            return synced;
+        }
+#endif
+    } // namespace Iotservicecommon
+} // namespace Aws
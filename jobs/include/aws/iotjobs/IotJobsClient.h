@@ -7,6 +7,7 @@
  */
 
 #include <aws/iotjobs/Exports.h>
+#include <aws/iotjobs/SubscriptionHandle.h>
 
 #include <aws/crt/StlAllocator.h>
 #include <aws/crt/Types.h>
@@ -29,6 +30,7 @@ namespace Aws
         class JobExecutionsChangedSubscriptionRequest;
         class NextJobExecutionChangedEvent;
         class NextJobExecutionChangedSubscriptionRequest;
+        class PublishBufferPool;
         class RejectedError;
         class StartNextJobExecutionResponse;
         class StartNextPendingJobExecutionRequest;
@@ -80,12 +82,37 @@ namespace Aws
         class AWS_IOTJOBS_API IotJobsClient final
         {
           public:
-            IotJobsClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection);
-            IotJobsClient(const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client);
+            /**
+             * @param allocator Allocates the client's publish buffers and subscription bookkeeping. The client counts
+             * what it allocates; see GetAllocatedBytes.
+             */
+            IotJobsClient(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                Aws::Crt::Allocator *allocator = Aws::Crt::ApiAllocator());
+            IotJobsClient(
+                const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client,
+                Aws::Crt::Allocator *allocator = Aws::Crt::ApiAllocator());
 
             operator bool() const noexcept;
             int GetLastError() const noexcept;
 
+            /**
+             * @return The allocator the client allocates with, which counts allocations before passing them on to
+             * the allocator the client was created with.
+             */
+            Aws::Crt::Allocator *GetAllocator() const noexcept;
+
+            /**
+             * @return The number of bytes the client has allocated and not yet freed. Buffers of publishes that are
+             * still in flight, and buffers kept for reuse, are included.
+             */
+            size_t GetAllocatedBytes() const noexcept;
+
+            /**
+             * @return The number of allocations the client has made and not yet freed.
+             */
+            size_t GetAllocationCount() const noexcept;
+
             /**
              * Subscribes to the accepted topic for the DescribeJobExecution operation
              *
@@ -103,9 +130,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToDescribeJobExecutionAccepted(
+            SubscriptionHandle SubscribeToDescribeJobExecutionAccepted(
                 const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDescribeJobExecutionAcceptedResponse &handler,
@@ -128,9 +156,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToDescribeJobExecutionRejected(
+            SubscriptionHandle SubscribeToDescribeJobExecutionRejected(
                 const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDescribeJobExecutionRejectedResponse &handler,
@@ -153,9 +182,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToGetPendingJobExecutionsAccepted(
+            SubscriptionHandle SubscribeToGetPendingJobExecutionsAccepted(
                 const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetPendingJobExecutionsAcceptedResponse &handler,
@@ -178,9 +208,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToGetPendingJobExecutionsRejected(
+            SubscriptionHandle SubscribeToGetPendingJobExecutionsRejected(
                 const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetPendingJobExecutionsRejectedResponse &handler,
@@ -203,9 +234,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToJobExecutionsChangedEvents(
+            SubscriptionHandle SubscribeToJobExecutionsChangedEvents(
                 const Aws::Iotjobs::JobExecutionsChangedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToJobExecutionsChangedEventsResponse &handler,
@@ -228,9 +260,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToNextJobExecutionChangedEvents(
+            SubscriptionHandle SubscribeToNextJobExecutionChangedEvents(
                 const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToNextJobExecutionChangedEventsResponse &handler,
@@ -253,9 +286,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToStartNextPendingJobExecutionAccepted(
+            SubscriptionHandle SubscribeToStartNextPendingJobExecutionAccepted(
                 const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &handler,
@@ -278,9 +312,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToStartNextPendingJobExecutionRejected(
+            SubscriptionHandle SubscribeToStartNextPendingJobExecutionRejected(
                 const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToStartNextPendingJobExecutionRejectedResponse &handler,
@@ -303,9 +338,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToUpdateJobExecutionAccepted(
+            SubscriptionHandle SubscribeToUpdateJobExecutionAccepted(
                 const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateJobExecutionAcceptedResponse &handler,
@@ -328,9 +364,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToUpdateJobExecutionRejected(
+            SubscriptionHandle SubscribeToUpdateJobExecutionRejected(
                 const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateJobExecutionRejectedResponse &handler,
@@ -431,7 +468,12 @@ namespace Aws
                 const OnPublishComplete &onPubAck);
 
           private:
+            /* Counts what the client allocates. Shared with the buffer pool and subscription registry, which may
+             * outlive the client. */
+            std::shared_ptr<Aws::Crt::Allocator> m_allocator;
             std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
+            std::shared_ptr<SubscriptionRegistry> m_subscriptions;
+            std::shared_ptr<PublishBufferPool> m_publishBuffers;
         };
 
     } // namespace Iotjobs
@@ -0,0 +1,148 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotjobs/Exports.h>
+#include <aws/iotjobs/IotJobsClient.h>
+#include <aws/iotjobs/OfflinePublishLog.h>
+
+#include <aws/crt/Types.h>
+#include <aws/crt/io/EventLoopGroup.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <chrono>
+#include <mutex>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        class UpdateJobExecutionRequest;
+
+        struct AWS_IOTJOBS_API JobExecutionUpdateQueueOptions
+        {
+            /**
+             * The file the queue is kept in. It is created if it does not exist.
+             */
+            Aws::Crt::String FilePath;
+
+            /**
+             * The size of the file. Updates are refused once it is full of updates that have not been published.
+             */
+            size_t MaxFileBytes = 256 * 1024;
+
+            /**
+             * Whether each update is flushed to disk before Enqueue returns, so that it survives the device losing
+             * power as well as the process exiting.
+             */
+            bool SyncEachWrite = true;
+
+            /**
+             * How many updates are published per second at most while the queue drains.
+             */
+            uint32_t MaxPublishesPerSecond = 10;
+
+            Aws::Crt::Mqtt::QOS Qos = AWS_MQTT_QOS_AT_LEAST_ONCE;
+
+            /**
+             * Runs the drain timer. The default event loop group is used if this is null.
+             */
+            Aws::Crt::Io::EventLoopGroup *EventLoopGroup = nullptr;
+        };
+
+        /**
+         * Keeps job execution updates in a file until they have been published, so that status changes made while
+         * the device is offline are reported once it reconnects, even if the process restarted in between.
+         *
+         * Updates are never merged, since each status change of an execution matters to the service. They are
+         * published one at a time in the order they were queued, and each is only dropped from the file once the
+         * connection has acknowledged it, so the updates of an execution always arrive in order. Whether the service
+         * accepted an update is not tracked.
+         *
+         * The queue only publishes while it is resumed, which should be done whenever the connection succeeds or
+         * resumes, and paused whenever it is interrupted.
+         */
+        class AWS_IOTJOBS_API JobExecutionUpdateQueue final
+            : public std::enable_shared_from_this<JobExecutionUpdateQueue>
+        {
+          public:
+            /**
+             * @return The queue, or nullptr if it could not be allocated. The queue is only created owned by a
+             * std::shared_ptr, since its drain timer and publish callbacks hold it weakly.
+             */
+            static std::shared_ptr<JobExecutionUpdateQueue> CreateQueue(
+                std::shared_ptr<IotJobsClient> client,
+                const JobExecutionUpdateQueueOptions &options,
+                Aws::Crt::Allocator *allocator = Aws::Crt::ApiAllocator()) noexcept;
+            ~JobExecutionUpdateQueue();
+            JobExecutionUpdateQueue(const JobExecutionUpdateQueue &) = delete;
+            JobExecutionUpdateQueue &operator=(const JobExecutionUpdateQueue &) = delete;
+
+            /**
+             * Open the queue's file, and take back the updates that were left in it.
+             * @return false if the file could not be opened, or is not a queue file.
+             */
+            bool Open() noexcept;
+
+            /**
+             * @return false if the queue is not open, or its file is full.
+             */
+            bool Enqueue(const UpdateJobExecutionRequest &request) noexcept;
+
+            /**
+             * Start publishing the queued updates.
+             */
+            void Resume() noexcept;
+
+            /**
+             * Stop publishing the queued updates. An update that was already published stays queued until it is
+             * acknowledged.
+             */
+            void Pause() noexcept;
+
+            size_t GetPendingCount() const noexcept;
+
+          private:
+            JobExecutionUpdateQueue(
+                std::shared_ptr<IotJobsClient> client,
+                const JobExecutionUpdateQueueOptions &options,
+                Aws::Crt::Allocator *allocator) noexcept;
+
+            struct PendingUpdate
+            {
+                Aws::Crt::String thingName;
+                Aws::Crt::String jobId;
+                Aws::Crt::String payload;
+            };
+
+            struct DrainTask;
+
+            static void s_onDrainTask(struct aws_task *task, void *arg, enum aws_task_status status);
+
+            void Drain() noexcept;
+            void OnPublished(uint64_t sequence, int ioErr) noexcept;
+            void ScheduleDrainLocked() noexcept;
+
+            std::shared_ptr<IotJobsClient> m_client;
+            JobExecutionUpdateQueueOptions m_options;
+            Aws::Crt::Allocator *m_allocator;
+            struct aws_event_loop *m_eventLoop;
+            std::chrono::nanoseconds m_publishInterval;
+
+            /* This mutex protects everything below it. */
+            mutable std::mutex m_mutex;
+            OfflinePublishLog m_log;
+            /* By the sequence number of their record, which is also the order they are published in. */
+            Aws::Crt::Map<uint64_t, PendingUpdate> m_pending;
+            bool m_resumed;
+            bool m_drainScheduled;
+            uint64_t m_publishing;
+            std::chrono::steady_clock::time_point m_lastPublish;
+        };
+    } // namespace Iotjobs
+} // namespace Aws
@@ -0,0 +1,74 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Types.h>
+#include <aws/iotservicecommon/PayloadReader.h>
+
+#include <aws/iotjobs/Exports.h>
+#include <aws/iotjobs/NextJobExecutionChangedEvent.h>
+#include <aws/iotjobs/RejectedError.h>
+#include <aws/iotjobs/StartNextJobExecutionResponse.h>
+#include <aws/iotjobs/UpdateJobExecutionResponse.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        using JsonPayloadValue = Aws::Iotservicecommon::JsonPayloadValue;
+        using JsonPayloadReader = Aws::Iotservicecommon::JsonPayloadReader;
+
+        /**
+         * How a payload is decoded into a model.
+         */
+        enum class PayloadDecoding
+        {
+            /**
+             * Parse the payload into a Crt::JsonObject, then load the model from it.
+             */
+            JsonObject,
+            /**
+             * Decode the model's fields directly from the payload with a JsonPayloadReader. A payload the reader
+             * cannot decode, such as one with escaped keys or values of unexpected types, is decoded with JsonObject
+             * instead.
+             */
+            OnDemand,
+        };
+
+        /**
+         * Decode a payload into a model. The models received most often are decoded on demand; the others always
+         * go through JsonObject.
+         */
+        template <typename Model>
+        void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            Model &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand)
+        {
+            (void)decoding;
+            Aws::Crt::String objectStr(reinterpret_cast<const char *>(payload.ptr), payload.len);
+            Aws::Crt::JsonObject jsonObject(objectStr);
+            model = jsonObject.View();
+        }
+
+        AWS_IOTJOBS_API void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            NextJobExecutionChangedEvent &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand);
+        AWS_IOTJOBS_API void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            StartNextJobExecutionResponse &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand);
+        AWS_IOTJOBS_API void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            UpdateJobExecutionResponse &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand);
+        AWS_IOTJOBS_API void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            RejectedError &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand);
+    } // namespace Iotjobs
+} // namespace Aws
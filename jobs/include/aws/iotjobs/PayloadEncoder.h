@@ -0,0 +1,41 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotservicecommon/PayloadWriter.h>
+
+#include <aws/iotjobs/DescribeJobExecutionRequest.h>
+#include <aws/iotjobs/Exports.h>
+#include <aws/iotjobs/GetPendingJobExecutionsRequest.h>
+#include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        /* The writer and buffer pool are shared with the other service clients. */
+        using JsonPayloadWriter = Aws::Iotservicecommon::JsonPayloadWriter;
+        using PublishBufferPool = Aws::Iotservicecommon::PublishBufferPool;
+
+        /**
+         * Serialize a request into `payload` as SerializeToObject would, without building a JsonObject.
+         * @return false if `payload` could not be grown.
+         */
+        AWS_IOTJOBS_API bool EncodePayload(
+            const DescribeJobExecutionRequest &request,
+            Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTJOBS_API bool EncodePayload(
+            const GetPendingJobExecutionsRequest &request,
+            Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTJOBS_API bool EncodePayload(
+            const StartNextPendingJobExecutionRequest &request,
+            Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTJOBS_API bool EncodePayload(
+            const UpdateJobExecutionRequest &request,
+            Aws::Crt::ByteBuf &payload) noexcept;
+    } // namespace Iotjobs
+} // namespace Aws
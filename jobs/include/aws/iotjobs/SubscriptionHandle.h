@@ -0,0 +1,20 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotservicecommon/SubscriptionRegistry.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        /**
+         * Identifies one subscription made through IotJobsClient. See Aws::Iotservicecommon::SubscriptionHandle.
+         */
+        using SubscriptionHandle = Aws::Iotservicecommon::SubscriptionHandle;
+        using ScopedSubscription = Aws::Iotservicecommon::ScopedSubscription;
+        using SubscriptionRegistry = Aws::Iotservicecommon::SubscriptionRegistry;
+    } // namespace Iotjobs
+} // namespace Aws
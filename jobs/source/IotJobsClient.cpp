@@ -5,6 +5,9 @@
  */
 #include <aws/iotjobs/IotJobsClient.h>
 
+#include <aws/iotdevicecommon/Tracing.h>
+#include <aws/iotservicecommon/CountingAllocator.h>
+
 #include <aws/iotjobs/DescribeJobExecutionRequest.h>
 #include <aws/iotjobs/DescribeJobExecutionResponse.h>
 #include <aws/iotjobs/DescribeJobExecutionSubscriptionRequest.h>
@@ -15,6 +18,8 @@
 #include <aws/iotjobs/JobExecutionsChangedSubscriptionRequest.h>
 #include <aws/iotjobs/NextJobExecutionChangedEvent.h>
 #include <aws/iotjobs/NextJobExecutionChangedSubscriptionRequest.h>
+#include <aws/iotjobs/PayloadDecoder.h>
+#include <aws/iotjobs/PayloadEncoder.h>
 #include <aws/iotjobs/RejectedError.h>
 #include <aws/iotjobs/StartNextJobExecutionResponse.h>
 #include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
@@ -28,34 +33,77 @@ namespace Aws
     namespace Iotjobs
     {
 
-        IotJobsClient::IotJobsClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection)
-            : m_connection(connection)
+#ifdef AWS_IOT_SDK_TRACING
+        static uint64_t s_startDispatchTrace()
+        {
+            return Aws::Iotdevicecommon::Tracing::IsEnabled() ? Aws::Iotdevicecommon::Tracing::NowNanoseconds() : 0;
+        }
+
+        static void s_markDispatchTrace(Aws::Iotservicecommon::DispatchPhase phase, uint64_t startNs)
+        {
+            Aws::Iotdevicecommon::Tracing::Record(
+                Aws::Iotdevicecommon::TraceSubsystem::Jobs,
+                phase == Aws::Iotservicecommon::DispatchPhase::HandlersFound
+                    ? Aws::Iotdevicecommon::TracePhase::ResponseReceived
+                    : Aws::Iotdevicecommon::TracePhase::HandlerDone,
+                Aws::Iotdevicecommon::Tracing::NowNanoseconds() - startNs);
+        }
+#endif
+
+        /* The registry is shared with the other service clients, which trace into their own subsystems. */
+        static Aws::Iotservicecommon::DispatchTraceHooks s_dispatchTraceHooks() noexcept
         {
+            Aws::Iotservicecommon::DispatchTraceHooks traceHooks;
+#ifdef AWS_IOT_SDK_TRACING
+            traceHooks.Start = s_startDispatchTrace;
+            traceHooks.Mark = s_markDispatchTrace;
+#endif
+            return traceHooks;
         }
 
-        IotJobsClient::IotJobsClient(const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client)
+        IotJobsClient::IotJobsClient(
+            const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+            Aws::Crt::Allocator *allocator)
+            : m_allocator(Aws::Iotservicecommon::CountingAllocator::Create(allocator)), m_connection(connection),
+              m_subscriptions(std::make_shared<SubscriptionRegistry>(connection, m_allocator, s_dispatchTraceHooks())),
+              m_publishBuffers(std::make_shared<PublishBufferPool>(m_allocator))
+        {
+        }
+
+        IotJobsClient::IotJobsClient(
+            const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client,
+            Aws::Crt::Allocator *allocator)
+            : m_allocator(Aws::Iotservicecommon::CountingAllocator::Create(allocator))
         {
             m_connection = Aws::Crt::Mqtt::MqttConnection::NewConnectionFromMqtt5Client(mqtt5Client);
+            m_subscriptions = std::make_shared<SubscriptionRegistry>(m_connection, m_allocator, s_dispatchTraceHooks());
+            m_publishBuffers = std::make_shared<PublishBufferPool>(m_allocator);
         }
 
         IotJobsClient::operator bool() const noexcept { return m_connection && *m_connection; }
 
         int IotJobsClient::GetLastError() const noexcept { return aws_last_error(); }
 
-        bool IotJobsClient::SubscribeToDescribeJobExecutionAccepted(
+        Aws::Crt::Allocator *IotJobsClient::GetAllocator() const noexcept { return m_allocator.get(); }
+
+        size_t IotJobsClient::GetAllocatedBytes() const noexcept
+        {
+            return Aws::Iotservicecommon::CountingAllocator::GetAllocatedBytes(m_allocator.get());
+        }
+
+        size_t IotJobsClient::GetAllocationCount() const noexcept
+        {
+            return Aws::Iotservicecommon::CountingAllocator::GetAllocationCount(m_allocator.get());
+        }
+
+        SubscriptionHandle IotJobsClient::SubscribeToDescribeJobExecutionAccepted(
             const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToDescribeJobExecutionAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -67,14 +115,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::DescribeJobExecutionResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::DescribeJobExecutionResponse response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -87,27 +132,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotJobsClient::SubscribeToDescribeJobExecutionRejected(
+        SubscriptionHandle IotJobsClient::SubscribeToDescribeJobExecutionRejected(
             const Aws::Iotjobs::DescribeJobExecutionSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToDescribeJobExecutionRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -119,14 +155,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::RejectedError response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::RejectedError response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -139,27 +172,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotJobsClient::SubscribeToGetPendingJobExecutionsAccepted(
+        SubscriptionHandle IotJobsClient::SubscribeToGetPendingJobExecutionsAccepted(
             const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToGetPendingJobExecutionsAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -171,14 +195,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::GetPendingJobExecutionsResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::GetPendingJobExecutionsResponse response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -191,27 +212,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotJobsClient::SubscribeToGetPendingJobExecutionsRejected(
+        SubscriptionHandle IotJobsClient::SubscribeToGetPendingJobExecutionsRejected(
             const Aws::Iotjobs::GetPendingJobExecutionsSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToGetPendingJobExecutionsRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -223,14 +235,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::RejectedError response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::RejectedError response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -243,27 +252,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotJobsClient::SubscribeToJobExecutionsChangedEvents(
+        SubscriptionHandle IotJobsClient::SubscribeToJobExecutionsChangedEvents(
             const Aws::Iotjobs::JobExecutionsChangedSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToJobExecutionsChangedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -275,14 +275,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::JobExecutionsChangedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::JobExecutionsChangedEvent response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -293,27 +290,18 @@ namespace Aws
                                << "/"
                                << "notify";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotJobsClient::SubscribeToNextJobExecutionChangedEvents(
+        SubscriptionHandle IotJobsClient::SubscribeToNextJobExecutionChangedEvents(
             const Aws::Iotjobs::NextJobExecutionChangedSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToNextJobExecutionChangedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -325,14 +313,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::NextJobExecutionChangedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::NextJobExecutionChangedEvent response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -343,27 +328,18 @@ namespace Aws
                                << "/"
                                << "notify-next";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotJobsClient::SubscribeToStartNextPendingJobExecutionAccepted(
+        SubscriptionHandle IotJobsClient::SubscribeToStartNextPendingJobExecutionAccepted(
             const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToStartNextPendingJobExecutionAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -375,14 +351,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::StartNextJobExecutionResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::StartNextJobExecutionResponse response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -395,27 +368,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotJobsClient::SubscribeToStartNextPendingJobExecutionRejected(
+        SubscriptionHandle IotJobsClient::SubscribeToStartNextPendingJobExecutionRejected(
             const Aws::Iotjobs::StartNextPendingJobExecutionSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToStartNextPendingJobExecutionRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -427,14 +391,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::RejectedError response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::RejectedError response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -447,27 +408,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotJobsClient::SubscribeToUpdateJobExecutionAccepted(
+        SubscriptionHandle IotJobsClient::SubscribeToUpdateJobExecutionAccepted(
             const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToUpdateJobExecutionAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -479,14 +431,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::UpdateJobExecutionResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::UpdateJobExecutionResponse response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -499,27 +448,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotJobsClient::SubscribeToUpdateJobExecutionRejected(
+        SubscriptionHandle IotJobsClient::SubscribeToUpdateJobExecutionRejected(
             const Aws::Iotjobs::UpdateJobExecutionSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToUpdateJobExecutionRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -531,14 +471,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotjobs::RejectedError response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotjobs::RejectedError response;
+                Aws::Iotjobs::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -551,11 +488,8 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
         bool IotJobsClient::PublishDescribeJobExecution(
@@ -563,6 +497,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Jobs);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -572,19 +507,30 @@ namespace Aws
                              << "/" << *request.JobId << "/"
                              << "get";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotjobs::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotJobsClient::PublishGetPendingJobExecutions(
@@ -592,6 +538,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Jobs);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -601,19 +548,30 @@ namespace Aws
                              << "/"
                              << "get";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotjobs::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotJobsClient::PublishStartNextPendingJobExecution(
@@ -621,6 +579,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Jobs);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -630,19 +589,30 @@ namespace Aws
                              << "/"
                              << "start-next";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotjobs::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotJobsClient::PublishUpdateJobExecution(
@@ -650,6 +620,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Jobs);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -659,19 +630,30 @@ namespace Aws
                              << "/" << *request.JobId << "/"
                              << "update";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotjobs::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
     } // namespace Iotjobs
@@ -0,0 +1,285 @@
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/JobExecutionUpdateQueue.h>
+
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/common/byte_buf.h>
+#include <aws/io/event_loop.h>
+
+#include <algorithm>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        struct JobExecutionUpdateQueue::DrainTask
+        {
+            struct aws_task task;
+            std::weak_ptr<JobExecutionUpdateQueue> queue;
+            Aws::Crt::Allocator *allocator;
+        };
+
+        /* A record is the thing name and the job id, each length-prefixed, followed by the payload. */
+        static bool s_encodeRecord(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::String &jobId,
+            const Aws::Crt::String &payload,
+            Aws::Crt::ByteBuf &record)
+        {
+            Aws::Crt::ByteCursor thingNameCursor = Aws::Crt::ByteCursorFromString(thingName);
+            Aws::Crt::ByteCursor jobIdCursor = Aws::Crt::ByteCursorFromString(jobId);
+            Aws::Crt::ByteCursor payloadCursor = Aws::Crt::ByteCursorFromString(payload);
+            return aws_byte_buf_write_be32(&record, static_cast<uint32_t>(thingNameCursor.len)) &&
+                   aws_byte_buf_write_from_whole_cursor(&record, thingNameCursor) &&
+                   aws_byte_buf_write_be32(&record, static_cast<uint32_t>(jobIdCursor.len)) &&
+                   aws_byte_buf_write_from_whole_cursor(&record, jobIdCursor) &&
+                   aws_byte_buf_write_from_whole_cursor(&record, payloadCursor);
+        }
+
+        static bool s_readString(Aws::Crt::ByteCursor &cursor, Aws::Crt::String &value)
+        {
+            uint32_t length = 0;
+            if (!aws_byte_cursor_read_be32(&cursor, &length) || length > cursor.len)
+            {
+                return false;
+            }
+            value.assign(reinterpret_cast<const char *>(cursor.ptr), length);
+            aws_byte_cursor_advance(&cursor, length);
+            return true;
+        }
+
+        JobExecutionUpdateQueue::JobExecutionUpdateQueue(
+            std::shared_ptr<IotJobsClient> client,
+            const JobExecutionUpdateQueueOptions &options,
+            Aws::Crt::Allocator *allocator) noexcept
+            : m_client(std::move(client)), m_options(options), m_allocator(allocator), m_eventLoop(nullptr),
+              m_publishInterval(std::chrono::nanoseconds(std::chrono::seconds(1)) /
+                                std::max<uint32_t>(options.MaxPublishesPerSecond, 1)),
+              m_resumed(false), m_drainScheduled(false), m_publishing(0)
+        {
+            Aws::Crt::Io::EventLoopGroup *eventLoopGroup = m_options.EventLoopGroup;
+            if (eventLoopGroup == nullptr)
+            {
+                eventLoopGroup = Aws::Crt::ApiHandle::GetOrCreateStaticDefaultEventLoopGroup();
+            }
+            m_eventLoop = aws_event_loop_group_get_next_loop(eventLoopGroup->GetUnderlyingHandle());
+        }
+
+        std::shared_ptr<JobExecutionUpdateQueue> JobExecutionUpdateQueue::CreateQueue(
+            std::shared_ptr<IotJobsClient> client,
+            const JobExecutionUpdateQueueOptions &options,
+            Aws::Crt::Allocator *allocator) noexcept
+        {
+            auto *toSeat =
+                static_cast<JobExecutionUpdateQueue *>(aws_mem_acquire(allocator, sizeof(JobExecutionUpdateQueue)));
+            if (toSeat == nullptr)
+            {
+                return nullptr;
+            }
+            toSeat = new (toSeat) JobExecutionUpdateQueue(std::move(client), options, allocator);
+            return std::shared_ptr<JobExecutionUpdateQueue>(
+                toSeat, [allocator](JobExecutionUpdateQueue *queue) { Aws::Crt::Delete(queue, allocator); });
+        }
+
+        JobExecutionUpdateQueue::~JobExecutionUpdateQueue() = default;
+
+        bool JobExecutionUpdateQueue::Open() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_log.IsOpen())
+            {
+                return true;
+            }
+            if (!m_log.Open(m_options.FilePath, m_options.MaxFileBytes, m_options.SyncEachWrite))
+            {
+                return false;
+            }
+
+            Aws::Crt::Vector<uint64_t> unreadable;
+            m_log.ForEach([this, &unreadable](uint64_t sequence, const Aws::Crt::ByteCursor &record) {
+                Aws::Crt::ByteCursor cursor = record;
+                PendingUpdate update;
+                if (!s_readString(cursor, update.thingName) || !s_readString(cursor, update.jobId))
+                {
+                    unreadable.push_back(sequence);
+                    return;
+                }
+                update.payload.assign(reinterpret_cast<const char *>(cursor.ptr), cursor.len);
+                m_pending[sequence] = std::move(update);
+            });
+            for (uint64_t sequence : unreadable)
+            {
+                m_log.MarkDone(sequence);
+            }
+
+            ScheduleDrainLocked();
+            return true;
+        }
+
+        bool JobExecutionUpdateQueue::Enqueue(const UpdateJobExecutionRequest &request) noexcept
+        {
+            if (!request.ThingName || !request.JobId)
+            {
+                return false;
+            }
+
+            PendingUpdate update;
+            update.thingName = *request.ThingName;
+            update.jobId = *request.JobId;
+            Aws::Crt::JsonObject payload;
+            request.SerializeToObject(payload);
+            update.payload = payload.View().WriteCompact(true);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_log.IsOpen())
+            {
+                return false;
+            }
+
+            Aws::Crt::ByteBuf record;
+            aws_byte_buf_init(
+                &record, m_allocator, update.thingName.size() + update.jobId.size() + update.payload.size() + 8);
+            uint64_t sequence = 0;
+            if (s_encodeRecord(update.thingName, update.jobId, update.payload, record))
+            {
+                sequence = m_log.Append(Aws::Crt::ByteCursorFromByteBuf(record));
+            }
+            aws_byte_buf_clean_up(&record);
+            if (sequence == 0)
+            {
+                return false;
+            }
+
+            m_pending[sequence] = std::move(update);
+            ScheduleDrainLocked();
+            return true;
+        }
+
+        void JobExecutionUpdateQueue::Resume() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_resumed = true;
+            ScheduleDrainLocked();
+        }
+
+        void JobExecutionUpdateQueue::Pause() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_resumed = false;
+        }
+
+        size_t JobExecutionUpdateQueue::GetPendingCount() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_pending.size();
+        }
+
+        void JobExecutionUpdateQueue::s_onDrainTask(struct aws_task *task, void *arg, enum aws_task_status status)
+        {
+            (void)task;
+            auto *drainTask = static_cast<DrainTask *>(arg);
+            std::shared_ptr<JobExecutionUpdateQueue> queue = drainTask->queue.lock();
+            Aws::Crt::Delete(drainTask, drainTask->allocator);
+            if (!queue)
+            {
+                return;
+            }
+            if (status != AWS_TASK_STATUS_RUN_READY)
+            {
+                std::lock_guard<std::mutex> lock(queue->m_mutex);
+                queue->m_drainScheduled = false;
+                return;
+            }
+            queue->Drain();
+        }
+
+        void JobExecutionUpdateQueue::Drain() noexcept
+        {
+            uint64_t sequence = 0;
+            PendingUpdate update;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_drainScheduled = false;
+                if (!m_resumed || m_publishing != 0 || m_pending.empty())
+                {
+                    return;
+                }
+                sequence = m_pending.begin()->first;
+                update = m_pending.begin()->second;
+                m_publishing = sequence;
+                m_lastPublish = std::chrono::steady_clock::now();
+            }
+
+            std::weak_ptr<JobExecutionUpdateQueue> weakSelf = shared_from_this();
+            auto onPublished = [weakSelf, sequence](int ioErr) {
+                std::shared_ptr<JobExecutionUpdateQueue> self = weakSelf.lock();
+                if (self)
+                {
+                    self->OnPublished(sequence, ioErr);
+                }
+            };
+
+            Aws::Crt::JsonObject payload(update.payload);
+            UpdateJobExecutionRequest request(payload.View());
+            request.ThingName = update.thingName;
+            request.JobId = update.jobId;
+            if (!m_client->PublishUpdateJobExecution(request, m_options.Qos, onPublished))
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_publishing = 0;
+                ScheduleDrainLocked();
+            }
+        }
+
+        void JobExecutionUpdateQueue::OnPublished(uint64_t sequence, int ioErr) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_publishing == sequence)
+            {
+                m_publishing = 0;
+            }
+
+            /* An update that failed to publish stays at the front of the queue, and is published again before any
+             * later one. */
+            if (ioErr == AWS_ERROR_SUCCESS)
+            {
+                m_log.MarkDone(sequence);
+                m_pending.erase(sequence);
+            }
+            ScheduleDrainLocked();
+        }
+
+        void JobExecutionUpdateQueue::ScheduleDrainLocked() noexcept
+        {
+            if (!m_resumed || m_drainScheduled || m_publishing != 0 || m_pending.empty())
+            {
+                return;
+            }
+
+            auto *drainTask = Aws::Crt::New<DrainTask>(m_allocator);
+            if (drainTask == nullptr)
+            {
+                return;
+            }
+            drainTask->queue = shared_from_this();
+            drainTask->allocator = m_allocator;
+            aws_task_init(&drainTask->task, s_onDrainTask, drainTask, "JobExecutionUpdateQueue");
+            m_drainScheduled = true;
+
+            /* Publishes are spaced by the publish interval, counted from the last one. */
+            auto sinceLastPublish = std::chrono::steady_clock::now() - m_lastPublish;
+            auto delay = std::max<std::chrono::nanoseconds>(
+                std::chrono::nanoseconds(0),
+                m_publishInterval - std::chrono::duration_cast<std::chrono::nanoseconds>(sinceLastPublish));
+            uint64_t runAt = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &runAt);
+            runAt += static_cast<uint64_t>(delay.count());
+            aws_event_loop_schedule_task_future(m_eventLoop, &drainTask->task, runAt);
+        }
+    } // namespace Iotjobs
+} // namespace Aws
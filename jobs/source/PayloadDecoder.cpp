@@ -0,0 +1,192 @@
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/PayloadDecoder.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        static bool s_readJobStatus(const JsonPayloadValue &value, Aws::Crt::Optional<JobStatus> &field)
+        {
+            Aws::Crt::String decoded;
+            if (!value.GetString(decoded))
+            {
+                return false;
+            }
+            field = JobStatusMarshaller::FromString(decoded);
+            return true;
+        }
+
+        static bool s_readStatusDetails(
+            const JsonPayloadValue &object,
+            Aws::Crt::Optional<Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>> &field)
+        {
+            Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> statusDetails;
+            JsonPayloadReader reader(object);
+            Aws::Crt::ByteCursor key;
+            JsonPayloadValue value;
+            while (reader.Next(key, value))
+            {
+                Aws::Crt::String detail;
+                if (!value.GetString(detail))
+                {
+                    return false;
+                }
+                /* As with JsonObject, a detail that appears more than once keeps its first value. */
+                statusDetails.emplace(
+                    Aws::Crt::String(reinterpret_cast<const char *>(key.ptr), key.len),
+                    std::move(detail));
+            }
+            if (reader.HasError())
+            {
+                return false;
+            }
+            field = std::move(statusDetails);
+            return true;
+        }
+
+        static bool s_readRejectedErrorCode(
+            const JsonPayloadValue &value,
+            Aws::Crt::Optional<RejectedErrorCode> &field)
+        {
+            Aws::Crt::String decoded;
+            if (!value.GetString(decoded))
+            {
+                return false;
+            }
+            field = RejectedErrorCodeMarshaller::FromString(decoded);
+            return true;
+        }
+    } // namespace Iotjobs
+
+    namespace Iotservicecommon
+    {
+        /*
+         * Each model names the fields its LoadFromObject reads. A value of the wrong type fails the decode so that
+         * JsonObject decides instead.
+         */
+
+        template <> struct PayloadModel<Iotjobs::JobExecutionData>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("jobId", &Iotjobs::JobExecutionData::JobId);
+                visitor.Field("thingName", &Iotjobs::JobExecutionData::ThingName);
+                visitor.Field("jobDocument", &Iotjobs::JobExecutionData::JobDocument);
+                visitor.Field("status", &Iotjobs::JobExecutionData::Status, Iotjobs::s_readJobStatus);
+                visitor.Field("statusDetails", &Iotjobs::JobExecutionData::StatusDetails, Iotjobs::s_readStatusDetails);
+                visitor.Field("queuedAt", &Iotjobs::JobExecutionData::QueuedAt);
+                visitor.Field("startedAt", &Iotjobs::JobExecutionData::StartedAt);
+                visitor.Field("lastUpdatedAt", &Iotjobs::JobExecutionData::LastUpdatedAt);
+                visitor.Field("versionNumber", &Iotjobs::JobExecutionData::VersionNumber);
+                visitor.Field("executionNumber", &Iotjobs::JobExecutionData::ExecutionNumber);
+            }
+        };
+
+        template <> struct PayloadModel<Iotjobs::JobExecutionState>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("status", &Iotjobs::JobExecutionState::Status, Iotjobs::s_readJobStatus);
+                visitor.Field(
+                    "statusDetails",
+                    &Iotjobs::JobExecutionState::StatusDetails,
+                    Iotjobs::s_readStatusDetails);
+                visitor.Field("versionNumber", &Iotjobs::JobExecutionState::VersionNumber);
+            }
+        };
+
+        template <> struct PayloadModel<Iotjobs::NextJobExecutionChangedEvent>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("execution", &Iotjobs::NextJobExecutionChangedEvent::Execution);
+                visitor.Field("timestamp", &Iotjobs::NextJobExecutionChangedEvent::Timestamp);
+            }
+        };
+
+        template <> struct PayloadModel<Iotjobs::StartNextJobExecutionResponse>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("clientToken", &Iotjobs::StartNextJobExecutionResponse::ClientToken);
+                visitor.Field("execution", &Iotjobs::StartNextJobExecutionResponse::Execution);
+                visitor.Field("timestamp", &Iotjobs::StartNextJobExecutionResponse::Timestamp);
+            }
+        };
+
+        template <> struct PayloadModel<Iotjobs::UpdateJobExecutionResponse>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("clientToken", &Iotjobs::UpdateJobExecutionResponse::ClientToken);
+                visitor.Field("executionState", &Iotjobs::UpdateJobExecutionResponse::ExecutionState);
+                visitor.Field("jobDocument", &Iotjobs::UpdateJobExecutionResponse::JobDocument);
+                visitor.Field("timestamp", &Iotjobs::UpdateJobExecutionResponse::Timestamp);
+            }
+        };
+
+        template <> struct PayloadModel<Iotjobs::RejectedError>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("clientToken", &Iotjobs::RejectedError::ClientToken);
+                visitor.Field("code", &Iotjobs::RejectedError::Code, Iotjobs::s_readRejectedErrorCode);
+                visitor.Field("message", &Iotjobs::RejectedError::Message);
+                visitor.Field("timestamp", &Iotjobs::RejectedError::Timestamp);
+                visitor.Field("executionState", &Iotjobs::RejectedError::ExecutionState);
+            }
+        };
+    } // namespace Iotservicecommon
+
+    namespace Iotjobs
+    {
+        template <typename Model>
+        static void s_decodePayload(const Aws::Crt::ByteCursor &payload, Model &model, PayloadDecoding decoding)
+        {
+            if (decoding == PayloadDecoding::OnDemand)
+            {
+                Model decoded;
+                if (Aws::Iotservicecommon::DecodePayloadModel(JsonPayloadValue(payload), decoded))
+                {
+                    model = std::move(decoded);
+                    return;
+                }
+            }
+
+            Aws::Crt::String objectStr(reinterpret_cast<const char *>(payload.ptr), payload.len);
+            Aws::Crt::JsonObject jsonObject(objectStr);
+            model = jsonObject.View();
+        }
+
+        void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            NextJobExecutionChangedEvent &model,
+            PayloadDecoding decoding)
+        {
+            s_decodePayload(payload, model, decoding);
+        }
+
+        void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            StartNextJobExecutionResponse &model,
+            PayloadDecoding decoding)
+        {
+            s_decodePayload(payload, model, decoding);
+        }
+
+        void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            UpdateJobExecutionResponse &model,
+            PayloadDecoding decoding)
+        {
+            s_decodePayload(payload, model, decoding);
+        }
+
+        void DecodePayload(const Aws::Crt::ByteCursor &payload, RejectedError &model, PayloadDecoding decoding)
+        {
+            s_decodePayload(payload, model, decoding);
+        }
+    } // namespace Iotjobs
+} // namespace Aws
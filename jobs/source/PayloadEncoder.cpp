@@ -0,0 +1,94 @@
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotjobs/PayloadEncoder.h>
+
+namespace Aws
+{
+    namespace Iotjobs
+    {
+        bool EncodePayload(const DescribeJobExecutionRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            JsonPayloadWriter writer(payload);
+            if (request.ClientToken)
+            {
+                writer.WithString("clientToken", *request.ClientToken);
+            }
+            if (request.ExecutionNumber)
+            {
+                writer.WithInt64("executionNumber", *request.ExecutionNumber);
+            }
+            if (request.IncludeJobDocument)
+            {
+                writer.WithBool("includeJobDocument", *request.IncludeJobDocument);
+            }
+            return writer.Finish();
+        }
+
+        bool EncodePayload(const GetPendingJobExecutionsRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            JsonPayloadWriter writer(payload);
+            if (request.ClientToken)
+            {
+                writer.WithString("clientToken", *request.ClientToken);
+            }
+            return writer.Finish();
+        }
+
+        bool EncodePayload(const StartNextPendingJobExecutionRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            JsonPayloadWriter writer(payload);
+            if (request.ClientToken)
+            {
+                writer.WithString("clientToken", *request.ClientToken);
+            }
+            if (request.StepTimeoutInMinutes)
+            {
+                writer.WithInt64("stepTimeoutInMinutes", *request.StepTimeoutInMinutes);
+            }
+            if (request.StatusDetails)
+            {
+                writer.WithStringMap("statusDetails", *request.StatusDetails);
+            }
+            return writer.Finish();
+        }
+
+        bool EncodePayload(const UpdateJobExecutionRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            JsonPayloadWriter writer(payload);
+            if (request.Status)
+            {
+                writer.WithString("status", JobStatusMarshaller::ToString(*request.Status));
+            }
+            if (request.ClientToken)
+            {
+                writer.WithString("clientToken", *request.ClientToken);
+            }
+            if (request.StatusDetails)
+            {
+                writer.WithStringMap("statusDetails", *request.StatusDetails);
+            }
+            if (request.ExpectedVersion)
+            {
+                writer.WithInt64("expectedVersion", *request.ExpectedVersion);
+            }
+            if (request.ExecutionNumber)
+            {
+                writer.WithInt64("executionNumber", *request.ExecutionNumber);
+            }
+            if (request.IncludeJobExecutionState)
+            {
+                writer.WithBool("includeJobExecutionState", *request.IncludeJobExecutionState);
+            }
+            if (request.IncludeJobDocument)
+            {
+                writer.WithBool("includeJobDocument", *request.IncludeJobDocument);
+            }
+            if (request.StepTimeoutInMinutes)
+            {
+                writer.WithInt64("stepTimeoutInMinutes", *request.StepTimeoutInMinutes);
+            }
+            return writer.Finish();
+        }
+    } // namespace Iotjobs
+} // namespace Aws
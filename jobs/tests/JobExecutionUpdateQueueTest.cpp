@@ -0,0 +1,173 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/iotjobs/JobExecutionUpdateQueue.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+
+#include "LocalMqttBroker.h"
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotjobs;
+
+struct JobExecutionUpdateQueueTestContext
+{
+    std::unique_ptr<ApiHandle> apiHandle;
+    std::unique_ptr<Io::EventLoopGroup> elGroup;
+    std::unique_ptr<Io::HostResolver> resolver;
+    std::unique_ptr<Io::ClientBootstrap> clientBootstrap;
+};
+
+static JobExecutionUpdateQueueTestContext s_testContext;
+
+static int s_testSetup(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<JobExecutionUpdateQueueTestContext *>(ctx);
+
+    testContext->apiHandle = std::unique_ptr<ApiHandle>(new ApiHandle(allocator));
+    testContext->elGroup = std::unique_ptr<Io::EventLoopGroup>(new Io::EventLoopGroup(0, allocator));
+    testContext->resolver =
+        std::unique_ptr<Io::HostResolver>(new Io::DefaultHostResolver(*testContext->elGroup, 8, 30, allocator));
+    testContext->clientBootstrap = std::unique_ptr<Io::ClientBootstrap>(
+        new Io::ClientBootstrap(*testContext->elGroup, *testContext->resolver, allocator));
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static int s_testTeardown(struct aws_allocator *allocator, int setup_result, void *ctx)
+{
+    auto *testContext = static_cast<JobExecutionUpdateQueueTestContext *>(ctx);
+
+    testContext->elGroup.reset();
+    testContext->resolver.reset();
+    testContext->clientBootstrap.reset();
+    /* The ApiHandle must be deallocated last or a deadlock occurs. */
+    testContext->apiHandle.reset();
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static const std::chrono::milliseconds s_waitTimeout(10000);
+
+static bool s_waitFor(const std::function<bool()> &condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + s_waitTimeout;
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static UpdateJobExecutionRequest s_update(const char *jobId, JobStatus status, const char *step)
+{
+    UpdateJobExecutionRequest request;
+    request.ThingName = "thing-1";
+    request.JobId = jobId;
+    request.Status = status;
+    Map<String, String> statusDetails;
+    statusDetails["step"] = step;
+    request.StatusDetails = statusDetails;
+    return request;
+}
+
+static String s_stepOf(const Utils::LocalMqttBroker::RecordedPublish &publish)
+{
+    JsonObject payload(publish.payload);
+    return payload.View().GetJsonObject("statusDetails").GetString("step");
+}
+
+static int s_TestJobExecutionUpdateQueueOrder(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<JobExecutionUpdateQueueTestContext *>(ctx);
+    const char *path = "JobExecutionUpdateQueueOrder.log";
+    remove(path);
+
+    JobExecutionUpdateQueueOptions options;
+    options.FilePath = path;
+    options.SyncEachWrite = false;
+    options.MaxPublishesPerSecond = 5;
+    options.EventLoopGroup = testContext->elGroup.get();
+
+    Utils::LocalMqttBroker broker(*testContext->elGroup, allocator);
+    ASSERT_TRUE(broker.Start());
+    broker.RecordPublishes("$aws/#");
+    {
+        Mqtt::MqttClient mqttClient(*testContext->clientBootstrap, allocator);
+        auto connection = broker.Connect(mqttClient, "job-execution-update-queue-test");
+        ASSERT_NOT_NULL(connection.get());
+        {
+            auto client = std::make_shared<IotJobsClient>(connection, allocator);
+
+            /* Updates queued by a queue that goes away are taken back by the next one on the same file. */
+            {
+                auto queue = JobExecutionUpdateQueue::CreateQueue(client, options, allocator);
+                ASSERT_TRUE(queue->Open());
+                ASSERT_TRUE(queue->Enqueue(s_update("job-1", JobStatus::IN_PROGRESS, "1")));
+                ASSERT_TRUE(queue->Enqueue(s_update("job-1", JobStatus::IN_PROGRESS, "2")));
+            }
+
+            auto queue = JobExecutionUpdateQueue::CreateQueue(client, options, allocator);
+            ASSERT_TRUE(queue->Open());
+            ASSERT_UINT_EQUALS(2, queue->GetPendingCount());
+            ASSERT_TRUE(queue->Enqueue(s_update("job-2", JobStatus::IN_PROGRESS, "3")));
+            ASSERT_TRUE(queue->Enqueue(s_update("job-1", JobStatus::SUCCEEDED, "4")));
+
+            /* Updates to the same execution are never merged. */
+            ASSERT_UINT_EQUALS(4, queue->GetPendingCount());
+
+            queue->Resume();
+            ASSERT_TRUE(broker.WaitForRecordedPublishes(4, s_waitTimeout));
+            ASSERT_TRUE(s_waitFor([&queue]() { return queue->GetPendingCount() == 0; }));
+
+            /* They are published in the order they were queued, at most five a second. */
+            Vector<Utils::LocalMqttBroker::RecordedPublish> publishes = broker.GetRecordedPublishes();
+            ASSERT_UINT_EQUALS(4, publishes.size());
+            const char *expectedTopics[] = {
+                "$aws/things/thing-1/jobs/job-1/update",
+                "$aws/things/thing-1/jobs/job-1/update",
+                "$aws/things/thing-1/jobs/job-2/update",
+                "$aws/things/thing-1/jobs/job-1/update",
+            };
+            for (size_t i = 0; i < publishes.size(); ++i)
+            {
+                ASSERT_TRUE(publishes[i].topic == expectedTopics[i]);
+                ASSERT_TRUE(s_stepOf(publishes[i]) == std::to_string(i + 1).c_str());
+                if (i > 0)
+                {
+                    /* Allow for the broker seeing publishes a little closer together than they were sent. */
+                    auto gap = publishes[i].receivedAt - publishes[i - 1].receivedAt;
+                    ASSERT_TRUE(gap >= std::chrono::milliseconds(150));
+                }
+            }
+            JsonObject last(publishes[3].payload);
+            ASSERT_TRUE(last.View().GetString("status") == "SUCCEEDED");
+        }
+        Utils::LocalMqttBroker::Disconnect(*connection);
+    }
+    broker.Stop();
+
+    remove(path);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    JobExecutionUpdateQueueOrder,
+    s_testSetup,
+    s_TestJobExecutionUpdateQueueOrder,
+    s_testTeardown,
+    &s_testContext);
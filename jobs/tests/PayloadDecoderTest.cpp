@@ -0,0 +1,66 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotjobs/PayloadDecoder.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotjobs;
+
+template <typename T>
+static bool s_optionalEquals(const Optional<T> &left, const Optional<T> &right)
+{
+    return left.has_value() == right.has_value() && (!left.has_value() || left.value() == right.value());
+}
+
+static int s_TestJobsPayloadDecoding(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        const char *payload = "{\"execution\":{\"jobId\":\"job-1\",\"status\":\"IN_PROGRESS\","
+                              "\"statusDetails\":{\"step\":\"2\",\"note\":\"a\\\"b\"},\"queuedAt\":1623456789,"
+                              "\"versionNumber\":3,\"executionNumber\":8589934592,\"jobDocument\":{\"x\":[1]}},"
+                              "\"timestamp\":1623456790}";
+        NextJobExecutionChangedEvent event;
+        DecodePayload(ByteCursorFromCString(payload), event);
+        ASSERT_TRUE(event.Execution.has_value());
+        const JobExecutionData &execution = event.Execution.value();
+        ASSERT_TRUE(execution.JobId.value() == "job-1");
+        ASSERT_INT_EQUALS((int)JobStatus::IN_PROGRESS, (int)execution.Status.value());
+        ASSERT_UINT_EQUALS(2, execution.StatusDetails.value().size());
+        ASSERT_TRUE(execution.StatusDetails.value().at("note") == "a\"b");
+        ASSERT_TRUE(execution.QueuedAt.value().SecondsWithMSPrecision() == 1623456789.0);
+        ASSERT_INT_EQUALS(3, execution.VersionNumber.value());
+        ASSERT_TRUE(execution.ExecutionNumber.value() == 8589934592LL);
+        ASSERT_TRUE(execution.JobDocument.has_value());
+        ASSERT_TRUE(event.Timestamp.value().SecondsWithMSPrecision() == 1623456790.0);
+
+        /* A status detail that is not a string, or a version that is not an integer, falls back to JsonObject. */
+        const char *fallbacks[] = {
+            "{\"execution\":{\"jobId\":\"job-1\",\"statusDetails\":{\"step\":2},\"versionNumber\":3}}",
+            "{\"execution\":{\"jobId\":\"job-1\",\"statusDetails\":{\"step\":\"2\"},\"versionNumber\":3.0}}",
+        };
+        for (const char *fallback : fallbacks)
+        {
+            NextJobExecutionChangedEvent onDemand;
+            NextJobExecutionChangedEvent jsonObject;
+            DecodePayload(ByteCursorFromCString(fallback), onDemand, PayloadDecoding::OnDemand);
+            DecodePayload(ByteCursorFromCString(fallback), jsonObject, PayloadDecoding::JsonObject);
+            const JobExecutionData &left = onDemand.Execution.value();
+            const JobExecutionData &right = jsonObject.Execution.value();
+            ASSERT_TRUE(s_optionalEquals(left.JobId, right.JobId));
+            ASSERT_TRUE(s_optionalEquals(left.VersionNumber, right.VersionNumber));
+            ASSERT_TRUE(s_optionalEquals(left.StatusDetails, right.StatusDetails));
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(JobsPayloadDecoding, s_TestJobsPayloadDecoding)
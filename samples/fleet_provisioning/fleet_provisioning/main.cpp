@@ -9,17 +9,8 @@
 
 #include <aws/iot/MqttClient.h>
 
-#include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
-#include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
-#include <aws/iotidentity/CreateCertificateFromCsrSubscriptionRequest.h>
-#include <aws/iotidentity/CreateKeysAndCertificateRequest.h>
-#include <aws/iotidentity/CreateKeysAndCertificateResponse.h>
-#include <aws/iotidentity/CreateKeysAndCertificateSubscriptionRequest.h>
-#include <aws/iotidentity/ErrorResponse.h>
 #include <aws/iotidentity/IotIdentityClient.h>
-#include <aws/iotidentity/RegisterThingRequest.h>
-#include <aws/iotidentity/RegisterThingResponse.h>
-#include <aws/iotidentity/RegisterThingSubscriptionRequest.h>
+#include <aws/iotidentity/ProvisioningFlow.h>
 
 #include <algorithm>
 #include <chrono>
@@ -36,14 +27,6 @@
 
 using namespace Aws::Crt;
 using namespace Aws::Iotidentity;
-using namespace std::this_thread; // sleep_for, sleep_until
-using namespace std::chrono;      // nanoseconds, system_clock, seconds
-
-static void sleep(int sleeptime)
-{
-    std::cout << "Sleeping for " << sleeptime << " seconds..." << std::endl;
-    sleep_until(system_clock::now() + seconds(sleeptime));
-}
 
 static std::string getFileData(std::string const &fileName)
 {
@@ -61,8 +44,6 @@ int main(int argc, char *argv[])
     ApiHandle apiHandle;
     // Variables for the sample
     String csrFile;
-    String token;
-    RegisterThingResponse registerThingResponse;
 
     /**
      * cmdData is the arguments/input from the command line placed into a single struct for
@@ -150,317 +131,76 @@ int main(int argc, char *argv[])
     if (connectionCompletedPromise.get_future().get())
     {
         IotIdentityClient identityClient(connection);
+        ProvisioningFlow provisioningFlow(identityClient, AWS_MQTT_QOS_AT_LEAST_ONCE);
 
-        std::promise<void> csrPublishCompletedPromise;
-        std::promise<void> csrAcceptedCompletedPromise;
-        std::promise<void> csrRejectedCompletedPromise;
-
-        std::promise<void> keysPublishCompletedPromise;
-        std::promise<void> keysAcceptedCompletedPromise;
-        std::promise<void> keysRejectedCompletedPromise;
-
-        std::promise<void> registerPublishCompletedPromise;
-        std::promise<void> registerAcceptedCompletedPromise;
-        std::promise<void> registerRejectedCompletedPromise;
-
-        auto onCsrPublishSubAck = [&](int ioErr) {
-            if (ioErr != AWS_OP_SUCCESS)
-            {
-                fprintf(stderr, "Error publishing to CreateCertificateFromCsr: %s\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-
-            csrPublishCompletedPromise.set_value();
-        };
-
-        auto onCsrAcceptedSubAck = [&](int ioErr) {
-            if (ioErr != AWS_OP_SUCCESS)
-            {
-                fprintf(
-                    stderr, "Error subscribing to CreateCertificateFromCsr accepted: %s\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-
-            csrAcceptedCompletedPromise.set_value();
-        };
-
-        auto onCsrRejectedSubAck = [&](int ioErr) {
-            if (ioErr != AWS_OP_SUCCESS)
-            {
-                fprintf(
-                    stderr, "Error subscribing to CreateCertificateFromCsr rejected: %s\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-            csrRejectedCompletedPromise.set_value();
-        };
-
-        auto onCsrAccepted = [&](CreateCertificateFromCsrResponse *response, int ioErr) {
-            if (ioErr == AWS_OP_SUCCESS)
-            {
-                fprintf(
-                    stdout, "CreateCertificateFromCsrResponse certificateId: %s.\n", response->CertificateId->c_str());
-                token = *response->CertificateOwnershipToken;
-            }
-            else
-            {
-                fprintf(stderr, "Error on subscription: %s.\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-        };
-
-        auto onCsrRejected = [&](ErrorResponse *error, int ioErr) {
-            if (ioErr == AWS_OP_SUCCESS)
-            {
-                fprintf(
-                    stdout,
-                    "CreateCertificateFromCsr failed with statusCode %d, errorMessage %s and errorCode %s.",
-                    *error->StatusCode,
-                    error->ErrorMessage->c_str(),
-                    error->ErrorCode->c_str());
-                exit(-1);
-            }
-            else
-            {
-                fprintf(stderr, "Error on subscription: %s.\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-        };
-
-        auto onKeysPublishSubAck = [&](int ioErr) {
-            if (ioErr != AWS_OP_SUCCESS)
-            {
-                fprintf(stderr, "Error publishing to CreateKeysAndCertificate: %s\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-
-            keysPublishCompletedPromise.set_value();
-        };
-
-        auto onKeysAcceptedSubAck = [&](int ioErr) {
-            if (ioErr != AWS_OP_SUCCESS)
-            {
-                fprintf(
-                    stderr, "Error subscribing to CreateKeysAndCertificate accepted: %s\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
+        const Aws::Crt::String jsonValue = cmdData.input_templateParameters;
+        Aws::Crt::JsonObject value(jsonValue);
+        Map<String, JsonView> pm = value.View().GetAllObjects();
+        Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> params =
+            Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
 
-            keysAcceptedCompletedPromise.set_value();
-        };
-
-        auto onKeysRejectedSubAck = [&](int ioErr) {
-            if (ioErr != AWS_OP_SUCCESS)
-            {
-                fprintf(
-                    stderr, "Error subscribing to CreateKeysAndCertificate rejected: %s\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-            keysRejectedCompletedPromise.set_value();
-        };
-
-        auto onKeysAccepted = [&](CreateKeysAndCertificateResponse *response, int ioErr) {
-            if (ioErr == AWS_OP_SUCCESS)
-            {
-                fprintf(
-                    stdout, "CreateKeysAndCertificateResponse certificateId: %s.\n", response->CertificateId->c_str());
-                token = *response->CertificateOwnershipToken;
-            }
-            else
-            {
-                fprintf(stderr, "Error on subscription: %s.\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-        };
-
-        auto onKeysRejected = [&](ErrorResponse *error, int ioErr) {
-            if (ioErr == AWS_OP_SUCCESS)
-            {
-                fprintf(
-                    stdout,
-                    "CreateKeysAndCertificate failed with statusCode %d, errorMessage %s and errorCode %s.",
-                    *error->StatusCode,
-                    error->ErrorMessage->c_str(),
-                    error->ErrorCode->c_str());
-                exit(-1);
-            }
-            else
-            {
-                fprintf(stderr, "Error on subscription: %s.\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-        };
-
-        auto onRegisterAcceptedSubAck = [&](int ioErr) {
-            if (ioErr != AWS_OP_SUCCESS)
-            {
-                fprintf(stderr, "Error subscribing to RegisterThing accepted: %s\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-
-            registerAcceptedCompletedPromise.set_value();
-        };
-
-        auto onRegisterRejectedSubAck = [&](int ioErr) {
-            if (ioErr != AWS_OP_SUCCESS)
-            {
-                fprintf(stderr, "Error subscribing to RegisterThing rejected: %s\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-            registerRejectedCompletedPromise.set_value();
-        };
-
-        auto onRegisterAccepted = [&](RegisterThingResponse *response, int ioErr) {
-            if (ioErr == AWS_OP_SUCCESS)
-            {
-                fprintf(stdout, "RegisterThingResponse ThingName: %s.\n", response->ThingName->c_str());
-            }
-            else
-            {
-                fprintf(stderr, "Error on subscription: %s.\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-        };
-
-        auto onRegisterRejected = [&](ErrorResponse *error, int ioErr) {
-            if (ioErr == AWS_OP_SUCCESS)
-            {
-                fprintf(
-                    stdout,
-                    "RegisterThing failed with statusCode %d, errorMessage %s and errorCode %s.",
-                    *error->StatusCode,
-                    error->ErrorMessage->c_str(),
-                    error->ErrorCode->c_str());
-            }
-            else
-            {
-                fprintf(stderr, "Error on subscription: %s.\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-        };
-
-        auto onRegisterPublishSubAck = [&](int ioErr) {
-            if (ioErr != AWS_OP_SUCCESS)
-            {
-                fprintf(stderr, "Error publishing to RegisterThing: %s\n", ErrorDebugString(ioErr));
-                exit(-1);
-            }
-
-            registerPublishCompletedPromise.set_value();
-        };
+        for (const auto &x : pm)
+        {
+            params.emplace(x.first, x.second.AsString());
+        }
 
+        /*
+         * The flow subscribes to every response topic at once, publishes the certificate request once they are all
+         * acknowledged, and registers the thing as soon as the certificate is accepted.
+         */
+        std::future<ProvisioningOutcome> outcomeFuture;
         if (csrFile.empty())
         {
-            // CreateKeysAndCertificate workflow
-            std::cout << "Subscribing to CreateKeysAndCertificate Accepted and Rejected topics" << std::endl;
-            CreateKeysAndCertificateSubscriptionRequest keySubscriptionRequest;
-            identityClient.SubscribeToCreateKeysAndCertificateAccepted(
-                keySubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onKeysAccepted, onKeysAcceptedSubAck);
-
-            identityClient.SubscribeToCreateKeysAndCertificateRejected(
-                keySubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onKeysRejected, onKeysRejectedSubAck);
-
-            std::cout << "Publishing to CreateKeysAndCertificate topic" << std::endl;
-            CreateKeysAndCertificateRequest createKeysAndCertificateRequest;
-            identityClient.PublishCreateKeysAndCertificate(
-                createKeysAndCertificateRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onKeysPublishSubAck);
-
-            std::cout << "Subscribing to RegisterThing Accepted and Rejected topics" << std::endl;
-            RegisterThingSubscriptionRequest registerSubscriptionRequest;
-            registerSubscriptionRequest.TemplateName = cmdData.input_templateName;
-
-            identityClient.SubscribeToRegisterThingAccepted(
-                registerSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterAccepted, onRegisterAcceptedSubAck);
-
-            identityClient.SubscribeToRegisterThingRejected(
-                registerSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterRejected, onRegisterRejectedSubAck);
-
-            sleep(1);
-
-            std::cout << "Publishing to RegisterThing topic" << std::endl;
-            RegisterThingRequest registerThingRequest;
-            registerThingRequest.TemplateName = cmdData.input_templateName;
-
-            const Aws::Crt::String jsonValue = cmdData.input_templateParameters;
-            Aws::Crt::JsonObject value(jsonValue);
-            Map<String, JsonView> pm = value.View().GetAllObjects();
-            Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> params =
-                Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
-
-            for (const auto &x : pm)
-            {
-                params.emplace(x.first, x.second.AsString());
-            }
-
-            registerThingRequest.Parameters = params;
-            registerThingRequest.CertificateOwnershipToken = token;
-
-            identityClient.PublishRegisterThing(
-                registerThingRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterPublishSubAck);
-            sleep(1);
-
-            keysPublishCompletedPromise.get_future().wait();
-            keysAcceptedCompletedPromise.get_future().wait();
-            keysRejectedCompletedPromise.get_future().wait();
-            registerPublishCompletedPromise.get_future().wait();
-            registerAcceptedCompletedPromise.get_future().wait();
-            registerRejectedCompletedPromise.get_future().wait();
+            std::cout << "Provisioning with CreateKeysAndCertificate" << std::endl;
+            outcomeFuture = provisioningFlow.ProvisionWithNewKeys(cmdData.input_templateName, params);
         }
         else
         {
-            // CreateCertificateFromCsr workflow
-            std::cout << "Subscribing to CreateCertificateFromCsr Accepted and Rejected topics" << std::endl;
-            CreateCertificateFromCsrSubscriptionRequest csrSubscriptionRequest;
-            identityClient.SubscribeToCreateCertificateFromCsrAccepted(
-                csrSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onCsrAccepted, onCsrAcceptedSubAck);
-
-            identityClient.SubscribeToCreateCertificateFromCsrRejected(
-                csrSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onCsrRejected, onCsrRejectedSubAck);
-
-            std::cout << "Publishing to CreateCertificateFromCsr topic" << std::endl;
-            CreateCertificateFromCsrRequest createCertificateFromCsrRequest;
-            createCertificateFromCsrRequest.CertificateSigningRequest = csrFile;
-            identityClient.PublishCreateCertificateFromCsr(
-                createCertificateFromCsrRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onCsrPublishSubAck);
-
-            std::cout << "Subscribing to RegisterThing Accepted and Rejected topics" << std::endl;
-            RegisterThingSubscriptionRequest registerSubscriptionRequest;
-            registerSubscriptionRequest.TemplateName = cmdData.input_templateName;
-
-            identityClient.SubscribeToRegisterThingAccepted(
-                registerSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterAccepted, onRegisterAcceptedSubAck);
-
-            identityClient.SubscribeToRegisterThingRejected(
-                registerSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterRejected, onRegisterRejectedSubAck);
-
-            sleep(2);
-
-            std::cout << "Publishing to RegisterThing topic" << std::endl;
-            RegisterThingRequest registerThingRequest;
-            registerThingRequest.TemplateName = cmdData.input_templateName;
-
-            const Aws::Crt::String jsonValue = cmdData.input_templateParameters;
-            Aws::Crt::JsonObject value(jsonValue);
-            Map<String, JsonView> pm = value.View().GetAllObjects();
-            Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> params =
-                Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
-
-            for (const auto &x : pm)
-            {
-                params.emplace(x.first, x.second.AsString());
-            }
-
-            registerThingRequest.Parameters = params;
-            registerThingRequest.CertificateOwnershipToken = token;
+            std::cout << "Provisioning with CreateCertificateFromCsr" << std::endl;
+            outcomeFuture = provisioningFlow.ProvisionWithCsr(csrFile, cmdData.input_templateName, params);
+        }
+        ProvisioningOutcome outcome = outcomeFuture.get();
 
-            identityClient.PublishRegisterThing(
-                registerThingRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterPublishSubAck);
-            sleep(2);
+        if (outcome.keysAndCertificate.has_value())
+        {
+            fprintf(
+                stdout,
+                "CreateKeysAndCertificateResponse certificateId: %s.\n",
+                outcome.keysAndCertificate->CertificateId->c_str());
+        }
+        if (outcome.certificateFromCsr.has_value())
+        {
+            fprintf(
+                stdout,
+                "CreateCertificateFromCsrResponse certificateId: %s.\n",
+                outcome.certificateFromCsr->CertificateId->c_str());
+        }
 
-            csrPublishCompletedPromise.get_future().wait();
-            csrAcceptedCompletedPromise.get_future().wait();
-            csrRejectedCompletedPromise.get_future().wait();
-            registerPublishCompletedPromise.get_future().wait();
-            registerAcceptedCompletedPromise.get_future().wait();
-            registerRejectedCompletedPromise.get_future().wait();
+        if (outcome.Succeeded())
+        {
+            fprintf(stdout, "RegisterThingResponse ThingName: %s.\n", outcome.registeredThing->ThingName->c_str());
+            fprintf(
+                stdout,
+                "Provisioned in %lld ms (subscribe %lld ms, create certificate %lld ms, register thing %lld ms).\n",
+                static_cast<long long>(outcome.timings.total.count()),
+                static_cast<long long>(outcome.timings.subscribe.count()),
+                static_cast<long long>(outcome.timings.createCertificate.count()),
+                static_cast<long long>(outcome.timings.registerThing.count()));
+        }
+        else if (outcome.rejection.has_value())
+        {
+            fprintf(
+                stdout,
+                "Provisioning failed with statusCode %d, errorMessage %s and errorCode %s.\n",
+                *outcome.rejection->StatusCode,
+                outcome.rejection->ErrorMessage->c_str(),
+                outcome.rejection->ErrorCode->c_str());
+            exit(-1);
+        }
+        else
+        {
+            fprintf(stderr, "Provisioning failed with error: %s.\n", ErrorDebugString(outcome.errorCode));
+            exit(-1);
         }
     }
 
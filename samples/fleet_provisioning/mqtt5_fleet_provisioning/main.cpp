@@ -346,10 +346,10 @@ int main(int argc, char *argv[])
             // CreateKeysAndCertificate workflow
             std::cout << "Subscribing to CreateKeysAndCertificate Accepted and Rejected topics" << std::endl;
             CreateKeysAndCertificateSubscriptionRequest keySubscriptionRequest;
-            identityClient.SubscribeToCreateKeysAndCertificateAccepted(
+            ScopedSubscription keysAccepted = identityClient.SubscribeToCreateKeysAndCertificateAccepted(
                 keySubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onKeysAccepted, onKeysAcceptedSubAck);
 
-            identityClient.SubscribeToCreateKeysAndCertificateRejected(
+            ScopedSubscription keysRejected = identityClient.SubscribeToCreateKeysAndCertificateRejected(
                 keySubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onKeysRejected, onKeysRejectedSubAck);
 
             std::cout << "Publishing to CreateKeysAndCertificate topic" << std::endl;
@@ -361,10 +361,10 @@ int main(int argc, char *argv[])
             RegisterThingSubscriptionRequest registerSubscriptionRequest;
             registerSubscriptionRequest.TemplateName = cmdData.input_templateName;
 
-            identityClient.SubscribeToRegisterThingAccepted(
+            ScopedSubscription registerAccepted = identityClient.SubscribeToRegisterThingAccepted(
                 registerSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterAccepted, onRegisterAcceptedSubAck);
 
-            identityClient.SubscribeToRegisterThingRejected(
+            ScopedSubscription registerRejected = identityClient.SubscribeToRegisterThingRejected(
                 registerSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterRejected, onRegisterRejectedSubAck);
 
             sleep(1);
@@ -403,10 +403,10 @@ int main(int argc, char *argv[])
             // CreateCertificateFromCsr workflow
             std::cout << "Subscribing to CreateCertificateFromCsr Accepted and Rejected topics" << std::endl;
             CreateCertificateFromCsrSubscriptionRequest csrSubscriptionRequest;
-            identityClient.SubscribeToCreateCertificateFromCsrAccepted(
+            ScopedSubscription csrAccepted = identityClient.SubscribeToCreateCertificateFromCsrAccepted(
                 csrSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onCsrAccepted, onCsrAcceptedSubAck);
 
-            identityClient.SubscribeToCreateCertificateFromCsrRejected(
+            ScopedSubscription csrRejected = identityClient.SubscribeToCreateCertificateFromCsrRejected(
                 csrSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onCsrRejected, onCsrRejectedSubAck);
 
             std::cout << "Publishing to CreateCertificateFromCsr topic" << std::endl;
@@ -419,10 +419,10 @@ int main(int argc, char *argv[])
             RegisterThingSubscriptionRequest registerSubscriptionRequest;
             registerSubscriptionRequest.TemplateName = cmdData.input_templateName;
 
-            identityClient.SubscribeToRegisterThingAccepted(
+            ScopedSubscription registerAccepted = identityClient.SubscribeToRegisterThingAccepted(
                 registerSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterAccepted, onRegisterAcceptedSubAck);
 
-            identityClient.SubscribeToRegisterThingRejected(
+            ScopedSubscription registerRejected = identityClient.SubscribeToRegisterThingRejected(
                 registerSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterRejected, onRegisterRejectedSubAck);
 
             sleep(2);
@@ -160,7 +160,9 @@ int main(int argc, char *argv[])
             }
         };
 
-        jobsClient.SubscribeToDescribeJobExecutionAccepted(
+        /* Subscriptions are released when their ScopedSubscription goes out of scope, along with the locals their
+         * handlers capture. */
+        ScopedSubscription describeAccepted = jobsClient.SubscribeToDescribeJobExecutionAccepted(
             describeJobExecutionSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, subscriptionHandler, subAckHandler);
         subAckedPromise.get_future().wait();
 
@@ -183,7 +185,7 @@ int main(int argc, char *argv[])
             }
         };
 
-        jobsClient.SubscribeToDescribeJobExecutionRejected(
+        ScopedSubscription describeRejected = jobsClient.SubscribeToDescribeJobExecutionRejected(
             describeJobExecutionSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
         subAckedPromise.get_future().wait();
 
@@ -249,7 +251,7 @@ int main(int argc, char *argv[])
                 StartNextPendingJobExecutionSubscriptionRequest subscriptionRequest;
                 subscriptionRequest.ThingName = cmdData.input_thingName;
                 subAckedPromise = std::promise<void>();
-                jobsClient.SubscribeToStartNextPendingJobExecutionAccepted(
+                ScopedSubscription startNextAccepted = jobsClient.SubscribeToStartNextPendingJobExecutionAccepted(
                     subscriptionRequest,
                     AWS_MQTT_QOS_AT_LEAST_ONCE,
                     OnSubscribeToStartNextPendingJobExecutionAcceptedResponse,
@@ -258,7 +260,7 @@ int main(int argc, char *argv[])
                 subAckedPromise.get_future().wait();
 
                 subAckedPromise = std::promise<void>();
-                jobsClient.SubscribeToStartNextPendingJobExecutionRejected(
+                ScopedSubscription startNextRejected = jobsClient.SubscribeToStartNextPendingJobExecutionRejected(
                     subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
 
                 subAckedPromise.get_future().wait();
@@ -361,12 +363,13 @@ void updateJobExecution(
         publishDescribeJobExeCompletedPromise.set_value();
     };
     subAckedPromise = std::promise<void>();
-    jobsClient.SubscribeToUpdateJobExecutionAccepted(
+    /* The handlers capture this call's locals, so their subscriptions end when it returns. */
+    ScopedSubscription updateAccepted = jobsClient.SubscribeToUpdateJobExecutionAccepted(
         subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, subscribeHandler, subAckHandler);
     subAckedPromise.get_future().wait();
 
     subAckedPromise = std::promise<void>();
-    jobsClient.SubscribeToUpdateJobExecutionRejected(
+    ScopedSubscription updateRejected = jobsClient.SubscribeToUpdateJobExecutionRejected(
         subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
     subAckedPromise.get_future().wait();
 
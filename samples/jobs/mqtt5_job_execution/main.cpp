@@ -140,7 +140,9 @@ int main(int argc, char *argv[])
             fprintf(stdout, "Execution Status: %s\n", JobStatusMarshaller::ToString(*response->Execution->Status));
         };
 
-        jobsClient.SubscribeToDescribeJobExecutionAccepted(
+        /* Subscriptions are released when their ScopedSubscription goes out of scope, along with the locals their
+         * handlers capture. */
+        ScopedSubscription describeAccepted = jobsClient.SubscribeToDescribeJobExecutionAccepted(
             describeJobExecutionSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, subscriptionHandler, subAckHandler);
         subAckedPromise.get_future().wait();
 
@@ -158,7 +160,7 @@ int main(int argc, char *argv[])
             }
         };
 
-        jobsClient.SubscribeToDescribeJobExecutionRejected(
+        ScopedSubscription describeRejected = jobsClient.SubscribeToDescribeJobExecutionRejected(
             describeJobExecutionSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
         subAckedPromise.get_future().wait();
 
@@ -223,7 +225,7 @@ int main(int argc, char *argv[])
                 StartNextPendingJobExecutionSubscriptionRequest subscriptionRequest;
                 subscriptionRequest.ThingName = cmdData.input_thingName;
                 subAckedPromise = std::promise<void>();
-                jobsClient.SubscribeToStartNextPendingJobExecutionAccepted(
+                ScopedSubscription startNextAccepted = jobsClient.SubscribeToStartNextPendingJobExecutionAccepted(
                     subscriptionRequest,
                     AWS_MQTT_QOS_AT_LEAST_ONCE,
                     OnSubscribeToStartNextPendingJobExecutionAcceptedResponse,
@@ -232,7 +234,7 @@ int main(int argc, char *argv[])
                 subAckedPromise.get_future().wait();
 
                 subAckedPromise = std::promise<void>();
-                jobsClient.SubscribeToStartNextPendingJobExecutionRejected(
+                ScopedSubscription startNextRejected = jobsClient.SubscribeToStartNextPendingJobExecutionRejected(
                     subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
 
                 subAckedPromise.get_future().wait();
@@ -333,12 +335,13 @@ void updateJobExecution(
         publishDescribeJobExeCompletedPromise.set_value();
     };
     subAckedPromise = std::promise<void>();
-    jobsClient.SubscribeToUpdateJobExecutionAccepted(
+    /* The handlers capture this call's locals, so their subscriptions end when it returns. */
+    ScopedSubscription updateAccepted = jobsClient.SubscribeToUpdateJobExecutionAccepted(
         subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, subscribeHandler, subAckHandler);
     subAckedPromise.get_future().wait();
 
     subAckedPromise = std::promise<void>();
-    jobsClient.SubscribeToUpdateJobExecutionRejected(
+    ScopedSubscription updateRejected = jobsClient.SubscribeToUpdateJobExecutionRejected(
         subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
     subAckedPromise.get_future().wait();
 
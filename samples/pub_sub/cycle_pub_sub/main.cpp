@@ -14,6 +14,7 @@
 #include <chrono>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 
 #include "../../utils/CommandLineUtils.h"
 
@@ -36,6 +37,11 @@ struct CycleClient
 // A vector to hold all the clients used in the sample
 std::vector<CycleClient> clients_holder;
 
+// The index in clients_holder of the client that owns each MQTT connection. It is filled in on the main thread and
+// read from the MQTT callbacks, which run on the event loop threads, so it is only used with the lock held.
+std::unordered_map<const Aws::Crt::Mqtt::MqttConnection *, size_t> clients_by_connection;
+std::mutex clients_by_connection_lock;
+
 /**
  * A helper function to get the CycleClient struct associated with the passed-in MqttConnection.
  * This allows us to get the CycleClient data in the MQTT callbacks.
@@ -46,15 +52,13 @@ std::vector<CycleClient> clients_holder;
  */
 CycleClient *getClientFromConnection(std::vector<CycleClient> *clients, Aws::Crt::Mqtt::MqttConnection *connection)
 {
-    for (size_t i = 0; i < clients->size(); i++)
+    std::lock_guard<std::mutex> lock(clients_by_connection_lock);
+    auto found = clients_by_connection.find(connection);
+    if (found == clients_by_connection.end() || found->second >= clients->size())
     {
-        CycleClient *current_client = &clients->at(i);
-        if (current_client->client.get() == connection)
-        {
-            return current_client;
-        }
+        return nullptr;
     }
-    return nullptr;
+    return &clients->at(found->second);
 }
 
 /**
@@ -98,6 +102,10 @@ void createNewClient(CycleClient *empty_client, size_t index, Utils::cmdData *cm
     }
 
     empty_client->client = connection;
+    {
+        std::lock_guard<std::mutex> lock(clients_by_connection_lock);
+        clients_by_connection[connection.get()] = index;
+    }
     empty_client->client_id = "test-" + Aws::Crt::UUID().ToString() + "-client-";
     empty_client->client_id.append(std::to_string(index).c_str());
 
@@ -594,6 +602,10 @@ int main(int argc, char *argv[])
         operationStop(&clients_holder.at(i), (int)i);
     }
     clients_holder.clear();
+    {
+        std::lock_guard<std::mutex> lock(clients_by_connection_lock);
+        clients_by_connection.clear();
+    }
 
     fprintf(stdout, "\nCycle pub-sub sample complete\n\n");
     return 0;
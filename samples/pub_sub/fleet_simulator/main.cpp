@@ -0,0 +1,597 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/io/HostResolver.h>
+
+#include <aws/common/allocator.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "../../utils/CommandLineUtils.h"
+#include "../../utils/LocalMqttBroker.h"
+
+using namespace Aws::Crt;
+
+/*
+ * Simulates a fleet of devices, each with its own MQTT connection, against a broker running in this process, and
+ * reports how publish latency, throughput and memory change as the fleet grows.
+ *
+ * Every connection shares one event loop group. The devices are split into groups that each have a telemetry topic;
+ * a device may publish to its group's topic, subscribe to it, or both, as set by the publish and subscribe mix.
+ * Publishers publish at a fixed rate, and every message carries the time it was published, so that subscribers can
+ * measure how long it took to reach them.
+ *
+ * The fleet is grown to each of the connection counts given with `--connections` in turn. After each, the memory
+ * the CRT has allocated is sampled, and then publishing runs for `--seconds`.
+ */
+
+/**
+ * Counts latencies in buckets that are an eighth of a power of two wide, so that recording is lock-free and
+ * percentiles are accurate to within 12.5%.
+ */
+class LatencyHistogram
+{
+  public:
+    LatencyHistogram() noexcept { Reset(); }
+
+    void Record(uint64_t value) noexcept
+    {
+        m_buckets[s_bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /* Not safe to call while values are being recorded. */
+    void Reset() noexcept
+    {
+        for (auto &bucket : m_buckets)
+        {
+            bucket.store(0);
+        }
+        m_max.store(0);
+    }
+
+    uint64_t GetCount() const noexcept
+    {
+        uint64_t count = 0;
+        for (const auto &bucket : m_buckets)
+        {
+            count += bucket.load();
+        }
+        return count;
+    }
+
+    /**
+     * @return The upper bound of the bucket that holds the value at `percentile`, which is between 0 and 1.
+     */
+    uint64_t GetPercentile(double percentile) const noexcept
+    {
+        uint64_t count = GetCount();
+        if (count == 0)
+        {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(percentile * static_cast<double>(count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < s_bucketCount; ++i)
+        {
+            seen += m_buckets[i].load();
+            if (seen >= rank)
+            {
+                return std::min(s_upperBoundOf(i), m_max.load());
+            }
+        }
+        return m_max.load();
+    }
+
+    uint64_t GetMax() const noexcept { return m_max.load(); }
+
+  private:
+    /* Values below 16 have a bucket each; every power of two above that is split into 8 buckets. */
+    static const size_t s_linearBuckets = 16;
+    static const size_t s_subBuckets = 8;
+    static const size_t s_bucketCount = s_linearBuckets + (64 - 4) * s_subBuckets;
+
+    static size_t s_bucketOf(uint64_t value) noexcept
+    {
+        if (value < s_linearBuckets)
+        {
+            return static_cast<size_t>(value);
+        }
+        size_t exponent = 63;
+        while ((value >> exponent) == 0)
+        {
+            --exponent;
+        }
+        size_t subBucket = static_cast<size_t>(value >> (exponent - 3)) & (s_subBuckets - 1);
+        return s_linearBuckets + (exponent - 4) * s_subBuckets + subBucket;
+    }
+
+    static uint64_t s_upperBoundOf(size_t bucket) noexcept
+    {
+        if (bucket < s_linearBuckets)
+        {
+            return bucket;
+        }
+        size_t exponent = (bucket - s_linearBuckets) / s_subBuckets + 4;
+        uint64_t subBucket = (bucket - s_linearBuckets) % s_subBuckets;
+        return ((s_subBuckets + subBucket + 1) << (exponent - 3)) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, s_bucketCount> m_buckets;
+    std::atomic<uint64_t> m_max;
+};
+
+struct SimulatedDevice
+{
+    String clientId;
+    String topic;
+    bool publishes = false;
+    bool subscribes = false;
+    std::shared_ptr<Mqtt::MqttConnection> connection;
+    std::shared_ptr<std::promise<bool>> connected;
+    bool isConnected = false;
+    std::promise<void> disconnected;
+    std::atomic<uint64_t> receivedCount{0};
+};
+
+/* Counters for one measurement window, shared by every connection's callbacks. */
+struct FleetStatistics
+{
+    std::atomic<uint64_t> publishedCount{0};
+    std::atomic<uint64_t> failedPublishCount{0};
+    std::atomic<uint64_t> receivedCount{0};
+    std::atomic<uint64_t> interruptedCount{0};
+    LatencyHistogram latencies;
+
+    void Reset() noexcept
+    {
+        publishedCount.store(0);
+        failedPublishCount.store(0);
+        receivedCount.store(0);
+        latencies.Reset();
+    }
+};
+
+/*
+ * The devices are created before any of them connects, and none is removed until every connection is closed. Their
+ * connections are added to the lookup table as the fleet grows, while earlier connections' callbacks may be reading
+ * it.
+ */
+static Vector<std::unique_ptr<SimulatedDevice>> s_devices;
+static std::shared_timed_mutex s_devicesByConnectionMutex;
+static std::unordered_map<const Mqtt::MqttConnection *, SimulatedDevice *> s_devicesByConnection;
+static FleetStatistics s_statistics;
+
+static SimulatedDevice *s_getDeviceFromConnection(const Mqtt::MqttConnection &connection)
+{
+    std::shared_lock<std::shared_timed_mutex> lock(s_devicesByConnectionMutex);
+    auto found = s_devicesByConnection.find(&connection);
+    return found != s_devicesByConnection.end() ? found->second : nullptr;
+}
+
+static int64_t s_nowNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/*
+ * One set of handlers is shared by every connection; they find the device a callback is for by its connection.
+ */
+static void s_onConnectionCompleted(Mqtt::MqttConnection &connection, int errorCode, Mqtt::ReturnCode, bool)
+{
+    SimulatedDevice *device = s_getDeviceFromConnection(connection);
+    if (device != nullptr)
+    {
+        device->connected->set_value(errorCode == AWS_ERROR_SUCCESS);
+    }
+}
+
+static void s_onDisconnect(Mqtt::MqttConnection &connection)
+{
+    SimulatedDevice *device = s_getDeviceFromConnection(connection);
+    if (device != nullptr)
+    {
+        device->disconnected.set_value();
+    }
+}
+
+static void s_onMessage(Mqtt::MqttConnection &connection, const String &, const ByteBuf &payload, bool, Mqtt::QOS, bool)
+{
+    int64_t receivedAt = s_nowNanoseconds();
+    SimulatedDevice *device = s_getDeviceFromConnection(connection);
+    if (device != nullptr)
+    {
+        device->receivedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    s_statistics.receivedCount.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t publishedAt = 0;
+    if (payload.len >= sizeof(publishedAt))
+    {
+        memcpy(&publishedAt, payload.buffer, sizeof(publishedAt));
+        int64_t latency = (receivedAt - publishedAt) / 1000;
+        s_statistics.latencies.Record(latency > 0 ? static_cast<uint64_t>(latency) : 0);
+    }
+}
+
+static void s_publish(SimulatedDevice &device, Mqtt::QOS qos, size_t payloadSize)
+{
+    /* The payload must outlive the publish, so the completion callback owns it. */
+    auto payload = std::make_shared<Vector<uint8_t>>(payloadSize, static_cast<uint8_t>('x'));
+    int64_t publishedAt = s_nowNanoseconds();
+    memcpy(payload->data(), &publishedAt, sizeof(publishedAt));
+
+    auto onPublishComplete = [payload](Mqtt::MqttConnection &, uint16_t, int errorCode) {
+        if (errorCode == AWS_ERROR_SUCCESS)
+        {
+            s_statistics.publishedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            s_statistics.failedPublishCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    ByteBuf buffer = ByteBufFromArray(payload->data(), payload->size());
+    if (device.connection->Publish(device.topic.c_str(), qos, false, buffer, std::move(onPublishComplete)) == 0)
+    {
+        s_statistics.failedPublishCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static Vector<size_t> s_parseConnectionCounts(const String &list)
+{
+    Vector<size_t> counts;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == String::npos)
+        {
+            end = list.size();
+        }
+        int count = atoi(list.substr(start, end - start).c_str());
+        if (count > 0)
+        {
+            counts.push_back(static_cast<size_t>(count));
+        }
+        start = end + 1;
+    }
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+}
+
+/* Connects the devices in [first, last) in batches, then subscribes those that subscribe. */
+static bool s_addDevices(
+    Utils::LocalMqttBroker &broker,
+    Mqtt::MqttClient &mqttClient,
+    size_t first,
+    size_t last,
+    size_t batchSize,
+    Mqtt::QOS qos)
+{
+    for (size_t batchStart = first; batchStart < last; batchStart += batchSize)
+    {
+        size_t batchEnd = std::min(last, batchStart + batchSize);
+        for (size_t i = batchStart; i < batchEnd; ++i)
+        {
+            SimulatedDevice &device = *s_devices[i];
+            device.connection = broker.NewConnection(mqttClient);
+            if (!device.connection)
+            {
+                return false;
+            }
+            device.connected = std::make_shared<std::promise<bool>>();
+            {
+                std::lock_guard<std::shared_timed_mutex> lock(s_devicesByConnectionMutex);
+                s_devicesByConnection[device.connection.get()] = &device;
+            }
+            device.connection->OnConnectionCompleted = s_onConnectionCompleted;
+            device.connection->OnDisconnect = s_onDisconnect;
+            device.connection->OnConnectionInterrupted = [](Mqtt::MqttConnection &, int) {
+                s_statistics.interruptedCount.fetch_add(1);
+            };
+        }
+        for (size_t i = batchStart; i < batchEnd; ++i)
+        {
+            SimulatedDevice &device = *s_devices[i];
+            if (!device.connection->Connect(device.clientId.c_str(), true, 0))
+            {
+                device.connected->set_value(false);
+            }
+        }
+        for (size_t i = batchStart; i < batchEnd; ++i)
+        {
+            s_devices[i]->isConnected = s_devices[i]->connected->get_future().get();
+        }
+        for (size_t i = batchStart; i < batchEnd; ++i)
+        {
+            if (!s_devices[i]->isConnected)
+            {
+                fprintf(stderr, "Failed to connect %s to the local broker\n", s_devices[i]->clientId.c_str());
+                return false;
+            }
+        }
+    }
+
+    Vector<std::future<int>> subAcks;
+    for (size_t i = first; i < last; ++i)
+    {
+        SimulatedDevice &device = *s_devices[i];
+        if (!device.subscribes)
+        {
+            continue;
+        }
+        auto subAckPromise = std::make_shared<std::promise<int>>();
+        subAcks.push_back(subAckPromise->get_future());
+        auto onSubAck = [subAckPromise](Mqtt::MqttConnection &, uint16_t, const String &, Mqtt::QOS, int errorCode) {
+            subAckPromise->set_value(errorCode);
+        };
+        if (device.connection->Subscribe(device.topic.c_str(), qos, s_onMessage, std::move(onSubAck)) == 0)
+        {
+            return false;
+        }
+    }
+    for (auto &subAck : subAcks)
+    {
+        if (subAck.get() != AWS_ERROR_SUCCESS)
+        {
+            fprintf(stderr, "Failed to subscribe a device to its group's topic\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Publishes round-robin across the publishers for `duration`, so that each publishes `rate` messages a second. */
+static void s_runPublishers(
+    const Vector<SimulatedDevice *> &publishers,
+    double rate,
+    std::chrono::steady_clock::duration duration,
+    Mqtt::QOS qos,
+    size_t payloadSize)
+{
+    if (publishers.empty() || rate <= 0)
+    {
+        std::this_thread::sleep_for(duration);
+        return;
+    }
+
+    double messagesPerSecond = rate * static_cast<double>(publishers.size());
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + duration;
+    uint64_t publishCount = 0;
+    size_t nextPublisher = 0;
+    for (auto now = start; now < end; now = std::chrono::steady_clock::now())
+    {
+        double elapsedSeconds = std::chrono::duration<double>(now - start).count();
+        uint64_t dueCount = static_cast<uint64_t>(elapsedSeconds * messagesPerSecond);
+        for (; publishCount < dueCount; ++publishCount)
+        {
+            s_publish(*publishers[nextPublisher], qos, payloadSize);
+            nextPublisher = (nextPublisher + 1) % publishers.size();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    /* Every allocation the CRT makes goes through this tracer, so that memory can be reported per connection. */
+    struct aws_allocator *tracer = aws_mem_tracer_new(aws_default_allocator(), nullptr, AWS_MEMTRACE_BYTES, 0);
+    {
+        ApiHandle apiHandle(tracer);
+
+        Utils::CommandLineUtils cmdUtils = Utils::CommandLineUtils();
+        cmdUtils.RegisterProgramName("fleet-simulator");
+        cmdUtils.RegisterCommand(
+            "connections",
+            "<list>",
+            "Comma-separated connection counts to grow the fleet to and measure at (optional, "
+            "default='100,1000,10000')");
+        cmdUtils.RegisterCommand(
+            "publishers", "<int>", "Percentage of devices that publish (optional, default='50')");
+        cmdUtils.RegisterCommand(
+            "subscribers", "<int>", "Percentage of devices that subscribe (optional, default='50')");
+        cmdUtils.RegisterCommand(
+            "group_size", "<int>", "Devices that share a telemetry topic (optional, default='10')");
+        cmdUtils.RegisterCommand(
+            "rate", "<double>", "Messages each publisher publishes a second (optional, default='1')");
+        cmdUtils.RegisterCommand("payload_size", "<int>", "Bytes in each message (optional, default='64')");
+        cmdUtils.RegisterCommand("qos", "<int>", "QoS to publish and subscribe with (optional, default='0')");
+        cmdUtils.RegisterCommand(
+            "seconds", "<int>", "Seconds to publish for at each connection count (optional, default='10')");
+        cmdUtils.RegisterCommand(
+            "connect_batch", "<int>", "Connections opened at a time (optional, default='1000')");
+        cmdUtils.RegisterCommand(
+            "threads", "<int>", "Event loop threads, or 0 for one per processor (optional, default='0')");
+        cmdUtils.RegisterCommand(
+            "seed", "<int>", "Seed for choosing which devices publish and subscribe (optional, default='1')");
+        cmdUtils.AddLoggingCommands();
+        const char **const_argv = (const char **)argv;
+        cmdUtils.SendArguments(const_argv, const_argv + argc);
+        cmdUtils.StartLoggingBasedOnCommand(&apiHandle);
+        if (cmdUtils.HasCommand("help"))
+        {
+            cmdUtils.PrintHelp();
+            exit(-1);
+        }
+
+        Vector<size_t> connectionCounts =
+            s_parseConnectionCounts(cmdUtils.GetCommandOrDefault("connections", "100,1000,10000"));
+        int publishPercent = atoi(cmdUtils.GetCommandOrDefault("publishers", "50").c_str());
+        int subscribePercent = atoi(cmdUtils.GetCommandOrDefault("subscribers", "50").c_str());
+        size_t groupSize = std::max<size_t>(1, atoi(cmdUtils.GetCommandOrDefault("group_size", "10").c_str()));
+        double rate = atof(cmdUtils.GetCommandOrDefault("rate", "1").c_str());
+        size_t payloadSize = std::max<size_t>(
+            sizeof(int64_t), atoi(cmdUtils.GetCommandOrDefault("payload_size", "64").c_str()));
+        Mqtt::QOS qos = atoi(cmdUtils.GetCommandOrDefault("qos", "0").c_str()) > 0 ? AWS_MQTT_QOS_AT_LEAST_ONCE
+                                                                                     : AWS_MQTT_QOS_AT_MOST_ONCE;
+        int seconds = std::max(1, atoi(cmdUtils.GetCommandOrDefault("seconds", "10").c_str()));
+        size_t connectBatch =
+            std::max<size_t>(1, atoi(cmdUtils.GetCommandOrDefault("connect_batch", "1000").c_str()));
+        uint16_t threadCount = static_cast<uint16_t>(atoi(cmdUtils.GetCommandOrDefault("threads", "0").c_str()));
+        unsigned int seed = static_cast<unsigned int>(atoi(cmdUtils.GetCommandOrDefault("seed", "1").c_str()));
+        if (connectionCounts.empty())
+        {
+            fprintf(stderr, "No connection counts to measure at\n");
+            exit(-1);
+        }
+
+        Io::EventLoopGroup eventLoopGroup(threadCount);
+        Io::DefaultHostResolver hostResolver(eventLoopGroup, 8, 30);
+        Io::ClientBootstrap bootstrap(eventLoopGroup, hostResolver);
+        Mqtt::MqttClient mqttClient(bootstrap);
+
+        Utils::LocalMqttBroker broker(eventLoopGroup);
+        if (!broker.Start())
+        {
+            fprintf(stderr, "Failed to start the local broker: %s\n", ErrorDebugString(LastError()));
+            exit(-1);
+        }
+
+        /* Every device is created up front, so that the lookup tables do not change while connections are open. */
+        size_t deviceCount = connectionCounts.back();
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> percent(0, 99);
+        s_devices.reserve(deviceCount);
+        s_devicesByConnection.reserve(deviceCount);
+        for (size_t i = 0; i < deviceCount; ++i)
+        {
+            std::unique_ptr<SimulatedDevice> device(new SimulatedDevice());
+            device->clientId = String("fleet-simulator-") + std::to_string(i).c_str();
+            device->topic = String("fleet/") + std::to_string(i / groupSize).c_str() + "/telemetry";
+            device->publishes = percent(random) < publishPercent;
+            device->subscribes = percent(random) < subscribePercent;
+            s_devices.push_back(std::move(device));
+        }
+        uint64_t baselineBytes = aws_mem_tracer_bytes(tracer);
+
+        fprintf(
+            stdout,
+            "%11s %10s %11s %10s %10s %9s %9s %9s %9s %12s %10s\n",
+            "connections",
+            "publishers",
+            "subscribers",
+            "publish/s",
+            "receive/s",
+            "p50 (us)",
+            "p99 (us)",
+            "max (us)",
+            "failed",
+            "bytes/conn",
+            "allocs");
+
+        Vector<SimulatedDevice *> publishers;
+        size_t subscriberCount = 0;
+        size_t connectedCount = 0;
+        bool succeeded = true;
+        for (size_t connectionCount : connectionCounts)
+        {
+            if (!s_addDevices(broker, mqttClient, connectedCount, connectionCount, connectBatch, qos))
+            {
+                succeeded = false;
+                break;
+            }
+            for (size_t i = connectedCount; i < connectionCount; ++i)
+            {
+                if (s_devices[i]->publishes)
+                {
+                    publishers.push_back(s_devices[i].get());
+                }
+                subscriberCount += s_devices[i]->subscribes ? 1 : 0;
+            }
+            connectedCount = connectionCount;
+
+            uint64_t connectedBytes = aws_mem_tracer_bytes(tracer);
+            size_t allocationCount = aws_mem_tracer_count(tracer);
+
+            s_statistics.Reset();
+            auto start = std::chrono::steady_clock::now();
+            s_runPublishers(publishers, rate, std::chrono::seconds(seconds), qos, payloadSize);
+            /* Give messages still in flight a moment to arrive before the window is closed. */
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            fprintf(
+                stdout,
+                "%11zu %10zu %11zu %10.0f %10.0f %9llu %9llu %9llu %9llu %12llu %10zu\n",
+                connectionCount,
+                publishers.size(),
+                subscriberCount,
+                static_cast<double>(s_statistics.publishedCount.load()) / elapsedSeconds,
+                static_cast<double>(s_statistics.receivedCount.load()) / elapsedSeconds,
+                static_cast<unsigned long long>(s_statistics.latencies.GetPercentile(0.50)),
+                static_cast<unsigned long long>(s_statistics.latencies.GetPercentile(0.99)),
+                static_cast<unsigned long long>(s_statistics.latencies.GetMax()),
+                static_cast<unsigned long long>(s_statistics.failedPublishCount.load()),
+                static_cast<unsigned long long>((connectedBytes - baselineBytes) / connectionCount),
+                allocationCount);
+            fflush(stdout);
+        }
+
+        fprintf(
+            stdout,
+            "Broker: %llu messages received, %llu delivered, %llu connections interrupted\n",
+            static_cast<unsigned long long>(broker.GetReceivedCount()),
+            static_cast<unsigned long long>(broker.GetDeliveredCount()),
+            static_cast<unsigned long long>(s_statistics.interruptedCount.load()));
+
+        uint64_t leastReceived = UINT64_MAX;
+        uint64_t mostReceived = 0;
+        for (size_t i = 0; i < connectedCount; ++i)
+        {
+            if (s_devices[i]->subscribes)
+            {
+                leastReceived = std::min(leastReceived, s_devices[i]->receivedCount.load());
+                mostReceived = std::max(mostReceived, s_devices[i]->receivedCount.load());
+            }
+        }
+        if (mostReceived > 0)
+        {
+            fprintf(
+                stdout,
+                "Messages received by each subscriber: least %llu, most %llu\n",
+                static_cast<unsigned long long>(leastReceived),
+                static_cast<unsigned long long>(mostReceived));
+        }
+
+        Vector<SimulatedDevice *> disconnecting;
+        for (auto &device : s_devices)
+        {
+            if (device->isConnected && device->connection->Disconnect())
+            {
+                disconnecting.push_back(device.get());
+            }
+        }
+        for (SimulatedDevice *device : disconnecting)
+        {
+            device->disconnected.get_future().wait();
+        }
+        s_devicesByConnection.clear();
+        s_devices.clear();
+        broker.Stop();
+
+        if (!succeeded)
+        {
+            exit(-1);
+        }
+    }
+    aws_mem_tracer_destroy(tracer);
+    return 0;
+}
@@ -283,19 +283,19 @@ int main(int argc, char *argv[])
         ShadowDeltaUpdatedSubscriptionRequest shadowDeltaUpdatedRequest;
         shadowDeltaUpdatedRequest.ThingName = cmdData.input_thingName;
 
-        shadowClient.SubscribeToShadowDeltaUpdatedEvents(
+        ScopedSubscription deltaUpdated = shadowClient.SubscribeToShadowDeltaUpdatedEvents(
             shadowDeltaUpdatedRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onDeltaUpdated, onDeltaUpdatedSubAck);
 
         UpdateShadowSubscriptionRequest updateShadowSubscriptionRequest;
         updateShadowSubscriptionRequest.ThingName = cmdData.input_thingName;
 
-        shadowClient.SubscribeToUpdateShadowAccepted(
+        ScopedSubscription updateAccepted = shadowClient.SubscribeToUpdateShadowAccepted(
             updateShadowSubscriptionRequest,
             AWS_MQTT_QOS_AT_LEAST_ONCE,
             onUpdateShadowAccepted,
             onDeltaUpdatedAcceptedSubAck);
 
-        shadowClient.SubscribeToUpdateShadowRejected(
+        ScopedSubscription updateRejected = shadowClient.SubscribeToUpdateShadowRejected(
             updateShadowSubscriptionRequest,
             AWS_MQTT_QOS_AT_LEAST_ONCE,
             onUpdateShadowRejected,
@@ -394,13 +394,13 @@ int main(int argc, char *argv[])
         GetShadowSubscriptionRequest shadowSubscriptionRequest;
         shadowSubscriptionRequest.ThingName = cmdData.input_thingName;
 
-        shadowClient.SubscribeToGetShadowAccepted(
+        ScopedSubscription getAccepted = shadowClient.SubscribeToGetShadowAccepted(
             shadowSubscriptionRequest,
             AWS_MQTT_QOS_AT_LEAST_ONCE,
             onGetShadowAccepted,
             onGetShadowUpdatedAcceptedSubAck);
 
-        shadowClient.SubscribeToGetShadowRejected(
+        ScopedSubscription getRejected = shadowClient.SubscribeToGetShadowRejected(
             shadowSubscriptionRequest,
             AWS_MQTT_QOS_AT_LEAST_ONCE,
             onGetShadowRejected,
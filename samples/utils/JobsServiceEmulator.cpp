@@ -0,0 +1,470 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "JobsServiceEmulator.h"
+
+namespace Utils
+{
+    static int64_t s_timestamp()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static Aws::Crt::JsonObject s_newResponse(const Aws::Crt::JsonView &request)
+    {
+        Aws::Crt::JsonObject response;
+        response.WithInt64("timestamp", s_timestamp());
+        if (request.IsObject() && request.ValueExists("clientToken"))
+        {
+            response.WithString("clientToken", request.GetString("clientToken"));
+        }
+        return response;
+    }
+
+    static bool s_isTerminal(const Aws::Crt::String &status)
+    {
+        return status == "SUCCEEDED" || status == "FAILED" || status == "REJECTED";
+    }
+
+    JobsServiceEmulator::JobsServiceEmulator(LocalMqttBroker &broker) noexcept
+        : m_broker(broker), m_pendingExecutionCount(0), m_finishedExecutionCount(0), m_rejectedCount(0)
+    {
+        m_broker.AddPublishHandler(
+            "$aws/things/+/jobs/#",
+            [this](const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) { OnRequest(topic, payload); });
+    }
+
+    void JobsServiceEmulator::AddJob(
+        const Aws::Crt::String &jobId,
+        const Aws::Crt::JsonObject &jobDocument,
+        const Aws::Crt::Vector<Aws::Crt::String> &thingNames) noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_jobsMutex);
+        m_jobDocuments[jobId] = jobDocument;
+
+        int64_t queuedAt = s_timestamp();
+        auto queuedTime = std::chrono::steady_clock::now();
+        for (const Aws::Crt::String &thingName : thingNames)
+        {
+            Thing &thing = m_things[thingName];
+            Execution *next = NextExecution(thing);
+            Aws::Crt::String previousNextJobId = next != nullptr ? next->jobId : Aws::Crt::String();
+
+            Execution execution;
+            execution.jobId = jobId;
+            execution.status = "QUEUED";
+            auto finished = thing.finished.find(jobId);
+            if (finished != thing.finished.end())
+            {
+                execution.executionNumber = finished->second.executionNumber + 1;
+                thing.finished.erase(finished);
+            }
+            execution.queuedAt = queuedAt;
+            execution.lastUpdatedAt = queuedAt;
+            execution.queuedTime = queuedTime;
+            thing.pending.push_back(std::move(execution));
+            m_pendingExecutionCount += 1;
+
+            NotifyChanged(thingName, thing, previousNextJobId);
+        }
+    }
+
+    void JobsServiceEmulator::SetOnExecutionFinished(OnExecutionFinished onExecutionFinished) noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_jobsMutex);
+        m_onExecutionFinished = std::move(onExecutionFinished);
+    }
+
+    uint64_t JobsServiceEmulator::GetPendingExecutionCount() const noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_jobsMutex);
+        return m_pendingExecutionCount;
+    }
+
+    uint64_t JobsServiceEmulator::GetFinishedExecutionCount() const noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_jobsMutex);
+        return m_finishedExecutionCount;
+    }
+
+    uint64_t JobsServiceEmulator::GetRejectedCount() const noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_jobsMutex);
+        return m_rejectedCount;
+    }
+
+    void JobsServiceEmulator::OnRequest(const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) noexcept
+    {
+        /* $aws/things/<thingName>/jobs/{get,start-next,<jobId>/get,<jobId>/update} */
+        static const Aws::Crt::String thingsPrefix("$aws/things/");
+        size_t thingEnd = topic.find('/', thingsPrefix.size());
+        if (topic.compare(0, thingsPrefix.size(), thingsPrefix) != 0 || thingEnd == Aws::Crt::String::npos ||
+            topic.compare(thingEnd, 6, "/jobs/") != 0)
+        {
+            return;
+        }
+        Aws::Crt::String thingName = topic.substr(thingsPrefix.size(), thingEnd - thingsPrefix.size());
+        Aws::Crt::String operation = topic.substr(thingEnd + 6);
+        Aws::Crt::String jobId;
+        size_t jobIdEnd = operation.find('/');
+        if (jobIdEnd != Aws::Crt::String::npos)
+        {
+            jobId = operation.substr(0, jobIdEnd);
+            operation = operation.substr(jobIdEnd + 1);
+        }
+
+        /* Clients may publish to other jobs topics too, but only requests are answered. */
+        bool isThingRequest = jobId.empty() && (operation == "get" || operation == "start-next");
+        bool isExecutionRequest = !jobId.empty() && (operation == "get" || operation == "update");
+        if (!isThingRequest && !isExecutionRequest)
+        {
+            return;
+        }
+
+        const std::lock_guard<std::mutex> lock(m_jobsMutex);
+        Aws::Crt::JsonObject request(Aws::Crt::String(reinterpret_cast<const char *>(payload.ptr), payload.len));
+        if (!request.WasParseSuccessful() || !request.View().IsObject())
+        {
+            Reject(topic, "InvalidJson", "Payload contains invalid json", Aws::Crt::JsonObject().View(), nullptr);
+            return;
+        }
+
+        Thing &thing = m_things[thingName];
+        if (isThingRequest)
+        {
+            if (operation == "get")
+            {
+                OnGetPending(topic, thingName, thing, request.View());
+            }
+            else
+            {
+                OnStartNext(topic, thingName, thing, request.View());
+            }
+        }
+        else if (operation == "get")
+        {
+            OnDescribe(topic, thingName, thing, jobId, request.View());
+        }
+        else
+        {
+            OnUpdate(topic, thingName, thing, jobId, request.View());
+        }
+    }
+
+    void JobsServiceEmulator::OnGetPending(
+        const Aws::Crt::String &responseTopic,
+        const Aws::Crt::String &thingName,
+        Thing &thing,
+        Aws::Crt::JsonView request) noexcept
+    {
+        (void)thingName;
+        Aws::Crt::Vector<Aws::Crt::JsonObject> inProgressJobs;
+        Aws::Crt::Vector<Aws::Crt::JsonObject> queuedJobs;
+        for (const Execution &execution : thing.pending)
+        {
+            Aws::Crt::JsonObject summary;
+            summary.WithString("jobId", execution.jobId);
+            summary.WithInt64("queuedAt", execution.queuedAt);
+            if (execution.startedAt != 0)
+            {
+                summary.WithInt64("startedAt", execution.startedAt);
+            }
+            summary.WithInt64("lastUpdatedAt", execution.lastUpdatedAt);
+            summary.WithInteger("versionNumber", execution.versionNumber);
+            summary.WithInt64("executionNumber", execution.executionNumber);
+            (execution.status == "IN_PROGRESS" ? inProgressJobs : queuedJobs).push_back(std::move(summary));
+        }
+
+        Aws::Crt::JsonObject response = s_newResponse(request);
+        response.WithArray("inProgressJobs", std::move(inProgressJobs));
+        response.WithArray("queuedJobs", std::move(queuedJobs));
+        Publish(responseTopic + "/accepted", response);
+    }
+
+    void JobsServiceEmulator::OnStartNext(
+        const Aws::Crt::String &responseTopic,
+        const Aws::Crt::String &thingName,
+        Thing &thing,
+        Aws::Crt::JsonView request) noexcept
+    {
+        Aws::Crt::JsonObject response = s_newResponse(request);
+        Execution *next = NextExecution(thing);
+        if (next != nullptr)
+        {
+            /* An execution that is already in progress is returned as it is. */
+            if (next->status == "QUEUED")
+            {
+                next->status = "IN_PROGRESS";
+                next->startedAt = s_timestamp();
+                next->lastUpdatedAt = next->startedAt;
+                next->versionNumber += 1;
+                if (request.ValueExists("statusDetails"))
+                {
+                    next->statusDetails = request.GetJsonObject("statusDetails").Materialize();
+                }
+            }
+            response.WithObject("execution", ExecutionData(thingName, *next, true));
+        }
+        Publish(responseTopic + "/accepted", response);
+    }
+
+    void JobsServiceEmulator::OnDescribe(
+        const Aws::Crt::String &responseTopic,
+        const Aws::Crt::String &thingName,
+        Thing &thing,
+        const Aws::Crt::String &jobId,
+        Aws::Crt::JsonView request) noexcept
+    {
+        const Execution *execution = nullptr;
+        if (jobId == "$next")
+        {
+            execution = NextExecution(thing);
+        }
+        else
+        {
+            for (const Execution &pending : thing.pending)
+            {
+                if (pending.jobId == jobId)
+                {
+                    execution = &pending;
+                    break;
+                }
+            }
+            auto finished = thing.finished.find(jobId);
+            if (execution == nullptr && finished != thing.finished.end())
+            {
+                execution = &finished->second;
+            }
+        }
+
+        if (execution == nullptr)
+        {
+            Reject(responseTopic, "ResourceNotFound", "Job execution not found", request, nullptr);
+            return;
+        }
+
+        bool includeJobDocument = !request.ValueExists("includeJobDocument") || request.GetBool("includeJobDocument");
+        Aws::Crt::JsonObject response = s_newResponse(request);
+        response.WithObject("execution", ExecutionData(thingName, *execution, includeJobDocument));
+        Publish(responseTopic + "/accepted", response);
+    }
+
+    void JobsServiceEmulator::OnUpdate(
+        const Aws::Crt::String &responseTopic,
+        const Aws::Crt::String &thingName,
+        Thing &thing,
+        const Aws::Crt::String &jobId,
+        Aws::Crt::JsonView request) noexcept
+    {
+        auto execution = thing.pending.begin();
+        while (execution != thing.pending.end() && execution->jobId != jobId)
+        {
+            ++execution;
+        }
+        if (execution == thing.pending.end())
+        {
+            auto finished = thing.finished.find(jobId);
+            if (finished != thing.finished.end())
+            {
+                Reject(
+                    responseTopic,
+                    "InvalidStateTransition",
+                    "Job execution is already in a terminal state",
+                    request,
+                    &finished->second);
+            }
+            else
+            {
+                Reject(responseTopic, "ResourceNotFound", "Job execution not found", request, nullptr);
+            }
+            return;
+        }
+
+        Aws::Crt::String status = request.ValueExists("status") ? request.GetString("status") : Aws::Crt::String();
+        if (status != "IN_PROGRESS" && !s_isTerminal(status))
+        {
+            Reject(
+                responseTopic, "InvalidRequest", "Status must be IN_PROGRESS or a terminal status", request, nullptr);
+            return;
+        }
+        if (request.ValueExists("expectedVersion") && request.GetInteger("expectedVersion") != execution->versionNumber)
+        {
+            Reject(responseTopic, "VersionMismatch", "Version mismatch", request, &*execution);
+            return;
+        }
+
+        Aws::Crt::String previousNextJobId = NextExecution(thing)->jobId;
+        int64_t now = s_timestamp();
+        if (execution->status == "QUEUED")
+        {
+            execution->startedAt = now;
+        }
+        execution->status = status;
+        execution->lastUpdatedAt = now;
+        execution->versionNumber += 1;
+        if (request.ValueExists("statusDetails"))
+        {
+            execution->statusDetails = request.GetJsonObject("statusDetails").Materialize();
+        }
+
+        Aws::Crt::JsonObject response = s_newResponse(request);
+        if (request.ValueExists("includeJobExecutionState") && request.GetBool("includeJobExecutionState"))
+        {
+            Aws::Crt::JsonObject executionState;
+            executionState.WithString("status", execution->status);
+            if (execution->statusDetails.View().IsObject())
+            {
+                executionState.WithObject("statusDetails", execution->statusDetails);
+            }
+            executionState.WithInteger("versionNumber", execution->versionNumber);
+            response.WithObject("executionState", std::move(executionState));
+        }
+        if (request.ValueExists("includeJobDocument") && request.GetBool("includeJobDocument"))
+        {
+            response.WithObject("jobDocument", m_jobDocuments[jobId]);
+        }
+        Publish(responseTopic + "/accepted", response);
+
+        if (s_isTerminal(status))
+        {
+            if (m_onExecutionFinished)
+            {
+                m_onExecutionFinished(
+                    thingName, jobId, status, std::chrono::steady_clock::now() - execution->queuedTime);
+            }
+            thing.finished[jobId] = std::move(*execution);
+            thing.pending.erase(execution);
+            m_pendingExecutionCount -= 1;
+            m_finishedExecutionCount += 1;
+            NotifyChanged(thingName, thing, previousNextJobId);
+        }
+    }
+
+    void JobsServiceEmulator::Reject(
+        const Aws::Crt::String &responseTopic,
+        const char *code,
+        const Aws::Crt::String &message,
+        Aws::Crt::JsonView request,
+        const Execution *execution) noexcept
+    {
+        m_rejectedCount += 1;
+        Aws::Crt::JsonObject response = s_newResponse(request);
+        response.WithString("code", code);
+        response.WithString("message", message);
+        if (execution != nullptr)
+        {
+            Aws::Crt::JsonObject executionState;
+            executionState.WithString("status", execution->status);
+            executionState.WithInteger("versionNumber", execution->versionNumber);
+            response.WithObject("executionState", std::move(executionState));
+        }
+        Publish(responseTopic + "/rejected", response);
+    }
+
+    void JobsServiceEmulator::NotifyChanged(
+        const Aws::Crt::String &thingName,
+        Thing &thing,
+        const Aws::Crt::String &previousNextJobId) noexcept
+    {
+        Aws::Crt::String topicPrefix = "$aws/things/" + thingName + "/jobs/";
+
+        Aws::Crt::Vector<Aws::Crt::JsonObject> queued;
+        Aws::Crt::Vector<Aws::Crt::JsonObject> inProgress;
+        for (const Execution &execution : thing.pending)
+        {
+            Aws::Crt::JsonObject summary;
+            summary.WithString("jobId", execution.jobId);
+            summary.WithInt64("queuedAt", execution.queuedAt);
+            summary.WithInt64("lastUpdatedAt", execution.lastUpdatedAt);
+            summary.WithInteger("versionNumber", execution.versionNumber);
+            summary.WithInt64("executionNumber", execution.executionNumber);
+            (execution.status == "IN_PROGRESS" ? inProgress : queued).push_back(std::move(summary));
+        }
+        Aws::Crt::JsonObject jobs;
+        if (!queued.empty())
+        {
+            jobs.WithArray("QUEUED", std::move(queued));
+        }
+        if (!inProgress.empty())
+        {
+            jobs.WithArray("IN_PROGRESS", std::move(inProgress));
+        }
+        Aws::Crt::JsonObject notify;
+        notify.WithInt64("timestamp", s_timestamp());
+        notify.WithObject("jobs", std::move(jobs));
+        Publish(topicPrefix + "notify", notify);
+
+        const Execution *next = NextExecution(thing);
+        Aws::Crt::String nextJobId = next != nullptr ? next->jobId : Aws::Crt::String();
+        if (nextJobId != previousNextJobId)
+        {
+            Aws::Crt::JsonObject notifyNext;
+            notifyNext.WithInt64("timestamp", s_timestamp());
+            if (next != nullptr)
+            {
+                notifyNext.WithObject("execution", ExecutionData(thingName, *next, true));
+            }
+            Publish(topicPrefix + "notify-next", notifyNext);
+        }
+    }
+
+    JobsServiceEmulator::Execution *JobsServiceEmulator::NextExecution(Thing &thing) noexcept
+    {
+        /* The oldest execution in progress, or else the oldest queued one. */
+        Execution *oldestQueued = nullptr;
+        for (Execution &execution : thing.pending)
+        {
+            if (execution.status == "IN_PROGRESS")
+            {
+                return &execution;
+            }
+            if (oldestQueued == nullptr)
+            {
+                oldestQueued = &execution;
+            }
+        }
+        return oldestQueued;
+    }
+
+    Aws::Crt::JsonObject JobsServiceEmulator::ExecutionData(
+        const Aws::Crt::String &thingName,
+        const Execution &execution,
+        bool includeJobDocument) const noexcept
+    {
+        Aws::Crt::JsonObject data;
+        data.WithString("jobId", execution.jobId);
+        data.WithString("thingName", thingName);
+        if (includeJobDocument)
+        {
+            auto jobDocument = m_jobDocuments.find(execution.jobId);
+            if (jobDocument != m_jobDocuments.end())
+            {
+                data.WithObject("jobDocument", jobDocument->second);
+            }
+        }
+        data.WithString("status", execution.status);
+        if (execution.statusDetails.View().IsObject())
+        {
+            data.WithObject("statusDetails", execution.statusDetails);
+        }
+        data.WithInt64("queuedAt", execution.queuedAt);
+        if (execution.startedAt != 0)
+        {
+            data.WithInt64("startedAt", execution.startedAt);
+        }
+        data.WithInt64("lastUpdatedAt", execution.lastUpdatedAt);
+        data.WithInteger("versionNumber", execution.versionNumber);
+        data.WithInt64("executionNumber", execution.executionNumber);
+        return data;
+    }
+
+    void JobsServiceEmulator::Publish(const Aws::Crt::String &topic, const Aws::Crt::JsonObject &document) noexcept
+    {
+        Aws::Crt::String payload = document.View().WriteCompact(true);
+        m_broker.Publish(
+            topic, Aws::Crt::ByteCursorFromArray(reinterpret_cast<const uint8_t *>(payload.data()), payload.size()));
+    }
+} // namespace Utils
@@ -0,0 +1,144 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "LocalMqttBroker.h"
+
+#include <aws/crt/JsonObject.h>
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+namespace Utils
+{
+    /**
+     * Emulates the AWS IoT Jobs service on a LocalMqttBroker.
+     *
+     * Jobs added with `AddJob` are queued for each of their things. Devices use the `$aws/things/+/jobs/...` topics
+     * to list their pending executions, describe an execution, start the next one and update executions, with
+     * `expectedVersion` checked against each execution's version. The `notify` and `notify-next` events are published
+     * when a thing's pending executions or its next execution change.
+     */
+    class JobsServiceEmulator
+    {
+      public:
+        /**
+         * Invoked when a device moves a job execution to a terminal status, with the time since it was queued. It is
+         * invoked while the emulator is locked, and must not call back into it.
+         */
+        using OnExecutionFinished = std::function<void(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::String &jobId,
+            const Aws::Crt::String &status,
+            std::chrono::steady_clock::duration latency)>;
+
+        explicit JobsServiceEmulator(LocalMqttBroker &broker) noexcept;
+        JobsServiceEmulator(const JobsServiceEmulator &) = delete;
+        JobsServiceEmulator &operator=(const JobsServiceEmulator &) = delete;
+
+        /**
+         * Queue a job for each of `thingNames`. May be called from any thread.
+         */
+        void AddJob(
+            const Aws::Crt::String &jobId,
+            const Aws::Crt::JsonObject &jobDocument,
+            const Aws::Crt::Vector<Aws::Crt::String> &thingNames) noexcept;
+
+        /**
+         * Set the callback invoked when an execution finishes. Set it before adding jobs.
+         */
+        void SetOnExecutionFinished(OnExecutionFinished onExecutionFinished) noexcept;
+
+        /**
+         * @return The number of executions that are queued or in progress.
+         */
+        uint64_t GetPendingExecutionCount() const noexcept;
+
+        /**
+         * @return The number of executions that reached a terminal status.
+         */
+        uint64_t GetFinishedExecutionCount() const noexcept;
+
+        /**
+         * @return The number of requests that were rejected.
+         */
+        uint64_t GetRejectedCount() const noexcept;
+
+      private:
+        struct Execution
+        {
+            Aws::Crt::String jobId;
+            Aws::Crt::String status;
+            Aws::Crt::JsonObject statusDetails;
+            int32_t versionNumber = 1;
+            int64_t executionNumber = 1;
+            int64_t queuedAt = 0;
+            int64_t startedAt = 0;
+            int64_t lastUpdatedAt = 0;
+            std::chrono::steady_clock::time_point queuedTime;
+        };
+
+        struct Thing
+        {
+            /* Queued and in progress executions, oldest first. */
+            Aws::Crt::List<Execution> pending;
+            Aws::Crt::Map<Aws::Crt::String, Execution> finished;
+        };
+
+        void OnRequest(const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) noexcept;
+        void OnGetPending(
+            const Aws::Crt::String &responseTopic,
+            const Aws::Crt::String &thingName,
+            Thing &thing,
+            Aws::Crt::JsonView request) noexcept;
+        void OnStartNext(
+            const Aws::Crt::String &responseTopic,
+            const Aws::Crt::String &thingName,
+            Thing &thing,
+            Aws::Crt::JsonView request) noexcept;
+        void OnDescribe(
+            const Aws::Crt::String &responseTopic,
+            const Aws::Crt::String &thingName,
+            Thing &thing,
+            const Aws::Crt::String &jobId,
+            Aws::Crt::JsonView request) noexcept;
+        void OnUpdate(
+            const Aws::Crt::String &responseTopic,
+            const Aws::Crt::String &thingName,
+            Thing &thing,
+            const Aws::Crt::String &jobId,
+            Aws::Crt::JsonView request) noexcept;
+        void Reject(
+            const Aws::Crt::String &responseTopic,
+            const char *code,
+            const Aws::Crt::String &message,
+            Aws::Crt::JsonView request,
+            const Execution *execution) noexcept;
+
+        /* Publishes notify, and notify-next if the next execution is no longer `previousNextJobId`. */
+        void NotifyChanged(
+            const Aws::Crt::String &thingName,
+            Thing &thing,
+            const Aws::Crt::String &previousNextJobId) noexcept;
+        static Execution *NextExecution(Thing &thing) noexcept;
+        Aws::Crt::JsonObject ExecutionData(
+            const Aws::Crt::String &thingName,
+            const Execution &execution,
+            bool includeJobDocument) const noexcept;
+        void Publish(const Aws::Crt::String &topic, const Aws::Crt::JsonObject &document) noexcept;
+
+        LocalMqttBroker &m_broker;
+
+        /* Requests are handled on the event loop of each device's connection. */
+        mutable std::mutex m_jobsMutex;
+        Aws::Crt::Map<Aws::Crt::String, Aws::Crt::JsonObject> m_jobDocuments;
+        Aws::Crt::Map<Aws::Crt::String, Thing> m_things;
+        OnExecutionFinished m_onExecutionFinished;
+        uint64_t m_pendingExecutionCount;
+        uint64_t m_finishedExecutionCount;
+        uint64_t m_rejectedCount;
+    };
+} // namespace Utils
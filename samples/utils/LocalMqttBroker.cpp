@@ -0,0 +1,848 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "LocalMqttBroker.h"
+
+#include <aws/crt/UUID.h>
+
+#include <algorithm>
+
+namespace Utils
+{
+    /* MQTT 3.1.1 control packet types, from the high nibble of the fixed header. */
+    enum MqttPacketType : uint8_t
+    {
+        MQTT_CONNECT = 1,
+        MQTT_CONNACK = 2,
+        MQTT_PUBLISH = 3,
+        MQTT_PUBACK = 4,
+        MQTT_PUBREC = 5,
+        MQTT_PUBREL = 6,
+        MQTT_PUBCOMP = 7,
+        MQTT_SUBSCRIBE = 8,
+        MQTT_SUBACK = 9,
+        MQTT_UNSUBSCRIBE = 10,
+        MQTT_UNSUBACK = 11,
+        MQTT_PINGREQ = 12,
+        MQTT_PINGRESP = 13,
+        MQTT_DISCONNECT = 14
+    };
+
+    static void s_writeRemainingLength(struct aws_byte_buf *buffer, size_t length)
+    {
+        do
+        {
+            uint8_t encodedByte = static_cast<uint8_t>(length % 128);
+            length /= 128;
+            if (length > 0)
+            {
+                encodedByte |= 128;
+            }
+            aws_byte_buf_append_byte_dynamic(buffer, encodedByte);
+        } while (length > 0);
+    }
+
+    static bool s_readString(struct aws_byte_cursor *cursor, Aws::Crt::String &value)
+    {
+        uint16_t length = 0;
+        if (!aws_byte_cursor_read_be16(cursor, &length) || cursor->len < length)
+        {
+            return false;
+        }
+        struct aws_byte_cursor string = aws_byte_cursor_advance(cursor, length);
+        value.assign(reinterpret_cast<const char *>(string.ptr), string.len);
+        return true;
+    }
+
+    /* A packet acknowledging `packetId`, which is all of PUBACK, PUBREC, PUBCOMP and UNSUBACK. */
+    static void s_writeAck(struct aws_byte_buf *buffer, uint8_t firstByte, uint16_t packetId)
+    {
+        aws_byte_buf_append_byte_dynamic(buffer, firstByte);
+        aws_byte_buf_append_byte_dynamic(buffer, 2);
+        aws_byte_buf_append_byte_dynamic(buffer, static_cast<uint8_t>(packetId >> 8));
+        aws_byte_buf_append_byte_dynamic(buffer, static_cast<uint8_t>(packetId & 0xFF));
+    }
+
+    /* The broker end of one client connection, installed as the last handler of the connection's channel. */
+    struct LocalMqttBroker::Session
+    {
+        struct DeliveryTask
+        {
+            struct aws_channel_task task;
+            Session *session;
+            struct aws_byte_buf packet;
+        };
+
+        LocalMqttBroker *broker;
+        struct aws_channel *channel;
+        struct aws_channel_slot *slot;
+        struct aws_channel_handler handler;
+        /* Bytes received that do not yet form a complete packet. */
+        struct aws_byte_buf readBuffer;
+        bool connected;
+        /* The following are protected by the broker's sessions mutex. */
+        bool registered;
+        Aws::Crt::List<Session *>::iterator position;
+        Aws::Crt::Vector<Aws::Crt::String> filters;
+
+        static struct aws_channel_handler_vtable s_handlerVtable;
+
+        /* Must be called on the channel's thread. */
+        void Write(struct aws_byte_cursor data)
+        {
+            while (data.len > 0)
+            {
+                struct aws_io_message *message =
+                    aws_channel_acquire_message_from_pool(channel, AWS_IO_MESSAGE_APPLICATION_DATA, data.len);
+                if (message == nullptr)
+                {
+                    aws_channel_shutdown(channel, aws_last_error());
+                    return;
+                }
+
+                size_t chunkSize =
+                    std::min(data.len, message->message_data.capacity - message->message_data.len);
+                struct aws_byte_cursor chunk = aws_byte_cursor_advance(&data, chunkSize);
+                aws_byte_buf_append(&message->message_data, &chunk);
+                if (aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE))
+                {
+                    aws_mem_release(message->allocator, message);
+                    aws_channel_shutdown(channel, aws_last_error());
+                    return;
+                }
+            }
+        }
+
+        /* Handles one complete packet. Returns false if the packet is malformed. */
+        bool OnPacket(uint8_t firstByte, struct aws_byte_cursor body)
+        {
+            uint8_t packetType = firstByte >> 4;
+            if (!connected && packetType != MQTT_CONNECT)
+            {
+                return false;
+            }
+
+            struct aws_byte_buf response;
+            aws_byte_buf_init(&response, broker->m_allocator, 16);
+            bool wellFormed = true;
+            switch (packetType)
+            {
+                case MQTT_CONNECT:
+                {
+                    /* Credentials, wills and session state are not supported, so the rest of CONNECT is ignored. */
+                    connected = true;
+                    const uint8_t connack[] = {MQTT_CONNACK << 4, 2, 0, 0};
+                    struct aws_byte_cursor connackCursor = aws_byte_cursor_from_array(connack, sizeof(connack));
+                    aws_byte_buf_append_dynamic(&response, &connackCursor);
+                    break;
+                }
+                case MQTT_PUBLISH:
+                {
+                    uint8_t qos = (firstByte >> 1) & 0x3;
+                    Aws::Crt::String topic;
+                    uint16_t packetId = 0;
+                    wellFormed =
+                        s_readString(&body, topic) && (qos == 0 || aws_byte_cursor_read_be16(&body, &packetId));
+                    if (!wellFormed)
+                    {
+                        break;
+                    }
+                    if (qos == 1 && !broker->TakeIgnoredPublish())
+                    {
+                        s_writeAck(&response, MQTT_PUBACK << 4, packetId);
+                    }
+                    else if (qos == 2)
+                    {
+                        s_writeAck(&response, MQTT_PUBREC << 4, packetId);
+                    }
+                    Write(aws_byte_cursor_from_buf(&response));
+                    aws_byte_buf_reset(&response, false);
+                    broker->OnClientPublished(topic, body);
+                    break;
+                }
+                case MQTT_PUBREL:
+                {
+                    uint16_t packetId = 0;
+                    wellFormed = aws_byte_cursor_read_be16(&body, &packetId);
+                    s_writeAck(&response, MQTT_PUBCOMP << 4, packetId);
+                    break;
+                }
+                case MQTT_SUBSCRIBE:
+                {
+                    uint16_t packetId = 0;
+                    wellFormed = aws_byte_cursor_read_be16(&body, &packetId);
+                    Aws::Crt::Vector<uint8_t> grantedQos;
+                    while (wellFormed && body.len > 0)
+                    {
+                        Aws::Crt::String filter;
+                        uint8_t requestedQos = 0;
+                        wellFormed = s_readString(&body, filter) && aws_byte_cursor_read_u8(&body, &requestedQos);
+                        if (wellFormed)
+                        {
+                            broker->Subscribe(this, filter);
+                            grantedQos.push_back(std::min<uint8_t>(requestedQos, 1));
+                        }
+                    }
+                    if (!wellFormed)
+                    {
+                        break;
+                    }
+                    aws_byte_buf_append_byte_dynamic(&response, MQTT_SUBACK << 4);
+                    s_writeRemainingLength(&response, 2 + grantedQos.size());
+                    aws_byte_buf_append_byte_dynamic(&response, static_cast<uint8_t>(packetId >> 8));
+                    aws_byte_buf_append_byte_dynamic(&response, static_cast<uint8_t>(packetId & 0xFF));
+                    for (uint8_t qos : grantedQos)
+                    {
+                        aws_byte_buf_append_byte_dynamic(&response, qos);
+                    }
+                    break;
+                }
+                case MQTT_UNSUBSCRIBE:
+                {
+                    uint16_t packetId = 0;
+                    wellFormed = aws_byte_cursor_read_be16(&body, &packetId);
+                    while (wellFormed && body.len > 0)
+                    {
+                        Aws::Crt::String filter;
+                        wellFormed = s_readString(&body, filter);
+                        if (wellFormed)
+                        {
+                            broker->Unsubscribe(this, filter);
+                        }
+                    }
+                    if (wellFormed)
+                    {
+                        s_writeAck(&response, MQTT_UNSUBACK << 4, packetId);
+                    }
+                    break;
+                }
+                case MQTT_PINGREQ:
+                {
+                    aws_byte_buf_append_byte_dynamic(&response, MQTT_PINGRESP << 4);
+                    aws_byte_buf_append_byte_dynamic(&response, 0);
+                    break;
+                }
+                case MQTT_DISCONNECT:
+                {
+                    aws_channel_shutdown(channel, AWS_OP_SUCCESS);
+                    break;
+                }
+                default:
+                    /* Acknowledgements of messages delivered at QoS 0 are not expected, and are ignored. */
+                    break;
+            }
+
+            if (wellFormed && response.len > 0)
+            {
+                Write(aws_byte_cursor_from_buf(&response));
+            }
+            aws_byte_buf_clean_up(&response);
+            return wellFormed;
+        }
+
+        static int s_processReadMessage(
+            struct aws_channel_handler *handler,
+            struct aws_channel_slot *slot,
+            struct aws_io_message *message)
+        {
+            auto *session = static_cast<Session *>(handler->impl);
+            size_t messageLength = message->message_data.len;
+            struct aws_byte_cursor received = aws_byte_cursor_from_buf(&message->message_data);
+            aws_byte_buf_append_dynamic(&session->readBuffer, &received);
+            aws_mem_release(message->allocator, message);
+
+            /* Handle every complete packet, then keep the remainder for the next read. */
+            struct aws_byte_cursor unread = aws_byte_cursor_from_buf(&session->readBuffer);
+            while (unread.len >= 2)
+            {
+                size_t remainingLength = 0;
+                size_t multiplier = 1;
+                size_t headerLength = 1;
+                uint8_t encodedByte = 0;
+                do
+                {
+                    if (headerLength >= unread.len)
+                    {
+                        break;
+                    }
+                    if (headerLength > 4)
+                    {
+                        aws_channel_shutdown(slot->channel, AWS_ERROR_INVALID_ARGUMENT);
+                        return AWS_OP_SUCCESS;
+                    }
+                    encodedByte = unread.ptr[headerLength++];
+                    remainingLength += (encodedByte & 127) * multiplier;
+                    multiplier *= 128;
+                } while (encodedByte & 128);
+
+                if ((encodedByte & 128) || headerLength + remainingLength > unread.len)
+                {
+                    break;
+                }
+
+                uint8_t firstByte = unread.ptr[0];
+                aws_byte_cursor_advance(&unread, headerLength);
+                struct aws_byte_cursor body = aws_byte_cursor_advance(&unread, remainingLength);
+                if (!session->OnPacket(firstByte, body))
+                {
+                    aws_channel_shutdown(slot->channel, AWS_ERROR_INVALID_ARGUMENT);
+                    return AWS_OP_SUCCESS;
+                }
+            }
+
+            size_t consumed = session->readBuffer.len - unread.len;
+            if (consumed > 0)
+            {
+                memmove(session->readBuffer.buffer, unread.ptr, unread.len);
+                session->readBuffer.len = unread.len;
+            }
+
+            return aws_channel_slot_increment_read_window(slot, messageLength);
+        }
+
+        static int s_processWriteMessage(
+            struct aws_channel_handler *handler,
+            struct aws_channel_slot *slot,
+            struct aws_io_message *message)
+        {
+            (void)handler;
+            return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE);
+        }
+
+        static int s_incrementReadWindow(
+            struct aws_channel_handler *handler,
+            struct aws_channel_slot *slot,
+            size_t size)
+        {
+            (void)handler;
+            (void)slot;
+            (void)size;
+            return AWS_OP_SUCCESS;
+        }
+
+        static int s_shutdown(
+            struct aws_channel_handler *handler,
+            struct aws_channel_slot *slot,
+            enum aws_channel_direction direction,
+            int errorCode,
+            bool freeScarceResourcesImmediately)
+        {
+            if (direction == AWS_CHANNEL_DIR_READ)
+            {
+                auto *session = static_cast<Session *>(handler->impl);
+                session->broker->RemoveSession(session);
+            }
+            return aws_channel_slot_on_handler_shutdown_complete(
+                slot, direction, errorCode, freeScarceResourcesImmediately);
+        }
+
+        static size_t s_initialWindowSize(struct aws_channel_handler *handler)
+        {
+            (void)handler;
+            return SIZE_MAX;
+        }
+
+        static size_t s_messageOverhead(struct aws_channel_handler *handler)
+        {
+            (void)handler;
+            return 0;
+        }
+
+        static void s_destroy(struct aws_channel_handler *handler)
+        {
+            auto *session = static_cast<Session *>(handler->impl);
+            LocalMqttBroker *broker = session->broker;
+            aws_byte_buf_clean_up(&session->readBuffer);
+            Aws::Crt::Delete(session, broker->m_allocator);
+
+            const std::lock_guard<std::mutex> lock(broker->m_sessionsMutex);
+            broker->m_liveSessions -= 1;
+            broker->m_sessionsClosedSignal.notify_all();
+        }
+
+        static void s_deliver(struct aws_channel_task *task, void *arg, enum aws_task_status status)
+        {
+            (void)task;
+            auto *delivery = static_cast<DeliveryTask *>(arg);
+            Session *session = delivery->session;
+            struct aws_channel *channel = session->channel;
+            if (status == AWS_TASK_STATUS_RUN_READY)
+            {
+                session->Write(aws_byte_cursor_from_buf(&delivery->packet));
+            }
+            aws_byte_buf_clean_up(&delivery->packet);
+            Aws::Crt::Delete(delivery, session->broker->m_allocator);
+            aws_channel_release_hold(channel);
+        }
+    };
+
+    struct aws_channel_handler_vtable LocalMqttBroker::Session::s_handlerVtable = {
+        LocalMqttBroker::Session::s_processReadMessage,
+        LocalMqttBroker::Session::s_processWriteMessage,
+        LocalMqttBroker::Session::s_incrementReadWindow,
+        LocalMqttBroker::Session::s_shutdown,
+        LocalMqttBroker::Session::s_initialWindowSize,
+        LocalMqttBroker::Session::s_messageOverhead,
+        LocalMqttBroker::Session::s_destroy,
+        nullptr,
+        nullptr,
+        nullptr,
+    };
+
+    LocalMqttBroker::LocalMqttBroker(
+        Aws::Crt::Io::EventLoopGroup &eventLoopGroup,
+        Aws::Crt::Allocator *allocator) noexcept
+        : m_allocator(allocator), m_eventLoopGroup(eventLoopGroup), m_serverBootstrap(nullptr), m_listener(nullptr),
+          m_receivedCount(0), m_deliveredCount(0), m_publishesToIgnore(0), m_liveSessions(0)
+    {
+        m_socketOptions.SetSocketDomain(Aws::Crt::Io::SocketDomain::Local);
+        m_socketOptions.SetSocketType(Aws::Crt::Io::SocketType::Stream);
+    }
+
+    LocalMqttBroker::~LocalMqttBroker() noexcept { Stop(); }
+
+    bool LocalMqttBroker::Start(const Aws::Crt::String &socketPath) noexcept
+    {
+        if (m_listener != nullptr)
+        {
+            return true;
+        }
+
+        m_socketPath = socketPath;
+        if (m_socketPath.empty())
+        {
+#if defined(_WIN32)
+            m_socketPath = Aws::Crt::String("\\\\.\\pipe\\local-mqtt-broker-") + Aws::Crt::UUID().ToString();
+#else
+            m_socketPath = Aws::Crt::String("/tmp/local-mqtt-broker-") + Aws::Crt::UUID().ToString() + ".sock";
+#endif
+        }
+
+        m_serverBootstrap = aws_server_bootstrap_new(m_allocator, m_eventLoopGroup.GetUnderlyingHandle());
+        if (m_serverBootstrap == nullptr)
+        {
+            return false;
+        }
+
+        struct aws_server_socket_channel_bootstrap_options listenerOptions;
+        AWS_ZERO_STRUCT(listenerOptions);
+        listenerOptions.bootstrap = m_serverBootstrap;
+        listenerOptions.host_name = m_socketPath.c_str();
+        listenerOptions.port = 0;
+        listenerOptions.socket_options = &m_socketOptions.GetImpl();
+        listenerOptions.incoming_callback = s_onIncomingChannelSetup;
+        listenerOptions.shutdown_callback = s_onIncomingChannelShutdown;
+        listenerOptions.destroy_callback = s_onListenerDestroy;
+        listenerOptions.user_data = this;
+
+        m_listenerDestroyedPromise = std::promise<void>();
+        m_listener = aws_server_bootstrap_new_socket_listener(&listenerOptions);
+        if (m_listener == nullptr)
+        {
+            aws_server_bootstrap_release(m_serverBootstrap);
+            m_serverBootstrap = nullptr;
+            return false;
+        }
+
+        return true;
+    }
+
+    void LocalMqttBroker::Stop() noexcept
+    {
+        if (m_listener != nullptr)
+        {
+            std::future<void> listenerDestroyed = m_listenerDestroyedPromise.get_future();
+            aws_server_bootstrap_destroy_socket_listener(m_serverBootstrap, m_listener);
+            listenerDestroyed.wait();
+            m_listener = nullptr;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_sessionsMutex);
+            for (Session *session : m_sessions)
+            {
+                aws_channel_shutdown(session->channel, AWS_IO_SOCKET_CLOSED);
+            }
+            m_sessionsClosedSignal.wait(lock, [this]() { return m_liveSessions == 0; });
+        }
+
+        if (m_serverBootstrap != nullptr)
+        {
+            aws_server_bootstrap_release(m_serverBootstrap);
+            m_serverBootstrap = nullptr;
+        }
+    }
+
+    std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> LocalMqttBroker::NewConnection(
+        Aws::Crt::Mqtt::MqttClient &client) const noexcept
+    {
+        return client.NewConnection(m_socketPath.c_str(), 0, m_socketOptions, false);
+    }
+
+    std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> LocalMqttBroker::Connect(
+        Aws::Crt::Mqtt::MqttClient &client,
+        const char *clientId,
+        uint32_t protocolOperationTimeoutMs) const noexcept
+    {
+        auto connection = NewConnection(client);
+        if (!connection || !*connection)
+        {
+            return nullptr;
+        }
+
+        auto connected = std::make_shared<std::promise<bool>>();
+        connection->OnConnectionCompleted = [connected](
+                                                Aws::Crt::Mqtt::MqttConnection &,
+                                                int errorCode,
+                                                Aws::Crt::Mqtt::ReturnCode returnCode,
+                                                bool) {
+            connected->set_value(errorCode == AWS_ERROR_SUCCESS && returnCode == AWS_MQTT_CONNECT_ACCEPTED);
+        };
+        if (!connection->Connect(clientId, true, 0, 0, protocolOperationTimeoutMs) || !connected->get_future().get())
+        {
+            return nullptr;
+        }
+        /* The broker does not drop connections, so the connection does not complete again. */
+        connection->OnConnectionCompleted = nullptr;
+        return connection;
+    }
+
+    void LocalMqttBroker::Disconnect(Aws::Crt::Mqtt::MqttConnection &connection) noexcept
+    {
+        std::promise<void> disconnected;
+        connection.OnDisconnect = [&disconnected](Aws::Crt::Mqtt::MqttConnection &) { disconnected.set_value(); };
+        if (connection.Disconnect())
+        {
+            disconnected.get_future().wait();
+        }
+        connection.OnDisconnect = nullptr;
+    }
+
+    void LocalMqttBroker::AddPublishHandler(const Aws::Crt::String &topicFilter, OnClientPublish handler) noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_sessionsMutex);
+        m_publishHandlers.push_back({topicFilter, std::move(handler)});
+    }
+
+    void LocalMqttBroker::RecordPublishes(const Aws::Crt::String &topicFilter) noexcept
+    {
+        AddPublishHandler(topicFilter, [this](const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) {
+            RecordedPublish publish;
+            publish.topic = topic;
+            publish.payload.assign(reinterpret_cast<const char *>(payload.ptr), payload.len);
+            publish.receivedAt = std::chrono::steady_clock::now();
+
+            const std::lock_guard<std::mutex> lock(m_recordedMutex);
+            m_recordedPublishes.push_back(std::move(publish));
+            m_recordedSignal.notify_all();
+        });
+    }
+
+    bool LocalMqttBroker::WaitForRecordedPublishes(size_t count, std::chrono::milliseconds timeout) const noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_recordedMutex);
+        return m_recordedSignal.wait_for(
+            lock, timeout, [this, count]() { return m_recordedPublishes.size() >= count; });
+    }
+
+    Aws::Crt::Vector<LocalMqttBroker::RecordedPublish> LocalMqttBroker::GetRecordedPublishes() const noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_recordedMutex);
+        return m_recordedPublishes;
+    }
+
+    void LocalMqttBroker::IgnorePublishes(size_t count) noexcept { m_publishesToIgnore.store(count); }
+
+    bool LocalMqttBroker::TakeIgnoredPublish() noexcept
+    {
+        size_t toIgnore = m_publishesToIgnore.load();
+        while (toIgnore > 0)
+        {
+            if (m_publishesToIgnore.compare_exchange_weak(toIgnore, toIgnore - 1))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t LocalMqttBroker::Publish(const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) noexcept
+    {
+        Aws::Crt::Vector<Session *> targets;
+        {
+            const std::lock_guard<std::mutex> lock(m_sessionsMutex);
+            auto exact = m_exactSubscriptions.find(topic);
+            if (exact != m_exactSubscriptions.end())
+            {
+                targets = exact->second;
+            }
+            for (const Subscription &subscription : m_wildcardSubscriptions)
+            {
+                if (TopicMatches(subscription.filter, topic))
+                {
+                    targets.push_back(subscription.session);
+                }
+            }
+            /* Keeps each channel, and so its session, alive until the message has been written to it. */
+            for (Session *session : targets)
+            {
+                aws_channel_acquire_hold(session->channel);
+            }
+        }
+
+        if (targets.empty())
+        {
+            return 0;
+        }
+
+        struct aws_byte_buf packet;
+        aws_byte_buf_init(&packet, m_allocator, 5 + topic.size() + payload.len);
+        aws_byte_buf_append_byte_dynamic(&packet, MQTT_PUBLISH << 4);
+        s_writeRemainingLength(&packet, 2 + topic.size() + payload.len);
+        aws_byte_buf_append_byte_dynamic(&packet, static_cast<uint8_t>(topic.size() >> 8));
+        aws_byte_buf_append_byte_dynamic(&packet, static_cast<uint8_t>(topic.size() & 0xFF));
+        struct aws_byte_cursor topicCursor = aws_byte_cursor_from_array(topic.data(), topic.size());
+        aws_byte_buf_append_dynamic(&packet, &topicCursor);
+        aws_byte_buf_append_dynamic(&packet, &payload);
+
+        for (Session *session : targets)
+        {
+            if (aws_channel_thread_is_callers_thread(session->channel))
+            {
+                struct aws_channel *channel = session->channel;
+                session->Write(aws_byte_cursor_from_buf(&packet));
+                aws_channel_release_hold(channel);
+                continue;
+            }
+
+            auto *delivery = Aws::Crt::New<Session::DeliveryTask>(m_allocator);
+            delivery->session = session;
+            aws_byte_buf_init_copy(&delivery->packet, m_allocator, &packet);
+            aws_channel_task_init(&delivery->task, Session::s_deliver, delivery, "local_mqtt_broker_deliver");
+            aws_channel_schedule_task_now(session->channel, &delivery->task);
+        }
+        aws_byte_buf_clean_up(&packet);
+
+        m_deliveredCount.fetch_add(targets.size());
+        return targets.size();
+    }
+
+    size_t LocalMqttBroker::GetConnectionCount() const noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_sessionsMutex);
+        return m_sessions.size();
+    }
+
+    Aws::Crt::Vector<Aws::Crt::String> LocalMqttBroker::GetSubscribedFilters() const noexcept
+    {
+        Aws::Crt::Vector<Aws::Crt::String> filters;
+        const std::lock_guard<std::mutex> lock(m_sessionsMutex);
+        for (const Session *session : m_sessions)
+        {
+            filters.insert(filters.end(), session->filters.begin(), session->filters.end());
+        }
+        return filters;
+    }
+
+    bool LocalMqttBroker::TopicMatches(const Aws::Crt::String &filter, const Aws::Crt::String &topic) noexcept
+    {
+        /* Wildcards at the first level do not match topics reserved by the server, such as `$aws/...`. */
+        if (!topic.empty() && topic[0] == '$' && !filter.empty() && (filter[0] == '+' || filter[0] == '#'))
+        {
+            return false;
+        }
+
+        size_t filterPosition = 0;
+        size_t topicPosition = 0;
+        for (;;)
+        {
+            size_t filterEnd = filter.find('/', filterPosition);
+            size_t topicEnd = topic.find('/', topicPosition);
+            size_t filterLevelLength =
+                (filterEnd == Aws::Crt::String::npos ? filter.size() : filterEnd) - filterPosition;
+            size_t topicLevelLength = (topicEnd == Aws::Crt::String::npos ? topic.size() : topicEnd) - topicPosition;
+
+            if (filterLevelLength == 1 && filter[filterPosition] == '#')
+            {
+                return true;
+            }
+            bool singleLevelWildcard = filterLevelLength == 1 && filter[filterPosition] == '+';
+            if (!singleLevelWildcard &&
+                filter.compare(filterPosition, filterLevelLength, topic, topicPosition, topicLevelLength) != 0)
+            {
+                return false;
+            }
+
+            if (filterEnd == Aws::Crt::String::npos)
+            {
+                return topicEnd == Aws::Crt::String::npos;
+            }
+            if (topicEnd == Aws::Crt::String::npos)
+            {
+                /* `a/#` also matches `a`. */
+                return filter.compare(filterEnd + 1, Aws::Crt::String::npos, "#") == 0;
+            }
+            filterPosition = filterEnd + 1;
+            topicPosition = topicEnd + 1;
+        }
+    }
+
+    void LocalMqttBroker::s_onIncomingChannelSetup(
+        struct aws_server_bootstrap *bootstrap,
+        int errorCode,
+        struct aws_channel *channel,
+        void *userData)
+    {
+        (void)bootstrap;
+        if (errorCode)
+        {
+            return;
+        }
+
+        auto *broker = static_cast<LocalMqttBroker *>(userData);
+        struct aws_channel_slot *slot = aws_channel_slot_new(channel);
+        if (slot == nullptr)
+        {
+            aws_channel_shutdown(channel, aws_last_error());
+            return;
+        }
+
+        auto *session = Aws::Crt::New<Session>(broker->m_allocator);
+        session->broker = broker;
+        session->channel = channel;
+        session->slot = slot;
+        session->connected = false;
+        session->registered = false;
+        aws_byte_buf_init(&session->readBuffer, broker->m_allocator, 1024);
+        AWS_ZERO_STRUCT(session->handler);
+        session->handler.vtable = &Session::s_handlerVtable;
+        session->handler.alloc = broker->m_allocator;
+        session->handler.impl = session;
+
+        {
+            const std::lock_guard<std::mutex> lock(broker->m_sessionsMutex);
+            session->position = broker->m_sessions.insert(broker->m_sessions.end(), session);
+            session->registered = true;
+            broker->m_liveSessions += 1;
+        }
+
+        aws_channel_slot_insert_end(channel, slot);
+        aws_channel_slot_set_handler(slot, &session->handler);
+    }
+
+    void LocalMqttBroker::s_onIncomingChannelShutdown(
+        struct aws_server_bootstrap *bootstrap,
+        int errorCode,
+        struct aws_channel *channel,
+        void *userData)
+    {
+        /* The session has already been removed when its handler was shut down. */
+        (void)bootstrap;
+        (void)errorCode;
+        (void)channel;
+        (void)userData;
+    }
+
+    void LocalMqttBroker::s_onListenerDestroy(struct aws_server_bootstrap *bootstrap, void *userData)
+    {
+        (void)bootstrap;
+        auto *broker = static_cast<LocalMqttBroker *>(userData);
+        broker->m_listenerDestroyedPromise.set_value();
+    }
+
+    void LocalMqttBroker::Subscribe(Session *session, const Aws::Crt::String &filter) noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_sessionsMutex);
+        if (!session->registered ||
+            std::find(session->filters.begin(), session->filters.end(), filter) != session->filters.end())
+        {
+            return;
+        }
+
+        session->filters.push_back(filter);
+        if (filter.find_first_of("+#") == Aws::Crt::String::npos)
+        {
+            m_exactSubscriptions[filter].push_back(session);
+        }
+        else
+        {
+            m_wildcardSubscriptions.push_back({filter, session});
+        }
+    }
+
+    void LocalMqttBroker::Unsubscribe(Session *session, const Aws::Crt::String &filter) noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_sessionsMutex);
+        auto sessionFilter = std::find(session->filters.begin(), session->filters.end(), filter);
+        if (sessionFilter == session->filters.end())
+        {
+            return;
+        }
+        session->filters.erase(sessionFilter);
+
+        auto exact = m_exactSubscriptions.find(filter);
+        if (exact != m_exactSubscriptions.end())
+        {
+            auto &sessions = exact->second;
+            sessions.erase(std::remove(sessions.begin(), sessions.end(), session), sessions.end());
+            if (sessions.empty())
+            {
+                m_exactSubscriptions.erase(exact);
+            }
+            return;
+        }
+
+        m_wildcardSubscriptions.erase(
+            std::remove_if(
+                m_wildcardSubscriptions.begin(),
+                m_wildcardSubscriptions.end(),
+                [session, &filter](const Subscription &subscription) {
+                    return subscription.session == session && subscription.filter == filter;
+                }),
+            m_wildcardSubscriptions.end());
+    }
+
+    void LocalMqttBroker::RemoveSession(Session *session) noexcept
+    {
+        Aws::Crt::Vector<Aws::Crt::String> filters;
+        {
+            const std::lock_guard<std::mutex> lock(m_sessionsMutex);
+            filters = session->filters;
+        }
+        for (const Aws::Crt::String &filter : filters)
+        {
+            Unsubscribe(session, filter);
+        }
+
+        const std::lock_guard<std::mutex> lock(m_sessionsMutex);
+        if (session->registered)
+        {
+            m_sessions.erase(session->position);
+            session->registered = false;
+        }
+    }
+
+    void LocalMqttBroker::OnClientPublished(const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) noexcept
+    {
+        m_receivedCount.fetch_add(1);
+
+        Aws::Crt::Vector<OnClientPublish> handlers;
+        {
+            const std::lock_guard<std::mutex> lock(m_sessionsMutex);
+            for (const PublishHandler &publishHandler : m_publishHandlers)
+            {
+                if (TopicMatches(publishHandler.filter, topic))
+                {
+                    handlers.push_back(publishHandler.handler);
+                }
+            }
+        }
+        for (const OnClientPublish &handler : handlers)
+        {
+            handler(topic, payload);
+        }
+
+        Publish(topic, payload);
+    }
+} // namespace Utils
@@ -0,0 +1,212 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Api.h>
+#include <aws/crt/Types.h>
+#include <aws/crt/io/Bootstrap.h>
+#include <aws/crt/io/EventLoopGroup.h>
+#include <aws/crt/io/SocketOptions.h>
+#include <aws/crt/mqtt/MqttClient.h>
+
+#include <aws/io/channel.h>
+#include <aws/io/channel_bootstrap.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+
+namespace Utils
+{
+    /**
+     * A minimal MQTT 3.1.1 broker that runs in-process on a local socket. It stands in for AWS IoT Core so that
+     * samples and service tests can be run and measured without network access.
+     *
+     * It supports what the SDK's clients use: CONNECT, SUBSCRIBE and UNSUBSCRIBE with `+` and `#` wildcards,
+     * PUBLISH at QoS 0, 1 and 2, PINGREQ and DISCONNECT. Messages are delivered to subscribers at QoS 0. There is no
+     * authentication, session persistence, retained or will messages.
+     */
+    class LocalMqttBroker
+    {
+      public:
+        /**
+         * Invoked on the publishing connection's event loop thread for each message that a client publishes to a
+         * topic matching the handler's filter.
+         */
+        using OnClientPublish =
+            std::function<void(const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload)>;
+
+        LocalMqttBroker(
+            Aws::Crt::Io::EventLoopGroup &eventLoopGroup,
+            Aws::Crt::Allocator *allocator = Aws::Crt::g_allocator) noexcept;
+        ~LocalMqttBroker() noexcept;
+        LocalMqttBroker(const LocalMqttBroker &) = delete;
+        LocalMqttBroker &operator=(const LocalMqttBroker &) = delete;
+
+        /**
+         * Start listening.
+         * @param socketPath Path of the socket to listen on. A unique path is generated if this is empty.
+         * @return True if the broker is listening.
+         */
+        bool Start(const Aws::Crt::String &socketPath = Aws::Crt::String()) noexcept;
+
+        /**
+         * Stop listening, close every connection and wait for them to be torn down.
+         */
+        void Stop() noexcept;
+
+        /**
+         * Create a connection to this broker. It still has to be connected with `Connect`.
+         */
+        std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> NewConnection(
+            Aws::Crt::Mqtt::MqttClient &client) const noexcept;
+
+        /**
+         * Create a connection to this broker and connect it, waiting for the broker to accept it.
+         * @param protocolOperationTimeoutMs How long the connection waits for a publish to be acknowledged before
+         * failing it, or 0 to wait forever.
+         * @return The connection, or nullptr if it could not connect.
+         */
+        std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> Connect(
+            Aws::Crt::Mqtt::MqttClient &client,
+            const char *clientId,
+            uint32_t protocolOperationTimeoutMs = 0) const noexcept;
+
+        /**
+         * Disconnect a connection made with `Connect`, and wait for it to close.
+         */
+        static void Disconnect(Aws::Crt::Mqtt::MqttConnection &connection) noexcept;
+
+        /**
+         * Handle the messages that clients publish to topics matching a filter, in addition to delivering them to
+         * subscribers. This is how service emulators receive requests.
+         */
+        void AddPublishHandler(const Aws::Crt::String &topicFilter, OnClientPublish handler) noexcept;
+
+        /**
+         * A message a client published, as kept by `RecordPublishes`.
+         */
+        struct RecordedPublish
+        {
+            Aws::Crt::String topic;
+            Aws::Crt::String payload;
+            std::chrono::steady_clock::time_point receivedAt;
+        };
+
+        /**
+         * Keep the messages that clients publish to topics matching a filter, so that tests can check them.
+         */
+        void RecordPublishes(const Aws::Crt::String &topicFilter) noexcept;
+
+        /**
+         * Wait until at least `count` messages have been recorded.
+         * @return False if they were not recorded in time.
+         */
+        bool WaitForRecordedPublishes(size_t count, std::chrono::milliseconds timeout) const noexcept;
+
+        /**
+         * @return Every message recorded so far, oldest first.
+         */
+        Aws::Crt::Vector<RecordedPublish> GetRecordedPublishes() const noexcept;
+
+        /**
+         * Leave the next `count` QoS 1 messages that clients publish unacknowledged, so that the clients time them
+         * out. They are still delivered and handled.
+         */
+        void IgnorePublishes(size_t count) noexcept;
+
+        /**
+         * Deliver a message to every client subscribed to a matching filter. May be called from any thread.
+         * @return The number of subscriptions the message was delivered to.
+         */
+        size_t Publish(const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) noexcept;
+
+        /**
+         * @return The number of connected clients.
+         */
+        size_t GetConnectionCount() const noexcept;
+
+        /**
+         * @return The topic filters that connected clients are subscribed to, each client's in the order it
+         * subscribed to them.
+         */
+        Aws::Crt::Vector<Aws::Crt::String> GetSubscribedFilters() const noexcept;
+
+        /**
+         * @return The number of messages published by clients.
+         */
+        uint64_t GetReceivedCount() const noexcept { return m_receivedCount.load(); }
+
+        /**
+         * @return The number of messages delivered to subscribers.
+         */
+        uint64_t GetDeliveredCount() const noexcept { return m_deliveredCount.load(); }
+
+        /**
+         * @return True if `topic` matches the MQTT topic filter `filter`.
+         */
+        static bool TopicMatches(const Aws::Crt::String &filter, const Aws::Crt::String &topic) noexcept;
+
+      private:
+        struct Session;
+        struct Subscription
+        {
+            Aws::Crt::String filter;
+            Session *session;
+        };
+        struct PublishHandler
+        {
+            Aws::Crt::String filter;
+            OnClientPublish handler;
+        };
+
+        static void s_onIncomingChannelSetup(
+            struct aws_server_bootstrap *bootstrap,
+            int errorCode,
+            struct aws_channel *channel,
+            void *userData);
+        static void s_onIncomingChannelShutdown(
+            struct aws_server_bootstrap *bootstrap,
+            int errorCode,
+            struct aws_channel *channel,
+            void *userData);
+        static void s_onListenerDestroy(struct aws_server_bootstrap *bootstrap, void *userData);
+
+        void Subscribe(Session *session, const Aws::Crt::String &filter) noexcept;
+        void Unsubscribe(Session *session, const Aws::Crt::String &filter) noexcept;
+        void RemoveSession(Session *session) noexcept;
+        void OnClientPublished(const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) noexcept;
+        bool TakeIgnoredPublish() noexcept;
+
+        Aws::Crt::Allocator *m_allocator;
+        Aws::Crt::Io::EventLoopGroup &m_eventLoopGroup;
+        Aws::Crt::String m_socketPath;
+        Aws::Crt::Io::SocketOptions m_socketOptions;
+        struct aws_server_bootstrap *m_serverBootstrap;
+        struct aws_socket *m_listener;
+        std::promise<void> m_listenerDestroyedPromise;
+        std::atomic<uint64_t> m_receivedCount;
+        std::atomic<uint64_t> m_deliveredCount;
+        std::atomic<size_t> m_publishesToIgnore;
+
+        /* Protects the recorded publishes. */
+        mutable std::mutex m_recordedMutex;
+        mutable std::condition_variable m_recordedSignal;
+        Aws::Crt::Vector<RecordedPublish> m_recordedPublishes;
+
+        /* Protects the sessions, subscriptions and publish handlers, which are used from every event loop. */
+        mutable std::mutex m_sessionsMutex;
+        std::condition_variable m_sessionsClosedSignal;
+        size_t m_liveSessions;
+        Aws::Crt::List<Session *> m_sessions;
+        /* Subscriptions without wildcards are looked up by topic; the others are matched one by one. */
+        Aws::Crt::Map<Aws::Crt::String, Aws::Crt::Vector<Session *>> m_exactSubscriptions;
+        Aws::Crt::Vector<Subscription> m_wildcardSubscriptions;
+        Aws::Crt::Vector<PublishHandler> m_publishHandlers;
+    };
+} // namespace Utils
@@ -0,0 +1,339 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include "ShadowServiceEmulator.h"
+
+#include <chrono>
+
+namespace Utils
+{
+    static bool s_isEmpty(const Aws::Crt::JsonView &view)
+    {
+        return !view.IsObject() || view.GetAllObjects().empty();
+    }
+
+    /* Applies a partial document to a state the way the shadow service does: null values remove keys. */
+    static Aws::Crt::JsonObject s_merge(const Aws::Crt::JsonView &current, const Aws::Crt::JsonView &update)
+    {
+        Aws::Crt::JsonObject merged;
+        Aws::Crt::Map<Aws::Crt::String, Aws::Crt::JsonView> updateValues = update.GetAllObjects();
+        if (current.IsObject())
+        {
+            for (const auto &value : current.GetAllObjects())
+            {
+                if (updateValues.find(value.first) == updateValues.end())
+                {
+                    merged.WithObject(value.first, value.second.Materialize());
+                }
+            }
+        }
+
+        for (const auto &value : updateValues)
+        {
+            if (value.second.IsNull())
+            {
+                continue;
+            }
+            if (value.second.IsObject() && current.IsObject() && current.ValueExists(value.first))
+            {
+                merged.WithObject(value.first, s_merge(current.GetJsonObject(value.first), value.second));
+            }
+            else
+            {
+                merged.WithObject(value.first, value.second.Materialize());
+            }
+        }
+        return merged;
+    }
+
+    /* The parts of the desired state that differ from the reported state. */
+    static Aws::Crt::JsonObject s_delta(
+        const Aws::Crt::JsonView &desired,
+        const Aws::Crt::JsonView &reported,
+        bool &hasDelta)
+    {
+        Aws::Crt::JsonObject delta;
+        hasDelta = false;
+        if (!desired.IsObject())
+        {
+            return delta;
+        }
+
+        for (const auto &value : desired.GetAllObjects())
+        {
+            if (!reported.IsObject() || !reported.ValueExists(value.first))
+            {
+                delta.WithObject(value.first, value.second.Materialize());
+                hasDelta = true;
+                continue;
+            }
+
+            Aws::Crt::JsonView reportedValue = reported.GetJsonObject(value.first);
+            if (value.second.IsObject() && reportedValue.IsObject())
+            {
+                bool hasNestedDelta = false;
+                Aws::Crt::JsonObject nestedDelta = s_delta(value.second, reportedValue, hasNestedDelta);
+                if (hasNestedDelta)
+                {
+                    delta.WithObject(value.first, std::move(nestedDelta));
+                    hasDelta = true;
+                }
+            }
+            else if (value.second.WriteCompact(false) != reportedValue.WriteCompact(false))
+            {
+                delta.WithObject(value.first, value.second.Materialize());
+                hasDelta = true;
+            }
+        }
+        return delta;
+    }
+
+    static int64_t s_timestamp()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /* Every response carries a timestamp and echoes the request's client token. */
+    static Aws::Crt::JsonObject s_newResponse(const Aws::Crt::JsonView &request)
+    {
+        Aws::Crt::JsonObject response;
+        response.WithInt64("timestamp", s_timestamp());
+        if (request.IsObject() && request.ValueExists("clientToken"))
+        {
+            response.WithString("clientToken", request.GetString("clientToken"));
+        }
+        return response;
+    }
+
+    static Aws::Crt::JsonObject s_stateObject(const Aws::Crt::JsonView &desired, const Aws::Crt::JsonView &reported)
+    {
+        Aws::Crt::JsonObject state;
+        if (!s_isEmpty(desired))
+        {
+            state.WithObject("desired", desired.Materialize());
+        }
+        if (!s_isEmpty(reported))
+        {
+            state.WithObject("reported", reported.Materialize());
+        }
+        return state;
+    }
+
+    ShadowServiceEmulator::ShadowServiceEmulator(LocalMqttBroker &broker) noexcept
+        : m_broker(broker), m_acceptedUpdateCount(0), m_deltaCount(0)
+    {
+        m_broker.AddPublishHandler(
+            "$aws/things/+/shadow/#",
+            [this](const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) { OnRequest(topic, payload); });
+    }
+
+    uint64_t ShadowServiceEmulator::GetVersion(
+        const Aws::Crt::String &thingName,
+        const Aws::Crt::String &shadowName) const noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_shadowsMutex);
+        auto shadow = m_shadows.find(thingName + "/" + shadowName);
+        return (shadow != m_shadows.end() && shadow->second.exists) ? shadow->second.version : 0;
+    }
+
+    uint64_t ShadowServiceEmulator::GetAcceptedUpdateCount() const noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_shadowsMutex);
+        return m_acceptedUpdateCount;
+    }
+
+    uint64_t ShadowServiceEmulator::GetDeltaCount() const noexcept
+    {
+        const std::lock_guard<std::mutex> lock(m_shadowsMutex);
+        return m_deltaCount;
+    }
+
+    void ShadowServiceEmulator::OnRequest(const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) noexcept
+    {
+        /* $aws/things/<thingName>/shadow/[name/<shadowName>/]<operation> */
+        static const Aws::Crt::String thingsPrefix("$aws/things/");
+        size_t thingEnd = topic.find('/', thingsPrefix.size());
+        if (topic.compare(0, thingsPrefix.size(), thingsPrefix) != 0 || thingEnd == Aws::Crt::String::npos ||
+            topic.compare(thingEnd, 8, "/shadow/") != 0)
+        {
+            return;
+        }
+        Aws::Crt::String thingName = topic.substr(thingsPrefix.size(), thingEnd - thingsPrefix.size());
+        size_t operationStart = thingEnd + 8;
+
+        Aws::Crt::String shadowName;
+        if (topic.compare(operationStart, 5, "name/") == 0)
+        {
+            size_t nameEnd = topic.find('/', operationStart + 5);
+            if (nameEnd == Aws::Crt::String::npos)
+            {
+                return;
+            }
+            shadowName = topic.substr(operationStart + 5, nameEnd - operationStart - 5);
+            operationStart = nameEnd + 1;
+        }
+
+        /* Clients may publish to other shadow topics too, but only requests are answered. */
+        Aws::Crt::String operation = topic.substr(operationStart);
+        if (operation != "get" && operation != "update" && operation != "delete")
+        {
+            return;
+        }
+
+        Aws::Crt::JsonObject request(Aws::Crt::String(reinterpret_cast<const char *>(payload.ptr), payload.len));
+        if (!request.WasParseSuccessful() || !request.View().IsObject())
+        {
+            Reject(topic, 400, "Payload contains invalid json", Aws::Crt::JsonObject().View());
+            return;
+        }
+
+        const std::lock_guard<std::mutex> lock(m_shadowsMutex);
+        Shadow &shadow = m_shadows[thingName + "/" + shadowName];
+        if (operation == "get")
+        {
+            OnGet(topic, shadow, request.View());
+        }
+        else if (operation == "update")
+        {
+            OnUpdate(topic, shadow, request.View());
+        }
+        else
+        {
+            OnDelete(topic, shadow, request.View());
+        }
+    }
+
+    void ShadowServiceEmulator::OnGet(
+        const Aws::Crt::String &responseTopic,
+        Shadow &shadow,
+        Aws::Crt::JsonView request) noexcept
+    {
+        if (!shadow.exists)
+        {
+            Reject(responseTopic, 404, "No shadow exists with name", request);
+            return;
+        }
+
+        Aws::Crt::JsonObject state = s_stateObject(shadow.desired.View(), shadow.reported.View());
+        bool hasDelta = false;
+        Aws::Crt::JsonObject delta = s_delta(shadow.desired.View(), shadow.reported.View(), hasDelta);
+        if (hasDelta)
+        {
+            state.WithObject("delta", std::move(delta));
+        }
+
+        Aws::Crt::JsonObject response = s_newResponse(request);
+        response.WithObject("state", std::move(state));
+        response.WithInt64("version", static_cast<int64_t>(shadow.version));
+        Publish(responseTopic + "/accepted", response);
+    }
+
+    void ShadowServiceEmulator::OnUpdate(
+        const Aws::Crt::String &responseTopic,
+        Shadow &shadow,
+        Aws::Crt::JsonView request) noexcept
+    {
+        if (!request.ValueExists("state") || !request.GetJsonObject("state").IsObject())
+        {
+            Reject(responseTopic, 400, "Missing required node: state", request);
+            return;
+        }
+        if (request.ValueExists("version") && shadow.exists &&
+            static_cast<uint64_t>(request.GetInt64("version")) != shadow.version)
+        {
+            Reject(responseTopic, 409, "Version conflict", request);
+            return;
+        }
+
+        Aws::Crt::JsonObject previous;
+        if (shadow.exists)
+        {
+            previous.WithObject("state", s_stateObject(shadow.desired.View(), shadow.reported.View()));
+            previous.WithInt64("version", static_cast<int64_t>(shadow.version));
+        }
+
+        Aws::Crt::JsonView state = request.GetJsonObject("state");
+        bool desiredUpdated = state.KeyExists("desired");
+        if (desiredUpdated)
+        {
+            shadow.desired = s_merge(shadow.desired.View(), state.GetJsonObject("desired"));
+        }
+        if (state.KeyExists("reported"))
+        {
+            shadow.reported = s_merge(shadow.reported.View(), state.GetJsonObject("reported"));
+        }
+        shadow.exists = true;
+        shadow.version += 1;
+        m_acceptedUpdateCount += 1;
+
+        Aws::Crt::JsonObject accepted = s_newResponse(request);
+        accepted.WithObject("state", state.Materialize());
+        accepted.WithInt64("version", static_cast<int64_t>(shadow.version));
+        Publish(responseTopic + "/accepted", accepted);
+
+        Aws::Crt::JsonObject current;
+        current.WithObject("state", s_stateObject(shadow.desired.View(), shadow.reported.View()));
+        current.WithInt64("version", static_cast<int64_t>(shadow.version));
+        Aws::Crt::JsonObject documents = s_newResponse(request);
+        if (!s_isEmpty(previous.View()))
+        {
+            documents.WithObject("previous", std::move(previous));
+        }
+        documents.WithObject("current", std::move(current));
+        Publish(responseTopic + "/documents", documents);
+
+        bool hasDelta = false;
+        Aws::Crt::JsonObject delta = s_delta(shadow.desired.View(), shadow.reported.View(), hasDelta);
+        if (desiredUpdated && hasDelta)
+        {
+            Aws::Crt::JsonObject deltaEvent = s_newResponse(request);
+            deltaEvent.WithObject("state", std::move(delta));
+            deltaEvent.WithInt64("version", static_cast<int64_t>(shadow.version));
+            Publish(responseTopic + "/delta", deltaEvent);
+            m_deltaCount += 1;
+        }
+    }
+
+    void ShadowServiceEmulator::OnDelete(
+        const Aws::Crt::String &responseTopic,
+        Shadow &shadow,
+        Aws::Crt::JsonView request) noexcept
+    {
+        if (!shadow.exists)
+        {
+            Reject(responseTopic, 404, "No shadow exists with name", request);
+            return;
+        }
+
+        /* The version is kept, so that a shadow created again continues from it. */
+        shadow.exists = false;
+        shadow.desired = Aws::Crt::JsonObject();
+        shadow.reported = Aws::Crt::JsonObject();
+
+        Aws::Crt::JsonObject response = s_newResponse(request);
+        response.WithInt64("version", static_cast<int64_t>(shadow.version));
+        Publish(responseTopic + "/accepted", response);
+    }
+
+    void ShadowServiceEmulator::Reject(
+        const Aws::Crt::String &responseTopic,
+        int code,
+        const Aws::Crt::String &message,
+        Aws::Crt::JsonView request) noexcept
+    {
+        Aws::Crt::JsonObject response = s_newResponse(request);
+        response.WithInteger("code", code);
+        response.WithString("message", message);
+        Publish(responseTopic + "/rejected", response);
+    }
+
+    void ShadowServiceEmulator::Publish(const Aws::Crt::String &topic, const Aws::Crt::JsonObject &document) noexcept
+    {
+        Aws::Crt::String payload = document.View().WriteCompact(true);
+        m_broker.Publish(
+            topic, Aws::Crt::ByteCursorFromArray(reinterpret_cast<const uint8_t *>(payload.data()), payload.size()));
+    }
+} // namespace Utils
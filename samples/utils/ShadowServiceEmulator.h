@@ -0,0 +1,76 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "LocalMqttBroker.h"
+
+#include <aws/crt/JsonObject.h>
+
+#include <mutex>
+
+namespace Utils
+{
+    /**
+     * Emulates the AWS IoT Device Shadow service on a LocalMqttBroker.
+     *
+     * It answers get, update and delete requests for classic and named shadows on the `$aws/things/+/shadow/...`
+     * topics, on the request's `accepted` and `rejected` topics. Updates publish `update/documents` and, when the
+     * desired state differs from the reported state, `update/delta`. Shadows are versioned, and an update with a
+     * `version` other than the current one is rejected with code 409. Metadata is not tracked.
+     */
+    class ShadowServiceEmulator
+    {
+      public:
+        explicit ShadowServiceEmulator(LocalMqttBroker &broker) noexcept;
+        ShadowServiceEmulator(const ShadowServiceEmulator &) = delete;
+        ShadowServiceEmulator &operator=(const ShadowServiceEmulator &) = delete;
+
+        /**
+         * @param thingName The thing the shadow belongs to.
+         * @param shadowName The name of a named shadow, or empty for the classic shadow.
+         * @return The version of the shadow, or 0 if it does not exist.
+         */
+        uint64_t GetVersion(const Aws::Crt::String &thingName, const Aws::Crt::String &shadowName) const noexcept;
+
+        /**
+         * @return The number of update requests that were accepted.
+         */
+        uint64_t GetAcceptedUpdateCount() const noexcept;
+
+        /**
+         * @return The number of delta events published.
+         */
+        uint64_t GetDeltaCount() const noexcept;
+
+      private:
+        struct Shadow
+        {
+            bool exists = false;
+            uint64_t version = 0;
+            Aws::Crt::JsonObject desired;
+            Aws::Crt::JsonObject reported;
+        };
+
+        void OnRequest(const Aws::Crt::String &topic, const Aws::Crt::ByteCursor &payload) noexcept;
+        void OnGet(const Aws::Crt::String &responseTopic, Shadow &shadow, Aws::Crt::JsonView request) noexcept;
+        void OnUpdate(const Aws::Crt::String &responseTopic, Shadow &shadow, Aws::Crt::JsonView request) noexcept;
+        void OnDelete(const Aws::Crt::String &responseTopic, Shadow &shadow, Aws::Crt::JsonView request) noexcept;
+        void Reject(
+            const Aws::Crt::String &responseTopic,
+            int code,
+            const Aws::Crt::String &message,
+            Aws::Crt::JsonView request) noexcept;
+        void Publish(const Aws::Crt::String &topic, const Aws::Crt::JsonObject &document) noexcept;
+
+        LocalMqttBroker &m_broker;
+
+        /* Requests are handled on the event loop of each client's connection. */
+        mutable std::mutex m_shadowsMutex;
+        /* Keyed by `<thingName>/<shadowName>`, where the classic shadow has an empty name. */
+        Aws::Crt::Map<Aws::Crt::String, Shadow> m_shadows;
+        uint64_t m_acceptedUpdateCount;
+        uint64_t m_deltaCount;
+    };
+} // namespace Utils
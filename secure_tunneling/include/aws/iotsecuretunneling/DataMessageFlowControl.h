@@ -0,0 +1,123 @@
+#pragma once
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotdevice/secure_tunneling.h>
+#include <aws/iotsecuretunneling/Exports.h>
+
+#include <functional>
+#include <mutex>
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        /**
+         * The send window and message coalescing of a SecureTunnel's data messages. See
+         * SecureTunnelBuilder::WithSendWindow and SecureTunnelBuilder::WithMessageCoalescing.
+         *
+         * Messages are handed to the secure tunnel through a callback, and every message handed to it must be
+         * reported back to OnSendComplete once written, in the order they were handed over.
+         */
+        class AWS_IOTSECURETUNNELING_API DataMessageFlowControl final
+        {
+          public:
+            /**
+             * Queues a data message with the secure tunnel, which copies its payload.
+             * @return AWS_OP_SUCCESS, or AWS_OP_ERR with the error raised.
+             */
+            using SendMessage = std::function<int(const aws_secure_tunnel_message_view &message)>;
+
+            /**
+             * @param highWatermark Bytes that may be waiting to be sent, or 0 for no limit.
+             * @param lowWatermark Bytes waiting to be sent at which the send window is reported available again.
+             * @param coalescedFrameSize Largest payload of a coalesced message, or 0 to not coalesce.
+             * @param sendMessage Called with the flow control locked, so it must not call back into it.
+             */
+            DataMessageFlowControl(
+                size_t highWatermark,
+                size_t lowWatermark,
+                size_t coalescedFrameSize,
+                SendMessage sendMessage,
+                Crt::Allocator *allocator = Crt::ApiAllocator()) noexcept;
+            ~DataMessageFlowControl();
+            DataMessageFlowControl(const DataMessageFlowControl &) = delete;
+            DataMessageFlowControl &operator=(const DataMessageFlowControl &) = delete;
+
+            /**
+             * The calls to Send that a call into the flow control has finished with. Every call to Send that succeeds
+             * is counted exactly once, as written or as failed, so its caller can be told of each one.
+             */
+            struct Completions
+            {
+                /* Sends whose payload the secure tunnel has written. */
+                size_t written = 0;
+                /* Sends held back that the secure tunnel refused, and the error it raised. */
+                size_t failed = 0;
+                int errorCode = AWS_ERROR_SUCCESS;
+            };
+
+            /**
+             * Send a data message, or hold it back to go out with later messages on the same connection.
+             * @param completions Counts the messages held back earlier that could not be sent.
+             * @return AWS_OP_SUCCESS, or AWS_OP_ERR with the error raised. The error is AWS_ERROR_INVALID_STATE if the
+             * message does not fit in the send window.
+             */
+            int Send(const aws_secure_tunnel_message_view &message, Completions &completions) noexcept;
+
+            /**
+             * Account for the oldest message sent having been written, and send whatever was held back meanwhile.
+             * @param completions Counts the sends the written message carried, and those held back that could not be
+             * sent.
+             * @param sendWindow Set to the send window if it has become available again.
+             * @return True if the send window was full and has fallen to the low watermark.
+             */
+            bool OnSendComplete(Completions &completions, size_t &sendWindow) noexcept;
+
+            /**
+             * @return The bytes that may still be sent before the send window is full, or SIZE_MAX if there is no
+             * send window.
+             */
+            size_t GetSendWindow() noexcept;
+
+          private:
+            /* Data messages are coalesced per service id and connection id. */
+            using CoalescingKey = std::pair<Crt::String, uint32_t>;
+
+            /* A message passed to the secure tunnel, or held back, and how many calls to Send it carries. */
+            struct SendInFlight
+            {
+                size_t bytes;
+                size_t sends;
+            };
+            struct Coalesced
+            {
+                Crt::ByteBuf payload;
+                size_t sends;
+            };
+
+            int SendLocked(const aws_secure_tunnel_message_view &message, size_t sends);
+            void FlushLocked(Crt::Map<CoalescingKey, Coalesced>::iterator coalesced, Completions &completions);
+            size_t GetBytesOutstandingLocked() const;
+
+            size_t m_highWatermark;
+            size_t m_lowWatermark;
+            size_t m_coalescedFrameSize;
+            SendMessage m_sendMessage;
+            Crt::Allocator *m_allocator;
+
+            /* This mutex protects everything below it. */
+            std::mutex m_lock;
+            /* The data messages being written, in the order they were passed to the secure tunnel. */
+            Crt::List<SendInFlight> m_sendsInFlight;
+            size_t m_bytesInFlight;
+            /* Payloads waiting for the data message being written to complete before they are sent. */
+            Crt::Map<CoalescingKey, Coalesced> m_coalescing;
+            size_t m_bytesCoalesced;
+            bool m_sendWindowFull;
+        };
+    } // namespace Iotsecuretunneling
+} // namespace Aws
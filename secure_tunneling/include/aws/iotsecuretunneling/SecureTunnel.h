@@ -8,8 +8,10 @@
 #include <aws/crt/io/Bootstrap.h>
 #include <aws/crt/io/SocketOptions.h>
 #include <aws/iotdevice/secure_tunneling.h>
+#include <aws/iotsecuretunneling/DataMessageFlowControl.h>
 #include <aws/iotsecuretunneling/Exports.h>
 
+#include <atomic>
 #include <future>
 
 namespace Aws
@@ -559,6 +561,12 @@ namespace Aws
          */
         using OnStopped = std::function<void(SecureTunnel *secureTunnel)>;
 
+        /**
+         * Type signature of the callback invoked when the send window opens up again, after SendMessage refused a
+         * message or the bytes waiting to be sent went over the high watermark.
+         */
+        using OnSendWindowAvailable = std::function<void(SecureTunnel *secureTunnel, size_t sendWindow)>;
+
         /**
          * Deprecated - OnConnectionSuccess and OnConnectionFailure
          */
@@ -770,6 +778,42 @@ namespace Aws
              */
             SecureTunnelBuilder &WithOnStopped(OnStopped onStopped);
 
+            /**
+             * Limits how many bytes of data messages may be waiting to be sent. Once the bytes passed to SendMessage
+             * but not yet written would go over highWatermark, SendMessage refuses further messages with
+             * AWS_ERROR_INVALID_STATE. The OnSendWindowAvailable callback is invoked once the waiting bytes fall to
+             * lowWatermark. By default there is no limit.
+             *
+             * @param highWatermark Bytes that may be waiting to be sent, or 0 for no limit.
+             * @param lowWatermark Bytes waiting to be sent at which the send window is reported available again.
+             *
+             * @return this builder object
+             */
+            SecureTunnelBuilder &WithSendWindow(size_t highWatermark, size_t lowWatermark);
+
+            /**
+             * Setup callback handler trigged when the send window opens up again.
+             *
+             * @param onSendWindowAvailable
+             *
+             * @return this builder object
+             */
+            SecureTunnelBuilder &WithOnSendWindowAvailable(OnSendWindowAvailable onSendWindowAvailable);
+
+            /**
+             * Coalesces small data messages. While a data message is being written, later messages smaller than
+             * frameSize are appended to a single message per service id and connection id, which is sent once the
+             * write completes or once it reaches frameSize bytes. OnSendMessageComplete is still invoked once per call
+             * to SendMessage, when the message carrying its payload is written. By default messages are not
+             * coalesced.
+             *
+             * @param frameSize Largest payload of a coalesced message, or 0 to not coalesce. It is capped at the
+             * largest payload the secure tunnel service accepts.
+             *
+             * @return this builder object
+             */
+            SecureTunnelBuilder &WithMessageCoalescing(size_t frameSize);
+
             /**
              * Deprecated - Use WithOnMessageReceived()
              */
@@ -852,6 +896,21 @@ namespace Aws
              */
             Crt::Optional<Crt::Http::HttpClientConnectionProxyOptions> m_httpClientConnectionProxyOptions;
 
+            /**
+             * Bytes of data messages that may be waiting to be sent, or 0 for no limit.
+             */
+            size_t m_sendWindowHighWatermark;
+
+            /**
+             * Bytes waiting to be sent at which the send window is reported available again.
+             */
+            size_t m_sendWindowLowWatermark;
+
+            /**
+             * Largest payload of a coalesced data message, or 0 to not coalesce.
+             */
+            size_t m_coalescedFrameSize;
+
             /* Callbacks */
             /**
              * Callback handler trigged when secure tunnel establishes connection with secure tunnel service and
@@ -928,6 +987,11 @@ namespace Aws
              */
             OnStopped m_OnStopped;
 
+            /**
+             * Callback handler trigged when the send window opens up again.
+             */
+            OnSendWindowAvailable m_OnSendWindowAvailable;
+
             /**
              * Deprecated - Use m_OnConnectionSuccess and m_OnConnectionFailure
              */
@@ -1024,6 +1088,26 @@ namespace Aws
              */
             int SendMessage(std::shared_ptr<Message> messageOptions) noexcept;
 
+            /**
+             * Tells the secure tunnel to attempt to send a data message without first copying its payload into a
+             * Message. The payload is borrowed until this call returns, since the secure tunnel copies it into the
+             * operation it queues.
+             *
+             * @param serviceId: The service id to send the message on, or an empty cursor for none.
+             * @param connectionId: The connection id to send the message on, or 0 for none.
+             * @param payload: The payload of the message.
+             *
+             * @return success/failure in the synchronous logic that kicks off the Send Message operation
+             */
+            int SendMessage(Crt::ByteCursor serviceId, uint32_t connectionId, Crt::ByteCursor payload) noexcept;
+
+            /**
+             * How many more bytes of data messages SendMessage accepts before the send window is full.
+             *
+             * @return The bytes left in the send window, or SIZE_MAX if the secure tunnel has no send window.
+             */
+            size_t GetSendWindow() noexcept;
+
             /* SOURCE MODE ONLY */
             /**
              * Notifies the secure tunnel that you want to start a stream with the Destination device. This will result
@@ -1166,7 +1250,11 @@ namespace Aws
                 OnConnectionStarted onConnectionStarted,
                 OnConnectionReset onConnectionReset,
                 OnSessionReset onSessionReset,
-                OnStopped onStopped);
+                OnStopped onStopped,
+                size_t sendWindowHighWatermark,
+                size_t sendWindowLowWatermark,
+                size_t coalescedFrameSize,
+                OnSendWindowAvailable onSendWindowAvailable);
 
             /* Static Callbacks */
             static void s_OnMessageReceived(const struct aws_secure_tunnel_message_view *message, void *user_data);
@@ -1203,6 +1291,18 @@ namespace Aws
 
             void OnTerminationComplete();
 
+            /* The native secure tunnel's user data, which follows the SecureTunnel when it is moved. */
+            struct CallbackTarget
+            {
+                explicit CallbackTarget(SecureTunnel *tunnel) noexcept : secureTunnel(tunnel) {}
+                std::atomic<SecureTunnel *> secureTunnel;
+            };
+
+            static SecureTunnel *s_FromUserData(void *user_data);
+
+            void InvokeSendMessageComplete(enum aws_secure_tunnel_message_type type, int errorCode);
+            int SendDataMessage(const aws_secure_tunnel_message_view &message);
+
             /**
              * Callback handler trigged when secure tunnel receives a Message.
              */
@@ -1261,6 +1361,11 @@ namespace Aws
              */
             OnStopped m_OnStopped;
 
+            /**
+             * Callback handler trigged when the send window opens up again.
+             */
+            OnSendWindowAvailable m_OnSendWindowAvailable;
+
             aws_secure_tunnel *m_secure_tunnel;
             Crt::Allocator *m_allocator;
 
@@ -1287,6 +1392,13 @@ namespace Aws
 
             std::shared_ptr<SecureTunnel> m_selfRef;
 
+            /* Only set when there is a send window or coalescing. Held by pointer so that moves carry the sends in
+             * flight along with the secure tunnel. */
+            Crt::ScopedResource<DataMessageFlowControl> m_flowControl;
+
+            /* Given to the native secure tunnel instead of this, since the native callbacks outlive a move. */
+            Crt::ScopedResource<CallbackTarget> m_callbackTarget;
+
             friend class SecureTunnelBuilder;
         };
     } // namespace Iotsecuretunneling
@@ -0,0 +1,189 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotsecuretunneling/DataMessageFlowControl.h>
+
+#include <cstdint>
+
+namespace Aws
+{
+    namespace Iotsecuretunneling
+    {
+        DataMessageFlowControl::DataMessageFlowControl(
+            size_t highWatermark,
+            size_t lowWatermark,
+            size_t coalescedFrameSize,
+            SendMessage sendMessage,
+            Crt::Allocator *allocator) noexcept
+            : m_highWatermark(highWatermark), m_lowWatermark(lowWatermark), m_coalescedFrameSize(coalescedFrameSize),
+              m_sendMessage(std::move(sendMessage)), m_allocator(allocator), m_bytesInFlight(0), m_bytesCoalesced(0),
+              m_sendWindowFull(false)
+        {
+        }
+
+        DataMessageFlowControl::~DataMessageFlowControl()
+        {
+            for (auto &coalesced : m_coalescing)
+            {
+                aws_byte_buf_clean_up(&coalesced.second.payload);
+            }
+            m_coalescing.clear();
+        }
+
+        int DataMessageFlowControl::Send(
+            const aws_secure_tunnel_message_view &message,
+            Completions &completions) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            size_t length = message.payload != nullptr ? message.payload->len : 0;
+            size_t outstanding = GetBytesOutstandingLocked();
+
+            /* A message larger than the whole window is still accepted once nothing else is waiting. */
+            if (m_highWatermark > 0 && outstanding > 0 && outstanding + length > m_highWatermark)
+            {
+                m_sendWindowFull = true;
+                return aws_raise_error(AWS_ERROR_INVALID_STATE);
+            }
+
+            CoalescingKey key(
+                message.service_id != nullptr
+                    ? Crt::String(reinterpret_cast<const char *>(message.service_id->ptr), message.service_id->len)
+                    : Crt::String(),
+                message.connection_id);
+            auto coalesced = m_coalescing.find(key);
+
+            /* Small messages wait for the data message being written to complete, so that they go out together
+             * instead of each as its own frame. */
+            int result = AWS_OP_SUCCESS;
+            bool coalesce = m_coalescedFrameSize > 0 && length > 0 && length < m_coalescedFrameSize;
+            if (coalesce && !m_sendsInFlight.empty())
+            {
+                if (coalesced != m_coalescing.end() && coalesced->second.payload.len + length > m_coalescedFrameSize)
+                {
+                    FlushLocked(coalesced, completions);
+                    coalesced = m_coalescing.end();
+                }
+                if (coalesced == m_coalescing.end())
+                {
+                    Coalesced waiting;
+                    if (aws_byte_buf_init(&waiting.payload, m_allocator, m_coalescedFrameSize) != AWS_OP_SUCCESS)
+                    {
+                        return AWS_OP_ERR;
+                    }
+                    waiting.sends = 0;
+                    coalesced = m_coalescing.emplace(std::move(key), waiting).first;
+                }
+                aws_byte_buf_write_from_whole_cursor(&coalesced->second.payload, *message.payload);
+                coalesced->second.sends++;
+                m_bytesCoalesced += length;
+                if (coalesced->second.payload.len == m_coalescedFrameSize)
+                {
+                    FlushLocked(coalesced, completions);
+                }
+            }
+            else
+            {
+                /* Anything already waiting on the same connection goes first, so the payloads stay in order. */
+                if (coalesced != m_coalescing.end())
+                {
+                    FlushLocked(coalesced, completions);
+                }
+                result = SendLocked(message, 1);
+            }
+
+            if (m_highWatermark > 0 && GetBytesOutstandingLocked() >= m_highWatermark)
+            {
+                m_sendWindowFull = true;
+            }
+            return result;
+        }
+
+        bool DataMessageFlowControl::OnSendComplete(Completions &completions, size_t &sendWindow) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            /* Data messages complete in the order they were queued. A coalesced message completes every send it
+             * carries. */
+            if (!m_sendsInFlight.empty())
+            {
+                m_bytesInFlight -= m_sendsInFlight.front().bytes;
+                completions.written += m_sendsInFlight.front().sends;
+                m_sendsInFlight.pop_front();
+            }
+
+            /* Whatever was coalesced while this message was being written goes out now. */
+            while (!m_coalescing.empty())
+            {
+                FlushLocked(m_coalescing.begin(), completions);
+            }
+
+            size_t outstanding = GetBytesOutstandingLocked();
+            if (m_sendWindowFull && outstanding <= m_lowWatermark)
+            {
+                m_sendWindowFull = false;
+                sendWindow = m_highWatermark - outstanding;
+                return true;
+            }
+            return false;
+        }
+
+        size_t DataMessageFlowControl::GetSendWindow() noexcept
+        {
+            if (m_highWatermark == 0)
+            {
+                return SIZE_MAX;
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            size_t outstanding = GetBytesOutstandingLocked();
+            return outstanding < m_highWatermark ? m_highWatermark - outstanding : 0;
+        }
+
+        int DataMessageFlowControl::SendLocked(const aws_secure_tunnel_message_view &message, size_t sends)
+        {
+            if (m_sendMessage(message) != AWS_OP_SUCCESS)
+            {
+                return AWS_OP_ERR;
+            }
+
+            size_t length = message.payload != nullptr ? message.payload->len : 0;
+            m_sendsInFlight.push_back({length, sends});
+            m_bytesInFlight += length;
+            return AWS_OP_SUCCESS;
+        }
+
+        void DataMessageFlowControl::FlushLocked(
+            Crt::Map<CoalescingKey, Coalesced>::iterator coalesced,
+            Completions &completions)
+        {
+            CoalescingKey key = coalesced->first;
+            Crt::ByteBuf payload = coalesced->second.payload;
+            size_t sends = coalesced->second.sends;
+            m_coalescing.erase(coalesced);
+            m_bytesCoalesced -= payload.len;
+
+            Crt::ByteCursor serviceId = aws_byte_cursor_from_array(key.first.data(), key.first.size());
+            Crt::ByteCursor payloadCursor = aws_byte_cursor_from_buf(&payload);
+            aws_secure_tunnel_message_view message;
+            AWS_ZERO_STRUCT(message);
+            if (serviceId.len > 0)
+            {
+                message.service_id = &serviceId;
+            }
+            message.connection_id = key.second;
+            message.payload = &payloadCursor;
+
+            /* The secure tunnel copies the payload, so the buffer can go as soon as the message is queued. */
+            if (SendLocked(message, sends) != AWS_OP_SUCCESS)
+            {
+                completions.failed += sends;
+                completions.errorCode = aws_last_error();
+            }
+            aws_byte_buf_clean_up(&payload);
+        }
+
+        size_t DataMessageFlowControl::GetBytesOutstandingLocked() const { return m_bytesInFlight + m_bytesCoalesced; }
+    } // namespace Iotsecuretunneling
+} // namespace Aws
@@ -4,12 +4,19 @@
  */
 
 #include <aws/crt/Api.h>
+#include <aws/iotdevicecommon/Tracing.h>
 #include <aws/iotsecuretunneling/SecureTunnel.h>
 
+#include <algorithm>
+#include <cstdint>
+
 namespace Aws
 {
     namespace Iotsecuretunneling
     {
+        /* The largest payload the secure tunnel service accepts in one data message. */
+        static const size_t s_maxDataMessagePayloadSize = 63 * 1024;
+
         void setPacketByteBufOptional(
             Crt::Optional<Crt::ByteCursor> &optional,
             Crt::ByteBuf &optionalStorage,
@@ -321,7 +328,8 @@ namespace Aws
             aws_secure_tunneling_local_proxy_mode localProxyMode,
             const std::string &endpointHost) // Make a copy and save in this object
             : m_allocator(allocator), m_clientBootstrap(&clientBootstrap), m_socketOptions(socketOptions),
-              m_accessToken(accessToken), m_localProxyMode(localProxyMode), m_endpointHost(endpointHost), m_rootCa("")
+              m_accessToken(accessToken), m_localProxyMode(localProxyMode), m_endpointHost(endpointHost), m_rootCa(""),
+              m_sendWindowHighWatermark(0), m_sendWindowLowWatermark(0), m_coalescedFrameSize(0)
         {
         }
 
@@ -333,7 +341,8 @@ namespace Aws
             const std::string &endpointHost) // Make a copy and save in this object
             : m_allocator(allocator), m_clientBootstrap(Crt::ApiHandle::GetOrCreateStaticDefaultClientBootstrap()),
               m_socketOptions(socketOptions), m_accessToken(accessToken), m_localProxyMode(localProxyMode),
-              m_endpointHost(endpointHost), m_rootCa("")
+              m_endpointHost(endpointHost), m_rootCa(""), m_sendWindowHighWatermark(0), m_sendWindowLowWatermark(0),
+              m_coalescedFrameSize(0)
         {
         }
 
@@ -344,7 +353,8 @@ namespace Aws
             const std::string &endpointHost) // Make a copy and save in this object
             : m_allocator(allocator), m_clientBootstrap(Crt::ApiHandle::GetOrCreateStaticDefaultClientBootstrap()),
               m_socketOptions(Crt::Io::SocketOptions()), m_accessToken(accessToken), m_localProxyMode(localProxyMode),
-              m_endpointHost(endpointHost), m_rootCa("")
+              m_endpointHost(endpointHost), m_rootCa(""), m_sendWindowHighWatermark(0), m_sendWindowLowWatermark(0),
+              m_coalescedFrameSize(0)
         {
         }
 
@@ -434,6 +444,26 @@ namespace Aws
             return *this;
         }
 
+        SecureTunnelBuilder &SecureTunnelBuilder::WithSendWindow(size_t highWatermark, size_t lowWatermark)
+        {
+            m_sendWindowHighWatermark = highWatermark;
+            m_sendWindowLowWatermark = lowWatermark;
+            return *this;
+        }
+
+        SecureTunnelBuilder &SecureTunnelBuilder::WithOnSendWindowAvailable(
+            OnSendWindowAvailable onSendWindowAvailable)
+        {
+            m_OnSendWindowAvailable = std::move(onSendWindowAvailable);
+            return *this;
+        }
+
+        SecureTunnelBuilder &SecureTunnelBuilder::WithMessageCoalescing(size_t frameSize)
+        {
+            m_coalescedFrameSize = frameSize;
+            return *this;
+        }
+
         SecureTunnelBuilder &SecureTunnelBuilder::WithClientToken(const std::string &clientToken)
         {
             m_clientToken = clientToken;
@@ -499,7 +529,11 @@ namespace Aws
                 m_OnConnectionStarted,
                 m_OnConnectionReset,
                 m_OnSessionReset,
-                m_OnStopped));
+                m_OnStopped,
+                m_sendWindowHighWatermark,
+                m_sendWindowLowWatermark,
+                m_coalescedFrameSize,
+                m_OnSendWindowAvailable));
 
             if (tunnel->m_secure_tunnel == nullptr)
             {
@@ -545,7 +579,11 @@ namespace Aws
             OnConnectionStarted onConnectionStarted,
             OnConnectionReset onConnectionReset,
             OnSessionReset onSessionReset,
-            OnStopped onStopped)
+            OnStopped onStopped,
+            size_t sendWindowHighWatermark,
+            size_t sendWindowLowWatermark,
+            size_t coalescedFrameSize,
+            OnSendWindowAvailable onSendWindowAvailable)
         {
             // Client callbacks
             m_OnConnectionSuccess = std::move(onConnectionSuccess);
@@ -558,11 +596,13 @@ namespace Aws
             m_OnDataReceive = std::move(onDataReceive);
             m_OnStreamStarted = std::move(onStreamStarted);
             m_OnStreamStart = std::move(onStreamStart);
+            m_OnStreamStopped = std::move(onStreamStopped);
             m_OnStreamReset = std::move(onStreamReset);
             m_OnConnectionStarted = std::move(onConnectionStarted);
             m_OnConnectionReset = std::move(onConnectionReset);
             m_OnSessionReset = std::move(onSessionReset);
             m_OnStopped = std::move(onStopped);
+            m_OnSendWindowAvailable = std::move(onSendWindowAvailable);
 
             // Initialize aws_secure_tunnel_options
             aws_secure_tunnel_options config;
@@ -599,7 +639,16 @@ namespace Aws
             config.on_session_reset = s_OnSessionReset;
             config.on_stopped = s_OnStopped;
 
-            config.user_data = this;
+            m_allocator = allocator;
+            m_secure_tunnel = nullptr;
+            m_callbackTarget = Crt::ScopedResource<CallbackTarget>(
+                Crt::New<CallbackTarget>(allocator, this),
+                [allocator](CallbackTarget *callbackTarget) { Crt::Delete(callbackTarget, allocator); });
+            if (!m_callbackTarget)
+            {
+                return;
+            }
+            config.user_data = m_callbackTarget.get();
 
             aws_http_proxy_options temp;
             AWS_ZERO_STRUCT(temp);
@@ -611,7 +660,22 @@ namespace Aws
 
             // Create the secure tunnel
             m_secure_tunnel = aws_secure_tunnel_new(allocator, &config);
-            m_allocator = allocator;
+
+            if (m_secure_tunnel != nullptr && (sendWindowHighWatermark > 0 || coalescedFrameSize > 0))
+            {
+                aws_secure_tunnel *secureTunnel = m_secure_tunnel;
+                m_flowControl = Crt::ScopedResource<DataMessageFlowControl>(
+                    Crt::New<DataMessageFlowControl>(
+                        allocator,
+                        sendWindowHighWatermark,
+                        std::min(sendWindowLowWatermark, sendWindowHighWatermark),
+                        std::min(coalescedFrameSize, s_maxDataMessagePayloadSize),
+                        [secureTunnel](const aws_secure_tunnel_message_view &message) {
+                            return aws_secure_tunnel_send_message(secureTunnel, &message);
+                        },
+                        allocator),
+                    [allocator](DataMessageFlowControl *flowControl) { Crt::Delete(flowControl, allocator); });
+            }
         }
 
         /**
@@ -660,6 +724,10 @@ namespace Aws
                   nullptr,
                   nullptr,
                   onSessionReset,
+                  nullptr,
+                  0,
+                  0,
+                  0,
                   nullptr)
         {
         }
@@ -709,6 +777,10 @@ namespace Aws
                   nullptr,
                   nullptr,
                   onSessionReset,
+                  nullptr,
+                  0,
+                  0,
+                  0,
                   nullptr)
         {
         }
@@ -720,6 +792,10 @@ namespace Aws
                 aws_secure_tunnel_release(m_secure_tunnel);
                 m_secure_tunnel = nullptr;
             }
+
+            /* The secure tunnel is released first, so no send can complete once the flow control is gone. */
+            m_flowControl.reset();
+            m_callbackTarget.reset();
         }
 
         SecureTunnel::SecureTunnel(SecureTunnel &&other) noexcept
@@ -735,6 +811,7 @@ namespace Aws
             m_OnConnectionReset = std::move(other.m_OnConnectionReset);
             m_OnSessionReset = std::move(other.m_OnSessionReset);
             m_OnStopped = std::move(other.m_OnStopped);
+            m_OnSendWindowAvailable = std::move(other.m_OnSendWindowAvailable);
 
             /* Deprecated - Use m_OnConnectionSuccess and m_OnConnectionFailure */
             m_OnConnectionComplete = std::move(other.m_OnConnectionComplete);
@@ -745,7 +822,16 @@ namespace Aws
             /* Deprecated - Use m_OnSendMessageComplete */
             m_OnSendDataComplete = std::move(other.m_OnSendDataComplete);
 
+            m_OnStreamStopped = std::move(other.m_OnStreamStopped);
+
             m_secure_tunnel = other.m_secure_tunnel;
+            m_allocator = other.m_allocator;
+            m_flowControl = std::move(other.m_flowControl);
+            m_callbackTarget = std::move(other.m_callbackTarget);
+            if (m_callbackTarget)
+            {
+                m_callbackTarget->secureTunnel.store(this);
+            }
 
             other.m_secure_tunnel = nullptr;
         }
@@ -767,6 +853,7 @@ namespace Aws
                 m_OnConnectionReset = std::move(other.m_OnConnectionReset);
                 m_OnSessionReset = std::move(other.m_OnSessionReset);
                 m_OnStopped = std::move(other.m_OnStopped);
+                m_OnSendWindowAvailable = std::move(other.m_OnSendWindowAvailable);
 
                 /* Deprecated - Use m_OnConnectionSuccess and m_OnConnectionFailure */
                 m_OnConnectionComplete = std::move(other.m_OnConnectionComplete);
@@ -777,7 +864,16 @@ namespace Aws
                 /* Deprecated - Use m_OnSendMessageComplete */
                 m_OnSendDataComplete = std::move(other.m_OnSendDataComplete);
 
+                m_OnStreamStopped = std::move(other.m_OnStreamStopped);
+
                 m_secure_tunnel = other.m_secure_tunnel;
+                m_allocator = other.m_allocator;
+                m_flowControl = std::move(other.m_flowControl);
+                m_callbackTarget = std::move(other.m_callbackTarget);
+                if (m_callbackTarget)
+                {
+                    m_callbackTarget->secureTunnel.store(this);
+                }
 
                 other.m_secure_tunnel = nullptr;
             }
@@ -818,10 +914,57 @@ namespace Aws
             {
                 return AWS_OP_ERR;
             }
+            AWS_IOT_TRACE_START(span, SecureTunneling);
 
             aws_secure_tunnel_message_view message;
             messageOptions->initializeRawOptions(message);
-            return aws_secure_tunnel_send_message(m_secure_tunnel, &message);
+            AWS_IOT_TRACE_MARK(span, Serialize);
+            int result = SendDataMessage(message);
+            /* Send completions are not matched to messages, so a sent message has no PubAck phase. */
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            return result;
+        }
+
+        int SecureTunnel::SendMessage(
+            Crt::ByteCursor serviceId,
+            uint32_t connectionId,
+            Crt::ByteCursor payload) noexcept
+        {
+            AWS_IOT_TRACE_START(span, SecureTunneling);
+
+            aws_secure_tunnel_message_view message;
+            AWS_ZERO_STRUCT(message);
+            if (serviceId.len > 0)
+            {
+                message.service_id = &serviceId;
+            }
+            message.connection_id = connectionId;
+            message.payload = &payload;
+            AWS_IOT_TRACE_MARK(span, Serialize);
+            int result = SendDataMessage(message);
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            return result;
+        }
+
+        size_t SecureTunnel::GetSendWindow() noexcept
+        {
+            return m_flowControl ? m_flowControl->GetSendWindow() : SIZE_MAX;
+        }
+
+        int SecureTunnel::SendDataMessage(const aws_secure_tunnel_message_view &message)
+        {
+            if (!m_flowControl)
+            {
+                return aws_secure_tunnel_send_message(m_secure_tunnel, &message);
+            }
+
+            DataMessageFlowControl::Completions completions;
+            int result = m_flowControl->Send(message, completions);
+            for (size_t i = 0; i < completions.failed; ++i)
+            {
+                InvokeSendMessageComplete(AWS_SECURE_TUNNEL_MT_DATA, completions.errorCode);
+            }
+            return result;
         }
 
         int SecureTunnel::SendStreamStart() { return SendStreamStart(""); }
@@ -876,12 +1019,17 @@ namespace Aws
 
         aws_secure_tunnel *SecureTunnel::GetUnderlyingHandle() { return m_secure_tunnel; }
 
+        SecureTunnel *SecureTunnel::s_FromUserData(void *user_data)
+        {
+            return static_cast<CallbackTarget *>(user_data)->secureTunnel.load();
+        }
+
         void SecureTunnel::s_OnConnectionComplete(
             const struct aws_secure_tunnel_connection_view *connection,
             int error_code,
             void *user_data)
         {
-            auto *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            auto *secureTunnel = s_FromUserData(user_data);
 
             if (!error_code)
             {
@@ -914,7 +1062,7 @@ namespace Aws
         void SecureTunnel::s_OnConnectionShutdown(int error_code, void *user_data)
         {
             (void)error_code;
-            SecureTunnel *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            SecureTunnel *secureTunnel = s_FromUserData(user_data);
             if (secureTunnel->m_OnConnectionShutdown)
             {
                 secureTunnel->m_OnConnectionShutdown();
@@ -926,28 +1074,56 @@ namespace Aws
             int error_code,
             void *user_data)
         {
-            auto *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            auto *secureTunnel = s_FromUserData(user_data);
 
-            if (secureTunnel->m_OnSendMessageComplete)
+            if (type != AWS_SECURE_TUNNEL_MT_DATA || !secureTunnel->m_flowControl)
+            {
+                secureTunnel->InvokeSendMessageComplete(type, error_code);
+                return;
+            }
+
+            DataMessageFlowControl::Completions completions;
+            size_t sendWindow = 0;
+            bool sendWindowAvailable = secureTunnel->m_flowControl->OnSendComplete(completions, sendWindow);
+
+            /* Each call to SendMessage completes once, including those coalesced into the message written. */
+            for (size_t i = 0; i < completions.written; ++i)
+            {
+                secureTunnel->InvokeSendMessageComplete(type, error_code);
+            }
+            for (size_t i = 0; i < completions.failed; ++i)
+            {
+                secureTunnel->InvokeSendMessageComplete(AWS_SECURE_TUNNEL_MT_DATA, completions.errorCode);
+            }
+            if (sendWindowAvailable && secureTunnel->m_OnSendWindowAvailable)
+            {
+                secureTunnel->m_OnSendWindowAvailable(secureTunnel, sendWindow);
+            }
+        }
+
+        void SecureTunnel::InvokeSendMessageComplete(enum aws_secure_tunnel_message_type type, int errorCode)
+        {
+            if (m_OnSendMessageComplete)
             {
                 std::shared_ptr<SendMessageCompleteData> packet =
-                    std::make_shared<SendMessageCompleteData>(type, secureTunnel->m_allocator);
+                    std::make_shared<SendMessageCompleteData>(type, m_allocator);
                 SendMessageCompleteEventData eventData;
                 eventData.sendMessageCompleteData = packet;
-                secureTunnel->m_OnSendMessageComplete(secureTunnel, error_code, eventData);
+                m_OnSendMessageComplete(this, errorCode, eventData);
                 return;
             }
 
             /* Fall back on deprecated complete callback */
-            if (secureTunnel->m_OnSendDataComplete)
+            if (m_OnSendDataComplete)
             {
-                secureTunnel->m_OnSendDataComplete(error_code);
+                m_OnSendDataComplete(errorCode);
             }
         }
 
         void SecureTunnel::s_OnMessageReceived(const struct aws_secure_tunnel_message_view *message, void *user_data)
         {
-            SecureTunnel *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            AWS_IOT_TRACE_START(span, SecureTunneling);
+            SecureTunnel *secureTunnel = s_FromUserData(user_data);
             if (secureTunnel != nullptr)
             {
                 if (message != NULL)
@@ -959,7 +1135,9 @@ namespace Aws
                             std::make_shared<Message>(*message, secureTunnel->m_allocator);
                         MessageReceivedEventData eventData;
                         eventData.message = packet;
+                        AWS_IOT_TRACE_MARK(span, ResponseReceived);
                         secureTunnel->m_OnMessageReceived(secureTunnel, eventData);
+                        AWS_IOT_TRACE_MARK(span, HandlerDone);
                         return;
                     }
 
@@ -992,7 +1170,7 @@ namespace Aws
             int error_code,
             void *user_data)
         {
-            SecureTunnel *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            SecureTunnel *secureTunnel = s_FromUserData(user_data);
             if (!error_code)
             {
                 if (secureTunnel->m_OnStreamStarted)
@@ -1020,7 +1198,7 @@ namespace Aws
         {
             (void)message;
             (void)error_code;
-            SecureTunnel *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            SecureTunnel *secureTunnel = s_FromUserData(user_data);
 
             if (secureTunnel->m_OnStreamStopped)
             {
@@ -1044,7 +1222,7 @@ namespace Aws
             int error_code,
             void *user_data)
         {
-            SecureTunnel *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            SecureTunnel *secureTunnel = s_FromUserData(user_data);
             if (!error_code)
             {
                 if (secureTunnel->m_OnConnectionStarted)
@@ -1064,7 +1242,7 @@ namespace Aws
             int error_code,
             void *user_data)
         {
-            SecureTunnel *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            SecureTunnel *secureTunnel = s_FromUserData(user_data);
 
             if (secureTunnel->m_OnConnectionReset)
             {
@@ -1079,7 +1257,7 @@ namespace Aws
 
         void SecureTunnel::s_OnSessionReset(void *user_data)
         {
-            SecureTunnel *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            SecureTunnel *secureTunnel = s_FromUserData(user_data);
             if (secureTunnel->m_OnSessionReset)
             {
                 secureTunnel->m_OnSessionReset();
@@ -1088,7 +1266,7 @@ namespace Aws
 
         void SecureTunnel::s_OnStopped(void *user_data)
         {
-            SecureTunnel *secureTunnel = static_cast<SecureTunnel *>(user_data);
+            SecureTunnel *secureTunnel = s_FromUserData(user_data);
             secureTunnel->m_selfRef = nullptr;
             if (secureTunnel->m_OnStopped)
             {
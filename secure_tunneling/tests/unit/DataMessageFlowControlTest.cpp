@@ -0,0 +1,203 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotsecuretunneling/DataMessageFlowControl.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <cstdint>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotsecuretunneling;
+
+struct SentMessage
+{
+    String serviceId;
+    uint32_t connectionId;
+    String payload;
+};
+
+/* Records every message the flow control hands to the secure tunnel, or fails them with sendError. */
+static DataMessageFlowControl::SendMessage s_recordSends(Vector<SentMessage> &sent, int &sendError)
+{
+    return [&sent, &sendError](const aws_secure_tunnel_message_view &message) {
+        if (sendError != AWS_ERROR_SUCCESS)
+        {
+            return aws_raise_error(sendError);
+        }
+        SentMessage record;
+        if (message.service_id != nullptr)
+        {
+            record.serviceId = String(reinterpret_cast<const char *>(message.service_id->ptr), message.service_id->len);
+        }
+        record.connectionId = message.connection_id;
+        record.payload = String(reinterpret_cast<const char *>(message.payload->ptr), message.payload->len);
+        sent.push_back(record);
+        return AWS_OP_SUCCESS;
+    };
+}
+
+static int s_send(
+    DataMessageFlowControl &flowControl,
+    const char *serviceId,
+    uint32_t connectionId,
+    const String &payload,
+    DataMessageFlowControl::Completions &completions)
+{
+    ByteCursor serviceIdCursor = aws_byte_cursor_from_c_str(serviceId);
+    ByteCursor payloadCursor = aws_byte_cursor_from_array(payload.data(), payload.size());
+    aws_secure_tunnel_message_view message;
+    AWS_ZERO_STRUCT(message);
+    message.service_id = &serviceIdCursor;
+    message.connection_id = connectionId;
+    message.payload = &payloadCursor;
+    return flowControl.Send(message, completions);
+}
+
+static int s_TestDataMessageFlowControlWatermarks(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        Vector<SentMessage> sent;
+        int sendError = AWS_ERROR_SUCCESS;
+        DataMessageFlowControl flowControl(100, 40, 0, s_recordSends(sent, sendError), allocator);
+        DataMessageFlowControl::Completions completions;
+        size_t sendWindow = 0;
+
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, String(60, 'a'), completions));
+        ASSERT_UINT_EQUALS(40, flowControl.GetSendWindow());
+
+        /* A message that does not fit is refused without being sent, and leaves the window as it was. */
+        ASSERT_FAILS(s_send(flowControl, "ssh", 1, String(50, 'b'), completions));
+        ASSERT_INT_EQUALS(AWS_ERROR_INVALID_STATE, aws_last_error());
+        ASSERT_UINT_EQUALS(1, sent.size());
+        ASSERT_UINT_EQUALS(40, flowControl.GetSendWindow());
+
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, String(40, 'c'), completions));
+        ASSERT_UINT_EQUALS(0, flowControl.GetSendWindow());
+
+        /* The window is reported available once the bytes waiting fall to the low watermark, and only once. */
+        ASSERT_TRUE(flowControl.OnSendComplete(completions, sendWindow));
+        ASSERT_UINT_EQUALS(60, sendWindow);
+        ASSERT_UINT_EQUALS(60, flowControl.GetSendWindow());
+        ASSERT_FALSE(flowControl.OnSendComplete(completions, sendWindow));
+        ASSERT_UINT_EQUALS(100, flowControl.GetSendWindow());
+
+        /* A message larger than the whole window goes out once nothing else is waiting. */
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, String(150, 'd'), completions));
+        ASSERT_UINT_EQUALS(0, flowControl.GetSendWindow());
+        ASSERT_TRUE(flowControl.OnSendComplete(completions, sendWindow));
+        ASSERT_UINT_EQUALS(100, sendWindow);
+
+        ASSERT_UINT_EQUALS(3, sent.size());
+        ASSERT_UINT_EQUALS(0, completions.failed);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(DataMessageFlowControlWatermarks, s_TestDataMessageFlowControlWatermarks)
+
+static int s_TestDataMessageFlowControlConnectionOrder(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        Vector<SentMessage> sent;
+        int sendError = AWS_ERROR_SUCCESS;
+        DataMessageFlowControl flowControl(0, 0, 16, s_recordSends(sent, sendError), allocator);
+        DataMessageFlowControl::Completions completions;
+        size_t sendWindow = 0;
+
+        /* Nothing is being written, so the first message goes out at once. */
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "A1", completions));
+        ASSERT_UINT_EQUALS(1, sent.size());
+        ASSERT_UINT_EQUALS(SIZE_MAX, flowControl.GetSendWindow());
+
+        /* Small messages wait for it, coalesced per connection. */
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "B1", completions));
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 2, "X2", completions));
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "C1", completions));
+        ASSERT_UINT_EQUALS(1, sent.size());
+
+        /* A message too large to coalesce sends what is waiting on its own connection first. */
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "0123456789abcdefXYZ", completions));
+        ASSERT_UINT_EQUALS(3, sent.size());
+        ASSERT_TRUE(sent[1].payload == "B1C1");
+        ASSERT_TRUE(sent[1].serviceId == "ssh");
+        ASSERT_UINT_EQUALS(1, sent[1].connectionId);
+        ASSERT_TRUE(sent[2].payload == "0123456789abcdefXYZ");
+
+        /* The other connection's message goes out when the message being written completes. */
+        ASSERT_FALSE(flowControl.OnSendComplete(completions, sendWindow));
+        ASSERT_UINT_EQUALS(1, completions.written);
+        ASSERT_UINT_EQUALS(4, sent.size());
+        ASSERT_TRUE(sent[3].payload == "X2");
+        ASSERT_TRUE(sent[3].serviceId == "ssh");
+        ASSERT_UINT_EQUALS(2, sent[3].connectionId);
+
+        /* The coalesced message completes both of the sends it carries. */
+        completions = DataMessageFlowControl::Completions();
+        ASSERT_FALSE(flowControl.OnSendComplete(completions, sendWindow));
+        ASSERT_UINT_EQUALS(2, completions.written);
+        ASSERT_UINT_EQUALS(0, completions.failed);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(DataMessageFlowControlConnectionOrder, s_TestDataMessageFlowControlConnectionOrder)
+
+static int s_TestDataMessageFlowControlFrameSize(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        Vector<SentMessage> sent;
+        int sendError = AWS_ERROR_SUCCESS;
+        DataMessageFlowControl flowControl(0, 0, 8, s_recordSends(sent, sendError), allocator);
+        DataMessageFlowControl::Completions completions;
+        size_t sendWindow = 0;
+
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "first", completions));
+
+        /* A coalesced message that reaches the frame size goes out without waiting. */
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "abcd", completions));
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "efgh", completions));
+        ASSERT_UINT_EQUALS(2, sent.size());
+        ASSERT_TRUE(sent[1].payload == "abcdefgh");
+
+        /* A payload that would overflow the frame sends what is waiting and starts a new frame. */
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "12345", completions));
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "6789", completions));
+        ASSERT_UINT_EQUALS(3, sent.size());
+        ASSERT_TRUE(sent[2].payload == "12345");
+
+        ASSERT_FALSE(flowControl.OnSendComplete(completions, sendWindow));
+        ASSERT_UINT_EQUALS(4, sent.size());
+        ASSERT_TRUE(sent[3].payload == "6789");
+        ASSERT_UINT_EQUALS(0, completions.failed);
+
+        /* A coalesced message the secure tunnel refuses fails every send it carries. */
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "la", completions));
+        ASSERT_SUCCESS(s_send(flowControl, "ssh", 1, "te", completions));
+        sendError = AWS_ERROR_INVALID_ARGUMENT;
+        completions = DataMessageFlowControl::Completions();
+        ASSERT_FALSE(flowControl.OnSendComplete(completions, sendWindow));
+        ASSERT_UINT_EQUALS(2, completions.written);
+        ASSERT_UINT_EQUALS(2, completions.failed);
+        ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, completions.errorCode);
+        ASSERT_UINT_EQUALS(4, sent.size());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(DataMessageFlowControlFrameSize, s_TestDataMessageFlowControlFrameSize)
@@ -0,0 +1,128 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/iotdevice/iotdevice.h>
+#include <aws/iotdevice/private/secure_tunneling_impl.h>
+
+#include <aws/iotsecuretunneling/SecureTunnel.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <atomic>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotsecuretunneling;
+
+struct SecureTunnelMoveTestContext
+{
+    std::unique_ptr<ApiHandle> apiHandle;
+    std::unique_ptr<Io::EventLoopGroup> elGroup;
+    std::unique_ptr<Io::HostResolver> resolver;
+    std::unique_ptr<Io::ClientBootstrap> clientBootstrap;
+};
+
+static SecureTunnelMoveTestContext s_testContext;
+
+static int s_testSetup(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<SecureTunnelMoveTestContext *>(ctx);
+
+    testContext->apiHandle = std::unique_ptr<ApiHandle>(new ApiHandle(allocator));
+    aws_iotdevice_library_init(allocator);
+    testContext->elGroup = std::unique_ptr<Io::EventLoopGroup>(new Io::EventLoopGroup(0, allocator));
+    testContext->resolver =
+        std::unique_ptr<Io::HostResolver>(new Io::DefaultHostResolver(*testContext->elGroup, 8, 30, allocator));
+    testContext->clientBootstrap = std::unique_ptr<Io::ClientBootstrap>(
+        new Io::ClientBootstrap(*testContext->elGroup, *testContext->resolver, allocator));
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static int s_testTeardown(struct aws_allocator *allocator, int setup_result, void *ctx)
+{
+    (void)allocator;
+    (void)setup_result;
+    auto *testContext = static_cast<SecureTunnelMoveTestContext *>(ctx);
+
+    testContext->elGroup.reset();
+    testContext->resolver.reset();
+    testContext->clientBootstrap.reset();
+    aws_iotdevice_library_clean_up();
+    /* The ApiHandle must be deallocated last or a deadlock occurs. */
+    testContext->apiHandle.reset();
+
+    return AWS_ERROR_SUCCESS;
+}
+
+/* Completes a data message the way the native secure tunnel does, through the user data it was given. */
+static void s_completeDataMessage(SecureTunnel &secureTunnel)
+{
+    aws_secure_tunnel *nativeTunnel = secureTunnel.GetUnderlyingHandle();
+    nativeTunnel->config->on_send_message_complete(
+        AWS_SECURE_TUNNEL_MT_DATA, AWS_ERROR_SUCCESS, nativeTunnel->config->user_data);
+}
+
+static int s_TestSecureTunnelMoveKeepsSendWindow(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<SecureTunnelMoveTestContext *>(ctx);
+
+    std::atomic<SecureTunnel *> completedOn(nullptr);
+    std::atomic<SecureTunnel *> windowAvailableOn(nullptr);
+
+    SecureTunnelBuilder builder(
+        allocator,
+        *testContext->clientBootstrap,
+        Io::SocketOptions(),
+        "access_token",
+        AWS_SECURE_TUNNELING_DESTINATION_MODE,
+        "data.tunneling.iot.us-east-1.amazonaws.com");
+    builder.WithSendWindow(100, 40);
+    builder.WithOnSendMessageComplete(
+        [&completedOn](SecureTunnel *secureTunnel, int errorCode, const SendMessageCompleteEventData &eventData) {
+            (void)errorCode;
+            (void)eventData;
+            completedOn = secureTunnel;
+        });
+    builder.WithOnSendWindowAvailable([&windowAvailableOn](SecureTunnel *secureTunnel, size_t sendWindow) {
+        (void)sendWindow;
+        windowAvailableOn = secureTunnel;
+    });
+
+    std::shared_ptr<SecureTunnel> built = builder.Build();
+    ASSERT_NOT_NULL(built);
+    ASSERT_TRUE(built->IsValid());
+
+    /* The tunnel is never started, so nothing is written and only the completions below reach the callbacks. */
+    SecureTunnel secureTunnel(std::move(*built));
+    built.reset();
+
+    ByteCursor serviceId = aws_byte_cursor_from_c_str("ssh");
+    String payload(60, 'a');
+    ASSERT_SUCCESS(secureTunnel.SendMessage(serviceId, 1, ByteCursorFromCString(payload.c_str())));
+    payload.assign(40, 'b');
+    ASSERT_SUCCESS(secureTunnel.SendMessage(serviceId, 1, ByteCursorFromCString(payload.c_str())));
+    ASSERT_UINT_EQUALS(0, secureTunnel.GetSendWindow());
+
+    payload.assign(50, 'c');
+    ASSERT_FAILS(secureTunnel.SendMessage(serviceId, 1, ByteCursorFromCString(payload.c_str())));
+
+    /* The completion reaches the tunnel that was moved to, which reopens the window. */
+    s_completeDataMessage(secureTunnel);
+    ASSERT_PTR_EQUALS(&secureTunnel, completedOn.load());
+    ASSERT_PTR_EQUALS(&secureTunnel, windowAvailableOn.load());
+    ASSERT_UINT_EQUALS(60, secureTunnel.GetSendWindow());
+
+    ASSERT_SUCCESS(secureTunnel.SendMessage(serviceId, 1, ByteCursorFromCString(payload.c_str())));
+    ASSERT_UINT_EQUALS(10, secureTunnel.GetSendWindow());
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    SecureTunnelMoveKeepsSendWindow,
+    s_testSetup,
+    s_TestSecureTunnelMoveKeepsSendWindow,
+    s_testTeardown,
+    &s_testContext);
@@ -11,17 +11,8 @@
 #include <aws/iot/Mqtt5Client.h>
 #include <aws/iot/MqttClient.h>
 
-#include <aws/iotidentity/CreateCertificateFromCsrRequest.h>
-#include <aws/iotidentity/CreateCertificateFromCsrResponse.h>
-#include <aws/iotidentity/CreateCertificateFromCsrSubscriptionRequest.h>
-#include <aws/iotidentity/CreateKeysAndCertificateRequest.h>
-#include <aws/iotidentity/CreateKeysAndCertificateResponse.h>
-#include <aws/iotidentity/CreateKeysAndCertificateSubscriptionRequest.h>
-#include <aws/iotidentity/ErrorResponse.h>
 #include <aws/iotidentity/IotIdentityClient.h>
-#include <aws/iotidentity/RegisterThingRequest.h>
-#include <aws/iotidentity/RegisterThingResponse.h>
-#include <aws/iotidentity/RegisterThingSubscriptionRequest.h>
+#include <aws/iotidentity/ProvisioningFlow.h>
 
 #include <algorithm>
 #include <aws/mqtt/mqtt.h>
@@ -41,8 +32,6 @@
 using namespace Aws::Crt;
 using namespace Aws::Iotidentity;
 
-static std::promise<void> gotResponse;
-
 static std::string getFileData(std::string const &fileName)
 {
     std::ifstream ifs(fileName);
@@ -183,351 +172,58 @@ std::shared_ptr<IotIdentityClient> build_mqtt5_client(
     return std::make_shared<IotIdentityClient>(client5);
 }
 
-void SubscribeToRegisterThing(String input_templateName, std::shared_ptr<IotIdentityClient> iotIdentityClient)
-{
-    std::promise<void> onSubAckPromise;
-    std::promise<void> registerRejectedCompletedPromise;
-    std::promise<void> registerAcceptedCompletedPromise;
-
-    auto onRegisterThingAccepted = [&](RegisterThingResponse *response, int ioErr) {
-        if (ioErr)
-        {
-            fprintf(stderr, "Error: onSuback callback error %d\n", ioErr);
-            exit(-1);
-        }
-        if (response)
-        {
-            fprintf(stdout, "Register thing: %s\n", response->ThingName.value().c_str());
-        }
-    };
-
-    RegisterThingSubscriptionRequest registerThingSubscriptionRequest;
-    registerThingSubscriptionRequest.TemplateName = input_templateName;
-
-    auto onRegisterAcceptedSubAck = [&](int ioErr) {
-        if (ioErr != AWS_OP_SUCCESS)
-        {
-            fprintf(stderr, "Error subscribing to RegisterThing accepted: %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-        registerAcceptedCompletedPromise.set_value();
-    };
-
-    iotIdentityClient->SubscribeToRegisterThingAccepted(
-        registerThingSubscriptionRequest,
-        AWS_MQTT_QOS_AT_LEAST_ONCE,
-        onRegisterThingAccepted,
-        onRegisterAcceptedSubAck);
-
-    auto rejectedHandler = [&](ErrorResponse *error, int ioErr) {
-        if (ioErr)
-        {
-            fprintf(stderr, "Error: rejectedHandler callback error %d\n", ioErr);
-            exit(-1);
-        }
-        else
-        {
-            fprintf(
-                stdout,
-                "RegisterThing failed with statusCode %d, errorMessage %s and errorCode %s.",
-                *error->StatusCode,
-                error->ErrorMessage->c_str(),
-                error->ErrorCode->c_str());
-        }
-    };
-    auto onRegisterRejectedSubAck = [&](int ioErr) {
-        if (ioErr != AWS_OP_SUCCESS)
-        {
-            fprintf(stderr, "Error subscribing to RegisterThing rejected: %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-        registerRejectedCompletedPromise.set_value();
-    };
-    iotIdentityClient->SubscribeToRegisterThingRejected(
-        registerThingSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, rejectedHandler, onRegisterRejectedSubAck);
-
-    registerAcceptedCompletedPromise.get_future().wait();
-    registerRejectedCompletedPromise.get_future().wait();
-}
-
-void createKeysAndCertificateWorkflow(
-    String &input_templateName,
-    String &input_templateParameters,
-    std::shared_ptr<IotIdentityClient> iotIdentityClient)
+void provisionThing(
+    const String &input_templateName,
+    const String &input_templateParameters,
+    const String &input_csrPath,
+    const IotIdentityClient &iotIdentityClient)
 {
-    std::promise<void> onSubAckPromise;
-
-    std::promise<void> keysPublishCompletedPromise;
-    std::promise<void> keysAcceptedCompletedPromise;
-    std::promise<void> keysRejectedCompletedPromise;
-
-    std::promise<void> registerPublishCompletedPromise;
-    std::promise<void> registerAcceptedCompletedPromise;
-
-    CreateKeysAndCertificateResponse *createKeysAndCertificateResponse = nullptr;
-    String token;
-
-    auto acceptedHandler = [&createKeysAndCertificateResponse,
-                            &token](CreateKeysAndCertificateResponse *response, int ioErr) {
-        fprintf(stderr, "acceptedhandler is called\n");
-        if (ioErr)
-        {
-            fprintf(stderr, "Error: acceptedHandler callback error %d\n", ioErr);
-            exit(-1);
-        }
-        if (response)
-        {
-            if (createKeysAndCertificateResponse == nullptr)
-            {
-                createKeysAndCertificateResponse = response;
-                token = *response->CertificateOwnershipToken;
-            }
-        }
-        gotResponse.set_value();
-    };
-
-    auto onKeysAcceptedSubAck = [&](int ioErr) {
-        if (ioErr != AWS_OP_SUCCESS)
-        {
-            fprintf(stderr, "Error subscribing to CreateKeysAndCertificate accepted: %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-
-        keysAcceptedCompletedPromise.set_value();
-    };
-
-    CreateKeysAndCertificateSubscriptionRequest createKeysAndCertificateSubscriptionRequest;
-    iotIdentityClient->SubscribeToCreateKeysAndCertificateAccepted(
-        createKeysAndCertificateSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, acceptedHandler, onKeysAcceptedSubAck);
-
-    auto rejectedHandler = [&](Aws::Iotidentity::ErrorResponse *error, int ioErr) {
-        if (ioErr == AWS_OP_ERR)
-        {
-            fprintf(stderr, "Error: rejectedHandler callback error %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-        if (error)
-        {
-            fprintf(
-                stdout,
-                "CreateKeysAndCertificate failed with statusCode %d, errorMessage %s and errorCode %s.",
-                *error->StatusCode,
-                error->ErrorMessage->c_str(),
-                error->ErrorCode->c_str());
-        }
-        exit(-1);
-    };
-
-    auto onKeysRejectedSubAck = [&](int ioErr) {
-        if (ioErr != AWS_OP_SUCCESS)
-        {
-            fprintf(stderr, "Error subscribing to CreateKeysAndCertificate rejected: %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-        keysRejectedCompletedPromise.set_value();
-    };
-    iotIdentityClient->SubscribeToCreateKeysAndCertificateRejected(
-        createKeysAndCertificateSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, rejectedHandler, onKeysRejectedSubAck);
-
-    auto onKeysPublishSubAck = [&](int ioErr) {
-        if (ioErr != AWS_OP_SUCCESS)
-        {
-            fprintf(stderr, "Error publishing to CreateKeysAndCertificate: %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-
-        keysPublishCompletedPromise.set_value();
-    };
-
-    CreateKeysAndCertificateRequest createKeysAndCertificateRequest;
-    iotIdentityClient->PublishCreateKeysAndCertificate(
-        createKeysAndCertificateRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onKeysPublishSubAck);
-
-    SubscribeToRegisterThing(input_templateName, iotIdentityClient);
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-
-    // Verify the response is good
-    if (createKeysAndCertificateResponse == nullptr)
-    {
-        fprintf(stderr, "Error: 1 createKeysAndCertificateResponse is null\n");
-        exit(-1);
-    }
-    // reset gotResponse future
-    gotResponse = std::promise<void>();
-
-    RegisterThingRequest registerThingRequest;
-    registerThingRequest.TemplateName = input_templateName;
-
+    Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> params = Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
     if (!input_templateParameters.empty())
     {
         const Aws::Crt::String jsonValue = input_templateParameters;
         Aws::Crt::JsonObject value(jsonValue);
         Map<String, JsonView> pm = value.View().GetAllObjects();
-        Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> params = Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
-
         for (const auto &x : pm)
         {
             params.emplace(x.first, x.second.AsString());
         }
-        registerThingRequest.Parameters = params;
     }
-    registerThingRequest.CertificateOwnershipToken = token;
 
-    auto onRegisterPublishSubAck = [&](int ioErr) {
-        if (ioErr != AWS_OP_SUCCESS)
-        {
-            fprintf(stderr, "Error publishing to RegisterThing: %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-
-        registerPublishCompletedPromise.set_value();
-    };
-    iotIdentityClient->PublishRegisterThing(registerThingRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterPublishSubAck);
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-
-    keysPublishCompletedPromise.get_future().wait();
-    keysAcceptedCompletedPromise.get_future().wait();
-    keysRejectedCompletedPromise.get_future().wait();
-    registerPublishCompletedPromise.get_future().wait();
-}
-
-void createCertificateFromCsrWorkflow(
-    String input_templateName,
-    String input_templateParameters,
-    String input_csrPath,
-    std::shared_ptr<IotIdentityClient> iotIdentityClient)
-{
-    std::promise<void> keysPublishCompletedPromise;
-    std::promise<void> keysAcceptedCompletedPromise;
-    std::promise<void> keysRejectedCompletedPromise;
-
-    std::promise<void> registerPublishCompletedPromise;
-    std::promise<void> registerAcceptedCompletedPromise;
-    CreateCertificateFromCsrResponse *createCertificateFromCsrResponse = nullptr;
-    String token;
-
-    gotResponse = std::promise<void>();
-
-    auto onCreateCertificateFromCsrResponseAccepted = [&createCertificateFromCsrResponse,
-                                                       &token](CreateCertificateFromCsrResponse *response, int ioErr) {
-        if (ioErr)
-        {
-            fprintf(stderr, "Error: onCreateCertificateFromCsrResponseAccepted callback error %d\n", ioErr);
-            exit(-1);
-        }
-        if (response != nullptr)
-        {
-            if (createCertificateFromCsrResponse == nullptr)
-            {
-                createCertificateFromCsrResponse = response;
-                token = *response->CertificateOwnershipToken;
-            }
-        }
-        gotResponse.set_value();
-    };
-
-    auto onSubAck = [&](int ioErr) {
-        if (ioErr)
-        {
-            fprintf(stderr, "Error: onSubAck callback error %d\n", ioErr);
-            exit(-1);
-        }
-        keysAcceptedCompletedPromise.set_value();
-    };
-
-    CreateCertificateFromCsrSubscriptionRequest createCertificateFromCsrSubscriptionRequest;
-    iotIdentityClient->SubscribeToCreateCertificateFromCsrAccepted(
-        createCertificateFromCsrSubscriptionRequest,
-        AWS_MQTT_QOS_AT_LEAST_ONCE,
-        onCreateCertificateFromCsrResponseAccepted,
-        onSubAck);
-
-    auto onRejectedCsr = [&](ErrorResponse *response, int ioErr) {
-        (void)response;
-        if (ioErr)
-        {
-            fprintf(stderr, "Error: onSubAck callback error %d\n", ioErr);
-            exit(-1);
-        }
-        exit(1);
-    };
-
-    auto onKeysRejectedSubAck = [&](int ioErr) {
-        if (ioErr != AWS_OP_SUCCESS)
-        {
-            fprintf(stderr, "Error subscribing to CreateKeysAndCertificate rejected: %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-        keysRejectedCompletedPromise.set_value();
-    };
-
-    iotIdentityClient->SubscribeToCreateCertificateFromCsrRejected(
-        createCertificateFromCsrSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRejectedCsr, onKeysRejectedSubAck);
-
-    auto onKeysPublishSubAck = [&](int ioErr) {
-        if (ioErr != AWS_OP_SUCCESS)
-        {
-            fprintf(stderr, "Error publishing to CreateKeysAndCertificate: %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-        keysPublishCompletedPromise.set_value();
-    };
-
-    std::string csrContents = getFileData(input_csrPath.c_str());
-    CreateCertificateFromCsrRequest createCertificateFromCsrRequest;
-    createCertificateFromCsrRequest.CertificateSigningRequest = csrContents.c_str();
-
-    iotIdentityClient->PublishCreateCertificateFromCsr(
-        createCertificateFromCsrRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onKeysPublishSubAck);
-
-    // Subscribes to the register thing accepted and rejected topics
-    SubscribeToRegisterThing(input_templateName, iotIdentityClient);
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    ProvisioningFlow provisioningFlow(iotIdentityClient, AWS_MQTT_QOS_AT_LEAST_ONCE);
+    std::future<ProvisioningOutcome> outcomeFuture;
+    if (input_csrPath.empty())
+    {
+        outcomeFuture = provisioningFlow.ProvisionWithNewKeys(input_templateName, params);
+    }
+    else
+    {
+        std::string csrContents = getFileData(input_csrPath.c_str());
+        outcomeFuture = provisioningFlow.ProvisionWithCsr(csrContents.c_str(), input_templateName, params);
+    }
 
-    // Verify the response is good
-    if (createCertificateFromCsrResponse == nullptr)
+    if (outcomeFuture.wait_for(std::chrono::seconds(30)) != std::future_status::ready)
     {
-        fprintf(stderr, "Error: 1 createCertificateFromCsrResponse is null\n");
+        fprintf(stderr, "Error: provisioning did not complete\n");
         exit(-1);
     }
-    // reset gotResponse future
-    gotResponse = std::promise<void>();
-
-    RegisterThingRequest registerThingRequest;
-    registerThingRequest.CertificateOwnershipToken = token;
-    registerThingRequest.TemplateName = input_templateName;
-
-    if (!input_templateParameters.empty())
+    ProvisioningOutcome outcome = outcomeFuture.get();
+    if (outcome.rejection.has_value())
     {
-        const Aws::Crt::String jsonValue = input_templateParameters;
-        Aws::Crt::JsonObject value(jsonValue);
-        Map<String, JsonView> pm = value.View().GetAllObjects();
-        Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String> params = Aws::Crt::Map<Aws::Crt::String, Aws::Crt::String>();
-
-        for (const auto &x : pm)
-        {
-            params.emplace(x.first, x.second.AsString());
-        }
-        registerThingRequest.Parameters = params;
+        fprintf(
+            stderr,
+            "Provisioning failed with statusCode %d, errorMessage %s and errorCode %s.\n",
+            *outcome.rejection->StatusCode,
+            outcome.rejection->ErrorMessage->c_str(),
+            outcome.rejection->ErrorCode->c_str());
+        exit(-1);
     }
-
-    auto onRegisterPublishSubAck = [&](int ioErr) {
-        if (ioErr != AWS_OP_SUCCESS)
-        {
-            fprintf(stderr, "Error publishing to RegisterThing: %s\n", ErrorDebugString(ioErr));
-            exit(-1);
-        }
-
-        registerPublishCompletedPromise.set_value();
-    };
-    iotIdentityClient->PublishRegisterThing(registerThingRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onRegisterPublishSubAck);
-
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-
-    keysPublishCompletedPromise.get_future().wait();
-    keysAcceptedCompletedPromise.get_future().wait();
-    keysRejectedCompletedPromise.get_future().wait();
-    registerPublishCompletedPromise.get_future().wait();
+    if (!outcome.Succeeded())
+    {
+        fprintf(stderr, "Provisioning failed with error: %s\n", ErrorDebugString(outcome.errorCode));
+        exit(-1);
+    }
+    fprintf(stdout, "Register thing: %s\n", outcome.registeredThing->ThingName->c_str());
 }
 
 int main(int argc, char *argv[])
@@ -568,16 +264,8 @@ int main(int argc, char *argv[])
     }
     if (connectionCompletedPromise.get_future().get())
     {
-        if (cmdData.input_csrPath.empty())
-        {
-            createKeysAndCertificateWorkflow(
-                cmdData.input_templateName, cmdData.input_templateParameters, iotIdentityClient);
-        }
-        else
-        {
-            createCertificateFromCsrWorkflow(
-                cmdData.input_templateName, cmdData.input_templateParameters, cmdData.input_csrPath, iotIdentityClient);
-        }
+        provisionThing(
+            cmdData.input_templateName, cmdData.input_templateParameters, cmdData.input_csrPath, *iotIdentityClient);
     }
     // Wait just a little bit to let the console print
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -250,7 +250,9 @@ int main(int argc, char *argv[])
                 }
             };
 
-            jobsClient->SubscribeToDescribeJobExecutionAccepted(
+            /* Each subscription ends with the block holding it, so that a later subscription to the same topic does
+             * not also invoke this one's handler. */
+            ScopedSubscription describeAccepted = jobsClient->SubscribeToDescribeJobExecutionAccepted(
                 describeJobExecutionSubscriptionRequest,
                 AWS_MQTT_QOS_AT_LEAST_ONCE,
                 subscriptionHandler,
@@ -276,7 +278,7 @@ int main(int argc, char *argv[])
                 }
             };
 
-            jobsClient->SubscribeToDescribeJobExecutionRejected(
+            ScopedSubscription describeRejected = jobsClient->SubscribeToDescribeJobExecutionRejected(
                 describeJobExecutionSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
             subAckedPromise.get_future().wait();
 
@@ -334,7 +336,7 @@ int main(int argc, char *argv[])
                 StartNextPendingJobExecutionSubscriptionRequest subscriptionRequest;
                 subscriptionRequest.ThingName = cmdData.input_thingName;
                 subAckedPromise = std::promise<void>();
-                jobsClient->SubscribeToStartNextPendingJobExecutionAccepted(
+                ScopedSubscription startNextAccepted = jobsClient->SubscribeToStartNextPendingJobExecutionAccepted(
                     subscriptionRequest,
                     AWS_MQTT_QOS_AT_LEAST_ONCE,
                     OnSubscribeToStartNextPendingJobExecutionAcceptedResponse,
@@ -343,7 +345,7 @@ int main(int argc, char *argv[])
                 subAckedPromise.get_future().wait();
 
                 subAckedPromise = std::promise<void>();
-                jobsClient->SubscribeToStartNextPendingJobExecutionRejected(
+                ScopedSubscription startNextRejected = jobsClient->SubscribeToStartNextPendingJobExecutionRejected(
                     subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
 
                 subAckedPromise.get_future().wait();
@@ -377,7 +379,7 @@ int main(int argc, char *argv[])
                 subscriptionRequest.JobId = currentJobId;
 
                 subAckedPromise = std::promise<void>();
-                jobsClient->SubscribeToUpdateJobExecutionAccepted(
+                ScopedSubscription updateAccepted = jobsClient->SubscribeToUpdateJobExecutionAccepted(
                     subscriptionRequest,
                     AWS_MQTT_QOS_AT_LEAST_ONCE,
                     OnSubscribeToUpdateJobExecutionAcceptedResponse,
@@ -385,7 +387,7 @@ int main(int argc, char *argv[])
                 subAckedPromise.get_future().wait();
 
                 subAckedPromise = std::promise<void>();
-                jobsClient->SubscribeToUpdateJobExecutionRejected(
+                ScopedSubscription updateRejected = jobsClient->SubscribeToUpdateJobExecutionRejected(
                     subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
                 subAckedPromise.get_future().wait();
 
@@ -421,12 +423,12 @@ int main(int argc, char *argv[])
                     pendingExecutionPromise.set_value();
                 };
                 subAckedPromise = std::promise<void>();
-                jobsClient->SubscribeToUpdateJobExecutionAccepted(
+                ScopedSubscription updateAccepted = jobsClient->SubscribeToUpdateJobExecutionAccepted(
                     subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, subscribeHandler, subAckHandler);
                 subAckedPromise.get_future().wait();
 
                 subAckedPromise = std::promise<void>();
-                jobsClient->SubscribeToUpdateJobExecutionRejected(
+                ScopedSubscription updateRejected = jobsClient->SubscribeToUpdateJobExecutionRejected(
                     subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, failureHandler, subAckHandler);
                 subAckedPromise.get_future().wait();
 
@@ -542,12 +544,13 @@ void getAvailableJobs(
         publishDescribeJobExeCompletedPromise.set_value();
     };
 
-    jobsClient.SubscribeToGetPendingJobExecutionsAccepted(
+    /* The handlers capture this call's locals, so their subscriptions end when it returns. */
+    ScopedSubscription pendingAccepted = jobsClient.SubscribeToGetPendingJobExecutionsAccepted(
         subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, handler, publishHandler);
     publishDescribeJobExeCompletedPromise.get_future().wait();
 
     publishDescribeJobExeCompletedPromise = std::promise<void>();
-    jobsClient.SubscribeToGetPendingJobExecutionsRejected(
+    ScopedSubscription pendingRejected = jobsClient.SubscribeToGetPendingJobExecutionsRejected(
         subscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, err_handler, publishHandler);
     publishDescribeJobExeCompletedPromise.get_future().wait();
 
@@ -0,0 +1,298 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/io/HostResolver.h>
+
+#include <aws/iotjobs/IotJobsClient.h>
+#include <aws/iotjobs/NextJobExecutionChangedEvent.h>
+#include <aws/iotjobs/NextJobExecutionChangedSubscriptionRequest.h>
+#include <aws/iotjobs/RejectedError.h>
+#include <aws/iotjobs/StartNextJobExecutionResponse.h>
+#include <aws/iotjobs/StartNextPendingJobExecutionRequest.h>
+#include <aws/iotjobs/StartNextPendingJobExecutionSubscriptionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionRequest.h>
+#include <aws/iotjobs/UpdateJobExecutionResponse.h>
+#include <aws/iotjobs/UpdateJobExecutionSubscriptionRequest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "../../../samples/utils/CommandLineUtils.h"
+#include "../../../samples/utils/JobsServiceEmulator.h"
+#include "../../../samples/utils/LocalMqttBroker.h"
+
+using namespace Aws::Crt;
+using namespace Aws::Iotjobs;
+
+/*
+ * Simulates a fleet of devices that each process their job queue through IotJobsClient, against the jobs service
+ * emulator on a local broker, and reports the execution throughput and the end-to-end latency of each execution.
+ *
+ * Every device has its own connection. An idle device starts the next execution when notify-next announces one,
+ * and a busy device asks for the next execution as soon as its update to SUCCEEDED is accepted, until its queue is
+ * empty. The latency of an execution is measured from the moment its job was added until it succeeded.
+ */
+
+struct SimulatedDevice
+{
+    String thingName;
+    std::shared_ptr<Mqtt::MqttConnection> connection;
+    std::shared_ptr<IotJobsClient> jobsClient;
+    /* The handlers of these capture the device, so they are released before it is destroyed. */
+    Vector<ScopedSubscription> subscriptions;
+    /* Set while the device has found its queue empty, and waits for notify-next. */
+    std::atomic<bool> idle{true};
+    std::promise<void> disconnected;
+};
+
+static void s_startNext(SimulatedDevice &device)
+{
+    StartNextPendingJobExecutionRequest request;
+    request.ThingName = device.thingName;
+    device.jobsClient->PublishStartNextPendingJobExecution(request, AWS_MQTT_QOS_AT_MOST_ONCE, [](int) {});
+}
+
+static int64_t s_percentile(const Vector<int64_t> &sortedValues, double percentile)
+{
+    if (sortedValues.empty())
+    {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(percentile * static_cast<double>(sortedValues.size() - 1));
+    return sortedValues[index];
+}
+
+int main(int argc, char *argv[])
+{
+    ApiHandle apiHandle;
+
+    Utils::CommandLineUtils cmdUtils = Utils::CommandLineUtils();
+    cmdUtils.RegisterProgramName("jobs-load");
+    cmdUtils.RegisterCommand("devices", "<int>", "The number of simulated devices (optional, default='1000')");
+    cmdUtils.RegisterCommand("jobs", "<int>", "The number of jobs queued for every device (optional, default='10')");
+    cmdUtils.RegisterCommand(
+        "threads", "<int>", "Event loop threads, or 0 for one per processor (optional, default='0')");
+    cmdUtils.RegisterCommand(
+        "timeout", "<int>", "Seconds to wait for every execution to finish (optional, default='60')");
+    cmdUtils.AddLoggingCommands();
+    const char **const_argv = (const char **)argv;
+    cmdUtils.SendArguments(const_argv, const_argv + argc);
+    cmdUtils.StartLoggingBasedOnCommand(&apiHandle);
+    if (cmdUtils.HasCommand("help"))
+    {
+        cmdUtils.PrintHelp();
+        exit(-1);
+    }
+
+    size_t deviceCount = std::max<size_t>(1, atoi(cmdUtils.GetCommandOrDefault("devices", "1000").c_str()));
+    size_t jobCount = std::max<size_t>(1, atoi(cmdUtils.GetCommandOrDefault("jobs", "10").c_str()));
+    uint16_t threadCount = static_cast<uint16_t>(atoi(cmdUtils.GetCommandOrDefault("threads", "0").c_str()));
+    int timeoutSeconds = atoi(cmdUtils.GetCommandOrDefault("timeout", "60").c_str());
+
+    Io::EventLoopGroup eventLoopGroup(threadCount);
+    Io::DefaultHostResolver hostResolver(eventLoopGroup, 8, 30);
+    Io::ClientBootstrap bootstrap(eventLoopGroup, hostResolver);
+    Mqtt::MqttClient mqttClient(bootstrap);
+
+    Utils::LocalMqttBroker broker(eventLoopGroup);
+    if (!broker.Start())
+    {
+        fprintf(stderr, "Failed to start the local broker: %s\n", ErrorDebugString(LastError()));
+        exit(-1);
+    }
+    Utils::JobsServiceEmulator emulator(broker);
+
+    std::mutex latenciesMutex;
+    Vector<int64_t> latencies;
+    latencies.reserve(deviceCount * jobCount);
+    std::atomic<uint64_t> succeededCount(0);
+    emulator.SetOnExecutionFinished(
+        [&](const String &, const String &, const String &status, std::chrono::steady_clock::duration latency) {
+            if (status != "SUCCEEDED")
+            {
+                return;
+            }
+            {
+                const std::lock_guard<std::mutex> lock(latenciesMutex);
+                latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+            }
+            succeededCount.fetch_add(1);
+        });
+
+    /* Connect every device, then subscribe each one to the topics it processes its queue with. */
+    fprintf(stdout, "Connecting %zu devices\n", deviceCount);
+    Vector<std::unique_ptr<SimulatedDevice>> devices;
+    Vector<std::future<bool>> connected;
+    for (size_t i = 0; i < deviceCount; ++i)
+    {
+        std::unique_ptr<SimulatedDevice> device(new SimulatedDevice());
+        device->thingName = String("jobs-load-") + std::to_string(i).c_str();
+        device->connection = broker.NewConnection(mqttClient);
+        auto connectedPromise = std::make_shared<std::promise<bool>>();
+        connected.push_back(connectedPromise->get_future());
+        device->connection->OnConnectionCompleted =
+            [connectedPromise](Mqtt::MqttConnection &, int errorCode, Mqtt::ReturnCode, bool) {
+                connectedPromise->set_value(errorCode == AWS_ERROR_SUCCESS);
+            };
+        SimulatedDevice *rawDevice = device.get();
+        device->connection->OnDisconnect = [rawDevice](Mqtt::MqttConnection &) { rawDevice->disconnected.set_value(); };
+        if (!device->connection->Connect(device->thingName.c_str(), true, 0))
+        {
+            connectedPromise->set_value(false);
+        }
+        devices.push_back(std::move(device));
+    }
+    for (auto &connection : connected)
+    {
+        if (!connection.get())
+        {
+            fprintf(stderr, "Failed to connect a device to the local broker\n");
+            exit(-1);
+        }
+    }
+
+    std::atomic<uint64_t> rejectedUpdateCount(0);
+    Vector<std::future<int>> subAcks;
+    for (auto &devicePtr : devices)
+    {
+        SimulatedDevice *device = devicePtr.get();
+        device->jobsClient = std::make_shared<IotJobsClient>(device->connection);
+        auto subscribed = [&subAcks]() {
+            auto subAckPromise = std::make_shared<std::promise<int>>();
+            subAcks.push_back(subAckPromise->get_future());
+            return [subAckPromise](int ioErr) { subAckPromise->set_value(ioErr); };
+        };
+
+        auto onNextChanged = [device](NextJobExecutionChangedEvent *event, int ioErr) {
+            if (ioErr == AWS_ERROR_SUCCESS && event != nullptr && event->Execution && device->idle.exchange(false))
+            {
+                s_startNext(*device);
+            }
+        };
+        NextJobExecutionChangedSubscriptionRequest nextChangedRequest;
+        nextChangedRequest.ThingName = device->thingName;
+        device->subscriptions.emplace_back(device->jobsClient->SubscribeToNextJobExecutionChangedEvents(
+            nextChangedRequest, AWS_MQTT_QOS_AT_MOST_ONCE, onNextChanged, subscribed()));
+
+        auto onStartNextAccepted = [device](StartNextJobExecutionResponse *response, int ioErr) {
+            if (ioErr || response == nullptr)
+            {
+                return;
+            }
+            if (!response->Execution)
+            {
+                device->idle.store(true);
+                return;
+            }
+            UpdateJobExecutionRequest request;
+            request.ThingName = device->thingName;
+            request.JobId = response->Execution->JobId;
+            request.ExpectedVersion = response->Execution->VersionNumber;
+            request.Status = JobStatus::SUCCEEDED;
+            device->jobsClient->PublishUpdateJobExecution(request, AWS_MQTT_QOS_AT_MOST_ONCE, [](int) {});
+        };
+        StartNextPendingJobExecutionSubscriptionRequest startNextRequest;
+        startNextRequest.ThingName = device->thingName;
+        device->subscriptions.emplace_back(device->jobsClient->SubscribeToStartNextPendingJobExecutionAccepted(
+            startNextRequest, AWS_MQTT_QOS_AT_MOST_ONCE, onStartNextAccepted, subscribed()));
+
+        auto onUpdateAccepted = [device](UpdateJobExecutionResponse *, int ioErr) {
+            if (ioErr == AWS_ERROR_SUCCESS)
+            {
+                s_startNext(*device);
+            }
+        };
+        auto onUpdateRejected = [device, &rejectedUpdateCount](RejectedError *, int ioErr) {
+            if (ioErr == AWS_ERROR_SUCCESS)
+            {
+                rejectedUpdateCount.fetch_add(1);
+                s_startNext(*device);
+            }
+        };
+        UpdateJobExecutionSubscriptionRequest updateRequest;
+        updateRequest.ThingName = device->thingName;
+        updateRequest.JobId = String("+");
+        device->subscriptions.emplace_back(device->jobsClient->SubscribeToUpdateJobExecutionAccepted(
+            updateRequest, AWS_MQTT_QOS_AT_MOST_ONCE, onUpdateAccepted, subscribed()));
+        device->subscriptions.emplace_back(device->jobsClient->SubscribeToUpdateJobExecutionRejected(
+            updateRequest, AWS_MQTT_QOS_AT_MOST_ONCE, onUpdateRejected, subscribed()));
+    }
+    for (auto &subAck : subAcks)
+    {
+        if (subAck.get() != AWS_ERROR_SUCCESS)
+        {
+            fprintf(stderr, "Failed to subscribe a device to the jobs topics\n");
+            exit(-1);
+        }
+    }
+
+    Vector<String> thingNames;
+    for (const auto &device : devices)
+    {
+        thingNames.push_back(device->thingName);
+    }
+
+    fprintf(stdout, "Queueing %zu jobs for each device\n", jobCount);
+    uint64_t executionCount = static_cast<uint64_t>(deviceCount * jobCount);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < jobCount; ++i)
+    {
+        JsonObject jobDocument;
+        jobDocument.WithString("operation", "load-test");
+        jobDocument.WithInt64("sequence", static_cast<int64_t>(i));
+        emulator.AddJob(String("job-") + std::to_string(i).c_str(), jobDocument, thingNames);
+    }
+
+    auto deadline = start + std::chrono::seconds(timeoutSeconds);
+    while (succeededCount.load() < executionCount && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Vector<int64_t> sortedLatencies;
+    {
+        const std::lock_guard<std::mutex> lock(latenciesMutex);
+        sortedLatencies = latencies;
+    }
+    std::sort(sortedLatencies.begin(), sortedLatencies.end());
+
+    fprintf(
+        stdout,
+        "Executions: %llu of %llu succeeded in %.2f s (%.0f/s), %llu updates rejected\n",
+        static_cast<unsigned long long>(succeededCount.load()),
+        static_cast<unsigned long long>(executionCount),
+        elapsedSeconds,
+        static_cast<double>(succeededCount.load()) / elapsedSeconds,
+        static_cast<unsigned long long>(rejectedUpdateCount.load()));
+    fprintf(
+        stdout,
+        "Job latency (us): p50=%lld p90=%lld p99=%lld max=%lld\n",
+        static_cast<long long>(s_percentile(sortedLatencies, 0.50)),
+        static_cast<long long>(s_percentile(sortedLatencies, 0.90)),
+        static_cast<long long>(s_percentile(sortedLatencies, 0.99)),
+        static_cast<long long>(sortedLatencies.empty() ? 0 : sortedLatencies.back()));
+    fprintf(
+        stdout,
+        "Broker: %llu messages received, %llu delivered\n",
+        static_cast<unsigned long long>(broker.GetReceivedCount()),
+        static_cast<unsigned long long>(broker.GetDeliveredCount()));
+
+    for (auto &device : devices)
+    {
+        if (device->connection->Disconnect())
+        {
+            device->disconnected.get_future().wait();
+        }
+    }
+    devices.clear();
+    broker.Stop();
+    return succeededCount.load() == executionCount ? 0 : -1;
+}
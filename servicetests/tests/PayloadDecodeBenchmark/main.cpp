@@ -0,0 +1,226 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/iotjobs/PayloadDecoder.h>
+#include <aws/iotshadow/PayloadDecoder.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "../../../samples/utils/CommandLineUtils.h"
+
+using namespace Aws::Crt;
+
+/*
+ * Measures how fast the payloads the shadow and jobs clients receive most often are decoded into their models, with
+ * the payload parsed into a JsonObject first and with the model's fields read on demand from the payload.
+ *
+ * Each payload carries `--properties` state properties or job document fields, so that the effect of payload size
+ * can be seen. Both decodings of every payload are serialized and compared before anything is timed.
+ */
+
+static JsonObject s_properties(size_t count, int64_t timestamp, bool asMetadata)
+{
+    JsonObject properties;
+    for (size_t i = 0; i < count; ++i)
+    {
+        String name = String("property") + std::to_string(i).c_str();
+        if (asMetadata)
+        {
+            properties.WithObject(name, JsonObject().WithInt64("timestamp", timestamp));
+        }
+        else if (i % 2 == 0)
+        {
+            properties.WithInt64(name, static_cast<int64_t>(i) * 1000);
+        }
+        else
+        {
+            properties.WithString(name, String("value \"") + std::to_string(i).c_str() + "\"");
+        }
+    }
+    return properties;
+}
+
+static String s_shadowDeltaPayload(size_t propertyCount)
+{
+    const int64_t timestamp = 1700000000;
+    JsonObject payload;
+    payload.WithInt64("version", 4242);
+    payload.WithInt64("timestamp", timestamp);
+    payload.WithObject("state", s_properties(propertyCount, timestamp, false));
+    payload.WithObject("metadata", s_properties(propertyCount, timestamp, true));
+    payload.WithString("clientToken", "payload-decode-benchmark-0123456789");
+    return payload.View().WriteCompact(true);
+}
+
+static String s_updateShadowAcceptedPayload(size_t propertyCount)
+{
+    const int64_t timestamp = 1700000000;
+    JsonObject payload;
+    payload.WithObject("state", JsonObject().WithObject("desired", s_properties(propertyCount, timestamp, false)));
+    payload.WithObject("metadata", JsonObject().WithObject("desired", s_properties(propertyCount, timestamp, true)));
+    payload.WithInt64("version", 4242);
+    payload.WithInt64("timestamp", timestamp);
+    payload.WithString("clientToken", "payload-decode-benchmark-0123456789");
+    return payload.View().WriteCompact(true);
+}
+
+static String s_nextJobExecutionPayload(size_t propertyCount)
+{
+    const int64_t timestamp = 1700000000;
+    JsonObject statusDetails;
+    statusDetails.WithString("step", "download");
+    statusDetails.WithString("progress", "42%");
+    JsonObject execution;
+    execution.WithString("jobId", "payload-decode-benchmark-job");
+    execution.WithString("thingName", "payload-decode-benchmark-thing");
+    execution.WithObject("jobDocument", s_properties(propertyCount, timestamp, false));
+    execution.WithString("status", "IN_PROGRESS");
+    execution.WithObject("statusDetails", statusDetails);
+    execution.WithInt64("queuedAt", timestamp);
+    execution.WithInt64("startedAt", timestamp + 1);
+    execution.WithInt64("lastUpdatedAt", timestamp + 2);
+    execution.WithInt64("versionNumber", 3);
+    execution.WithInt64("executionNumber", 1);
+    JsonObject payload;
+    payload.WithObject("execution", execution);
+    payload.WithInt64("timestamp", timestamp);
+    return payload.View().WriteCompact(true);
+}
+
+static String s_updateJobExecutionAcceptedPayload(size_t propertyCount)
+{
+    const int64_t timestamp = 1700000000;
+    JsonObject executionState;
+    executionState.WithString("status", "SUCCEEDED");
+    executionState.WithObject("statusDetails", JsonObject().WithString("result", "installed"));
+    executionState.WithInt64("versionNumber", 4);
+    JsonObject payload;
+    payload.WithObject("executionState", executionState);
+    payload.WithObject("jobDocument", s_properties(propertyCount, timestamp, false));
+    payload.WithInt64("timestamp", timestamp);
+    payload.WithString("clientToken", "payload-decode-benchmark-0123456789");
+    return payload.View().WriteCompact(true);
+}
+
+static void s_decodeModel(const ByteCursor &payload, Aws::Iotshadow::ShadowDeltaUpdatedEvent &model, bool onDemand)
+{
+    Aws::Iotshadow::DecodePayload(
+        payload,
+        model,
+        onDemand ? Aws::Iotshadow::PayloadDecoding::OnDemand : Aws::Iotshadow::PayloadDecoding::JsonObject);
+}
+
+static void s_decodeModel(const ByteCursor &payload, Aws::Iotshadow::UpdateShadowResponse &model, bool onDemand)
+{
+    Aws::Iotshadow::DecodePayload(
+        payload,
+        model,
+        onDemand ? Aws::Iotshadow::PayloadDecoding::OnDemand : Aws::Iotshadow::PayloadDecoding::JsonObject);
+}
+
+static void s_decodeModel(const ByteCursor &payload, Aws::Iotjobs::NextJobExecutionChangedEvent &model, bool onDemand)
+{
+    Aws::Iotjobs::DecodePayload(
+        payload,
+        model,
+        onDemand ? Aws::Iotjobs::PayloadDecoding::OnDemand : Aws::Iotjobs::PayloadDecoding::JsonObject);
+}
+
+static void s_decodeModel(const ByteCursor &payload, Aws::Iotjobs::UpdateJobExecutionResponse &model, bool onDemand)
+{
+    Aws::Iotjobs::DecodePayload(
+        payload,
+        model,
+        onDemand ? Aws::Iotjobs::PayloadDecoding::OnDemand : Aws::Iotjobs::PayloadDecoding::JsonObject);
+}
+
+/* Serializes the model decoded each way; the two must match. */
+template <typename Model> static bool s_decodingsMatch(const String &payload)
+{
+    ByteCursor cursor = ByteCursorFromCString(payload.c_str());
+    Model fromJsonObject;
+    Model onDemand;
+    s_decodeModel(cursor, fromJsonObject, false);
+    s_decodeModel(cursor, onDemand, true);
+    JsonObject fromJsonObjectDocument;
+    JsonObject onDemandDocument;
+    fromJsonObject.SerializeToObject(fromJsonObjectDocument);
+    onDemand.SerializeToObject(onDemandDocument);
+    return fromJsonObjectDocument.View().WriteCompact(true) == onDemandDocument.View().WriteCompact(true);
+}
+
+template <typename Model> static double s_decodeSeconds(const String &payload, uint64_t iterations, bool onDemand)
+{
+    ByteCursor cursor = ByteCursorFromCString(payload.c_str());
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        Model model;
+        s_decodeModel(cursor, model, onDemand);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Model> static bool s_run(const char *name, const String &payload, uint64_t iterations)
+{
+    if (!s_decodingsMatch<Model>(payload))
+    {
+        fprintf(stderr, "%s: decoding on demand does not match decoding through JsonObject\n", name);
+        return false;
+    }
+
+    double jsonObjectSeconds = s_decodeSeconds<Model>(payload, iterations, false);
+    double onDemandSeconds = s_decodeSeconds<Model>(payload, iterations, true);
+    double megabytes = static_cast<double>(payload.size()) * static_cast<double>(iterations) / (1024.0 * 1024.0);
+    fprintf(
+        stdout,
+        "%-32s %6zu bytes  JsonObject %8.0f decodes/s %7.1f MB/s  OnDemand %8.0f decodes/s %7.1f MB/s  (%.2fx)\n",
+        name,
+        payload.size(),
+        static_cast<double>(iterations) / jsonObjectSeconds,
+        megabytes / jsonObjectSeconds,
+        static_cast<double>(iterations) / onDemandSeconds,
+        megabytes / onDemandSeconds,
+        jsonObjectSeconds / onDemandSeconds);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    ApiHandle apiHandle;
+
+    Utils::CommandLineUtils cmdUtils = Utils::CommandLineUtils();
+    cmdUtils.RegisterProgramName("payload-decode-benchmark");
+    cmdUtils.RegisterCommand("iterations", "<int>", "Decodes of each payload (optional, default='100000')");
+    cmdUtils.RegisterCommand(
+        "properties", "<int>", "State properties or job document fields per payload (optional, default='16')");
+    cmdUtils.AddLoggingCommands();
+    const char **const_argv = (const char **)argv;
+    cmdUtils.SendArguments(const_argv, const_argv + argc);
+    cmdUtils.StartLoggingBasedOnCommand(&apiHandle);
+    if (cmdUtils.HasCommand("help"))
+    {
+        cmdUtils.PrintHelp();
+        exit(-1);
+    }
+
+    uint64_t iterations = std::max<uint64_t>(1, atoi(cmdUtils.GetCommandOrDefault("iterations", "100000").c_str()));
+    size_t propertyCount = static_cast<size_t>(atoi(cmdUtils.GetCommandOrDefault("properties", "16").c_str()));
+
+    bool matched = true;
+    matched &= s_run<Aws::Iotshadow::ShadowDeltaUpdatedEvent>(
+        "shadow/update/delta", s_shadowDeltaPayload(propertyCount), iterations);
+    matched &= s_run<Aws::Iotshadow::UpdateShadowResponse>(
+        "shadow/update/accepted", s_updateShadowAcceptedPayload(propertyCount), iterations);
+    matched &= s_run<Aws::Iotjobs::NextJobExecutionChangedEvent>(
+        "jobs/notify-next", s_nextJobExecutionPayload(propertyCount), iterations);
+    matched &= s_run<Aws::Iotjobs::UpdateJobExecutionResponse>(
+        "jobs/<jobId>/update/accepted", s_updateJobExecutionAcceptedPayload(propertyCount), iterations);
+
+    return matched ? 0 : -1;
+}
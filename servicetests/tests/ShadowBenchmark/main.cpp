@@ -0,0 +1,259 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/io/HostResolver.h>
+
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "../../../samples/utils/CommandLineUtils.h"
+#include "../../../samples/utils/LocalMqttBroker.h"
+#include "../../../samples/utils/ShadowServiceEmulator.h"
+
+using namespace Aws::Crt;
+using namespace Aws::Iotshadow;
+
+/*
+ * Drives IotShadowClient against the shadow service emulator on a local broker, so that shadow update and delta
+ * throughput can be measured without network access.
+ *
+ * Each update sets a new desired state on one of the shadows, in turn, and stamps it with the time it was published.
+ * Nothing is ever reported, so every update produces a delta event, and the delta latency is measured from the stamp.
+ */
+
+static int64_t s_nowMicroseconds()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static int64_t s_percentile(const Vector<int64_t> &sortedValues, double percentile)
+{
+    if (sortedValues.empty())
+    {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(percentile * static_cast<double>(sortedValues.size() - 1));
+    return sortedValues[index];
+}
+
+int main(int argc, char *argv[])
+{
+    ApiHandle apiHandle;
+
+    Utils::CommandLineUtils cmdUtils = Utils::CommandLineUtils();
+    cmdUtils.RegisterProgramName("shadow-benchmark");
+    cmdUtils.RegisterCommand("shadows", "<int>", "The number of shadows to update (optional, default='10')");
+    cmdUtils.RegisterCommand("rate", "<int>", "Updates published per second (optional, default='1000')");
+    cmdUtils.RegisterCommand("seconds", "<int>", "How long to publish updates for (optional, default='10')");
+    cmdUtils.RegisterCommand(
+        "shadow_name", "<str>", "Update the named shadow with this name instead of the classic shadow (optional)");
+    cmdUtils.RegisterCommand("qos", "<int>", "The QoS of subscriptions and updates (optional, default='0')");
+    cmdUtils.AddLoggingCommands();
+    const char **const_argv = (const char **)argv;
+    cmdUtils.SendArguments(const_argv, const_argv + argc);
+    cmdUtils.StartLoggingBasedOnCommand(&apiHandle);
+    if (cmdUtils.HasCommand("help"))
+    {
+        cmdUtils.PrintHelp();
+        exit(-1);
+    }
+
+    size_t shadowCount = std::max<size_t>(1, atoi(cmdUtils.GetCommandOrDefault("shadows", "10").c_str()));
+    uint64_t rate = std::max<uint64_t>(1, atoi(cmdUtils.GetCommandOrDefault("rate", "1000").c_str()));
+    uint64_t seconds = std::max<uint64_t>(1, atoi(cmdUtils.GetCommandOrDefault("seconds", "10").c_str()));
+    String shadowName = cmdUtils.GetCommandOrDefault("shadow_name", "");
+    Mqtt::QOS qos = atoi(cmdUtils.GetCommandOrDefault("qos", "0").c_str()) == 0 ? AWS_MQTT_QOS_AT_MOST_ONCE
+                                                                                 : AWS_MQTT_QOS_AT_LEAST_ONCE;
+
+    Io::EventLoopGroup eventLoopGroup(2);
+    Io::DefaultHostResolver hostResolver(eventLoopGroup, 8, 30);
+    Io::ClientBootstrap bootstrap(eventLoopGroup, hostResolver);
+    Mqtt::MqttClient mqttClient(bootstrap);
+
+    Utils::LocalMqttBroker broker(eventLoopGroup);
+    if (!broker.Start())
+    {
+        fprintf(stderr, "Failed to start the local broker: %s\n", ErrorDebugString(LastError()));
+        exit(-1);
+    }
+    Utils::ShadowServiceEmulator emulator(broker);
+
+    std::shared_ptr<Mqtt::MqttConnection> connection = broker.NewConnection(mqttClient);
+    std::promise<bool> connectionCompletedPromise;
+    std::promise<void> connectionClosedPromise;
+    connection->OnConnectionCompleted = [&](Mqtt::MqttConnection &, int errorCode, Mqtt::ReturnCode, bool) {
+        connectionCompletedPromise.set_value(errorCode == AWS_ERROR_SUCCESS);
+    };
+    connection->OnDisconnect = [&](Mqtt::MqttConnection &) { connectionClosedPromise.set_value(); };
+    if (!connection->Connect("shadow-benchmark", true, 0) || !connectionCompletedPromise.get_future().get())
+    {
+        fprintf(stderr, "Failed to connect to the local broker: %s\n", ErrorDebugString(connection->LastError()));
+        exit(-1);
+    }
+
+    IotShadowClient shadowClient(connection);
+
+    std::mutex latenciesMutex;
+    Vector<int64_t> latencies;
+    latencies.reserve(static_cast<size_t>(rate * seconds));
+    std::atomic<uint64_t> deltaCount(0);
+    auto onDelta = [&](ShadowDeltaUpdatedEvent *event, int ioErr) {
+        if (ioErr || event == nullptr || !event->State)
+        {
+            return;
+        }
+        int64_t latency = s_nowMicroseconds() - event->State->View().GetInt64("sentAt");
+        {
+            const std::lock_guard<std::mutex> lock(latenciesMutex);
+            latencies.push_back(latency);
+        }
+        deltaCount.fetch_add(1);
+    };
+
+    Vector<String> thingNames;
+    Vector<std::future<int>> subAcks;
+    /* Released before the locals that onDelta captures. */
+    Vector<ScopedSubscription> subscriptions;
+    for (size_t i = 0; i < shadowCount; ++i)
+    {
+        thingNames.push_back(String("shadow-benchmark-") + std::to_string(i).c_str());
+        auto subAckPromise = std::make_shared<std::promise<int>>();
+        subAcks.push_back(subAckPromise->get_future());
+        auto onSubAck = [subAckPromise](int ioErr) { subAckPromise->set_value(ioErr); };
+        if (shadowName.empty())
+        {
+            ShadowDeltaUpdatedSubscriptionRequest request;
+            request.ThingName = thingNames.back();
+            subscriptions.emplace_back(
+                shadowClient.SubscribeToShadowDeltaUpdatedEvents(request, qos, onDelta, onSubAck));
+        }
+        else
+        {
+            NamedShadowDeltaUpdatedSubscriptionRequest request;
+            request.ThingName = thingNames.back();
+            request.ShadowName = shadowName;
+            subscriptions.emplace_back(
+                shadowClient.SubscribeToNamedShadowDeltaUpdatedEvents(request, qos, onDelta, onSubAck));
+        }
+    }
+    for (auto &subAck : subAcks)
+    {
+        if (subAck.get() != AWS_ERROR_SUCCESS)
+        {
+            fprintf(stderr, "Failed to subscribe to delta events\n");
+            exit(-1);
+        }
+    }
+
+    fprintf(
+        stdout,
+        "Updating %zu %s shadows at %llu updates/s for %llu s\n",
+        shadowCount,
+        shadowName.empty() ? "classic" : "named",
+        static_cast<unsigned long long>(rate),
+        static_cast<unsigned long long>(seconds));
+
+    /* Updates are published on a fixed schedule, so that a slow update does not lower the offered rate. */
+    std::atomic<uint64_t> failedPublishCount(0);
+    auto onPubAck = [&failedPublishCount](int ioErr) {
+        if (ioErr)
+        {
+            failedPublishCount.fetch_add(1);
+        }
+    };
+    uint64_t updateCount = rate * seconds;
+    auto interval = std::chrono::nanoseconds(std::chrono::seconds(1)) / rate;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < updateCount; ++i)
+    {
+        std::this_thread::sleep_until(start + interval * i);
+
+        JsonObject desired;
+        desired.WithInt64("value", static_cast<int64_t>(i));
+        desired.WithInt64("sentAt", s_nowMicroseconds());
+        ShadowState state;
+        state.Desired = desired;
+        const String &thingName = thingNames[i % shadowCount];
+        if (shadowName.empty())
+        {
+            UpdateShadowRequest request;
+            request.ThingName = thingName;
+            request.State = state;
+            shadowClient.PublishUpdateShadow(request, qos, onPubAck);
+        }
+        else
+        {
+            UpdateNamedShadowRequest request;
+            request.ThingName = thingName;
+            request.ShadowName = shadowName;
+            request.State = state;
+            shadowClient.PublishUpdateNamedShadow(request, qos, onPubAck);
+        }
+    }
+    double publishSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    /* Wait for the deltas still in flight. */
+    auto drainDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (deltaCount.load() < updateCount && std::chrono::steady_clock::now() < drainDeadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Vector<int64_t> sortedLatencies;
+    {
+        const std::lock_guard<std::mutex> lock(latenciesMutex);
+        sortedLatencies = latencies;
+    }
+    std::sort(sortedLatencies.begin(), sortedLatencies.end());
+
+    fprintf(
+        stdout,
+        "Updates: %llu published in %.2f s (%.0f/s), %llu accepted, %llu failed to publish\n",
+        static_cast<unsigned long long>(updateCount),
+        publishSeconds,
+        static_cast<double>(updateCount) / publishSeconds,
+        static_cast<unsigned long long>(emulator.GetAcceptedUpdateCount()),
+        static_cast<unsigned long long>(failedPublishCount.load()));
+    fprintf(
+        stdout,
+        "Deltas: %llu received (%.0f/s), %llu lost\n",
+        static_cast<unsigned long long>(deltaCount.load()),
+        static_cast<double>(deltaCount.load()) / totalSeconds,
+        static_cast<unsigned long long>(updateCount - std::min<uint64_t>(updateCount, deltaCount.load())));
+    fprintf(
+        stdout,
+        "Delta latency (us): p50=%lld p90=%lld p99=%lld max=%lld\n",
+        static_cast<long long>(s_percentile(sortedLatencies, 0.50)),
+        static_cast<long long>(s_percentile(sortedLatencies, 0.90)),
+        static_cast<long long>(s_percentile(sortedLatencies, 0.99)),
+        static_cast<long long>(sortedLatencies.empty() ? 0 : sortedLatencies.back()));
+    fprintf(
+        stdout,
+        "Broker: %llu messages received, %llu delivered\n",
+        static_cast<unsigned long long>(broker.GetReceivedCount()),
+        static_cast<unsigned long long>(broker.GetDeliveredCount()));
+
+    if (connection->Disconnect())
+    {
+        connectionClosedPromise.get_future().wait();
+    }
+    broker.Stop();
+    return 0;
+}
@@ -0,0 +1,322 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/iotshadow/PayloadDecoder.h>
+#include <aws/iotshadow/PayloadEncoder.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowSchema.h>
+#include <aws/iotshadow/ShadowState.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "../../../samples/utils/CommandLineUtils.h"
+
+using namespace Aws::Crt;
+using namespace Aws::Iotshadow;
+
+/*
+ * Measures how fast a device state struct is read from a delta event and written into an update, through a
+ * ShadowSchema and through a JsonObject with the same fields looked up or set by name.
+ *
+ * Both ways of decoding the delta, and both ways of encoding the update, must give the same result before anything
+ * is timed.
+ */
+
+struct NetworkState
+{
+    String Ssid;
+    int64_t Rssi = 0;
+};
+
+struct DeviceState
+{
+    bool Power = false;
+    int64_t Brightness = 0;
+    int32_t FanSpeed = 0;
+    double Temperature = 0;
+    String Color;
+    String Firmware;
+    NetworkState Network;
+};
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        template <> struct ShadowSchema<NetworkState>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("ssid", &NetworkState::Ssid);
+                visitor.Field("rssi", &NetworkState::Rssi);
+            }
+        };
+
+        template <> struct ShadowSchema<DeviceState>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("power", &DeviceState::Power);
+                visitor.Field("brightness", &DeviceState::Brightness);
+                visitor.Field("fanSpeed", &DeviceState::FanSpeed);
+                visitor.Field("temperature", &DeviceState::Temperature);
+                visitor.Field("color", &DeviceState::Color);
+                visitor.Field("firmware", &DeviceState::Firmware);
+                visitor.Field("network", &DeviceState::Network);
+            }
+        };
+    } // namespace Iotshadow
+} // namespace Aws
+
+static DeviceState s_sampleState()
+{
+    DeviceState state;
+    state.Power = true;
+    state.Brightness = 80;
+    state.FanSpeed = 3;
+    state.Temperature = 21.5;
+    state.Color = "warm white";
+    state.Firmware = "1.4.2";
+    state.Network.Ssid = "shadow-schema-benchmark";
+    state.Network.Rssi = -61;
+    return state;
+}
+
+static String s_deltaPayload(const DeviceState &state)
+{
+    JsonObject network;
+    network.WithString("ssid", state.Network.Ssid);
+    network.WithInt64("rssi", state.Network.Rssi);
+    JsonObject delta;
+    delta.WithBool("power", state.Power);
+    delta.WithInt64("brightness", state.Brightness);
+    delta.WithInteger("fanSpeed", state.FanSpeed);
+    delta.WithDouble("temperature", state.Temperature);
+    delta.WithString("color", state.Color);
+    delta.WithString("firmware", state.Firmware);
+    delta.WithObject("network", network);
+    delta.WithString("unbound", "not in the schema");
+
+    JsonObject metadata;
+    metadata.WithObject("power", JsonObject().WithInt64("timestamp", 1700000000));
+    JsonObject payload;
+    payload.WithInt64("version", 4242);
+    payload.WithInt64("timestamp", 1700000000);
+    payload.WithObject("state", delta);
+    payload.WithObject("metadata", metadata);
+    return payload.View().WriteCompact(true);
+}
+
+/* The way a delta is read without a schema: decode the event, then look each field up in its state. */
+static void s_decodeWithJsonObject(const ByteCursor &payload, DeviceState &state)
+{
+    ShadowDeltaUpdatedEvent event;
+    DecodePayload(payload, event, PayloadDecoding::OnDemand);
+    if (!event.State)
+    {
+        return;
+    }
+    JsonView delta = event.State->View();
+    if (delta.ValueExists("power"))
+    {
+        state.Power = delta.GetBool("power");
+    }
+    if (delta.ValueExists("brightness"))
+    {
+        state.Brightness = delta.GetInt64("brightness");
+    }
+    if (delta.ValueExists("fanSpeed"))
+    {
+        state.FanSpeed = delta.GetInteger("fanSpeed");
+    }
+    if (delta.ValueExists("temperature"))
+    {
+        state.Temperature = delta.GetDouble("temperature");
+    }
+    if (delta.ValueExists("color"))
+    {
+        state.Color = delta.GetString("color");
+    }
+    if (delta.ValueExists("firmware"))
+    {
+        state.Firmware = delta.GetString("firmware");
+    }
+    if (delta.ValueExists("network"))
+    {
+        JsonView network = delta.GetJsonObject("network");
+        if (network.ValueExists("ssid"))
+        {
+            state.Network.Ssid = network.GetString("ssid");
+        }
+        if (network.ValueExists("rssi"))
+        {
+            state.Network.Rssi = network.GetInt64("rssi");
+        }
+    }
+}
+
+static void s_decodeWithSchema(const ByteCursor &payload, DeviceState &state)
+{
+    TypedShadowDelta<DeviceState> delta;
+    DecodeShadowDelta(payload, state, delta);
+}
+
+static bool s_encodeWithJsonObject(const DeviceState &state, ByteBuf &payload)
+{
+    JsonObject network;
+    network.WithString("ssid", state.Network.Ssid);
+    network.WithInt64("rssi", state.Network.Rssi);
+    JsonObject reported;
+    reported.WithBool("power", state.Power);
+    reported.WithInt64("brightness", state.Brightness);
+    reported.WithInteger("fanSpeed", state.FanSpeed);
+    reported.WithDouble("temperature", state.Temperature);
+    reported.WithString("color", state.Color);
+    reported.WithString("firmware", state.Firmware);
+    reported.WithObject("network", network);
+
+    ShadowState shadowState;
+    shadowState.Reported = reported;
+    UpdateShadowRequest request;
+    request.ThingName = "shadow-schema-benchmark";
+    request.State = shadowState;
+    request.Version = 4242;
+    return EncodePayload(request, payload);
+}
+
+static bool s_encodeWithSchema(const DeviceState &state, ByteBuf &payload)
+{
+    TypedShadowUpdate<DeviceState> update;
+    update.Reported = state;
+    update.ReportedFields = ShadowFieldSet<DeviceState>::All();
+    update.Version = 4242;
+    return EncodePayload(update, payload);
+}
+
+static bool s_sameState(const DeviceState &left, const DeviceState &right)
+{
+    return left.Power == right.Power && left.Brightness == right.Brightness && left.FanSpeed == right.FanSpeed &&
+           left.Temperature == right.Temperature && left.Color == right.Color && left.Firmware == right.Firmware &&
+           left.Network.Ssid == right.Network.Ssid && left.Network.Rssi == right.Network.Rssi;
+}
+
+static String s_encode(bool (*encode)(const DeviceState &, ByteBuf &), const DeviceState &state)
+{
+    ByteBuf payload;
+    aws_byte_buf_init(&payload, ApiAllocator(), 512);
+    String encoded;
+    if (encode(state, payload))
+    {
+        encoded.assign(reinterpret_cast<const char *>(payload.buffer), payload.len);
+    }
+    aws_byte_buf_clean_up(&payload);
+    return encoded;
+}
+
+static double s_decodeSeconds(void (*decode)(const ByteCursor &, DeviceState &), const String &payload, uint64_t n)
+{
+    ByteCursor cursor = ByteCursorFromCString(payload.c_str());
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        DeviceState state;
+        decode(cursor, state);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double s_encodeSeconds(bool (*encode)(const DeviceState &, ByteBuf &), const DeviceState &state, uint64_t n)
+{
+    ByteBuf payload;
+    aws_byte_buf_init(&payload, ApiAllocator(), 512);
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        aws_byte_buf_reset(&payload, false);
+        encode(state, payload);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    aws_byte_buf_clean_up(&payload);
+    return seconds;
+}
+
+static void s_print(const char *name, size_t bytes, uint64_t iterations, double jsonObjectSeconds, double schemaSeconds)
+{
+    fprintf(
+        stdout,
+        "%-24s %5zu bytes  JsonObject %8.0f/s  ShadowSchema %8.0f/s  (%.2fx)\n",
+        name,
+        bytes,
+        static_cast<double>(iterations) / jsonObjectSeconds,
+        static_cast<double>(iterations) / schemaSeconds,
+        jsonObjectSeconds / schemaSeconds);
+}
+
+int main(int argc, char *argv[])
+{
+    ApiHandle apiHandle;
+
+    Utils::CommandLineUtils cmdUtils = Utils::CommandLineUtils();
+    cmdUtils.RegisterProgramName("shadow-schema-benchmark");
+    cmdUtils.RegisterCommand(
+        "iterations", "<int>", "Decodes and encodes of each payload (optional, default='100000')");
+    cmdUtils.AddLoggingCommands();
+    const char **const_argv = (const char **)argv;
+    cmdUtils.SendArguments(const_argv, const_argv + argc);
+    cmdUtils.StartLoggingBasedOnCommand(&apiHandle);
+    if (cmdUtils.HasCommand("help"))
+    {
+        cmdUtils.PrintHelp();
+        exit(-1);
+    }
+
+    uint64_t iterations = std::max<uint64_t>(1, atoi(cmdUtils.GetCommandOrDefault("iterations", "100000").c_str()));
+    DeviceState sample = s_sampleState();
+    String delta = s_deltaPayload(sample);
+
+    /* The schema should find every field in the delta, and nothing else. */
+    DeviceState fromJsonObject;
+    DeviceState fromSchema;
+    TypedShadowDelta<DeviceState> typedDelta;
+    s_decodeWithJsonObject(ByteCursorFromCString(delta.c_str()), fromJsonObject);
+    bool decoded = DecodeShadowDelta(ByteCursorFromCString(delta.c_str()), fromSchema, typedDelta);
+    if (!decoded || !typedDelta.Version || *typedDelta.Version != 4242 || !typedDelta.State.Mismatched.IsEmpty() ||
+        !typedDelta.State.Changed.Contains(&DeviceState::Network) || !s_sameState(fromJsonObject, sample) ||
+        !s_sameState(fromSchema, sample))
+    {
+        fprintf(stderr, "Decoding the delta through the schema does not match decoding it through JsonObject\n");
+        return -1;
+    }
+
+    String encodedWithJsonObject = s_encode(s_encodeWithJsonObject, sample);
+    String encodedWithSchema = s_encode(s_encodeWithSchema, sample);
+    if (encodedWithSchema.empty() || encodedWithSchema != encodedWithJsonObject)
+    {
+        fprintf(
+            stderr,
+            "Encoding the update through the schema does not match encoding it through JsonObject:\n%s\n%s\n",
+            encodedWithSchema.c_str(),
+            encodedWithJsonObject.c_str());
+        return -1;
+    }
+
+    s_print(
+        "shadow/update/delta",
+        delta.size(),
+        iterations,
+        s_decodeSeconds(s_decodeWithJsonObject, delta, iterations),
+        s_decodeSeconds(s_decodeWithSchema, delta, iterations));
+    s_print(
+        "shadow/update",
+        encodedWithSchema.size(),
+        iterations,
+        s_encodeSeconds(s_encodeWithJsonObject, sample, iterations),
+        s_encodeSeconds(s_encodeWithSchema, sample, iterations));
+    return 0;
+}
@@ -0,0 +1,249 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/io/HostResolver.h>
+
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/GetShadowRequest.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/ShadowSync.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "../../../samples/utils/CommandLineUtils.h"
+#include "../../../samples/utils/LocalMqttBroker.h"
+#include "../../../samples/utils/ShadowServiceEmulator.h"
+
+using namespace Aws::Crt;
+using namespace Aws::Iotshadow;
+
+/*
+ * Checks that ShadowSync converges on the last of a storm of desired-state changes, against the shadow service
+ * emulator on a local broker, and reports how many updates the device needed to get there.
+ *
+ * A controller sets new desired values for three properties as fast as it can, without a version, while the device
+ * also changes one property locally. The device's updates therefore race with the controller's and some are
+ * rejected for their version. Once the storm is over, the shadow is read until its reported state matches its
+ * desired state.
+ */
+
+static std::shared_ptr<Mqtt::MqttConnection> s_connect(
+    Utils::LocalMqttBroker &broker,
+    Mqtt::MqttClient &mqttClient,
+    const char *clientId,
+    std::promise<void> &disconnected)
+{
+    std::shared_ptr<Mqtt::MqttConnection> connection = broker.NewConnection(mqttClient);
+    auto connectedPromise = std::make_shared<std::promise<bool>>();
+    connection->OnConnectionCompleted =
+        [connectedPromise](Mqtt::MqttConnection &, int errorCode, Mqtt::ReturnCode, bool) {
+            connectedPromise->set_value(errorCode == AWS_ERROR_SUCCESS);
+        };
+    connection->OnDisconnect = [&disconnected](Mqtt::MqttConnection &) { disconnected.set_value(); };
+    if (!connection->Connect(clientId, true, 0) || !connectedPromise->get_future().get())
+    {
+        fprintf(stderr, "Failed to connect %s to the local broker\n", clientId);
+        exit(-1);
+    }
+    return connection;
+}
+
+int main(int argc, char *argv[])
+{
+    ApiHandle apiHandle;
+
+    Utils::CommandLineUtils cmdUtils = Utils::CommandLineUtils();
+    cmdUtils.RegisterProgramName("shadow-sync-storm");
+    cmdUtils.RegisterCommand("updates", "<int>", "Desired-state changes in the storm (optional, default='1000')");
+    cmdUtils.RegisterCommand(
+        "debounce", "<int>", "ShadowSync debounce interval in milliseconds (optional, default='100')");
+    cmdUtils.RegisterCommand(
+        "timeout", "<int>", "Seconds to wait for the shadow to converge (optional, default='30')");
+    cmdUtils.AddLoggingCommands();
+    const char **const_argv = (const char **)argv;
+    cmdUtils.SendArguments(const_argv, const_argv + argc);
+    cmdUtils.StartLoggingBasedOnCommand(&apiHandle);
+    if (cmdUtils.HasCommand("help"))
+    {
+        cmdUtils.PrintHelp();
+        exit(-1);
+    }
+
+    int64_t updateCount = std::max(1, atoi(cmdUtils.GetCommandOrDefault("updates", "1000").c_str()));
+    int debounceMilliseconds = std::max(0, atoi(cmdUtils.GetCommandOrDefault("debounce", "100").c_str()));
+    int timeoutSeconds = std::max(1, atoi(cmdUtils.GetCommandOrDefault("timeout", "30").c_str()));
+    const String thingName("shadow-sync-storm");
+
+    Io::EventLoopGroup eventLoopGroup(2);
+    Io::DefaultHostResolver hostResolver(eventLoopGroup, 8, 30);
+    Io::ClientBootstrap bootstrap(eventLoopGroup, hostResolver);
+    Mqtt::MqttClient mqttClient(bootstrap);
+
+    Utils::LocalMqttBroker broker(eventLoopGroup);
+    if (!broker.Start())
+    {
+        fprintf(stderr, "Failed to start the local broker: %s\n", ErrorDebugString(LastError()));
+        exit(-1);
+    }
+    Utils::ShadowServiceEmulator emulator(broker);
+
+    std::promise<void> deviceDisconnected;
+    std::promise<void> controllerDisconnected;
+    auto deviceConnection = s_connect(broker, mqttClient, "shadow-sync-storm-device", deviceDisconnected);
+    auto controllerConnection = s_connect(broker, mqttClient, "shadow-sync-storm-controller", controllerDisconnected);
+
+    /* The device takes every desired value it is offered. */
+    std::atomic<uint64_t> offeredCount(0);
+    std::atomic<uint64_t> errorCount(0);
+    ShadowSyncOptions options;
+    options.ThingName = thingName;
+    options.DebounceInterval = std::chrono::milliseconds(debounceMilliseconds);
+    options.EventLoopGroup = &eventLoopGroup;
+    options.OnError = [&errorCount](int ioErr, const ErrorResponse *rejection) {
+        fprintf(
+            stderr,
+            "ShadowSync request failed: %s\n",
+            rejection != nullptr && rejection->Message ? rejection->Message->c_str() : ErrorDebugString(ioErr));
+        errorCount.fetch_add(1);
+    };
+    auto deviceClient = std::make_shared<IotShadowClient>(deviceConnection);
+    auto sync = std::make_shared<ShadowSync>(deviceClient, options);
+    sync->BindProperty<String>("color", String("off"), [&offeredCount](const String &) {
+        offeredCount.fetch_add(1);
+        return true;
+    });
+    sync->BindProperty<int64_t>("brightness", 0, [&offeredCount](const int64_t &) {
+        offeredCount.fetch_add(1);
+        return true;
+    });
+    sync->BindProperty<String>("config.mode", String("auto"), [&offeredCount](const String &) {
+        offeredCount.fetch_add(1);
+        return true;
+    });
+    sync->BindProperty<int64_t>("uptime", 0);
+
+    std::promise<bool> startedPromise;
+    sync->Start([&startedPromise](int ioErr, const ErrorResponse *rejection) {
+        startedPromise.set_value(ioErr == AWS_ERROR_SUCCESS && rejection == nullptr);
+    });
+    if (!startedPromise.get_future().get())
+    {
+        fprintf(stderr, "ShadowSync failed to start\n");
+        exit(-1);
+    }
+
+    IotShadowClient controllerClient(controllerConnection);
+    std::mutex shadowMutex;
+    std::shared_ptr<std::promise<JsonObject>> shadowPromise;
+    GetShadowSubscriptionRequest getSubscriptionRequest;
+    getSubscriptionRequest.ThingName = thingName;
+    std::promise<int> getSubAck;
+    auto onGetAccepted = [&](GetShadowResponse *response, int ioErr) {
+        std::lock_guard<std::mutex> lock(shadowMutex);
+        if (ioErr == AWS_ERROR_SUCCESS && response != nullptr && shadowPromise)
+        {
+            JsonObject document;
+            response->SerializeToObject(document);
+            shadowPromise->set_value(document);
+            shadowPromise.reset();
+        }
+    };
+    ScopedSubscription getAccepted = controllerClient.SubscribeToGetShadowAccepted(
+        getSubscriptionRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, onGetAccepted, [&getSubAck](int ioErr) {
+            getSubAck.set_value(ioErr);
+        });
+    if (getSubAck.get_future().get() != AWS_ERROR_SUCCESS)
+    {
+        fprintf(stderr, "Failed to subscribe the controller to get/accepted\n");
+        exit(-1);
+    }
+    uint64_t updatesBeforeStorm = emulator.GetAcceptedUpdateCount();
+
+    fprintf(stdout, "Publishing %lld desired-state changes\n", static_cast<long long>(updateCount));
+    auto start = std::chrono::steady_clock::now();
+    const char *modes[] = {"auto", "eco", "boost"};
+    for (int64_t i = 1; i <= updateCount; ++i)
+    {
+        JsonObject desired;
+        desired.WithString("color", String("color-") + std::to_string(i).c_str());
+        desired.WithInt64("brightness", i * 3);
+        desired.WithObject("config", JsonObject().WithString("mode", modes[i % 3]));
+        ShadowState state;
+        state.Desired = desired;
+        UpdateShadowRequest request;
+        request.ThingName = thingName;
+        request.State = state;
+        controllerClient.PublishUpdateShadow(request, AWS_MQTT_QOS_AT_LEAST_ONCE, [](int) {});
+        if (i % 100 == 0)
+        {
+            sync->SetProperty<int64_t>("uptime", i);
+        }
+    }
+
+    /* The shadow has converged once nothing desired differs from what is reported. */
+    bool converged = false;
+    JsonObject shadow;
+    auto deadline = start + std::chrono::seconds(timeoutSeconds);
+    while (!converged && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::future<JsonObject> shadowFuture;
+        {
+            std::lock_guard<std::mutex> lock(shadowMutex);
+            shadowPromise = std::make_shared<std::promise<JsonObject>>();
+            shadowFuture = shadowPromise->get_future();
+        }
+        GetShadowRequest getRequest;
+        getRequest.ThingName = thingName;
+        controllerClient.PublishGetShadow(getRequest, AWS_MQTT_QOS_AT_LEAST_ONCE, [](int) {});
+        if (shadowFuture.wait_for(std::chrono::seconds(1)) != std::future_status::ready)
+        {
+            continue;
+        }
+        shadow = shadowFuture.get();
+        JsonView state = shadow.View().GetJsonObject("state");
+        converged = !state.ValueExists("delta") && state.ValueExists("reported") &&
+                    state.GetJsonObject("reported").GetInt64("uptime") == (updateCount / 100) * 100;
+    }
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    /* Every update from the controller is accepted, since it carries no version. */
+    uint64_t acceptedUpdates = emulator.GetAcceptedUpdateCount() - updatesBeforeStorm;
+    uint64_t deviceUpdates = acceptedUpdates - std::min(acceptedUpdates, static_cast<uint64_t>(updateCount));
+    fprintf(
+        stdout,
+        "%s in %.2f s: %llu desired values offered to the device, %llu device updates accepted, %llu errors\n",
+        converged ? "Converged" : "Did not converge",
+        elapsedSeconds,
+        static_cast<unsigned long long>(offeredCount.load()),
+        static_cast<unsigned long long>(deviceUpdates),
+        static_cast<unsigned long long>(errorCount.load()));
+    if (!converged)
+    {
+        fprintf(stderr, "Last shadow read: %s\n", shadow.View().WriteCompact(true).c_str());
+    }
+
+    sync->Stop();
+    sync.reset();
+    if (deviceConnection->Disconnect())
+    {
+        deviceDisconnected.get_future().wait();
+    }
+    if (controllerConnection->Disconnect())
+    {
+        controllerDisconnected.get_future().wait();
+    }
+    broker.Stop();
+    return converged ? 0 : -1;
+}
@@ -47,7 +47,7 @@ void changeNamedShadowValue(
     String shadowName,
     std::shared_ptr<IotShadowClient> shadowClient);
 
-void subscribeNamedShadowUpdatedValue(
+SubscriptionHandle subscribeNamedShadowUpdatedValue(
     Aws::Crt::String thingName,
     String property,
     String value,
@@ -61,7 +61,7 @@ void changeShadowValue(
     String value,
     std::shared_ptr<IotShadowClient> shadowClient);
 
-void subscribeShadowUpdatedValue(
+SubscriptionHandle subscribeShadowUpdatedValue(
     Aws::Crt::String thingName,
     String property,
     String value,
@@ -249,7 +249,7 @@ int main(int argc, char *argv[])
         if (cmdData.input_shadowName.empty())
         {
             std::promise<void> gotResponse;
-            subscribeShadowUpdatedValue(
+            ScopedSubscription updated = subscribeShadowUpdatedValue(
                 cmdData.input_thingName,
                 cmdData.input_shadowProperty,
                 cmdData.input_shadowValue,
@@ -269,7 +269,7 @@ int main(int argc, char *argv[])
         else
         {
             std::promise<void> gotResponse;
-            subscribeNamedShadowUpdatedValue(
+            ScopedSubscription updated = subscribeNamedShadowUpdatedValue(
                 cmdData.input_thingName,
                 cmdData.input_shadowProperty,
                 cmdData.input_shadowValue,
@@ -316,7 +316,7 @@ int main(int argc, char *argv[])
     return 0;
 }
 
-void subscribeShadowUpdatedValue(
+SubscriptionHandle subscribeShadowUpdatedValue(
     Aws::Crt::String thingName,
     String property,
     String value,
@@ -355,12 +355,13 @@ void subscribeShadowUpdatedValue(
     /* subscribe to event updates */
     ShadowUpdatedSubscriptionRequest requestUpdate;
     requestUpdate.ThingName = thingName;
-    shadowClient->SubscribeToShadowUpdatedEvents(
+    SubscriptionHandle subscription = shadowClient->SubscribeToShadowUpdatedEvents(
         requestUpdate, AWS_MQTT_QOS_AT_LEAST_ONCE, (handler), (publishCompleted));
     shadowCompletedPromise.get_future().get();
+    return subscription;
 }
 
-void subscribeNamedShadowUpdatedValue(
+SubscriptionHandle subscribeNamedShadowUpdatedValue(
     Aws::Crt::String thingName,
     String property,
     String value,
@@ -401,9 +402,10 @@ void subscribeNamedShadowUpdatedValue(
     NamedShadowUpdatedSubscriptionRequest requestUpdate;
     requestUpdate.ThingName = thingName;
     requestUpdate.ShadowName = shadowName;
-    shadowClient->SubscribeToNamedShadowUpdatedEvents(
+    SubscriptionHandle subscription = shadowClient->SubscribeToNamedShadowUpdatedEvents(
         requestUpdate, AWS_MQTT_QOS_AT_LEAST_ONCE, handler, std::move(publishCompleted));
     shadowCompletedPromise.get_future().get();
+    return subscription;
 }
 
 void changeShadowValue(
@@ -7,6 +7,7 @@
  */
 
 #include <aws/iotshadow/Exports.h>
+#include <aws/iotshadow/SubscriptionHandle.h>
 
 #include <aws/crt/StlAllocator.h>
 #include <aws/crt/Types.h>
@@ -32,6 +33,7 @@ namespace Aws
         class GetShadowSubscriptionRequest;
         class NamedShadowDeltaUpdatedSubscriptionRequest;
         class NamedShadowUpdatedSubscriptionRequest;
+        class PublishBufferPool;
         class ShadowDeltaUpdatedEvent;
         class ShadowDeltaUpdatedSubscriptionRequest;
         class ShadowUpdatedEvent;
@@ -42,6 +44,8 @@ namespace Aws
         class UpdateShadowResponse;
         class UpdateShadowSubscriptionRequest;
 
+        template <typename Struct> struct TypedShadowUpdate;
+
         using OnSubscribeComplete = std::function<void(int ioErr)>;
         using OnPublishComplete = std::function<void(int ioErr)>;
 
@@ -103,12 +107,37 @@ namespace Aws
         class AWS_IOTSHADOW_API IotShadowClient final
         {
           public:
-            IotShadowClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection);
-            IotShadowClient(const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client);
+            /**
+             * @param allocator Allocates the client's publish buffers and subscription bookkeeping. The client counts
+             * what it allocates; see GetAllocatedBytes.
+             */
+            IotShadowClient(
+                const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+                Aws::Crt::Allocator *allocator = Aws::Crt::ApiAllocator());
+            IotShadowClient(
+                const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client,
+                Aws::Crt::Allocator *allocator = Aws::Crt::ApiAllocator());
 
             operator bool() const noexcept;
             int GetLastError() const noexcept;
 
+            /**
+             * @return The allocator the client allocates with, which counts allocations before passing them on to
+             * the allocator the client was created with.
+             */
+            Aws::Crt::Allocator *GetAllocator() const noexcept;
+
+            /**
+             * @return The number of bytes the client has allocated and not yet freed. Buffers of publishes that are
+             * still in flight, and buffers kept for reuse, are included.
+             */
+            size_t GetAllocatedBytes() const noexcept;
+
+            /**
+             * @return The number of allocations the client has made and not yet freed.
+             */
+            size_t GetAllocationCount() const noexcept;
+
             /**
              * Subscribes to the accepted topic for the DeleteNamedShadow operation.
              *
@@ -126,9 +155,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToDeleteNamedShadowAccepted(
+            SubscriptionHandle SubscribeToDeleteNamedShadowAccepted(
                 const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDeleteNamedShadowAcceptedResponse &handler,
@@ -151,9 +181,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToDeleteNamedShadowRejected(
+            SubscriptionHandle SubscribeToDeleteNamedShadowRejected(
                 const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDeleteNamedShadowRejectedResponse &handler,
@@ -176,9 +207,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToDeleteShadowAccepted(
+            SubscriptionHandle SubscribeToDeleteShadowAccepted(
                 const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDeleteShadowAcceptedResponse &handler,
@@ -201,9 +233,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToDeleteShadowRejected(
+            SubscriptionHandle SubscribeToDeleteShadowRejected(
                 const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToDeleteShadowRejectedResponse &handler,
@@ -226,9 +259,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToGetNamedShadowAccepted(
+            SubscriptionHandle SubscribeToGetNamedShadowAccepted(
                 const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetNamedShadowAcceptedResponse &handler,
@@ -251,9 +285,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToGetNamedShadowRejected(
+            SubscriptionHandle SubscribeToGetNamedShadowRejected(
                 const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetNamedShadowRejectedResponse &handler,
@@ -276,9 +311,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToGetShadowAccepted(
+            SubscriptionHandle SubscribeToGetShadowAccepted(
                 const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetShadowAcceptedResponse &handler,
@@ -301,9 +337,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToGetShadowRejected(
+            SubscriptionHandle SubscribeToGetShadowRejected(
                 const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToGetShadowRejectedResponse &handler,
@@ -326,9 +363,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToNamedShadowDeltaUpdatedEvents(
+            SubscriptionHandle SubscribeToNamedShadowDeltaUpdatedEvents(
                 const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler,
@@ -351,9 +389,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToNamedShadowUpdatedEvents(
+            SubscriptionHandle SubscribeToNamedShadowUpdatedEvents(
                 const Aws::Iotshadow::NamedShadowUpdatedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToNamedShadowUpdatedEventsResponse &handler,
@@ -376,9 +415,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToShadowDeltaUpdatedEvents(
+            SubscriptionHandle SubscribeToShadowDeltaUpdatedEvents(
                 const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler,
@@ -401,9 +441,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToShadowUpdatedEvents(
+            SubscriptionHandle SubscribeToShadowUpdatedEvents(
                 const Aws::Iotshadow::ShadowUpdatedSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToShadowUpdatedEventsResponse &handler,
@@ -426,9 +467,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToUpdateNamedShadowAccepted(
+            SubscriptionHandle SubscribeToUpdateNamedShadowAccepted(
                 const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateNamedShadowAcceptedResponse &handler,
@@ -451,9 +493,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToUpdateNamedShadowRejected(
+            SubscriptionHandle SubscribeToUpdateNamedShadowRejected(
                 const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateNamedShadowRejectedResponse &handler,
@@ -476,9 +519,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToUpdateShadowAccepted(
+            SubscriptionHandle SubscribeToUpdateShadowAccepted(
                 const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateShadowAcceptedResponse &handler,
@@ -501,9 +545,10 @@ namespace Aws
              * @param handler callback function to invoke with messages received on the subscription topic
              * @param onSubAck callback function invoked on receipt of the SUBACK from the server
              *
-             * @return true if the subscribe was successfully queued, false if there was an error doing so
+             * @return a handle to the subscription, which converts to false if there was an error queueing the
+             * subscribe. The subscription stays in place until the handle is unsubscribed.
              */
-            bool SubscribeToUpdateShadowRejected(
+            SubscriptionHandle SubscribeToUpdateShadowRejected(
                 const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
                 Aws::Crt::Mqtt::QOS qos,
                 const OnSubscribeToUpdateShadowRejectedResponse &handler,
@@ -647,8 +692,59 @@ namespace Aws
                 Aws::Crt::Mqtt::QOS qos,
                 const OnPublishComplete &onPubAck);
 
+            /**
+             * Publish a UpdateNamedShadow message whose state is held in structs with a ShadowSchema. The payload is
+             * written from the structs directly; include ShadowSchema.h to use this.
+             */
+            template <typename Struct>
+            bool PublishUpdateNamedShadow(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::String &shadowName,
+                const TypedShadowUpdate<Struct> &update,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck)
+            {
+                return PublishEncodedUpdate(
+                    thingName,
+                    &shadowName,
+                    [&update](Aws::Crt::ByteBuf &payload) { return EncodePayload(update, payload); },
+                    qos,
+                    onPubAck);
+            }
+
+            /**
+             * Publish a UpdateShadow message whose state is held in structs with a ShadowSchema. The payload is
+             * written from the structs directly; include ShadowSchema.h to use this.
+             */
+            template <typename Struct>
+            bool PublishUpdateShadow(
+                const Aws::Crt::String &thingName,
+                const TypedShadowUpdate<Struct> &update,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck)
+            {
+                return PublishEncodedUpdate(
+                    thingName,
+                    nullptr,
+                    [&update](Aws::Crt::ByteBuf &payload) { return EncodePayload(update, payload); },
+                    qos,
+                    onPubAck);
+            }
+
           private:
+            bool PublishEncodedUpdate(
+                const Aws::Crt::String &thingName,
+                const Aws::Crt::String *shadowName,
+                const std::function<bool(Aws::Crt::ByteBuf &payload)> &encodePayload,
+                Aws::Crt::Mqtt::QOS qos,
+                const OnPublishComplete &onPubAck);
+
+            /* Counts what the client allocates. Shared with the buffer pool and subscription registry, which may
+             * outlive the client. */
+            std::shared_ptr<Aws::Crt::Allocator> m_allocator;
             std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> m_connection;
+            std::shared_ptr<SubscriptionRegistry> m_subscriptions;
+            std::shared_ptr<PublishBufferPool> m_publishBuffers;
         };
 
     } // namespace Iotshadow
@@ -0,0 +1,18 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotservicecommon/OfflinePublishLog.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        /**
+         * The file ShadowUpdateQueue keeps its updates in. See Aws::Iotservicecommon::OfflinePublishLog.
+         */
+        using OfflinePublishLog = Aws::Iotservicecommon::OfflinePublishLog;
+    } // namespace Iotshadow
+} // namespace Aws
@@ -0,0 +1,79 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Types.h>
+#include <aws/iotservicecommon/PayloadReader.h>
+
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/Exports.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowUpdatedEvent.h>
+#include <aws/iotshadow/UpdateShadowResponse.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        using JsonPayloadValue = Aws::Iotservicecommon::JsonPayloadValue;
+        using JsonPayloadReader = Aws::Iotservicecommon::JsonPayloadReader;
+
+        /**
+         * How a payload is decoded into a model.
+         */
+        enum class PayloadDecoding
+        {
+            /**
+             * Parse the payload into a Crt::JsonObject, then load the model from it.
+             */
+            JsonObject,
+            /**
+             * Decode the model's fields directly from the payload with a JsonPayloadReader. A payload the reader
+             * cannot decode, such as one with escaped keys or values of unexpected types, is decoded with JsonObject
+             * instead.
+             */
+            OnDemand,
+        };
+
+        /**
+         * Decode a payload into a model. The models received most often are decoded on demand; the others always
+         * go through JsonObject.
+         */
+        template <typename Model>
+        void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            Model &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand)
+        {
+            (void)decoding;
+            Aws::Crt::String objectStr(reinterpret_cast<const char *>(payload.ptr), payload.len);
+            Aws::Crt::JsonObject jsonObject(objectStr);
+            model = jsonObject.View();
+        }
+
+        AWS_IOTSHADOW_API void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            ShadowDeltaUpdatedEvent &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand);
+        AWS_IOTSHADOW_API void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            ShadowUpdatedEvent &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand);
+        AWS_IOTSHADOW_API void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            UpdateShadowResponse &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand);
+        AWS_IOTSHADOW_API void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            GetShadowResponse &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand);
+        AWS_IOTSHADOW_API void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            ErrorResponse &model,
+            PayloadDecoding decoding = PayloadDecoding::OnDemand);
+    } // namespace Iotshadow
+} // namespace Aws
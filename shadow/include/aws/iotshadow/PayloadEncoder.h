@@ -0,0 +1,41 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/crt/Types.h>
+#include <aws/iotservicecommon/PayloadWriter.h>
+
+#include <aws/iotshadow/DeleteNamedShadowRequest.h>
+#include <aws/iotshadow/DeleteShadowRequest.h>
+#include <aws/iotshadow/Exports.h>
+#include <aws/iotshadow/GetNamedShadowRequest.h>
+#include <aws/iotshadow/GetShadowRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        /* The writer and buffer pool are shared with the other service clients. */
+        using JsonPayloadWriter = Aws::Iotservicecommon::JsonPayloadWriter;
+        using PublishBufferPool = Aws::Iotservicecommon::PublishBufferPool;
+
+        /**
+         * Serialize a request into `payload` as SerializeToObject would, without building a JsonObject.
+         * @return false if `payload` could not be grown.
+         */
+        AWS_IOTSHADOW_API bool EncodePayload(
+            const DeleteNamedShadowRequest &request,
+            Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTSHADOW_API bool EncodePayload(const DeleteShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTSHADOW_API bool EncodePayload(const GetNamedShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTSHADOW_API bool EncodePayload(const GetShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTSHADOW_API bool EncodePayload(
+            const UpdateNamedShadowRequest &request,
+            Aws::Crt::ByteBuf &payload) noexcept;
+        AWS_IOTSHADOW_API bool EncodePayload(const UpdateShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept;
+    } // namespace Iotshadow
+} // namespace Aws
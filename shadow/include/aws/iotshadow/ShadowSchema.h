@@ -0,0 +1,617 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotshadow/PayloadDecoder.h>
+#include <aws/iotshadow/PayloadEncoder.h>
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Optional.h>
+#include <aws/crt/Types.h>
+
+#include <aws/common/assert.h>
+
+#include <limits>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        /**
+         * Maps the fields of a struct to the members of a shadow state object. Specialize it for each struct to be
+         * bound, with a static Describe that names every field to the visitor it is given:
+         *
+         *     template <> struct ShadowSchema<LightState>
+         *     {
+         *         template <typename Visitor> static void Describe(Visitor &visitor)
+         *         {
+         *             visitor.Field("color", &LightState::Color);
+         *             visitor.Field("brightness", &LightState::Brightness);
+         *             visitor.Field("config", &LightState::Config);
+         *         }
+         *     };
+         *
+         * A field may be a bool, int32_t, int64_t, double, Crt::String or Crt::JsonObject, or a struct with a schema
+         * of its own, which maps to a nested object. A struct may have at most 64 fields.
+         *
+         * Every encoder and decoder instantiates Describe with its own visitor, so the names and member pointers are
+         * constants to the compiler: no table of fields exists at run time, and only Crt::JsonObject fields are ever
+         * parsed into a document.
+         */
+        template <typename Struct> struct ShadowSchema;
+
+        namespace ShadowSchemaDetail
+        {
+            inline uint64_t FieldBit(size_t index) noexcept
+            {
+                AWS_FATAL_ASSERT(index < 64 && "A ShadowSchema may have at most 64 fields");
+                return uint64_t(1) << index;
+            }
+
+            /* Finds the bit of a field within a ShadowFieldSet, which is its position in Describe. */
+            template <typename Struct, typename Member> class FieldBitFinder final
+            {
+              public:
+                explicit FieldBitFinder(Member Struct::*member) noexcept : m_member(member), m_index(0), m_bit(0) {}
+
+                void Field(const char *, Member Struct::*member) noexcept
+                {
+                    if (m_bit == 0 && member == m_member)
+                    {
+                        m_bit = FieldBit(m_index);
+                    }
+                    ++m_index;
+                }
+
+                template <typename Other> void Field(const char *, Other Struct::*) noexcept { ++m_index; }
+
+                uint64_t GetBit() const noexcept { return m_bit; }
+
+              private:
+                Member Struct::*m_member;
+                size_t m_index;
+                uint64_t m_bit;
+            };
+        } // namespace ShadowSchemaDetail
+
+        /**
+         * A set of the fields of a struct with a ShadowSchema.
+         */
+        template <typename Struct> class ShadowFieldSet final
+        {
+          public:
+            ShadowFieldSet() noexcept : m_bits(0) {}
+
+            static ShadowFieldSet All() noexcept
+            {
+                ShadowFieldSet all;
+                all.m_bits = ~uint64_t(0);
+                return all;
+            }
+
+            /**
+             * Add a field. Members that are not in the schema are not added.
+             */
+            template <typename T> ShadowFieldSet &Add(T Struct::*member) noexcept
+            {
+                m_bits |= s_bitOf(member);
+                return *this;
+            }
+
+            template <typename T> bool Contains(T Struct::*member) const noexcept
+            {
+                return (m_bits & s_bitOf(member)) != 0;
+            }
+
+            bool IsEmpty() const noexcept { return m_bits == 0; }
+
+            ShadowFieldSet &operator|=(const ShadowFieldSet &other) noexcept
+            {
+                m_bits |= other.m_bits;
+                return *this;
+            }
+
+            /**
+             * Add or look up the field at `index`, its position in the schema's Describe.
+             */
+            void AddIndex(size_t index) noexcept { m_bits |= ShadowSchemaDetail::FieldBit(index); }
+            bool ContainsIndex(size_t index) const noexcept
+            {
+                return (m_bits & ShadowSchemaDetail::FieldBit(index)) != 0;
+            }
+
+          private:
+            template <typename T> static uint64_t s_bitOf(T Struct::*member) noexcept
+            {
+                ShadowSchemaDetail::FieldBitFinder<Struct, T> finder(member);
+                ShadowSchema<Struct>::Describe(finder);
+                return finder.GetBit();
+            }
+
+            uint64_t m_bits;
+        };
+
+        /**
+         * What decoding a state object found out about each field of a struct.
+         */
+        template <typename Struct> struct ShadowFieldChanges
+        {
+            /**
+             * Fields with a value in the object. Null values, which delete a field from the shadow, are not counted.
+             */
+            ShadowFieldSet<Struct> Present;
+
+            /**
+             * Present fields whose value differs from the one they had before decoding.
+             */
+            ShadowFieldSet<Struct> Changed;
+
+            /**
+             * Present fields whose value was not of the field's type, and which were therefore left as they were.
+             * A nested struct is mismatched if any of its own fields are, though its other fields are still read.
+             */
+            ShadowFieldSet<Struct> Mismatched;
+        };
+
+        template <typename Struct>
+        void EncodeShadowFields(
+            JsonPayloadWriter &writer,
+            const Struct &value,
+            const ShadowFieldSet<Struct> &fields) noexcept;
+
+        template <typename Struct>
+        bool DecodeShadowFields(const JsonPayloadValue &object, Struct *value, ShadowFieldChanges<Struct> &changes);
+
+        /**
+         * Reads and writes the value of one field. The primary template handles structs with a schema of their own.
+         */
+        template <typename T> struct ShadowFieldCodec
+        {
+            static void Write(JsonPayloadWriter &writer, const char *name, const T &value) noexcept
+            {
+                writer.BeginObject(name);
+                EncodeShadowFields(writer, value, ShadowFieldSet<T>::All());
+                writer.EndObject();
+            }
+
+            /**
+             * Nested objects are merged into the struct, as the service merges them into the shadow.
+             */
+            static bool Read(const JsonPayloadValue &json, T &value, bool &changed)
+            {
+                ShadowFieldChanges<T> changes;
+                bool decoded = DecodeShadowFields(json, &value, changes);
+                changed = !changes.Changed.IsEmpty();
+                return decoded && changes.Mismatched.IsEmpty();
+            }
+        };
+
+        template <> struct ShadowFieldCodec<bool>
+        {
+            static void Write(JsonPayloadWriter &writer, const char *name, bool value) noexcept
+            {
+                writer.WithBool(name, value);
+            }
+
+            static bool Read(const JsonPayloadValue &json, bool &value, bool &changed) noexcept
+            {
+                bool decoded = false;
+                if (!json.GetBool(decoded))
+                {
+                    return false;
+                }
+                changed = decoded != value;
+                value = decoded;
+                return true;
+            }
+        };
+
+        template <> struct ShadowFieldCodec<int32_t>
+        {
+            static void Write(JsonPayloadWriter &writer, const char *name, int32_t value) noexcept
+            {
+                writer.WithInt64(name, value);
+            }
+
+            static bool Read(const JsonPayloadValue &json, int32_t &value, bool &changed) noexcept
+            {
+                int64_t decoded = 0;
+                if (!json.GetInt64(decoded) || decoded < (std::numeric_limits<int32_t>::min)() ||
+                    decoded > (std::numeric_limits<int32_t>::max)())
+                {
+                    return false;
+                }
+                changed = decoded != value;
+                value = static_cast<int32_t>(decoded);
+                return true;
+            }
+        };
+
+        template <> struct ShadowFieldCodec<int64_t>
+        {
+            static void Write(JsonPayloadWriter &writer, const char *name, int64_t value) noexcept
+            {
+                writer.WithInt64(name, value);
+            }
+
+            static bool Read(const JsonPayloadValue &json, int64_t &value, bool &changed) noexcept
+            {
+                int64_t decoded = 0;
+                if (!json.GetInt64(decoded))
+                {
+                    return false;
+                }
+                changed = decoded != value;
+                value = decoded;
+                return true;
+            }
+        };
+
+        template <> struct ShadowFieldCodec<double>
+        {
+            static void Write(JsonPayloadWriter &writer, const char *name, double value) noexcept
+            {
+                writer.WithDouble(name, value);
+            }
+
+            static bool Read(const JsonPayloadValue &json, double &value, bool &changed) noexcept
+            {
+                double decoded = 0;
+                if (!json.GetDouble(decoded))
+                {
+                    return false;
+                }
+                changed = decoded != value;
+                value = decoded;
+                return true;
+            }
+        };
+
+        template <> struct ShadowFieldCodec<Aws::Crt::String>
+        {
+            static void Write(JsonPayloadWriter &writer, const char *name, const Aws::Crt::String &value) noexcept
+            {
+                writer.WithString(name, value);
+            }
+
+            static bool Read(const JsonPayloadValue &json, Aws::Crt::String &value, bool &changed)
+            {
+                Aws::Crt::String decoded;
+                if (!json.GetString(decoded))
+                {
+                    return false;
+                }
+                changed = decoded != value;
+                value = std::move(decoded);
+                return true;
+            }
+        };
+
+        /**
+         * A Crt::JsonObject field holds whatever value its member has, and is the one kind of field that is parsed
+         * into a document.
+         */
+        template <> struct ShadowFieldCodec<Aws::Crt::JsonObject>
+        {
+            static void Write(JsonPayloadWriter &writer, const char *name, const Aws::Crt::JsonObject &value) noexcept
+            {
+                writer.WithObject(name, value);
+            }
+
+            static bool Read(const JsonPayloadValue &json, Aws::Crt::JsonObject &value, bool &changed)
+            {
+                Aws::Crt::JsonObject decoded;
+                if (!json.GetJsonObject(decoded))
+                {
+                    return false;
+                }
+                changed = decoded.View().WriteCompact(true) != value.View().WriteCompact(true);
+                value = std::move(decoded);
+                return true;
+            }
+        };
+
+        namespace ShadowSchemaDetail
+        {
+            template <typename Struct> class FieldWriter final
+            {
+              public:
+                FieldWriter(
+                    JsonPayloadWriter &writer,
+                    const Struct &value,
+                    const ShadowFieldSet<Struct> &fields) noexcept
+                    : m_writer(writer), m_value(value), m_fields(fields), m_index(0)
+                {
+                }
+
+                template <typename T> void Field(const char *name, T Struct::*member) noexcept
+                {
+                    if (m_fields.ContainsIndex(m_index))
+                    {
+                        ShadowFieldCodec<T>::Write(m_writer, name, m_value.*member);
+                    }
+                    ++m_index;
+                }
+
+              private:
+                JsonPayloadWriter &m_writer;
+                const Struct &m_value;
+                const ShadowFieldSet<Struct> &m_fields;
+                size_t m_index;
+            };
+
+            /* Reads one member of a state object into the field named by its key, if there is one. */
+            template <typename Struct> class FieldReader final
+            {
+              public:
+                FieldReader(
+                    const Aws::Crt::ByteCursor &key,
+                    const JsonPayloadValue &json,
+                    Struct *value,
+                    ShadowFieldChanges<Struct> &changes) noexcept
+                    : m_key(key), m_json(json), m_value(value), m_changes(changes), m_index(0), m_found(false)
+                {
+                }
+
+                template <typename T> void Field(const char *name, T Struct::*member)
+                {
+                    size_t index = m_index++;
+                    if (m_found || !aws_byte_cursor_eq_c_str(&m_key, name))
+                    {
+                        return;
+                    }
+                    m_found = true;
+                    m_changes.Present.AddIndex(index);
+                    if (m_value == nullptr)
+                    {
+                        return;
+                    }
+
+                    bool changed = false;
+                    if (!ShadowFieldCodec<T>::Read(m_json, m_value->*member, changed))
+                    {
+                        m_changes.Mismatched.AddIndex(index);
+                    }
+                    if (changed)
+                    {
+                        m_changes.Changed.AddIndex(index);
+                    }
+                }
+
+              private:
+                const Aws::Crt::ByteCursor &m_key;
+                const JsonPayloadValue &m_json;
+                Struct *m_value;
+                ShadowFieldChanges<Struct> &m_changes;
+                size_t m_index;
+                bool m_found;
+            };
+
+            inline bool ReadInt32(const JsonPayloadValue &json, Aws::Crt::Optional<int32_t> &value) noexcept
+            {
+                int32_t decoded = 0;
+                bool changed = false;
+                if (!ShadowFieldCodec<int32_t>::Read(json, decoded, changed))
+                {
+                    return false;
+                }
+                value = decoded;
+                return true;
+            }
+        } // namespace ShadowSchemaDetail
+
+        /**
+         * Write the fields in `fields` as members of the object `writer` is writing.
+         */
+        template <typename Struct>
+        void EncodeShadowFields(
+            JsonPayloadWriter &writer,
+            const Struct &value,
+            const ShadowFieldSet<Struct> &fields) noexcept
+        {
+            ShadowSchemaDetail::FieldWriter<Struct> fieldWriter(writer, value, fields);
+            ShadowSchema<Struct>::Describe(fieldWriter);
+        }
+
+        /**
+         * Read a state object into the fields of `value`, leaving fields the object has no value for as they were.
+         * Members that are not in the schema are skipped without being parsed.
+         *
+         * @param value If null, the fields present in the object are found but not read.
+         * @return false if `object` is not an object, or is malformed or has escaped keys.
+         */
+        template <typename Struct>
+        bool DecodeShadowFields(const JsonPayloadValue &object, Struct *value, ShadowFieldChanges<Struct> &changes)
+        {
+            JsonPayloadReader reader(object);
+            Aws::Crt::ByteCursor key;
+            JsonPayloadValue member;
+            while (reader.Next(key, member))
+            {
+                if (member.IsNull())
+                {
+                    continue;
+                }
+                ShadowSchemaDetail::FieldReader<Struct> fieldReader(key, member, value, changes);
+                ShadowSchema<Struct>::Describe(fieldReader);
+            }
+            return !reader.HasError();
+        }
+
+        /**
+         * An update to a shadow, with its desired and reported state in structs with a ShadowSchema. Only the fields
+         * in DesiredFields and ReportedFields are sent, and a section with no fields is left out.
+         */
+        template <typename Struct> struct TypedShadowUpdate
+        {
+            Struct Desired;
+            ShadowFieldSet<Struct> DesiredFields;
+            Struct Reported;
+            ShadowFieldSet<Struct> ReportedFields;
+            Aws::Crt::Optional<Aws::Crt::String> ClientToken;
+            Aws::Crt::Optional<int32_t> Version;
+        };
+
+        /**
+         * Serialize a typed update into `payload`, in the form EncodePayload gives an UpdateShadowRequest.
+         * @return false if `payload` could not be grown.
+         */
+        template <typename Struct>
+        bool EncodePayload(const TypedShadowUpdate<Struct> &update, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            JsonPayloadWriter writer(payload);
+            if (update.ClientToken)
+            {
+                writer.WithString("clientToken", *update.ClientToken);
+            }
+            if (!update.DesiredFields.IsEmpty() || !update.ReportedFields.IsEmpty())
+            {
+                writer.BeginObject("state");
+                if (!update.DesiredFields.IsEmpty())
+                {
+                    writer.BeginObject("desired");
+                    EncodeShadowFields(writer, update.Desired, update.DesiredFields);
+                    writer.EndObject();
+                }
+                if (!update.ReportedFields.IsEmpty())
+                {
+                    writer.BeginObject("reported");
+                    EncodeShadowFields(writer, update.Reported, update.ReportedFields);
+                    writer.EndObject();
+                }
+                writer.EndObject();
+            }
+            if (update.Version)
+            {
+                writer.WithInt64("version", *update.Version);
+            }
+            return writer.Finish();
+        }
+
+        /**
+         * A delta event decoded against a ShadowSchema.
+         */
+        template <typename Struct> struct TypedShadowDelta
+        {
+            Aws::Crt::Optional<int32_t> Version;
+
+            /**
+             * The fields in the delta, whose values are decoded into the struct given to DecodeShadowDelta.
+             */
+            ShadowFieldChanges<Struct> State;
+        };
+
+        /**
+         * Decode the payload of a delta event. The fields of the delta are merged into `desired`, which should hold
+         * the desired state known so far, so that the change set says which of them actually changed.
+         * @return false if the payload is malformed.
+         */
+        template <typename Struct>
+        bool DecodeShadowDelta(const Aws::Crt::ByteCursor &payload, Struct &desired, TypedShadowDelta<Struct> &delta)
+        {
+            JsonPayloadValue object(payload);
+            JsonPayloadReader reader(object);
+            Aws::Crt::ByteCursor key;
+            JsonPayloadValue value;
+            while (reader.Next(key, value))
+            {
+                if (aws_byte_cursor_eq_c_str(&key, "version"))
+                {
+                    ShadowSchemaDetail::ReadInt32(value, delta.Version);
+                }
+                else if (aws_byte_cursor_eq_c_str(&key, "state") && !DecodeShadowFields(value, &desired, delta.State))
+                {
+                    return false;
+                }
+            }
+            return !reader.HasError();
+        }
+
+        /**
+         * A shadow document, as a get or an update is answered with, decoded against a ShadowSchema.
+         */
+        template <typename Struct> struct TypedShadowDocument
+        {
+            Aws::Crt::Optional<int32_t> Version;
+            Aws::Crt::Optional<Aws::Crt::String> ClientToken;
+            ShadowFieldChanges<Struct> Desired;
+            ShadowFieldChanges<Struct> Reported;
+
+            /**
+             * The fields whose desired value differs from their reported one. Only Delta.Present is set, since the
+             * values are the desired ones.
+             */
+            ShadowFieldChanges<Struct> Delta;
+        };
+
+        /**
+         * Decode the payload of a get/accepted or update/accepted message, merging its desired and reported states
+         * into `desired` and `reported`.
+         * @return false if the payload is malformed.
+         */
+        template <typename Struct>
+        bool DecodeShadowDocument(
+            const Aws::Crt::ByteCursor &payload,
+            Struct &desired,
+            Struct &reported,
+            TypedShadowDocument<Struct> &document)
+        {
+            JsonPayloadValue object(payload);
+            JsonPayloadReader reader(object);
+            Aws::Crt::ByteCursor key;
+            JsonPayloadValue value;
+            while (reader.Next(key, value))
+            {
+                if (aws_byte_cursor_eq_c_str(&key, "version"))
+                {
+                    ShadowSchemaDetail::ReadInt32(value, document.Version);
+                }
+                else if (aws_byte_cursor_eq_c_str(&key, "clientToken"))
+                {
+                    Aws::Crt::String clientToken;
+                    if (value.GetString(clientToken))
+                    {
+                        document.ClientToken = std::move(clientToken);
+                    }
+                }
+                else if (aws_byte_cursor_eq_c_str(&key, "state"))
+                {
+                    JsonPayloadReader stateReader(value);
+                    Aws::Crt::ByteCursor section;
+                    JsonPayloadValue state;
+                    while (stateReader.Next(section, state))
+                    {
+                        bool decoded = true;
+                        if (state.IsNull())
+                        {
+                            continue;
+                        }
+                        if (aws_byte_cursor_eq_c_str(&section, "desired"))
+                        {
+                            decoded = DecodeShadowFields(state, &desired, document.Desired);
+                        }
+                        else if (aws_byte_cursor_eq_c_str(&section, "reported"))
+                        {
+                            decoded = DecodeShadowFields(state, &reported, document.Reported);
+                        }
+                        else if (aws_byte_cursor_eq_c_str(&section, "delta"))
+                        {
+                            decoded = DecodeShadowFields<Struct>(state, nullptr, document.Delta);
+                        }
+                        if (!decoded)
+                        {
+                            return false;
+                        }
+                    }
+                    if (stateReader.HasError())
+                    {
+                        return false;
+                    }
+                }
+            }
+            return !reader.HasError();
+        }
+    } // namespace Iotshadow
+} // namespace Aws
@@ -0,0 +1,342 @@
+#pragma once
+
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/iotshadow/Exports.h>
+#include <aws/iotshadow/IotShadowClient.h>
+#include <aws/iotshadow/SubscriptionHandle.h>
+
+#include <aws/crt/JsonObject.h>
+#include <aws/crt/Optional.h>
+#include <aws/crt/Types.h>
+#include <aws/crt/io/EventLoopGroup.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <chrono>
+#include <mutex>
+#include <type_traits>
+
+struct aws_event_loop;
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        class ErrorResponse;
+        class GetShadowResponse;
+        class ShadowDeltaUpdatedEvent;
+        class UpdateShadowResponse;
+
+        /**
+         * Invoked when a ShadowSync request fails. `rejection` is set if the service rejected the request, and
+         * `ioErr` says why it failed otherwise.
+         */
+        using OnShadowSyncError = std::function<void(int ioErr, const ErrorResponse *rejection)>;
+
+        /**
+         * Invoked once ShadowSync has subscribed and read the shadow, or failed to. It failed if `ioErr` is not
+         * AWS_ERROR_SUCCESS or `rejection` is set.
+         */
+        using OnShadowSyncStarted = std::function<void(int ioErr, const ErrorResponse *rejection)>;
+
+        /**
+         * Converts the property types that ShadowSync binds between their C++ and JSON representations.
+         */
+        template <typename T> struct ShadowPropertyTraits;
+
+        template <> struct ShadowPropertyTraits<bool>
+        {
+            static bool FromJson(const Aws::Crt::JsonView &json, bool &value)
+            {
+                if (!json.IsBool())
+                {
+                    return false;
+                }
+                value = json.AsBool();
+                return true;
+            }
+            static Aws::Crt::JsonObject ToJson(bool value) { return Aws::Crt::JsonObject().AsBool(value); }
+        };
+
+        template <> struct ShadowPropertyTraits<int32_t>
+        {
+            static bool FromJson(const Aws::Crt::JsonView &json, int32_t &value)
+            {
+                if (!json.IsIntegerType())
+                {
+                    return false;
+                }
+                value = json.AsInteger();
+                return true;
+            }
+            static Aws::Crt::JsonObject ToJson(int32_t value) { return Aws::Crt::JsonObject().AsInteger(value); }
+        };
+
+        template <> struct ShadowPropertyTraits<int64_t>
+        {
+            static bool FromJson(const Aws::Crt::JsonView &json, int64_t &value)
+            {
+                if (!json.IsIntegerType())
+                {
+                    return false;
+                }
+                value = json.AsInt64();
+                return true;
+            }
+            static Aws::Crt::JsonObject ToJson(int64_t value) { return Aws::Crt::JsonObject().AsInt64(value); }
+        };
+
+        template <> struct ShadowPropertyTraits<double>
+        {
+            static bool FromJson(const Aws::Crt::JsonView &json, double &value)
+            {
+                if (!json.IsIntegerType() && !json.IsFloatingPointType())
+                {
+                    return false;
+                }
+                value = json.AsDouble();
+                return true;
+            }
+            static Aws::Crt::JsonObject ToJson(double value) { return Aws::Crt::JsonObject().AsDouble(value); }
+        };
+
+        template <> struct ShadowPropertyTraits<Aws::Crt::String>
+        {
+            static bool FromJson(const Aws::Crt::JsonView &json, Aws::Crt::String &value)
+            {
+                if (!json.IsString())
+                {
+                    return false;
+                }
+                value = json.AsString();
+                return true;
+            }
+            static Aws::Crt::JsonObject ToJson(const Aws::Crt::String &value)
+            {
+                return Aws::Crt::JsonObject().AsString(value);
+            }
+        };
+
+        template <> struct ShadowPropertyTraits<Aws::Crt::JsonObject>
+        {
+            static bool FromJson(const Aws::Crt::JsonView &json, Aws::Crt::JsonObject &value)
+            {
+                value = json.Materialize();
+                return true;
+            }
+            static Aws::Crt::JsonObject ToJson(const Aws::Crt::JsonObject &value) { return value; }
+        };
+
+        struct AWS_IOTSHADOW_API ShadowSyncOptions
+        {
+            Aws::Crt::String ThingName;
+
+            /**
+             * The shadow to synchronize with. The classic shadow is used if this is not set.
+             */
+            Aws::Crt::Optional<Aws::Crt::String> ShadowName;
+
+            Aws::Crt::Mqtt::QOS Qos = AWS_MQTT_QOS_AT_LEAST_ONCE;
+
+            /**
+             * How long to wait after a change for further changes, before they are all applied and reported in one
+             * update. Each change restarts the wait.
+             */
+            std::chrono::milliseconds DebounceInterval = std::chrono::milliseconds(100);
+
+            /**
+             * The longest a change waits to be applied and reported while further changes keep arriving, counted
+             * from the first of them.
+             */
+            std::chrono::milliseconds MaxDebounceDelay = std::chrono::milliseconds(1000);
+
+            /**
+             * How long to wait for the response to a get or update before the shadow is read again.
+             */
+            std::chrono::milliseconds ResponseTimeout = std::chrono::milliseconds(10000);
+
+            /**
+             * How many version conflicts in a row are resolved by reading the shadow and updating again, before an
+             * update is given up on.
+             */
+            uint32_t MaxConflictRetries = 5;
+
+            /**
+             * Runs the debounce and response timers. The default event loop group is used if this is null.
+             */
+            Aws::Crt::Io::EventLoopGroup *EventLoopGroup = nullptr;
+
+            OnShadowSyncError OnError;
+        };
+
+        /**
+         * Keeps a set of local properties and a device shadow in step.
+         *
+         * Each property is bound to a dot-separated path in the shadow document, such as `config.led.color`, and is
+         * treated as a leaf. When the desired value of a property changes, its handler decides whether to take it;
+         * a taken value becomes the local value. Whenever local values differ from the last reported ones, only the
+         * properties that differ are reported, in a single update.
+         *
+         * Updates carry the shadow version they were based on, so an update that races with another writer is
+         * rejected rather than applied; the shadow is then read again and the update retried against it. Changes
+         * that arrive within the debounce interval of each other are applied and reported together, up to the maximum
+         * debounce delay, and only one request is in flight at a time.
+         *
+         * Handlers are invoked on event loop threads, without any lock held. A ShadowSync must be owned by a
+         * std::shared_ptr.
+         */
+        class AWS_IOTSHADOW_API ShadowSync final : public std::enable_shared_from_this<ShadowSync>
+        {
+          public:
+            /**
+             * Invoked with the desired value of a property. Returns whether the value was taken.
+             */
+            using OnDesiredValue = std::function<bool(const Aws::Crt::JsonView &desired)>;
+
+            ShadowSync(
+                std::shared_ptr<IotShadowClient> client,
+                const ShadowSyncOptions &options,
+                Aws::Crt::Allocator *allocator = Aws::Crt::ApiAllocator()) noexcept;
+            ~ShadowSync();
+            ShadowSync(const ShadowSync &) = delete;
+            ShadowSync &operator=(const ShadowSync &) = delete;
+
+            /**
+             * Bind a property to `path`. Properties should be bound before Start, so that their desired values are
+             * read with the shadow.
+             *
+             * @param onDesired Decides whether to take a desired value. If it is empty, every desired value of the
+             * right type is taken.
+             * @return false if a property is already bound to `path`.
+             */
+            template <typename T>
+            bool BindProperty(
+                const Aws::Crt::String &path,
+                const T &initialValue,
+                std::function<bool(const typename std::decay<T>::type &desired)> onDesired = nullptr) noexcept
+            {
+                using Traits = ShadowPropertyTraits<typename std::decay<T>::type>;
+                OnDesiredValue onDesiredValue = [onDesired](const Aws::Crt::JsonView &desired) {
+                    typename std::decay<T>::type value;
+                    return Traits::FromJson(desired, value) && (!onDesired || onDesired(value));
+                };
+                return BindValue(path, Traits::ToJson(initialValue), std::move(onDesiredValue));
+            }
+
+            /**
+             * Change the local value of a property. It is reported after the debounce interval, together with any
+             * other changes made by then.
+             * @return false if no property is bound to `path`.
+             */
+            template <typename T> bool SetProperty(const Aws::Crt::String &path, const T &value) noexcept
+            {
+                return SetValue(path, ShadowPropertyTraits<T>::ToJson(value));
+            }
+
+            /**
+             * @return false if no property is bound to `path`, or its local value is not a `T`.
+             */
+            template <typename T> bool GetProperty(const Aws::Crt::String &path, T &value) const noexcept
+            {
+                Aws::Crt::JsonObject json;
+                return GetValue(path, json) && ShadowPropertyTraits<T>::FromJson(json.View(), value);
+            }
+
+            bool BindValue(
+                const Aws::Crt::String &path,
+                const Aws::Crt::JsonObject &initialValue,
+                OnDesiredValue onDesired) noexcept;
+            bool SetValue(const Aws::Crt::String &path, const Aws::Crt::JsonObject &value) noexcept;
+            bool GetValue(const Aws::Crt::String &path, Aws::Crt::JsonObject &value) const noexcept;
+
+            /**
+             * Subscribe to the shadow's topics and read it. Desired values that differ from the reported ones are
+             * offered to their properties, and local values that differ from the reported ones are reported.
+             * @return false if already started, or a subscribe could not be queued.
+             */
+            bool Start(const OnShadowSyncStarted &onStarted) noexcept;
+
+            /**
+             * Unsubscribe from the shadow's topics. Local values are kept, and Start may be called again.
+             */
+            void Stop() noexcept;
+
+            /**
+             * @return The version of the shadow that the last known reported values belong to, if it has been read.
+             */
+            Aws::Crt::Optional<int32_t> GetVersion() const noexcept;
+
+          private:
+            struct Property
+            {
+                Aws::Crt::Vector<Aws::Crt::String> segments;
+                Aws::Crt::JsonObject local;
+                Aws::Crt::Optional<Aws::Crt::JsonObject> reported;
+                Aws::Crt::Optional<Aws::Crt::JsonObject> pendingDesired;
+                OnDesiredValue onDesired;
+            };
+
+            enum class PendingRequest
+            {
+                None,
+                Get,
+                Update,
+            };
+
+            struct ScheduledTask;
+
+            static void s_onScheduledTask(struct aws_task *task, void *arg, enum aws_task_status status);
+
+            void SubscribeToShadow(const std::shared_ptr<std::function<void(int)>> &onSubAck) noexcept;
+            void RequestShadow() noexcept;
+            void Reconcile(uint64_t generation) noexcept;
+            void OnGetAccepted(const GetShadowResponse &response) noexcept;
+            void OnUpdateAccepted(const UpdateShadowResponse &response) noexcept;
+            void OnRejected(const ErrorResponse &rejection, PendingRequest request) noexcept;
+            void OnDelta(const ShadowDeltaUpdatedEvent &event) noexcept;
+            void OnPublishFailed(uint64_t requestId, int ioErr) noexcept;
+            void OnRequestTimedOut(uint64_t requestId) noexcept;
+            void OnStartFailed(int ioErr, const ErrorResponse *rejection) noexcept;
+            void ReportError(int ioErr, const ErrorResponse *rejection) const noexcept;
+
+            bool HasWorkLocked() const noexcept;
+            Aws::Crt::String BeginRequestLocked(PendingRequest request) noexcept;
+            void ScheduleReconcileLocked(std::chrono::milliseconds delay) noexcept;
+            void ScheduleReconcileTaskLocked(uint64_t runAt) noexcept;
+            void ScheduleTaskLocked(bool reconcile, uint64_t id, uint64_t runAt) noexcept;
+            uint64_t GetClockTimeLocked() const noexcept;
+
+            std::shared_ptr<IotShadowClient> m_client;
+            ShadowSyncOptions m_options;
+            Aws::Crt::Allocator *m_allocator;
+            struct aws_event_loop *m_eventLoop;
+            Aws::Crt::String m_tokenPrefix;
+
+            /* This mutex protects everything below it. */
+            mutable std::mutex m_mutex;
+            Aws::Crt::Map<Aws::Crt::String, Property> m_properties;
+            Aws::Crt::Vector<ScopedSubscription> m_subscriptions;
+            OnShadowSyncStarted m_onStarted;
+            bool m_started;
+            bool m_synchronized;
+            bool m_reconcileScheduled;
+            /* Only the most recently scheduled reconcile task runs; the earlier ones find a newer generation. */
+            uint64_t m_reconcileGeneration;
+            /* Event loop clock times: when the reconcile task runs, when the reconcile is due, and the latest it may
+             * be put off to. */
+            uint64_t m_reconcileTaskAt;
+            uint64_t m_reconcileDueAt;
+            uint64_t m_reconcileDeadline;
+            Aws::Crt::Optional<int32_t> m_version;
+            PendingRequest m_pendingRequest;
+            uint64_t m_lastRequestId;
+            Aws::Crt::String m_pendingToken;
+            /* The values sent by the update in flight, which become the reported values once it is accepted. */
+            Aws::Crt::Vector<std::pair<Aws::Crt::String, Aws::Crt::JsonObject>> m_sentValues;
+            uint32_t m_conflictCount;
+        };
+    } // namespace Iotshadow
+} // namespace Aws
@@ -5,6 +5,9 @@
  */
 #include <aws/iotshadow/IotShadowClient.h>
 
+#include <aws/iotdevicecommon/Tracing.h>
+#include <aws/iotservicecommon/CountingAllocator.h>
+
 #include <aws/iotshadow/DeleteNamedShadowRequest.h>
 #include <aws/iotshadow/DeleteNamedShadowSubscriptionRequest.h>
 #include <aws/iotshadow/DeleteShadowRequest.h>
@@ -18,6 +21,8 @@
 #include <aws/iotshadow/GetShadowSubscriptionRequest.h>
 #include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
 #include <aws/iotshadow/NamedShadowUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/PayloadDecoder.h>
+#include <aws/iotshadow/PayloadEncoder.h>
 #include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
 #include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
 #include <aws/iotshadow/ShadowUpdatedEvent.h>
@@ -33,34 +38,77 @@ namespace Aws
     namespace Iotshadow
     {
 
-        IotShadowClient::IotShadowClient(const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection)
-            : m_connection(connection)
+#ifdef AWS_IOT_SDK_TRACING
+        static uint64_t s_startDispatchTrace()
+        {
+            return Aws::Iotdevicecommon::Tracing::IsEnabled() ? Aws::Iotdevicecommon::Tracing::NowNanoseconds() : 0;
+        }
+
+        static void s_markDispatchTrace(Aws::Iotservicecommon::DispatchPhase phase, uint64_t startNs)
+        {
+            Aws::Iotdevicecommon::Tracing::Record(
+                Aws::Iotdevicecommon::TraceSubsystem::Shadow,
+                phase == Aws::Iotservicecommon::DispatchPhase::HandlersFound
+                    ? Aws::Iotdevicecommon::TracePhase::ResponseReceived
+                    : Aws::Iotdevicecommon::TracePhase::HandlerDone,
+                Aws::Iotdevicecommon::Tracing::NowNanoseconds() - startNs);
+        }
+#endif
+
+        /* The registry is shared with the other service clients, which trace into their own subsystems. */
+        static Aws::Iotservicecommon::DispatchTraceHooks s_dispatchTraceHooks() noexcept
+        {
+            Aws::Iotservicecommon::DispatchTraceHooks traceHooks;
+#ifdef AWS_IOT_SDK_TRACING
+            traceHooks.Start = s_startDispatchTrace;
+            traceHooks.Mark = s_markDispatchTrace;
+#endif
+            return traceHooks;
+        }
+
+        IotShadowClient::IotShadowClient(
+            const std::shared_ptr<Aws::Crt::Mqtt::MqttConnection> &connection,
+            Aws::Crt::Allocator *allocator)
+            : m_allocator(Aws::Iotservicecommon::CountingAllocator::Create(allocator)), m_connection(connection),
+              m_subscriptions(std::make_shared<SubscriptionRegistry>(connection, m_allocator, s_dispatchTraceHooks())),
+              m_publishBuffers(std::make_shared<PublishBufferPool>(m_allocator))
         {
         }
 
-        IotShadowClient::IotShadowClient(const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client)
+        IotShadowClient::IotShadowClient(
+            const std::shared_ptr<Aws::Crt::Mqtt5::Mqtt5Client> &mqtt5Client,
+            Aws::Crt::Allocator *allocator)
+            : m_allocator(Aws::Iotservicecommon::CountingAllocator::Create(allocator))
         {
             m_connection = Aws::Crt::Mqtt::MqttConnection::NewConnectionFromMqtt5Client(mqtt5Client);
+            m_subscriptions = std::make_shared<SubscriptionRegistry>(m_connection, m_allocator, s_dispatchTraceHooks());
+            m_publishBuffers = std::make_shared<PublishBufferPool>(m_allocator);
         }
 
         IotShadowClient::operator bool() const noexcept { return m_connection && *m_connection; }
 
         int IotShadowClient::GetLastError() const noexcept { return aws_last_error(); }
 
-        bool IotShadowClient::SubscribeToDeleteNamedShadowAccepted(
+        Aws::Crt::Allocator *IotShadowClient::GetAllocator() const noexcept { return m_allocator.get(); }
+
+        size_t IotShadowClient::GetAllocatedBytes() const noexcept
+        {
+            return Aws::Iotservicecommon::CountingAllocator::GetAllocatedBytes(m_allocator.get());
+        }
+
+        size_t IotShadowClient::GetAllocationCount() const noexcept
+        {
+            return Aws::Iotservicecommon::CountingAllocator::GetAllocationCount(m_allocator.get());
+        }
+
+        SubscriptionHandle IotShadowClient::SubscribeToDeleteNamedShadowAccepted(
             const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToDeleteNamedShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -72,14 +120,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::DeleteShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::DeleteShadowResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -94,27 +139,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToDeleteNamedShadowRejected(
+        SubscriptionHandle IotShadowClient::SubscribeToDeleteNamedShadowRejected(
             const Aws::Iotshadow::DeleteNamedShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToDeleteNamedShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -126,14 +162,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ErrorResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -148,27 +181,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToDeleteShadowAccepted(
+        SubscriptionHandle IotShadowClient::SubscribeToDeleteShadowAccepted(
             const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToDeleteShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -180,14 +204,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::DeleteShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::DeleteShadowResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -200,27 +221,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToDeleteShadowRejected(
+        SubscriptionHandle IotShadowClient::SubscribeToDeleteShadowRejected(
             const Aws::Iotshadow::DeleteShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToDeleteShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -232,14 +244,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ErrorResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -252,27 +261,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToGetNamedShadowAccepted(
+        SubscriptionHandle IotShadowClient::SubscribeToGetNamedShadowAccepted(
             const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToGetNamedShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -284,14 +284,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::GetShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::GetShadowResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -306,27 +303,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToGetNamedShadowRejected(
+        SubscriptionHandle IotShadowClient::SubscribeToGetNamedShadowRejected(
             const Aws::Iotshadow::GetNamedShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToGetNamedShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -338,14 +326,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ErrorResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -360,27 +345,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToGetShadowAccepted(
+        SubscriptionHandle IotShadowClient::SubscribeToGetShadowAccepted(
             const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToGetShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -392,14 +368,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::GetShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::GetShadowResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -412,27 +385,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToGetShadowRejected(
+        SubscriptionHandle IotShadowClient::SubscribeToGetShadowRejected(
             const Aws::Iotshadow::GetShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToGetShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -444,14 +408,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ErrorResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -464,27 +425,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToNamedShadowDeltaUpdatedEvents(
+        SubscriptionHandle IotShadowClient::SubscribeToNamedShadowDeltaUpdatedEvents(
             const Aws::Iotshadow::NamedShadowDeltaUpdatedSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToNamedShadowDeltaUpdatedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -496,14 +448,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ShadowDeltaUpdatedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ShadowDeltaUpdatedEvent response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -518,27 +467,18 @@ namespace Aws
                                << "/"
                                << "delta";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToNamedShadowUpdatedEvents(
+        SubscriptionHandle IotShadowClient::SubscribeToNamedShadowUpdatedEvents(
             const Aws::Iotshadow::NamedShadowUpdatedSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToNamedShadowUpdatedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -550,14 +490,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ShadowUpdatedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ShadowUpdatedEvent response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -572,27 +509,18 @@ namespace Aws
                                << "/"
                                << "documents";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToShadowDeltaUpdatedEvents(
+        SubscriptionHandle IotShadowClient::SubscribeToShadowDeltaUpdatedEvents(
             const Aws::Iotshadow::ShadowDeltaUpdatedSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToShadowDeltaUpdatedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -604,14 +532,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ShadowDeltaUpdatedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ShadowDeltaUpdatedEvent response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -624,27 +549,18 @@ namespace Aws
                                << "/"
                                << "delta";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToShadowUpdatedEvents(
+        SubscriptionHandle IotShadowClient::SubscribeToShadowUpdatedEvents(
             const Aws::Iotshadow::ShadowUpdatedSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToShadowUpdatedEventsResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -656,14 +572,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ShadowUpdatedEvent response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ShadowUpdatedEvent response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -676,27 +589,18 @@ namespace Aws
                                << "/"
                                << "documents";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToUpdateNamedShadowAccepted(
+        SubscriptionHandle IotShadowClient::SubscribeToUpdateNamedShadowAccepted(
             const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToUpdateNamedShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -708,14 +612,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::UpdateShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::UpdateShadowResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -730,27 +631,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToUpdateNamedShadowRejected(
+        SubscriptionHandle IotShadowClient::SubscribeToUpdateNamedShadowRejected(
             const Aws::Iotshadow::UpdateNamedShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToUpdateNamedShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -762,14 +654,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ErrorResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -784,27 +673,18 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToUpdateShadowAccepted(
+        SubscriptionHandle IotShadowClient::SubscribeToUpdateShadowAccepted(
             const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToUpdateShadowAcceptedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -816,14 +696,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::UpdateShadowResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::UpdateShadowResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -836,27 +713,18 @@ namespace Aws
                                << "/"
                                << "accepted";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
-        bool IotShadowClient::SubscribeToUpdateShadowRejected(
+        SubscriptionHandle IotShadowClient::SubscribeToUpdateShadowRejected(
             const Aws::Iotshadow::UpdateShadowSubscriptionRequest &request,
             Aws::Crt::Mqtt::QOS qos,
             const OnSubscribeToUpdateShadowRejectedResponse &handler,
             const OnSubscribeComplete &onSubAck)
         {
             (void)request;
-            auto onSubscribeComplete = [handler, onSubAck](
-                                           Aws::Crt::Mqtt::MqttConnection &,
-                                           uint16_t,
-                                           const Aws::Crt::String &topic,
-                                           Aws::Crt::Mqtt::QOS,
-                                           int errorCode) {
-                (void)topic;
+            auto onSubscribeComplete = [handler, onSubAck](int errorCode) {
                 if (errorCode)
                 {
                     handler(nullptr, errorCode);
@@ -868,14 +736,11 @@ namespace Aws
                 }
             };
 
-            auto onSubscribePublish =
-                [handler](
-                    Aws::Crt::Mqtt::MqttConnection &, const Aws::Crt::String &, const Aws::Crt::ByteBuf &payload) {
-                    Aws::Crt::String objectStr(reinterpret_cast<char *>(payload.buffer), payload.len);
-                    Aws::Crt::JsonObject jsonObject(objectStr);
-                    Aws::Iotshadow::ErrorResponse response(jsonObject);
-                    handler(&response, AWS_ERROR_SUCCESS);
-                };
+            auto onSubscribePublish = [handler](const Aws::Crt::ByteBuf &payload) {
+                Aws::Iotshadow::ErrorResponse response;
+                Aws::Iotshadow::DecodePayload(Aws::Crt::ByteCursorFromByteBuf(payload), response);
+                handler(&response, AWS_ERROR_SUCCESS);
+            };
 
             Aws::Crt::StringStream subscribeTopicSStr;
             subscribeTopicSStr << "$aws"
@@ -888,11 +753,8 @@ namespace Aws
                                << "/"
                                << "rejected";
 
-            return m_connection->Subscribe(
-                       subscribeTopicSStr.str().c_str(),
-                       qos,
-                       std::move(onSubscribePublish),
-                       std::move(onSubscribeComplete)) != 0;
+            return m_subscriptions->Subscribe(
+                subscribeTopicSStr.str(), qos, std::move(onSubscribePublish), std::move(onSubscribeComplete));
         }
 
         bool IotShadowClient::PublishDeleteNamedShadow(
@@ -900,6 +762,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Shadow);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -911,19 +774,30 @@ namespace Aws
                              << "/" << *request.ShadowName << "/"
                              << "delete";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotshadow::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotShadowClient::PublishDeleteShadow(
@@ -931,6 +805,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Shadow);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -940,19 +815,30 @@ namespace Aws
                              << "/"
                              << "delete";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotshadow::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotShadowClient::PublishGetNamedShadow(
@@ -960,6 +846,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Shadow);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -971,19 +858,30 @@ namespace Aws
                              << "/" << *request.ShadowName << "/"
                              << "get";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotshadow::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotShadowClient::PublishGetShadow(
@@ -991,6 +889,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Shadow);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -1000,19 +899,30 @@ namespace Aws
                              << "/"
                              << "get";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotshadow::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotShadowClient::PublishUpdateNamedShadow(
@@ -1020,6 +930,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Shadow);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -1031,19 +942,30 @@ namespace Aws
                              << "/" << *request.ShadowName << "/"
                              << "update";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
-
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotshadow::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
         bool IotShadowClient::PublishUpdateShadow(
@@ -1051,6 +973,7 @@ namespace Aws
             Aws::Crt::Mqtt::QOS qos,
             const OnPublishComplete &onPubAck)
         {
+            AWS_IOT_TRACE_START(span, Shadow);
             Aws::Crt::StringStream publishTopicSStr;
             publishTopicSStr << "$aws"
                              << "/"
@@ -1060,19 +983,72 @@ namespace Aws
                              << "/"
                              << "update";
 
-            Aws::Crt::JsonObject jsonObject;
-            request.SerializeToObject(jsonObject);
-            Aws::Crt::String outgoingJson = jsonObject.View().WriteCompact(true);
-            Aws::Crt::ByteBuf buf = Aws::Crt::ByteBufNewCopy(
-                Aws::Crt::g_allocator, reinterpret_cast<const uint8_t *>(outgoingJson.data()), outgoingJson.length());
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!Aws::Iotshadow::EncodePayload(request, buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            auto onPublishComplete = [buf, onPubAck](Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
-                onPubAck(errorCode);
-                Aws::Crt::ByteBufDelete(const_cast<Aws::Crt::ByteBuf &>(buf));
-            };
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
+        }
+
+        bool IotShadowClient::PublishEncodedUpdate(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::String *shadowName,
+            const std::function<bool(Aws::Crt::ByteBuf &payload)> &encodePayload,
+            Aws::Crt::Mqtt::QOS qos,
+            const OnPublishComplete &onPubAck)
+        {
+            AWS_IOT_TRACE_START(span, Shadow);
+            Aws::Crt::StringStream publishTopicSStr;
+            publishTopicSStr << "$aws/things/" << thingName << "/shadow/";
+            if (shadowName != nullptr)
+            {
+                publishTopicSStr << "name/" << *shadowName << "/";
+            }
+            publishTopicSStr << "update";
+
+            std::shared_ptr<PublishBufferPool> publishBuffers = m_publishBuffers;
+            Aws::Crt::ByteBuf buf = publishBuffers->Acquire();
+            if (!encodePayload(buf))
+            {
+                publishBuffers->Release(buf);
+                return false;
+            }
+            AWS_IOT_TRACE_MARK(span, Serialize);
+
+            auto onPublishComplete = [publishBuffers, buf, onPubAck AWS_IOT_TRACE_CAPTURE(span)](
+                                         Aws::Crt::Mqtt::MqttConnection &, uint16_t, int errorCode) {
+                    AWS_IOT_TRACE_MARK(span, PubAck);
+                    onPubAck(errorCode);
+                    publishBuffers->Release(buf);
+                };
 
-            return m_connection->Publish(
-                       publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete)) != 0;
+            uint16_t packetId =
+                m_connection->Publish(publishTopicSStr.str().c_str(), qos, false, buf, std::move(onPublishComplete));
+            AWS_IOT_TRACE_MARK(span, PublishQueued);
+            if (packetId == 0)
+            {
+                publishBuffers->Release(buf);
+            }
+            return packetId != 0;
         }
 
     } // namespace Iotshadow
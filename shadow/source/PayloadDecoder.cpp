@@ -0,0 +1,159 @@
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/PayloadDecoder.h>
+
+namespace Aws
+{
+    namespace Iotservicecommon
+    {
+        /*
+         * Each model names the fields its LoadFromObject reads. A value of the wrong type fails the decode so that
+         * JsonObject decides instead.
+         */
+
+        template <> struct PayloadModel<Iotshadow::ShadowState>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("desired", &Iotshadow::ShadowState::Desired);
+                visitor.Field("reported", &Iotshadow::ShadowState::Reported);
+            }
+        };
+
+        template <> struct PayloadModel<Iotshadow::ShadowStateWithDelta>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("desired", &Iotshadow::ShadowStateWithDelta::Desired);
+                visitor.Field("reported", &Iotshadow::ShadowStateWithDelta::Reported);
+                visitor.Field("delta", &Iotshadow::ShadowStateWithDelta::Delta);
+            }
+        };
+
+        template <> struct PayloadModel<Iotshadow::ShadowMetadata>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("desired", &Iotshadow::ShadowMetadata::Desired);
+                visitor.Field("reported", &Iotshadow::ShadowMetadata::Reported);
+            }
+        };
+
+        template <> struct PayloadModel<Iotshadow::ShadowUpdatedSnapshot>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("state", &Iotshadow::ShadowUpdatedSnapshot::State);
+                visitor.Field("metadata", &Iotshadow::ShadowUpdatedSnapshot::Metadata);
+                visitor.Field("version", &Iotshadow::ShadowUpdatedSnapshot::Version);
+            }
+        };
+
+        template <> struct PayloadModel<Iotshadow::ShadowDeltaUpdatedEvent>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("state", &Iotshadow::ShadowDeltaUpdatedEvent::State);
+                visitor.Field("metadata", &Iotshadow::ShadowDeltaUpdatedEvent::Metadata);
+                visitor.Field("timestamp", &Iotshadow::ShadowDeltaUpdatedEvent::Timestamp);
+                visitor.Field("version", &Iotshadow::ShadowDeltaUpdatedEvent::Version);
+                visitor.Field("clientToken", &Iotshadow::ShadowDeltaUpdatedEvent::ClientToken);
+            }
+        };
+
+        template <> struct PayloadModel<Iotshadow::ShadowUpdatedEvent>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("previous", &Iotshadow::ShadowUpdatedEvent::Previous);
+                visitor.Field("current", &Iotshadow::ShadowUpdatedEvent::Current);
+                visitor.Field("timestamp", &Iotshadow::ShadowUpdatedEvent::Timestamp);
+            }
+        };
+
+        template <> struct PayloadModel<Iotshadow::UpdateShadowResponse>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("clientToken", &Iotshadow::UpdateShadowResponse::ClientToken);
+                visitor.Field("state", &Iotshadow::UpdateShadowResponse::State);
+                visitor.Field("metadata", &Iotshadow::UpdateShadowResponse::Metadata);
+                visitor.Field("timestamp", &Iotshadow::UpdateShadowResponse::Timestamp);
+                visitor.Field("version", &Iotshadow::UpdateShadowResponse::Version);
+            }
+        };
+
+        template <> struct PayloadModel<Iotshadow::GetShadowResponse>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("clientToken", &Iotshadow::GetShadowResponse::ClientToken);
+                visitor.Field("state", &Iotshadow::GetShadowResponse::State);
+                visitor.Field("metadata", &Iotshadow::GetShadowResponse::Metadata);
+                visitor.Field("timestamp", &Iotshadow::GetShadowResponse::Timestamp);
+                visitor.Field("version", &Iotshadow::GetShadowResponse::Version);
+            }
+        };
+
+        template <> struct PayloadModel<Iotshadow::ErrorResponse>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("clientToken", &Iotshadow::ErrorResponse::ClientToken);
+                visitor.Field("code", &Iotshadow::ErrorResponse::Code);
+                visitor.Field("message", &Iotshadow::ErrorResponse::Message);
+                visitor.Field("timestamp", &Iotshadow::ErrorResponse::Timestamp);
+            }
+        };
+    } // namespace Iotservicecommon
+
+    namespace Iotshadow
+    {
+        template <typename Model>
+        static void s_decodePayload(const Aws::Crt::ByteCursor &payload, Model &model, PayloadDecoding decoding)
+        {
+            if (decoding == PayloadDecoding::OnDemand)
+            {
+                Model decoded;
+                if (Aws::Iotservicecommon::DecodePayloadModel(JsonPayloadValue(payload), decoded))
+                {
+                    model = std::move(decoded);
+                    return;
+                }
+            }
+
+            Aws::Crt::String objectStr(reinterpret_cast<const char *>(payload.ptr), payload.len);
+            Aws::Crt::JsonObject jsonObject(objectStr);
+            model = jsonObject.View();
+        }
+
+        void DecodePayload(
+            const Aws::Crt::ByteCursor &payload,
+            ShadowDeltaUpdatedEvent &model,
+            PayloadDecoding decoding)
+        {
+            s_decodePayload(payload, model, decoding);
+        }
+
+        void DecodePayload(const Aws::Crt::ByteCursor &payload, ShadowUpdatedEvent &model, PayloadDecoding decoding)
+        {
+            s_decodePayload(payload, model, decoding);
+        }
+
+        void DecodePayload(const Aws::Crt::ByteCursor &payload, UpdateShadowResponse &model, PayloadDecoding decoding)
+        {
+            s_decodePayload(payload, model, decoding);
+        }
+
+        void DecodePayload(const Aws::Crt::ByteCursor &payload, GetShadowResponse &model, PayloadDecoding decoding)
+        {
+            s_decodePayload(payload, model, decoding);
+        }
+
+        void DecodePayload(const Aws::Crt::ByteCursor &payload, ErrorResponse &model, PayloadDecoding decoding)
+        {
+            s_decodePayload(payload, model, decoding);
+        }
+    } // namespace Iotshadow
+} // namespace Aws
@@ -0,0 +1,77 @@
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/PayloadEncoder.h>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        template <typename Request> static bool s_encodeClientToken(const Request &request, Aws::Crt::ByteBuf &payload)
+        {
+            JsonPayloadWriter writer(payload);
+            if (request.ClientToken)
+            {
+                writer.WithString("clientToken", *request.ClientToken);
+            }
+            return writer.Finish();
+        }
+
+        template <typename Request> static bool s_encodeUpdate(const Request &request, Aws::Crt::ByteBuf &payload)
+        {
+            JsonPayloadWriter writer(payload);
+            if (request.ClientToken)
+            {
+                writer.WithString("clientToken", *request.ClientToken);
+            }
+            if (request.State)
+            {
+                writer.BeginObject("state");
+                if (request.State->Desired)
+                {
+                    writer.WithObject("desired", *request.State->Desired);
+                }
+                if (request.State->Reported)
+                {
+                    writer.WithObject("reported", *request.State->Reported);
+                }
+                writer.EndObject();
+            }
+            if (request.Version)
+            {
+                writer.WithInt64("version", *request.Version);
+            }
+            return writer.Finish();
+        }
+
+        bool EncodePayload(const DeleteNamedShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            return s_encodeClientToken(request, payload);
+        }
+
+        bool EncodePayload(const DeleteShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            return s_encodeClientToken(request, payload);
+        }
+
+        bool EncodePayload(const GetNamedShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            return s_encodeClientToken(request, payload);
+        }
+
+        bool EncodePayload(const GetShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            return s_encodeClientToken(request, payload);
+        }
+
+        bool EncodePayload(const UpdateNamedShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            return s_encodeUpdate(request, payload);
+        }
+
+        bool EncodePayload(const UpdateShadowRequest &request, Aws::Crt::ByteBuf &payload) noexcept
+        {
+            return s_encodeUpdate(request, payload);
+        }
+    } // namespace Iotshadow
+} // namespace Aws
@@ -0,0 +1,872 @@
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowSync.h>
+
+#include <aws/iotshadow/ErrorResponse.h>
+#include <aws/iotshadow/GetNamedShadowRequest.h>
+#include <aws/iotshadow/GetNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/GetShadowRequest.h>
+#include <aws/iotshadow/GetShadowResponse.h>
+#include <aws/iotshadow/GetShadowSubscriptionRequest.h>
+#include <aws/iotshadow/NamedShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedEvent.h>
+#include <aws/iotshadow/ShadowDeltaUpdatedSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowRequest.h>
+#include <aws/iotshadow/UpdateNamedShadowSubscriptionRequest.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowResponse.h>
+#include <aws/iotshadow/UpdateShadowSubscriptionRequest.h>
+
+#include <aws/crt/Api.h>
+#include <aws/crt/UUID.h>
+
+#include <aws/io/event_loop.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        /* Delta, get accepted and rejected, update accepted and rejected. */
+        static const int s_subscriptionCount = 5;
+
+        struct ShadowSync::ScheduledTask
+        {
+            struct aws_task task;
+            std::weak_ptr<ShadowSync> sync;
+            Aws::Crt::Allocator *allocator;
+            bool reconcile;
+            /* The reconcile generation, or the request whose response timer this is. */
+            uint64_t id;
+        };
+
+        static uint64_t s_toNanos(std::chrono::milliseconds duration)
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        }
+
+        static Aws::Crt::Vector<Aws::Crt::String> s_splitPath(const Aws::Crt::String &path)
+        {
+            Aws::Crt::Vector<Aws::Crt::String> segments;
+            size_t start = 0;
+            while (start <= path.size())
+            {
+                size_t end = path.find('.', start);
+                if (end == Aws::Crt::String::npos)
+                {
+                    end = path.size();
+                }
+                segments.push_back(path.substr(start, end - start));
+                start = end + 1;
+            }
+            return segments;
+        }
+
+        static bool s_findAtPath(
+            Aws::Crt::JsonView document,
+            const Aws::Crt::Vector<Aws::Crt::String> &segments,
+            Aws::Crt::JsonView &value)
+        {
+            for (const auto &segment : segments)
+            {
+                if (!document.IsObject() || !document.ValueExists(segment))
+                {
+                    return false;
+                }
+                document = document.GetJsonObject(segment);
+            }
+            value = document;
+            return true;
+        }
+
+        /* Objects along the path are copied and written back, since JsonObject cannot be modified in place. */
+        static void s_setAtPath(
+            Aws::Crt::JsonObject &document,
+            const Aws::Crt::Vector<Aws::Crt::String> &segments,
+            size_t index,
+            const Aws::Crt::JsonObject &value)
+        {
+            const Aws::Crt::String &segment = segments[index];
+            if (index + 1 == segments.size())
+            {
+                document.WithObject(segment, value);
+                return;
+            }
+
+            Aws::Crt::JsonView view = document.View();
+            Aws::Crt::JsonObject child;
+            if (view.ValueExists(segment) && view.GetJsonObject(segment).IsObject())
+            {
+                child = view.GetJsonObjectCopy(segment);
+            }
+            s_setAtPath(child, segments, index + 1, value);
+            document.WithObject(segment, std::move(child));
+        }
+
+        static bool s_sameValue(const Aws::Crt::JsonObject &left, const Aws::Crt::JsonObject &right)
+        {
+            return left.View().WriteCompact(true) == right.View().WriteCompact(true);
+        }
+
+        ShadowSync::ShadowSync(
+            std::shared_ptr<IotShadowClient> client,
+            const ShadowSyncOptions &options,
+            Aws::Crt::Allocator *allocator) noexcept
+            : m_client(std::move(client)), m_options(options), m_allocator(allocator), m_eventLoop(nullptr),
+              m_tokenPrefix(Aws::Crt::UUID().ToString()), m_started(false), m_synchronized(false),
+              m_reconcileScheduled(false), m_reconcileGeneration(0), m_reconcileTaskAt(0), m_reconcileDueAt(0),
+              m_reconcileDeadline(0), m_pendingRequest(PendingRequest::None), m_lastRequestId(0), m_conflictCount(0)
+        {
+            Aws::Crt::Io::EventLoopGroup *eventLoopGroup = m_options.EventLoopGroup;
+            if (eventLoopGroup == nullptr)
+            {
+                eventLoopGroup = Aws::Crt::ApiHandle::GetOrCreateStaticDefaultEventLoopGroup();
+            }
+            m_eventLoop = aws_event_loop_group_get_next_loop(eventLoopGroup->GetUnderlyingHandle());
+        }
+
+        ShadowSync::~ShadowSync() = default;
+
+        bool ShadowSync::BindValue(
+            const Aws::Crt::String &path,
+            const Aws::Crt::JsonObject &initialValue,
+            OnDesiredValue onDesired) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_properties.find(path) != m_properties.end())
+            {
+                return false;
+            }
+            Property &property = m_properties[path];
+            property.segments = s_splitPath(path);
+            property.local = initialValue;
+            property.onDesired = std::move(onDesired);
+            if (m_synchronized)
+            {
+                ScheduleReconcileLocked(m_options.DebounceInterval);
+            }
+            return true;
+        }
+
+        bool ShadowSync::SetValue(const Aws::Crt::String &path, const Aws::Crt::JsonObject &value) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto propertyIter = m_properties.find(path);
+            if (propertyIter == m_properties.end())
+            {
+                return false;
+            }
+            propertyIter->second.local = value;
+            if (m_synchronized)
+            {
+                ScheduleReconcileLocked(m_options.DebounceInterval);
+            }
+            return true;
+        }
+
+        bool ShadowSync::GetValue(const Aws::Crt::String &path, Aws::Crt::JsonObject &value) const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto propertyIter = m_properties.find(path);
+            if (propertyIter == m_properties.end())
+            {
+                return false;
+            }
+            value = propertyIter->second.local;
+            return true;
+        }
+
+        bool ShadowSync::Start(const OnShadowSyncStarted &onStarted) noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_started)
+                {
+                    return false;
+                }
+                m_started = true;
+                m_onStarted = onStarted;
+            }
+
+            /* The shadow is read once every subscription is acknowledged, so that no change after the read is
+             * missed. */
+            std::weak_ptr<ShadowSync> weakSelf = shared_from_this();
+            auto remaining = std::make_shared<std::atomic<int>>(s_subscriptionCount);
+            auto failed = std::make_shared<std::atomic<bool>>(false);
+            auto onSubAck = std::make_shared<std::function<void(int)>>([weakSelf, remaining, failed](int ioErr) {
+                std::shared_ptr<ShadowSync> self = weakSelf.lock();
+                if (!self)
+                {
+                    return;
+                }
+                if (ioErr != AWS_ERROR_SUCCESS)
+                {
+                    if (!failed->exchange(true))
+                    {
+                        self->OnStartFailed(ioErr, nullptr);
+                    }
+                }
+                else if (remaining->fetch_sub(1) == 1 && !failed->load())
+                {
+                    self->RequestShadow();
+                }
+            });
+            SubscribeToShadow(onSubAck);
+
+            Aws::Crt::Vector<ScopedSubscription> subscriptions;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_subscriptions.size() == static_cast<size_t>(s_subscriptionCount))
+                {
+                    return true;
+                }
+
+                /* A subscribe could not be queued. Its handler is never invoked, so the start is undone here. */
+                failed->store(true);
+                subscriptions.swap(m_subscriptions);
+                m_started = false;
+                m_onStarted = nullptr;
+            }
+            return false;
+        }
+
+        void ShadowSync::Stop() noexcept
+        {
+            Aws::Crt::Vector<ScopedSubscription> subscriptions;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                subscriptions.swap(m_subscriptions);
+                m_started = false;
+                m_synchronized = false;
+                m_onStarted = nullptr;
+                m_pendingRequest = PendingRequest::None;
+                m_sentValues.clear();
+            }
+        }
+
+        Aws::Crt::Optional<int32_t> ShadowSync::GetVersion() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_version;
+        }
+
+        void ShadowSync::s_onScheduledTask(struct aws_task *task, void *arg, enum aws_task_status status)
+        {
+            (void)task;
+            auto *scheduled = static_cast<ScheduledTask *>(arg);
+            std::shared_ptr<ShadowSync> sync = scheduled->sync.lock();
+            bool reconcile = scheduled->reconcile;
+            uint64_t id = scheduled->id;
+            Aws::Crt::Delete(scheduled, scheduled->allocator);
+            if (status != AWS_TASK_STATUS_RUN_READY || !sync)
+            {
+                return;
+            }
+
+            if (reconcile)
+            {
+                sync->Reconcile(id);
+            }
+            else
+            {
+                sync->OnRequestTimedOut(id);
+            }
+        }
+
+        void ShadowSync::SubscribeToShadow(const std::shared_ptr<std::function<void(int)>> &onSubAck) noexcept
+        {
+            std::weak_ptr<ShadowSync> weakSelf = shared_from_this();
+            auto subAck = [onSubAck](int ioErr) { (*onSubAck)(ioErr); };
+            auto onDelta = [weakSelf](ShadowDeltaUpdatedEvent *event, int ioErr) {
+                std::shared_ptr<ShadowSync> self = weakSelf.lock();
+                if (self && ioErr == AWS_ERROR_SUCCESS && event != nullptr)
+                {
+                    self->OnDelta(*event);
+                }
+            };
+            auto onGetAccepted = [weakSelf](GetShadowResponse *response, int ioErr) {
+                std::shared_ptr<ShadowSync> self = weakSelf.lock();
+                if (self && ioErr == AWS_ERROR_SUCCESS && response != nullptr)
+                {
+                    self->OnGetAccepted(*response);
+                }
+            };
+            auto onGetRejected = [weakSelf](ErrorResponse *rejection, int ioErr) {
+                std::shared_ptr<ShadowSync> self = weakSelf.lock();
+                if (self && ioErr == AWS_ERROR_SUCCESS && rejection != nullptr)
+                {
+                    self->OnRejected(*rejection, PendingRequest::Get);
+                }
+            };
+            auto onUpdateAccepted = [weakSelf](UpdateShadowResponse *response, int ioErr) {
+                std::shared_ptr<ShadowSync> self = weakSelf.lock();
+                if (self && ioErr == AWS_ERROR_SUCCESS && response != nullptr)
+                {
+                    self->OnUpdateAccepted(*response);
+                }
+            };
+            auto onUpdateRejected = [weakSelf](ErrorResponse *rejection, int ioErr) {
+                std::shared_ptr<ShadowSync> self = weakSelf.lock();
+                if (self && ioErr == AWS_ERROR_SUCCESS && rejection != nullptr)
+                {
+                    self->OnRejected(*rejection, PendingRequest::Update);
+                }
+            };
+
+            Aws::Crt::Vector<SubscriptionHandle> handles;
+            Aws::Crt::Mqtt::QOS qos = m_options.Qos;
+            if (m_options.ShadowName)
+            {
+                NamedShadowDeltaUpdatedSubscriptionRequest deltaRequest;
+                deltaRequest.ThingName = m_options.ThingName;
+                deltaRequest.ShadowName = m_options.ShadowName;
+                handles.push_back(
+                    m_client->SubscribeToNamedShadowDeltaUpdatedEvents(deltaRequest, qos, onDelta, subAck));
+
+                GetNamedShadowSubscriptionRequest getRequest;
+                getRequest.ThingName = m_options.ThingName;
+                getRequest.ShadowName = m_options.ShadowName;
+                handles.push_back(m_client->SubscribeToGetNamedShadowAccepted(getRequest, qos, onGetAccepted, subAck));
+                handles.push_back(m_client->SubscribeToGetNamedShadowRejected(getRequest, qos, onGetRejected, subAck));
+
+                UpdateNamedShadowSubscriptionRequest updateRequest;
+                updateRequest.ThingName = m_options.ThingName;
+                updateRequest.ShadowName = m_options.ShadowName;
+                handles.push_back(
+                    m_client->SubscribeToUpdateNamedShadowAccepted(updateRequest, qos, onUpdateAccepted, subAck));
+                handles.push_back(
+                    m_client->SubscribeToUpdateNamedShadowRejected(updateRequest, qos, onUpdateRejected, subAck));
+            }
+            else
+            {
+                ShadowDeltaUpdatedSubscriptionRequest deltaRequest;
+                deltaRequest.ThingName = m_options.ThingName;
+                handles.push_back(m_client->SubscribeToShadowDeltaUpdatedEvents(deltaRequest, qos, onDelta, subAck));
+
+                GetShadowSubscriptionRequest getRequest;
+                getRequest.ThingName = m_options.ThingName;
+                handles.push_back(m_client->SubscribeToGetShadowAccepted(getRequest, qos, onGetAccepted, subAck));
+                handles.push_back(m_client->SubscribeToGetShadowRejected(getRequest, qos, onGetRejected, subAck));
+
+                UpdateShadowSubscriptionRequest updateRequest;
+                updateRequest.ThingName = m_options.ThingName;
+                handles.push_back(
+                    m_client->SubscribeToUpdateShadowAccepted(updateRequest, qos, onUpdateAccepted, subAck));
+                handles.push_back(
+                    m_client->SubscribeToUpdateShadowRejected(updateRequest, qos, onUpdateRejected, subAck));
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto &handle : handles)
+            {
+                if (handle)
+                {
+                    m_subscriptions.emplace_back(std::move(handle));
+                }
+            }
+        }
+
+        void ShadowSync::RequestShadow() noexcept
+        {
+            Aws::Crt::String token;
+            uint64_t requestId = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_started)
+                {
+                    return;
+                }
+                token = BeginRequestLocked(PendingRequest::Get);
+                requestId = m_lastRequestId;
+            }
+
+            std::weak_ptr<ShadowSync> weakSelf = shared_from_this();
+            auto onPublished = [weakSelf, requestId](int ioErr) {
+                std::shared_ptr<ShadowSync> self = weakSelf.lock();
+                if (self && ioErr != AWS_ERROR_SUCCESS)
+                {
+                    self->OnPublishFailed(requestId, ioErr);
+                }
+            };
+
+            bool published = false;
+            if (m_options.ShadowName)
+            {
+                GetNamedShadowRequest request;
+                request.ThingName = m_options.ThingName;
+                request.ShadowName = m_options.ShadowName;
+                request.ClientToken = token;
+                published = m_client->PublishGetNamedShadow(request, m_options.Qos, onPublished);
+            }
+            else
+            {
+                GetShadowRequest request;
+                request.ThingName = m_options.ThingName;
+                request.ClientToken = token;
+                published = m_client->PublishGetShadow(request, m_options.Qos, onPublished);
+            }
+            if (!published)
+            {
+                OnPublishFailed(requestId, Aws::Crt::LastErrorOrUnknown());
+            }
+        }
+
+        void ShadowSync::Reconcile(uint64_t generation) noexcept
+        {
+            /* Desired values are offered to their handlers unlocked, so that the handlers may use this object. */
+            Aws::Crt::Vector<std::pair<Aws::Crt::String, Aws::Crt::JsonObject>> desiredValues;
+            Aws::Crt::Vector<OnDesiredValue> handlers;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_reconcileScheduled || generation != m_reconcileGeneration)
+                {
+                    return;
+                }
+                /* A change since the task was scheduled put the reconcile off. */
+                if (GetClockTimeLocked() < m_reconcileDueAt)
+                {
+                    ScheduleReconcileTaskLocked(m_reconcileDueAt);
+                    return;
+                }
+                m_reconcileScheduled = false;
+                if (!m_synchronized)
+                {
+                    return;
+                }
+                for (auto &property : m_properties)
+                {
+                    if (property.second.pendingDesired)
+                    {
+                        desiredValues.emplace_back(property.first, *property.second.pendingDesired);
+                        handlers.push_back(property.second.onDesired);
+                        property.second.pendingDesired.reset();
+                    }
+                }
+            }
+
+            Aws::Crt::Vector<bool> taken(desiredValues.size(), false);
+            for (size_t i = 0; i < desiredValues.size(); ++i)
+            {
+                taken[i] = !handlers[i] || handlers[i](desiredValues[i].second.View());
+            }
+
+            Aws::Crt::JsonObject reported;
+            Aws::Crt::String token;
+            uint64_t requestId = 0;
+            Aws::Crt::Optional<int32_t> version;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (size_t i = 0; i < desiredValues.size(); ++i)
+                {
+                    auto propertyIter = m_properties.find(desiredValues[i].first);
+                    if (taken[i] && propertyIter != m_properties.end())
+                    {
+                        propertyIter->second.local = std::move(desiredValues[i].second);
+                    }
+                }
+
+                /* The response to the request in flight schedules another reconcile if there is more to do. */
+                if (!m_synchronized || m_pendingRequest != PendingRequest::None)
+                {
+                    return;
+                }
+
+                Aws::Crt::Vector<std::pair<Aws::Crt::String, Aws::Crt::JsonObject>> sentValues;
+                for (const auto &property : m_properties)
+                {
+                    if (!property.second.reported || !s_sameValue(*property.second.reported, property.second.local))
+                    {
+                        s_setAtPath(reported, property.second.segments, 0, property.second.local);
+                        sentValues.emplace_back(property.first, property.second.local);
+                    }
+                }
+                if (sentValues.empty())
+                {
+                    return;
+                }
+
+                token = BeginRequestLocked(PendingRequest::Update);
+                requestId = m_lastRequestId;
+                version = m_version;
+                m_sentValues = std::move(sentValues);
+            }
+
+            std::weak_ptr<ShadowSync> weakSelf = shared_from_this();
+            auto onPublished = [weakSelf, requestId](int ioErr) {
+                std::shared_ptr<ShadowSync> self = weakSelf.lock();
+                if (self && ioErr != AWS_ERROR_SUCCESS)
+                {
+                    self->OnPublishFailed(requestId, ioErr);
+                }
+            };
+
+            ShadowState state;
+            state.Reported = std::move(reported);
+            bool published = false;
+            if (m_options.ShadowName)
+            {
+                UpdateNamedShadowRequest request;
+                request.ThingName = m_options.ThingName;
+                request.ShadowName = m_options.ShadowName;
+                request.ClientToken = token;
+                request.State = std::move(state);
+                request.Version = version;
+                published = m_client->PublishUpdateNamedShadow(request, m_options.Qos, onPublished);
+            }
+            else
+            {
+                UpdateShadowRequest request;
+                request.ThingName = m_options.ThingName;
+                request.ClientToken = token;
+                request.State = std::move(state);
+                request.Version = version;
+                published = m_client->PublishUpdateShadow(request, m_options.Qos, onPublished);
+            }
+            if (!published)
+            {
+                OnPublishFailed(requestId, Aws::Crt::LastErrorOrUnknown());
+            }
+        }
+
+        void ShadowSync::OnGetAccepted(const GetShadowResponse &response) noexcept
+        {
+            OnShadowSyncStarted onStarted;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_pendingRequest != PendingRequest::Get || !response.ClientToken ||
+                    *response.ClientToken != m_pendingToken)
+                {
+                    return;
+                }
+                m_pendingRequest = PendingRequest::None;
+                m_version = response.Version;
+
+                /* Desired values are taken from the delta, which holds only those that differ from the reported
+                 * ones, as the delta topic does. */
+                Aws::Crt::JsonObject empty;
+                Aws::Crt::JsonView reported = empty.View();
+                Aws::Crt::JsonView delta = empty.View();
+                if (response.State && response.State->Reported)
+                {
+                    reported = response.State->Reported->View();
+                }
+                if (response.State && response.State->Delta)
+                {
+                    delta = response.State->Delta->View();
+                }
+                for (auto &property : m_properties)
+                {
+                    Aws::Crt::JsonView value;
+                    property.second.reported.reset();
+                    if (s_findAtPath(reported, property.second.segments, value))
+                    {
+                        property.second.reported = value.Materialize();
+                    }
+                    property.second.pendingDesired.reset();
+                    if (s_findAtPath(delta, property.second.segments, value) &&
+                        !s_sameValue(value.Materialize(), property.second.local))
+                    {
+                        property.second.pendingDesired = value.Materialize();
+                    }
+                }
+
+                if (!m_synchronized)
+                {
+                    m_synchronized = true;
+                    onStarted = std::move(m_onStarted);
+                    m_onStarted = nullptr;
+                }
+                ScheduleReconcileLocked(std::chrono::milliseconds(0));
+            }
+
+            if (onStarted)
+            {
+                onStarted(AWS_ERROR_SUCCESS, nullptr);
+            }
+        }
+
+        void ShadowSync::OnUpdateAccepted(const UpdateShadowResponse &response) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            /* Updates by other writers are not adopted: the reported values they carry are unknown here, so the
+             * version conflict they cause is what brings the shadow to be read again. */
+            if (m_pendingRequest != PendingRequest::Update || !response.ClientToken ||
+                *response.ClientToken != m_pendingToken)
+            {
+                return;
+            }
+            m_pendingRequest = PendingRequest::None;
+            m_conflictCount = 0;
+            if (response.Version)
+            {
+                m_version = response.Version;
+            }
+            for (auto &sent : m_sentValues)
+            {
+                auto propertyIter = m_properties.find(sent.first);
+                if (propertyIter != m_properties.end())
+                {
+                    propertyIter->second.reported = std::move(sent.second);
+                }
+            }
+            m_sentValues.clear();
+
+            if (HasWorkLocked())
+            {
+                ScheduleReconcileLocked(std::chrono::milliseconds(0));
+            }
+        }
+
+        void ShadowSync::OnRejected(const ErrorResponse &rejection, PendingRequest request) noexcept
+        {
+            enum class Outcome
+            {
+                Created,
+                Retry,
+                StartFailed,
+                Failed,
+            };
+            Outcome outcome = Outcome::Failed;
+            OnShadowSyncStarted onStarted;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_pendingRequest != request || !rejection.ClientToken || *rejection.ClientToken != m_pendingToken)
+                {
+                    return;
+                }
+                m_pendingRequest = PendingRequest::None;
+                m_sentValues.clear();
+                int32_t code = rejection.Code ? *rejection.Code : 0;
+
+                if (request == PendingRequest::Get && code == 404)
+                {
+                    /* The shadow does not exist yet; the first update creates it. */
+                    outcome = Outcome::Created;
+                    m_version.reset();
+                    for (auto &property : m_properties)
+                    {
+                        property.second.reported.reset();
+                        property.second.pendingDesired.reset();
+                    }
+                    if (!m_synchronized)
+                    {
+                        m_synchronized = true;
+                        onStarted = std::move(m_onStarted);
+                        m_onStarted = nullptr;
+                    }
+                    ScheduleReconcileLocked(std::chrono::milliseconds(0));
+                }
+                else if (request == PendingRequest::Update && code == 409 &&
+                         m_conflictCount < m_options.MaxConflictRetries)
+                {
+                    outcome = Outcome::Retry;
+                    m_conflictCount += 1;
+                }
+                else
+                {
+                    outcome = m_synchronized ? Outcome::Failed : Outcome::StartFailed;
+                    m_conflictCount = 0;
+                }
+            }
+
+            switch (outcome)
+            {
+                case Outcome::Created:
+                    if (onStarted)
+                    {
+                        onStarted(AWS_ERROR_SUCCESS, nullptr);
+                    }
+                    break;
+                case Outcome::Retry:
+                    RequestShadow();
+                    break;
+                case Outcome::StartFailed:
+                    OnStartFailed(AWS_ERROR_SUCCESS, &rejection);
+                    break;
+                case Outcome::Failed:
+                    ReportError(AWS_ERROR_SUCCESS, &rejection);
+                    break;
+            }
+        }
+
+        void ShadowSync::OnDelta(const ShadowDeltaUpdatedEvent &event) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            /* Until the shadow has been read, its response covers every delta. */
+            if (!m_synchronized || !event.State)
+            {
+                return;
+            }
+            if (event.Version)
+            {
+                if (m_version && *event.Version <= *m_version)
+                {
+                    return;
+                }
+                m_version = event.Version;
+            }
+
+            bool changed = false;
+            Aws::Crt::JsonView state = event.State->View();
+            for (auto &property : m_properties)
+            {
+                Aws::Crt::JsonView value;
+                if (s_findAtPath(state, property.second.segments, value))
+                {
+                    property.second.pendingDesired = value.Materialize();
+                    changed = true;
+                }
+            }
+            if (changed)
+            {
+                ScheduleReconcileLocked(m_options.DebounceInterval);
+            }
+        }
+
+        void ShadowSync::OnPublishFailed(uint64_t requestId, int ioErr) noexcept
+        {
+            bool startFailed = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_pendingRequest == PendingRequest::None || m_lastRequestId != requestId)
+                {
+                    return;
+                }
+                /* Once started, the request is left to time out, which reads the shadow and so retries it. */
+                startFailed = !m_synchronized;
+                if (startFailed)
+                {
+                    m_pendingRequest = PendingRequest::None;
+                }
+            }
+
+            if (startFailed)
+            {
+                OnStartFailed(ioErr, nullptr);
+            }
+            else
+            {
+                ReportError(ioErr, nullptr);
+            }
+        }
+
+        void ShadowSync::OnRequestTimedOut(uint64_t requestId) noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_pendingRequest == PendingRequest::None || m_lastRequestId != requestId)
+                {
+                    return;
+                }
+                m_pendingRequest = PendingRequest::None;
+                m_sentValues.clear();
+            }
+
+            /* Whether or not an update was applied, reading the shadow brings the reported values up to date. */
+            RequestShadow();
+        }
+
+        void ShadowSync::OnStartFailed(int ioErr, const ErrorResponse *rejection) noexcept
+        {
+            OnShadowSyncStarted onStarted;
+            Aws::Crt::Vector<ScopedSubscription> subscriptions;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                onStarted = std::move(m_onStarted);
+                m_onStarted = nullptr;
+                subscriptions.swap(m_subscriptions);
+                m_started = false;
+                m_pendingRequest = PendingRequest::None;
+            }
+
+            subscriptions.clear();
+            if (onStarted)
+            {
+                onStarted(ioErr, rejection);
+            }
+        }
+
+        void ShadowSync::ReportError(int ioErr, const ErrorResponse *rejection) const noexcept
+        {
+            if (m_options.OnError)
+            {
+                m_options.OnError(ioErr, rejection);
+            }
+        }
+
+        bool ShadowSync::HasWorkLocked() const noexcept
+        {
+            for (const auto &property : m_properties)
+            {
+                if (property.second.pendingDesired || !property.second.reported ||
+                    !s_sameValue(*property.second.reported, property.second.local))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        Aws::Crt::String ShadowSync::BeginRequestLocked(PendingRequest request) noexcept
+        {
+            m_lastRequestId += 1;
+            m_pendingRequest = request;
+            m_pendingToken = m_tokenPrefix + "-" + std::to_string(m_lastRequestId).c_str();
+            ScheduleTaskLocked(false, m_lastRequestId, GetClockTimeLocked() + s_toNanos(m_options.ResponseTimeout));
+            return m_pendingToken;
+        }
+
+        void ShadowSync::ScheduleReconcileLocked(std::chrono::milliseconds delay) noexcept
+        {
+            uint64_t now = GetClockTimeLocked();
+            if (!m_reconcileScheduled)
+            {
+                m_reconcileScheduled = true;
+                m_reconcileDeadline = now + s_toNanos(m_options.MaxDebounceDelay);
+                m_reconcileDueAt = (std::min)(now + s_toNanos(delay), m_reconcileDeadline);
+                ScheduleReconcileTaskLocked(m_reconcileDueAt);
+                return;
+            }
+
+            /* Each change puts the reconcile off again, but no later than the deadline set by the first. A later due
+             * time is left to the task already scheduled, which reschedules itself when it runs. */
+            m_reconcileDueAt = (std::min)(now + s_toNanos(delay), m_reconcileDeadline);
+            if (m_reconcileDueAt < m_reconcileTaskAt)
+            {
+                ScheduleReconcileTaskLocked(m_reconcileDueAt);
+            }
+        }
+
+        void ShadowSync::ScheduleReconcileTaskLocked(uint64_t runAt) noexcept
+        {
+            m_reconcileGeneration += 1;
+            m_reconcileTaskAt = runAt;
+            ScheduleTaskLocked(true, m_reconcileGeneration, runAt);
+        }
+
+        void ShadowSync::ScheduleTaskLocked(bool reconcile, uint64_t id, uint64_t runAt) noexcept
+        {
+            auto *scheduled = Aws::Crt::New<ScheduledTask>(m_allocator);
+            if (scheduled == nullptr)
+            {
+                return;
+            }
+            scheduled->sync = shared_from_this();
+            scheduled->allocator = m_allocator;
+            scheduled->reconcile = reconcile;
+            scheduled->id = id;
+            aws_task_init(&scheduled->task, s_onScheduledTask, scheduled, "ShadowSync");
+            aws_event_loop_schedule_task_future(m_eventLoop, &scheduled->task, runAt);
+        }
+
+        uint64_t ShadowSync::GetClockTimeLocked() const noexcept
+        {
+            uint64_t now = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &now);
+            return now;
+        }
+    } // namespace Iotshadow
+} // namespace Aws
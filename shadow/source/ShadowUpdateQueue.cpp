@@ -0,0 +1,388 @@
+/* Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/iotshadow/ShadowUpdateQueue.h>
+
+#include <aws/iotshadow/UpdateNamedShadowRequest.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/common/byte_buf.h>
+#include <aws/io/event_loop.h>
+
+#include <algorithm>
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        struct ShadowUpdateQueue::DrainTask
+        {
+            struct aws_task task;
+            std::weak_ptr<ShadowUpdateQueue> queue;
+            Aws::Crt::Allocator *allocator;
+        };
+
+        /* A record is the thing name, whether the shadow is named and its name, each length-prefixed, followed by
+         * the payload. */
+        static bool s_encodeRecord(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::Optional<Aws::Crt::String> &shadowName,
+            const Aws::Crt::String &payload,
+            Aws::Crt::ByteBuf &record)
+        {
+            Aws::Crt::ByteCursor thingNameCursor = Aws::Crt::ByteCursorFromString(thingName);
+            Aws::Crt::ByteCursor shadowNameCursor =
+                Aws::Crt::ByteCursorFromString(shadowName ? *shadowName : Aws::Crt::String());
+            Aws::Crt::ByteCursor payloadCursor = Aws::Crt::ByteCursorFromString(payload);
+            return aws_byte_buf_write_be32(&record, static_cast<uint32_t>(thingNameCursor.len)) &&
+                   aws_byte_buf_write_from_whole_cursor(&record, thingNameCursor) &&
+                   aws_byte_buf_write_u8(&record, shadowName ? 1 : 0) &&
+                   aws_byte_buf_write_be32(&record, static_cast<uint32_t>(shadowNameCursor.len)) &&
+                   aws_byte_buf_write_from_whole_cursor(&record, shadowNameCursor) &&
+                   aws_byte_buf_write_from_whole_cursor(&record, payloadCursor);
+        }
+
+        static bool s_readString(Aws::Crt::ByteCursor &cursor, Aws::Crt::String &value)
+        {
+            uint32_t length = 0;
+            if (!aws_byte_cursor_read_be32(&cursor, &length) || length > cursor.len)
+            {
+                return false;
+            }
+            value.assign(reinterpret_cast<const char *>(cursor.ptr), length);
+            aws_byte_cursor_advance(&cursor, length);
+            return true;
+        }
+
+        /* Objects are merged key by key; anything else, null included, is replaced by the later value. */
+        static Aws::Crt::JsonObject s_mergeJson(const Aws::Crt::JsonView &earlier, const Aws::Crt::JsonView &later)
+        {
+            if (!earlier.IsObject() || !later.IsObject())
+            {
+                return later.Materialize();
+            }
+
+            Aws::Crt::JsonObject merged = earlier.Materialize();
+            for (const auto &member : later.GetAllObjects())
+            {
+                if (earlier.ValueExists(member.first))
+                {
+                    merged.WithObject(member.first, s_mergeJson(earlier.GetJsonObject(member.first), member.second));
+                }
+                else
+                {
+                    merged.WithObject(member.first, member.second.Materialize());
+                }
+            }
+            return merged;
+        }
+
+        ShadowUpdateQueue::ShadowUpdateQueue(
+            std::shared_ptr<IotShadowClient> client,
+            const ShadowUpdateQueueOptions &options,
+            Aws::Crt::Allocator *allocator) noexcept
+            : m_client(std::move(client)), m_options(options), m_allocator(allocator), m_eventLoop(nullptr),
+              m_publishInterval(std::chrono::nanoseconds(std::chrono::seconds(1)) /
+                                std::max<uint32_t>(options.MaxPublishesPerSecond, 1)),
+              m_resumed(false), m_drainScheduled(false), m_publishing(0)
+        {
+            Aws::Crt::Io::EventLoopGroup *eventLoopGroup = m_options.EventLoopGroup;
+            if (eventLoopGroup == nullptr)
+            {
+                eventLoopGroup = Aws::Crt::ApiHandle::GetOrCreateStaticDefaultEventLoopGroup();
+            }
+            m_eventLoop = aws_event_loop_group_get_next_loop(eventLoopGroup->GetUnderlyingHandle());
+        }
+
+        std::shared_ptr<ShadowUpdateQueue> ShadowUpdateQueue::CreateQueue(
+            std::shared_ptr<IotShadowClient> client,
+            const ShadowUpdateQueueOptions &options,
+            Aws::Crt::Allocator *allocator) noexcept
+        {
+            auto *toSeat = static_cast<ShadowUpdateQueue *>(aws_mem_acquire(allocator, sizeof(ShadowUpdateQueue)));
+            if (toSeat == nullptr)
+            {
+                return nullptr;
+            }
+            toSeat = new (toSeat) ShadowUpdateQueue(std::move(client), options, allocator);
+            return std::shared_ptr<ShadowUpdateQueue>(
+                toSeat, [allocator](ShadowUpdateQueue *queue) { Aws::Crt::Delete(queue, allocator); });
+        }
+
+        ShadowUpdateQueue::~ShadowUpdateQueue() = default;
+
+        bool ShadowUpdateQueue::Open() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_log.IsOpen())
+            {
+                return true;
+            }
+            if (!m_log.Open(m_options.FilePath, m_options.MaxFileBytes, m_options.SyncEachWrite))
+            {
+                return false;
+            }
+
+            /* Updates are taken back as they were. A shadow may have two if the process stopped while one was being
+             * merged into the other, which does no harm, since the second includes the first. */
+            Aws::Crt::Vector<uint64_t> unreadable;
+            m_log.ForEach([this, &unreadable](uint64_t sequence, const Aws::Crt::ByteCursor &record) {
+                Aws::Crt::ByteCursor cursor = record;
+                PendingUpdate update;
+                uint8_t named = 0;
+                Aws::Crt::String shadowName;
+                if (!s_readString(cursor, update.thingName) || !aws_byte_cursor_read_u8(&cursor, &named) ||
+                    !s_readString(cursor, shadowName))
+                {
+                    unreadable.push_back(sequence);
+                    return;
+                }
+                if (named != 0)
+                {
+                    update.shadowName = shadowName;
+                }
+                update.payload.assign(reinterpret_cast<const char *>(cursor.ptr), cursor.len);
+                m_mergeTargets[update.thingName + "/" + shadowName] = sequence;
+                m_pending[sequence] = std::move(update);
+            });
+            for (uint64_t sequence : unreadable)
+            {
+                m_log.MarkDone(sequence);
+            }
+
+            ScheduleDrainLocked();
+            return true;
+        }
+
+        bool ShadowUpdateQueue::Enqueue(const UpdateShadowRequest &request) noexcept
+        {
+            if (!request.ThingName)
+            {
+                return false;
+            }
+            Aws::Crt::JsonObject payload;
+            request.SerializeToObject(payload);
+            return EnqueuePayload(*request.ThingName, Aws::Crt::Optional<Aws::Crt::String>(), std::move(payload));
+        }
+
+        bool ShadowUpdateQueue::Enqueue(const UpdateNamedShadowRequest &request) noexcept
+        {
+            if (!request.ThingName || !request.ShadowName)
+            {
+                return false;
+            }
+            Aws::Crt::JsonObject payload;
+            request.SerializeToObject(payload);
+            return EnqueuePayload(*request.ThingName, request.ShadowName, std::move(payload));
+        }
+
+        bool ShadowUpdateQueue::EnqueuePayload(
+            const Aws::Crt::String &thingName,
+            const Aws::Crt::Optional<Aws::Crt::String> &shadowName,
+            Aws::Crt::JsonObject payload) noexcept
+        {
+            Aws::Crt::String key = thingName + "/" + (shadowName ? *shadowName : Aws::Crt::String());
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_log.IsOpen())
+            {
+                return false;
+            }
+
+            auto targetIter = m_mergeTargets.find(key);
+            uint64_t mergedSequence = 0;
+            if (targetIter != m_mergeTargets.end() && targetIter->second != m_publishing)
+            {
+                mergedSequence = targetIter->second;
+                Aws::Crt::JsonObject earlierPayload(m_pending[mergedSequence].payload);
+                Aws::Crt::JsonView earlier = earlierPayload.View();
+                Aws::Crt::JsonView later = payload.View();
+                if (earlier.ValueExists("state") && later.ValueExists("state"))
+                {
+                    payload.WithObject(
+                        "state", s_mergeJson(earlier.GetJsonObject("state"), later.GetJsonObject("state")));
+                }
+                else if (earlier.ValueExists("state"))
+                {
+                    payload.WithObject("state", earlier.GetJsonObjectCopy("state"));
+                }
+            }
+
+            PendingUpdate update;
+            update.thingName = thingName;
+            update.shadowName = shadowName;
+            update.payload = payload.View().WriteCompact(true);
+
+            Aws::Crt::ByteBuf record;
+            aws_byte_buf_init(&record, m_allocator, update.thingName.size() + update.payload.size() + 64);
+            uint64_t sequence = 0;
+            if (s_encodeRecord(update.thingName, update.shadowName, update.payload, record))
+            {
+                sequence = m_log.Append(Aws::Crt::ByteCursorFromByteBuf(record));
+            }
+            aws_byte_buf_clean_up(&record);
+            if (sequence == 0)
+            {
+                return false;
+            }
+
+            /* The earlier update is only dropped once the one it was merged into has been written. */
+            if (mergedSequence != 0)
+            {
+                m_log.MarkDone(mergedSequence);
+                m_pending.erase(mergedSequence);
+            }
+            m_pending[sequence] = std::move(update);
+            m_mergeTargets[key] = sequence;
+            ScheduleDrainLocked();
+            return true;
+        }
+
+        void ShadowUpdateQueue::Resume() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_resumed = true;
+            ScheduleDrainLocked();
+        }
+
+        void ShadowUpdateQueue::Pause() noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_resumed = false;
+        }
+
+        size_t ShadowUpdateQueue::GetPendingCount() const noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_pending.size();
+        }
+
+        void ShadowUpdateQueue::s_onDrainTask(struct aws_task *task, void *arg, enum aws_task_status status)
+        {
+            (void)task;
+            auto *drainTask = static_cast<DrainTask *>(arg);
+            std::shared_ptr<ShadowUpdateQueue> queue = drainTask->queue.lock();
+            Aws::Crt::Delete(drainTask, drainTask->allocator);
+            if (!queue)
+            {
+                return;
+            }
+            if (status != AWS_TASK_STATUS_RUN_READY)
+            {
+                std::lock_guard<std::mutex> lock(queue->m_mutex);
+                queue->m_drainScheduled = false;
+                return;
+            }
+            queue->Drain();
+        }
+
+        void ShadowUpdateQueue::Drain() noexcept
+        {
+            uint64_t sequence = 0;
+            PendingUpdate update;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_drainScheduled = false;
+                if (!m_resumed || m_publishing != 0 || m_pending.empty())
+                {
+                    return;
+                }
+                sequence = m_pending.begin()->first;
+                update = m_pending.begin()->second;
+                m_publishing = sequence;
+                m_lastPublish = std::chrono::steady_clock::now();
+            }
+
+            std::weak_ptr<ShadowUpdateQueue> weakSelf = shared_from_this();
+            auto onPublished = [weakSelf, sequence](int ioErr) {
+                std::shared_ptr<ShadowUpdateQueue> self = weakSelf.lock();
+                if (self)
+                {
+                    self->OnPublished(sequence, ioErr);
+                }
+            };
+
+            Aws::Crt::JsonObject payload(update.payload);
+            bool published = false;
+            if (update.shadowName)
+            {
+                UpdateNamedShadowRequest request(payload.View());
+                request.ThingName = update.thingName;
+                request.ShadowName = update.shadowName;
+                published = m_client->PublishUpdateNamedShadow(request, m_options.Qos, onPublished);
+            }
+            else
+            {
+                UpdateShadowRequest request(payload.View());
+                request.ThingName = update.thingName;
+                published = m_client->PublishUpdateShadow(request, m_options.Qos, onPublished);
+            }
+
+            if (!published)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_publishing = 0;
+                ScheduleDrainLocked();
+            }
+        }
+
+        void ShadowUpdateQueue::OnPublished(uint64_t sequence, int ioErr) noexcept
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_publishing == sequence)
+            {
+                m_publishing = 0;
+            }
+
+            /* An update that failed to publish stays at the front of the queue, and is published again. */
+            if (ioErr == AWS_ERROR_SUCCESS)
+            {
+                m_log.MarkDone(sequence);
+                auto pendingIter = m_pending.find(sequence);
+                if (pendingIter != m_pending.end())
+                {
+                    const PendingUpdate &update = pendingIter->second;
+                    auto targetIter = m_mergeTargets.find(
+                        update.thingName + "/" + (update.shadowName ? *update.shadowName : Aws::Crt::String()));
+                    if (targetIter != m_mergeTargets.end() && targetIter->second == sequence)
+                    {
+                        m_mergeTargets.erase(targetIter);
+                    }
+                    m_pending.erase(pendingIter);
+                }
+            }
+            ScheduleDrainLocked();
+        }
+
+        void ShadowUpdateQueue::ScheduleDrainLocked() noexcept
+        {
+            if (!m_resumed || m_drainScheduled || m_publishing != 0 || m_pending.empty())
+            {
+                return;
+            }
+
+            auto *drainTask = Aws::Crt::New<DrainTask>(m_allocator);
+            if (drainTask == nullptr)
+            {
+                return;
+            }
+            drainTask->queue = shared_from_this();
+            drainTask->allocator = m_allocator;
+            aws_task_init(&drainTask->task, s_onDrainTask, drainTask, "ShadowUpdateQueue");
+            m_drainScheduled = true;
+
+            /* Publishes are spaced by the publish interval, counted from the last one. */
+            auto sinceLastPublish = std::chrono::steady_clock::now() - m_lastPublish;
+            auto delay = std::max<std::chrono::nanoseconds>(
+                std::chrono::nanoseconds(0),
+                m_publishInterval - std::chrono::duration_cast<std::chrono::nanoseconds>(sinceLastPublish));
+            uint64_t runAt = 0;
+            aws_event_loop_current_clock_time(m_eventLoop, &runAt);
+            runAt += static_cast<uint64_t>(delay.count());
+            aws_event_loop_schedule_task_future(m_eventLoop, &drainTask->task, runAt);
+        }
+    } // namespace Iotshadow
+} // namespace Aws
@@ -0,0 +1,69 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotservicecommon/CountingAllocator.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <thread>
+
+using namespace Aws::Crt;
+using Aws::Iotservicecommon::CountingAllocator;
+
+static int s_TestCountingAllocator(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        std::shared_ptr<Allocator> counting = CountingAllocator::Create(allocator);
+        ASSERT_NOT_NULL(counting.get());
+
+        void *first = aws_mem_acquire(counting.get(), 100);
+        void *second = aws_mem_acquire(counting.get(), 28);
+        ASSERT_NOT_NULL(first);
+        ASSERT_NOT_NULL(second);
+        ASSERT_UINT_EQUALS(128, CountingAllocator::GetAllocatedBytes(counting.get()));
+        ASSERT_UINT_EQUALS(2, CountingAllocator::GetAllocationCount(counting.get()));
+
+        /* The size header keeps the alignment of the allocator underneath. */
+        ASSERT_UINT_EQUALS(0, reinterpret_cast<uintptr_t>(first) % 16);
+
+        aws_mem_release(counting.get(), first);
+        ASSERT_UINT_EQUALS(28, CountingAllocator::GetAllocatedBytes(counting.get()));
+        ASSERT_UINT_EQUALS(1, CountingAllocator::GetAllocationCount(counting.get()));
+        aws_mem_release(counting.get(), second);
+
+        /* The peak and the total are kept once the allocations are freed. */
+        ASSERT_UINT_EQUALS(128, CountingAllocator::GetPeakBytes(counting.get()));
+        ASSERT_UINT_EQUALS(2, CountingAllocator::GetTotalAllocationCount(counting.get()));
+
+        /* Allocations from several threads at once are all counted. */
+        Vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i)
+        {
+            threads.emplace_back([&counting]() {
+                for (size_t size = 1; size <= 1000; ++size)
+                {
+                    aws_mem_release(counting.get(), aws_mem_acquire(counting.get(), size));
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        ASSERT_UINT_EQUALS(0, CountingAllocator::GetAllocatedBytes(counting.get()));
+        ASSERT_UINT_EQUALS(0, CountingAllocator::GetAllocationCount(counting.get()));
+        ASSERT_UINT_EQUALS(2 + 4 * 1000, CountingAllocator::GetTotalAllocationCount(counting.get()));
+        ASSERT_TRUE(CountingAllocator::GetPeakBytes(counting.get()) >= 1000);
+        ASSERT_TRUE(CountingAllocator::GetPeakBytes(counting.get()) <= 4 * 1000);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(CountingAllocatorCounts, s_TestCountingAllocator)
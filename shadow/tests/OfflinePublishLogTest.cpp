@@ -0,0 +1,202 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotshadow/OfflinePublishLog.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <cstdio>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotshadow;
+
+/* The log's header is 16 bytes and each record's header 24, with records padded to 8 bytes. */
+static const size_t s_logHeaderSize = 16;
+static const size_t s_recordHeaderSize = 24;
+
+struct LogRecord
+{
+    uint64_t sequence;
+    String record;
+};
+
+static Vector<LogRecord> s_readRecords(const OfflinePublishLog &log)
+{
+    Vector<LogRecord> records;
+    log.ForEach([&records](uint64_t sequence, const ByteCursor &record) {
+        records.push_back({sequence, String(reinterpret_cast<const char *>(record.ptr), record.len)});
+    });
+    return records;
+}
+
+static uint64_t s_append(OfflinePublishLog &log, const char *record)
+{
+    return log.Append(ByteCursorFromCString(record));
+}
+
+/* Overwrite part of the file, as a write that was cut short or a bad sector would leave it. */
+static bool s_overwrite(const char *path, size_t offset, const void *bytes, size_t length)
+{
+    FILE *file = fopen(path, "r+b");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool written = fseek(file, static_cast<long>(offset), SEEK_SET) == 0 && fwrite(bytes, 1, length, file) == length;
+    fclose(file);
+    return written;
+}
+
+static int s_TestOfflinePublishLogRecovery(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+        const char *path = "OfflinePublishLogRecovery.log";
+        remove(path);
+
+        {
+            OfflinePublishLog log;
+            ASSERT_TRUE(log.Open(path, 4096, true));
+            ASSERT_UINT_EQUALS(1, s_append(log, "record-1"));
+            ASSERT_UINT_EQUALS(2, s_append(log, "record-2"));
+            ASSERT_UINT_EQUALS(3, s_append(log, "record-3"));
+            ASSERT_UINT_EQUALS(4, s_append(log, "record-4"));
+            log.MarkDone(1);
+            ASSERT_UINT_EQUALS(3, log.GetRecordCount());
+        }
+
+        /* Records that are not done come back, and sequence numbers carry on from the last one. */
+        {
+            OfflinePublishLog log;
+            ASSERT_TRUE(log.Open(path, 4096, false));
+            Vector<LogRecord> records = s_readRecords(log);
+            ASSERT_UINT_EQUALS(3, records.size());
+            ASSERT_UINT_EQUALS(2, records[0].sequence);
+            ASSERT_TRUE(records[0].record == "record-2");
+            ASSERT_UINT_EQUALS(4, records[2].sequence);
+        }
+
+        /* Corrupt the third record. Reading stops before it, so the fourth is lost with it. Each record of 8 bytes
+         * takes 32. */
+        size_t recordSize = s_recordHeaderSize + 8;
+        size_t thirdRecord = s_logHeaderSize + 2 * recordSize;
+        ASSERT_TRUE(s_overwrite(path, thirdRecord + s_recordHeaderSize, "RECORD", 6));
+        {
+            OfflinePublishLog log;
+            ASSERT_TRUE(log.Open(path, 4096, false));
+            Vector<LogRecord> records = s_readRecords(log);
+            ASSERT_UINT_EQUALS(1, records.size());
+            ASSERT_TRUE(records[0].record == "record-2");
+
+            /* The next record is written where the corrupt one was. */
+            ASSERT_UINT_EQUALS(3, s_append(log, "record-5"));
+        }
+
+        /* Cut the new record short, as a write interrupted by a power loss would. */
+        const uint8_t zeros[8] = {0};
+        ASSERT_TRUE(s_overwrite(path, thirdRecord + s_recordHeaderSize, zeros, sizeof(zeros)));
+        {
+            OfflinePublishLog log;
+            ASSERT_TRUE(log.Open(path, 4096, false));
+            Vector<LogRecord> records = s_readRecords(log);
+            ASSERT_UINT_EQUALS(1, records.size());
+            ASSERT_UINT_EQUALS(2, records[0].sequence);
+            ASSERT_UINT_EQUALS(3, s_append(log, "record-6"));
+        }
+        {
+            OfflinePublishLog log;
+            ASSERT_TRUE(log.Open(path, 4096, false));
+            Vector<LogRecord> records = s_readRecords(log);
+            ASSERT_UINT_EQUALS(2, records.size());
+            ASSERT_TRUE(records[1].record == "record-6");
+        }
+
+        /* A file that is not a log is not opened. */
+        const char notALog[] = "not an offline publish log";
+        ASSERT_TRUE(s_overwrite(path, 0, notALog, sizeof(notALog)));
+        {
+            OfflinePublishLog log;
+            ASSERT_FALSE(log.Open(path, 4096, false));
+            ASSERT_FALSE(log.IsOpen());
+            ASSERT_UINT_EQUALS(0, s_append(log, "record-7"));
+        }
+
+        remove(path);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(OfflinePublishLogRecovery, s_TestOfflinePublishLogRecovery)
+
+static int s_TestOfflinePublishLogCompaction(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+        const char *path = "OfflinePublishLogCompaction.log";
+        Aws::Crt::String compactPath = Aws::Crt::String(path) + ".compact";
+        remove(path);
+
+        /* Room for the header and four records of 8 bytes. */
+        size_t maxBytes = s_logHeaderSize + 4 * (s_recordHeaderSize + 8);
+        {
+            OfflinePublishLog log;
+            ASSERT_TRUE(log.Open(path, maxBytes, true));
+            ASSERT_UINT_EQUALS(1, s_append(log, "record-1"));
+            ASSERT_UINT_EQUALS(2, s_append(log, "record-2"));
+            ASSERT_UINT_EQUALS(3, s_append(log, "record-3"));
+            ASSERT_UINT_EQUALS(4, s_append(log, "record-4"));
+
+            /* Full, with nothing done to drop. */
+            ASSERT_UINT_EQUALS(0, s_append(log, "record-5"));
+            ASSERT_UINT_EQUALS(4, log.GetRecordCount());
+
+            /* Dropping the records that are done makes room, and keeps the others in order. */
+            log.MarkDone(1);
+            log.MarkDone(3);
+            ASSERT_UINT_EQUALS(5, s_append(log, "record-5"));
+            ASSERT_UINT_EQUALS(6, s_append(log, "record-6"));
+            ASSERT_UINT_EQUALS(0, s_append(log, "record-7"));
+
+            Vector<LogRecord> records = s_readRecords(log);
+            ASSERT_UINT_EQUALS(4, records.size());
+            ASSERT_TRUE(records[0].record == "record-2");
+            ASSERT_TRUE(records[1].record == "record-4");
+            ASSERT_TRUE(records[2].record == "record-5");
+            ASSERT_TRUE(records[3].record == "record-6");
+
+            /* The compacted file replaced the log. */
+            FILE *compactFile = fopen(compactPath.c_str(), "rb");
+            ASSERT_NULL(compactFile);
+        }
+
+        {
+            OfflinePublishLog log;
+            ASSERT_TRUE(log.Open(path, maxBytes, false));
+            Vector<LogRecord> records = s_readRecords(log);
+            ASSERT_UINT_EQUALS(4, records.size());
+            ASSERT_UINT_EQUALS(2, records[0].sequence);
+            ASSERT_UINT_EQUALS(6, records[3].sequence);
+
+            /* Sequence numbers never go back, even once every record is done and the file is compacted. */
+            for (const LogRecord &record : records)
+            {
+                log.MarkDone(record.sequence);
+            }
+            ASSERT_UINT_EQUALS(7, s_append(log, "record-7"));
+            ASSERT_UINT_EQUALS(1, log.GetRecordCount());
+        }
+
+        remove(path);
+        remove(compactPath.c_str());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(OfflinePublishLogCompaction, s_TestOfflinePublishLogCompaction)
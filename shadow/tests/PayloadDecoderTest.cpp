@@ -0,0 +1,297 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+
+#include <aws/iotshadow/PayloadDecoder.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotshadow;
+
+static JsonPayloadValue s_valueOf(const char *raw)
+{
+    return JsonPayloadValue(ByteCursorFromCString(raw));
+}
+
+template <typename T>
+static bool s_optionalEquals(const Optional<T> &left, const Optional<T> &right)
+{
+    return left.has_value() == right.has_value() && (!left.has_value() || left.value() == right.value());
+}
+
+/* The payload must decode to the same model on demand as it does through JsonObject. */
+static bool s_decodesAsJsonObject(const char *payload)
+{
+    ErrorResponse onDemand;
+    ErrorResponse jsonObject;
+    DecodePayload(ByteCursorFromCString(payload), onDemand, PayloadDecoding::OnDemand);
+    DecodePayload(ByteCursorFromCString(payload), jsonObject, PayloadDecoding::JsonObject);
+    return s_optionalEquals(onDemand.ClientToken, jsonObject.ClientToken) &&
+           s_optionalEquals(onDemand.Code, jsonObject.Code) && s_optionalEquals(onDemand.Message, jsonObject.Message);
+}
+
+static int s_TestPayloadReaderNumbers(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        int64_t integer = 0;
+        ASSERT_TRUE(s_valueOf("42").GetInt64(integer));
+        ASSERT_INT_EQUALS(42, integer);
+        ASSERT_TRUE(s_valueOf("-7").GetInt64(integer));
+        ASSERT_INT_EQUALS(-7, integer);
+        ASSERT_TRUE(s_valueOf("0").GetInt64(integer));
+        ASSERT_INT_EQUALS(0, integer);
+
+        const char *notIntegers[] = {
+            "1.5", "1e3", "+1", "01", "-", "0x10", " 1", "true", "\"1\"", "99999999999999999999"};
+        for (const char *raw : notIntegers)
+        {
+            ASSERT_FALSE(s_valueOf(raw).GetInt64(integer));
+        }
+
+        double number = 0;
+        ASSERT_TRUE(s_valueOf("1.5").GetDouble(number));
+        ASSERT_TRUE(number == 1.5);
+        ASSERT_TRUE(s_valueOf("-0.25e2").GetDouble(number));
+        ASSERT_TRUE(number == -25.0);
+        ASSERT_TRUE(s_valueOf("1E+3").GetDouble(number));
+        ASSERT_TRUE(number == 1000.0);
+        ASSERT_TRUE(s_valueOf("1623456789").GetDouble(number));
+        ASSERT_TRUE(number == 1623456789.0);
+
+        const char *notNumbers[] = {"+1", "inf", "nan", "0x1p3", "1.", ".5", "1e", "1e+", "-.5", "00", "1..2"};
+        for (const char *raw : notNumbers)
+        {
+            ASSERT_FALSE(s_valueOf(raw).GetDouble(number));
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(PayloadReaderNumbers, s_TestPayloadReaderNumbers)
+
+static int s_TestPayloadReaderStrings(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        String value;
+        ASSERT_TRUE(s_valueOf("\"plain\"").GetString(value));
+        ASSERT_TRUE(value == "plain");
+        ASSERT_TRUE(s_valueOf("\"a\\\"b\\\\c\\/d\\n\\t\"").GetString(value));
+        ASSERT_TRUE(value == "a\"b\\c/d\n\t");
+        ASSERT_TRUE(s_valueOf("\"\\u0041\\u00e9\\u20AC\"").GetString(value));
+        ASSERT_TRUE(value == "A\xC3\xA9\xE2\x82\xAC");
+
+        /* Surrogate pairs and invalid escapes are left to JsonObject. */
+        const char *notDecoded[] = {
+            "\"\\ud83d\\ude00\"",
+            "\"\\q\"",
+            "\"\\u+123\"",
+            "\"\\u 12a\"",
+            "\"\\u0x12\"",
+            "\"\\u12\"",
+            "\"abc\\\"",
+            "abc",
+        };
+        for (const char *raw : notDecoded)
+        {
+            ASSERT_FALSE(s_valueOf(raw).GetString(value));
+        }
+
+        /* A key with an escape stops the reader; strings within values are skipped whatever they contain. */
+        JsonPayloadReader escapedKey(s_valueOf("{\"a\\u0062\":1}"));
+        ByteCursor key;
+        JsonPayloadValue member;
+        ASSERT_FALSE(escapedKey.Next(key, member));
+        ASSERT_TRUE(escapedKey.HasError());
+
+        JsonPayloadReader reader(s_valueOf(" { \"text\" : \"x\\\"}\" , \"next\":[1,{\"y\":\"]\"}] } "));
+        ASSERT_TRUE(reader.Next(key, member));
+        ASSERT_TRUE(JsonPayloadReader::KeyIs(key, "text"));
+        ASSERT_TRUE(member.GetString(value));
+        ASSERT_TRUE(value == "x\"}");
+        ASSERT_TRUE(reader.Next(key, member));
+        ASSERT_TRUE(JsonPayloadReader::KeyIs(key, "next"));
+        ByteCursor raw = member.GetRaw();
+        ASSERT_TRUE(aws_byte_cursor_eq_c_str(&raw, "[1,{\"y\":\"]\"}]"));
+        ASSERT_FALSE(reader.Next(key, member));
+        ASSERT_FALSE(reader.HasError());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(PayloadReaderStrings, s_TestPayloadReaderStrings)
+
+static int s_TestPayloadReaderMalformed(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        const char *malformed[] = {
+            "",
+            "[1]",
+            "{\"a\":1,}",
+            "{\"a\" 1}",
+            "{\"a\":\"x}",
+            "{\"a\":{\"b\":1}",
+            "{\"a\":1} x",
+            "{\"a\":1 \"b\":2}",
+            "{a:1}",
+            "{\"a\":{]}",
+            "{\"a\":[}]}",
+            "{\"a\":[{\"b\":1]}}",
+            "{\"a\":{\"b\":[1}}}",
+            "{\"a\":[[]}]}",
+        };
+        for (const char *payload : malformed)
+        {
+            JsonPayloadReader reader(s_valueOf(payload));
+            ByteCursor key;
+            JsonPayloadValue value;
+            while (reader.Next(key, value))
+            {
+            }
+            ASSERT_TRUE(reader.HasError());
+            /* Once failed, the reader stays failed. */
+            ASSERT_FALSE(reader.Next(key, value));
+        }
+
+        JsonPayloadReader empty(s_valueOf(" {} "));
+        ByteCursor key;
+        JsonPayloadValue value;
+        ASSERT_FALSE(empty.Next(key, value));
+        ASSERT_FALSE(empty.HasError());
+
+        /* Brackets inside strings are not counted. */
+        JsonPayloadReader nested(s_valueOf("{\"a\":[{\"b\":\"]}\"},[{}]],\"c\":{\"d\":\"{[\"}}"));
+        ASSERT_TRUE(nested.Next(key, value));
+        ASSERT_TRUE(aws_byte_cursor_eq_c_str(&key, "a"));
+        ASSERT_TRUE(nested.Next(key, value));
+        ASSERT_TRUE(aws_byte_cursor_eq_c_str(&key, "c"));
+        ASSERT_FALSE(nested.Next(key, value));
+        ASSERT_FALSE(nested.HasError());
+
+        /* Values are skipped down to a depth of 1024. */
+        for (size_t depth = 1024; depth <= 1025; ++depth)
+        {
+            String deep = "{\"a\":" + String(depth, '[') + String(depth, ']') + "}";
+            JsonPayloadReader reader(s_valueOf(deep.c_str()));
+            while (reader.Next(key, value))
+            {
+            }
+            ASSERT_TRUE(reader.HasError() == (depth > 1024));
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(PayloadReaderMalformed, s_TestPayloadReaderMalformed)
+
+static int s_TestShadowPayloadDecoding(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        ShadowDeltaUpdatedEvent delta;
+        DecodePayload(
+            ByteCursorFromCString("{\"state\":{\"color\":\"red\"},\"metadata\":null,\"timestamp\":1623456789,"
+                                  "\"version\":12,\"clientToken\":\"t\\u00e9\",\"unknown\":[true,false]}"),
+            delta);
+        ASSERT_TRUE(delta.State.has_value());
+        ASSERT_TRUE(delta.State.value().View().GetString("color") == "red");
+        ASSERT_FALSE(delta.Metadata.has_value());
+        ASSERT_TRUE(delta.Timestamp.has_value());
+        ASSERT_TRUE(delta.Timestamp.value().SecondsWithMSPrecision() == 1623456789.0);
+        ASSERT_TRUE(delta.Version.has_value());
+        ASSERT_INT_EQUALS(12, delta.Version.value());
+        ASSERT_TRUE(delta.ClientToken.has_value());
+        ASSERT_TRUE(delta.ClientToken.value() == "t\xC3\xA9");
+
+        /* Payloads the reader does not decode fall back to JsonObject and decode the same either way. */
+        const char *fallbacks[] = {
+            "{\"clientToken\":\"t\",\"code\":400,\"message\":\"m\"}",
+            "{\"client\\u0054oken\":\"t\",\"code\":400}",
+            "{\"clientToken\":\"\\ud83d\\ude00\",\"code\":400}",
+            "{\"clientToken\":\"t\",\"code\":400.0}",
+            "{\"clientToken\":\"t\",\"code\":4e2}",
+            "{\"clientToken\":\"t\",\"code\":\"400\"}",
+            "{\"clientToken\":7,\"code\":400}",
+            "{\"clientToken\":\"t\",\"code\":400",
+            "{\"clientToken\":\"t\",\"code\":400}}",
+        };
+        for (const char *payload : fallbacks)
+        {
+            ASSERT_TRUE(s_decodesAsJsonObject(payload));
+        }
+
+        ErrorResponse error;
+        DecodePayload(ByteCursorFromCString("{\"client\\u0054oken\":\"t\",\"code\":4e2}"), error);
+        ASSERT_TRUE(error.ClientToken.has_value());
+        ASSERT_TRUE(error.ClientToken.value() == "t");
+        ASSERT_TRUE(error.Code.has_value());
+        ASSERT_INT_EQUALS(400, error.Code.value());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowPayloadDecoding, s_TestShadowPayloadDecoding)
+
+static int s_TestShadowPayloadDuplicateKeys(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        /* As with cJSON, the first member with a key is the one read, even when it is null or of the wrong type. */
+        const char *duplicates[] = {
+            "{\"clientToken\":\"first\",\"code\":400,\"clientToken\":\"second\"}",
+            "{\"code\":null,\"clientToken\":\"t\",\"code\":400}",
+            "{\"code\":400,\"code\":\"x\",\"message\":\"m\"}",
+            "{\"code\":\"x\",\"code\":400}",
+        };
+        for (const char *payload : duplicates)
+        {
+            ASSERT_TRUE(s_decodesAsJsonObject(payload));
+        }
+
+        ErrorResponse error;
+        DecodePayload(ByteCursorFromCString(duplicates[0]), error, PayloadDecoding::OnDemand);
+        ASSERT_TRUE(error.ClientToken.value() == "first");
+
+        DecodePayload(ByteCursorFromCString(duplicates[1]), error, PayloadDecoding::OnDemand);
+        ASSERT_FALSE(error.Code.has_value());
+
+        DecodePayload(ByteCursorFromCString(duplicates[2]), error, PayloadDecoding::OnDemand);
+        ASSERT_INT_EQUALS(400, error.Code.value());
+
+        /* The first member of a nested model wins within that model only. */
+        UpdateShadowResponse response;
+        DecodePayload(
+            ByteCursorFromCString("{\"state\":{\"reported\":{\"on\":true},\"reported\":null},\"version\":3,"
+                                  "\"state\":{\"desired\":{}},\"version\":4}"),
+            response,
+            PayloadDecoding::OnDemand);
+        ASSERT_TRUE(response.State.has_value());
+        ASSERT_TRUE(response.State.value().Reported.has_value());
+        ASSERT_TRUE(response.State.value().Reported.value().View().GetBool("on"));
+        ASSERT_FALSE(response.State.value().Desired.has_value());
+        ASSERT_INT_EQUALS(3, response.Version.value());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowPayloadDuplicateKeys, s_TestShadowPayloadDuplicateKeys)
@@ -0,0 +1,285 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/iotshadow/ShadowSchema.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotshadow;
+
+struct NetworkState
+{
+    String Ssid;
+    int64_t Rssi = 0;
+};
+
+struct DeviceState
+{
+    bool Power = false;
+    int32_t FanSpeed = 0;
+    int64_t Uptime = 0;
+    double Temperature = 0;
+    String Color;
+    JsonObject Config;
+    NetworkState Network;
+};
+
+namespace Aws
+{
+    namespace Iotshadow
+    {
+        template <> struct ShadowSchema<NetworkState>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("ssid", &NetworkState::Ssid);
+                visitor.Field("rssi", &NetworkState::Rssi);
+            }
+        };
+
+        template <> struct ShadowSchema<DeviceState>
+        {
+            template <typename Visitor> static void Describe(Visitor &visitor)
+            {
+                visitor.Field("power", &DeviceState::Power);
+                visitor.Field("fanSpeed", &DeviceState::FanSpeed);
+                visitor.Field("uptime", &DeviceState::Uptime);
+                visitor.Field("temperature", &DeviceState::Temperature);
+                visitor.Field("color", &DeviceState::Color);
+                visitor.Field("config", &DeviceState::Config);
+                visitor.Field("network", &DeviceState::Network);
+            }
+        };
+    } // namespace Iotshadow
+} // namespace Aws
+
+static DeviceState s_sampleState()
+{
+    DeviceState state;
+    state.Power = true;
+    state.FanSpeed = -3;
+    state.Uptime = int64_t(1) << 40;
+    state.Temperature = 21.5;
+    state.Color = "blue \"sky\"";
+    state.Config = JsonObject("{\"modes\":[1,2],\"auto\":true}");
+    state.Network.Ssid = "home";
+    state.Network.Rssi = -40;
+    return state;
+}
+
+static bool s_sameState(const DeviceState &left, const DeviceState &right)
+{
+    return left.Power == right.Power && left.FanSpeed == right.FanSpeed && left.Uptime == right.Uptime &&
+           left.Temperature == right.Temperature && left.Color == right.Color &&
+           left.Config.View().WriteCompact(true) == right.Config.View().WriteCompact(true) &&
+           left.Network.Ssid == right.Network.Ssid && left.Network.Rssi == right.Network.Rssi;
+}
+
+static bool s_decodeDelta(const char *payload, DeviceState &desired, TypedShadowDelta<DeviceState> &delta)
+{
+    return DecodeShadowDelta(ByteCursorFromCString(payload), desired, delta);
+}
+
+static int s_TestShadowSchemaRoundTrip(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        TypedShadowUpdate<DeviceState> update;
+        update.Desired = s_sampleState();
+        update.DesiredFields = ShadowFieldSet<DeviceState>::All();
+        update.Reported.FanSpeed = 7;
+        update.Reported.Network.Rssi = -70;
+        update.ReportedFields.Add(&DeviceState::FanSpeed).Add(&DeviceState::Network);
+        update.ClientToken = String("token-1");
+        update.Version = 12;
+
+        ByteBuf payload;
+        ASSERT_SUCCESS(aws_byte_buf_init(&payload, allocator, 64));
+        ASSERT_TRUE(EncodePayload(update, payload));
+        String encoded(reinterpret_cast<const char *>(payload.buffer), payload.len);
+        aws_byte_buf_clean_up(&payload);
+
+        /* The payload is the JSON the service expects, and only the chosen reported fields are in it. */
+        JsonObject json(encoded);
+        ASSERT_TRUE(json.WasParseSuccessful());
+        ASSERT_INT_EQUALS(12, json.View().GetInteger("version"));
+        JsonView reportedJson = json.View().GetJsonObject("state").GetJsonObject("reported");
+        ASSERT_UINT_EQUALS(2, reportedJson.GetAllObjects().size());
+        ASSERT_TRUE(reportedJson.GetJsonObject("network").GetString("ssid").empty());
+
+        DeviceState desired;
+        DeviceState reported;
+        TypedShadowDocument<DeviceState> document;
+        ASSERT_TRUE(DecodeShadowDocument(ByteCursorFromCString(encoded.c_str()), desired, reported, document));
+        ASSERT_TRUE(s_sameState(update.Desired, desired));
+        ASSERT_INT_EQUALS(7, reported.FanSpeed);
+        ASSERT_INT_EQUALS(-70, reported.Network.Rssi);
+        ASSERT_TRUE(document.Version.has_value());
+        ASSERT_INT_EQUALS(12, *document.Version);
+        ASSERT_TRUE(document.ClientToken.has_value() && *document.ClientToken == "token-1");
+
+        ASSERT_TRUE(document.Desired.Present.Contains(&DeviceState::Config));
+        ASSERT_TRUE(document.Desired.Changed.Contains(&DeviceState::Color));
+        ASSERT_TRUE(document.Desired.Mismatched.IsEmpty());
+        ASSERT_TRUE(document.Reported.Present.Contains(&DeviceState::FanSpeed));
+        ASSERT_FALSE(document.Reported.Present.Contains(&DeviceState::Power));
+        ASSERT_TRUE(document.Delta.Present.IsEmpty());
+
+        /* An update with no fields leaves the state out altogether. */
+        TypedShadowUpdate<DeviceState> empty;
+        ASSERT_SUCCESS(aws_byte_buf_init(&payload, allocator, 16));
+        ASSERT_TRUE(EncodePayload(empty, payload));
+        ASSERT_TRUE(String(reinterpret_cast<const char *>(payload.buffer), payload.len) == "{}");
+        aws_byte_buf_clean_up(&payload);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowSchemaRoundTrip, s_TestShadowSchemaRoundTrip)
+
+static int s_TestShadowSchemaUnknownFields(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        /* Members that are not in the schema, at any depth and of any type, are skipped. */
+        DeviceState desired;
+        TypedShadowDelta<DeviceState> delta;
+        ASSERT_TRUE(s_decodeDelta(
+            "{\"timestamp\":1,\"state\":{\"unknown\":{\"a\":[1,{\"b\":\"}\"}]},\"power\":true,\"extra\":[[]],"
+            "\"network\":{\"bssid\":\"00:11\",\"ssid\":\"office\"}},\"metadata\":{\"power\":{\"timestamp\":1}},"
+            "\"version\":3}",
+            desired,
+            delta));
+        ASSERT_TRUE(desired.Power);
+        ASSERT_TRUE(desired.Network.Ssid == "office");
+        ASSERT_TRUE(delta.State.Present.Contains(&DeviceState::Power));
+        ASSERT_TRUE(delta.State.Present.Contains(&DeviceState::Network));
+        ASSERT_FALSE(delta.State.Present.Contains(&DeviceState::Color));
+        ASSERT_TRUE(delta.State.Mismatched.IsEmpty());
+        ASSERT_TRUE(delta.Version.has_value());
+        ASSERT_INT_EQUALS(3, *delta.Version);
+
+        /* A document's sections other than desired, reported and delta are skipped too. */
+        DeviceState reported;
+        TypedShadowDocument<DeviceState> document;
+        ASSERT_TRUE(DecodeShadowDocument(
+            ByteCursorFromCString("{\"state\":{\"other\":{\"power\":true},\"reported\":{\"color\":\"red\"}}}"),
+            desired,
+            reported,
+            document));
+        ASSERT_TRUE(reported.Color == "red");
+        ASSERT_FALSE(reported.Power);
+        ASSERT_TRUE(document.Desired.Present.IsEmpty());
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowSchemaUnknownFields, s_TestShadowSchemaUnknownFields)
+
+static int s_TestShadowSchemaPartialDelta(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        DeviceState desired = s_sampleState();
+        DeviceState before = desired;
+
+        /* Only the fields in the delta are read, and nested objects are merged into the nested struct. */
+        TypedShadowDelta<DeviceState> delta;
+        ASSERT_TRUE(s_decodeDelta(
+            "{\"state\":{\"fanSpeed\":-3,\"network\":{\"rssi\":-55}},\"version\":8}", desired, delta));
+        ASSERT_TRUE(delta.State.Present.Contains(&DeviceState::FanSpeed));
+        ASSERT_TRUE(delta.State.Present.Contains(&DeviceState::Network));
+        ASSERT_FALSE(delta.State.Present.Contains(&DeviceState::Power));
+        ASSERT_FALSE(delta.State.Changed.Contains(&DeviceState::FanSpeed));
+        ASSERT_TRUE(delta.State.Changed.Contains(&DeviceState::Network));
+        ASSERT_INT_EQUALS(-55, desired.Network.Rssi);
+        ASSERT_TRUE(desired.Network.Ssid == before.Network.Ssid);
+        desired.Network.Rssi = before.Network.Rssi;
+        ASSERT_TRUE(s_sameState(before, desired));
+
+        /* A value of the wrong type, or out of the field's range, leaves the field as it was. */
+        TypedShadowDelta<DeviceState> mismatched;
+        ASSERT_TRUE(s_decodeDelta(
+            "{\"state\":{\"fanSpeed\":3000000000,\"color\":5,\"power\":false,\"network\":{\"rssi\":\"low\"}}}",
+            desired,
+            mismatched));
+        ASSERT_TRUE(mismatched.State.Mismatched.Contains(&DeviceState::FanSpeed));
+        ASSERT_TRUE(mismatched.State.Mismatched.Contains(&DeviceState::Color));
+        ASSERT_TRUE(mismatched.State.Mismatched.Contains(&DeviceState::Network));
+        ASSERT_FALSE(mismatched.State.Mismatched.Contains(&DeviceState::Power));
+        ASSERT_TRUE(mismatched.State.Changed.Contains(&DeviceState::Power));
+        ASSERT_INT_EQUALS(before.FanSpeed, desired.FanSpeed);
+        ASSERT_TRUE(desired.Color == before.Color);
+        ASSERT_INT_EQUALS(before.Network.Rssi, desired.Network.Rssi);
+        ASSERT_FALSE(desired.Power);
+        ASSERT_FALSE(mismatched.Version.has_value());
+
+        /* A malformed payload fails the decode. */
+        TypedShadowDelta<DeviceState> malformed;
+        ASSERT_FALSE(s_decodeDelta("{\"state\":{\"power\":tru}}", desired, malformed));
+        ASSERT_FALSE(s_decodeDelta("{\"state\":{\"network\":{\"ssid\":\"a\"]}}", desired, malformed));
+        ASSERT_FALSE(s_decodeDelta("{\"state\":", desired, malformed));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowSchemaPartialDelta, s_TestShadowSchemaPartialDelta)
+
+static int s_TestShadowSchemaNullFields(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    (void)ctx;
+    {
+        ApiHandle apiHandle(allocator);
+
+        DeviceState desired = s_sampleState();
+        DeviceState before = desired;
+
+        /* A null value removes the field from the shadow. It is not present, and the struct keeps its value. */
+        TypedShadowDelta<DeviceState> delta;
+        ASSERT_TRUE(s_decodeDelta(
+            "{\"state\":{\"color\":null,\"config\":null,\"network\":{\"ssid\":null},\"power\":false}}",
+            desired,
+            delta));
+        ASSERT_FALSE(delta.State.Present.Contains(&DeviceState::Color));
+        ASSERT_FALSE(delta.State.Present.Contains(&DeviceState::Config));
+        ASSERT_TRUE(delta.State.Present.Contains(&DeviceState::Network));
+        ASSERT_FALSE(delta.State.Changed.Contains(&DeviceState::Network));
+        ASSERT_TRUE(delta.State.Changed.Contains(&DeviceState::Power));
+        ASSERT_TRUE(delta.State.Mismatched.IsEmpty());
+        ASSERT_TRUE(desired.Color == before.Color);
+        ASSERT_TRUE(desired.Network.Ssid == before.Network.Ssid);
+        ASSERT_TRUE(desired.Config.View().WriteCompact(true) == before.Config.View().WriteCompact(true));
+
+        /* A section that was removed is null, and is skipped like an absent one. */
+        DeviceState reported = before;
+        TypedShadowDocument<DeviceState> document;
+        ASSERT_TRUE(DecodeShadowDocument(
+            ByteCursorFromCString("{\"state\":{\"desired\":null,\"reported\":{\"uptime\":null,\"fanSpeed\":1}}}"),
+            desired,
+            reported,
+            document));
+        ASSERT_TRUE(document.Desired.Present.IsEmpty());
+        ASSERT_FALSE(document.Reported.Present.Contains(&DeviceState::Uptime));
+        ASSERT_TRUE(document.Reported.Present.Contains(&DeviceState::FanSpeed));
+        ASSERT_TRUE(reported.Uptime == before.Uptime);
+        ASSERT_INT_EQUALS(1, reported.FanSpeed);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(ShadowSchemaNullFields, s_TestShadowSchemaNullFields)
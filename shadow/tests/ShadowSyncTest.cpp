@@ -0,0 +1,418 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/iotshadow/ShadowSync.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+#include "LocalMqttBroker.h"
+#include "ShadowServiceEmulator.h"
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotshadow;
+
+struct ShadowSyncTestContext
+{
+    std::unique_ptr<ApiHandle> apiHandle;
+    std::unique_ptr<Io::EventLoopGroup> elGroup;
+    std::unique_ptr<Io::HostResolver> resolver;
+    std::unique_ptr<Io::ClientBootstrap> clientBootstrap;
+};
+
+static ShadowSyncTestContext s_testContext;
+
+static int s_testSetup(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ShadowSyncTestContext *>(ctx);
+
+    testContext->apiHandle = std::unique_ptr<ApiHandle>(new ApiHandle(allocator));
+    testContext->elGroup = std::unique_ptr<Io::EventLoopGroup>(new Io::EventLoopGroup(0, allocator));
+    testContext->resolver =
+        std::unique_ptr<Io::HostResolver>(new Io::DefaultHostResolver(*testContext->elGroup, 8, 30, allocator));
+    testContext->clientBootstrap = std::unique_ptr<Io::ClientBootstrap>(
+        new Io::ClientBootstrap(*testContext->elGroup, *testContext->resolver, allocator));
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static int s_testTeardown(struct aws_allocator *allocator, int setup_result, void *ctx)
+{
+    auto *testContext = static_cast<ShadowSyncTestContext *>(ctx);
+
+    testContext->elGroup.reset();
+    testContext->resolver.reset();
+    testContext->clientBootstrap.reset();
+    /* The ApiHandle must be deallocated last or a deadlock occurs. */
+    testContext->apiHandle.reset();
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static const char *s_thingName = "shadow-sync-thing";
+static const char *s_updateTopic = "$aws/things/shadow-sync-thing/shadow/update";
+static const char *s_writerToken = "writer";
+static const std::chrono::milliseconds s_waitTimeout(10000);
+
+static bool s_waitFor(const std::function<bool()> &condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + s_waitTimeout;
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static ShadowSyncOptions s_syncOptions(Io::EventLoopGroup &eventLoopGroup, std::atomic<int> &errorCount)
+{
+    ShadowSyncOptions options;
+    options.ThingName = s_thingName;
+    options.DebounceInterval = std::chrono::milliseconds(20);
+    options.EventLoopGroup = &eventLoopGroup;
+    options.OnError = [&errorCount](int ioErr, const ErrorResponse *rejection) {
+        (void)ioErr;
+        (void)rejection;
+        errorCount++;
+    };
+    return options;
+}
+
+static bool s_start(ShadowSync &sync)
+{
+    auto started = std::make_shared<std::promise<bool>>();
+    if (!sync.Start([started](int ioErr, const ErrorResponse *rejection) {
+            started->set_value(ioErr == AWS_ERROR_SUCCESS && rejection == nullptr);
+        }))
+    {
+        return false;
+    }
+    std::future<bool> startedFuture = started->get_future();
+    return startedFuture.wait_for(s_waitTimeout) == std::future_status::ready && startedFuture.get();
+}
+
+/* Updates the shadow the way another writer would, and waits for the service to accept it. */
+static bool s_writeShadow(
+    IotShadowClient &writer,
+    Utils::ShadowServiceEmulator &emulator,
+    const char *desired,
+    const char *reported)
+{
+    uint64_t acceptedCount = emulator.GetAcceptedUpdateCount();
+    UpdateShadowRequest request;
+    request.ThingName = s_thingName;
+    request.ClientToken = s_writerToken;
+    ShadowState state;
+    if (desired != nullptr)
+    {
+        state.Desired = JsonObject(desired);
+    }
+    if (reported != nullptr)
+    {
+        state.Reported = JsonObject(reported);
+    }
+    request.State = state;
+    return writer.PublishUpdateShadow(request, AWS_MQTT_QOS_AT_LEAST_ONCE, [](int) {}) &&
+           s_waitFor([&emulator, acceptedCount]() { return emulator.GetAcceptedUpdateCount() > acceptedCount; });
+}
+
+/* The updates ShadowSync published, oldest first. */
+static Vector<JsonObject> s_syncUpdates(const Utils::LocalMqttBroker &broker)
+{
+    Vector<JsonObject> updates;
+    for (const auto &publish : broker.GetRecordedPublishes())
+    {
+        JsonObject update(publish.payload);
+        if (publish.topic == s_updateTopic && update.View().GetString("clientToken") != s_writerToken)
+        {
+            updates.push_back(std::move(update));
+        }
+    }
+    return updates;
+}
+
+static bool s_syncedTo(ShadowSync &sync, Utils::ShadowServiceEmulator &emulator)
+{
+    Optional<int32_t> version = sync.GetVersion();
+    return version && static_cast<uint64_t>(*version) == emulator.GetVersion(s_thingName, "");
+}
+
+/* Waits for the service to have accepted `acceptedCount` updates, and for ShadowSync to know the latest version. */
+static bool s_waitForSync(ShadowSync &sync, Utils::ShadowServiceEmulator &emulator, uint64_t acceptedCount)
+{
+    return s_waitFor([&sync, &emulator, acceptedCount]() {
+        return emulator.GetAcceptedUpdateCount() == acceptedCount && s_syncedTo(sync, emulator);
+    });
+}
+
+static JsonView s_reported(const JsonObject &update)
+{
+    return update.View().GetJsonObject("state").GetJsonObject("reported");
+}
+
+static int s_TestShadowSyncDelta(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ShadowSyncTestContext *>(ctx);
+
+    Utils::LocalMqttBroker broker(*testContext->elGroup, allocator);
+    Utils::ShadowServiceEmulator emulator(broker);
+    ASSERT_TRUE(broker.Start());
+    broker.RecordPublishes("$aws/#");
+    {
+        Mqtt::MqttClient mqttClient(*testContext->clientBootstrap, allocator);
+        auto connection = broker.Connect(mqttClient, "shadow-sync-device");
+        auto writerConnection = broker.Connect(mqttClient, "shadow-sync-writer");
+        ASSERT_NOT_NULL(connection.get());
+        ASSERT_NOT_NULL(writerConnection.get());
+        {
+            std::atomic<int> errorCount(0);
+            IotShadowClient writer(writerConnection, allocator);
+            auto client = std::make_shared<IotShadowClient>(connection, allocator);
+            ShadowSyncOptions options = s_syncOptions(*testContext->elGroup, errorCount);
+            auto sync = std::make_shared<ShadowSync>(client, options, allocator);
+            ASSERT_TRUE(sync->BindProperty<int32_t>("config.speed", 1));
+            ASSERT_TRUE(sync->BindProperty<String>(
+                "config.mode", "idle", [](const String &desired) { return desired != "off"; }));
+
+            /* The shadow does not exist yet, so the first update creates it with the local values. */
+            ASSERT_TRUE(s_start(*sync));
+            ASSERT_TRUE(s_waitForSync(*sync, emulator, 1));
+            Vector<JsonObject> updates = s_syncUpdates(broker);
+            JsonView created = s_reported(updates[0]);
+            ASSERT_INT_EQUALS(1, created.GetJsonObject("config").GetInteger("speed"));
+            ASSERT_TRUE(created.GetJsonObject("config").GetString("mode") == "idle");
+
+            /* A desired value the handler takes becomes the local value and is reported; one it refuses is not. */
+            ASSERT_TRUE(s_writeShadow(writer, emulator, "{\"config\":{\"speed\":5,\"mode\":\"off\"}}", nullptr));
+            ASSERT_TRUE(s_waitForSync(*sync, emulator, 3));
+
+            int32_t speed = 0;
+            String mode;
+            ASSERT_TRUE(sync->GetProperty("config.speed", speed));
+            ASSERT_TRUE(sync->GetProperty("config.mode", mode));
+            ASSERT_INT_EQUALS(5, speed);
+            ASSERT_TRUE(mode == "idle");
+
+            updates = s_syncUpdates(broker);
+            ASSERT_UINT_EQUALS(2, updates.size());
+            JsonView reported = s_reported(updates[1]);
+            ASSERT_INT_EQUALS(5, reported.GetJsonObject("config").GetInteger("speed"));
+            ASSERT_FALSE(reported.GetJsonObject("config").ValueExists("mode"));
+            ASSERT_INT_EQUALS(0, errorCount.load());
+
+            sync->Stop();
+        }
+        Utils::LocalMqttBroker::Disconnect(*writerConnection);
+        Utils::LocalMqttBroker::Disconnect(*connection);
+    }
+    broker.Stop();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(ShadowSyncDelta, s_testSetup, s_TestShadowSyncDelta, s_testTeardown, &s_testContext);
+
+static int s_TestShadowSyncDebounce(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ShadowSyncTestContext *>(ctx);
+
+    Utils::LocalMqttBroker broker(*testContext->elGroup, allocator);
+    Utils::ShadowServiceEmulator emulator(broker);
+    ASSERT_TRUE(broker.Start());
+    broker.RecordPublishes("$aws/#");
+    {
+        Mqtt::MqttClient mqttClient(*testContext->clientBootstrap, allocator);
+        auto connection = broker.Connect(mqttClient, "shadow-sync-device");
+        ASSERT_NOT_NULL(connection.get());
+        {
+            std::atomic<int> errorCount(0);
+            ShadowSyncOptions options = s_syncOptions(*testContext->elGroup, errorCount);
+            options.DebounceInterval = std::chrono::milliseconds(300);
+            options.MaxDebounceDelay = std::chrono::milliseconds(1000);
+            auto client = std::make_shared<IotShadowClient>(connection, allocator);
+            auto sync = std::make_shared<ShadowSync>(client, options, allocator);
+            ASSERT_TRUE(sync->BindProperty<int32_t>("speed", 0));
+            ASSERT_TRUE(s_start(*sync));
+            ASSERT_TRUE(s_waitForSync(*sync, emulator, 1));
+
+            /* Each change restarts the wait, so changes closer together than the interval are reported once the
+             * last of them has settled. */
+            for (int32_t speed = 1; speed <= 4; ++speed)
+            {
+                ASSERT_TRUE(sync->SetProperty<int32_t>("speed", speed));
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            ASSERT_UINT_EQUALS(1, emulator.GetAcceptedUpdateCount());
+            ASSERT_TRUE(s_waitForSync(*sync, emulator, 2));
+            Vector<JsonObject> updates = s_syncUpdates(broker);
+            ASSERT_UINT_EQUALS(2, updates.size());
+            ASSERT_INT_EQUALS(4, s_reported(updates[1]).GetInteger("speed"));
+
+            /* Changes that keep arriving are still reported once the maximum delay has passed. */
+            auto changesEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(2500);
+            int32_t speed = 10;
+            while (std::chrono::steady_clock::now() < changesEnd)
+            {
+                ASSERT_TRUE(sync->SetProperty<int32_t>("speed", speed++));
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            ASSERT_TRUE(emulator.GetAcceptedUpdateCount() > 2);
+
+            int32_t lastSpeed = speed - 1;
+            ASSERT_TRUE(s_waitFor([&broker, &sync, &emulator, lastSpeed]() {
+                return s_reported(s_syncUpdates(broker).back()).GetInteger("speed") == lastSpeed &&
+                       s_syncedTo(*sync, emulator);
+            }));
+            /* The changes were still coalesced: far fewer updates than changes. */
+            ASSERT_TRUE(s_syncUpdates(broker).size() < 10);
+            ASSERT_INT_EQUALS(0, errorCount.load());
+
+            sync->Stop();
+        }
+        Utils::LocalMqttBroker::Disconnect(*connection);
+    }
+    broker.Stop();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(ShadowSyncDebounce, s_testSetup, s_TestShadowSyncDebounce, s_testTeardown, &s_testContext);
+
+static int s_TestShadowSyncVersionConflict(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ShadowSyncTestContext *>(ctx);
+
+    Utils::LocalMqttBroker broker(*testContext->elGroup, allocator);
+    Utils::ShadowServiceEmulator emulator(broker);
+    ASSERT_TRUE(broker.Start());
+    broker.RecordPublishes("$aws/#");
+    {
+        Mqtt::MqttClient mqttClient(*testContext->clientBootstrap, allocator);
+        auto connection = broker.Connect(mqttClient, "shadow-sync-device");
+        auto writerConnection = broker.Connect(mqttClient, "shadow-sync-writer");
+        ASSERT_NOT_NULL(connection.get());
+        ASSERT_NOT_NULL(writerConnection.get());
+        {
+            std::atomic<int> errorCount(0);
+            IotShadowClient writer(writerConnection, allocator);
+            auto client = std::make_shared<IotShadowClient>(connection, allocator);
+            ShadowSyncOptions options = s_syncOptions(*testContext->elGroup, errorCount);
+            auto sync = std::make_shared<ShadowSync>(client, options, allocator);
+            ASSERT_TRUE(sync->BindProperty<int32_t>("speed", 1));
+            ASSERT_TRUE(s_start(*sync));
+            ASSERT_TRUE(s_waitForSync(*sync, emulator, 1));
+
+            /* A reported-only update by another writer raises the version without a delta, so ShadowSync is not
+             * told of it. */
+            ASSERT_TRUE(s_writeShadow(writer, emulator, nullptr, "{\"other\":1}"));
+            ASSERT_INT_EQUALS(1, *sync->GetVersion());
+
+            /* The update based on the stale version is rejected, and made again once the shadow has been read. */
+            ASSERT_TRUE(sync->SetProperty<int32_t>("speed", 7));
+            ASSERT_TRUE(s_waitForSync(*sync, emulator, 3));
+
+            Vector<JsonObject> updates = s_syncUpdates(broker);
+            ASSERT_UINT_EQUALS(3, updates.size());
+            ASSERT_INT_EQUALS(1, updates[1].View().GetInteger("version"));
+            ASSERT_INT_EQUALS(2, updates[2].View().GetInteger("version"));
+            ASSERT_INT_EQUALS(7, s_reported(updates[2]).GetInteger("speed"));
+            ASSERT_INT_EQUALS(3, *sync->GetVersion());
+            ASSERT_INT_EQUALS(0, errorCount.load());
+
+            sync->Stop();
+        }
+        Utils::LocalMqttBroker::Disconnect(*writerConnection);
+        Utils::LocalMqttBroker::Disconnect(*connection);
+    }
+    broker.Stop();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    ShadowSyncVersionConflict,
+    s_testSetup,
+    s_TestShadowSyncVersionConflict,
+    s_testTeardown,
+    &s_testContext);
+
+/* Connects a connection again after `LocalMqttBroker::Disconnect`. */
+static bool s_reconnect(Mqtt::MqttConnection &connection, const char *clientId)
+{
+    std::promise<bool> connected;
+    connection.OnConnectionCompleted =
+        [&connected](Mqtt::MqttConnection &, int errorCode, Mqtt::ReturnCode returnCode, bool) {
+            connected.set_value(errorCode == AWS_ERROR_SUCCESS && returnCode == AWS_MQTT_CONNECT_ACCEPTED);
+        };
+    bool result = connection.Connect(clientId, true) && connected.get_future().get();
+    connection.OnConnectionCompleted = nullptr;
+    return result;
+}
+
+static int s_TestShadowSyncReconnect(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ShadowSyncTestContext *>(ctx);
+
+    Utils::LocalMqttBroker broker(*testContext->elGroup, allocator);
+    Utils::ShadowServiceEmulator emulator(broker);
+    ASSERT_TRUE(broker.Start());
+    broker.RecordPublishes("$aws/#");
+    {
+        Mqtt::MqttClient mqttClient(*testContext->clientBootstrap, allocator);
+        auto connection = broker.Connect(mqttClient, "shadow-sync-device");
+        auto writerConnection = broker.Connect(mqttClient, "shadow-sync-writer");
+        ASSERT_NOT_NULL(connection.get());
+        ASSERT_NOT_NULL(writerConnection.get());
+        {
+            std::atomic<int> errorCount(0);
+            IotShadowClient writer(writerConnection, allocator);
+            auto client = std::make_shared<IotShadowClient>(connection, allocator);
+            ShadowSyncOptions options = s_syncOptions(*testContext->elGroup, errorCount);
+            auto sync = std::make_shared<ShadowSync>(client, options, allocator);
+            ASSERT_TRUE(sync->BindProperty<int32_t>("speed", 1));
+            ASSERT_TRUE(s_start(*sync));
+            ASSERT_TRUE(s_waitForSync(*sync, emulator, 1));
+
+            /* While the device is offline, the desired value changes and its delta is missed. */
+            sync->Stop();
+            Utils::LocalMqttBroker::Disconnect(*connection);
+            ASSERT_TRUE(s_writeShadow(writer, emulator, "{\"speed\":9}", nullptr));
+            ASSERT_TRUE(sync->SetProperty<int32_t>("speed", 2));
+
+            /* Starting again reads the shadow, so the missed desired value is taken and reported. */
+            ASSERT_TRUE(s_reconnect(*connection, "shadow-sync-device"));
+            ASSERT_TRUE(s_start(*sync));
+            ASSERT_TRUE(s_waitForSync(*sync, emulator, 3));
+
+            int32_t speed = 0;
+            ASSERT_TRUE(sync->GetProperty("speed", speed));
+            ASSERT_INT_EQUALS(9, speed);
+            Vector<JsonObject> updates = s_syncUpdates(broker);
+            ASSERT_UINT_EQUALS(2, updates.size());
+            ASSERT_INT_EQUALS(9, s_reported(updates[1]).GetInteger("speed"));
+            ASSERT_INT_EQUALS(0, errorCount.load());
+
+            sync->Stop();
+        }
+        Utils::LocalMqttBroker::Disconnect(*writerConnection);
+        Utils::LocalMqttBroker::Disconnect(*connection);
+    }
+    broker.Stop();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(ShadowSyncReconnect, s_testSetup, s_TestShadowSyncReconnect, s_testTeardown, &s_testContext);
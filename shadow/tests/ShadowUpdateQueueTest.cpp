@@ -0,0 +1,209 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/crt/Api.h>
+#include <aws/crt/JsonObject.h>
+
+#include <aws/iotshadow/ShadowUpdateQueue.h>
+#include <aws/iotshadow/UpdateShadowRequest.h>
+
+#include "LocalMqttBroker.h"
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <cstdio>
+#include <functional>
+#include <thread>
+
+using namespace Aws::Crt;
+using namespace Aws::Iotshadow;
+
+struct ShadowUpdateQueueTestContext
+{
+    std::unique_ptr<ApiHandle> apiHandle;
+    std::unique_ptr<Io::EventLoopGroup> elGroup;
+    std::unique_ptr<Io::HostResolver> resolver;
+    std::unique_ptr<Io::ClientBootstrap> clientBootstrap;
+};
+
+static ShadowUpdateQueueTestContext s_testContext;
+
+static int s_testSetup(struct aws_allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ShadowUpdateQueueTestContext *>(ctx);
+
+    testContext->apiHandle = std::unique_ptr<ApiHandle>(new ApiHandle(allocator));
+    testContext->elGroup = std::unique_ptr<Io::EventLoopGroup>(new Io::EventLoopGroup(0, allocator));
+    testContext->resolver =
+        std::unique_ptr<Io::HostResolver>(new Io::DefaultHostResolver(*testContext->elGroup, 8, 30, allocator));
+    testContext->clientBootstrap = std::unique_ptr<Io::ClientBootstrap>(
+        new Io::ClientBootstrap(*testContext->elGroup, *testContext->resolver, allocator));
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static int s_testTeardown(struct aws_allocator *allocator, int setup_result, void *ctx)
+{
+    auto *testContext = static_cast<ShadowUpdateQueueTestContext *>(ctx);
+
+    testContext->elGroup.reset();
+    testContext->resolver.reset();
+    testContext->clientBootstrap.reset();
+    /* The ApiHandle must be deallocated last or a deadlock occurs. */
+    testContext->apiHandle.reset();
+
+    return AWS_ERROR_SUCCESS;
+}
+
+static const std::chrono::milliseconds s_waitTimeout(10000);
+
+static bool s_waitFor(const std::function<bool()> &condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + s_waitTimeout;
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static UpdateShadowRequest s_update(const char *thingName, const char *desired, const char *clientToken)
+{
+    UpdateShadowRequest request;
+    request.ThingName = thingName;
+    request.ClientToken = clientToken;
+    ShadowState state;
+    state.Desired = JsonObject(desired);
+    request.State = state;
+    return request;
+}
+
+static ShadowUpdateQueueOptions s_queueOptions(const char *path, Io::EventLoopGroup &eventLoopGroup)
+{
+    ShadowUpdateQueueOptions options;
+    options.FilePath = path;
+    options.SyncEachWrite = false;
+    options.MaxPublishesPerSecond = 50;
+    options.EventLoopGroup = &eventLoopGroup;
+    return options;
+}
+
+static int s_TestShadowUpdateQueueMerge(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ShadowUpdateQueueTestContext *>(ctx);
+    const char *path = "ShadowUpdateQueueMerge.log";
+    remove(path);
+
+    Utils::LocalMqttBroker broker(*testContext->elGroup, allocator);
+    ASSERT_TRUE(broker.Start());
+    broker.RecordPublishes("$aws/#");
+    {
+        Mqtt::MqttClient mqttClient(*testContext->clientBootstrap, allocator);
+        auto connection = broker.Connect(mqttClient, "shadow-update-queue-test");
+        ASSERT_NOT_NULL(connection.get());
+        {
+            auto client = std::make_shared<IotShadowClient>(connection, allocator);
+            auto queue = ShadowUpdateQueue::CreateQueue(client, s_queueOptions(path, *testContext->elGroup), allocator);
+            ASSERT_NOT_NULL(queue.get());
+            ASSERT_FALSE(queue->Enqueue(s_update("thing-1", "{\"a\":1}", "t0")));
+            ASSERT_TRUE(queue->Open());
+
+            /* Queued while paused, so the second update to thing-1 is merged into the first. */
+            ASSERT_TRUE(queue->Enqueue(s_update("thing-1", "{\"a\":1,\"nested\":{\"x\":1},\"c\":{\"z\":1}}", "t1")));
+            ASSERT_TRUE(queue->Enqueue(s_update("thing-1", "{\"b\":2,\"nested\":{\"y\":2},\"c\":3}", "t2")));
+            ASSERT_TRUE(queue->Enqueue(s_update("thing-2", "{\"a\":4}", "t3")));
+            ASSERT_UINT_EQUALS(2, queue->GetPendingCount());
+
+            queue->Resume();
+            ASSERT_TRUE(broker.WaitForRecordedPublishes(2, s_waitTimeout));
+            ASSERT_TRUE(s_waitFor([&queue]() { return queue->GetPendingCount() == 0; }));
+
+            Vector<Utils::LocalMqttBroker::RecordedPublish> publishes = broker.GetRecordedPublishes();
+            ASSERT_UINT_EQUALS(2, publishes.size());
+            ASSERT_TRUE(publishes[0].topic == "$aws/things/thing-1/shadow/update");
+            ASSERT_TRUE(publishes[1].topic == "$aws/things/thing-2/shadow/update");
+
+            /* Objects are merged key by key, and anything else takes the later value. */
+            JsonObject merged(publishes[0].payload);
+            JsonView desired = merged.View().GetJsonObject("state").GetJsonObject("desired");
+            ASSERT_INT_EQUALS(1, desired.GetInteger("a"));
+            ASSERT_INT_EQUALS(2, desired.GetInteger("b"));
+            ASSERT_INT_EQUALS(3, desired.GetInteger("c"));
+            ASSERT_INT_EQUALS(1, desired.GetJsonObject("nested").GetInteger("x"));
+            ASSERT_INT_EQUALS(2, desired.GetJsonObject("nested").GetInteger("y"));
+            ASSERT_TRUE(merged.View().GetString("clientToken") == "t2");
+
+            /* Once the merged update is published, the next update to thing-1 starts afresh. */
+            ASSERT_TRUE(queue->Enqueue(s_update("thing-1", "{\"d\":5}", "t4")));
+            ASSERT_TRUE(broker.WaitForRecordedPublishes(3, s_waitTimeout));
+            JsonObject unmerged(broker.GetRecordedPublishes()[2].payload);
+            ASSERT_FALSE(unmerged.View().GetJsonObject("state").GetJsonObject("desired").ValueExists("a"));
+        }
+        Utils::LocalMqttBroker::Disconnect(*connection);
+    }
+    broker.Stop();
+
+    remove(path);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    ShadowUpdateQueueMerge,
+    s_testSetup,
+    s_TestShadowUpdateQueueMerge,
+    s_testTeardown,
+    &s_testContext);
+
+static int s_TestShadowUpdateQueueFailedPublish(Aws::Crt::Allocator *allocator, void *ctx)
+{
+    auto *testContext = static_cast<ShadowUpdateQueueTestContext *>(ctx);
+    const char *path = "ShadowUpdateQueueFailedPublish.log";
+    remove(path);
+
+    Utils::LocalMqttBroker broker(*testContext->elGroup, allocator);
+    ASSERT_TRUE(broker.Start());
+    broker.RecordPublishes("$aws/#");
+    {
+        Mqtt::MqttClient mqttClient(*testContext->clientBootstrap, allocator);
+        /* The unacknowledged publish fails once the operation times out. */
+        auto connection = broker.Connect(mqttClient, "shadow-update-queue-test", 500);
+        ASSERT_NOT_NULL(connection.get());
+        {
+            auto client = std::make_shared<IotShadowClient>(connection, allocator);
+            auto queue = ShadowUpdateQueue::CreateQueue(client, s_queueOptions(path, *testContext->elGroup), allocator);
+            ASSERT_TRUE(queue->Open());
+            ASSERT_TRUE(queue->Enqueue(s_update("thing-1", "{\"a\":1}", "t1")));
+            ASSERT_TRUE(queue->Enqueue(s_update("thing-2", "{\"a\":2}", "t2")));
+
+            broker.IgnorePublishes(1);
+            queue->Resume();
+            ASSERT_TRUE(broker.WaitForRecordedPublishes(3, s_waitTimeout));
+            ASSERT_TRUE(s_waitFor([&queue]() { return queue->GetPendingCount() == 0; }));
+
+            /* The failed update stays at the front, and is published again before the next one. */
+            Vector<Utils::LocalMqttBroker::RecordedPublish> publishes = broker.GetRecordedPublishes();
+            ASSERT_UINT_EQUALS(3, publishes.size());
+            ASSERT_TRUE(publishes[0].topic == "$aws/things/thing-1/shadow/update");
+            ASSERT_TRUE(publishes[1].topic == "$aws/things/thing-1/shadow/update");
+            ASSERT_TRUE(publishes[1].payload == publishes[0].payload);
+            ASSERT_TRUE(publishes[2].topic == "$aws/things/thing-2/shadow/update");
+        }
+        Utils::LocalMqttBroker::Disconnect(*connection);
+    }
+    broker.Stop();
+
+    remove(path);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE_FIXTURE(
+    ShadowUpdateQueueFailedPublish,
+    s_testSetup,
+    s_TestShadowUpdateQueueFailedPublish,
+    s_testTeardown,
+    &s_testContext);